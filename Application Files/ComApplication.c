@@ -13,6 +13,14 @@
 //
 //	Change History (most recent first):
 //	   
+//	   <11>	 	11/13/26	rtm		added QTApp_GetExitStatus, so that a run whose output differs from its golden digests fails
+//	   <10>	 	11/13/26	rtm		QTApp_MCActionFilterProc wakes the window only for actions that change playback
+//	   <9>	 	11/07/26	rtm		stop the slice threads when the application quits
+//	   <8>	 	10/29/26	rtm		a copy of the application started as a codec worker compresses frames and quits
+//	   <7>	 	10/27/26	rtm		the Compress item is enabled with no window open when there's a source of raw frames
+//	   <6>	 	10/21/26	rtm		flush the frame cache when a movie is edited or its window is closed
+//	   <5>	 	10/20/26	rtm		QTApp_Idle now saves and restores the port only when it has work to do;
+//									QTApp_MCActionFilterProc wakes the window for any non-idle action
 //	   <4>	 	10/06/00	rtm		tweaked QTApp_Draw: don't erase windows associated with graphics importers
 //	   <3>	 	08/11/00	rtm		simplified QTApp_Draw
 //	   <2>	 	03/02/00	rtm		made changes to get things running under CarbonLib
@@ -64,6 +72,17 @@ void QTApp_Init (UInt32 theStartPhase)
 {
 	// do any start-up activities that should occur before the MDI frame window is created
 	if (theStartPhase & kInitAppPhase_BeforeCreateFrameWindow) {
+#if USE_CODEC_WORKERS
+		// if we were started as a codec worker, compress frames for the application that started us,
+		// and then quit without ever creating a window (see QTCmprWorker.c)
+		if (QTCmpr_IsWorkerProcess()) {
+			QTCmpr_RunWorker();
+			ExitMovies();
+			TerminateQTML();
+			ExitProcess(0);
+		}
+#endif
+
 #if TARGET_OS_MAC
 		// make sure that the Apple Event Manager is available; install handlers for required Apple events
 		QTApp_InstallAppleEventHandlers();
@@ -99,6 +118,8 @@ void QTApp_Stop (UInt32 theStopPhase)
 	
 	// do any shut-down activities that should occur after the movie windows are destroyed
 	if (theStopPhase & kStopAppPhase_AfterDestroyWindows) {
+		QTCmpr_StopSlicePool();
+
 #if TARGET_OS_MAC
 		// dispose of routine descriptors for Apple event handlers
 		DisposeAEEventHandlerUPP(gHandleOpenAppAEUPP);
@@ -111,6 +132,25 @@ void QTApp_Stop (UInt32 theStopPhase)
 }
 
 
+//////////
+//
+// QTApp_GetExitStatus
+// Return the status the application should exit with: 0 if all went well, or 1 if any compressed output didn't
+// match its golden digest (see QTCmprGolden.c), so that a script running a regression suite can tell.
+//
+//////////
+
+int QTApp_GetExitStatus (void)
+{
+	if (QTCmpr_GetGoldenFailures() > 0L) {
+		QTCmpr_LogMessage("QTApp_GetExitStatus: %ld digests didn't match the golden file", QTCmpr_GetGoldenFailures());
+		return(1);
+	}
+
+	return(0);
+}
+
+
 //////////
 //
 // QTApp_Idle
@@ -123,39 +163,45 @@ void QTApp_Idle (WindowReference theWindow)
 	WindowObject 		myWindowObject = NULL;
 	GrafPtr 			mySavedPort;
 	
+	// most calls to this function find nothing to do; so we don't touch the current port
+	// unless we actually have some work to do in the window
+	myWindowObject = QTFrame_GetWindowObjectFromWindow(theWindow);
+	if (myWindowObject == NULL)
+		return;
+		
+	if ((**myWindowObject).fController == NULL)
+		return;
+	
+#if TARGET_OS_MAC
+	// only the front movie window has any idle-time work to do
+	if (theWindow != QTFrame_GetFrontMovieWindow())
+		return;
+#endif
+
 	GetPort(&mySavedPort);
 	MacSetPort(QTFrame_GetPortFromWindowReference(theWindow));
 	
-	myWindowObject = QTFrame_GetWindowObjectFromWindow(theWindow);
-	if (myWindowObject != NULL) {
-		MovieController		myMC = NULL;
-	
-		myMC = (**myWindowObject).fController;
-		if (myMC != NULL) {
-			
-			// run any idle-time tasks for the movie
+	// run any idle-time tasks for the movie
 			
 #if TARGET_OS_MAC
-			// restore the cursor to the arrow
-			// if it's outside the front movie window or outside the window's visible region
-			if (theWindow == QTFrame_GetFrontMovieWindow()) {
-				Rect			myRect;
-				Point			myPoint;
-				RgnHandle		myVisRegion;
-				Cursor			myArrow;
-				
-				GetMouse(&myPoint);
-				myVisRegion = NewRgn();
-				GetPortVisibleRegion(QTFrame_GetPortFromWindowReference(theWindow), myVisRegion);
-				GetWindowPortBounds(theWindow, &myRect);
-				if (!MacPtInRect(myPoint, &myRect) || !PtInRgn(myPoint, myVisRegion))
-					MacSetCursor(GetQDGlobalsArrow(&myArrow));
-					
-				DisposeRgn(myVisRegion);
-			}
-#endif // TARGET_OS_MAC
-		}
+	// restore the cursor to the arrow
+	// if it's outside the front movie window or outside the window's visible region
+	{
+		Rect			myRect;
+		Point			myPoint;
+		RgnHandle		myVisRegion;
+		Cursor			myArrow;
+		
+		GetMouse(&myPoint);
+		myVisRegion = NewRgn();
+		GetPortVisibleRegion(QTFrame_GetPortFromWindowReference(theWindow), myVisRegion);
+		GetWindowPortBounds(theWindow, &myRect);
+		if (!MacPtInRect(myPoint, &myRect) || !PtInRgn(myPoint, myVisRegion))
+			MacSetCursor(GetQDGlobalsArrow(&myArrow));
+			
+		DisposeRgn(myVisRegion);
 	}
+#endif // TARGET_OS_MAC
 	
 	// ***insert application-specific idle-time processing here***
 	
@@ -276,8 +322,16 @@ Boolean QTApp_HandleMenu (UInt16 theMenuItem)
 	Boolean				myIsHandled = false;			// false => allow caller to process the menu item
 	
 	myWindowObject = QTFrame_GetWindowObjectFromFrontWindow();
-	if (myWindowObject == NULL)
+	if (myWindowObject == NULL) {
+#if USE_RAW_INGEST
+		// with no window open, the Compress item compresses raw frames from the ingest source
+		if ((theMenuItem == IDM_COMPRESS) && (QTCmpr_GetIngestInput(NULL) != NULL)) {
+			QTCmpr_CompressIngest(QTCmpr_GetIngestInput(NULL));
+			myIsHandled = true;
+		}
+#endif
 		return(myIsHandled);
+	}
 	
 	myWindow = (**myWindowObject).fWindow;
 	
@@ -331,7 +385,11 @@ void QTApp_AdjustMenus (WindowReference theWindow, MenuReference theMenu)
 
 	// ***insert application-specific menu adjusting here***
 
+#if USE_RAW_INGEST
+	if ((myWindowObject == NULL) && (QTCmpr_GetIngestInput(NULL) == NULL)) {
+#else
 	if (myWindowObject == NULL) {
+#endif
 		QTFrame_SetMenuItemState(myMenu, IDM_COMPRESS, kDisableMenuItem);
 	} else {
 		QTFrame_SetMenuItemState(myMenu, IDM_COMPRESS, kEnableMenuItem);
@@ -410,10 +468,14 @@ void QTApp_SetupWindowObject (WindowObject theWindowObject)
 
 void QTApp_RemoveWindowObject (WindowObject theWindowObject)
 {
-#pragma unused(theWindowObject)
-	
 	// ***insert application-specific window object clean-up here***
 
+#if USE_FRAME_CACHE
+	// the movie is about to be disposed of, so any frames we cached for it can never be used again
+	if (theWindowObject != NULL)
+		QTCmpr_FlushFrameCache((**theWindowObject).fMovie);
+#endif
+
 	// QTFrame_DestroyMovieWindow in MacFramework.c or QTFrame_MovieWndProc in WinFramework.c
 	// releases the window object itself
 }
@@ -451,7 +513,30 @@ PASCAL_RTN Boolean QTApp_MCActionFilterProc (MovieController theMC, short theAct
 		case mcActionIdle:
 			QTApp_Idle((**myWindowObject).fWindow);
 			break;
-			
+
+		// handle movie edits; any frames we cached for this movie may now be stale
+		case mcActionMovieEdited:
+#if USE_FRAME_CACHE
+			QTCmpr_FlushFrameCache((**myWindowObject).fMovie);
+#endif
+			QTFrame_WakeMovieWindow(myWindowObject);
+			break;
+
+		// handle actions that change how (or whether) the movie plays, and activation, which changes
+		// how often a paused movie is idled; make sure the window gets idle time on the next pass through
+		// the event loop, so that it can work out when it next needs idle time
+		case mcActionPlay:
+		case mcActionGoToTime:
+		case mcActionStep:
+		case mcActionSetLooping:
+		case mcActionSetLoopIsPalindrome:
+		case mcActionSetPlaySelection:
+		case mcActionSetPlayEveryFrame:
+		case mcActionActivate:
+		case mcActionDeactivate:
+			QTFrame_WakeMovieWindow(myWindowObject);
+			break;
+
 		default:
 			break;
 			
@@ -13,6 +13,24 @@
 //
 //	Change History (most recent first):
 //	   
+//	   <32>	 	11/13/26	rtm		QTFrame_HashImporterComponents no longer opens the importers; it hashes their flags and
+//									asks each component (not an instance) for its version
+//	   <31>	 	11/13/26	rtm		QTFrame_IdleMovieWindows now keeps a deadline for each window (see
+//									QTFrame_ScheduleIdle) and does nothing at all until the earliest one comes
+//	   <30>	 	11/12/26	rtm		the file type cache is now keyed by a hash of the type, subtype, manufacturer, and
+//									version of every importer component, so that a replaced or updated importer
+//									invalidates it even when the number of importers stays the same
+//	   <29>	 	10/24/26	rtm		QTFrame_OpenMovieInWindow now opens movies with newMovieAsyncOK, so that the
+//									window appears before a large movie is completely loaded; loading movies
+//									get idle time until they're done (see QTFrame_CheckMovieLoadState)
+//	   <28>	 	10/20/26	rtm		QTFrame_IdleMovieWindows now idles only the windows that need it (playing
+//									movies, QuickTime VR and streamed movies, and the front-most window at a
+//									reduced rate); added QTFrame_WakeMovieWindow
+//	   <27>	 	10/19/26	rtm		added a hashed file type table (see QTFrame_IsValidFileType) and an on-disk
+//									cache of the file type list, so that QTFrame_BuildFileTypeList walks the
+//									importer components only when the installed component set changes
+//	   <26>	 	10/18/26	rtm		QTFrame_OpenMovieInWindow now sniffs the file signature before looking for
+//									a graphics importer
 //	   <25>	 	02/12/01	rtm		fixed stupid bug in QTFrame_PutFile (was calling NavDisposeReply before
 //									reading data from reply record); d'oh!
 //	   <24>	 	02/01/01	rtm		fixed *Proc names to *UPP, to conform to Universal Header 3.4b4
@@ -86,11 +104,14 @@
 Rect					gMCResizeBounds;						// maximum size for any movie window
 Handle 					gValidFileTypes = NULL;					// the list of file types that our application can open
 long					gFirstGITypeIndex;						// the index in gValidFileTypes of the first graphics importer file type
+Handle					gValidFileTypeTable = NULL;				// an open-addressed hash table of the types in gValidFileTypes
+UInt32					gNextIdleTime = kIdleTimeNow;			// the earliest fNextIdleTime of any movie window
 
 #if TARGET_OS_WIN32
 extern HWND				ghWnd;
 extern HWND				ghWndMDIClient;
 extern BOOL				gWeAreSizingWindow;
+extern FSSpec			gAppFSSpec;
 #endif
 
 #if TARGET_OS_MAC
@@ -416,6 +437,7 @@ Boolean QTFrame_OpenMovieInWindow (Movie theMovie, FSSpec *theFSSpec)
 	Rect					myRect = {0, 0, 0, 0};
 	Point					myPoint;
 	QTFrameFileFilterUPP	myFileFilterUPP = NULL;
+	short					myFlags = newMovieActive;
 	OSErr					myErr = noErr;
 
 #if TARGET_OS_MAC
@@ -445,10 +467,17 @@ Boolean QTFrame_OpenMovieInWindow (Movie theMovie, FSSpec *theFSSpec)
 
 	// if we got no movie passed in, read one from the specified file
 	if (theMovie == NULL) {
-		// see if the FSSpec picks out an image file; if so, skip the movie-opening code
-		myErr = GetGraphicsImporterForFile(&myFSSpec, &myImporter);
-		if (myImporter != NULL)
-			goto gotImageFile;
+		short		myFileKind = kQTUtilsFileKindUnknown;
+		
+		// see if the FSSpec picks out an image file; if so, skip the movie-opening code; we look at
+		// the file's signature first, so that we don't go looking for a graphics importer for a file
+		// that is plainly a movie
+		QTUtils_SniffFileSignature(&myFSSpec, &myFileKind, NULL);
+		if (myFileKind != kQTUtilsFileKindMovie) {
+			myErr = GetGraphicsImporterForFile(&myFSSpec, &myImporter);
+			if (myImporter != NULL)
+				goto gotImageFile;
+		}
 			
 		// ideally, we'd like read and write permission, but we'll settle for read-only permission
 		myErr = OpenMovieFile(&myFSSpec, &myRefNum, fsRdWrPerm);
@@ -459,9 +488,15 @@ Boolean QTFrame_OpenMovieInWindow (Movie theMovie, FSSpec *theFSSpec)
 		if (myErr != noErr)
 			goto bail;
 
-		// now fetch the first movie from the file
+		// now fetch the first movie from the file; if QuickTime can load movies asynchronously, we let
+		// NewMovieFromFile return before the movie is completely loaded, so that the time it takes to
+		// open the window doesn't depend on the length of the movie
 		myResID = 0;
-		myErr = NewMovieFromFile(&myMovie, myRefNum, &myResID, NULL, newMovieActive, NULL);
+#if USE_ASYNC_MOVIE_LOADING
+		if (QTUtils_HasAsyncMovieLoading())
+			myFlags |= newMovieAsyncOK;
+#endif
+		myErr = NewMovieFromFile(&myMovie, myRefNum, &myResID, NULL, myFlags, NULL);
 		if (myErr != noErr)
 			goto bail;
 	} else {
@@ -512,6 +547,7 @@ gotImageFile:
 	(**myWindowObject).fInstance = NULL;
 	(**myWindowObject).fAppData = NULL;
 	(**myWindowObject).fFileFSSpec = myFSSpec;
+	(**myWindowObject).fLoadState = (myMovie != NULL) ? QTUtils_GetMovieLoadState(myMovie) : kMovieLoadStateComplete;
 	
 	// do any application-specific window object initialization
 	QTApp_SetupWindowObject(myWindowObject);
@@ -836,28 +872,191 @@ Boolean QTFrame_UpdateMovieFile (WindowReference theWindow)
 //////////
 //
 // QTFrame_IdleMovieWindows
-// Do idle-time processing on all open movie windows.
+// Do idle-time processing on those open movie windows that are due for it.
+//
+// Calling MCIdle and QTApp_Idle for every window on every pass through the event loop keeps the CPU busy
+// even when nothing is playing. So each window has a deadline, its next idle time, which QTFrame_ScheduleIdle
+// sets each time the window is idled; we idle only the windows whose deadlines have come, and until the
+// earliest of them (gNextIdleTime) comes, we don't even look at the windows. A paused movie in a background
+// window has no deadline at all, until something wakes it up (see QTFrame_WakeMovieWindow).
 //
 //////////
 
 void QTFrame_IdleMovieWindows (void)
 {	
 	WindowReference			myWindow = NULL;
+	WindowObject			myWindowObject = NULL;
 	MovieController			myMC = NULL;
-	
+	UInt32					myNow = TickCount();
+
+	if (!QTFrame_IsIdleTimeDue(gNextIdleTime, myNow))
+		return;
+
+	// work out the earliest deadline afresh; a window woken while we're idling others makes it "now"
+	gNextIdleTime = kIdleTimeNever;
+
 	myWindow = QTFrame_GetFrontMovieWindow();
 	while (myWindow != NULL) {
-		myMC = QTFrame_GetMCFromWindow(myWindow);
-		if (myMC != NULL)
-			MCIdle(myMC);
-			
-		QTApp_Idle(myWindow);
+		myWindowObject = QTFrame_GetWindowObjectFromWindow(myWindow);
+		if (myWindowObject != NULL) {
+			if (QTFrame_IsIdleTimeDue((**myWindowObject).fNextIdleTime, myNow)) {
+				myMC = (**myWindowObject).fController;
+				if (myMC != NULL)
+					MCIdle(myMC);
+					
+				QTApp_Idle(myWindow);
+				QTFrame_CheckMovieLoadState(myWindowObject);
+				QTFrame_ScheduleIdle(myWindow, myWindowObject, myNow);
+			}
+
+			gNextIdleTime = QTFrame_GetEarlierIdleTime(gNextIdleTime, (**myWindowObject).fNextIdleTime, myNow);
+		}
 		
 		myWindow = QTFrame_GetNextMovieWindow(myWindow);
 	}
 }
 
 
+//////////
+//
+// QTFrame_ScheduleIdle
+// Set the next idle time of the specified movie window, which has just been idled.
+//
+// A movie that's playing or still loading, a QuickTime VR movie, or a streamed movie needs tasking even when
+// nothing happens in its window; where the Idle Manager is available (QuickTime 6 and later), we ask QuickTime how
+// soon it next needs tasking, and otherwise we idle the window on every pass. Otherwise, the front-most window is
+// idled every kIdleIntervalPausedFront ticks (so that the controller bar stays responsive), and any other window
+// not until it's woken up.
+//
+//////////
+
+static void QTFrame_ScheduleIdle (WindowReference theWindow, WindowObject theWindowObject, UInt32 theNow)
+{
+	Movie					myMovie = (**theWindowObject).fMovie;
+	long					myTicks = 0L;
+
+	(**theWindowObject).fNextIdleTime = kIdleTimeNever;
+
+	if (((**theWindowObject).fController == NULL) || (myMovie == NULL))
+		return;
+
+	if ((GetMovieRate(myMovie) != 0) || (**theWindowObject).fIsQTVRMovie || QTUtils_IsStreamedMovie(myMovie) ||
+		(((**theWindowObject).fLoadState != kMovieLoadStateError) && ((**theWindowObject).fLoadState < kMovieLoadStateComplete))) {
+		if (QTUtils_HasIdleManager())
+			if ((QTGetTimeUntilNextTask(&myTicks, kIdleTicksPerSecond) != noErr) || (myTicks < 0L))
+				myTicks = 0L;
+
+		(**theWindowObject).fNextIdleTime = theNow + myTicks;
+	} else if (theWindow == QTFrame_GetFrontMovieWindow()) {
+		(**theWindowObject).fNextIdleTime = theNow + kIdleIntervalPausedFront;
+	}
+
+	// a deadline that happens to fall on the value meaning "never" has come already (near enough)
+	if ((**theWindowObject).fNextIdleTime == kIdleTimeNever)
+		(**theWindowObject).fNextIdleTime = kIdleTimeNow;
+}
+
+
+//////////
+//
+// QTFrame_IsIdleTimeDue
+// Has the specified idle time come?
+//
+//////////
+
+static Boolean QTFrame_IsIdleTimeDue (UInt32 theIdleTime, UInt32 theNow)
+{
+	if (theIdleTime == kIdleTimeNow)
+		return(true);
+
+	if (theIdleTime == kIdleTimeNever)
+		return(false);
+
+	// compare the difference, so that we behave correctly when the tick count wraps around
+	return((SInt32)(theNow - theIdleTime) >= 0);
+}
+
+
+//////////
+//
+// QTFrame_GetEarlierIdleTime
+// Return the earlier of the two specified idle times.
+//
+//////////
+
+static UInt32 QTFrame_GetEarlierIdleTime (UInt32 theIdleTime1, UInt32 theIdleTime2, UInt32 theNow)
+{
+	if ((theIdleTime1 == kIdleTimeNow) || (theIdleTime2 == kIdleTimeNever))
+		return(theIdleTime1);
+
+	if ((theIdleTime2 == kIdleTimeNow) || (theIdleTime1 == kIdleTimeNever))
+		return(theIdleTime2);
+
+	return(((SInt32)(theIdleTime1 - theNow) <= (SInt32)(theIdleTime2 - theNow)) ? theIdleTime1 : theIdleTime2);
+}
+
+
+//////////
+//
+// QTFrame_WakeMovieWindow
+// Make sure that the specified movie window gets idle-time processing on the next pass.
+//
+// Call this whenever something may have changed the playback state of a movie that isn't being idled (for
+// instance, when its movie controller starts it playing); once the window has been idled, QTFrame_ScheduleIdle
+// decides when it next needs idle time.
+//
+//////////
+
+void QTFrame_WakeMovieWindow (WindowObject theWindowObject)
+{
+	if (theWindowObject == NULL)
+		return;
+
+	(**theWindowObject).fNextIdleTime = kIdleTimeNow;
+	gNextIdleTime = kIdleTimeNow;
+}
+
+
+//////////
+//
+// QTFrame_CheckMovieLoadState
+// See whether the load state of the movie in the specified window has changed, and respond accordingly.
+//
+// A movie opened with newMovieAsyncOK may not know its final size or duration when its window is first
+// displayed; once it becomes playable we resize the window, and whenever more of it has loaded we tell the
+// movie controller, so that the controller bar reflects the new duration.
+//
+//////////
+
+static void QTFrame_CheckMovieLoadState (WindowObject theWindowObject)
+{
+	Movie					myMovie = NULL;
+	long					myLoadState;
+
+	if (theWindowObject == NULL)
+		return;
+
+	if (((**theWindowObject).fLoadState == kMovieLoadStateError) || ((**theWindowObject).fLoadState >= kMovieLoadStateComplete))
+		return;
+
+	myMovie = (**theWindowObject).fMovie;
+	if (myMovie == NULL)
+		return;
+
+	myLoadState = QTUtils_GetMovieLoadState(myMovie);
+	if (myLoadState == (**theWindowObject).fLoadState)
+		return;
+
+	if ((**theWindowObject).fController != NULL)
+		MCMovieChanged((**theWindowObject).fController, myMovie);
+
+	if (((**theWindowObject).fLoadState < kMovieLoadStatePlayable) && (myLoadState >= kMovieLoadStatePlayable))
+		QTFrame_SizeWindowToMovie(theWindowObject);
+
+	(**theWindowObject).fLoadState = myLoadState;
+}
+
+
 //////////
 //
 // QTFrame_CloseMovieWindows
@@ -908,6 +1107,8 @@ void QTFrame_CreateWindowObject (WindowReference theWindow)
 		(**myWindowObject).fInstance = NULL;
 		(**myWindowObject).fIsDirty = false;
 		(**myWindowObject).fAppData = NULL;
+		(**myWindowObject).fNextIdleTime = kIdleTimeNow;
+		(**myWindowObject).fLoadState = kMovieLoadStateComplete;
 	}
 	
 	// associate myWindowObject (which may be NULL) with the window
@@ -1935,18 +2136,9 @@ PASCAL_RTN Boolean QTFrame_FilterFiles (AEDesc *theItem, void *theInfo, void *th
 	if (theItem->descriptorType == typeFSS) {
 		if (!myInfo->isFolder) {
 			OSType			myType = myInfo->fileAndFolder.fileInfo.finderInfo.fdType;
-			OSType			*myTypes = (OSType *)*gValidFileTypes;
-			short			myCount;
-			short			myIndex;
 			
 			// see whether the file type is in the list of file types that our application can open 
-			myCount = GetHandleSize(gValidFileTypes) / sizeof(OSType);
-			for (myIndex = 0; myIndex < myCount; myIndex++)
-				if (myType == myTypes[myIndex])
-					return(true);
-
-			// if we got to here, it's a file we cannot open
-			return(false);		
+			return(QTFrame_IsValidFileType(myType));
 		}
 	}
 	
@@ -1968,17 +2160,27 @@ PASCAL_RTN Boolean QTFrame_FilterFiles (CInfoPBPtr thePBPtr)
 // QTFrame_BuildFileTypeList
 // Build a list of file types that QuickTime can open.
 //
+// Walking all the movie importer and graphics importer components is slow, so we keep a copy of the
+// list in a cache file; we rebuild the list only if the cache is missing or was written for a different
+// set of installed components. In either case, we finish by building a hash table of the types, so that
+// QTFrame_IsValidFileType can answer in constant time.
+//
 //////////
 
 OSErr QTFrame_BuildFileTypeList (void)
 {
 	long		myIndex = 0;
 	OSType		*myTypes;
+	OSErr		myErr = noErr;
 
 	// if we've already built the list, just return
 	if (gValidFileTypes != NULL)
 		return(noErr);
 	
+	// if the cached list is still good, use it
+	if (QTFrame_ReadFileTypeCache() == noErr)
+		return(QTFrame_BuildFileTypeTable());
+	
 	// allocate a block of memory to hold a preset number of file types; we'll resize this block
 	// while building the list if we need more room; we always resize it after building the list,
 	// to truncate it to the exact size required
@@ -2000,8 +2202,411 @@ OSErr QTFrame_BuildFileTypeList (void)
 
 	// resize the pointer to hold the exact number of valid file types
 	SetHandleSize(gValidFileTypes, myIndex * sizeof(OSType));
+	myErr = MemError();
+	if (myErr != noErr)
+		return(myErr);
 	
-	return(MemError());
+	// save the list for next time; it's not a problem if we can't
+	QTFrame_WriteFileTypeCache();
+	
+	return(QTFrame_BuildFileTypeTable());
+}
+
+
+//////////
+//
+// QTFrame_BuildFileTypeTable
+// Build a hash table of the file types in the global list of file types.
+//
+// The table is an open-addressed table of OSTypes whose size is a power of two at least twice the number
+// of types; an empty slot holds 0, which is never a valid file type.
+//
+//////////
+
+static OSErr QTFrame_BuildFileTypeTable (void)
+{
+	OSType		*myTypes = NULL;
+	OSType		*mySlots = NULL;
+	long		myCount;
+	long		mySize = kFileTypeTableMinSize;
+	long		myIndex;
+
+	if (gValidFileTypes == NULL)
+		return(paramErr);
+
+	myCount = GetHandleSize(gValidFileTypes) / (long)sizeof(OSType);
+	while (mySize < 2 * myCount)
+		mySize <<= 1;
+
+	if (gValidFileTypeTable != NULL)
+		DisposeHandle(gValidFileTypeTable);
+
+	gValidFileTypeTable = NewHandleClear(mySize * sizeof(OSType));
+	if (gValidFileTypeTable == NULL)
+		return(memFullErr);
+
+	myTypes = (OSType *)*gValidFileTypes;
+	mySlots = (OSType *)*gValidFileTypeTable;
+
+	for (myIndex = 0; myIndex < myCount; myIndex++) {
+		unsigned long	mySlot = QTFrame_HashFileType(myTypes[myIndex], mySize);
+
+		if (myTypes[myIndex] == 0L)
+			continue;
+
+		// probe linearly for the type or an empty slot; duplicates are stored only once
+		while ((mySlots[mySlot] != 0L) && (mySlots[mySlot] != myTypes[myIndex]))
+			mySlot = (mySlot + 1) & (mySize - 1);
+
+		mySlots[mySlot] = myTypes[myIndex];
+	}
+
+	return(noErr);
+}
+
+
+//////////
+//
+// QTFrame_HashFileType
+// Return the home slot of the specified file type in a hash table of the specified size (a power of two).
+//
+//////////
+
+static unsigned long QTFrame_HashFileType (OSType theType, long theTableSize)
+{
+	// multiply by 2^32 divided by the golden ratio, then fold the well-mixed high-order bits down
+	unsigned long	myHash = (unsigned long)((theType * 2654435761UL) & 0xFFFFFFFFUL);
+	
+	myHash ^= myHash >> 16;
+
+	return(myHash & (unsigned long)(theTableSize - 1));
+}
+
+
+//////////
+//
+// QTFrame_IsValidFileType
+// Is the specified file type one that our application can open?
+//
+//////////
+
+Boolean QTFrame_IsValidFileType (OSType theType)
+{
+	OSType			*mySlots = NULL;
+	long			mySize;
+	unsigned long	mySlot;
+
+	if (gValidFileTypes == NULL)
+		QTFrame_BuildFileTypeList();
+	else if (gValidFileTypeTable == NULL)
+		QTFrame_BuildFileTypeTable();
+
+	if ((gValidFileTypeTable == NULL) || (theType == 0L))
+		return(false);
+
+	mySize = GetHandleSize(gValidFileTypeTable) / (long)sizeof(OSType);
+	mySlots = (OSType *)*gValidFileTypeTable;
+
+	for (mySlot = QTFrame_HashFileType(theType, mySize); mySlots[mySlot] != 0L; mySlot = (mySlot + 1) & (mySize - 1))
+		if (mySlots[mySlot] == theType)
+			return(true);
+
+	return(false);
+}
+
+
+//////////
+//
+// QTFrame_GetFileTypeCacheSpec
+// Get a file specification for the file that holds our cached list of file types.
+//
+// On Macintosh, the cache file lives in the Preferences folder; on Windows, it lives alongside the application.
+//
+//////////
+
+static OSErr QTFrame_GetFileTypeCacheSpec (FSSpecPtr theFSSpecPtr)
+{
+	StringPtr		myName = QTUtils_ConvertCToPascalString(kFileTypeCacheFileName);
+	OSErr			myErr = noErr;
+
+#if TARGET_OS_MAC
+	short			myVRefNum;
+	long			myDirID;
+
+	myErr = FindFolder(kOnSystemDisk, kPreferencesFolderType, kCreateFolder, &myVRefNum, &myDirID);
+	if (myErr == noErr)
+		myErr = FSMakeFSSpec(myVRefNum, myDirID, myName, theFSSpecPtr);
+#endif
+#if TARGET_OS_WIN32
+	char			*myPath = QTUtils_ConvertPascalToCString(gAppFSSpec.name);
+	char			*mySeparator = strrchr(myPath, '\\');
+	char			*myFullPath = malloc(strlen(myPath) + strlen(kFileTypeCacheFileName) + 2);
+
+	if (myFullPath != NULL) {
+		if (mySeparator != NULL)
+			*(mySeparator + 1) = '\0';
+		else
+			myPath[0] = '\0';
+
+		strcpy(myFullPath, myPath);
+		strcat(myFullPath, kFileTypeCacheFileName);
+		myErr = NativePathNameToFSSpec(myFullPath, theFSSpecPtr, kFullNativePath);
+		free(myFullPath);
+	} else {
+		myErr = memFullErr;
+	}
+
+	free(myPath);
+#endif
+
+	free(myName);
+
+	// a nonexistent cache file is fine; we just need a valid specification for it
+	if (myErr == fnfErr)
+		myErr = noErr;
+
+	return(myErr);
+}
+
+
+//////////
+//
+// QTFrame_GetFileTypeCacheKey
+// Fill in the fields of a cache file header that identify the installed set of importer components.
+//
+//////////
+
+static void QTFrame_GetFileTypeCacheKey (FileTypeCacheHeader *theHeader)
+{
+	ComponentDescription		myCompDesc = {0, 0, 0, 0, 0};
+
+	theHeader->fSignature = kFileTypeCacheSignature;
+	theHeader->fVersion = kFileTypeCacheVersion;
+	theHeader->fQTVersion = QTUtils_GetQTVersion();
+
+	// use the same flags as QTFrame_AddComponentFileTypes, so that the counts track exactly what it would find
+	myCompDesc.componentFlags = 0;
+	myCompDesc.componentFlagsMask = movieImportSubTypeIsFileExtension;
+
+	myCompDesc.componentType = MovieImportType;
+	theHeader->fMovieImportCount = CountComponents(&myCompDesc);
+
+	myCompDesc.componentType = GraphicsImporterComponentType;
+	theHeader->fGraphicsImportCount = CountComponents(&myCompDesc);
+
+	// an importer that's replaced or updated leaves the counts the same, but not the hash
+	theHeader->fComponentHash = QTFrame_HashImporterComponents(MovieImportType, kFileTypeCacheHashSeed);
+	theHeader->fComponentHash = QTFrame_HashImporterComponents(GraphicsImporterComponentType, theHeader->fComponentHash);
+}
+
+
+//////////
+//
+// QTFrame_HashImporterComponents
+// Add the type, subtype, manufacturer, flags, and version of each component of the specified type to the specified
+// hash, and return the new hash.
+//
+// We walk the components just as QTFrame_AddComponentFileTypes does, but we never open one: all we use is what the
+// Component Manager already knows, and we ask for the version with the component itself rather than an instance
+// of it, so no importer's code is loaded just to check the cache.
+//
+//////////
+
+static UInt32 QTFrame_HashImporterComponents (OSType theComponentType, UInt32 theHash)
+{
+	ComponentDescription		myFindCompDesc = {0, 0, 0, 0, 0};
+	ComponentDescription		myInfoCompDesc = {0, 0, 0, 0, 0};
+	Component					myComponent = NULL;
+	UInt32						myValues[5];
+	long						myIndex;
+
+	myFindCompDesc.componentType = theComponentType;
+	myFindCompDesc.componentFlags = 0;
+	myFindCompDesc.componentFlagsMask = movieImportSubTypeIsFileExtension;
+
+	myComponent = FindNextComponent(myComponent, &myFindCompDesc);
+	while (myComponent != NULL) {
+		GetComponentInfo(myComponent, &myInfoCompDesc, NULL, NULL, NULL);
+
+		myValues[0] = myInfoCompDesc.componentType;
+		myValues[1] = myInfoCompDesc.componentSubType;
+		myValues[2] = myInfoCompDesc.componentManufacturer;
+		myValues[3] = myInfoCompDesc.componentFlags;
+		myValues[4] = (UInt32)GetComponentVersion((ComponentInstance)myComponent);
+
+		// FNV-1a, a byte at a time, most significant byte first
+		for (myIndex = 0; myIndex < 20; myIndex++) {
+			theHash ^= (myValues[myIndex / 4] >> (24 - (8 * (myIndex % 4)))) & 0xFF;
+			theHash = (theHash * kFileTypeCacheHashPrime) & 0xFFFFFFFFUL;
+		}
+
+		myComponent = FindNextComponent(myComponent, &myFindCompDesc);
+	}
+
+	return(theHash);
+}
+
+
+//////////
+//
+// QTFrame_ReadFileTypeCache
+// Read the global list of file types from the cache file, if it exists and is current.
+//
+//////////
+
+static OSErr QTFrame_ReadFileTypeCache (void)
+{
+	FSSpec					myFSSpec;
+	FileTypeCacheHeader		myHeader;
+	FileTypeCacheHeader		myCurrent;
+	OSType					*myTypes = NULL;
+	long					mySize;
+	long					myIndex;
+	short					myRefNum = kInvalidFileRefNum;
+	OSErr					myErr = noErr;
+
+	myErr = QTFrame_GetFileTypeCacheSpec(&myFSSpec);
+	if (myErr != noErr)
+		goto bail;
+
+	myErr = FSpOpenDF(&myFSSpec, fsRdPerm, &myRefNum);
+	if (myErr != noErr)
+		goto bail;
+
+	mySize = sizeof(myHeader);
+	myErr = FSRead(myRefNum, &mySize, &myHeader);
+	if (myErr != noErr)
+		goto bail;
+
+	// the header is stored in big-endian format
+	myHeader.fSignature = EndianU32_BtoN(myHeader.fSignature);
+	myHeader.fVersion = EndianS32_BtoN(myHeader.fVersion);
+	myHeader.fQTVersion = EndianS32_BtoN(myHeader.fQTVersion);
+	myHeader.fMovieImportCount = EndianS32_BtoN(myHeader.fMovieImportCount);
+	myHeader.fGraphicsImportCount = EndianS32_BtoN(myHeader.fGraphicsImportCount);
+	myHeader.fComponentHash = EndianU32_BtoN(myHeader.fComponentHash);
+	myHeader.fTypeCount = EndianS32_BtoN(myHeader.fTypeCount);
+	myHeader.fFirstGITypeIndex = EndianS32_BtoN(myHeader.fFirstGITypeIndex);
+
+	// make sure the cache was built for the components that are installed right now
+	QTFrame_GetFileTypeCacheKey(&myCurrent);
+	if ((myHeader.fSignature != myCurrent.fSignature) ||
+		(myHeader.fVersion != myCurrent.fVersion) ||
+		(myHeader.fQTVersion != myCurrent.fQTVersion) ||
+		(myHeader.fMovieImportCount != myCurrent.fMovieImportCount) ||
+		(myHeader.fGraphicsImportCount != myCurrent.fGraphicsImportCount) ||
+		(myHeader.fComponentHash != myCurrent.fComponentHash) ||
+		(myHeader.fTypeCount <= 0) ||
+		(myHeader.fFirstGITypeIndex > myHeader.fTypeCount)) {
+		myErr = paramErr;
+		goto bail;
+	}
+
+	gValidFileTypes = NewHandleClear(myHeader.fTypeCount * sizeof(OSType));
+	if (gValidFileTypes == NULL) {
+		myErr = memFullErr;
+		goto bail;
+	}
+
+	HLock(gValidFileTypes);
+	mySize = myHeader.fTypeCount * sizeof(OSType);
+	myErr = FSRead(myRefNum, &mySize, *gValidFileTypes);
+	HUnlock(gValidFileTypes);
+	if (myErr != noErr)
+		goto bail;
+
+	myTypes = (OSType *)*gValidFileTypes;
+	for (myIndex = 0; myIndex < myHeader.fTypeCount; myIndex++)
+		myTypes[myIndex] = EndianU32_BtoN(myTypes[myIndex]);
+
+	gFirstGITypeIndex = myHeader.fFirstGITypeIndex;
+
+bail:
+	if (myRefNum != kInvalidFileRefNum)
+		FSClose(myRefNum);
+
+	if ((myErr != noErr) && (gValidFileTypes != NULL)) {
+		DisposeHandle(gValidFileTypes);
+		gValidFileTypes = NULL;
+	}
+
+	return(myErr);
+}
+
+
+//////////
+//
+// QTFrame_WriteFileTypeCache
+// Write the global list of file types into the cache file.
+//
+//////////
+
+static OSErr QTFrame_WriteFileTypeCache (void)
+{
+	FSSpec					myFSSpec;
+	FileTypeCacheHeader		myHeader;
+	OSType					*myTypes = NULL;
+	long					myCount;
+	long					mySize;
+	long					myIndex;
+	short					myRefNum = kInvalidFileRefNum;
+	OSErr					myErr = noErr;
+
+	if (gValidFileTypes == NULL)
+		return(paramErr);
+
+	myErr = QTFrame_GetFileTypeCacheSpec(&myFSSpec);
+	if (myErr != noErr)
+		goto bail;
+
+	myCount = GetHandleSize(gValidFileTypes) / (long)sizeof(OSType);
+
+	// build a big-endian copy of the list, so that the file is the same on all platforms
+	myTypes = (OSType *)NewPtr(myCount * sizeof(OSType));
+	if (myTypes == NULL) {
+		myErr = memFullErr;
+		goto bail;
+	}
+
+	for (myIndex = 0; myIndex < myCount; myIndex++)
+		myTypes[myIndex] = EndianU32_NtoB(((OSType *)*gValidFileTypes)[myIndex]);
+
+	QTFrame_GetFileTypeCacheKey(&myHeader);
+	myHeader.fSignature = EndianU32_NtoB(myHeader.fSignature);
+	myHeader.fVersion = EndianS32_NtoB(myHeader.fVersion);
+	myHeader.fQTVersion = EndianS32_NtoB(myHeader.fQTVersion);
+	myHeader.fMovieImportCount = EndianS32_NtoB(myHeader.fMovieImportCount);
+	myHeader.fGraphicsImportCount = EndianS32_NtoB(myHeader.fGraphicsImportCount);
+	myHeader.fComponentHash = EndianU32_NtoB(myHeader.fComponentHash);
+	myHeader.fTypeCount = EndianS32_NtoB(myCount);
+	myHeader.fFirstGITypeIndex = EndianS32_NtoB(gFirstGITypeIndex);
+
+	// create the file, if necessary, and open it
+	FSpCreate(&myFSSpec, kApplicationSignature, kFileTypeCacheFileType, smSystemScript);
+	myErr = FSpOpenDF(&myFSSpec, fsRdWrPerm, &myRefNum);
+	if (myErr != noErr)
+		goto bail;
+
+	mySize = sizeof(myHeader);
+	myErr = FSWrite(myRefNum, &mySize, &myHeader);
+	if (myErr != noErr)
+		goto bail;
+
+	mySize = myCount * sizeof(OSType);
+	myErr = FSWrite(myRefNum, &mySize, myTypes);
+	if (myErr != noErr)
+		goto bail;
+
+	myErr = SetEOF(myRefNum, sizeof(myHeader) + (myCount * sizeof(OSType)));
+
+bail:
+	if (myRefNum != kInvalidFileRefNum)
+		FSClose(myRefNum);
+
+	if (myTypes != NULL)
+		DisposePtr((Ptr)myTypes);
+
+	return(myErr);
 }
 
 
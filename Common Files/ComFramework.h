@@ -13,6 +13,12 @@
 //
 //	Change History (most recent first):
 //	   
+//	   <8>	 	11/13/26	rtm		added QTApp_GetExitStatus
+//	   <7>	 	11/13/26	rtm		added kIdleTimeNever and kIdleTicksPerSecond
+//	   <6>	 	11/12/26	rtm		added fComponentHash field to FileTypeCacheHeader
+//	   <5>	 	10/24/26	rtm		added USE_ASYNC_MOVIE_LOADING and the fLoadState field to window object record
+//	   <4>	 	10/20/26	rtm		added fNextIdleTime field to window object record
+//	   <3>	 	10/19/26	rtm		added FileTypeCacheHeader and the file type cache constants
 //	   <2>	 	01/14/00	rtm		added fGraphicsImporter field to window object record
 //	   <1>	 	11/05/99	rtm		first file
 //
@@ -39,6 +45,10 @@
 #include <FileTypesAndCreators.h>
 #endif
 
+#ifndef __FOLDERS__
+#include <Folders.h>
+#endif
+
 #ifndef __MENUS__
 #include <Menus.h>
 #endif
@@ -92,6 +102,15 @@
 #endif
 
 
+//////////
+//
+// compiler flags
+//
+//////////
+
+#define USE_ASYNC_MOVIE_LOADING				1				// do we open movie windows before their movies are completely loaded?
+
+
 //////////
 //
 // constants
@@ -101,6 +120,21 @@
 #define kInvalidFileRefNum					-1				// an invalid file reference number
 
 #define kDefaultFileTypeCount				100				// a generous guess at the number of file types we can open
+#define kFileTypeTableMinSize				64				// minimum number of slots in the file type hash table
+
+// constants for scheduling idle-time processing of movie windows
+#define kIdleIntervalPausedFront			6				// ticks between idles for a paused, front-most movie window
+#define kIdleTimeNow						0L				// a value of fNextIdleTime that means "as soon as possible"
+#define kIdleTimeNever						0xFFFFFFFFUL	// a value of fNextIdleTime that means "not until woken up"
+#define kIdleTicksPerSecond					60L				// the time scale of fNextIdleTime (ticks)
+
+// constants for the file type cache file
+#define kFileTypeCacheFileName				"QTFrame File Types"
+#define kFileTypeCacheFileType				FOUR_CHAR_CODE('QTft')
+#define kFileTypeCacheSignature				FOUR_CHAR_CODE('QTft')
+#define kFileTypeCacheVersion				2
+#define kFileTypeCacheHashSeed				2166136261UL	// the starting value of the importer component hash
+#define kFileTypeCacheHashPrime				16777619UL		// the multiplier of the importer component hash
 
 // constants for selecting InitApplication phase
 enum {
@@ -235,8 +269,26 @@ typedef struct {
 	QTVRInstance			fInstance;			// the QTVRInstance, if it's a QuickTime VR movie
 	OSType					fObjectType;		// a tag indicating that the window object belongs to our application
 	Handle					fAppData;			// a handle to application-specific window data
+	UInt32					fNextIdleTime;		// the tick count at which a paused movie next needs idle-time processing
+	long					fLoadState;			// the movie's load state, as of the last time we checked
 } WindowObjectRecord, *WindowObjectPtr, **WindowObject;
 
+// FileTypeCacheHeader is the header of the file type cache file; it is followed by fTypeCount file types.
+// Everything in the file is stored in big-endian format. The fields fQTVersion, fMovieImportCount,
+// fGraphicsImportCount, and fComponentHash identify the set of importer components that the cached list
+// was built from.
+
+typedef struct {
+	OSType					fSignature;			// kFileTypeCacheSignature
+	long					fVersion;			// kFileTypeCacheVersion
+	long					fQTVersion;			// the QuickTime version, as returned by QTUtils_GetQTVersion
+	long					fMovieImportCount;	// the number of movie importer components
+	long					fGraphicsImportCount;	// the number of graphics importer components
+	UInt32					fComponentHash;		// a hash of the type, subtype, manufacturer, and version of each of them
+	long					fTypeCount;			// the number of file types that follow this header
+	long					fFirstGITypeIndex;	// the index of the first graphics importer file type
+} FileTypeCacheHeader;
+
 
 //////////
 //
@@ -262,6 +314,11 @@ MovieController				QTFrame_SetupController (Movie theMovie, WindowReference theW
 OSErr						QTFrame_SaveAsMovieFile (WindowReference theWindow);
 Boolean 					QTFrame_UpdateMovieFile (WindowReference theWindow);
 void						QTFrame_IdleMovieWindows (void);
+static void					QTFrame_ScheduleIdle (WindowReference theWindow, WindowObject theWindowObject, UInt32 theNow);
+static Boolean				QTFrame_IsIdleTimeDue (UInt32 theIdleTime, UInt32 theNow);
+static UInt32				QTFrame_GetEarlierIdleTime (UInt32 theIdleTime1, UInt32 theIdleTime2, UInt32 theNow);
+void						QTFrame_WakeMovieWindow (WindowObject theWindowObject);
+static void					QTFrame_CheckMovieLoadState (WindowObject theWindowObject);
 void						QTFrame_CloseMovieWindows (void);
 void						QTFrame_CreateWindowObject (WindowReference theWindow);
 void						QTFrame_CloseWindowObject (WindowObject theWindowObject);
@@ -305,6 +362,14 @@ Handle						QTFrame_CreateOpenHandle (OSType theApplicationSignature, short theN
 QTFrameFileFilterUPP		QTFrame_GetFileFilterUPP (ProcPtr theFileFilterProc);
 OSErr						QTFrame_BuildFileTypeList (void);
 static void					QTFrame_AddComponentFileTypes (OSType theComponentType, long *theNextIndex);
+static OSErr				QTFrame_BuildFileTypeTable (void);
+static unsigned long		QTFrame_HashFileType (OSType theType, long theTableSize);
+Boolean						QTFrame_IsValidFileType (OSType theType);
+static OSErr				QTFrame_GetFileTypeCacheSpec (FSSpecPtr theFSSpecPtr);
+static void					QTFrame_GetFileTypeCacheKey (FileTypeCacheHeader *theHeader);
+static UInt32				QTFrame_HashImporterComponents (OSType theComponentType, UInt32 theHash);
+static OSErr				QTFrame_ReadFileTypeCache (void);
+static OSErr				QTFrame_WriteFileTypeCache (void);
 
 #if TARGET_OS_MAC
 PASCAL_RTN Boolean			QTFrame_FilterFiles (AEDesc *theItem, void *theInfo, void *theCallBackUD, NavFilterModes theFilterMode);
@@ -328,6 +393,7 @@ void						QTFrame_ConvertMacToWinMenuItemLabel (MovieController theMC, MenuRefer
 
 void						QTApp_Init (UInt32 theStartPhase);
 void						QTApp_Stop (UInt32 theStopPhase);
+int							QTApp_GetExitStatus (void);
 void						QTApp_Idle (WindowReference theWindow);
 void						QTApp_Draw (WindowReference theWindow);
 void 						QTApp_HandleContentClick (WindowReference theWindow, EventRecord *theEvent);
@@ -0,0 +1,1034 @@
+//////////
+//
+//	File:		QTParse.c
+//
+//	Contains:	A lightweight reader for QuickTime movie files, which maps the file into memory and
+//				returns movie samples in place, without using the Movie Toolbox.
+//				All utilities start with the prefix "QTParse_".
+//
+//	Written by:	Tim Monroe
+//
+//	Copyright:	 2000 by Apple Computer, Inc., all rights reserved.
+//
+//	Change History (most recent first):
+//
+//	   <4>	 	11/13/26	rtm		added QTParse_IsTrackSelfContained, so that callers can tell tracks whose samples
+//									live in other files from tracks whose samples we can read
+//	   <3>	 	11/13/26	rtm		removed the sample page index; nothing seeks at random into a track, and
+//									reading samples in order needs only the table cursors
+//	   <2>	 	10/24/26	rtm		added the sample page index, so that random access into a long track doesn't
+//									have to walk its tables from the beginning
+//	   <1>	 	10/23/26	rtm		first file
+//
+//	The Movie Toolbox is the right way to play or render a movie, but it's a heavyweight way to look at
+//	the raw samples in a movie file: opening a movie instantiates media handlers and data handlers, and
+//	GetMediaSample copies each sample into a handle. The functions in this file instead map the entire file
+//	into memory and walk the atoms directly. A sample is returned as a span (a pointer and a length) into
+//	the mapping, so reading a sample never copies it; the operating system pages in just the parts of the
+//	file that are actually touched.
+//
+//	Parsing is lazy. QTParse_OpenMovieFile only finds the movie atom among the top-level atoms; the track
+//	atoms are parsed the first time anyone asks about tracks; and a track's sample table is parsed the first
+//	time anyone asks for one of its samples. Even then, "parsing" a sample table just means finding the
+//	tables inside it; table entries are read from the mapping when they are needed. We keep cursors into the
+//	sample-to-chunk and time-to-sample tables, so that stepping through the samples of a track in order
+//	takes constant time per sample.
+//
+//	On Windows, we map the file with CreateFileMapping; on Mac OS X, with mmap. On Mac OS 9 there is no
+//	file mapping, so we read the file into memory; everything else works the same.
+//
+//	LIMITATIONS: The entire file must fit in the address space, so we reject files of 4 GB or more (and
+//	64-bit chunk offsets beyond that size). We don't handle compressed movie atoms ('cmov') or fragmented
+//	movies; QTParse_GetSample returns an error for samples we can't locate. We don't follow data references
+//	either: a chunk offset is always taken to be an offset in this file, so a caller must check with
+//	QTParse_IsTrackSelfContained before trusting the samples of a track.
+//	All multi-byte values in a movie file are big-endian.
+//
+//////////
+
+//////////
+//
+// header files
+//
+//////////
+
+#include "QTParse.h"
+
+#if TARGET_RT_MAC_MACHO
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/param.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+
+//////////
+//
+// QTParse_OpenMovieFile
+// Map the specified movie file into memory and find its movie atom.
+//
+// If successful, theMovie is set to a new movie record, which the caller should eventually pass to
+// QTParse_CloseMovieFile.
+//
+//////////
+
+OSErr QTParse_OpenMovieFile (FSSpecPtr theFSSpecPtr, QTParseMoviePtr *theMovie)
+{
+	QTParseMoviePtr			myMovie = NULL;
+	QTParseSpan				myFile;
+	OSErr					myErr = noErr;
+
+	if ((theFSSpecPtr == NULL) || (theMovie == NULL))
+		return(paramErr);
+
+	*theMovie = NULL;
+
+	myMovie = (QTParseMoviePtr)NewPtrClear(sizeof(QTParseMovie));
+	if (myMovie == NULL)
+		return(memFullErr);
+
+	myErr = QTParse_MapFile(theFSSpecPtr, myMovie);
+	if (myErr != noErr)
+		goto bail;
+
+	// find the movie atom; this touches only the headers of the top-level atoms
+	myFile.fData = myMovie->fBase;
+	myFile.fSize = myMovie->fSize;
+
+	myErr = QTParse_FindAtom(&myFile, FOUR_CHAR_CODE('moov'), 1, &myMovie->fMovieAtom);
+
+bail:
+	if (myErr != noErr)
+		QTParse_CloseMovieFile(myMovie);
+	else
+		*theMovie = myMovie;
+
+	return(myErr);
+}
+
+
+//////////
+//
+// QTParse_CloseMovieFile
+// Unmap the specified movie file and dispose of the movie record.
+//
+// Any spans returned for this movie are no longer valid once this function returns.
+//
+//////////
+
+void QTParse_CloseMovieFile (QTParseMoviePtr theMovie)
+{
+	if (theMovie == NULL)
+		return;
+
+	QTParse_UnmapFile(theMovie);
+
+	if (theMovie->fTracks != NULL)
+		DisposePtr((Ptr)theMovie->fTracks);
+
+	DisposePtr((Ptr)theMovie);
+}
+
+
+//////////
+//
+// QTParse_GetTrackCount
+// Return the number of tracks in the specified movie, or 0 if the movie atom can't be parsed.
+//
+//////////
+
+long QTParse_GetTrackCount (QTParseMoviePtr theMovie)
+{
+	if (theMovie == NULL)
+		return(0L);
+
+	if (!theMovie->fMovieIsParsed)
+		if (QTParse_ParseMovieAtom(theMovie) != noErr)
+			return(0L);
+
+	return(theMovie->fNumTracks);
+}
+
+
+//////////
+//
+// QTParse_GetIndTrackType
+// Return the track with the specified index among the tracks of the specified media type (or among
+// all tracks, if theMediaType is kQTParseAnyMediaType); return NULL if there is no such track.
+//
+// Like GetMovieIndTrackType, the index is 1-based.
+//
+//////////
+
+QTParseTrackPtr QTParse_GetIndTrackType (QTParseMoviePtr theMovie, long theIndex, OSType theMediaType)
+{
+	long					myNumTracks = QTParse_GetTrackCount(theMovie);
+	long					myCount = 0L;
+	long					myTrack;
+
+	for (myTrack = 0; myTrack < myNumTracks; myTrack++) {
+		if ((theMediaType == kQTParseAnyMediaType) || (theMovie->fTracks[myTrack].fMediaType == theMediaType)) {
+			myCount++;
+			if (myCount == theIndex)
+				return(&theMovie->fTracks[myTrack]);
+		}
+	}
+
+	return(NULL);
+}
+
+
+//////////
+//
+// QTParse_GetSampleCount
+// Return the number of samples in the specified track, or 0 if the sample table can't be parsed.
+//
+//////////
+
+long QTParse_GetSampleCount (QTParseTrackPtr theTrack)
+{
+	if (theTrack == NULL)
+		return(0L);
+
+	if (!theTrack->fTableIsParsed)
+		if (QTParse_ParseSampleTable(theTrack) != noErr)
+			return(0L);
+
+	return(theTrack->fNumSamples);
+}
+
+
+//////////
+//
+// QTParse_GetSample
+// Get the location, timing, and flags of the specified sample (1-based) in the specified track.
+//
+// The sample data is returned in place (theSample->fBytes points into the file mapping); it remains valid
+// until the movie is closed. The caller must not write into it.
+//
+//////////
+
+OSErr QTParse_GetSample (QTParseMoviePtr theMovie, QTParseTrackPtr theTrack, long theSampleNum, QTParseSample *theSample)
+{
+	OSErr					myErr = noErr;
+
+	if ((theMovie == NULL) || (theTrack == NULL) || (theSample == NULL))
+		return(paramErr);
+
+	if (!theTrack->fTableIsParsed) {
+		myErr = QTParse_ParseSampleTable(theTrack);
+		if (myErr != noErr)
+			return(myErr);
+	}
+
+	if ((theSampleNum < 1) || (theSampleNum > theTrack->fNumSamples))
+		return(paramErr);
+
+	myErr = QTParse_FindSampleChunk(theMovie, theTrack, theSampleNum, theSample);
+	if (myErr != noErr)
+		return(myErr);
+
+	myErr = QTParse_FindSampleTime(theTrack, theSampleNum, theSample);
+	if (myErr != noErr)
+		return(myErr);
+
+	theSample->fIsSync = QTParse_IsSyncSample(theTrack, theSampleNum);
+
+	return(noErr);
+}
+
+
+//////////
+//
+// QTParse_GetSampleDescription
+// Get the sample description with the specified index (1-based) in the specified track.
+//
+// The sample description is returned in place, in big-endian format; it begins with the description's
+// size and data format, just like a SampleDescription record.
+//
+//////////
+
+OSErr QTParse_GetSampleDescription (QTParseTrackPtr theTrack, long theIndex, QTParseSpan *theDesc)
+{
+	const UInt8				*myEntry = NULL;
+	UInt32					myRemaining;
+	UInt32					mySize;
+	long					myCount;
+	OSErr					myErr = noErr;
+
+	if ((theTrack == NULL) || (theDesc == NULL))
+		return(paramErr);
+
+	if (!theTrack->fTableIsParsed) {
+		myErr = QTParse_ParseSampleTable(theTrack);
+		if (myErr != noErr)
+			return(myErr);
+	}
+
+	if ((theIndex < 1) || (theIndex > theTrack->fNumDescs))
+		return(paramErr);
+
+	// sample descriptions have varying sizes, so we need to walk the list
+	myEntry = theTrack->fDescTable.fData;
+	myRemaining = theTrack->fDescTable.fSize;
+
+	for (myCount = 1; ; myCount++) {
+		if (myRemaining < kQTParseAtomHeaderSize)
+			return(invalidMedia);
+
+		mySize = QTParse_GetLong(myEntry);
+		if ((mySize < kQTParseAtomHeaderSize) || (mySize > myRemaining))
+			return(invalidMedia);
+
+		if (myCount == theIndex)
+			break;
+
+		myEntry += mySize;
+		myRemaining -= mySize;
+	}
+
+	theDesc->fData = myEntry;
+	theDesc->fSize = mySize;
+
+	return(noErr);
+}
+
+
+//////////
+//
+// QTParse_IsTrackSelfContained
+// Are all the samples of the specified track in the movie file itself?
+//
+// That's so only if the track's data reference atom holds a single reference, to the movie file, and every
+// sample description uses it. A sample description has its data reference index right after its size, data
+// format, and six reserved bytes.
+//
+//////////
+
+Boolean QTParse_IsTrackSelfContained (QTParseTrackPtr theTrack)
+{
+	QTParseSpan				myDesc;
+	long					myIndex;
+
+	if ((theTrack == NULL) || !theTrack->fHasSelfRef)
+		return(false);
+
+	if (!theTrack->fTableIsParsed)
+		if (QTParse_ParseSampleTable(theTrack) != noErr)
+			return(false);
+
+	for (myIndex = 1; myIndex <= theTrack->fNumDescs; myIndex++) {
+		if (QTParse_GetSampleDescription(theTrack, myIndex, &myDesc) != noErr)
+			return(false);
+
+		if ((myDesc.fSize < 16) || (((myDesc.fData[14] << 8) | myDesc.fData[15]) != 1))
+			return(false);
+	}
+
+	return(true);
+}
+
+
+//////////
+//
+// QTParse_FindAtom
+// Find the child atom of the specified type and index (1-based) inside the specified span, which should
+// cover the contents of the parent atom (or the entire file, for top-level atoms).
+//
+// On return, theAtom covers the contents of the child atom, not including its header.
+//
+//////////
+
+OSErr QTParse_FindAtom (QTParseSpan *theParent, OSType theType, long theIndex, QTParseSpan *theAtom)
+{
+	const UInt8				*myAtom = theParent->fData;
+	UInt32					myRemaining = theParent->fSize;
+	UInt32					mySize;
+	UInt32					myHeaderSize;
+	long					myCount = 0L;
+
+	while (myRemaining >= kQTParseAtomHeaderSize) {
+		mySize = QTParse_GetLong(myAtom);
+		myHeaderSize = kQTParseAtomHeaderSize;
+
+		if (mySize == 1) {
+			// a 64-bit atom size follows the type; we can handle it only if the atom is smaller than 4 GB
+			if (myRemaining < kQTParseExtAtomHeaderSize)
+				return(invalidMovie);
+			if (QTParse_GetLong(myAtom + 8) != 0)
+				return(invalidMovie);
+
+			mySize = QTParse_GetLong(myAtom + 12);
+			myHeaderSize = kQTParseExtAtomHeaderSize;
+		} else if (mySize == 0) {
+			// the atom extends to the end of its container
+			mySize = myRemaining;
+		}
+
+		if ((mySize < myHeaderSize) || (mySize > myRemaining))
+			return(invalidMovie);
+
+		if (QTParse_GetLong(myAtom + 4) == theType) {
+			myCount++;
+			if (myCount == theIndex) {
+				theAtom->fData = myAtom + myHeaderSize;
+				theAtom->fSize = mySize - myHeaderSize;
+				return(noErr);
+			}
+		}
+
+		myAtom += mySize;
+		myRemaining -= mySize;
+	}
+
+	return(cannotFindAtomErr);
+}
+
+
+//////////
+//
+// QTParse_MapFile
+// Map the specified file into memory.
+//
+//////////
+
+static OSErr QTParse_MapFile (FSSpecPtr theFSSpecPtr, QTParseMoviePtr theMovie)
+{
+#if TARGET_OS_WIN32
+	char					myPath[MAX_PATH];
+	DWORD					mySizeHigh = 0;
+	DWORD					mySize;
+
+	theMovie->fFile = INVALID_HANDLE_VALUE;
+	theMovie->fMapping = NULL;
+
+	if (FSSpecToNativePathName(theFSSpecPtr, myPath, MAX_PATH, kFullNativePath) != noErr)
+		return(fnfErr);
+
+	theMovie->fFile = CreateFile(myPath, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+	if (theMovie->fFile == INVALID_HANDLE_VALUE)
+		return(fnfErr);
+
+	mySize = GetFileSize(theMovie->fFile, &mySizeHigh);
+	if ((mySize == 0xFFFFFFFF) || (mySizeHigh != 0) || (mySize == 0))
+		return(invalidMovie);
+
+	theMovie->fMapping = CreateFileMapping(theMovie->fFile, NULL, PAGE_READONLY, 0, 0, NULL);
+	if (theMovie->fMapping == NULL)
+		return(memFullErr);
+
+	theMovie->fBase = (const UInt8 *)MapViewOfFile(theMovie->fMapping, FILE_MAP_READ, 0, 0, 0);
+	if (theMovie->fBase == NULL)
+		return(memFullErr);
+
+	theMovie->fSize = mySize;
+
+	return(noErr);
+#elif TARGET_RT_MAC_MACHO
+	FSRef					myFSRef;
+	UInt8					myPath[PATH_MAX];
+	struct stat				myStat;
+	void					*myBase;
+	OSErr					myErr = noErr;
+
+	theMovie->fFile = -1;
+
+	myErr = FSpMakeFSRef(theFSSpecPtr, &myFSRef);
+	if (myErr != noErr)
+		return(myErr);
+
+	if (FSRefMakePath(&myFSRef, myPath, sizeof(myPath)) != noErr)
+		return(fnfErr);
+
+	theMovie->fFile = open((char *)myPath, O_RDONLY);
+	if (theMovie->fFile < 0)
+		return(fnfErr);
+
+	if ((fstat(theMovie->fFile, &myStat) != 0) || (myStat.st_size == 0) || (myStat.st_size > 0xFFFFFFFF))
+		return(invalidMovie);
+
+	myBase = mmap(NULL, (size_t)myStat.st_size, PROT_READ, MAP_SHARED, theMovie->fFile, 0);
+	if (myBase == MAP_FAILED)
+		return(memFullErr);
+
+	theMovie->fBase = (const UInt8 *)myBase;
+	theMovie->fSize = (UInt32)myStat.st_size;
+
+	return(noErr);
+#else
+	short					myRefNum = -1;
+	long					mySize = 0L;
+	OSErr					myErr = noErr;
+
+	theMovie->fBuffer = NULL;
+
+	myErr = FSpOpenDF(theFSSpecPtr, fsRdPerm, &myRefNum);
+	if (myErr != noErr)
+		return(myErr);
+
+	myErr = GetEOF(myRefNum, &mySize);
+	if ((myErr == noErr) && (mySize == 0))
+		myErr = invalidMovie;
+
+	if (myErr == noErr) {
+		theMovie->fBuffer = NewPtr(mySize);
+		if (theMovie->fBuffer == NULL)
+			myErr = memFullErr;
+	}
+
+	if (myErr == noErr)
+		myErr = FSRead(myRefNum, &mySize, theMovie->fBuffer);
+
+	FSClose(myRefNum);
+
+	if (myErr == noErr) {
+		theMovie->fBase = (const UInt8 *)theMovie->fBuffer;
+		theMovie->fSize = (UInt32)mySize;
+	}
+
+	return(myErr);
+#endif
+}
+
+
+//////////
+//
+// QTParse_UnmapFile
+// Unmap the file mapped by QTParse_MapFile; this works for partially mapped files, too.
+//
+//////////
+
+static void QTParse_UnmapFile (QTParseMoviePtr theMovie)
+{
+#if TARGET_OS_WIN32
+	if (theMovie->fBase != NULL)
+		UnmapViewOfFile((LPCVOID)theMovie->fBase);
+
+	if (theMovie->fMapping != NULL)
+		CloseHandle(theMovie->fMapping);
+
+	if ((theMovie->fFile != NULL) && (theMovie->fFile != INVALID_HANDLE_VALUE))
+		CloseHandle(theMovie->fFile);
+
+	theMovie->fMapping = NULL;
+	theMovie->fFile = INVALID_HANDLE_VALUE;
+#elif TARGET_RT_MAC_MACHO
+	if (theMovie->fBase != NULL)
+		munmap((void *)theMovie->fBase, theMovie->fSize);
+
+	if (theMovie->fFile >= 0)
+		close(theMovie->fFile);
+
+	theMovie->fFile = -1;
+#else
+	if (theMovie->fBuffer != NULL)
+		DisposePtr(theMovie->fBuffer);
+
+	theMovie->fBuffer = NULL;
+#endif
+
+	theMovie->fBase = NULL;
+	theMovie->fSize = 0;
+}
+
+
+//////////
+//
+// QTParse_ParseMovieAtom
+// Find the movie header and the track atoms in the movie atom.
+//
+//////////
+
+static OSErr QTParse_ParseMovieAtom (QTParseMoviePtr theMovie)
+{
+	QTParseSpan				myHeader;
+	QTParseSpan				myTrackAtom;
+	QTParseSpan				myUnused;
+	long					myNumTracks = 0L;
+	long					myIndex;
+	OSErr					myErr = noErr;
+
+	// we don't handle compressed movie atoms
+	if (QTParse_FindAtom(&theMovie->fMovieAtom, FOUR_CHAR_CODE('cmov'), 1, &myUnused) == noErr)
+		return(invalidMovie);
+
+	// get the movie time scale and duration from the movie header atom
+	myErr = QTParse_FindAtom(&theMovie->fMovieAtom, FOUR_CHAR_CODE('mvhd'), 1, &myHeader);
+	if (myErr != noErr)
+		return(myErr);
+
+	if ((myHeader.fSize >= 20) && (myHeader.fData[0] == 0)) {
+		theMovie->fTimeScale = QTParse_GetLong(myHeader.fData + 12);
+		theMovie->fDuration = QTParse_GetLong(myHeader.fData + 16);
+	} else if ((myHeader.fSize >= 32) && (myHeader.fData[0] == 1)) {
+		theMovie->fTimeScale = QTParse_GetLong(myHeader.fData + 20);
+		theMovie->fDuration = QTParse_GetLong(myHeader.fData + 28);
+	} else {
+		return(invalidMovie);
+	}
+
+	// count the track atoms
+	while (QTParse_FindAtom(&theMovie->fMovieAtom, FOUR_CHAR_CODE('trak'), myNumTracks + 1, &myTrackAtom) == noErr)
+		myNumTracks++;
+
+	if (myNumTracks > 0) {
+		theMovie->fTracks = (QTParseTrackPtr)NewPtrClear(myNumTracks * sizeof(QTParseTrack));
+		if (theMovie->fTracks == NULL)
+			return(memFullErr);
+	}
+
+	// parse the header atoms of each track; we leave the sample tables for later
+	for (myIndex = 0; myIndex < myNumTracks; myIndex++) {
+		QTParse_FindAtom(&theMovie->fMovieAtom, FOUR_CHAR_CODE('trak'), myIndex + 1, &myTrackAtom);
+
+		myErr = QTParse_ParseTrackAtom(&myTrackAtom, &theMovie->fTracks[myIndex]);
+		if (myErr != noErr)
+			return(myErr);
+	}
+
+	theMovie->fNumTracks = myNumTracks;
+	theMovie->fMovieIsParsed = true;
+
+	return(noErr);
+}
+
+
+//////////
+//
+// QTParse_ParseTrackAtom
+// Get the track ID, dimensions, media type, time scale, and duration of the specified track atom,
+// and find its sample table atom.
+//
+//////////
+
+static OSErr QTParse_ParseTrackAtom (QTParseSpan *theTrackAtom, QTParseTrackPtr theTrack)
+{
+	QTParseSpan				myHeader;
+	QTParseSpan				myMedia;
+	QTParseSpan				myMediaInfo;
+	OSErr					myErr = noErr;
+
+	// the track header atom
+	myErr = QTParse_FindAtom(theTrackAtom, FOUR_CHAR_CODE('tkhd'), 1, &myHeader);
+	if (myErr != noErr)
+		return(myErr);
+
+	if ((myHeader.fSize >= 84) && (myHeader.fData[0] == 0)) {
+		theTrack->fTrackID = QTParse_GetLong(myHeader.fData + 12);
+		theTrack->fWidth = (short)(QTParse_GetLong(myHeader.fData + 76) >> 16);
+		theTrack->fHeight = (short)(QTParse_GetLong(myHeader.fData + 80) >> 16);
+	} else if ((myHeader.fSize >= 96) && (myHeader.fData[0] == 1)) {
+		theTrack->fTrackID = QTParse_GetLong(myHeader.fData + 20);
+		theTrack->fWidth = (short)(QTParse_GetLong(myHeader.fData + 88) >> 16);
+		theTrack->fHeight = (short)(QTParse_GetLong(myHeader.fData + 92) >> 16);
+	} else {
+		return(invalidTrack);
+	}
+
+	// the media atom
+	myErr = QTParse_FindAtom(theTrackAtom, FOUR_CHAR_CODE('mdia'), 1, &myMedia);
+	if (myErr != noErr)
+		return(myErr);
+
+	myErr = QTParse_FindAtom(&myMedia, FOUR_CHAR_CODE('mdhd'), 1, &myHeader);
+	if (myErr != noErr)
+		return(myErr);
+
+	if ((myHeader.fSize >= 20) && (myHeader.fData[0] == 0)) {
+		theTrack->fTimeScale = QTParse_GetLong(myHeader.fData + 12);
+		theTrack->fDuration = QTParse_GetLong(myHeader.fData + 16);
+	} else if ((myHeader.fSize >= 32) && (myHeader.fData[0] == 1)) {
+		theTrack->fTimeScale = QTParse_GetLong(myHeader.fData + 20);
+		theTrack->fDuration = QTParse_GetLong(myHeader.fData + 28);
+	} else {
+		return(invalidMedia);
+	}
+
+	// the media handler atom; its component subtype is the media type
+	myErr = QTParse_FindAtom(&myMedia, FOUR_CHAR_CODE('hdlr'), 1, &myHeader);
+	if (myErr != noErr)
+		return(myErr);
+
+	if (myHeader.fSize < 12)
+		return(invalidMedia);
+
+	theTrack->fMediaType = QTParse_GetLong(myHeader.fData + 8);
+
+	// the sample table atom
+	myErr = QTParse_FindAtom(&myMedia, FOUR_CHAR_CODE('minf'), 1, &myMediaInfo);
+	if (myErr != noErr)
+		return(myErr);
+
+	theTrack->fHasSelfRef = QTParse_HasSelfRef(&myMediaInfo);
+
+	return(QTParse_FindAtom(&myMediaInfo, FOUR_CHAR_CODE('stbl'), 1, &theTrack->fSampleTable));
+}
+
+
+//////////
+//
+// QTParse_HasSelfRef
+// Does the data reference atom in the specified media information atom hold a single reference, which is to
+// the movie file itself?
+//
+// The data reference atom is a full atom with an entry count, followed by the entries; each entry is itself a
+// full atom, whose flags have the self-reference bit set if it refers to the file that holds it.
+//
+//////////
+
+static Boolean QTParse_HasSelfRef (QTParseSpan *theMediaInfo)
+{
+	QTParseSpan				myDataInfo;
+	QTParseSpan				myDataRefs;
+	UInt32					mySize;
+
+	if (QTParse_FindAtom(theMediaInfo, FOUR_CHAR_CODE('dinf'), 1, &myDataInfo) != noErr)
+		return(false);
+
+	if (QTParse_FindAtom(&myDataInfo, FOUR_CHAR_CODE('dref'), 1, &myDataRefs) != noErr)
+		return(false);
+
+	if ((myDataRefs.fSize < kQTParseFullAtomHeaderSize + 4 + kQTParseAtomHeaderSize + kQTParseFullAtomHeaderSize) ||
+		(QTParse_GetLong(myDataRefs.fData + kQTParseFullAtomHeaderSize) != 1))
+		return(false);
+
+	// the one entry must fit in the atom and be a self-reference
+	mySize = QTParse_GetLong(myDataRefs.fData + kQTParseFullAtomHeaderSize + 4);
+	if ((mySize < kQTParseAtomHeaderSize + kQTParseFullAtomHeaderSize) || (mySize > myDataRefs.fSize - kQTParseFullAtomHeaderSize - 4))
+		return(false);
+
+	return((QTParse_GetLong(myDataRefs.fData + kQTParseFullAtomHeaderSize + 4 + kQTParseAtomHeaderSize) & 0x00000001) != 0);
+}
+
+
+//////////
+//
+// QTParse_ParseSampleTable
+// Find the tables in the sample table atom of the specified track, and reset the track's cursors.
+//
+//////////
+
+static OSErr QTParse_ParseSampleTable (QTParseTrackPtr theTrack)
+{
+	QTParseSpan				mySizeAtom;
+	OSErr					myErr = noErr;
+
+	// sample descriptions
+	myErr = QTParse_GetTable(&theTrack->fSampleTable, FOUR_CHAR_CODE('stsd'), 8, 0, &theTrack->fDescTable, &theTrack->fNumDescs);
+	if (myErr != noErr)
+		return(myErr);
+
+	// time-to-sample
+	myErr = QTParse_GetTable(&theTrack->fSampleTable, FOUR_CHAR_CODE('stts'), 8, 8, &theTrack->fTimeTable, &theTrack->fNumTimeEntries);
+	if (myErr != noErr)
+		return(myErr);
+
+	// sample-to-chunk
+	myErr = QTParse_GetTable(&theTrack->fSampleTable, FOUR_CHAR_CODE('stsc'), 8, 12, &theTrack->fChunkTable, &theTrack->fNumChunkEntries);
+	if (myErr != noErr)
+		return(myErr);
+
+	// sample sizes; this atom has an extra field (the constant sample size) before the count
+	myErr = QTParse_FindAtom(&theTrack->fSampleTable, FOUR_CHAR_CODE('stsz'), 1, &mySizeAtom);
+	if (myErr != noErr)
+		return(myErr);
+
+	if (mySizeAtom.fSize < 12)
+		return(invalidMedia);
+
+	theTrack->fSampleSize = QTParse_GetLong(mySizeAtom.fData + 4);
+	theTrack->fNumSamples = QTParse_GetLong(mySizeAtom.fData + 8);
+	theTrack->fSizeTable.fData = mySizeAtom.fData + 12;
+	theTrack->fSizeTable.fSize = 0;
+
+	if (theTrack->fSampleSize == 0) {
+		if ((theTrack->fNumSamples < 0) || ((UInt32)theTrack->fNumSamples > (mySizeAtom.fSize - 12) / 4))
+			return(invalidMedia);
+
+		theTrack->fSizeTable.fSize = theTrack->fNumSamples * 4;
+	}
+
+	// chunk offsets; these are either 32-bit or 64-bit values
+	theTrack->fHas64BitOffsets = false;
+	myErr = QTParse_GetTable(&theTrack->fSampleTable, FOUR_CHAR_CODE('stco'), 8, 4, &theTrack->fOffsetTable, &theTrack->fNumChunks);
+	if (myErr == cannotFindAtomErr) {
+		theTrack->fHas64BitOffsets = true;
+		myErr = QTParse_GetTable(&theTrack->fSampleTable, FOUR_CHAR_CODE('co64'), 8, 8, &theTrack->fOffsetTable, &theTrack->fNumChunks);
+	}
+	if (myErr != noErr)
+		return(myErr);
+
+	// sync samples; if there is no sync sample atom, every sample is a sync sample
+	myErr = QTParse_GetTable(&theTrack->fSampleTable, FOUR_CHAR_CODE('stss'), 8, 4, &theTrack->fSyncTable, &theTrack->fNumSyncEntries);
+	if (myErr == cannotFindAtomErr) {
+		theTrack->fSyncTable.fSize = 0;
+		theTrack->fNumSyncEntries = 0L;
+		myErr = noErr;
+	}
+	if (myErr != noErr)
+		return(myErr);
+
+	// a track with samples must have some way of finding them
+	if ((theTrack->fNumSamples > 0) && ((theTrack->fNumTimeEntries == 0) || (theTrack->fNumChunkEntries == 0) || (theTrack->fNumChunks == 0)))
+		return(invalidMedia);
+
+	// reset the cursors
+	theTrack->fChunkEntry = 0L;
+	theTrack->fChunk = 1L;
+	theTrack->fChunkFirstSample = 1L;
+	theTrack->fCursorSample = 1L;
+	theTrack->fCursorOffset = 0L;
+	theTrack->fTimeEntry = 0L;
+	theTrack->fTimeFirstSample = 1L;
+	theTrack->fTimeEntryStart = 0L;
+
+	theTrack->fTableIsParsed = true;
+
+	return(noErr);
+}
+
+
+//////////
+//
+// QTParse_GetTable
+// Find the table atom of the specified type in the specified sample table atom. Each of these atoms has
+// theHeaderSize bytes (the version, flags, and entry count) before the entries, which are theEntrySize
+// bytes each (or vary in size, if theEntrySize is 0).
+//
+// On return, theTable covers just the entries.
+//
+//////////
+
+static OSErr QTParse_GetTable (QTParseSpan *theSampleTable, OSType theType, long theHeaderSize, long theEntrySize, QTParseSpan *theTable, long *theCount)
+{
+	QTParseSpan				myAtom;
+	UInt32					myCount;
+	OSErr					myErr = noErr;
+
+	myErr = QTParse_FindAtom(theSampleTable, theType, 1, &myAtom);
+	if (myErr != noErr)
+		return(myErr);
+
+	if (myAtom.fSize < (UInt32)theHeaderSize)
+		return(invalidMedia);
+
+	myCount = QTParse_GetLong(myAtom.fData + theHeaderSize - 4);
+
+	theTable->fData = myAtom.fData + theHeaderSize;
+	theTable->fSize = myAtom.fSize - theHeaderSize;
+
+	// make sure the table really holds as many entries as it says it does
+	if (theEntrySize > 0) {
+		if (myCount > theTable->fSize / theEntrySize)
+			return(invalidMedia);
+
+		theTable->fSize = myCount * theEntrySize;
+	} else if (myCount > 0x7FFFFFFF) {
+		return(invalidMedia);
+	}
+
+	*theCount = (long)myCount;
+
+	return(noErr);
+}
+
+
+//////////
+//
+// QTParse_FindSampleChunk
+// Find the data for the specified sample, using the sample-to-chunk, chunk offset, and sample size tables.
+// Also get the sample description index.
+//
+// We remember the chunk we found and the offset of the sample within that chunk, so that finding the next
+// sample is cheap. Moving backwards restarts the search from the first chunk.
+//
+//////////
+
+static OSErr QTParse_FindSampleChunk (QTParseMoviePtr theMovie, QTParseTrackPtr theTrack, long theSampleNum, QTParseSample *theSample)
+{
+	const UInt8				*myEntry = NULL;
+	long					mySamplesPerChunk;
+	long					myNextFirstChunk;
+	UInt32					myChunkOffset;
+	UInt32					mySize;
+
+	// restart from the beginning if the sample precedes the current chunk
+	if (theSampleNum < theTrack->fChunkFirstSample) {
+		theTrack->fChunkEntry = 0L;
+		theTrack->fChunk = 1L;
+		theTrack->fChunkFirstSample = 1L;
+		theTrack->fCursorSample = 1L;
+		theTrack->fCursorOffset = 0L;
+	}
+
+	// step forward, one chunk at a time, until we reach the chunk that holds the sample
+	for (;;) {
+		myEntry = theTrack->fChunkTable.fData + (theTrack->fChunkEntry * 12);
+		mySamplesPerChunk = QTParse_GetLong(myEntry + 4);
+		if (mySamplesPerChunk <= 0)
+			return(invalidMedia);
+
+		if (theSampleNum < theTrack->fChunkFirstSample + mySamplesPerChunk)
+			break;
+
+		theTrack->fChunkFirstSample += mySamplesPerChunk;
+		theTrack->fChunk++;
+		theTrack->fCursorSample = theTrack->fChunkFirstSample;
+		theTrack->fCursorOffset = 0L;
+
+		if (theTrack->fChunk > theTrack->fNumChunks)
+			return(invalidMedia);
+
+		// move to the next sample-to-chunk entry, if this chunk begins it
+		if (theTrack->fChunkEntry + 1 < theTrack->fNumChunkEntries) {
+			myNextFirstChunk = QTParse_GetLong(myEntry + 12);
+			if (theTrack->fChunk >= myNextFirstChunk)
+				theTrack->fChunkEntry++;
+		}
+	}
+
+	// step forward, one sample at a time, to the sample within the chunk
+	if (theSampleNum < theTrack->fCursorSample) {
+		theTrack->fCursorSample = theTrack->fChunkFirstSample;
+		theTrack->fCursorOffset = 0L;
+	}
+
+	while (theTrack->fCursorSample < theSampleNum) {
+		theTrack->fCursorOffset += QTParse_GetSampleSize(theTrack, theTrack->fCursorSample);
+		theTrack->fCursorSample++;
+	}
+
+	// get the offset of the chunk; we can't reach data past 4 GB
+	if (theTrack->fHas64BitOffsets) {
+		if (QTParse_GetLong(theTrack->fOffsetTable.fData + ((theTrack->fChunk - 1) * 8)) != 0)
+			return(invalidMedia);
+
+		myChunkOffset = QTParse_GetLong(theTrack->fOffsetTable.fData + ((theTrack->fChunk - 1) * 8) + 4);
+	} else {
+		myChunkOffset = QTParse_GetLong(theTrack->fOffsetTable.fData + ((theTrack->fChunk - 1) * 4));
+	}
+
+	mySize = QTParse_GetSampleSize(theTrack, theSampleNum);
+
+	// make sure the sample lies entirely within the file
+	if ((myChunkOffset > theMovie->fSize) || (theTrack->fCursorOffset > theMovie->fSize - myChunkOffset) ||
+		(mySize > theMovie->fSize - myChunkOffset - theTrack->fCursorOffset))
+		return(invalidMedia);
+
+	theSample->fOffset = myChunkOffset + theTrack->fCursorOffset;
+	theSample->fBytes.fData = theMovie->fBase + theSample->fOffset;
+	theSample->fBytes.fSize = mySize;
+	theSample->fDescIndex = QTParse_GetLong(myEntry + 8);
+
+	return(noErr);
+}
+
+
+//////////
+//
+// QTParse_FindSampleTime
+// Find the decode time and duration of the specified sample, using the time-to-sample table.
+//
+// As with QTParse_FindSampleChunk, we remember where we were, so that finding the next sample is cheap.
+//
+//////////
+
+static OSErr QTParse_FindSampleTime (QTParseTrackPtr theTrack, long theSampleNum, QTParseSample *theSample)
+{
+	const UInt8				*myEntry = NULL;
+	long					myCount;
+	TimeValue				myDelta;
+
+	if (theSampleNum < theTrack->fTimeFirstSample) {
+		theTrack->fTimeEntry = 0L;
+		theTrack->fTimeFirstSample = 1L;
+		theTrack->fTimeEntryStart = 0L;
+	}
+
+	for (;;) {
+		if (theTrack->fTimeEntry >= theTrack->fNumTimeEntries)
+			return(invalidMedia);
+
+		myEntry = theTrack->fTimeTable.fData + (theTrack->fTimeEntry * 8);
+		myCount = QTParse_GetLong(myEntry);
+		myDelta = QTParse_GetLong(myEntry + 4);
+
+		if (theSampleNum < theTrack->fTimeFirstSample + myCount)
+			break;
+
+		theTrack->fTimeFirstSample += myCount;
+		theTrack->fTimeEntryStart += myCount * myDelta;
+		theTrack->fTimeEntry++;
+	}
+
+	theSample->fDecodeTime = theTrack->fTimeEntryStart + ((theSampleNum - theTrack->fTimeFirstSample) * myDelta);
+	theSample->fDuration = myDelta;
+
+	return(noErr);
+}
+
+
+//////////
+//
+// QTParse_IsSyncSample
+// Is the specified sample a sync sample?
+//
+// The sync sample table is sorted, so we use a binary search.
+//
+//////////
+
+static Boolean QTParse_IsSyncSample (QTParseTrackPtr theTrack, long theSampleNum)
+{
+	long					myLow = 0L;
+	long					myHigh = theTrack->fNumSyncEntries - 1;
+	long					myMiddle;
+	long					mySyncSample;
+
+	if (theTrack->fSyncTable.fSize == 0)
+		return(true);
+
+	while (myLow <= myHigh) {
+		myMiddle = (myLow + myHigh) / 2;
+		mySyncSample = QTParse_GetLong(theTrack->fSyncTable.fData + (myMiddle * 4));
+
+		if (mySyncSample == theSampleNum)
+			return(true);
+
+		if (mySyncSample < theSampleNum)
+			myLow = myMiddle + 1;
+		else
+			myHigh = myMiddle - 1;
+	}
+
+	return(false);
+}
+
+
+//////////
+//
+// QTParse_GetSampleSize
+// Return the size of the specified sample.
+//
+//////////
+
+static UInt32 QTParse_GetSampleSize (QTParseTrackPtr theTrack, long theSampleNum)
+{
+	if (theTrack->fSampleSize != 0)
+		return(theTrack->fSampleSize);
+
+	return(QTParse_GetLong(theTrack->fSizeTable.fData + ((theSampleNum - 1) * 4)));
+}
+
+
+//////////
+//
+// QTParse_GetLong
+// Return the big-endian 32-bit value at the specified address, in native format.
+//
+//////////
+
+static UInt32 QTParse_GetLong (const UInt8 *theBytes)
+{
+	return(((UInt32)theBytes[0] << 24) | ((UInt32)theBytes[1] << 16) | ((UInt32)theBytes[2] << 8) | (UInt32)theBytes[3]);
+}
@@ -0,0 +1,166 @@
+//////////
+//
+//	File:		QTParse.h
+//
+//	Contains:	A lightweight reader for QuickTime movie files, which maps the file into memory and
+//				returns movie samples in place, without using the Movie Toolbox.
+//				All utilities start with the prefix "QTParse_".
+//
+//	Written by:	Tim Monroe
+//
+//	Copyright:	 2000 by Apple Computer, Inc., all rights reserved.
+//
+//	Change History (most recent first):
+//
+//	   <4>	 	11/13/26	rtm		added QTParse_IsTrackSelfContained
+//	   <3>	 	11/13/26	rtm		removed the sample page index
+//	   <2>	 	10/24/26	rtm		added the sample page index, for random access into long tracks
+//	   <1>	 	10/23/26	rtm		first file
+//
+//////////
+
+#pragma once
+
+
+//////////
+//
+// header files
+//
+//////////
+
+#ifndef __QTParse__
+#define __QTParse__
+
+#ifndef __MOVIES__
+#include <Movies.h>
+#endif
+
+#if TARGET_OS_WIN32
+#include <windows.h>
+#endif
+
+
+//////////
+//
+// constants
+//
+//////////
+
+#define kQTParseAtomHeaderSize			8			// size of an atom's size and type fields
+#define kQTParseExtAtomHeaderSize		16			// size of an atom header that includes a 64-bit size
+#define kQTParseFullAtomHeaderSize		4			// size of the version and flags fields of a "full" atom
+
+#define kQTParseAnyMediaType			0L			// pass to QTParse_GetIndTrackType to get tracks of any media type
+
+
+//////////
+//
+// data types
+//
+//////////
+
+// a range of bytes inside the file mapping; nothing in a span is ever copied
+typedef struct QTParseSpan {
+	const UInt8						*fData;
+	UInt32							fSize;
+} QTParseSpan;
+
+// a single media sample
+typedef struct QTParseSample {
+	QTParseSpan						fBytes;				// the sample data, in place in the file mapping
+	UInt32							fOffset;			// the offset of the sample data in the file
+	TimeValue						fDecodeTime;		// the media time of the sample
+	TimeValue						fDuration;			// the duration of the sample, in media time units
+	long							fDescIndex;			// the index of the sample's sample description (1-based)
+	Boolean							fIsSync;			// is this a sync (key) sample?
+} QTParseSample;
+
+// a track; the sample table is parsed the first time a sample is requested
+typedef struct QTParseTrack {
+	long							fTrackID;
+	OSType							fMediaType;			// the media type (from the media handler atom)
+	TimeScale						fTimeScale;			// the media time scale
+	TimeValue						fDuration;			// the media duration
+	short							fWidth;				// the track dimensions (from the track header atom)
+	short							fHeight;
+	QTParseSpan						fSampleTable;		// the sample table atom
+	Boolean							fHasSelfRef;		// is the track's only data reference the movie file itself?
+	Boolean							fTableIsParsed;
+
+	// the tables in the sample table atom; each span covers just the table entries
+	QTParseSpan						fDescTable;			// sample descriptions
+	QTParseSpan						fTimeTable;			// time-to-sample
+	QTParseSpan						fChunkTable;		// sample-to-chunk
+	QTParseSpan						fSizeTable;			// sample sizes (empty if all samples are the same size)
+	QTParseSpan						fOffsetTable;		// chunk offsets
+	QTParseSpan						fSyncTable;			// sync samples (empty if all samples are sync samples)
+	Boolean							fHas64BitOffsets;	// are the chunk offsets 64-bit values?
+	long							fNumDescs;
+	long							fNumTimeEntries;
+	long							fNumChunkEntries;
+	long							fNumSamples;
+	long							fSampleSize;		// the size of every sample, or 0 if they differ
+	long							fNumChunks;
+	long							fNumSyncEntries;
+
+	// cursors that make sequential access cheap; see QTParse_FindSampleChunk and QTParse_FindSampleTime
+	long							fChunkEntry;		// the sample-to-chunk entry that covers fChunk (0-based)
+	long							fChunk;				// the chunk that holds fCursorSample (1-based)
+	long							fChunkFirstSample;	// the first sample in fChunk
+	long							fCursorSample;		// a sample in fChunk
+	UInt32							fCursorOffset;		// the offset of fCursorSample from the start of fChunk
+	long							fTimeEntry;			// the time-to-sample entry that covers fTimeFirstSample (0-based)
+	long							fTimeFirstSample;	// the first sample covered by fTimeEntry
+	TimeValue						fTimeEntryStart;	// the media time of fTimeFirstSample
+} QTParseTrack, *QTParseTrackPtr;
+
+// a movie file
+typedef struct QTParseMovie {
+	const UInt8						*fBase;				// the start of the file mapping
+	UInt32							fSize;				// the size of the file mapping
+#if TARGET_OS_WIN32
+	HANDLE							fFile;
+	HANDLE							fMapping;
+#elif TARGET_RT_MAC_MACHO
+	int								fFile;
+#else
+	Ptr								fBuffer;
+#endif
+	QTParseSpan						fMovieAtom;			// the movie atom
+	Boolean							fMovieIsParsed;
+	TimeScale						fTimeScale;			// the movie time scale
+	TimeValue						fDuration;			// the movie duration
+	long							fNumTracks;
+	QTParseTrackPtr					fTracks;
+} QTParseMovie, *QTParseMoviePtr;
+
+
+//////////
+//
+// function prototypes
+//
+//////////
+
+OSErr							QTParse_OpenMovieFile (FSSpecPtr theFSSpecPtr, QTParseMoviePtr *theMovie);
+void							QTParse_CloseMovieFile (QTParseMoviePtr theMovie);
+long							QTParse_GetTrackCount (QTParseMoviePtr theMovie);
+QTParseTrackPtr					QTParse_GetIndTrackType (QTParseMoviePtr theMovie, long theIndex, OSType theMediaType);
+long							QTParse_GetSampleCount (QTParseTrackPtr theTrack);
+OSErr							QTParse_GetSample (QTParseMoviePtr theMovie, QTParseTrackPtr theTrack, long theSampleNum, QTParseSample *theSample);
+OSErr							QTParse_GetSampleDescription (QTParseTrackPtr theTrack, long theIndex, QTParseSpan *theDesc);
+Boolean							QTParse_IsTrackSelfContained (QTParseTrackPtr theTrack);
+OSErr							QTParse_FindAtom (QTParseSpan *theParent, OSType theType, long theIndex, QTParseSpan *theAtom);
+static OSErr					QTParse_MapFile (FSSpecPtr theFSSpecPtr, QTParseMoviePtr theMovie);
+static void						QTParse_UnmapFile (QTParseMoviePtr theMovie);
+static OSErr					QTParse_ParseMovieAtom (QTParseMoviePtr theMovie);
+static OSErr					QTParse_ParseTrackAtom (QTParseSpan *theTrackAtom, QTParseTrackPtr theTrack);
+static Boolean					QTParse_HasSelfRef (QTParseSpan *theMediaInfo);
+static OSErr					QTParse_ParseSampleTable (QTParseTrackPtr theTrack);
+static OSErr					QTParse_GetTable (QTParseSpan *theSampleTable, OSType theType, long theHeaderSize, long theEntrySize, QTParseSpan *theTable, long *theCount);
+static OSErr					QTParse_FindSampleChunk (QTParseMoviePtr theMovie, QTParseTrackPtr theTrack, long theSampleNum, QTParseSample *theSample);
+static OSErr					QTParse_FindSampleTime (QTParseTrackPtr theTrack, long theSampleNum, QTParseSample *theSample);
+static Boolean					QTParse_IsSyncSample (QTParseTrackPtr theTrack, long theSampleNum);
+static UInt32					QTParse_GetSampleSize (QTParseTrackPtr theTrack, long theSampleNum);
+static UInt32					QTParse_GetLong (const UInt8 *theBytes);
+
+#endif	// __QTParse__
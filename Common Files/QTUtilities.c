@@ -13,6 +13,13 @@
 //
 //	Change History (most recent first):
 //
+//	   <40>	 	11/13/26	rtm		QTUtils_ClassifyAtoms stops at an atom that runs past the bytes it was given
+//	   <39>	 	11/13/26	rtm		added QTUtils_HasIdleManager
+//	   <38>	 	10/24/26	rtm		added QTUtils_HasAsyncMovieLoading, QTUtils_GetMovieLoadState, and
+//									QTUtils_WaitForMovieLoadState
+//	   <37>	 	10/23/26	rtm		QTUtils_GetFrameDuration now uses GetMediaNextInterestingTime instead of GetMediaSample
+//	   <36>	 	10/18/26	rtm		added QTUtils_SniffFileSignature; QTUtils_IsImageFile and QTUtils_IsMovieFile
+//									now consult the file's signature before instantiating any importers
 //	   <35>	 	09/29/00	rtm		added QTUtils_IsAutoPlayMovie
 //	   <34>	 	04/28/00	rtm		fixed bug in QTUtils_AddUserDataTextToMovie (had a script system, not a region code)
 //	   <33>	 	03/08/00	rtm		removed QTUtils_SaveMovie and QTUtils_PrintMoviePICT
@@ -228,6 +235,84 @@ Boolean QTUtils_HasWiredSprites (void)
 }
 
 
+//////////
+//
+// QTUtils_HasAsyncMovieLoading
+// Does the installed version of QuickTime support asynchronous movie loading (newMovieAsyncOK)?
+//
+//////////
+
+Boolean QTUtils_HasAsyncMovieLoading (void) 
+{
+	return(((QTUtils_GetQTVersion() >> 16) & 0xffff) >= kQTAsyncLoadingMinVers);
+}
+
+
+//////////
+//
+// QTUtils_HasIdleManager
+// Does the installed version of QuickTime support the Idle Manager (QTGetTimeUntilNextTask)?
+//
+//////////
+
+Boolean QTUtils_HasIdleManager (void) 
+{
+	return(((QTUtils_GetQTVersion() >> 16) & 0xffff) >= kQTIdleManagerMinVers);
+}
+
+
+//////////
+//
+// QTUtils_GetMovieLoadState
+// Get the load state of the specified movie.
+//
+// Versions of QuickTime that don't support asynchronous movie loading always load a movie completely
+// before returning it, so we return kMovieLoadStateComplete for them.
+//
+//////////
+
+long QTUtils_GetMovieLoadState (Movie theMovie) 
+{
+	if (theMovie == NULL)
+		return(kMovieLoadStateError);
+
+	if (!QTUtils_HasAsyncMovieLoading())
+		return(kMovieLoadStateComplete);
+
+	return(GetMovieLoadState(theMovie));
+}
+
+
+//////////
+//
+// QTUtils_WaitForMovieLoadState
+// Task the specified movie until its load state reaches theLoadState.
+//
+// Note that this blocks the caller; use it only when there's nothing useful to do until the movie is loaded
+// (for instance, before walking through all of the frames of a movie).
+//
+//////////
+
+OSErr QTUtils_WaitForMovieLoadState (Movie theMovie, long theLoadState) 
+{
+	long		myLoadState = QTUtils_GetMovieLoadState(theMovie);
+	OSErr		myErr = noErr;
+
+	while ((myLoadState != kMovieLoadStateError) && (myLoadState < theLoadState)) {
+		MoviesTask(theMovie, 0);
+		myLoadState = QTUtils_GetMovieLoadState(theMovie);
+	}
+
+	if (myLoadState == kMovieLoadStateError) {
+		myErr = (theMovie != NULL) ? GetMovieStatus(theMovie, NULL) : paramErr;
+		if (myErr == noErr)
+			myErr = invalidMovie;
+	}
+
+	return(myErr);
+}
+
+
 //////////
 //
 // QTUtils_IsQTVRMovie
@@ -1331,16 +1416,372 @@ char *QTUtils_MakeTrackNameByType (Track theTrack)
 }
 
 
+//////////
+//
+// QTUtils_SniffFileSignature
+// Classify the specified file by looking at the signature bytes at the start of its data fork.
+//
+// We read the first kQTUtilsSniffBufferSize bytes of the file exactly once and compare them against the
+// headers of the common container and image formats. This is a great deal cheaper than instantiating
+// a movie importer or a graphics importer just to find out whether one exists. If the header is not one
+// we recognize, theFileKind is set to kQTUtilsFileKindUnknown and the caller should fall back to asking
+// QuickTime (that is, to calling GetGraphicsImporterForFile or GetMovieImporterForDataRef).
+//
+// The theFileFormat parameter (which may be NULL) returns a four-character code identifying the format,
+// or 0L if the format was not recognized.
+//
+//////////
+
+OSErr QTUtils_SniffFileSignature (FSSpec *theFSSpec, short *theFileKind, OSType *theFileFormat)
+{
+	UInt8			*myBuffer = NULL;
+	long			myCount = kQTUtilsSniffBufferSize;
+	short			myRefNum = -1;
+	short			myKind = kQTUtilsFileKindUnknown;
+	OSType			myFormat = 0L;
+	OSErr			myErr = noErr;
+
+	if ((theFSSpec == NULL) || (theFileKind == NULL))
+		return(paramErr);
+
+	myBuffer = (UInt8 *)NewPtrClear(kQTUtilsSniffBufferSize);
+	if (myBuffer == NULL) {
+		myErr = memFullErr;
+		goto bail;
+	}
+
+	myErr = FSpOpenDF(theFSSpec, fsRdPerm, &myRefNum);
+	if (myErr != noErr)
+		goto bail;
+
+	// a short file is not an error; we just have fewer bytes to look at
+	myErr = FSRead(myRefNum, &myCount, myBuffer);
+	if (myErr == eofErr)
+		myErr = noErr;
+	if (myErr != noErr)
+		goto bail;
+
+	myKind = QTUtils_ClassifySignature(myBuffer, myCount, &myFormat);
+
+bail:
+	if (myRefNum != -1)
+		FSClose(myRefNum);
+
+	if (myBuffer != NULL)
+		DisposePtr((Ptr)myBuffer);
+
+	*theFileKind = myKind;
+	if (theFileFormat != NULL)
+		*theFileFormat = myFormat;
+
+	return(myErr);
+}
+
+
+//////////
+//
+// QTUtils_ClassifySignature
+// Classify a block of bytes read from the start of a file; return the kind of file they indicate.
+//
+// The order of the tests matters: the strong magic numbers (those that are four or more bytes long and
+// fixed at offset 0) come first, then the atom-based QuickTime formats, and finally the weaker tests.
+//
+//////////
+
+static short QTUtils_ClassifySignature (UInt8 *theBytes, long theCount, OSType *theFileFormat)
+{
+	short			myKind = kQTUtilsFileKindUnknown;
+	OSType			myFormat = 0L;
+	UInt32			myLong = 0L;
+
+	if ((theBytes == NULL) || (theCount < 4))
+		goto bail;
+
+	myLong = QTUtils_GetBigEndianLong(theBytes);
+
+	//////////
+	//
+	// still-image formats with unambiguous magic numbers
+	//
+	//////////
+
+	// JPEG: SOI marker followed by the start of another marker
+	if ((theBytes[0] == 0xFF) && (theBytes[1] == 0xD8) && (theBytes[2] == 0xFF)) {
+		myKind = kQTUtilsFileKindImage;
+		myFormat = FOUR_CHAR_CODE('JPEG');
+		goto bail;
+	}
+
+	// PNG: 0x89 'P' 'N' 'G' CR LF 0x1A LF
+	if ((theCount >= 8) && (myLong == 0x89504E47) && (QTUtils_GetBigEndianLong(theBytes + 4) == 0x0D0A1A0A)) {
+		myKind = kQTUtilsFileKindImage;
+		myFormat = FOUR_CHAR_CODE('PNGf');
+		goto bail;
+	}
+
+	// TIFF: "II*\0" or "MM\0*"
+	if ((myLong == 0x49492A00) || (myLong == 0x4D4D002A)) {
+		myKind = kQTUtilsFileKindImage;
+		myFormat = FOUR_CHAR_CODE('TIFF');
+		goto bail;
+	}
+
+	// Photoshop: "8BPS"
+	if (myLong == FOUR_CHAR_CODE('8BPS')) {
+		myKind = kQTUtilsFileKindImage;
+		myFormat = FOUR_CHAR_CODE('8BPS');
+		goto bail;
+	}
+
+	// SGI: magic number 474 (big-endian), followed by a storage byte of 0 or 1
+	if ((theBytes[0] == 0x01) && (theBytes[1] == 0xDA) && (theBytes[2] <= 1)) {
+		myKind = kQTUtilsFileKindImage;
+		myFormat = FOUR_CHAR_CODE('.SGI');
+		goto bail;
+	}
+
+	// GIF: "GIF87a" or "GIF89a"; QuickTime can open these both as images and (animated) as movies
+	if ((theCount >= 6) && (myLong == FOUR_CHAR_CODE('GIF8')) && ((theBytes[4] == '7') || (theBytes[4] == '9')) && (theBytes[5] == 'a')) {
+		myKind = kQTUtilsFileKindMovieOrImage;
+		myFormat = FOUR_CHAR_CODE('GIFf');
+		goto bail;
+	}
+
+	//////////
+	//
+	// movie container formats with unambiguous magic numbers
+	//
+	//////////
+
+	// RIFF: AVI and WAVE files
+	if ((theCount >= 12) && (myLong == FOUR_CHAR_CODE('RIFF'))) {
+		myFormat = QTUtils_GetBigEndianLong(theBytes + 8);
+		if ((myFormat == FOUR_CHAR_CODE('AVI ')) || (myFormat == FOUR_CHAR_CODE('WAVE'))) {
+			myKind = kQTUtilsFileKindMovie;
+			goto bail;
+		}
+		myFormat = 0L;
+	}
+
+	// IFF: AIFF and AIFF-C files
+	if ((theCount >= 12) && (myLong == FOUR_CHAR_CODE('FORM'))) {
+		myFormat = QTUtils_GetBigEndianLong(theBytes + 8);
+		if ((myFormat == FOUR_CHAR_CODE('AIFF')) || (myFormat == FOUR_CHAR_CODE('AIFC'))) {
+			myKind = kQTUtilsFileKindMovie;
+			goto bail;
+		}
+		myFormat = 0L;
+	}
+
+	// MPEG program stream pack header or video sequence header
+	if ((myLong == 0x000001BA) || (myLong == 0x000001B3)) {
+		myKind = kQTUtilsFileKindMovie;
+		myFormat = FOUR_CHAR_CODE('MPEG');
+		goto bail;
+	}
+
+	// MP3 with an ID3v2 tag
+	if ((theBytes[0] == 'I') && (theBytes[1] == 'D') && (theBytes[2] == '3')) {
+		myKind = kQTUtilsFileKindMovie;
+		myFormat = FOUR_CHAR_CODE('MPEG');
+		goto bail;
+	}
+
+	// Standard MIDI file
+	if (myLong == FOUR_CHAR_CODE('MThd')) {
+		myKind = kQTUtilsFileKindMovie;
+		myFormat = FOUR_CHAR_CODE('Midi');
+		goto bail;
+	}
+
+	// Flash: "FWS" or (compressed) "CWS"
+	if (((theBytes[0] == 'F') || (theBytes[0] == 'C')) && (theBytes[1] == 'W') && (theBytes[2] == 'S')) {
+		myKind = kQTUtilsFileKindMovie;
+		myFormat = FOUR_CHAR_CODE('SWFL');
+		goto bail;
+	}
+
+	// Sun/NeXT audio: ".snd"
+	if (myLong == FOUR_CHAR_CODE('.snd')) {
+		myKind = kQTUtilsFileKindMovie;
+		myFormat = FOUR_CHAR_CODE('ULAW');
+		goto bail;
+	}
+
+	//////////
+	//
+	// atom-based formats: QuickTime movies, QuickTime images, and MPEG-4/JPEG 2000 files
+	//
+	//////////
+
+	myKind = QTUtils_ClassifyAtoms(theBytes, theCount, &myFormat);
+	if (myKind != kQTUtilsFileKindUnknown)
+		goto bail;
+
+	//////////
+	//
+	// the weaker tests
+	//
+	//////////
+
+	// PICT: a 512-byte header, then picSize and picFrame, then a version opcode
+	if (theCount >= 526) {
+		if (((theBytes[522] == 0x00) && (theBytes[523] == 0x11) && (theBytes[524] == 0x02) && (theBytes[525] == 0xFF)) ||
+			((theBytes[522] == 0x11) && (theBytes[523] == 0x01))) {
+			myKind = kQTUtilsFileKindMovieOrImage;
+			myFormat = FOUR_CHAR_CODE('PICT');
+			goto bail;
+		}
+	}
+
+	// BMP: "BM", with a little-endian info header size we know about at offset 14
+	if ((theCount >= 18) && (theBytes[0] == 'B') && (theBytes[1] == 'M')) {
+		UInt32		myHeaderSize = theBytes[14] | (theBytes[15] << 8) | (theBytes[16] << 16) | ((UInt32)theBytes[17] << 24);
+
+		if ((myHeaderSize == 12) || (myHeaderSize == 40) || (myHeaderSize == 56) || (myHeaderSize == 64) || (myHeaderSize == 108) || (myHeaderSize == 124)) {
+			myKind = kQTUtilsFileKindImage;
+			myFormat = FOUR_CHAR_CODE('BMPf');
+			goto bail;
+		}
+	}
+
+	// MPEG transport stream: a sync byte every 188 bytes
+	if ((theCount >= 3 * 188) && (theBytes[0] == 0x47) && (theBytes[188] == 0x47) && (theBytes[2 * 188] == 0x47)) {
+		myKind = kQTUtilsFileKindMovie;
+		myFormat = FOUR_CHAR_CODE('MPEG');
+		goto bail;
+	}
+
+bail:
+	if (theFileFormat != NULL)
+		*theFileFormat = myFormat;
+
+	return(myKind);
+}
+
+
+//////////
+//
+// QTUtils_ClassifyAtoms
+// Walk the top-level atoms contained in the specified block of bytes and decide whether they belong
+// to a QuickTime movie file, a QuickTime image file, or a JPEG 2000 file.
+//
+// We require every complete atom header in the block to have a plausible size and a type we know about;
+// a single unfamiliar atom makes the result ambiguous, in which case we let the importers decide.
+//
+//////////
+
+static short QTUtils_ClassifyAtoms (UInt8 *theBytes, long theCount, OSType *theFileFormat)
+{
+	long			myOffset = 0L;
+	short			myKind = kQTUtilsFileKindUnknown;
+	short			myAtomCount = 0;
+
+	*theFileFormat = 0L;
+
+	while (myOffset + 8 <= theCount) {
+		UInt32		mySize = QTUtils_GetBigEndianLong(theBytes + myOffset);
+		OSType		myType = QTUtils_GetBigEndianLong(theBytes + myOffset + 4);
+
+		switch (myType) {
+			case FOUR_CHAR_CODE('ftyp'):
+				// the major brand tells us whether this is a JPEG 2000 image or a movie
+				if (myOffset + 12 > theCount)
+					return(kQTUtilsFileKindUnknown);
+				*theFileFormat = QTUtils_GetBigEndianLong(theBytes + myOffset + 8);
+				if ((*theFileFormat == FOUR_CHAR_CODE('jp2 ')) || (*theFileFormat == FOUR_CHAR_CODE('jpx ')))
+					return(kQTUtilsFileKindImage);
+				myKind = kQTUtilsFileKindMovie;
+				break;
+
+			case FOUR_CHAR_CODE('jP  '):
+				*theFileFormat = FOUR_CHAR_CODE('jp2 ');
+				return(kQTUtilsFileKindImage);
+
+			case FOUR_CHAR_CODE('idsc'):
+			case FOUR_CHAR_CODE('idat'):
+				*theFileFormat = FOUR_CHAR_CODE('qtif');
+				return(kQTUtilsFileKindImage);
+
+			case FOUR_CHAR_CODE('moov'):
+			case FOUR_CHAR_CODE('mdat'):
+				*theFileFormat = kQTFileTypeMovie;
+				myKind = kQTUtilsFileKindMovie;
+				break;
+
+			case FOUR_CHAR_CODE('free'):
+			case FOUR_CHAR_CODE('skip'):
+			case FOUR_CHAR_CODE('wide'):
+			case FOUR_CHAR_CODE('pnot'):		// preview atom
+			case FOUR_CHAR_CODE('PICT'):		// preview data
+				break;
+
+			default:
+				return(kQTUtilsFileKindUnknown);
+		}
+
+		myAtomCount++;
+
+		// an atom size of 0 means "extends to the end of the file"; a size of 1 means that a 64-bit
+		// size follows the type; in either case we cannot step any further with what we have read
+		if ((mySize == 0) || (mySize == 1))
+			break;
+
+		if (mySize < 8)
+			return(kQTUtilsFileKindUnknown);
+
+		// an atom that runs past what we've read (a large 'mdat', say) is the last one we can look at; stepping
+		// over it could carry myOffset past the end of a long
+		if (mySize > (UInt32)(theCount - myOffset))
+			break;
+
+		myOffset += mySize;
+	}
+
+	// a file consisting only of free space and previews is not something we can claim
+	if (myAtomCount == 0)
+		return(kQTUtilsFileKindUnknown);
+
+	return(myKind);
+}
+
+
+//////////
+//
+// QTUtils_GetBigEndianLong
+// Return the big-endian 32-bit value beginning at the specified address.
+//
+//////////
+
+static UInt32 QTUtils_GetBigEndianLong (UInt8 *theBytes)
+{
+	return(((UInt32)theBytes[0] << 24) | ((UInt32)theBytes[1] << 16) | ((UInt32)theBytes[2] << 8) | (UInt32)theBytes[3]);
+}
+
+
 //////////
 //
 // QTUtils_IsImageFile
 // Is the specified file an image file?
 //
+// We first look at the file's signature; only if that is inconclusive do we go to the trouble of
+// opening (and then immediately closing) a graphics importer.
+//
 //////////
 
 Boolean QTUtils_IsImageFile (FSSpec *theFSSpec)
 {	
 	GraphicsImportComponent		myImporter = NULL;
+	short						myKind = kQTUtilsFileKindUnknown;
+
+	QTUtils_SniffFileSignature(theFSSpec, &myKind, NULL);
+	switch (myKind) {
+		case kQTUtilsFileKindImage:
+		case kQTUtilsFileKindMovieOrImage:
+			return(true);
+		case kQTUtilsFileKindMovie:
+			return(false);
+	}
 
 	GetGraphicsImporterForFile(theFSSpec, &myImporter);
 	if (myImporter != NULL)
@@ -1363,6 +1804,7 @@ Boolean QTUtils_IsMovieFile (FSSpec *theFSSpec)
 	AliasHandle					myAlias = NULL;
 	Component					myImporter = NULL;
 	FInfo						myFinderInfo;
+	short						myKind = kQTUtilsFileKindUnknown;
 	OSErr						myErr = noErr;
 			
 	// see whether the file type is MovieFileType; to do this, get the Finder information
@@ -1371,6 +1813,16 @@ Boolean QTUtils_IsMovieFile (FSSpec *theFSSpec)
 		if (myFinderInfo.fdType == kQTFileTypeMovie)
 			return(true);
 
+	// see whether the file's signature settles the matter
+	QTUtils_SniffFileSignature(theFSSpec, &myKind, NULL);
+	switch (myKind) {
+		case kQTUtilsFileKindMovie:
+		case kQTUtilsFileKindMovieOrImage:
+			return(true);
+		case kQTUtilsFileKindImage:
+			return(false);
+	}
+
 	// if it isn't a movie file, see whether the file can be imported as a movie
 	myErr = QTNewAlias(theFSSpec, &myAlias, true);
 	if (myErr == noErr) {
@@ -1513,23 +1965,20 @@ OSErr QTUtils_DeleteAllReferencesToTrack (Track theTrack)
 
 TimeValue QTUtils_GetFrameDuration (Track theTrack)
 {	
-	TimeValue	mySampleDuration;
+	TimeValue	mySampleDuration = 0;
 	OSErr		myErr = noErr;
 
-	myErr = GetMediaSample(	GetTrackMedia(theTrack),
-							NULL, 		// don't return sample data
-							0,
-							NULL,		// don't return number of bytes of sample data returned
-							0,
-							NULL,
-							&mySampleDuration,
-							NULL,		// don't return sample description
-							NULL,		// don't return sample description index
-							0,			// no max number of samples
-							NULL,		// don't return number of samples returned
-							NULL);		// don't return sample flags
-
-	// make sure we return a legitimate value even if GetMediaSample encounters an error
+	// we need only the duration, so ask the media for its first interesting time; unlike GetMediaSample,
+	// this doesn't go through the data handler to locate the sample data
+	GetMediaNextInterestingTime(GetTrackMedia(theTrack),
+							nextTimeMediaSample | nextTimeEdgeOK,
+							0,			// start at the beginning of the media
+							fixed1,		// search forward
+							NULL,		// don't return the time of the sample
+							&mySampleDuration);
+
+	// make sure we return a legitimate value even if GetMediaNextInterestingTime encounters an error
+	myErr = GetMoviesError();
 	if (myErr != noErr)
 		mySampleDuration = 0;
 
@@ -13,6 +13,9 @@
 //
 //	Change History (most recent first):
 //
+//	   <5>	 	11/13/26	rtm		added QTUtils_HasIdleManager
+//	   <4>	 	10/24/26	rtm		added QTUtils_HasAsyncMovieLoading and the movie load state utilities
+//	   <3>	 	10/18/26	rtm		added QTUtils_SniffFileSignature and file-kind constants
 //	   <2>	 	02/03/99	rtm		moved non-QTVR-specific utilities from QTVRUtilities to here
 //	   <1>	 	09/10/97	rtm		first file
 //	   
@@ -136,9 +139,21 @@ enum {
 	kNoLooping						= 2
 };
 
+// constants used for QTUtils_SniffFileSignature
+#define kQTUtilsSniffBufferSize		4096		// number of bytes we examine at the start of a file
+
+enum eQTUFileKind {
+	kQTUtilsFileKindUnknown			= 0,		// the signature is ambiguous; ask the importers
+	kQTUtilsFileKindMovie			= 1,		// a file that opens as a movie
+	kQTUtilsFileKindImage			= 2,		// a file that opens as a still image
+	kQTUtilsFileKindMovieOrImage	= 3			// a file that QuickTime can open either way (GIF, PICT)
+};
+
 #define kQTVideoEffectsMinVers		0x0300		// version of QT that first supports QT video effects
 #define kQTFullScreenMinVers		0x0209		// version of QT that first supports full-screen calls
 #define kQTWiredSpritesMinVers		0x0300		// version of QT that first supports wired sprites
+#define kQTAsyncLoadingMinVers		0x0410		// version of QT that first supports asynchronous movie loading
+#define kQTIdleManagerMinVers		0x0600		// version of QT that first supports the Idle Manager (QTGetTimeUntilNextTask)
 
 // constants for GetQuickTimePreference/SetQuickTimePreference settings
 #define kConnectionSpeedPrefsType	FOUR_CHAR_CODE('cspd')
@@ -205,6 +220,10 @@ long						QTUtils_GetQTVersion (void);
 Boolean						QTUtils_HasQuickTimeVideoEffects (void);
 Boolean						QTUtils_HasFullScreenSupport (void);
 Boolean						QTUtils_HasWiredSprites (void);
+Boolean						QTUtils_HasAsyncMovieLoading (void);
+Boolean						QTUtils_HasIdleManager (void);
+long						QTUtils_GetMovieLoadState (Movie theMovie);
+OSErr						QTUtils_WaitForMovieLoadState (Movie theMovie, long theLoadState);
 Boolean						QTUtils_IsQTVRMovie (Movie theMovie);
 Boolean						QTUtils_IsStreamedMovie (Movie theMovie);
 Boolean						QTUtils_IsAutoPlayMovie (Movie theMovie);
@@ -242,6 +261,10 @@ OSErr						QTUtils_GetWindowPositionFromFile (Movie theMovie, Point *thePoint);
 char *						QTUtils_GetTrackName (Track theTrack);
 OSErr						QTUtils_SetTrackName (Track theTrack, char *theText);
 char *						QTUtils_MakeTrackNameByType (Track theTrack);
+OSErr						QTUtils_SniffFileSignature (FSSpec *theFSSpec, short *theFileKind, OSType *theFileFormat);
+static short				QTUtils_ClassifySignature (UInt8 *theBytes, long theCount, OSType *theFileFormat);
+static short				QTUtils_ClassifyAtoms (UInt8 *theBytes, long theCount, OSType *theFileFormat);
+static UInt32				QTUtils_GetBigEndianLong (UInt8 *theBytes);
 Boolean						QTUtils_IsImageFile (FSSpec *theFSSpec);
 Boolean						QTUtils_IsMovieFile (FSSpec *theFSSpec);
 void						QTUtils_ConvertFloatToBigEndian (float *theFloat);
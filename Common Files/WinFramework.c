@@ -15,6 +15,7 @@
 //
 //	Change History (most recent first):
 //
+//	   <12>	 	11/13/26	rtm		the application exits with the status that QTApp_GetExitStatus returns
 //	   <11>	 	07/31/00	rtm		reworked QTFrame_CalcWindowMinMaxInfo to use subsystem 4.0 metrics
 //	   <10>	 	07/07/00	rtm		removed QTFrame_CreateMacEditMenu; now we use MCGetMenuString
 //	   <9>	 	07/06/00	rtm		made changes to support new parameter to QTFrame_AdjustMenus; added the calls
@@ -352,7 +353,7 @@ LRESULT CALLBACK QTFrame_FrameWndProc (HWND theWnd, UINT theMessage, UINT wParam
 		case WM_DESTROY:
 			// do any application-specific shutdown
 			QTApp_Stop(kStopAppPhase_AfterDestroyWindows);
-			PostQuitMessage(0);
+			PostQuitMessage(QTApp_GetExitStatus());
 			break;
 	}
 	
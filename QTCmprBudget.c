@@ -0,0 +1,469 @@
+//////////
+//
+//	File:		QTCmprBudget.c
+//
+//	Contains:	A process-wide memory budget for compression jobs, for use by QTCompress.
+//
+//	Written by:	Tim Monroe
+//
+//	Copyright:	 2000 by Apple Computer, Inc., all rights reserved.
+//
+//	Change History (most recent first):
+//
+//	   <2>	 	11/13/26	rtm		the budget lock is set up exactly once, even when the first reservations race;
+//									gMemoryInUse is read only under the lock; a stalled job without an idle
+//									function waits until some other job releases memory, instead of spinning
+//	   <1>	 	10/22/26	rtm		first file
+//
+//	Each compression job (compressing an image, compressing a movie, and so forth) is represented by a
+//	MemoryJob record. Before a job allocates a large block of memory (a frame buffer, a queue, a cache entry,
+//	or a buffer for compressed data), it reserves that many bytes against a single process-wide budget; when
+//	it disposes of the block, it releases the bytes. Small allocations (handles to image descriptions and the
+//	like) aren't worth tracking.
+//
+//	If a reservation would exceed the budget, we first ask the registered reclaimers (the frame cache, for
+//	instance) to give back memory they can recreate later. If that isn't enough, we don't fail; instead,
+//	we stall the job that made the reservation (calling its idle function, so that other jobs can make
+//	progress, or else sleeping until a release wakes it) until some other job releases enough memory. A job that is the only holder of reserved memory
+//	is always admitted, even if it alone exceeds the budget, so that a single large job can't deadlock.
+//
+//	We keep track of the current and peak usage of each job, and report them when the job ends.
+//
+//////////
+
+//////////
+//
+// header files
+//
+//////////
+
+#include "QTCompress.h"
+
+
+//////////
+//
+// global variables
+//
+//////////
+
+static long						gMemoryBudget = kMemoryBudgetDefault;		// maximum number of bytes reserved by all jobs
+static long						gMemoryInUse = 0L;							// number of bytes currently reserved by all jobs
+static long						gMemoryPeak = 0L;							// largest value that gMemoryInUse has had
+static MemoryReclaimProcPtr		gMemoryReclaimers[kMemoryMaxReclaimers];	// functions that can give back memory
+static short					gNumMemoryReclaimers = 0;
+
+static UInt32					gMemoryReleaseCount = 0L;					// number of times any job has released memory
+
+#if TARGET_OS_WIN32
+static CRITICAL_SECTION			gMemoryBudgetLock;							// guards all of the globals above
+static HANDLE					gMemoryReleasedEvent = NULL;				// set whenever gMemoryReleaseCount changes
+static volatile LONG			gMemoryBudgetLockState = kMemoryLockUninited;
+#endif
+
+#if TARGET_RT_MAC_MACHO
+static pthread_mutex_t			gMemoryBudgetLock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t			gMemoryReleased = PTHREAD_COND_INITIALIZER;	// signalled whenever gMemoryReleaseCount changes
+#endif
+
+
+//////////
+//
+// QTCmpr_BeginMemoryJob
+// Initialize the specified job record.
+//
+// theIdleProc is called (with theRefCon) whenever the job is stalled waiting for memory; it may be NULL.
+//
+//////////
+
+void QTCmpr_BeginMemoryJob (MemoryJobPtr theJob, char *theName, MemoryIdleProcPtr theIdleProc, long theRefCon)
+{
+	if (theJob == NULL)
+		return;
+
+	strncpy(theJob->fName, (theName != NULL) ? theName : "", kMemoryJobNameLength - 1);
+	theJob->fName[kMemoryJobNameLength - 1] = '\0';
+	theJob->fCurrent = 0L;
+	theJob->fPeak = 0L;
+	theJob->fIdleProc = theIdleProc;
+	theJob->fIdleRefCon = theRefCon;
+}
+
+
+//////////
+//
+// QTCmpr_EndMemoryJob
+// Report the current and peak usage of the specified job and release any memory it still holds.
+//
+// A job that ends with memory still reserved has leaked a reservation (or, more likely, a block of memory);
+// the report makes that easy to spot.
+//
+//////////
+
+void QTCmpr_EndMemoryJob (MemoryJobPtr theJob)
+{
+	long				myInUse;
+	long				myPeak;
+
+	if (theJob == NULL)
+		return;
+
+	QTCmpr_LockBudget();
+	myInUse = gMemoryInUse;
+	myPeak = gMemoryPeak;
+	QTCmpr_UnlockBudget();
+
+	QTCmpr_LogMessage("%s: current %ld bytes, peak %ld bytes (all jobs: %ld bytes in use, peak %ld bytes, budget %ld bytes)",
+						theJob->fName, theJob->fCurrent, theJob->fPeak, myInUse, myPeak, gMemoryBudget);
+
+	if (theJob->fCurrent > 0L)
+		QTCmpr_ReleaseMemory(theJob, theJob->fCurrent);
+}
+
+
+//////////
+//
+// QTCmpr_ReserveMemory
+// Reserve theSize bytes of memory for the specified job, stalling the job until they are available.
+//
+//////////
+
+void QTCmpr_ReserveMemory (MemoryJobPtr theJob, long theSize)
+{
+	long				myShortfall = 0L;
+	UInt32				myReleaseCount = 0L;
+
+	if ((theJob == NULL) || (theSize <= 0L))
+		return;
+
+	while (!QTCmpr_AdmitReservation(theJob, theSize, false, &myShortfall, NULL)) {
+		// first, see whether any cached data can be given back
+		if (QTCmpr_ReclaimMemory(myShortfall) > 0L)
+			continue;
+
+		// if no other job holds any memory, there's nobody to wait for; let this job exceed the budget
+		if (QTCmpr_AdmitReservation(theJob, theSize, true, NULL, &myReleaseCount))
+			break;
+
+		// otherwise, wait for some other job to release memory
+		QTCmpr_StallMemoryJob(theJob, myReleaseCount);
+	}
+}
+
+
+//////////
+//
+// QTCmpr_TryReserveMemory
+// Reserve theSize bytes of memory for the specified job, if they are available now; return true if they are.
+//
+// This never stalls and never calls the reclaimers, so it's suitable for reserving memory for cached data.
+//
+//////////
+
+Boolean QTCmpr_TryReserveMemory (MemoryJobPtr theJob, long theSize)
+{
+	if (theJob == NULL)
+		return(false);
+
+	if (theSize <= 0L)
+		return(true);
+
+	return(QTCmpr_AdmitReservation(theJob, theSize, false, NULL, NULL));
+}
+
+
+//////////
+//
+// QTCmpr_ReleaseMemory
+// Release theSize bytes of memory previously reserved for the specified job.
+//
+//////////
+
+void QTCmpr_ReleaseMemory (MemoryJobPtr theJob, long theSize)
+{
+	if ((theJob == NULL) || (theSize <= 0L))
+		return;
+
+	QTCmpr_LockBudget();
+
+	if (theSize > theJob->fCurrent)
+		theSize = theJob->fCurrent;
+
+	theJob->fCurrent -= theSize;
+	gMemoryInUse -= theSize;
+
+	// let any stalled jobs try again
+	gMemoryReleaseCount++;
+#if TARGET_OS_WIN32
+	SetEvent(gMemoryReleasedEvent);
+#endif
+#if TARGET_RT_MAC_MACHO
+	pthread_cond_broadcast(&gMemoryReleased);
+#endif
+
+	QTCmpr_UnlockBudget();
+}
+
+
+//////////
+//
+// QTCmpr_AddMemoryReclaimer
+// Add a function to the list of functions we call to get back memory when the budget is exhausted.
+//
+//////////
+
+void QTCmpr_AddMemoryReclaimer (MemoryReclaimProcPtr theProc)
+{
+	short				myIndex;
+
+	if (theProc == NULL)
+		return;
+
+	QTCmpr_LockBudget();
+
+	for (myIndex = 0; myIndex < gNumMemoryReclaimers; myIndex++)
+		if (gMemoryReclaimers[myIndex] == theProc)
+			break;
+
+	if ((myIndex == gNumMemoryReclaimers) && (gNumMemoryReclaimers < kMemoryMaxReclaimers))
+		gMemoryReclaimers[gNumMemoryReclaimers++] = theProc;
+
+	QTCmpr_UnlockBudget();
+}
+
+
+//////////
+//
+// QTCmpr_SetMemoryBudget
+// Set the maximum number of bytes reserved by all jobs.
+//
+// Lowering the budget doesn't take memory away from any job; it just makes new reservations wait longer.
+//
+//////////
+
+void QTCmpr_SetMemoryBudget (long theLimit)
+{
+	if (theLimit < 0L)
+		theLimit = 0L;
+
+	gMemoryBudget = theLimit;
+}
+
+
+//////////
+//
+// QTCmpr_GetMemoryBudget
+// Return the maximum number of bytes reserved by all jobs.
+//
+//////////
+
+long QTCmpr_GetMemoryBudget (void)
+{
+	return(gMemoryBudget);
+}
+
+
+//////////
+//
+// QTCmpr_GetMemoryInUse
+// Return the number of bytes currently reserved by all jobs.
+//
+//////////
+
+long QTCmpr_GetMemoryInUse (void)
+{
+	long				myInUse;
+
+	QTCmpr_LockBudget();
+	myInUse = gMemoryInUse;
+	QTCmpr_UnlockBudget();
+
+	return(myInUse);
+}
+
+
+//////////
+//
+// QTCmpr_GetMemoryPeak
+// Return the largest number of bytes reserved by all jobs at any one time.
+//
+//////////
+
+long QTCmpr_GetMemoryPeak (void)
+{
+	long				myPeak;
+
+	QTCmpr_LockBudget();
+	myPeak = gMemoryPeak;
+	QTCmpr_UnlockBudget();
+
+	return(myPeak);
+}
+
+
+//////////
+//
+// QTCmpr_AdmitReservation
+// Reserve theSize bytes for the specified job if that fits within the budget (or if theMayAdmitAlone is true
+// and no other job holds any memory); return true if the bytes were reserved.
+//
+// If they weren't, return (in theShortfall and theReleaseCount, either of which may be NULL) how far over the
+// budget the reservation would go and the number of releases so far, both read under the same lock as the test.
+//
+//////////
+
+static Boolean QTCmpr_AdmitReservation (MemoryJobPtr theJob, long theSize, Boolean theMayAdmitAlone, long *theShortfall, UInt32 *theReleaseCount)
+{
+	Boolean				isAdmitted = false;
+
+	QTCmpr_LockBudget();
+
+	if ((gMemoryInUse + theSize <= gMemoryBudget) || (theMayAdmitAlone && (gMemoryInUse == theJob->fCurrent))) {
+		theJob->fCurrent += theSize;
+		if (theJob->fCurrent > theJob->fPeak)
+			theJob->fPeak = theJob->fCurrent;
+
+		gMemoryInUse += theSize;
+		if (gMemoryInUse > gMemoryPeak)
+			gMemoryPeak = gMemoryInUse;
+
+		isAdmitted = true;
+	} else {
+		if (theShortfall != NULL)
+			*theShortfall = gMemoryInUse + theSize - gMemoryBudget;
+		if (theReleaseCount != NULL)
+			*theReleaseCount = gMemoryReleaseCount;
+	}
+
+	QTCmpr_UnlockBudget();
+
+	return(isAdmitted);
+}
+
+
+//////////
+//
+// QTCmpr_ReclaimMemory
+// Ask the reclaimers to give back theBytesNeeded bytes of memory; return the number of bytes they released.
+//
+// The reclaimers release memory by calling QTCmpr_ReleaseMemory, so we must not hold the lock while we call them.
+//
+//////////
+
+static long QTCmpr_ReclaimMemory (long theBytesNeeded)
+{
+	long				myReleased = 0L;
+	short				myIndex;
+
+	for (myIndex = 0; (myIndex < gNumMemoryReclaimers) && (myReleased < theBytesNeeded); myIndex++)
+		myReleased += (*gMemoryReclaimers[myIndex])(theBytesNeeded - myReleased);
+
+	return(myReleased);
+}
+
+
+//////////
+//
+// QTCmpr_StallMemoryJob
+// Wait until some other job releases memory (that is, until gMemoryReleaseCount is no longer theReleaseCount).
+//
+// A job with an idle function runs on the main thread, which must keep handling events; we call the idle
+// function and return, and the caller tries again. Any other job sleeps until it's woken by QTCmpr_ReleaseMemory
+// (or, on Windows, for at most kMemoryStallInterval milliseconds, in case a release slips by us).
+//
+//////////
+
+static void QTCmpr_StallMemoryJob (MemoryJobPtr theJob, UInt32 theReleaseCount)
+{
+	if (theJob->fIdleProc != NULL) {
+		(*theJob->fIdleProc)(theJob->fIdleRefCon);
+		return;
+	}
+
+#if TARGET_OS_WIN32
+	QTCmpr_LockBudget();
+	if (gMemoryReleaseCount == theReleaseCount) {
+		// reset the event while we hold the lock, so that any release from here on sets it again
+		ResetEvent(gMemoryReleasedEvent);
+		QTCmpr_UnlockBudget();
+		WaitForSingleObject(gMemoryReleasedEvent, kMemoryStallInterval);
+	} else {
+		QTCmpr_UnlockBudget();
+	}
+#endif
+
+#if TARGET_RT_MAC_MACHO
+	pthread_mutex_lock(&gMemoryBudgetLock);
+	while (gMemoryReleaseCount == theReleaseCount)
+		pthread_cond_wait(&gMemoryReleased, &gMemoryBudgetLock);
+	pthread_mutex_unlock(&gMemoryBudgetLock);
+#endif
+}
+
+
+//////////
+//
+// QTCmpr_InitBudgetLock
+// Set up the critical section and event that guard the budget on Windows, exactly once.
+//
+// The first reservations may well be made on several threads at once, so the thread that wins the race to
+// change gMemoryBudgetLockState sets them up and the others wait until it's done. (On Mac OS X, the mutex and
+// condition variable are initialized statically.)
+//
+//////////
+
+static void QTCmpr_InitBudgetLock (void)
+{
+#if TARGET_OS_WIN32
+	if (gMemoryBudgetLockState == kMemoryLockInited)
+		return;
+
+	if (InterlockedCompareExchange(&gMemoryBudgetLockState, kMemoryLockIniting, kMemoryLockUninited) == kMemoryLockUninited) {
+		InitializeCriticalSection(&gMemoryBudgetLock);
+		gMemoryReleasedEvent = CreateEvent(NULL, TRUE, FALSE, NULL);
+		InterlockedExchange(&gMemoryBudgetLockState, kMemoryLockInited);
+	} else {
+		while (gMemoryBudgetLockState != kMemoryLockInited)
+			Sleep(0);
+	}
+#endif
+}
+
+
+//////////
+//
+// QTCmpr_LockBudget
+// Get exclusive access to the budget.
+//
+// On Windows and Mac OS X, jobs may reserve and release memory on other threads, so we guard the budget with a
+// critical section or a mutex; on Mac OS 9 and earlier, all jobs run on the main thread.
+//
+//////////
+
+static void QTCmpr_LockBudget (void)
+{
+#if TARGET_OS_WIN32
+	QTCmpr_InitBudgetLock();
+	EnterCriticalSection(&gMemoryBudgetLock);
+#endif
+#if TARGET_RT_MAC_MACHO
+	pthread_mutex_lock(&gMemoryBudgetLock);
+#endif
+}
+
+
+//////////
+//
+// QTCmpr_UnlockBudget
+// Give up exclusive access to the budget.
+//
+//////////
+
+static void QTCmpr_UnlockBudget (void)
+{
+#if TARGET_OS_WIN32
+	LeaveCriticalSection(&gMemoryBudgetLock);
+#endif
+#if TARGET_RT_MAC_MACHO
+	pthread_mutex_unlock(&gMemoryBudgetLock);
+#endif
+}
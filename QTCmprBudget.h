@@ -0,0 +1,105 @@
+//////////
+//
+//	File:		QTCmprBudget.h
+//
+//	Contains:	A process-wide memory budget for compression jobs, for use by QTCompress.
+//
+//	Written by:	Tim Monroe
+//
+//	Copyright:	 2000 by Apple Computer, Inc., all rights reserved.
+//
+//	Change History (most recent first):
+//
+//	   <2>	 	11/13/26	rtm		the budget lock is set up only once; stalled jobs wait for a release
+//	   <1>	 	10/22/26	rtm		first file
+//
+//////////
+
+#pragma once
+
+
+//////////
+//
+// header files
+//
+//////////
+
+#ifndef __QTCmprBudget__
+#define __QTCmprBudget__
+
+#ifndef __MACTYPES__
+#include <MacTypes.h>
+#endif
+
+#if TARGET_OS_WIN32
+#include <windows.h>
+#endif
+
+#if TARGET_RT_MAC_MACHO
+#include <pthread.h>
+#endif
+
+
+//////////
+//
+// constants
+//
+//////////
+
+#define kMemoryBudgetDefault			(128L * 1024L * 1024L)	// default maximum number of bytes reserved by all jobs
+#define kMemoryJobNameLength			32						// maximum length of a job name, including the terminating null
+#define kMemoryMaxReclaimers			4						// maximum number of reclaimer functions
+#define kMemoryStallInterval			10						// longest time (in milliseconds) a stalled job waits for a release
+#define kMemoryLockUninited				0L						// states of the budget lock on Windows:
+#define kMemoryLockIniting				1L						//   being set up by some thread,
+#define kMemoryLockInited				2L						//   ready for use
+
+
+//////////
+//
+// data types
+//
+//////////
+
+// an idle function, called while a job is stalled waiting for memory; it should give other jobs a chance
+// to run (and so to release the memory they hold)
+typedef void (*MemoryIdleProcPtr) (long theRefCon);
+
+// a reclaimer function, called when the budget is exhausted; it should release up to theBytesNeeded bytes
+// of memory that can be recreated on demand (cached data, for instance) and return the number of bytes released
+typedef long (*MemoryReclaimProcPtr) (long theBytesNeeded);
+
+// a job; a job reserves memory against the budget before it allocates it and releases it after disposing of it
+typedef struct MemoryJob {
+	char						fName[kMemoryJobNameLength];	// the name of the job, for reports
+	long						fCurrent;						// the number of bytes the job currently holds
+	long						fPeak;							// the largest value that fCurrent has had
+	MemoryIdleProcPtr			fIdleProc;						// the job's idle function, or NULL
+	long						fIdleRefCon;					// the reference constant passed to fIdleProc
+} MemoryJob, *MemoryJobPtr;
+
+
+//////////
+//
+// function prototypes
+//
+//////////
+
+void							QTCmpr_BeginMemoryJob (MemoryJobPtr theJob, char *theName, MemoryIdleProcPtr theIdleProc, long theRefCon);
+void							QTCmpr_EndMemoryJob (MemoryJobPtr theJob);
+void							QTCmpr_ReserveMemory (MemoryJobPtr theJob, long theSize);
+Boolean							QTCmpr_TryReserveMemory (MemoryJobPtr theJob, long theSize);
+void							QTCmpr_ReleaseMemory (MemoryJobPtr theJob, long theSize);
+void							QTCmpr_AddMemoryReclaimer (MemoryReclaimProcPtr theProc);
+void							QTCmpr_SetMemoryBudget (long theLimit);
+long							QTCmpr_GetMemoryBudget (void);
+long							QTCmpr_GetMemoryInUse (void);
+long							QTCmpr_GetMemoryPeak (void);
+static Boolean					QTCmpr_AdmitReservation (MemoryJobPtr theJob, long theSize, Boolean theMayAdmitAlone, long *theShortfall, UInt32 *theReleaseCount);
+static long						QTCmpr_ReclaimMemory (long theBytesNeeded);
+static void						QTCmpr_StallMemoryJob (MemoryJobPtr theJob, UInt32 theReleaseCount);
+static void						QTCmpr_InitBudgetLock (void);
+static void						QTCmpr_LockBudget (void);
+static void						QTCmpr_UnlockBudget (void);
+
+#endif	// __QTCmprBudget__
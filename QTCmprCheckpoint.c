@@ -0,0 +1,649 @@
+//////////
+//
+//	File:		QTCmprCheckpoint.c
+//
+//	Contains:	Checkpoints for long sequence compressions, so that a compression that fails part way through
+//				can be resumed, for use by QTCompress.
+//
+//	Written by:	Tim Monroe
+//
+//	Copyright:	 2000 by Apple Computer, Inc., all rights reserved.
+//
+//	Change History (most recent first):
+//
+//	   <3>	 	11/13/26	rtm		the header now records the source file (its location, size, and modification date), and a
+//									checkpoint is used only if the source file and the compression settings are unchanged;
+//									each commit flushes the movie file's data to disk before the commit record, and then
+//									the commit record
+//	   <2>	 	11/11/26	rtm		commit records can be written every fIntervalFrames frames, instead of every few seconds,
+//									so that where the sample writer's chunks end doesn't depend on how fast we compress
+//	   <1>	 	10/28/26	rtm		first file
+//
+//	Compressing a long movie can take hours. Until QTCmpr_CompressSequence adds the movie resource to the new
+//	movie file at the very end, nothing in that file says which frames it holds; if the compression fails, or
+//	the application quits, all that work is lost.
+//
+//	So while we compress, we keep a checkpoint file next to the new movie file (its name is the movie file's
+//	name with kCheckpointSuffix added). The checkpoint file begins with a header holding the compression
+//	settings and the image description of the compressed frames. Every few seconds, we write out the frames
+//	buffered by the sample writer and append a commit record to the checkpoint file, giving the sample
+//	references added to the media since the previous commit record, the end of the committed data in the
+//	movie file, and the source frame to continue with. Each header and record carries a checksum, and the
+//	records are only ever appended, so a record that was cut short is easy to recognize and ignore. The data a
+//	record commits is flushed to disk before the record is written, and the record is flushed in turn; so if the
+//	machine goes down, a complete record never points at data that didn't make it to disk.
+//
+//	A checkpoint is only any use for the same source compressed with the same settings. So the header also
+//	identifies the source movie file, by its location, the sizes of its forks, and its modification date, and
+//	we resume only if those, the source movie's time scale and duration, and the compression settings in the
+//	Standard Compression component all match.
+//
+//	To resume, we read the header and every complete commit record, throw away anything in the movie file
+//	past the end of the last committed data, add the committed sample references to a new media in that file,
+//	and continue compressing at the next source frame. Once the movie resource is written, we delete the
+//	checkpoint file.
+//
+//	The checkpoint file is written in native byte order; it's meant to be read back by the same application
+//	on the same machine, not to be moved around.
+//
+//////////
+
+//////////
+//
+// header files
+//
+//////////
+
+#include <string.h>
+
+#include "QTCmprCheckpoint.h"
+
+
+//////////
+//
+// QTCmpr_CreateCheckpoint
+// Create a checkpoint file for the specified new movie file, and write its header.
+//
+// The source file and movie identify the movie being compressed, and the Standard Compression component holds
+// the compression settings; theDesc is the image description of the compressed frames.
+//
+//////////
+
+OSErr QTCmpr_CreateCheckpoint (CheckpointPtr theCheckpoint, FSSpec *theMovieFile, FSSpec *theSrcFile, Movie theSrcMovie, ComponentInstance theComponent, ImageDescriptionHandle theDesc)
+{
+	CheckpointHeader			myHeader;
+	QTAtomContainer				mySettings = NULL;
+	OSErr						myErr = noErr;
+
+	if ((theCheckpoint == NULL) || (theMovieFile == NULL) || (theSrcFile == NULL) || (theSrcMovie == NULL) || (theComponent == NULL) || (theDesc == NULL))
+		return(paramErr);
+
+	QTCmpr_InitCheckpoint(theCheckpoint, theMovieFile);
+
+	// the header is checksummed as it is in memory, so clear any padding (and the unused part of the file name)
+	memset(&myHeader, 0, sizeof(myHeader));
+
+	myErr = QTCmpr_GetCheckpointSource(theSrcFile, &myHeader.fSource);
+	if (myErr != noErr)
+		return(myErr);
+
+	myErr = SCGetSettingsAsAtomContainer(theComponent, &mySettings);
+	if (myErr != noErr)
+		goto bail;
+
+	// replace any checkpoint file left over from an earlier compression
+	FSpDelete(&theCheckpoint->fFile);
+
+	myErr = FSpCreate(&theCheckpoint->fFile, sigMoviePlayer, kCheckpointSignature, smSystemScript);
+	if (myErr != noErr)
+		goto bail;
+
+	myErr = FSpOpenDF(&theCheckpoint->fFile, fsRdWrPerm, &theCheckpoint->fRefNum);
+	if (myErr != noErr) {
+		theCheckpoint->fRefNum = -1;
+		goto bail;
+	}
+
+	myHeader.fSignature = kCheckpointSignature;
+	myHeader.fVersion = kCheckpointVersion;
+	myHeader.fSrcTimeScale = GetMovieTimeScale(theSrcMovie);
+	myHeader.fSrcDuration = GetMovieDuration(theSrcMovie);
+	myHeader.fSettingsSize = GetHandleSize(mySettings);
+	myHeader.fDescSize = GetHandleSize((Handle)theDesc);
+	myHeader.fCheckSum = 0L;
+
+	HLock(mySettings);
+	HLock((Handle)theDesc);
+
+	myHeader.fCheckSum = QTCmpr_CheckpointSum(0L, &myHeader, sizeof(myHeader));
+	myHeader.fCheckSum = QTCmpr_CheckpointSum(myHeader.fCheckSum, *mySettings, myHeader.fSettingsSize);
+	myHeader.fCheckSum = QTCmpr_CheckpointSum(myHeader.fCheckSum, *theDesc, myHeader.fDescSize);
+
+	myErr = QTCmpr_WriteCheckpointBytes(theCheckpoint->fRefNum, &myHeader, sizeof(myHeader));
+	if (myErr == noErr)
+		myErr = QTCmpr_WriteCheckpointBytes(theCheckpoint->fRefNum, *mySettings, myHeader.fSettingsSize);
+	if (myErr == noErr)
+		myErr = QTCmpr_WriteCheckpointBytes(theCheckpoint->fRefNum, *theDesc, myHeader.fDescSize);
+	if (myErr == noErr)
+		myErr = QTCmpr_SyncCheckpointVolume(theCheckpoint);
+
+	HUnlock((Handle)theDesc);
+
+	theCheckpoint->fLastTicks = TickCount();
+
+bail:
+	if (mySettings != NULL)
+		QTDisposeAtomContainer(mySettings);
+
+	if (myErr != noErr)
+		QTCmpr_CloseCheckpoint(theCheckpoint, true);
+
+	return(myErr);
+}
+
+
+//////////
+//
+// QTCmpr_ReadCheckpoint
+// Read the checkpoint file for the specified movie file, and leave it open for appending commit records.
+//
+// Return noErr if the checkpoint file was written while compressing the specified source file and movie, with the
+// settings now in the specified Standard Compression component, and holds at least one complete commit record;
+// the settings, image description, sample references, and position of the last complete commit record are then
+// in the fields of theCheckpoint. Any incomplete record at the end of the file is thrown away. Call
+// QTCmpr_DisposeCheckpointState once the state has been used.
+//
+//////////
+
+OSErr QTCmpr_ReadCheckpoint (CheckpointPtr theCheckpoint, FSSpec *theMovieFile, FSSpec *theSrcFile, Movie theSrcMovie, ComponentInstance theComponent)
+{
+	CheckpointHeader			myHeader;
+	CheckpointSource			mySource;
+	CheckpointRecord			myRecord;
+	UInt32						myCheckSum;
+	UInt32						myRecordSum;
+	long						myFileSize = 0L;
+	long						myPos = 0L;
+	long						myRefsSize;
+	long						myOldSize;
+	OSErr						myErr = noErr;
+
+	if ((theCheckpoint == NULL) || (theMovieFile == NULL) || (theSrcFile == NULL) || (theSrcMovie == NULL) || (theComponent == NULL))
+		return(paramErr);
+
+	QTCmpr_InitCheckpoint(theCheckpoint, theMovieFile);
+
+	memset(&mySource, 0, sizeof(mySource));
+	myErr = QTCmpr_GetCheckpointSource(theSrcFile, &mySource);
+	if (myErr != noErr)
+		goto bail;
+
+	myErr = FSpOpenDF(&theCheckpoint->fFile, fsRdWrPerm, &theCheckpoint->fRefNum);
+	if (myErr != noErr) {
+		theCheckpoint->fRefNum = -1;
+		goto bail;
+	}
+
+	myErr = GetEOF(theCheckpoint->fRefNum, &myFileSize);
+	if (myErr != noErr)
+		goto bail;
+
+	//////////
+	//
+	// read the header, the settings, and the image description
+	//
+	//////////
+
+	myErr = QTCmpr_ReadCheckpointBytes(theCheckpoint->fRefNum, 0L, &myHeader, sizeof(myHeader));
+	if (myErr != noErr)
+		goto bail;
+
+	myPos = sizeof(myHeader);
+
+	if ((myHeader.fSignature != kCheckpointSignature) || (myHeader.fVersion != kCheckpointVersion) ||
+		(myHeader.fSettingsSize <= 0L) || (myHeader.fDescSize < (long)sizeof(ImageDescription)) ||
+		(myHeader.fSettingsSize > myFileSize - myPos) || (myHeader.fDescSize > myFileSize - myPos - myHeader.fSettingsSize)) {
+		myErr = badFileFormat;
+		goto bail;
+	}
+
+	// a checkpoint for some other source movie (or for this one, since changed) is no use to us
+	if (!QTCmpr_IsSameCheckpointSource(&myHeader.fSource, &mySource) ||
+		(myHeader.fSrcTimeScale != GetMovieTimeScale(theSrcMovie)) || (myHeader.fSrcDuration != GetMovieDuration(theSrcMovie))) {
+		myErr = badFileFormat;
+		goto bail;
+	}
+
+	theCheckpoint->fSettings = NewHandle(myHeader.fSettingsSize);
+	theCheckpoint->fDesc = (ImageDescriptionHandle)NewHandle(myHeader.fDescSize);
+	theCheckpoint->fReferences = NewHandle(0);
+	if ((theCheckpoint->fSettings == NULL) || (theCheckpoint->fDesc == NULL) || (theCheckpoint->fReferences == NULL)) {
+		myErr = memFullErr;
+		goto bail;
+	}
+
+	myErr = QTCmpr_ReadCheckpointBytes(theCheckpoint->fRefNum, myPos, *theCheckpoint->fSettings, myHeader.fSettingsSize);
+	if (myErr != noErr)
+		goto bail;
+
+	myPos += myHeader.fSettingsSize;
+
+	myErr = QTCmpr_ReadCheckpointBytes(theCheckpoint->fRefNum, myPos, *theCheckpoint->fDesc, myHeader.fDescSize);
+	if (myErr != noErr)
+		goto bail;
+
+	myPos += myHeader.fDescSize;
+
+	myCheckSum = myHeader.fCheckSum;
+	myHeader.fCheckSum = 0L;
+	myHeader.fCheckSum = QTCmpr_CheckpointSum(0L, &myHeader, sizeof(myHeader));
+	myHeader.fCheckSum = QTCmpr_CheckpointSum(myHeader.fCheckSum, *theCheckpoint->fSettings, myHeader.fSettingsSize);
+	myHeader.fCheckSum = QTCmpr_CheckpointSum(myHeader.fCheckSum, *theCheckpoint->fDesc, myHeader.fDescSize);
+	if (myHeader.fCheckSum != myCheckSum) {
+		myErr = badFileFormat;
+		goto bail;
+	}
+
+	// nor is a checkpoint for frames compressed with other settings
+	if (!QTCmpr_IsSameSettings(theComponent, theCheckpoint->fSettings)) {
+		myErr = badFileFormat;
+		goto bail;
+	}
+
+	//////////
+	//
+	// read the commit records, stopping at the first one that's incomplete or damaged
+	//
+	//////////
+
+	while (myPos + (long)sizeof(myRecord) <= myFileSize) {
+		if (QTCmpr_ReadCheckpointBytes(theCheckpoint->fRefNum, myPos, &myRecord, sizeof(myRecord)) != noErr)
+			break;
+
+		if ((myRecord.fType != kCheckpointCommitType) || (myRecord.fNumReferences < 0L) ||
+			(myRecord.fNumReferences > (myFileSize - myPos - (long)sizeof(myRecord)) / (long)sizeof(SampleReference64Record)))
+			break;
+
+		myRefsSize = myRecord.fNumReferences * sizeof(SampleReference64Record);
+		myOldSize = theCheckpoint->fNumReferences * sizeof(SampleReference64Record);
+
+		SetHandleSize(theCheckpoint->fReferences, myOldSize + myRefsSize);
+		myErr = MemError();
+		if (myErr != noErr)
+			goto bail;
+
+		if (QTCmpr_ReadCheckpointBytes(theCheckpoint->fRefNum, myPos + sizeof(myRecord), *theCheckpoint->fReferences + myOldSize, myRefsSize) != noErr)
+			break;
+
+		myRecordSum = myRecord.fCheckSum;
+		myRecord.fCheckSum = 0L;
+		myCheckSum = QTCmpr_CheckpointSum(0L, &myRecord, sizeof(myRecord));
+		myCheckSum = QTCmpr_CheckpointSum(myCheckSum, *theCheckpoint->fReferences + myOldSize, myRefsSize);
+		if (myCheckSum != myRecordSum)
+			break;
+
+		theCheckpoint->fNumReferences += myRecord.fNumReferences;
+		theCheckpoint->fDataEnd = myRecord.fDataEnd;
+		theCheckpoint->fNextFrame = myRecord.fNextFrame;
+		theCheckpoint->fLastFrame = myRecord.fNextFrame;
+		theCheckpoint->fNextTime = myRecord.fNextTime;
+
+		myPos += sizeof(myRecord) + myRefsSize;
+	}
+
+	SetHandleSize(theCheckpoint->fReferences, theCheckpoint->fNumReferences * sizeof(SampleReference64Record));
+
+	// with nothing committed, there's nothing to resume
+	if (theCheckpoint->fNextFrame <= 0L) {
+		myErr = badFileFormat;
+		goto bail;
+	}
+
+	// throw away any incomplete record, so that the next record follows the last complete one
+	myErr = SetEOF(theCheckpoint->fRefNum, myPos);
+	if (myErr != noErr)
+		goto bail;
+
+	theCheckpoint->fLastTicks = TickCount();
+
+bail:
+	if (myErr != noErr)
+		QTCmpr_CloseCheckpoint(theCheckpoint, false);
+
+	return(myErr);
+}
+
+
+//////////
+//
+// QTCmpr_CheckpointIsDue
+// Is it time to write another commit record? theNextFrame is the source frame it would tell us to continue with.
+//
+// Writing a commit record flushes the sample writer, so if fIntervalFrames isn't 0 we go by the number of frames
+// since the last one, and the new movie file comes out the same however long each frame takes to compress.
+//
+//////////
+
+Boolean QTCmpr_CheckpointIsDue (CheckpointPtr theCheckpoint, long theNextFrame)
+{
+	if ((theCheckpoint == NULL) || (theCheckpoint->fRefNum == -1))
+		return(false);
+
+	if (theCheckpoint->fIntervalFrames > 0L)
+		return(theNextFrame - theCheckpoint->fLastFrame >= theCheckpoint->fIntervalFrames);
+
+	return(TickCount() - theCheckpoint->fLastTicks >= (UInt32)kCheckpointIntervalTicks);
+}
+
+
+//////////
+//
+// QTCmpr_WriteCheckpoint
+// Write out the frames buffered by the sample writer, and then append a commit record to the checkpoint file.
+//
+// The writer must be keeping a log of the sample references it adds (see QTCmpr_KeepSampleLog); theNextFrame and
+// theNextTime tell where to continue compressing the source movie if we resume from this record.
+//
+// The frames must be on disk before a record that commits them is, and the record must be on disk before we go
+// on; so we flush the movie file's data, then write the record, then flush the record.
+//
+//////////
+
+OSErr QTCmpr_WriteCheckpoint (CheckpointPtr theCheckpoint, SampleWriterPtr theWriter, long theNextFrame, TimeValue theNextTime)
+{
+	CheckpointRecord			myRecord;
+	Handle						myLog = NULL;
+	long						myNumReferences = 0L;
+	OSErr						myErr = noErr;
+
+	if ((theCheckpoint == NULL) || (theCheckpoint->fRefNum == -1) || (theWriter == NULL))
+		return(paramErr);
+
+	// the movie file must hold every frame we're about to commit
+	myErr = QTCmpr_FlushSampleWriter(theWriter);
+	if (myErr == noErr)
+		myErr = QTCmpr_SyncSampleWriter(theWriter);
+	if (myErr == noErr)
+		myErr = QTCmpr_SyncCheckpointVolume(theCheckpoint);
+	if (myErr != noErr)
+		return(myErr);
+
+	myLog = QTCmpr_TakeSampleLog(theWriter, &myNumReferences);
+	if (myLog == NULL)
+		return(memFullErr);
+
+	myRecord.fType = kCheckpointCommitType;
+	myRecord.fNumReferences = myNumReferences;
+	myRecord.fDataEnd = theWriter->fDataEnd;
+	myRecord.fNextFrame = theNextFrame;
+	myRecord.fNextTime = theNextTime;
+	myRecord.fCheckSum = 0L;
+
+	HLock(myLog);
+
+	myRecord.fCheckSum = QTCmpr_CheckpointSum(0L, &myRecord, sizeof(myRecord));
+	myRecord.fCheckSum = QTCmpr_CheckpointSum(myRecord.fCheckSum, *myLog, myNumReferences * sizeof(SampleReference64Record));
+
+	myErr = QTCmpr_WriteCheckpointBytes(theCheckpoint->fRefNum, &myRecord, sizeof(myRecord));
+	if (myErr == noErr)
+		myErr = QTCmpr_WriteCheckpointBytes(theCheckpoint->fRefNum, *myLog, myNumReferences * sizeof(SampleReference64Record));
+	if (myErr == noErr)
+		myErr = QTCmpr_SyncCheckpointVolume(theCheckpoint);
+
+	DisposeHandle(myLog);
+
+	theCheckpoint->fLastTicks = TickCount();
+	theCheckpoint->fLastFrame = theNextFrame;
+
+	return(myErr);
+}
+
+
+//////////
+//
+// QTCmpr_DisposeCheckpointState
+// Dispose of the state read by QTCmpr_ReadCheckpoint, leaving the checkpoint file open.
+//
+//////////
+
+void QTCmpr_DisposeCheckpointState (CheckpointPtr theCheckpoint)
+{
+	if (theCheckpoint == NULL)
+		return;
+
+	if (theCheckpoint->fSettings != NULL)
+		DisposeHandle(theCheckpoint->fSettings);
+
+	if (theCheckpoint->fDesc != NULL)
+		DisposeHandle((Handle)theCheckpoint->fDesc);
+
+	if (theCheckpoint->fReferences != NULL)
+		DisposeHandle(theCheckpoint->fReferences);
+
+	theCheckpoint->fSettings = NULL;
+	theCheckpoint->fDesc = NULL;
+	theCheckpoint->fReferences = NULL;
+	theCheckpoint->fNumReferences = 0L;
+}
+
+
+//////////
+//
+// QTCmpr_CloseCheckpoint
+// Close the checkpoint file, and delete it if theDelete is true.
+//
+//////////
+
+void QTCmpr_CloseCheckpoint (CheckpointPtr theCheckpoint, Boolean theDelete)
+{
+	if (theCheckpoint == NULL)
+		return;
+
+	QTCmpr_DisposeCheckpointState(theCheckpoint);
+
+	if (theCheckpoint->fRefNum != -1)
+		FSClose(theCheckpoint->fRefNum);
+	theCheckpoint->fRefNum = -1;
+
+	if (theDelete)
+		FSpDelete(&theCheckpoint->fFile);
+}
+
+
+//////////
+//
+// QTCmpr_InitCheckpoint
+// Set up the fields of a checkpoint for the specified movie file, and make the checkpoint file's specification.
+//
+//////////
+
+static void QTCmpr_InitCheckpoint (CheckpointPtr theCheckpoint, FSSpec *theMovieFile)
+{
+	short						myLength;
+	short						mySuffixLength = strlen(kCheckpointSuffix);
+
+	theCheckpoint->fRefNum = -1;
+	theCheckpoint->fLastTicks = 0L;
+	theCheckpoint->fLastFrame = 0L;
+	theCheckpoint->fIntervalFrames = 0L;
+	theCheckpoint->fSettings = NULL;
+	theCheckpoint->fDesc = NULL;
+	theCheckpoint->fReferences = NULL;
+	theCheckpoint->fNumReferences = 0L;
+	theCheckpoint->fDataEnd.hi = 0;
+	theCheckpoint->fDataEnd.lo = 0;
+	theCheckpoint->fNextFrame = 0L;
+	theCheckpoint->fNextTime = 0L;
+
+	// the checkpoint file is in the same folder as the movie file, and has the movie file's name plus a suffix
+	theCheckpoint->fFile = *theMovieFile;
+
+	myLength = theMovieFile->name[0];
+	if (myLength > kCheckpointMaxNameLength - mySuffixLength)
+		myLength = kCheckpointMaxNameLength - mySuffixLength;
+
+	BlockMoveData(kCheckpointSuffix, &theCheckpoint->fFile.name[myLength + 1], mySuffixLength);
+	theCheckpoint->fFile.name[0] = myLength + mySuffixLength;
+}
+
+
+//////////
+//
+// QTCmpr_GetCheckpointSource
+// Get the identity of the specified source movie file.
+//
+//////////
+
+static OSErr QTCmpr_GetCheckpointSource (FSSpec *theSrcFile, CheckpointSourcePtr theSource)
+{
+	CInfoPBRec					myInfo;
+	Str255						myName;
+	OSErr						myErr = noErr;
+
+	BlockMoveData(theSrcFile->name, myName, theSrcFile->name[0] + 1);
+
+	myInfo.hFileInfo.ioCompletion = NULL;
+	myInfo.hFileInfo.ioNamePtr = myName;
+	myInfo.hFileInfo.ioVRefNum = theSrcFile->vRefNum;
+	myInfo.hFileInfo.ioDirID = theSrcFile->parID;
+	myInfo.hFileInfo.ioFDirIndex = 0;
+
+	myErr = PBGetCatInfoSync(&myInfo);
+	if (myErr != noErr)
+		return(myErr);
+
+	theSource->fFile.vRefNum = theSrcFile->vRefNum;
+	theSource->fFile.parID = theSrcFile->parID;
+	BlockMoveData(theSrcFile->name, theSource->fFile.name, theSrcFile->name[0] + 1);
+	theSource->fDataSize = myInfo.hFileInfo.ioFlLgLen;
+	theSource->fResourceSize = myInfo.hFileInfo.ioFlRLgLen;
+	theSource->fModDate = myInfo.hFileInfo.ioFlMdDat;
+
+	return(noErr);
+}
+
+
+//////////
+//
+// QTCmpr_IsSameCheckpointSource
+// Do the two source identities describe the same, unchanged, file?
+//
+//////////
+
+static Boolean QTCmpr_IsSameCheckpointSource (CheckpointSourcePtr theSource1, CheckpointSourcePtr theSource2)
+{
+	return((theSource1->fFile.vRefNum == theSource2->fFile.vRefNum) &&
+			(theSource1->fFile.parID == theSource2->fFile.parID) &&
+			EqualString(theSource1->fFile.name, theSource2->fFile.name, true, true) &&
+			(theSource1->fDataSize == theSource2->fDataSize) &&
+			(theSource1->fResourceSize == theSource2->fResourceSize) &&
+			(theSource1->fModDate == theSource2->fModDate));
+}
+
+
+//////////
+//
+// QTCmpr_IsSameSettings
+// Are the settings in the specified Standard Compression component the same as the flattened settings in theSettings?
+//
+//////////
+
+static Boolean QTCmpr_IsSameSettings (ComponentInstance theComponent, Handle theSettings)
+{
+	QTAtomContainer				mySettings = NULL;
+	Boolean						isSame = false;
+
+	if (SCGetSettingsAsAtomContainer(theComponent, &mySettings) != noErr)
+		return(false);
+
+	if (GetHandleSize(mySettings) == GetHandleSize(theSettings))
+		isSame = (memcmp(*mySettings, *theSettings, GetHandleSize(theSettings)) == 0);
+
+	QTDisposeAtomContainer(mySettings);
+
+	return(isSame);
+}
+
+
+//////////
+//
+// QTCmpr_SyncCheckpointVolume
+// Make sure that everything written so far to the checkpoint file (and to the movie file, which is in the same
+// folder) is on disk.
+//
+//////////
+
+static OSErr QTCmpr_SyncCheckpointVolume (CheckpointPtr theCheckpoint)
+{
+	return(FlushVol(NULL, theCheckpoint->fFile.vRefNum));
+}
+
+
+//////////
+//
+// QTCmpr_ReadCheckpointBytes
+// Read the specified number of bytes from the specified position in the checkpoint file.
+//
+//////////
+
+static OSErr QTCmpr_ReadCheckpointBytes (short theRefNum, long thePos, void *theData, long theSize)
+{
+	long						myCount = theSize;
+	OSErr						myErr = noErr;
+
+	myErr = SetFPos(theRefNum, fsFromStart, thePos);
+	if (myErr != noErr)
+		return(myErr);
+
+	myErr = FSRead(theRefNum, &myCount, theData);
+	if ((myErr == noErr) && (myCount != theSize))
+		myErr = eofErr;
+
+	return(myErr);
+}
+
+
+//////////
+//
+// QTCmpr_WriteCheckpointBytes
+// Append the specified bytes to the checkpoint file.
+//
+//////////
+
+static OSErr QTCmpr_WriteCheckpointBytes (short theRefNum, void *theData, long theSize)
+{
+	long						myCount = theSize;
+	OSErr						myErr = noErr;
+
+	if (theSize == 0L)
+		return(noErr);
+
+	myErr = SetFPos(theRefNum, fsFromLEOF, 0L);
+	if (myErr != noErr)
+		return(myErr);
+
+	myErr = FSWrite(theRefNum, &myCount, theData);
+	if ((myErr == noErr) && (myCount != theSize))
+		myErr = ioErr;
+
+	return(myErr);
+}
+
+
+//////////
+//
+// QTCmpr_CheckpointSum
+// Add the specified bytes to a running checksum.
+//
+//////////
+
+static UInt32 QTCmpr_CheckpointSum (UInt32 theSum, void *theData, long theSize)
+{
+	UInt8						*myBytes = (UInt8 *)theData;
+	long						myIndex;
+
+	for (myIndex = 0L; myIndex < theSize; myIndex++)
+		theSum = ((theSum << 5) | (theSum >> 27)) + myBytes[myIndex];
+
+	return(theSum);
+}
@@ -0,0 +1,136 @@
+//////////
+//
+//	File:		QTCmprCheckpoint.h
+//
+//	Contains:	Checkpoints for long sequence compressions, so that a compression that fails part way through
+//				can be resumed, for use by QTCompress.
+//
+//	Written by:	Tim Monroe
+//
+//	Copyright:	 2000 by Apple Computer, Inc., all rights reserved.
+//
+//	Change History (most recent first):
+//
+//	   <4>	 	11/13/26	rtm		version 3: the movie file's data is in a movie data atom, so older files can't be resumed
+//	   <3>	 	11/13/26	rtm		the header identifies the source file, and is checked against the source and the settings
+//	   <2>	 	11/11/26	rtm		commit records can be written every so many frames, instead of every few seconds
+//	   <1>	 	10/28/26	rtm		first file
+//
+//////////
+
+#pragma once
+
+
+//////////
+//
+// header files
+//
+//////////
+
+#ifndef __QTCmprCheckpoint__
+#define __QTCmprCheckpoint__
+
+#ifndef __MOVIES__
+#include <Movies.h>
+#endif
+
+#ifndef __QUICKTIMECOMPONENTS__
+#include <QuickTimeComponents.h>
+#endif
+
+#include "QTCmprWriter.h"
+
+
+//////////
+//
+// constants
+//
+//////////
+
+#define kCheckpointSignature			FOUR_CHAR_CODE('QTCk')	// the start of a checkpoint file, and its file type
+#define kCheckpointCommitType			FOUR_CHAR_CODE('cmit')	// the type of a commit record
+#define kCheckpointVersion				3L
+#define kCheckpointSuffix				".ckpt"					// appended to the movie file's name to get the checkpoint file's name
+#define kCheckpointMaxNameLength		31						// the longest file name we create
+#define kCheckpointIntervalTicks		(2L * 60L)				// the time between checkpoints (2 seconds)
+#define kCheckpointIntervalFrames		60L						// the frames between checkpoints, when they're counted in frames
+
+
+//////////
+//
+// data types
+//
+//////////
+
+// the identity of a source movie file: where it is, how big it is, and when it was last changed
+typedef struct CheckpointSource {
+	FSSpec						fFile;
+	long						fDataSize;							// the logical size of the data fork
+	long						fResourceSize;						// the logical size of the resource fork
+	UInt32						fModDate;							// the modification date, in seconds
+} CheckpointSource, *CheckpointSourcePtr;
+
+// the header at the start of a checkpoint file; it's followed by the compression settings (as a flattened atom
+// container) and the image description of the compressed frames
+typedef struct CheckpointHeader {
+	OSType						fSignature;							// kCheckpointSignature
+	long						fVersion;							// kCheckpointVersion
+	CheckpointSource			fSource;							// the source movie file
+	TimeScale					fSrcTimeScale;						// the time scale of the source movie
+	TimeValue					fSrcDuration;						// the duration of the source movie
+	long						fSettingsSize;
+	long						fDescSize;
+	UInt32						fCheckSum;							// the checksum of the header (with this field set to 0) and the data that follows it
+} CheckpointHeader, *CheckpointHeaderPtr;
+
+// a commit record; it's followed by the sample references added to the media since the previous commit record
+typedef struct CheckpointRecord {
+	OSType						fType;								// kCheckpointCommitType
+	long						fNumReferences;						// the number of SampleReference64Record structures that follow
+	wide						fDataEnd;							// the end of the committed data in the movie file
+	long						fNextFrame;							// the number of the next source frame to compress
+	TimeValue					fNextTime;							// the time of that frame in the source movie
+	UInt32						fCheckSum;							// the checksum of the record (with this field set to 0) and the references
+} CheckpointRecord, *CheckpointRecordPtr;
+
+// a checkpoint file, open for appending commit records
+typedef struct Checkpoint {
+	FSSpec						fFile;
+	short						fRefNum;							// the checkpoint file, or -1
+	UInt32						fLastTicks;							// the time of the last commit record
+	long						fLastFrame;							// the next source frame, as of the last commit record
+	long						fIntervalFrames;					// if not 0, the frames between commit records (instead of the time)
+
+	// the state read from an existing checkpoint file
+	QTAtomContainer				fSettings;							// the compression settings
+	ImageDescriptionHandle		fDesc;								// the image description of the committed frames
+	Handle						fReferences;						// the sample references of the committed frames
+	long						fNumReferences;
+	wide						fDataEnd;
+	long						fNextFrame;
+	TimeValue					fNextTime;
+} Checkpoint, *CheckpointPtr;
+
+
+//////////
+//
+// function prototypes
+//
+//////////
+
+OSErr							QTCmpr_CreateCheckpoint (CheckpointPtr theCheckpoint, FSSpec *theMovieFile, FSSpec *theSrcFile, Movie theSrcMovie, ComponentInstance theComponent, ImageDescriptionHandle theDesc);
+OSErr							QTCmpr_ReadCheckpoint (CheckpointPtr theCheckpoint, FSSpec *theMovieFile, FSSpec *theSrcFile, Movie theSrcMovie, ComponentInstance theComponent);
+Boolean							QTCmpr_CheckpointIsDue (CheckpointPtr theCheckpoint, long theNextFrame);
+OSErr							QTCmpr_WriteCheckpoint (CheckpointPtr theCheckpoint, SampleWriterPtr theWriter, long theNextFrame, TimeValue theNextTime);
+void							QTCmpr_DisposeCheckpointState (CheckpointPtr theCheckpoint);
+void							QTCmpr_CloseCheckpoint (CheckpointPtr theCheckpoint, Boolean theDelete);
+static void						QTCmpr_InitCheckpoint (CheckpointPtr theCheckpoint, FSSpec *theMovieFile);
+static OSErr					QTCmpr_GetCheckpointSource (FSSpec *theSrcFile, CheckpointSourcePtr theSource);
+static Boolean					QTCmpr_IsSameCheckpointSource (CheckpointSourcePtr theSource1, CheckpointSourcePtr theSource2);
+static Boolean					QTCmpr_IsSameSettings (ComponentInstance theComponent, Handle theSettings);
+static OSErr					QTCmpr_SyncCheckpointVolume (CheckpointPtr theCheckpoint);
+static OSErr					QTCmpr_ReadCheckpointBytes (short theRefNum, long thePos, void *theData, long theSize);
+static OSErr					QTCmpr_WriteCheckpointBytes (short theRefNum, void *theData, long theSize);
+static UInt32					QTCmpr_CheckpointSum (UInt32 theSum, void *theData, long theSize);
+
+#endif	// __QTCmprCheckpoint__
@@ -0,0 +1,983 @@
+//////////
+//
+//	File:		QTCmprColor.c
+//
+//	Contains:	Conversions between 32-bit RGB frames and Y'CbCr 4:2:0 and 4:2:2 frames, for use by QTCompress.
+//
+//	Written by:	Tim Monroe
+//
+//	Copyright:	 2000 by Apple Computer, Inc., all rights reserved.
+//
+//	Change History (most recent first):
+//
+//	   <5>	 	11/13/26	rtm		added QTCmpr_AddColorExtension, so that BT.709 frames say so
+//	   <4>	 	11/07/26	rtm		frames are converted in slices, on the threads in QTCmprSlice.c
+//	   <3>	 	11/04/26	rtm		added QTCmpr_ConvertRowsToYUV, so that only the rows that changed need converting
+//	   <2>	 	11/02/26	rtm		made QTCmpr_HasSSE2 public, for QTCmprResize.c
+//	   <1>	 	11/01/26	rtm		first file
+//
+//	Many compressors work in Y'CbCr. Given an RGB frame, such a compressor converts it to Y'CbCr itself, usually a
+//	pixel at a time. If the compressor says (in its 'cpix' resource) that it also accepts 4:2:2 ('2vuy') or 4:2:0
+//	('y420') frames, we can do the conversion ourselves, once per frame, and hand it the result.
+//
+//	Each conversion is done a row at a time, by one of a set of row routines. There is a plain C version of each
+//	routine, and on x86 processors with SSE2 a version that converts 8 pixels at a time. The two versions use the
+//	same integer arithmetic, so they produce the same bytes; the first time the routines are needed, we run both
+//	versions on a small test frame and use the SSE2 versions only if they match.
+//
+//	We use the ITU-R BT.601 coefficients for standard definition frames and the BT.709 coefficients for anything
+//	taller than kColorHDHeight; Y'CbCr values are video range (Y' from 16 to 235, Cb and Cr from 16 to 240). Chroma
+//	is the average of the 2 (for 4:2:2) or 4 (for 4:2:0) pixels it covers; at an odd right or bottom edge, the last
+//	column or row counts twice.
+//
+//	A decompressor that isn't told otherwise takes Y'CbCr to be BT.601, so when we use the BT.709 coefficients we
+//	say so in the image description of the compressed frames, with an 'nclc' color parameters extension (see
+//	QTCmpr_AddColorExtension).
+//
+//	The rows of a frame are independent, so a large frame is converted in slices, on several threads at once (see
+//	QTCmprSlice.c); a 24-bit source needs two rows of scratch memory for each slice.
+//
+//	The same row routines convert Y'CbCr to RGB (for QTCmprIngest.c), with each chroma sample covering 2 pixels.
+//
+//////////
+
+//////////
+//
+// header files
+//
+//////////
+
+#include "QTCompress.h"
+
+
+//////////
+//
+// global variables
+//
+//////////
+
+static ColorKernels					gColorKernels;						// the row routines we use
+static Boolean						gColorKernelsReady = false;
+
+// the C row routines, which are also the reference for the SSE2 ones
+static ColorKernels					gColorKernels_C = {QTCmpr_ToYRow_C, QTCmpr_ToCbCrRow_C, QTCmpr_To2vuyRow_C, QTCmpr_FromYCbCrRow_C, "C"};
+
+#if USE_SSE2_KERNELS
+static ColorKernels					gColorKernels_SSE2 = {QTCmpr_ToYRow_SSE2, QTCmpr_ToCbCrRow_SSE2, QTCmpr_To2vuyRow_SSE2, QTCmpr_FromYCbCrRow_SSE2, "SSE2"};
+#endif
+
+// the coefficients, in the order of the fields of ColorParams (forward, then inverse)
+static long							gColor601Coefs[17] = {	66, 129, 25,	-38, -74, 112,		112, -94, -18,
+															298, 409,		298, -100, -208,	298, 516 };
+static long							gColor709Coefs[17] = {	47, 157, 16,	-26, -87, 113,		112, -102, -10,
+															298, 459,		298, -55, -136,		298, 541 };
+
+// the rounding constants; Y' is offset by 16, and Cb and Cr by 128
+#define kColorYOffset				((16L << kColorFixedShift) + (1L << (kColorFixedShift - 1)))
+#define kColorCOffset				((128L << kColorFixedShift) + (1L << (kColorFixedShift - 1)))
+#define kColorRound					(1L << (kColorFixedShift - 1))
+
+
+//////////
+//
+// QTCmpr_GetCompressorYUVFormat
+// Return the Y'CbCr pixel format (k2vuyPixelFormat or kYUV420PixelFormat) that a compressor of the specified type
+// accepts, or 0 if it accepts neither.
+//
+// If it accepts both, we use the one it lists first, which is presumably the one it prefers.
+//
+//////////
+
+OSType QTCmpr_GetCompressorYUVFormat (CodecType theCodecType)
+{
+	CompressorComponent			myCompressor = NULL;
+	Handle						myFormats = NULL;
+	OSType						myFormat;
+	long						myIndex;
+	long						myCount;
+
+	if ((FindCodec(theCodecType, anyCodec, &myCompressor, NULL) != noErr) || (myCompressor == NULL))
+		return(0L);
+
+	if ((GetComponentPublicResource(myCompressor, FOUR_CHAR_CODE('cpix'), 1, &myFormats) != noErr) || (myFormats == NULL))
+		return(0L);
+
+	myCount = GetHandleSize(myFormats) / sizeof(OSType);
+	for (myIndex = 0; myIndex < myCount; myIndex++) {
+		myFormat = EndianU32_BtoN(((OSType *)*myFormats)[myIndex]);
+		if ((myFormat == k2vuyPixelFormat) || (myFormat == kYUV420PixelFormat))
+			break;
+	}
+
+	DisposeHandle(myFormats);
+
+	return((myIndex < myCount) ? myFormat : 0L);
+}
+
+
+//////////
+//
+// QTCmpr_NewColorConverter
+// Prepare to convert the frames in the specified RGB pixel map to the specified Y'CbCr pixel format.
+//
+// The pixel map must be 32-bit ARGB or BGRA, or 24-bit RGB. Call QTCmpr_DisposeColorConverter even if this
+// function fails.
+//
+//////////
+
+OSErr QTCmpr_NewColorConverter (ColorConverterPtr theConverter, PixMapHandle theSrcPixMap, OSType theFormat, MemoryJobPtr theJob)
+{
+	OSType						mySrcFormat;
+	Rect						myRect;
+	OSErr						myErr = noErr;
+
+	if (theConverter == NULL)
+		return(paramErr);
+
+	theConverter->fSrcPixMap = theSrcPixMap;
+	theConverter->fFormat = theFormat;
+	theConverter->fGWorld = NULL;
+	theConverter->fPixMap = NULL;
+	theConverter->fRows = NULL;
+	theConverter->fMatrix = kColorMatrix601;
+	theConverter->fNumFrames = 0L;
+	theConverter->fConvertTime = 0.0;
+	theConverter->fSize = 0L;
+	theConverter->fJob = theJob;
+
+	if (theSrcPixMap == NULL)
+		return(paramErr);
+
+	// a 32-bit pixel map that doesn't say otherwise is ARGB
+	mySrcFormat = (**theSrcPixMap).pixelFormat;
+	if ((mySrcFormat != k32BGRAPixelFormat) && (mySrcFormat != k24RGBPixelFormat)) {
+		if (GetPixDepth(theSrcPixMap) != 32)
+			return(paramErr);
+		mySrcFormat = k32ARGBPixelFormat;
+	}
+
+	if ((theFormat != k2vuyPixelFormat) && (theFormat != kYUV420PixelFormat))
+		return(paramErr);
+
+	GetPixBounds(theSrcPixMap, &myRect);
+	theConverter->fWidth = myRect.right - myRect.left;
+	theConverter->fHeight = myRect.bottom - myRect.top;
+
+	// 4:2:2 frames take 2 bytes per pixel, and 4:2:0 frames 1.5 bytes per pixel; 24-bit rows are first
+	// widened to 32 bits, two at a time
+	if (theFormat == k2vuyPixelFormat)
+		theConverter->fSize = ((theConverter->fWidth + 1) & ~1L) * 2L * theConverter->fHeight;
+	else
+		theConverter->fSize = (theConverter->fWidth * theConverter->fHeight) + (((theConverter->fWidth + 1) / 2) * ((theConverter->fHeight + 1) / 2) * 2L);
+
+	if (mySrcFormat == k24RGBPixelFormat)
+		theConverter->fSize += 2L * theConverter->fWidth * sizeof(UInt32) * QTCmpr_GetMaxSlices();
+
+	QTCmpr_ReserveMemory(theJob, theConverter->fSize);
+
+	if (mySrcFormat == k24RGBPixelFormat) {
+		theConverter->fRows = (UInt32 *)NewPtr(2L * theConverter->fWidth * sizeof(UInt32) * QTCmpr_GetMaxSlices());
+		if (theConverter->fRows == NULL)
+			return(memFullErr);
+	}
+
+	myErr = QTNewGWorld(&theConverter->fGWorld, theFormat, &myRect, NULL, NULL, 0L);
+	if (myErr != noErr) {
+		theConverter->fGWorld = NULL;
+		return(myErr);
+	}
+
+	theConverter->fPixMap = GetGWorldPixMap(theConverter->fGWorld);
+	if (!LockPixels(theConverter->fPixMap))
+		return(memFullErr);
+
+	// a widened 24-bit row is in ARGB order
+	theConverter->fMatrix = (theConverter->fHeight > kColorHDHeight) ? kColorMatrix709 : kColorMatrix601;
+	QTCmpr_SetColorParams(&theConverter->fParams, theConverter->fMatrix, (mySrcFormat == k24RGBPixelFormat) ? NULL : theSrcPixMap);
+
+	return(noErr);
+}
+
+
+//////////
+//
+// QTCmpr_AddColorExtension
+// Add to the specified image description of the converter's compressed frames the color parameters that the
+// converter used, if they aren't the ones a decompressor would assume.
+//
+// For BT.709 frames, we add an 'nclc' extension giving the BT.709 primaries, transfer function, and matrix; BT.601
+// frames are left as they are, since that's what an image description without the extension means.
+//
+//////////
+
+OSErr QTCmpr_AddColorExtension (ColorConverterPtr theConverter, ImageDescriptionHandle theDesc)
+{
+	Handle						myExtension = NULL;
+	UInt8						*myBytes;
+	OSErr						myErr = noErr;
+
+	if ((theConverter == NULL) || (theDesc == NULL))
+		return(paramErr);
+
+	if (theConverter->fMatrix != kColorMatrix709)
+		return(noErr);
+
+	myExtension = NewHandle(kColorInfoNCLCSize);
+	if (myExtension == NULL)
+		return(memFullErr);
+
+	// the type, then the primaries, the transfer function, and the matrix, in big-endian byte order
+	myBytes = (UInt8 *)*myExtension;
+	myBytes[0] = (UInt8)(kColorInfoNCLCType >> 24);
+	myBytes[1] = (UInt8)(kColorInfoNCLCType >> 16);
+	myBytes[2] = (UInt8)(kColorInfoNCLCType >> 8);
+	myBytes[3] = (UInt8)kColorInfoNCLCType;
+	myBytes[4] = 0;
+	myBytes[5] = kColorInfoCode709;
+	myBytes[6] = 0;
+	myBytes[7] = kColorInfoCode709;
+	myBytes[8] = 0;
+	myBytes[9] = kColorInfoCode709;
+
+	myErr = AddImageDescriptionExtension(theDesc, myExtension, kColorInfoExtensionType);
+
+	DisposeHandle(myExtension);
+
+	return(myErr);
+}
+
+
+//////////
+//
+// QTCmpr_ConvertFrameToYUV
+// Convert the frame in the converter's RGB pixel map to Y'CbCr, in the converter's own pixel map.
+//
+//////////
+
+void QTCmpr_ConvertFrameToYUV (ColorConverterPtr theConverter)
+{
+	QTCmpr_ConvertRowsToYUV(theConverter, 0L, theConverter->fHeight);
+}
+
+
+//////////
+//
+// QTCmpr_ConvertRowsToYUV
+// Convert rows theTop through theBottom - 1 of the frame in the converter's RGB pixel map to Y'CbCr; the other
+// rows of the converter's pixel map are left as they were.
+//
+// Chroma rows of a 4:2:0 frame cover 2 rows each, so we may convert one row more at the top.
+//
+//////////
+
+void QTCmpr_ConvertRowsToYUV (ColorConverterPtr theConverter, long theTop, long theBottom)
+{
+	UnsignedWide				myStart, myEnd;
+
+	Microseconds(&myStart);
+
+	if (theTop < 0L)
+		theTop = 0L;
+	if (theBottom > theConverter->fHeight)
+		theBottom = theConverter->fHeight;
+
+	// make sure the row routines are chosen before any other thread needs them
+	QTCmpr_GetColorKernels();
+
+	if (theConverter->fFormat == k2vuyPixelFormat)
+		QTCmpr_RunSlices(QTCmpr_ConvertSlice, theConverter, theTop, theBottom, 1L);
+	else
+		QTCmpr_RunSlices(QTCmpr_ConvertSlice, theConverter, theTop & ~1L, theBottom, 2L);
+
+	Microseconds(&myEnd);
+
+	theConverter->fConvertTime += ((double)myEnd.hi - (double)myStart.hi) * 4294967296.0 + ((double)myEnd.lo - (double)myStart.lo);
+	theConverter->fNumFrames++;
+}
+
+
+//////////
+//
+// QTCmpr_ConvertSlice
+// Convert rows theTop through theBottom - 1 of the frame in the converter's RGB pixel map to Y'CbCr; for a 4:2:0
+// frame, theTop must be even.
+//
+// This is called on the threads in the slice pool.
+//
+//////////
+
+static void QTCmpr_ConvertSlice (void *theRefCon, long theSlice, long theTop, long theBottom)
+{
+	ColorConverterPtr			myConverter = (ColorConverterPtr)theRefCon;
+	ColorKernelsPtr				myKernels = QTCmpr_GetColorKernels();
+	UInt8						*myBaseAddr = (UInt8 *)GetPixBaseAddr(myConverter->fPixMap);
+	long						myWidth = myConverter->fWidth;
+	UInt32						*mySrc0, *mySrc1;
+	long						myRow;
+
+	if (myConverter->fFormat == k2vuyPixelFormat) {
+		long					myRowBytes = QTGetPixMapHandleRowBytes(myConverter->fPixMap);
+
+		for (myRow = theTop; myRow < theBottom; myRow++) {
+			mySrc0 = QTCmpr_GetConverterRow(myConverter, myRow, 2L * theSlice);
+			myKernels->fTo2vuy(mySrc0, myBaseAddr + (myRow * myRowBytes), myWidth, &myConverter->fParams);
+		}
+	} else {
+		// the pixel map of a 4:2:0 graphics world begins with a description of where the planes are
+		PlanarPixmapInfoYUV420	*myInfo = (PlanarPixmapInfoYUV420 *)myBaseAddr;
+		UInt8					*myY = myBaseAddr + EndianS32_BtoN(myInfo->componentInfoY.offset);
+		UInt8					*myCb = myBaseAddr + EndianS32_BtoN(myInfo->componentInfoCb.offset);
+		UInt8					*myCr = myBaseAddr + EndianS32_BtoN(myInfo->componentInfoCr.offset);
+		long					myYRowBytes = EndianU32_BtoN(myInfo->componentInfoY.rowBytes);
+		long					myCbRowBytes = EndianU32_BtoN(myInfo->componentInfoCb.rowBytes);
+		long					myCrRowBytes = EndianU32_BtoN(myInfo->componentInfoCr.rowBytes);
+
+		for (myRow = theTop; myRow < theBottom; myRow += 2) {
+			mySrc0 = QTCmpr_GetConverterRow(myConverter, myRow, 2L * theSlice);
+			myKernels->fToY(mySrc0, myY + (myRow * myYRowBytes), myWidth, &myConverter->fParams);
+
+			if (myRow + 1 < theBottom) {
+				mySrc1 = QTCmpr_GetConverterRow(myConverter, myRow + 1, (2L * theSlice) + 1L);
+				myKernels->fToY(mySrc1, myY + ((myRow + 1) * myYRowBytes), myWidth, &myConverter->fParams);
+			} else {
+				mySrc1 = mySrc0;
+			}
+
+			myKernels->fToCbCr(mySrc0, mySrc1, myCb + ((myRow / 2) * myCbRowBytes), myCr + ((myRow / 2) * myCrRowBytes), myWidth, &myConverter->fParams);
+		}
+	}
+}
+
+
+//////////
+//
+// QTCmpr_DisposeColorConverter
+// Dispose of the converter's Y'CbCr graphics world, and report how long the conversions took.
+//
+//////////
+
+void QTCmpr_DisposeColorConverter (ColorConverterPtr theConverter)
+{
+	if (theConverter == NULL)
+		return;
+
+	if (theConverter->fNumFrames > 0L)
+		QTCmpr_LogMessage("QTCmpr_DisposeColorConverter: converted %ld frames to %s with the %s routines, %.0f us per frame",
+							theConverter->fNumFrames, (theConverter->fFormat == k2vuyPixelFormat) ? "4:2:2" : "4:2:0",
+							QTCmpr_GetColorKernels()->fName, theConverter->fConvertTime / theConverter->fNumFrames);
+
+	if (theConverter->fGWorld != NULL)
+		DisposeGWorld(theConverter->fGWorld);
+	theConverter->fGWorld = NULL;
+	theConverter->fPixMap = NULL;
+
+	if (theConverter->fRows != NULL)
+		DisposePtr((Ptr)theConverter->fRows);
+	theConverter->fRows = NULL;
+
+	QTCmpr_ReleaseMemory(theConverter->fJob, theConverter->fSize);
+	theConverter->fSize = 0L;
+}
+
+
+//////////
+//
+// QTCmpr_SetColorParams
+// Set up the parameters for converting rows of the specified 32-bit pixel map with the specified coefficients.
+//
+// If thePixMap is NULL, the pixels are in ARGB order.
+//
+//////////
+
+void QTCmpr_SetColorParams (ColorParamsPtr theParams, long theMatrix, PixMapHandle thePixMap)
+{
+	long						*myCoefs = (theMatrix == kColorMatrix709) ? gColor709Coefs : gColor601Coefs;
+	short						myA = 0, myR = 1, myG = 2, myB = 3;		// the byte offsets of the components
+	short						myIndex;
+
+	for (myIndex = 0; myIndex < 3; myIndex++) {
+		theParams->fYCoef[myIndex] = myCoefs[myIndex];
+		theParams->fCbCoef[myIndex] = myCoefs[3 + myIndex];
+		theParams->fCrCoef[myIndex] = myCoefs[6 + myIndex];
+		theParams->fGCoef[myIndex] = myCoefs[11 + myIndex];
+	}
+
+	for (myIndex = 0; myIndex < 2; myIndex++) {
+		theParams->fRCoef[myIndex] = myCoefs[9 + myIndex];
+		theParams->fBCoef[myIndex] = myCoefs[14 + myIndex];
+	}
+
+	if ((thePixMap != NULL) && ((**thePixMap).pixelFormat == k32BGRAPixelFormat)) {
+		myB = 0;
+		myG = 1;
+		myR = 2;
+		myA = 3;
+	}
+
+	// we load each pixel as a 32-bit word, so the shift that gets at a byte depends on the byte order
+#if TARGET_RT_LITTLE_ENDIAN
+	theParams->fAShift = myA * 8;
+	theParams->fRShift = myR * 8;
+	theParams->fGShift = myG * 8;
+	theParams->fBShift = myB * 8;
+#else
+	theParams->fAShift = 24 - (myA * 8);
+	theParams->fRShift = 24 - (myR * 8);
+	theParams->fGShift = 24 - (myG * 8);
+	theParams->fBShift = 24 - (myB * 8);
+#endif
+}
+
+
+//////////
+//
+// QTCmpr_ConvertYCbCrRow
+// Convert a row of video-range Y'CbCr pixels, with each chroma sample covering 2 pixels, to 32-bit RGB.
+//
+//////////
+
+void QTCmpr_ConvertYCbCrRow (UInt8 *theY, UInt8 *theCb, UInt8 *theCr, UInt8 *theDst, long theWidth, ColorParamsPtr theParams)
+{
+	QTCmpr_GetColorKernels()->fFromYCbCr(theY, theCb, theCr, (UInt32 *)theDst, theWidth, theParams);
+}
+
+
+//////////
+//
+// QTCmpr_GetColorKernels
+// Return the row routines to use: the SSE2 ones, if the processor has SSE2 and they give the same results as the
+// C ones, or else the C ones.
+//
+//////////
+
+static ColorKernelsPtr QTCmpr_GetColorKernels (void)
+{
+	if (!gColorKernelsReady) {
+		gColorKernels = gColorKernels_C;
+
+#if USE_SSE2_KERNELS
+		if (QTCmpr_HasSSE2()) {
+			if (QTCmpr_CheckColorKernels(&gColorKernels_SSE2, &gColorKernels_C))
+				gColorKernels = gColorKernels_SSE2;
+			else
+				QTCmpr_LogMessage("QTCmpr_GetColorKernels: the SSE2 routines don't match the C routines; using the C routines");
+		}
+#endif
+
+		gColorKernelsReady = true;
+	}
+
+	return(&gColorKernels);
+}
+
+
+//////////
+//
+// QTCmpr_CheckColorKernels
+// Do the specified row routines produce exactly the same results as the reference routines?
+//
+// We convert a test frame with both sets of coefficients and both component orders; the frame is wide enough to
+// exercise both the 8-pixel loops and the leftover pixels, and its pixels cover the full range of each component.
+//
+//////////
+
+static Boolean QTCmpr_CheckColorKernels (ColorKernelsPtr theKernels, ColorKernelsPtr theReference)
+{
+	UInt32						myRGB[kColorCheckHeight][kColorCheckWidth];
+	UInt8						myPlanes[2][3][(kColorCheckWidth + 1) * 2];	// Y', Cb, and Cr, or 4:2:2
+	UInt32						myResults[2][kColorCheckWidth];
+	ColorKernelsPtr				myKernels[2];
+	ColorParams					myParams;
+	unsigned long				mySeed = 1L;
+	long						myPass, myRow, myCol, myIndex;
+
+	myKernels[0] = theKernels;
+	myKernels[1] = theReference;
+
+	for (myRow = 0; myRow < kColorCheckHeight; myRow++) {
+		for (myCol = 0; myCol < kColorCheckWidth; myCol++) {
+			mySeed = (mySeed * 1103515245L) + 12345L;
+			myRGB[myRow][myCol] = (UInt32)mySeed ^ (UInt32)(mySeed >> 16);
+		}
+	}
+
+	// the first and last pixels are black and white
+	myRGB[0][0] = 0x00000000;
+	myRGB[0][kColorCheckWidth - 1] = 0xFFFFFFFF;
+
+	for (myPass = 0; myPass < 4; myPass++) {
+		QTCmpr_SetColorParams(&myParams, (myPass & 1) ? kColorMatrix709 : kColorMatrix601, NULL);
+
+		// the second two passes use BGRA order
+		if (myPass >= 2) {
+			short		myShift = myParams.fAShift;
+
+			myParams.fAShift = myParams.fBShift;
+			myParams.fBShift = myShift;
+			myShift = myParams.fRShift;
+			myParams.fRShift = myParams.fGShift;
+			myParams.fGShift = myShift;
+		}
+
+		for (myRow = 0; myRow + 1 < kColorCheckHeight; myRow++) {
+			for (myIndex = 0; myIndex < 2; myIndex++) {
+				myKernels[myIndex]->fToY(myRGB[myRow], myPlanes[myIndex][0], kColorCheckWidth, &myParams);
+				myKernels[myIndex]->fToCbCr(myRGB[myRow], myRGB[myRow + 1], myPlanes[myIndex][1], myPlanes[myIndex][2], kColorCheckWidth, &myParams);
+				myKernels[myIndex]->fFromYCbCr((UInt8 *)myRGB[myRow], (UInt8 *)myRGB[myRow + 1], (UInt8 *)myRGB[myRow] + kColorCheckWidth, myResults[myIndex], kColorCheckWidth, &myParams);
+			}
+
+			if ((memcmp(myPlanes[0][0], myPlanes[1][0], kColorCheckWidth) != 0) ||
+				(memcmp(myPlanes[0][1], myPlanes[1][1], (kColorCheckWidth + 1) / 2) != 0) ||
+				(memcmp(myPlanes[0][2], myPlanes[1][2], (kColorCheckWidth + 1) / 2) != 0) ||
+				(memcmp(myResults[0], myResults[1], sizeof(myResults[0])) != 0))
+				return(false);
+
+			for (myIndex = 0; myIndex < 2; myIndex++)
+				myKernels[myIndex]->fTo2vuy(myRGB[myRow], myPlanes[myIndex][0], kColorCheckWidth, &myParams);
+
+			if (memcmp(myPlanes[0][0], myPlanes[1][0], ((kColorCheckWidth + 1) / 2) * 4) != 0)
+				return(false);
+		}
+	}
+
+	return(true);
+}
+
+
+//////////
+//
+// QTCmpr_GetConverterRow
+// Return the specified row of the converter's RGB pixel map as 32-bit pixels; a 24-bit row is widened into the
+// specified slot of the converter's row buffer.
+//
+//////////
+
+static UInt32 *QTCmpr_GetConverterRow (ColorConverterPtr theConverter, long theRow, long theSlot)
+{
+	UInt8						*mySrc = (UInt8 *)GetPixBaseAddr(theConverter->fSrcPixMap) + (theRow * QTGetPixMapHandleRowBytes(theConverter->fSrcPixMap));
+	UInt8						*myDst;
+	long						myCol;
+
+	if (theConverter->fRows == NULL)
+		return((UInt32 *)mySrc);
+
+	myDst = (UInt8 *)(theConverter->fRows + (theSlot * theConverter->fWidth));
+	for (myCol = 0; myCol < theConverter->fWidth; myCol++) {
+		myDst[0] = 0xFF;
+		myDst[1] = mySrc[0];
+		myDst[2] = mySrc[1];
+		myDst[3] = mySrc[2];
+		myDst += 4;
+		mySrc += 3;
+	}
+
+	return(theConverter->fRows + (theSlot * theConverter->fWidth));
+}
+
+
+//////////
+//
+// QTCmpr_ToYRow_C
+// Convert a row of 32-bit RGB pixels to Y'.
+//
+//////////
+
+static void QTCmpr_ToYRow_C (UInt32 *theSrc, UInt8 *theY, long theWidth, ColorParamsPtr theParams)
+{
+	long						myCol;
+	long						myR, myG, myB;
+
+	for (myCol = 0; myCol < theWidth; myCol++) {
+		myR = (theSrc[myCol] >> theParams->fRShift) & 0xFF;
+		myG = (theSrc[myCol] >> theParams->fGShift) & 0xFF;
+		myB = (theSrc[myCol] >> theParams->fBShift) & 0xFF;
+
+		theY[myCol] = (UInt8)(((theParams->fYCoef[0] * myR) + (theParams->fYCoef[1] * myG) + (theParams->fYCoef[2] * myB) + kColorYOffset) >> kColorFixedShift);
+	}
+}
+
+
+//////////
+//
+// QTCmpr_ToCbCrRow_C
+// Convert two rows of 32-bit RGB pixels to a row of 4:2:0 Cb and Cr; each chroma sample is the average of 2x2 pixels.
+//
+//////////
+
+static void QTCmpr_ToCbCrRow_C (UInt32 *theSrc0, UInt32 *theSrc1, UInt8 *theCb, UInt8 *theCr, long theWidth, ColorParamsPtr theParams)
+{
+	long						myCol, myNext;
+	long						myR, myG, myB;
+
+	for (myCol = 0; myCol < theWidth; myCol += 2) {
+		myNext = (myCol + 1 < theWidth) ? myCol + 1 : myCol;
+
+		myR = (((theSrc0[myCol] >> theParams->fRShift) & 0xFF) + ((theSrc0[myNext] >> theParams->fRShift) & 0xFF) +
+				((theSrc1[myCol] >> theParams->fRShift) & 0xFF) + ((theSrc1[myNext] >> theParams->fRShift) & 0xFF) + 2) >> 2;
+		myG = (((theSrc0[myCol] >> theParams->fGShift) & 0xFF) + ((theSrc0[myNext] >> theParams->fGShift) & 0xFF) +
+				((theSrc1[myCol] >> theParams->fGShift) & 0xFF) + ((theSrc1[myNext] >> theParams->fGShift) & 0xFF) + 2) >> 2;
+		myB = (((theSrc0[myCol] >> theParams->fBShift) & 0xFF) + ((theSrc0[myNext] >> theParams->fBShift) & 0xFF) +
+				((theSrc1[myCol] >> theParams->fBShift) & 0xFF) + ((theSrc1[myNext] >> theParams->fBShift) & 0xFF) + 2) >> 2;
+
+		theCb[myCol / 2] = (UInt8)(((theParams->fCbCoef[0] * myR) + (theParams->fCbCoef[1] * myG) + (theParams->fCbCoef[2] * myB) + kColorCOffset) >> kColorFixedShift);
+		theCr[myCol / 2] = (UInt8)(((theParams->fCrCoef[0] * myR) + (theParams->fCrCoef[1] * myG) + (theParams->fCrCoef[2] * myB) + kColorCOffset) >> kColorFixedShift);
+	}
+}
+
+
+//////////
+//
+// QTCmpr_To2vuyRow_C
+// Convert a row of 32-bit RGB pixels to 4:2:2 ('2vuy': Cb, Y'0, Cr, Y'1 for each pair of pixels).
+//
+//////////
+
+static void QTCmpr_To2vuyRow_C (UInt32 *theSrc, UInt8 *theDst, long theWidth, ColorParamsPtr theParams)
+{
+	long						myCol, myNext;
+	long						myR0, myG0, myB0;
+	long						myR1, myG1, myB1;
+	long						myR, myG, myB;
+
+	for (myCol = 0; myCol < theWidth; myCol += 2) {
+		myNext = (myCol + 1 < theWidth) ? myCol + 1 : myCol;
+
+		myR0 = (theSrc[myCol] >> theParams->fRShift) & 0xFF;
+		myG0 = (theSrc[myCol] >> theParams->fGShift) & 0xFF;
+		myB0 = (theSrc[myCol] >> theParams->fBShift) & 0xFF;
+		myR1 = (theSrc[myNext] >> theParams->fRShift) & 0xFF;
+		myG1 = (theSrc[myNext] >> theParams->fGShift) & 0xFF;
+		myB1 = (theSrc[myNext] >> theParams->fBShift) & 0xFF;
+
+		myR = (myR0 + myR1 + 1) >> 1;
+		myG = (myG0 + myG1 + 1) >> 1;
+		myB = (myB0 + myB1 + 1) >> 1;
+
+		theDst[0] = (UInt8)(((theParams->fCbCoef[0] * myR) + (theParams->fCbCoef[1] * myG) + (theParams->fCbCoef[2] * myB) + kColorCOffset) >> kColorFixedShift);
+		theDst[1] = (UInt8)(((theParams->fYCoef[0] * myR0) + (theParams->fYCoef[1] * myG0) + (theParams->fYCoef[2] * myB0) + kColorYOffset) >> kColorFixedShift);
+		theDst[2] = (UInt8)(((theParams->fCrCoef[0] * myR) + (theParams->fCrCoef[1] * myG) + (theParams->fCrCoef[2] * myB) + kColorCOffset) >> kColorFixedShift);
+		theDst[3] = (UInt8)(((theParams->fYCoef[0] * myR1) + (theParams->fYCoef[1] * myG1) + (theParams->fYCoef[2] * myB1) + kColorYOffset) >> kColorFixedShift);
+		theDst += 4;
+	}
+}
+
+
+//////////
+//
+// QTCmpr_FromYCbCrRow_C
+// Convert a row of video-range Y'CbCr pixels, with each chroma sample covering 2 pixels, to 32-bit RGB.
+//
+//////////
+
+static void QTCmpr_FromYCbCrRow_C (UInt8 *theY, UInt8 *theCb, UInt8 *theCr, UInt32 *theDst, long theWidth, ColorParamsPtr theParams)
+{
+	long						myCol;
+	long						myY, myCb, myCr;
+	long						myR, myG, myB;
+
+	for (myCol = 0; myCol < theWidth; myCol++) {
+		myY = (long)theY[myCol] - 16;
+		myCb = (long)theCb[myCol / 2] - 128;
+		myCr = (long)theCr[myCol / 2] - 128;
+
+		myR = ((theParams->fRCoef[0] * myY) + (theParams->fRCoef[1] * myCr) + kColorRound) >> kColorFixedShift;
+		myG = ((theParams->fGCoef[0] * myY) + (theParams->fGCoef[1] * myCb) + (theParams->fGCoef[2] * myCr) + kColorRound) >> kColorFixedShift;
+		myB = ((theParams->fBCoef[0] * myY) + (theParams->fBCoef[1] * myCb) + kColorRound) >> kColorFixedShift;
+
+		myR = (myR < 0) ? 0 : ((myR > 255) ? 255 : myR);
+		myG = (myG < 0) ? 0 : ((myG > 255) ? 255 : myG);
+		myB = (myB < 0) ? 0 : ((myB > 255) ? 255 : myB);
+
+		theDst[myCol] = (0xFFUL << theParams->fAShift) | ((UInt32)myR << theParams->fRShift) | ((UInt32)myG << theParams->fGShift) | ((UInt32)myB << theParams->fBShift);
+	}
+}
+
+
+#if USE_SSE2_KERNELS
+//////////
+//
+// QTCmpr_HasSSE2
+// Does the processor have the SSE2 instructions?
+//
+//////////
+
+Boolean QTCmpr_HasSSE2 (void)
+{
+#if defined(_M_X64)
+	return(true);
+#else
+	return(IsProcessorFeaturePresent(PF_XMMI64_INSTRUCTIONS_AVAILABLE) != 0);
+#endif
+}
+
+
+//////////
+//
+// QTCmpr_WeighRGB_SSE2
+// Return the weighted sums of 4 pixels' components, plus an offset, shifted down; theRG holds the red (low
+// half) and green (high half) components of each pixel, and theB the blue components.
+//
+//////////
+
+static __m128i QTCmpr_WeighRGB_SSE2 (__m128i theRG, __m128i theB, __m128i theRGCoef, __m128i theBCoef, __m128i theOffset)
+{
+	__m128i						mySum;
+
+	mySum = _mm_add_epi32(_mm_madd_epi16(theRG, theRGCoef), _mm_madd_epi16(theB, theBCoef));
+
+	return(_mm_srai_epi32(_mm_add_epi32(mySum, theOffset), kColorFixedShift));
+}
+
+
+//////////
+//
+// QTCmpr_GetComponent_SSE2
+// Return one component of 4 32-bit pixels, in the low byte of each 32-bit lane.
+//
+//////////
+
+static __m128i QTCmpr_GetComponent_SSE2 (__m128i thePixels, short theShift)
+{
+	return(_mm_and_si128(_mm_srl_epi32(thePixels, _mm_cvtsi32_si128(theShift)), _mm_set1_epi32(0xFF)));
+}
+
+
+//////////
+//
+// QTCmpr_SumPairs_SSE2
+// Return the sums of adjacent pairs of the 8 values in two vectors of 32-bit lanes.
+//
+//////////
+
+static __m128i QTCmpr_SumPairs_SSE2 (__m128i theFirst, __m128i theSecond)
+{
+	theFirst = _mm_add_epi32(theFirst, _mm_srli_epi64(theFirst, 32));
+	theSecond = _mm_add_epi32(theSecond, _mm_srli_epi64(theSecond, 32));
+
+	// the sums are in lanes 0 and 2 of each vector
+	theFirst = _mm_shuffle_epi32(theFirst, _MM_SHUFFLE(3, 1, 2, 0));
+	theSecond = _mm_shuffle_epi32(theSecond, _MM_SHUFFLE(3, 1, 2, 0));
+
+	return(_mm_unpacklo_epi64(theFirst, theSecond));
+}
+
+
+//////////
+//
+// QTCmpr_ToYRow_SSE2
+// Convert a row of 32-bit RGB pixels to Y', 8 pixels at a time.
+//
+//////////
+
+static void QTCmpr_ToYRow_SSE2 (UInt32 *theSrc, UInt8 *theY, long theWidth, ColorParamsPtr theParams)
+{
+	__m128i						myRGCoef = _mm_set1_epi32((UInt16)theParams->fYCoef[0] | ((UInt32)(UInt16)theParams->fYCoef[1] << 16));
+	__m128i						myBCoef = _mm_set1_epi32((UInt16)theParams->fYCoef[2]);
+	__m128i						myOffset = _mm_set1_epi32(kColorYOffset);
+	__m128i						myPixels, myY0, myY1;
+	long						myCol;
+
+	for (myCol = 0; myCol + 8 <= theWidth; myCol += 8) {
+		myPixels = _mm_loadu_si128((__m128i *)(theSrc + myCol));
+		myY0 = QTCmpr_WeighRGB_SSE2(_mm_or_si128(QTCmpr_GetComponent_SSE2(myPixels, theParams->fRShift), _mm_slli_epi32(QTCmpr_GetComponent_SSE2(myPixels, theParams->fGShift), 16)),
+									QTCmpr_GetComponent_SSE2(myPixels, theParams->fBShift), myRGCoef, myBCoef, myOffset);
+
+		myPixels = _mm_loadu_si128((__m128i *)(theSrc + myCol + 4));
+		myY1 = QTCmpr_WeighRGB_SSE2(_mm_or_si128(QTCmpr_GetComponent_SSE2(myPixels, theParams->fRShift), _mm_slli_epi32(QTCmpr_GetComponent_SSE2(myPixels, theParams->fGShift), 16)),
+									QTCmpr_GetComponent_SSE2(myPixels, theParams->fBShift), myRGCoef, myBCoef, myOffset);
+
+		myY0 = _mm_packs_epi32(myY0, myY1);
+		_mm_storel_epi64((__m128i *)(theY + myCol), _mm_packus_epi16(myY0, myY0));
+	}
+
+	QTCmpr_ToYRow_C(theSrc + myCol, theY + myCol, theWidth - myCol, theParams);
+}
+
+
+//////////
+//
+// QTCmpr_ToCbCrRow_SSE2
+// Convert two rows of 32-bit RGB pixels to a row of 4:2:0 Cb and Cr, 8 pixels (4 chroma samples) at a time.
+//
+//////////
+
+static void QTCmpr_ToCbCrRow_SSE2 (UInt32 *theSrc0, UInt32 *theSrc1, UInt8 *theCb, UInt8 *theCr, long theWidth, ColorParamsPtr theParams)
+{
+	__m128i						myCbRGCoef = _mm_set1_epi32((UInt16)theParams->fCbCoef[0] | ((UInt32)(UInt16)theParams->fCbCoef[1] << 16));
+	__m128i						myCbBCoef = _mm_set1_epi32((UInt16)theParams->fCbCoef[2]);
+	__m128i						myCrRGCoef = _mm_set1_epi32((UInt16)theParams->fCrCoef[0] | ((UInt32)(UInt16)theParams->fCrCoef[1] << 16));
+	__m128i						myCrBCoef = _mm_set1_epi32((UInt16)theParams->fCrCoef[2]);
+	__m128i						myOffset = _mm_set1_epi32(kColorCOffset);
+	__m128i						myTwo = _mm_set1_epi32(2);
+	__m128i						myA0, myA1, myB0, myB1;
+	__m128i						myR, myG, myB, myRG;
+	__m128i						myCb, myCr;
+	UInt32						myPacked[2];
+	long						myCol;
+
+	for (myCol = 0; myCol + 8 <= theWidth; myCol += 8) {
+		myA0 = _mm_loadu_si128((__m128i *)(theSrc0 + myCol));
+		myA1 = _mm_loadu_si128((__m128i *)(theSrc0 + myCol + 4));
+		myB0 = _mm_loadu_si128((__m128i *)(theSrc1 + myCol));
+		myB1 = _mm_loadu_si128((__m128i *)(theSrc1 + myCol + 4));
+
+		// add each column of the two rows, then each pair of columns, and round
+		myR = QTCmpr_SumPairs_SSE2(_mm_add_epi32(QTCmpr_GetComponent_SSE2(myA0, theParams->fRShift), QTCmpr_GetComponent_SSE2(myB0, theParams->fRShift)),
+									_mm_add_epi32(QTCmpr_GetComponent_SSE2(myA1, theParams->fRShift), QTCmpr_GetComponent_SSE2(myB1, theParams->fRShift)));
+		myG = QTCmpr_SumPairs_SSE2(_mm_add_epi32(QTCmpr_GetComponent_SSE2(myA0, theParams->fGShift), QTCmpr_GetComponent_SSE2(myB0, theParams->fGShift)),
+									_mm_add_epi32(QTCmpr_GetComponent_SSE2(myA1, theParams->fGShift), QTCmpr_GetComponent_SSE2(myB1, theParams->fGShift)));
+		myB = QTCmpr_SumPairs_SSE2(_mm_add_epi32(QTCmpr_GetComponent_SSE2(myA0, theParams->fBShift), QTCmpr_GetComponent_SSE2(myB0, theParams->fBShift)),
+									_mm_add_epi32(QTCmpr_GetComponent_SSE2(myA1, theParams->fBShift), QTCmpr_GetComponent_SSE2(myB1, theParams->fBShift)));
+
+		myR = _mm_srli_epi32(_mm_add_epi32(myR, myTwo), 2);
+		myG = _mm_srli_epi32(_mm_add_epi32(myG, myTwo), 2);
+		myB = _mm_srli_epi32(_mm_add_epi32(myB, myTwo), 2);
+		myRG = _mm_or_si128(myR, _mm_slli_epi32(myG, 16));
+
+		myCb = QTCmpr_WeighRGB_SSE2(myRG, myB, myCbRGCoef, myCbBCoef, myOffset);
+		myCr = QTCmpr_WeighRGB_SSE2(myRG, myB, myCrRGCoef, myCrBCoef, myOffset);
+
+		// the low 4 bytes are Cb, the next 4 Cr
+		myCb = _mm_packs_epi32(myCb, myCr);
+		_mm_storel_epi64((__m128i *)myPacked, _mm_packus_epi16(myCb, myCb));
+		BlockMoveData((Ptr)&myPacked[0], (Ptr)(theCb + (myCol / 2)), 4);
+		BlockMoveData((Ptr)&myPacked[1], (Ptr)(theCr + (myCol / 2)), 4);
+	}
+
+	QTCmpr_ToCbCrRow_C(theSrc0 + myCol, theSrc1 + myCol, theCb + (myCol / 2), theCr + (myCol / 2), theWidth - myCol, theParams);
+}
+
+
+//////////
+//
+// QTCmpr_To2vuyRow_SSE2
+// Convert a row of 32-bit RGB pixels to 4:2:2 ('2vuy'), 8 pixels at a time.
+//
+//////////
+
+static void QTCmpr_To2vuyRow_SSE2 (UInt32 *theSrc, UInt8 *theDst, long theWidth, ColorParamsPtr theParams)
+{
+	__m128i						myYRGCoef = _mm_set1_epi32((UInt16)theParams->fYCoef[0] | ((UInt32)(UInt16)theParams->fYCoef[1] << 16));
+	__m128i						myYBCoef = _mm_set1_epi32((UInt16)theParams->fYCoef[2]);
+	__m128i						myCbRGCoef = _mm_set1_epi32((UInt16)theParams->fCbCoef[0] | ((UInt32)(UInt16)theParams->fCbCoef[1] << 16));
+	__m128i						myCbBCoef = _mm_set1_epi32((UInt16)theParams->fCbCoef[2]);
+	__m128i						myCrRGCoef = _mm_set1_epi32((UInt16)theParams->fCrCoef[0] | ((UInt32)(UInt16)theParams->fCrCoef[1] << 16));
+	__m128i						myCrBCoef = _mm_set1_epi32((UInt16)theParams->fCrCoef[2]);
+	__m128i						myYOffset = _mm_set1_epi32(kColorYOffset);
+	__m128i						myCOffset = _mm_set1_epi32(kColorCOffset);
+	__m128i						myOne = _mm_set1_epi32(1);
+	__m128i						myPixels0, myPixels1;
+	__m128i						myR0, myG0, myB0, myR1, myG1, myB1;
+	__m128i						myR, myG, myB, myRG;
+	__m128i						myY, myY1, myCb, myCr, myCbCr;
+	long						myCol;
+
+	for (myCol = 0; myCol + 8 <= theWidth; myCol += 8) {
+		myPixels0 = _mm_loadu_si128((__m128i *)(theSrc + myCol));
+		myPixels1 = _mm_loadu_si128((__m128i *)(theSrc + myCol + 4));
+
+		myR0 = QTCmpr_GetComponent_SSE2(myPixels0, theParams->fRShift);
+		myG0 = QTCmpr_GetComponent_SSE2(myPixels0, theParams->fGShift);
+		myB0 = QTCmpr_GetComponent_SSE2(myPixels0, theParams->fBShift);
+		myR1 = QTCmpr_GetComponent_SSE2(myPixels1, theParams->fRShift);
+		myG1 = QTCmpr_GetComponent_SSE2(myPixels1, theParams->fGShift);
+		myB1 = QTCmpr_GetComponent_SSE2(myPixels1, theParams->fBShift);
+
+		myY = QTCmpr_WeighRGB_SSE2(_mm_or_si128(myR0, _mm_slli_epi32(myG0, 16)), myB0, myYRGCoef, myYBCoef, myYOffset);
+		myY1 = QTCmpr_WeighRGB_SSE2(_mm_or_si128(myR1, _mm_slli_epi32(myG1, 16)), myB1, myYRGCoef, myYBCoef, myYOffset);
+		myY = _mm_packs_epi32(myY, myY1);
+
+		// each chroma sample is the rounded average of a pair of pixels
+		myR = _mm_srli_epi32(_mm_add_epi32(QTCmpr_SumPairs_SSE2(myR0, myR1), myOne), 1);
+		myG = _mm_srli_epi32(_mm_add_epi32(QTCmpr_SumPairs_SSE2(myG0, myG1), myOne), 1);
+		myB = _mm_srli_epi32(_mm_add_epi32(QTCmpr_SumPairs_SSE2(myB0, myB1), myOne), 1);
+		myRG = _mm_or_si128(myR, _mm_slli_epi32(myG, 16));
+
+		myCb = QTCmpr_WeighRGB_SSE2(myRG, myB, myCbRGCoef, myCbBCoef, myCOffset);
+		myCr = QTCmpr_WeighRGB_SSE2(myRG, myB, myCrRGCoef, myCrBCoef, myCOffset);
+
+		// interleave Cb, Y'0, Cr, Y'1
+		myCbCr = _mm_unpacklo_epi16(_mm_packs_epi32(myCb, myCb), _mm_packs_epi32(myCr, myCr));
+		_mm_storeu_si128((__m128i *)(theDst + (myCol * 2)), _mm_packus_epi16(_mm_unpacklo_epi16(myCbCr, myY), _mm_unpackhi_epi16(myCbCr, myY)));
+	}
+
+	QTCmpr_To2vuyRow_C(theSrc + myCol, theDst + (myCol * 2), theWidth - myCol, theParams);
+}
+
+
+//////////
+//
+// QTCmpr_FromYCbCrRow_SSE2
+// Convert a row of video-range Y'CbCr pixels, with each chroma sample covering 2 pixels, to 32-bit RGB,
+// 8 pixels at a time.
+//
+//////////
+
+static void QTCmpr_FromYCbCrRow_SSE2 (UInt8 *theY, UInt8 *theCb, UInt8 *theCr, UInt32 *theDst, long theWidth, ColorParamsPtr theParams)
+{
+	__m128i						myZero = _mm_setzero_si128();
+	__m128i						myRCoef = _mm_set1_epi32((UInt16)theParams->fRCoef[0] | ((UInt32)(UInt16)theParams->fRCoef[1] << 16));
+	__m128i						myGYCbCoef = _mm_set1_epi32((UInt16)theParams->fGCoef[0] | ((UInt32)(UInt16)theParams->fGCoef[1] << 16));
+	__m128i						myGCrCoef = _mm_set1_epi32((UInt16)theParams->fGCoef[2]);
+	__m128i						myBCoef = _mm_set1_epi32((UInt16)theParams->fBCoef[0] | ((UInt32)(UInt16)theParams->fBCoef[1] << 16));
+	__m128i						myRound = _mm_set1_epi32(kColorRound);
+	__m128i						myComponents[4];
+	__m128i						myY, myCb, myCr;
+	__m128i						myYCb, myYCr, myCr0;
+	__m128i						myLo, myHi;
+	__m128i						myR, myG, myB;
+	UInt32						myChroma;
+	long						myCol;
+
+	for (myCol = 0; myCol + 8 <= theWidth; myCol += 8) {
+		myY = _mm_sub_epi16(_mm_unpacklo_epi8(_mm_loadl_epi64((__m128i *)(theY + myCol)), myZero), _mm_set1_epi16(16));
+
+		BlockMoveData((Ptr)(theCb + (myCol / 2)), (Ptr)&myChroma, 4);
+		myCb = _mm_sub_epi16(_mm_unpacklo_epi8(_mm_cvtsi32_si128(myChroma), myZero), _mm_set1_epi16(128));
+		BlockMoveData((Ptr)(theCr + (myCol / 2)), (Ptr)&myChroma, 4);
+		myCr = _mm_sub_epi16(_mm_unpacklo_epi8(_mm_cvtsi32_si128(myChroma), myZero), _mm_set1_epi16(128));
+
+		// each chroma sample covers two pixels
+		myCb = _mm_unpacklo_epi16(myCb, myCb);
+		myCr = _mm_unpacklo_epi16(myCr, myCr);
+
+		// R = Y' and Cr
+		myYCr = _mm_unpacklo_epi16(myY, myCr);
+		myLo = _mm_srai_epi32(_mm_add_epi32(_mm_madd_epi16(myYCr, myRCoef), myRound), kColorFixedShift);
+		myYCr = _mm_unpackhi_epi16(myY, myCr);
+		myHi = _mm_srai_epi32(_mm_add_epi32(_mm_madd_epi16(myYCr, myRCoef), myRound), kColorFixedShift);
+		myR = _mm_packs_epi32(myLo, myHi);
+
+		// G = Y', Cb, and Cr
+		myYCb = _mm_unpacklo_epi16(myY, myCb);
+		myCr0 = _mm_unpacklo_epi16(myCr, myZero);
+		myLo = _mm_add_epi32(_mm_madd_epi16(myYCb, myGYCbCoef), _mm_madd_epi16(myCr0, myGCrCoef));
+		myLo = _mm_srai_epi32(_mm_add_epi32(myLo, myRound), kColorFixedShift);
+		myYCb = _mm_unpackhi_epi16(myY, myCb);
+		myCr0 = _mm_unpackhi_epi16(myCr, myZero);
+		myHi = _mm_add_epi32(_mm_madd_epi16(myYCb, myGYCbCoef), _mm_madd_epi16(myCr0, myGCrCoef));
+		myHi = _mm_srai_epi32(_mm_add_epi32(myHi, myRound), kColorFixedShift);
+		myG = _mm_packs_epi32(myLo, myHi);
+
+		// B = Y' and Cb
+		myYCb = _mm_unpacklo_epi16(myY, myCb);
+		myLo = _mm_srai_epi32(_mm_add_epi32(_mm_madd_epi16(myYCb, myBCoef), myRound), kColorFixedShift);
+		myYCb = _mm_unpackhi_epi16(myY, myCb);
+		myHi = _mm_srai_epi32(_mm_add_epi32(_mm_madd_epi16(myYCb, myBCoef), myRound), kColorFixedShift);
+		myB = _mm_packs_epi32(myLo, myHi);
+
+		// clamp each component to a byte, and put it at its place in the pixel
+		myComponents[theParams->fAShift / 8] = _mm_set1_epi8((char)0xFF);
+		myComponents[theParams->fRShift / 8] = _mm_packus_epi16(myR, myR);
+		myComponents[theParams->fGShift / 8] = _mm_packus_epi16(myG, myG);
+		myComponents[theParams->fBShift / 8] = _mm_packus_epi16(myB, myB);
+
+		myLo = _mm_unpacklo_epi8(myComponents[0], myComponents[1]);
+		myHi = _mm_unpacklo_epi8(myComponents[2], myComponents[3]);
+		_mm_storeu_si128((__m128i *)(theDst + myCol), _mm_unpacklo_epi16(myLo, myHi));
+		_mm_storeu_si128((__m128i *)(theDst + myCol + 4), _mm_unpackhi_epi16(myLo, myHi));
+	}
+
+	QTCmpr_FromYCbCrRow_C(theY + myCol, theCb + (myCol / 2), theCr + (myCol / 2), theDst + myCol, theWidth - myCol, theParams);
+}
+#endif	// USE_SSE2_KERNELS
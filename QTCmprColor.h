@@ -0,0 +1,180 @@
+//////////
+//
+//	File:		QTCmprColor.h
+//
+//	Contains:	Conversions between 32-bit RGB frames and Y'CbCr 4:2:0 and 4:2:2 frames, for use by QTCompress.
+//
+//	Written by:	Tim Monroe
+//
+//	Copyright:	 2000 by Apple Computer, Inc., all rights reserved.
+//
+//	Change History (most recent first):
+//
+//	   <5>	 	11/13/26	rtm		added QTCmpr_AddColorExtension
+//	   <4>	 	11/07/26	rtm		added QTCmpr_ConvertSlice
+//	   <3>	 	11/04/26	rtm		added QTCmpr_ConvertRowsToYUV
+//	   <2>	 	11/02/26	rtm		made QTCmpr_HasSSE2 public, for QTCmprResize.c
+//	   <1>	 	11/01/26	rtm		first file
+//
+//////////
+
+#pragma once
+
+
+//////////
+//
+// header files
+//
+//////////
+
+#ifndef __QTCmprColor__
+#define __QTCmprColor__
+
+#ifndef __MOVIES__
+#include <Movies.h>
+#endif
+
+#ifndef __QUICKTIMECOMPONENTS__
+#include <QuickTimeComponents.h>
+#endif
+
+#if TARGET_OS_WIN32
+#include <windows.h>
+#endif
+
+#include "QTCmprBudget.h"
+
+
+//////////
+//
+// compiler flags
+//
+//////////
+
+// do we have SSE2 versions of the conversion routines? we need an x86 compiler that knows the SSE2 intrinsics
+#if TARGET_OS_WIN32 && (defined(_M_IX86) || defined(_M_X64))
+#define USE_SSE2_KERNELS				1
+#else
+#define USE_SSE2_KERNELS				0
+#endif
+
+#if USE_SSE2_KERNELS
+#include <emmintrin.h>
+#endif
+
+
+//////////
+//
+// constants
+//
+//////////
+
+#define kColorFixedShift				8						// fraction bits in the conversion coefficients
+#define kColorHDHeight					576						// frames taller than this use the BT.709 coefficients
+#define kColorCheckWidth				37						// size of the test frame we compare the SSE2 and C routines on
+#define kColorCheckHeight				3
+
+// the coefficient sets
+enum {
+	kColorMatrix601						= 1,					// ITU-R BT.601 (standard definition)
+	kColorMatrix709						= 2						// ITU-R BT.709 (high definition)
+};
+
+// the color parameters image description extension ('colr'), which tells a decompressor how to turn Y'CbCr back
+// into RGB; an 'nclc' extension holds three codes, for the primaries, the transfer function, and the matrix
+#define kColorInfoExtensionType			FOUR_CHAR_CODE('colr')
+#define kColorInfoNCLCType				FOUR_CHAR_CODE('nclc')
+#define kColorInfoNCLCSize				10						// the type and three 16-bit codes, big-endian
+#define kColorInfoCode709				1						// the code for BT.709 primaries, transfer function, and matrix
+
+
+//////////
+//
+// data types
+//
+//////////
+
+// the parameters of a row conversion: the coefficients, in fixed point with kColorFixedShift fraction bits, and
+// the shift that extracts each component from a 32-bit pixel (as loaded from memory on a little-endian processor)
+typedef struct ColorParams {
+	long						fYCoef[3];							// R, G, and B coefficients of Y'
+	long						fCbCoef[3];
+	long						fCrCoef[3];
+	long						fRCoef[2];							// Y' and Cr coefficients of R
+	long						fGCoef[3];							// Y', Cb, and Cr coefficients of G
+	long						fBCoef[2];							// Y' and Cb coefficients of B
+	short						fAShift;
+	short						fRShift;
+	short						fGShift;
+	short						fBShift;
+} ColorParams, *ColorParamsPtr;
+
+// the row conversion routines; RGB pixels are 32 bits, Y'CbCr rows are video range, and chroma is subsampled 2:1
+// horizontally (for 4:2:0, the caller averages two rows)
+typedef void (*ColorToYRowProcPtr) (UInt32 *theSrc, UInt8 *theY, long theWidth, ColorParamsPtr theParams);
+typedef void (*ColorToCbCrRowProcPtr) (UInt32 *theSrc0, UInt32 *theSrc1, UInt8 *theCb, UInt8 *theCr, long theWidth, ColorParamsPtr theParams);
+typedef void (*ColorTo2vuyRowProcPtr) (UInt32 *theSrc, UInt8 *theDst, long theWidth, ColorParamsPtr theParams);
+typedef void (*ColorFromYCbCrRowProcPtr) (UInt8 *theY, UInt8 *theCb, UInt8 *theCr, UInt32 *theDst, long theWidth, ColorParamsPtr theParams);
+
+typedef struct ColorKernels {
+	ColorToYRowProcPtr			fToY;
+	ColorToCbCrRowProcPtr		fToCbCr;
+	ColorTo2vuyRowProcPtr		fTo2vuy;
+	ColorFromYCbCrRowProcPtr	fFromYCbCr;
+	char						*fName;
+} ColorKernels, *ColorKernelsPtr;
+
+// a converter from the RGB graphics world that frames are rendered in to a Y'CbCr graphics world
+typedef struct ColorConverter {
+	PixMapHandle				fSrcPixMap;							// the RGB frames (32-bit or 24-bit)
+	OSType						fFormat;							// k2vuyPixelFormat or kYUV420PixelFormat
+	GWorldPtr					fGWorld;							// the Y'CbCr frames
+	PixMapHandle				fPixMap;
+	long						fWidth;
+	long						fHeight;
+	UInt32						*fRows;								// two rows of 32-bit pixels for each slice, if the source is 24-bit
+	ColorParams					fParams;
+	long						fMatrix;							// kColorMatrix601 or kColorMatrix709
+	long						fNumFrames;
+	double						fConvertTime;						// microseconds spent converting frames
+	long						fSize;								// the number of bytes reserved
+	MemoryJobPtr				fJob;
+} ColorConverter, *ColorConverterPtr;
+
+
+//////////
+//
+// function prototypes
+//
+//////////
+
+OSType							QTCmpr_GetCompressorYUVFormat (CodecType theCodecType);
+OSErr							QTCmpr_NewColorConverter (ColorConverterPtr theConverter, PixMapHandle theSrcPixMap, OSType theFormat, MemoryJobPtr theJob);
+OSErr							QTCmpr_AddColorExtension (ColorConverterPtr theConverter, ImageDescriptionHandle theDesc);
+void							QTCmpr_ConvertFrameToYUV (ColorConverterPtr theConverter);
+void							QTCmpr_ConvertRowsToYUV (ColorConverterPtr theConverter, long theTop, long theBottom);
+void							QTCmpr_DisposeColorConverter (ColorConverterPtr theConverter);
+void							QTCmpr_SetColorParams (ColorParamsPtr theParams, long theMatrix, PixMapHandle thePixMap);
+void							QTCmpr_ConvertYCbCrRow (UInt8 *theY, UInt8 *theCb, UInt8 *theCr, UInt8 *theDst, long theWidth, ColorParamsPtr theParams);
+#if USE_SSE2_KERNELS
+Boolean							QTCmpr_HasSSE2 (void);
+#endif
+static ColorKernelsPtr			QTCmpr_GetColorKernels (void);
+static Boolean					QTCmpr_CheckColorKernels (ColorKernelsPtr theKernels, ColorKernelsPtr theReference);
+static void						QTCmpr_ConvertSlice (void *theRefCon, long theSlice, long theTop, long theBottom);
+static UInt32					*QTCmpr_GetConverterRow (ColorConverterPtr theConverter, long theRow, long theSlot);
+static void						QTCmpr_ToYRow_C (UInt32 *theSrc, UInt8 *theY, long theWidth, ColorParamsPtr theParams);
+static void						QTCmpr_ToCbCrRow_C (UInt32 *theSrc0, UInt32 *theSrc1, UInt8 *theCb, UInt8 *theCr, long theWidth, ColorParamsPtr theParams);
+static void						QTCmpr_To2vuyRow_C (UInt32 *theSrc, UInt8 *theDst, long theWidth, ColorParamsPtr theParams);
+static void						QTCmpr_FromYCbCrRow_C (UInt8 *theY, UInt8 *theCb, UInt8 *theCr, UInt32 *theDst, long theWidth, ColorParamsPtr theParams);
+#if USE_SSE2_KERNELS
+static __m128i					QTCmpr_WeighRGB_SSE2 (__m128i theRG, __m128i theB, __m128i theRGCoef, __m128i theBCoef, __m128i theOffset);
+static __m128i					QTCmpr_GetComponent_SSE2 (__m128i thePixels, short theShift);
+static __m128i					QTCmpr_SumPairs_SSE2 (__m128i theFirst, __m128i theSecond);
+static void						QTCmpr_ToYRow_SSE2 (UInt32 *theSrc, UInt8 *theY, long theWidth, ColorParamsPtr theParams);
+static void						QTCmpr_ToCbCrRow_SSE2 (UInt32 *theSrc0, UInt32 *theSrc1, UInt8 *theCb, UInt8 *theCr, long theWidth, ColorParamsPtr theParams);
+static void						QTCmpr_To2vuyRow_SSE2 (UInt32 *theSrc, UInt8 *theDst, long theWidth, ColorParamsPtr theParams);
+static void						QTCmpr_FromYCbCrRow_SSE2 (UInt8 *theY, UInt8 *theCb, UInt8 *theCr, UInt32 *theDst, long theWidth, ColorParamsPtr theParams);
+#endif
+
+#endif	// __QTCmprColor__
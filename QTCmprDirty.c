@@ -0,0 +1,408 @@
+//////////
+//
+//	File:		QTCmprDirty.c
+//
+//	Contains:	Detection of the part of each frame that changed since the last one, for use by QTCompress.
+//
+//	Written by:	Tim Monroe
+//
+//	Copyright:	 2000 by Apple Computer, Inc., all rights reserved.
+//
+//	Change History (most recent first):
+//
+//	   <1>	 	11/04/26	rtm		first file
+//
+//	Screen recordings and slide shows often hold the same picture for many frames, or change only a small part
+//	of it. Compressing such a frame costs as much as compressing any other, even though the result is a
+//	difference frame that says "nothing changed". So QTCmpr_CompressSequence compares each frame with the last
+//	one before compressing it; if nothing changed, it doesn't compress the frame at all, but makes the previous
+//	sample last longer instead (see QTCmpr_ExtendHeldSample). If only some rows changed, only those rows are
+//	converted to Y'CbCr.
+//
+//	We'd like to go further and hand the compressor only the part that changed, but the frames of a compression
+//	sequence must all be the same size, so the compressor always sees the whole frame; temporal compressors
+//	already spend little on the unchanged parts.
+//
+//	Rows are compared in blocks of kDirtyBlockBytes bytes, from each end toward the middle, so that the
+//	comparison stops early in rows that changed and runs at memory speed in rows that didn't; the changed part
+//	of each frame is then copied over the saved frame. On x86 processors with SSE2 we compare 64 bytes at a
+//	time; as with the other SSE2 routines, we check first that the SSE2 version agrees with the C version.
+//
+//	A movie whose frames all change (most camera footage) gains nothing from this, so if none of the first
+//	kDirtyTrialFrames frames is unchanged and most of each frame changes, the detector stops looking and gives
+//	back its copy of the frame.
+//
+//////////
+
+//////////
+//
+// header files
+//
+//////////
+
+#include "QTCompress.h"
+
+
+//////////
+//
+// global variables
+//
+//////////
+
+static DirtyKernels					gDirtyKernels;						// the comparison routine we use
+static Boolean						gDirtyKernelsReady = false;
+
+// the C comparison routine, which is also the reference for the SSE2 one
+static DirtyKernels					gDirtyKernels_C = {QTCmpr_CompareRow_C, "C"};
+
+#if USE_SSE2_KERNELS
+static DirtyKernels					gDirtyKernels_SSE2 = {QTCmpr_CompareRow_SSE2, "SSE2"};
+#endif
+
+
+//////////
+//
+// QTCmpr_NewDirtyDetector
+// Prepare to find the changes between successive frames in the specified pixel map.
+//
+// Call QTCmpr_DisposeDirtyDetector even if this function fails.
+//
+//////////
+
+OSErr QTCmpr_NewDirtyDetector (DirtyDetectorPtr theDetector, PixMapHandle thePixMap, MemoryJobPtr theJob)
+{
+	Rect						myRect;
+
+	if (theDetector == NULL)
+		return(paramErr);
+
+	theDetector->fPixMap = thePixMap;
+	theDetector->fPrevious = NULL;
+	theDetector->fHasPrevious = false;
+	theDetector->fIsActive = false;
+	theDetector->fNumFrames = 0L;
+	theDetector->fNumUnchanged = 0L;
+	theDetector->fDirtyPercent = 0.0;
+	theDetector->fCompareTime = 0.0;
+	theDetector->fSize = 0L;
+	theDetector->fJob = theJob;
+
+	if (thePixMap == NULL)
+		return(paramErr);
+
+	GetPixBounds(thePixMap, &myRect);
+	theDetector->fDepth = GetPixDepth(thePixMap);
+	theDetector->fWidth = myRect.right - myRect.left;
+	theDetector->fHeight = myRect.bottom - myRect.top;
+	theDetector->fRowBytes = ((theDetector->fWidth * theDetector->fDepth) + 7) / 8;
+
+	// we can't tell where the pixels of a planar pixel map are
+	if ((theDetector->fDepth < 8) || ((**thePixMap).pixelFormat == kYUV420PixelFormat))
+		return(paramErr);
+
+	theDetector->fSize = theDetector->fRowBytes * theDetector->fHeight;
+	QTCmpr_ReserveMemory(theJob, theDetector->fSize);
+
+	theDetector->fPrevious = (UInt8 *)NewPtr(theDetector->fSize);
+	if (theDetector->fPrevious == NULL)
+		return(memFullErr);
+
+	theDetector->fIsActive = true;
+
+	return(noErr);
+}
+
+
+//////////
+//
+// QTCmpr_FindDirtyRect
+// Compare the frame now in the detector's pixel map with the last one, and return the smallest rectangle that
+// holds all the changes in theDirtyRect; return false if nothing changed.
+//
+// The first frame, and every frame once the detector has stopped looking, is all changed.
+//
+//////////
+
+Boolean QTCmpr_FindDirtyRect (DirtyDetectorPtr theDetector, Rect *theDirtyRect)
+{
+	DirtyKernelsPtr				myKernels = QTCmpr_GetDirtyKernels();
+	UInt8						*myBaseAddr;
+	long						myRowBytes;
+	long						myTop = -1L;
+	long						myBottom = 0L;
+	long						myLeft = theDetector->fRowBytes;
+	long						myRight = 0L;
+	long						myFirst, myEnd;
+	long						myRow;
+	UnsignedWide				myStart, myFinish;
+
+	MacSetRect(theDirtyRect, 0, 0, (short)theDetector->fWidth, (short)theDetector->fHeight);
+
+	if (!theDetector->fIsActive)
+		return(true);
+
+	Microseconds(&myStart);
+
+	myBaseAddr = (UInt8 *)GetPixBaseAddr(theDetector->fPixMap);
+	myRowBytes = QTGetPixMapHandleRowBytes(theDetector->fPixMap);
+
+	if (!theDetector->fHasPrevious) {
+		myTop = 0L;
+		myBottom = theDetector->fHeight;
+		myLeft = 0L;
+		myRight = theDetector->fRowBytes;
+		theDetector->fHasPrevious = true;
+	} else {
+		for (myRow = 0; myRow < theDetector->fHeight; myRow++) {
+			if (myKernels->fCompareRow(myBaseAddr + (myRow * myRowBytes), theDetector->fPrevious + (myRow * theDetector->fRowBytes), theDetector->fRowBytes, &myFirst, &myEnd)) {
+				if (myTop < 0L)
+					myTop = myRow;
+				myBottom = myRow + 1;
+				if (myFirst < myLeft)
+					myLeft = myFirst;
+				if (myEnd > myRight)
+					myRight = myEnd;
+			}
+		}
+	}
+
+	// save the part that changed, for comparison with the next frame
+	for (myRow = myTop; (myTop >= 0L) && (myRow < myBottom); myRow++)
+		BlockMoveData(myBaseAddr + (myRow * myRowBytes) + myLeft, theDetector->fPrevious + (myRow * theDetector->fRowBytes) + myLeft, myRight - myLeft);
+
+	Microseconds(&myFinish);
+
+	theDetector->fCompareTime += ((double)myFinish.hi - (double)myStart.hi) * 4294967296.0 + ((double)myFinish.lo - (double)myStart.lo);
+	theDetector->fNumFrames++;
+
+	if (myTop < 0L) {
+		MacSetRect(theDirtyRect, 0, 0, 0, 0);
+		theDetector->fNumUnchanged++;
+		return(false);
+	}
+
+	// convert the byte offsets to pixels
+	MacSetRect(theDirtyRect, (short)((myLeft * 8) / theDetector->fDepth), (short)myTop,
+				(short)(((myRight * 8) + theDetector->fDepth - 1) / theDetector->fDepth), (short)myBottom);
+
+	theDetector->fDirtyPercent += (100.0 * (theDirtyRect->right - theDirtyRect->left) * (theDirtyRect->bottom - theDirtyRect->top)) /
+									((double)theDetector->fWidth * theDetector->fHeight);
+
+	// if we're not finding any unchanged frames, stop looking
+	if ((theDetector->fNumFrames == kDirtyTrialFrames) && (theDetector->fNumUnchanged == 0L) &&
+		(theDetector->fDirtyPercent / theDetector->fNumFrames > kDirtyGiveUpPercent))
+		QTCmpr_StopDirtyDetector(theDetector);
+
+	return(true);
+}
+
+
+//////////
+//
+// QTCmpr_DisposeDirtyDetector
+// Dispose of the detector's copy of the last frame, and report what it found.
+//
+//////////
+
+void QTCmpr_DisposeDirtyDetector (DirtyDetectorPtr theDetector)
+{
+	if (theDetector == NULL)
+		return;
+
+	if (theDetector->fNumFrames > theDetector->fNumUnchanged)
+		QTCmpr_LogMessage("QTCmpr_DisposeDirtyDetector: %ld of %ld frames unchanged; %.0f%% of each changed frame was dirty, on average; %s routines, %.0f us per frame",
+							theDetector->fNumUnchanged, theDetector->fNumFrames,
+							theDetector->fDirtyPercent / (theDetector->fNumFrames - theDetector->fNumUnchanged),
+							QTCmpr_GetDirtyKernels()->fName, theDetector->fCompareTime / theDetector->fNumFrames);
+
+	QTCmpr_StopDirtyDetector(theDetector);
+}
+
+
+//////////
+//
+// QTCmpr_StopDirtyDetector
+// Stop looking for changes, and give back the copy of the last frame.
+//
+//////////
+
+static void QTCmpr_StopDirtyDetector (DirtyDetectorPtr theDetector)
+{
+	if (theDetector->fIsActive && (theDetector->fNumFrames == kDirtyTrialFrames))
+		QTCmpr_LogMessage("QTCmpr_StopDirtyDetector: every frame changes; no longer comparing frames");
+
+	if (theDetector->fPrevious != NULL)
+		DisposePtr((Ptr)theDetector->fPrevious);
+	theDetector->fPrevious = NULL;
+	theDetector->fHasPrevious = false;
+	theDetector->fIsActive = false;
+
+	QTCmpr_ReleaseMemory(theDetector->fJob, theDetector->fSize);
+	theDetector->fSize = 0L;
+}
+
+
+//////////
+//
+// QTCmpr_GetDirtyKernels
+// Return the comparison routine to use: the SSE2 one, if the processor has SSE2 and it gives the same results as
+// the C one, or else the C one.
+//
+//////////
+
+static DirtyKernelsPtr QTCmpr_GetDirtyKernels (void)
+{
+	if (!gDirtyKernelsReady) {
+		gDirtyKernels = gDirtyKernels_C;
+
+#if USE_SSE2_KERNELS
+		if (QTCmpr_HasSSE2()) {
+			if (QTCmpr_CheckDirtyKernels(&gDirtyKernels_SSE2, &gDirtyKernels_C))
+				gDirtyKernels = gDirtyKernels_SSE2;
+			else
+				QTCmpr_LogMessage("QTCmpr_GetDirtyKernels: the SSE2 routine doesn't match the C routine; using the C routine");
+		}
+#endif
+
+		gDirtyKernelsReady = true;
+	}
+
+	return(&gDirtyKernels);
+}
+
+
+//////////
+//
+// QTCmpr_CheckDirtyKernels
+// Does the specified comparison routine produce exactly the same results as the reference routine?
+//
+// We compare a test row with copies that differ in a single byte, at every position, and with an identical copy.
+//
+//////////
+
+static Boolean QTCmpr_CheckDirtyKernels (DirtyKernelsPtr theKernels, DirtyKernelsPtr theReference)
+{
+	UInt8						myRow[kDirtyCheckBytes];
+	UInt8						myCopy[kDirtyCheckBytes];
+	long						myFirst[2], myEnd[2];
+	Boolean						isDirty[2];
+	long						myIndex;
+
+	for (myIndex = 0; myIndex < kDirtyCheckBytes; myIndex++)
+		myRow[myIndex] = myCopy[myIndex] = (UInt8)(myIndex * 37);
+
+	for (myIndex = -1; myIndex < kDirtyCheckBytes; myIndex++) {
+		if (myIndex >= 0)
+			myCopy[myIndex] ^= 0x01;
+
+		myFirst[0] = myFirst[1] = myEnd[0] = myEnd[1] = 0L;
+		isDirty[0] = theKernels->fCompareRow(myRow, myCopy, kDirtyCheckBytes, &myFirst[0], &myEnd[0]);
+		isDirty[1] = theReference->fCompareRow(myRow, myCopy, kDirtyCheckBytes, &myFirst[1], &myEnd[1]);
+
+		if ((isDirty[0] != isDirty[1]) || (isDirty[0] && ((myFirst[0] != myFirst[1]) || (myEnd[0] != myEnd[1]))))
+			return(false);
+
+		if (myIndex >= 0)
+			myCopy[myIndex] ^= 0x01;
+	}
+
+	return(true);
+}
+
+
+//////////
+//
+// QTCmpr_CompareRow_C
+// Compare a row with the same row of the previous frame, a block at a time.
+//
+//////////
+
+static Boolean QTCmpr_CompareRow_C (UInt8 *theRow, UInt8 *thePrevious, long theNumBytes, long *theFirst, long *theEnd)
+{
+	long						myFirst, myLast, mySize;
+
+	for (myFirst = 0; myFirst < theNumBytes; myFirst += kDirtyBlockBytes) {
+		mySize = (theNumBytes - myFirst < kDirtyBlockBytes) ? (theNumBytes - myFirst) : kDirtyBlockBytes;
+		if (memcmp(theRow + myFirst, thePrevious + myFirst, mySize) != 0)
+			break;
+	}
+
+	if (myFirst >= theNumBytes)
+		return(false);
+
+	for (myLast = ((theNumBytes - 1) / kDirtyBlockBytes) * kDirtyBlockBytes; myLast > myFirst; myLast -= kDirtyBlockBytes) {
+		mySize = (theNumBytes - myLast < kDirtyBlockBytes) ? (theNumBytes - myLast) : kDirtyBlockBytes;
+		if (memcmp(theRow + myLast, thePrevious + myLast, mySize) != 0)
+			break;
+	}
+
+	*theFirst = myFirst;
+	*theEnd = (myLast + kDirtyBlockBytes < theNumBytes) ? (myLast + kDirtyBlockBytes) : theNumBytes;
+
+	return(true);
+}
+
+
+#if USE_SSE2_KERNELS
+//////////
+//
+// QTCmpr_CompareRow_SSE2
+// Compare a row with the same row of the previous frame, 4 blocks at a time while the blocks are all the same.
+//
+//////////
+
+static Boolean QTCmpr_CompareRow_SSE2 (UInt8 *theRow, UInt8 *thePrevious, long theNumBytes, long *theFirst, long *theEnd)
+{
+	long						myNumBlocks = theNumBytes / kDirtyBlockBytes;		// the whole blocks
+	long						myFirst, myLast;
+	__m128i						mySame;
+
+	// from the left: skip 4 matching blocks at a time, then find the first block that differs
+	for (myFirst = 0; myFirst + 4 <= myNumBlocks; myFirst += 4) {
+		UInt8					*myRow = theRow + (myFirst * kDirtyBlockBytes);
+		UInt8					*myPrevious = thePrevious + (myFirst * kDirtyBlockBytes);
+
+		mySame = _mm_and_si128(_mm_cmpeq_epi8(_mm_loadu_si128((__m128i *)myRow), _mm_loadu_si128((__m128i *)myPrevious)),
+								_mm_cmpeq_epi8(_mm_loadu_si128((__m128i *)(myRow + 16)), _mm_loadu_si128((__m128i *)(myPrevious + 16))));
+		mySame = _mm_and_si128(mySame, _mm_cmpeq_epi8(_mm_loadu_si128((__m128i *)(myRow + 32)), _mm_loadu_si128((__m128i *)(myPrevious + 32))));
+		mySame = _mm_and_si128(mySame, _mm_cmpeq_epi8(_mm_loadu_si128((__m128i *)(myRow + 48)), _mm_loadu_si128((__m128i *)(myPrevious + 48))));
+		if (_mm_movemask_epi8(mySame) != 0xFFFF)
+			break;
+	}
+
+	for (; myFirst < myNumBlocks; myFirst++) {
+		mySame = _mm_cmpeq_epi8(_mm_loadu_si128((__m128i *)(theRow + (myFirst * kDirtyBlockBytes))), _mm_loadu_si128((__m128i *)(thePrevious + (myFirst * kDirtyBlockBytes))));
+		if (_mm_movemask_epi8(mySame) != 0xFFFF)
+			break;
+	}
+
+	// the leftover bytes at the end of the row are one more, short, block
+	if (myFirst == myNumBlocks) {
+		if ((myNumBlocks * kDirtyBlockBytes == theNumBytes) ||
+			(memcmp(theRow + (myNumBlocks * kDirtyBlockBytes), thePrevious + (myNumBlocks * kDirtyBlockBytes), theNumBytes - (myNumBlocks * kDirtyBlockBytes)) == 0))
+			return(false);
+
+		*theFirst = myNumBlocks * kDirtyBlockBytes;
+		*theEnd = theNumBytes;
+		return(true);
+	}
+
+	*theFirst = myFirst * kDirtyBlockBytes;
+	*theEnd = theNumBytes;
+
+	// from the right: the short block, if it differs, is the last one
+	if ((myNumBlocks * kDirtyBlockBytes < theNumBytes) &&
+		(memcmp(theRow + (myNumBlocks * kDirtyBlockBytes), thePrevious + (myNumBlocks * kDirtyBlockBytes), theNumBytes - (myNumBlocks * kDirtyBlockBytes)) != 0))
+		return(true);
+
+	for (myLast = myNumBlocks - 1; myLast > myFirst; myLast--) {
+		mySame = _mm_cmpeq_epi8(_mm_loadu_si128((__m128i *)(theRow + (myLast * kDirtyBlockBytes))), _mm_loadu_si128((__m128i *)(thePrevious + (myLast * kDirtyBlockBytes))));
+		if (_mm_movemask_epi8(mySame) != 0xFFFF)
+			break;
+	}
+
+	*theEnd = (myLast + 1) * kDirtyBlockBytes;
+
+	return(true);
+}
+#endif	// USE_SSE2_KERNELS
@@ -0,0 +1,100 @@
+//////////
+//
+//	File:		QTCmprDirty.h
+//
+//	Contains:	Detection of the part of each frame that changed since the last one, for use by QTCompress.
+//
+//	Written by:	Tim Monroe
+//
+//	Copyright:	 2000 by Apple Computer, Inc., all rights reserved.
+//
+//	Change History (most recent first):
+//
+//	   <1>	 	11/04/26	rtm		first file
+//
+//////////
+
+#pragma once
+
+
+//////////
+//
+// header files
+//
+//////////
+
+#ifndef __QTCmprDirty__
+#define __QTCmprDirty__
+
+#ifndef __MOVIES__
+#include <Movies.h>
+#endif
+
+#include "QTCmprBudget.h"
+#include "QTCmprColor.h"										// for USE_SSE2_KERNELS
+
+
+//////////
+//
+// constants
+//
+//////////
+
+#define kDirtyBlockBytes				16						// rows are compared in blocks of this many bytes
+#define kDirtyTrialFrames				60						// if none of the first this many frames is unchanged...
+#define kDirtyGiveUpPercent				90						// ...and on average more than this much of each frame changed, we stop looking
+#define kDirtyCheckBytes				77						// size of the test row we compare the SSE2 and C routines on
+
+
+//////////
+//
+// data types
+//
+//////////
+
+// the routine that compares a row with the same row of the previous frame; if they differ, it returns the byte
+// offsets of the first differing block and of the end of the last differing block
+typedef Boolean (*DirtyRowProcPtr) (UInt8 *theRow, UInt8 *thePrevious, long theNumBytes, long *theFirst, long *theEnd);
+
+typedef struct DirtyKernels {
+	DirtyRowProcPtr				fCompareRow;
+	char						*fName;
+} DirtyKernels, *DirtyKernelsPtr;
+
+// a detector of changes in the frames in a pixel map; it keeps a copy of the last frame it saw
+typedef struct DirtyDetector {
+	PixMapHandle				fPixMap;
+	short						fDepth;
+	long						fWidth;
+	long						fHeight;
+	long						fRowBytes;							// the number of bytes of pixels in each row of fPrevious
+	UInt8						*fPrevious;							// the last frame, or NULL if we haven't seen one
+	Boolean						fHasPrevious;
+	Boolean						fIsActive;							// are we still looking for changes?
+	long						fNumFrames;
+	long						fNumUnchanged;
+	double						fDirtyPercent;						// the sum of the percentage of each frame that changed
+	double						fCompareTime;						// microseconds spent comparing frames
+	long						fSize;								// the number of bytes reserved
+	MemoryJobPtr				fJob;
+} DirtyDetector, *DirtyDetectorPtr;
+
+
+//////////
+//
+// function prototypes
+//
+//////////
+
+OSErr							QTCmpr_NewDirtyDetector (DirtyDetectorPtr theDetector, PixMapHandle thePixMap, MemoryJobPtr theJob);
+Boolean							QTCmpr_FindDirtyRect (DirtyDetectorPtr theDetector, Rect *theDirtyRect);
+void							QTCmpr_DisposeDirtyDetector (DirtyDetectorPtr theDetector);
+static void						QTCmpr_StopDirtyDetector (DirtyDetectorPtr theDetector);
+static DirtyKernelsPtr			QTCmpr_GetDirtyKernels (void);
+static Boolean					QTCmpr_CheckDirtyKernels (DirtyKernelsPtr theKernels, DirtyKernelsPtr theReference);
+static Boolean					QTCmpr_CompareRow_C (UInt8 *theRow, UInt8 *thePrevious, long theNumBytes, long *theFirst, long *theEnd);
+#if USE_SSE2_KERNELS
+static Boolean					QTCmpr_CompareRow_SSE2 (UInt8 *theRow, UInt8 *thePrevious, long theNumBytes, long *theFirst, long *theEnd);
+#endif
+
+#endif	// __QTCmprDirty__
@@ -0,0 +1,768 @@
+//////////
+//
+//	File:		QTCmprFragment.c
+//
+//	Contains:	A writer for fragmented movie files, which can be written to pipes and read while they grow,
+//				for use by QTCompress.
+//
+//	Written by:	Tim Monroe
+//
+//	Copyright:	 2000 by Apple Computer, Inc., all rights reserved.
+//
+//	Change History (most recent first):
+//
+//	   <1>	 	10/26/26	rtm		first file
+//
+//	A movie file written by the Movie Toolbox can't be read until it's finished: the movie atom, which holds
+//	the sample tables, is added only by the call to AddMovieResource at the very end, and the Movie Toolbox
+//	needs a file it can seek in. If we crash (or the user quits) halfway through compressing a long movie,
+//	everything compressed so far is lost.
+//
+//	Instead, we can write a fragmented movie file (as described in ISO/IEC 14496-12), which the Movie Toolbox
+//	doesn't know how to write but which we can easily write ourselves, strictly from front to back. The file
+//	begins with a file type atom and a movie atom whose sample tables are empty, followed by a series of
+//	fragments; each fragment is a movie fragment atom, which lists the sizes, durations, and flags of the
+//	samples in the fragment, followed by a media data atom holding the samples themselves. Since we never seek,
+//	we can write to standard output or to a named pipe as well as to a file; a reader can start playing the
+//	movie as soon as the first fragment arrives, and a file that's cut short loses at most the fragment
+//	that was being written.
+//
+//	We begin a new fragment at the first key frame after the current fragment holds the requested number of
+//	frames, so that each fragment can be decoded on its own. If key frames are rare, we begin a new fragment
+//	anyway once the current one gets much too long.
+//
+//	The movie atom needs the sample description, which isn't known until the first frame is compressed, so
+//	we write the file header when we get the first sample. All samples must use that sample description.
+//
+//////////
+
+//////////
+//
+// header files
+//
+//////////
+
+#include <string.h>
+
+#include "QTCmprFragment.h"
+
+#if TARGET_OS_WIN32
+#include <fcntl.h>
+#include <io.h>
+#endif
+
+#if TARGET_RT_MAC_MACHO
+#include <signal.h>
+#endif
+
+
+//////////
+//
+// QTCmpr_BeginFragmentWriter
+// Open the specified file (or standard output, if thePath is kFragmentStdOutName) and prepare to write
+// a fragmented movie into it.
+//
+// The buffers are reserved against the memory budget for the specified job. Call QTCmpr_EndFragmentWriter
+// even if this function fails.
+//
+//////////
+
+OSErr QTCmpr_BeginFragmentWriter (FragmentWriterPtr theWriter, char *thePath, TimeScale theTimeScale, short theWidth, short theHeight, long theFramesPerFragment, MemoryJobPtr theJob)
+{
+	long						mySize;
+
+	if (theWriter == NULL)
+		return(paramErr);
+
+	theWriter->fFile = NULL;
+	theWriter->fIsStdOut = false;
+	theWriter->fTimeScale = theTimeScale;
+	theWriter->fWidth = theWidth;
+	theWriter->fHeight = theHeight;
+	theWriter->fDesc = NULL;
+	theWriter->fWroteHeader = false;
+	theWriter->fFramesPerFragment = (theFramesPerFragment > 0L) ? theFramesPerFragment : kFragmentDefaultFrames;
+	theWriter->fMaxSamples = theWriter->fFramesPerFragment * kFragmentMaxFrameFactor;
+	theWriter->fSamples = NULL;
+	theWriter->fNumSamples = 0L;
+	theWriter->fData = NULL;
+	theWriter->fDataSize = 0L;
+	theWriter->fDataCapacity = 0L;
+	theWriter->fHeader = NULL;
+	theWriter->fHeaderCapacity = 0L;
+	theWriter->fSequenceNumber = 1L;
+	theWriter->fDecodeTime.hi = 0L;
+	theWriter->fDecodeTime.lo = 0L;
+	theWriter->fNumFragments = 0L;
+	theWriter->fJob = theJob;
+
+	if ((thePath == NULL) || (theTimeScale <= 0L))
+		return(paramErr);
+
+	if (strcmp(thePath, kFragmentStdOutName) == 0) {
+#if TARGET_OS_WIN32
+		// standard output is opened in text mode, which would expand every linefeed byte in the movie data
+		_setmode(_fileno(stdout), _O_BINARY);
+#endif
+		theWriter->fFile = stdout;
+		theWriter->fIsStdOut = true;
+	} else {
+		// if thePath names a pipe, this waits until a reader opens the other end
+		theWriter->fFile = fopen(thePath, "wb");
+		if (theWriter->fFile == NULL)
+			return(fnfErr);
+	}
+
+#if TARGET_RT_MAC_MACHO
+	// if the reader goes away, we want an error from fwrite, not a signal that quits the application
+	signal(SIGPIPE, SIG_IGN);
+#endif
+
+	// allocate the list of samples in a fragment
+	mySize = theWriter->fMaxSamples * sizeof(FragmentSample);
+	QTCmpr_ReserveMemory(theWriter->fJob, mySize);
+
+	theWriter->fSamples = (FragmentSamplePtr)NewPtr(mySize);
+	if (theWriter->fSamples == NULL) {
+		QTCmpr_ReleaseMemory(theWriter->fJob, mySize);
+		return(memFullErr);
+	}
+
+	return(QTCmpr_GrowFragmentBuffer(theWriter, &theWriter->fData, &theWriter->fDataCapacity, kFragmentInitialDataSize, 0L));
+}
+
+
+//////////
+//
+// QTCmpr_WriteFragmentSample
+// Add a sample to the fragmented movie.
+//
+// The sample data is copied, so the caller may reuse theData as soon as this function returns. The sample
+// isn't written until its fragment is complete.
+//
+//////////
+
+OSErr QTCmpr_WriteFragmentSample (FragmentWriterPtr theWriter, Ptr theData, long theSize, TimeValue theDuration, SampleDescriptionHandle theDesc, short theFlags)
+{
+	long						myCapacity;
+	FragmentSamplePtr			mySample = NULL;
+	OSErr						myErr = noErr;
+
+	if ((theWriter == NULL) || (theWriter->fSamples == NULL) || (theData == NULL) || (theSize <= 0L) || (theDesc == NULL))
+		return(paramErr);
+
+	// the first sample supplies the sample description for the movie atom; all later samples must use it too
+	if (!theWriter->fWroteHeader) {
+		theWriter->fDesc = theDesc;
+
+		myErr = QTCmpr_WriteFragmentHeader(theWriter);
+		if (myErr != noErr)
+			return(myErr);
+	} else if (theDesc != theWriter->fDesc) {
+		return(paramErr);
+	}
+
+	// begin a new fragment at a key frame once this one is long enough, or at any frame once it's full
+	if (((theWriter->fNumSamples >= theWriter->fFramesPerFragment) && !(theFlags & mediaSampleNotSync)) ||
+		(theWriter->fNumSamples == theWriter->fMaxSamples)) {
+		myErr = QTCmpr_FlushFragment(theWriter);
+		if (myErr != noErr)
+			return(myErr);
+	}
+
+	// make sure the sample fits in the data buffer
+	if (theWriter->fDataSize + theSize > theWriter->fDataCapacity) {
+		myCapacity = theWriter->fDataCapacity * 2;
+		if (myCapacity < theWriter->fDataSize + theSize)
+			myCapacity = theWriter->fDataSize + theSize;
+
+		myErr = QTCmpr_GrowFragmentBuffer(theWriter, &theWriter->fData, &theWriter->fDataCapacity, myCapacity, theWriter->fDataSize);
+		if (myErr != noErr)
+			return(myErr);
+	}
+
+	BlockMoveData(theData, theWriter->fData + theWriter->fDataSize, theSize);
+	theWriter->fDataSize += theSize;
+
+	mySample = &theWriter->fSamples[theWriter->fNumSamples++];
+	mySample->fSize = theSize;
+	mySample->fDuration = theDuration;
+	mySample->fFlags = theFlags;
+
+	return(noErr);
+}
+
+
+//////////
+//
+// QTCmpr_EndFragmentWriter
+// Finish writing the fragmented movie, writing out the last fragment if theFlush is true, and close the file.
+//
+//////////
+
+OSErr QTCmpr_EndFragmentWriter (FragmentWriterPtr theWriter, Boolean theFlush)
+{
+	OSErr						myErr = noErr;
+
+	if (theWriter == NULL)
+		return(paramErr);
+
+	if (theFlush && (theWriter->fFile != NULL))
+		myErr = QTCmpr_FlushFragment(theWriter);
+
+	if (theWriter->fFile != NULL) {
+		if (theWriter->fIsStdOut)
+			fflush(theWriter->fFile);
+		else if ((fclose(theWriter->fFile) != 0) && (myErr == noErr))
+			myErr = ioErr;
+	}
+
+	if (theWriter->fSamples != NULL) {
+		DisposePtr((Ptr)theWriter->fSamples);
+		QTCmpr_ReleaseMemory(theWriter->fJob, theWriter->fMaxSamples * sizeof(FragmentSample));
+	}
+
+	if (theWriter->fData != NULL) {
+		DisposePtr(theWriter->fData);
+		QTCmpr_ReleaseMemory(theWriter->fJob, theWriter->fDataCapacity);
+	}
+
+	if (theWriter->fHeader != NULL) {
+		DisposePtr(theWriter->fHeader);
+		QTCmpr_ReleaseMemory(theWriter->fJob, theWriter->fHeaderCapacity);
+	}
+
+	theWriter->fFile = NULL;
+	theWriter->fSamples = NULL;
+	theWriter->fData = NULL;
+	theWriter->fHeader = NULL;
+	theWriter->fNumSamples = 0L;
+	theWriter->fDataSize = 0L;
+
+	return(myErr);
+}
+
+
+//////////
+//
+// QTCmpr_WriteFragmentHeader
+// Write the file type atom and the movie atom.
+//
+// The movie atom describes a single video track whose sample tables are empty; the movie extends atom
+// tells the reader to look for the samples in movie fragments.
+//
+//////////
+
+static OSErr QTCmpr_WriteFragmentHeader (FragmentWriterPtr theWriter)
+{
+	UInt8						*myBytes;
+	long						myPos = 0L;
+	long						myMoov, myTrak, myMdia, myMinf, myDinf, myDref, myStbl, myStsd, myMvex, myAtom;
+	OSErr						myErr = noErr;
+
+	myErr = QTCmpr_GrowFragmentBuffer(theWriter, &theWriter->fHeader, &theWriter->fHeaderCapacity, kFragmentInitHeaderSize + GetHandleSize((Handle)theWriter->fDesc), 0L);
+	if (myErr != noErr)
+		return(myErr);
+
+	myBytes = (UInt8 *)theWriter->fHeader;
+
+	// file type atom
+	myAtom = myPos;
+	myPos = QTCmpr_BeginAtom(myBytes, myPos, FOUR_CHAR_CODE('ftyp'));
+	myPos = QTCmpr_PutLong(myBytes, myPos, FOUR_CHAR_CODE('iso5'));			// major brand
+	myPos = QTCmpr_PutLong(myBytes, myPos, 0L);								// minor version
+	myPos = QTCmpr_PutLong(myBytes, myPos, FOUR_CHAR_CODE('iso5'));			// compatible brands
+	myPos = QTCmpr_PutLong(myBytes, myPos, FOUR_CHAR_CODE('isom'));
+	QTCmpr_EndAtom(myBytes, myAtom, myPos);
+
+	// movie atom
+	myMoov = myPos;
+	myPos = QTCmpr_BeginAtom(myBytes, myPos, FOUR_CHAR_CODE('moov'));
+
+	// movie header atom
+	myAtom = myPos;
+	myPos = QTCmpr_BeginFullAtom(myBytes, myPos, FOUR_CHAR_CODE('mvhd'), 0, 0L);
+	myPos = QTCmpr_PutLong(myBytes, myPos, 0L);								// creation time
+	myPos = QTCmpr_PutLong(myBytes, myPos, 0L);								// modification time
+	myPos = QTCmpr_PutLong(myBytes, myPos, theWriter->fTimeScale);
+	myPos = QTCmpr_PutLong(myBytes, myPos, 0L);								// duration; the fragments supply it
+	myPos = QTCmpr_PutLong(myBytes, myPos, fixed1);							// preferred rate
+	myPos = QTCmpr_PutShort(myBytes, myPos, 0x0100);							// preferred volume
+	myPos = QTCmpr_PutZeros(myBytes, myPos, 10L);
+	myPos = QTCmpr_PutMatrix(myBytes, myPos);
+	myPos = QTCmpr_PutZeros(myBytes, myPos, 24L);							// preview, poster, selection, and current times
+	myPos = QTCmpr_PutLong(myBytes, myPos, kFragmentTrackID + 1);				// next track ID
+	QTCmpr_EndAtom(myBytes, myAtom, myPos);
+
+	// track atom
+	myTrak = myPos;
+	myPos = QTCmpr_BeginAtom(myBytes, myPos, FOUR_CHAR_CODE('trak'));
+
+	myAtom = myPos;
+	myPos = QTCmpr_BeginFullAtom(myBytes, myPos, FOUR_CHAR_CODE('tkhd'), 0, 0x000007L);	// enabled, in movie, in preview
+	myPos = QTCmpr_PutLong(myBytes, myPos, 0L);								// creation time
+	myPos = QTCmpr_PutLong(myBytes, myPos, 0L);								// modification time
+	myPos = QTCmpr_PutLong(myBytes, myPos, kFragmentTrackID);
+	myPos = QTCmpr_PutLong(myBytes, myPos, 0L);
+	myPos = QTCmpr_PutLong(myBytes, myPos, 0L);								// duration
+	myPos = QTCmpr_PutZeros(myBytes, myPos, 8L);
+	myPos = QTCmpr_PutShort(myBytes, myPos, 0);								// layer
+	myPos = QTCmpr_PutShort(myBytes, myPos, 0);								// alternate group
+	myPos = QTCmpr_PutShort(myBytes, myPos, 0);								// volume
+	myPos = QTCmpr_PutShort(myBytes, myPos, 0);
+	myPos = QTCmpr_PutMatrix(myBytes, myPos);
+	myPos = QTCmpr_PutLong(myBytes, myPos, (UInt32)theWriter->fWidth << 16);
+	myPos = QTCmpr_PutLong(myBytes, myPos, (UInt32)theWriter->fHeight << 16);
+	QTCmpr_EndAtom(myBytes, myAtom, myPos);
+
+	// media atom
+	myMdia = myPos;
+	myPos = QTCmpr_BeginAtom(myBytes, myPos, FOUR_CHAR_CODE('mdia'));
+
+	myAtom = myPos;
+	myPos = QTCmpr_BeginFullAtom(myBytes, myPos, FOUR_CHAR_CODE('mdhd'), 0, 0L);
+	myPos = QTCmpr_PutLong(myBytes, myPos, 0L);								// creation time
+	myPos = QTCmpr_PutLong(myBytes, myPos, 0L);								// modification time
+	myPos = QTCmpr_PutLong(myBytes, myPos, theWriter->fTimeScale);
+	myPos = QTCmpr_PutLong(myBytes, myPos, 0L);								// duration
+	myPos = QTCmpr_PutShort(myBytes, myPos, 0x55C4);							// language ("und", packed)
+	myPos = QTCmpr_PutShort(myBytes, myPos, 0);								// quality
+	QTCmpr_EndAtom(myBytes, myAtom, myPos);
+
+	myAtom = myPos;
+	myPos = QTCmpr_BeginFullAtom(myBytes, myPos, FOUR_CHAR_CODE('hdlr'), 0, 0L);
+	myPos = QTCmpr_PutLong(myBytes, myPos, 0L);
+	myPos = QTCmpr_PutLong(myBytes, myPos, VideoMediaType);
+	myPos = QTCmpr_PutZeros(myBytes, myPos, 12L);
+	myPos = QTCmpr_PutZeros(myBytes, myPos, 1L);								// an empty name
+	QTCmpr_EndAtom(myBytes, myAtom, myPos);
+
+	// media information atom
+	myMinf = myPos;
+	myPos = QTCmpr_BeginAtom(myBytes, myPos, FOUR_CHAR_CODE('minf'));
+
+	myAtom = myPos;
+	myPos = QTCmpr_BeginFullAtom(myBytes, myPos, FOUR_CHAR_CODE('vmhd'), 0, 0x000001L);
+	myPos = QTCmpr_PutShort(myBytes, myPos, 0);								// graphics mode
+	myPos = QTCmpr_PutZeros(myBytes, myPos, 6L);								// opcolor
+	QTCmpr_EndAtom(myBytes, myAtom, myPos);
+
+	// the samples are in this file
+	myDinf = myPos;
+	myPos = QTCmpr_BeginAtom(myBytes, myPos, FOUR_CHAR_CODE('dinf'));
+	myDref = myPos;
+	myPos = QTCmpr_BeginFullAtom(myBytes, myPos, FOUR_CHAR_CODE('dref'), 0, 0L);
+	myPos = QTCmpr_PutLong(myBytes, myPos, 1L);
+	myAtom = myPos;
+	myPos = QTCmpr_BeginFullAtom(myBytes, myPos, FOUR_CHAR_CODE('url '), 0, 0x000001L);
+	QTCmpr_EndAtom(myBytes, myAtom, myPos);
+	QTCmpr_EndAtom(myBytes, myDref, myPos);
+	QTCmpr_EndAtom(myBytes, myDinf, myPos);
+
+	// sample table atom; only the sample description table has any entries
+	myStbl = myPos;
+	myPos = QTCmpr_BeginAtom(myBytes, myPos, FOUR_CHAR_CODE('stbl'));
+
+	myStsd = myPos;
+	myPos = QTCmpr_BeginFullAtom(myBytes, myPos, FOUR_CHAR_CODE('stsd'), 0, 0L);
+	myPos = QTCmpr_PutLong(myBytes, myPos, 1L);
+	myPos = QTCmpr_PutSampleDescription(myBytes, myPos, (ImageDescriptionHandle)theWriter->fDesc);
+	QTCmpr_EndAtom(myBytes, myStsd, myPos);
+
+	myAtom = myPos;
+	myPos = QTCmpr_BeginFullAtom(myBytes, myPos, FOUR_CHAR_CODE('stts'), 0, 0L);
+	myPos = QTCmpr_PutLong(myBytes, myPos, 0L);
+	QTCmpr_EndAtom(myBytes, myAtom, myPos);
+
+	myAtom = myPos;
+	myPos = QTCmpr_BeginFullAtom(myBytes, myPos, FOUR_CHAR_CODE('stsc'), 0, 0L);
+	myPos = QTCmpr_PutLong(myBytes, myPos, 0L);
+	QTCmpr_EndAtom(myBytes, myAtom, myPos);
+
+	myAtom = myPos;
+	myPos = QTCmpr_BeginFullAtom(myBytes, myPos, FOUR_CHAR_CODE('stsz'), 0, 0L);
+	myPos = QTCmpr_PutLong(myBytes, myPos, 0L);
+	myPos = QTCmpr_PutLong(myBytes, myPos, 0L);
+	QTCmpr_EndAtom(myBytes, myAtom, myPos);
+
+	myAtom = myPos;
+	myPos = QTCmpr_BeginFullAtom(myBytes, myPos, FOUR_CHAR_CODE('stco'), 0, 0L);
+	myPos = QTCmpr_PutLong(myBytes, myPos, 0L);
+	QTCmpr_EndAtom(myBytes, myAtom, myPos);
+
+	QTCmpr_EndAtom(myBytes, myStbl, myPos);
+	QTCmpr_EndAtom(myBytes, myMinf, myPos);
+	QTCmpr_EndAtom(myBytes, myMdia, myPos);
+	QTCmpr_EndAtom(myBytes, myTrak, myPos);
+
+	// movie extends atom; the track's samples are all in fragments
+	myMvex = myPos;
+	myPos = QTCmpr_BeginAtom(myBytes, myPos, FOUR_CHAR_CODE('mvex'));
+	myAtom = myPos;
+	myPos = QTCmpr_BeginFullAtom(myBytes, myPos, FOUR_CHAR_CODE('trex'), 0, 0L);
+	myPos = QTCmpr_PutLong(myBytes, myPos, kFragmentTrackID);
+	myPos = QTCmpr_PutLong(myBytes, myPos, 1L);								// default sample description index
+	myPos = QTCmpr_PutLong(myBytes, myPos, 0L);								// default sample duration
+	myPos = QTCmpr_PutLong(myBytes, myPos, 0L);								// default sample size
+	myPos = QTCmpr_PutLong(myBytes, myPos, 0L);								// default sample flags
+	QTCmpr_EndAtom(myBytes, myAtom, myPos);
+	QTCmpr_EndAtom(myBytes, myMvex, myPos);
+
+	QTCmpr_EndAtom(myBytes, myMoov, myPos);
+
+	myErr = QTCmpr_WriteFragmentBytes(theWriter, myBytes, myPos);
+	if (myErr != noErr)
+		return(myErr);
+
+	if (fflush(theWriter->fFile) != 0)
+		return(ioErr);
+
+	theWriter->fWroteHeader = true;
+
+	return(noErr);
+}
+
+
+//////////
+//
+// QTCmpr_FlushFragment
+// Write the samples in the fragment buffer as a movie fragment atom followed by a media data atom.
+//
+// We flush the file after each fragment, so that a reader (or a file cut short by a crash) always sees
+// whole fragments.
+//
+//////////
+
+static OSErr QTCmpr_FlushFragment (FragmentWriterPtr theWriter)
+{
+	UInt8						*myBytes;
+	long						myPos = 0L;
+	long						myMoof, myTraf, myAtom, myOffsetPos;
+	long						myIndex;
+	FragmentSamplePtr			mySample;
+	UInt32						mySampleFlags;
+	UInt32						myLow;
+	OSErr						myErr = noErr;
+
+	if ((theWriter->fNumSamples == 0L) || !theWriter->fWroteHeader)
+		return(noErr);
+
+	myErr = QTCmpr_GrowFragmentBuffer(theWriter, &theWriter->fHeader, &theWriter->fHeaderCapacity, kFragmentMoofHeaderSize + (theWriter->fNumSamples * kFragmentMoofEntrySize), 0L);
+	if (myErr != noErr)
+		return(myErr);
+
+	myBytes = (UInt8 *)theWriter->fHeader;
+
+	// movie fragment atom
+	myMoof = myPos;
+	myPos = QTCmpr_BeginAtom(myBytes, myPos, FOUR_CHAR_CODE('moof'));
+
+	myAtom = myPos;
+	myPos = QTCmpr_BeginFullAtom(myBytes, myPos, FOUR_CHAR_CODE('mfhd'), 0, 0L);
+	myPos = QTCmpr_PutLong(myBytes, myPos, theWriter->fSequenceNumber);
+	QTCmpr_EndAtom(myBytes, myAtom, myPos);
+
+	// track fragment atom; the sample data offsets are relative to the start of the movie fragment atom
+	myTraf = myPos;
+	myPos = QTCmpr_BeginAtom(myBytes, myPos, FOUR_CHAR_CODE('traf'));
+
+	myAtom = myPos;
+	myPos = QTCmpr_BeginFullAtom(myBytes, myPos, FOUR_CHAR_CODE('tfhd'), 0, kFragmentDefaultBaseIsMoof);
+	myPos = QTCmpr_PutLong(myBytes, myPos, kFragmentTrackID);
+	QTCmpr_EndAtom(myBytes, myAtom, myPos);
+
+	// the media time of the first sample in the fragment, so that a reader can start with any fragment
+	myAtom = myPos;
+	myPos = QTCmpr_BeginFullAtom(myBytes, myPos, FOUR_CHAR_CODE('tfdt'), 1, 0L);
+	myPos = QTCmpr_PutLong(myBytes, myPos, theWriter->fDecodeTime.hi);
+	myPos = QTCmpr_PutLong(myBytes, myPos, theWriter->fDecodeTime.lo);
+	QTCmpr_EndAtom(myBytes, myAtom, myPos);
+
+	myAtom = myPos;
+	myPos = QTCmpr_BeginFullAtom(myBytes, myPos, FOUR_CHAR_CODE('trun'), 0, kFragmentRunDataOffsetPresent | kFragmentRunDurationPresent | kFragmentRunSizePresent | kFragmentRunFlagsPresent);
+	myPos = QTCmpr_PutLong(myBytes, myPos, theWriter->fNumSamples);
+	myOffsetPos = myPos;
+	myPos = QTCmpr_PutLong(myBytes, myPos, 0L);								// data offset; filled in below
+
+	for (myIndex = 0; myIndex < theWriter->fNumSamples; myIndex++) {
+		mySample = &theWriter->fSamples[myIndex];
+
+		if (mySample->fFlags & mediaSampleNotSync)
+			mySampleFlags = kFragmentSampleDependsOnOthers | kFragmentSampleIsNotSync;
+		else
+			mySampleFlags = kFragmentSampleDependsOnNothing;
+
+		myPos = QTCmpr_PutLong(myBytes, myPos, mySample->fDuration);
+		myPos = QTCmpr_PutLong(myBytes, myPos, mySample->fSize);
+		myPos = QTCmpr_PutLong(myBytes, myPos, mySampleFlags);
+
+		// keep track of the media time of the next fragment
+		myLow = theWriter->fDecodeTime.lo + (UInt32)mySample->fDuration;
+		if (myLow < theWriter->fDecodeTime.lo)
+			theWriter->fDecodeTime.hi++;
+		theWriter->fDecodeTime.lo = myLow;
+	}
+
+	QTCmpr_EndAtom(myBytes, myAtom, myPos);
+	QTCmpr_EndAtom(myBytes, myTraf, myPos);
+	QTCmpr_EndAtom(myBytes, myMoof, myPos);
+
+	// the samples begin just past the header of the media data atom that follows the movie fragment atom
+	QTCmpr_PutLong(myBytes, myOffsetPos, (UInt32)(myPos - myMoof) + kFragmentAtomHeaderSize);
+
+	// media data atom header
+	myPos = QTCmpr_PutLong(myBytes, myPos, (UInt32)theWriter->fDataSize + kFragmentAtomHeaderSize);
+	myPos = QTCmpr_PutLong(myBytes, myPos, FOUR_CHAR_CODE('mdat'));
+
+	myErr = QTCmpr_WriteFragmentBytes(theWriter, myBytes, myPos);
+	if (myErr == noErr)
+		myErr = QTCmpr_WriteFragmentBytes(theWriter, theWriter->fData, theWriter->fDataSize);
+	if ((myErr == noErr) && (fflush(theWriter->fFile) != 0))
+		myErr = ioErr;
+	if (myErr != noErr)
+		return(myErr);
+
+	theWriter->fSequenceNumber++;
+	theWriter->fNumFragments++;
+	theWriter->fNumSamples = 0L;
+	theWriter->fDataSize = 0L;
+
+	return(noErr);
+}
+
+
+//////////
+//
+// QTCmpr_GrowFragmentBuffer
+// Make sure the specified buffer can hold at least theSize bytes, keeping the first theKeep bytes.
+//
+//////////
+
+static OSErr QTCmpr_GrowFragmentBuffer (FragmentWriterPtr theWriter, Ptr *theBuffer, long *theCapacity, long theSize, long theKeep)
+{
+	Ptr							myBuffer = NULL;
+
+	if (theSize <= *theCapacity)
+		return(noErr);
+
+	QTCmpr_ReserveMemory(theWriter->fJob, theSize);
+
+	myBuffer = NewPtr(theSize);
+	if (myBuffer == NULL) {
+		QTCmpr_ReleaseMemory(theWriter->fJob, theSize);
+		return(memFullErr);
+	}
+
+	if (*theBuffer != NULL) {
+		if (theKeep > 0L)
+			BlockMoveData(*theBuffer, myBuffer, theKeep);
+		DisposePtr(*theBuffer);
+		QTCmpr_ReleaseMemory(theWriter->fJob, *theCapacity);
+	}
+
+	*theBuffer = myBuffer;
+	*theCapacity = theSize;
+
+	return(noErr);
+}
+
+
+//////////
+//
+// QTCmpr_WriteFragmentBytes
+// Write the specified bytes to the output file.
+//
+//////////
+
+static OSErr QTCmpr_WriteFragmentBytes (FragmentWriterPtr theWriter, void *theData, long theSize)
+{
+	if (theSize <= 0L)
+		return(noErr);
+
+	if (fwrite(theData, 1, (size_t)theSize, theWriter->fFile) != (size_t)theSize)
+		return(ioErr);
+
+	return(noErr);
+}
+
+
+//////////
+//
+// QTCmpr_PutSampleDescription
+// Put the specified image description into theBytes at thePos, in the big-endian form used in movie files;
+// return the position just past it.
+//
+// On Windows, the fields of an image description in memory are in native byte order; any extensions that
+// follow the fields are already in big-endian form, so we copy them as they are.
+//
+//////////
+
+static long QTCmpr_PutSampleDescription (UInt8 *theBytes, long thePos, ImageDescriptionHandle theDesc)
+{
+	ImageDescriptionPtr			myDesc = *theDesc;
+	long						mySize = myDesc->idSize;
+
+	if (mySize > GetHandleSize((Handle)theDesc))
+		mySize = GetHandleSize((Handle)theDesc);
+	if (mySize < (long)sizeof(ImageDescription))
+		mySize = sizeof(ImageDescription);
+
+	thePos = QTCmpr_PutLong(theBytes, thePos, mySize);
+	thePos = QTCmpr_PutLong(theBytes, thePos, myDesc->cType);
+	thePos = QTCmpr_PutZeros(theBytes, thePos, 6L);
+	thePos = QTCmpr_PutShort(theBytes, thePos, 1);							// data reference index
+	thePos = QTCmpr_PutShort(theBytes, thePos, myDesc->version);
+	thePos = QTCmpr_PutShort(theBytes, thePos, myDesc->revisionLevel);
+	thePos = QTCmpr_PutLong(theBytes, thePos, myDesc->vendor);
+	thePos = QTCmpr_PutLong(theBytes, thePos, myDesc->temporalQuality);
+	thePos = QTCmpr_PutLong(theBytes, thePos, myDesc->spatialQuality);
+	thePos = QTCmpr_PutShort(theBytes, thePos, myDesc->width);
+	thePos = QTCmpr_PutShort(theBytes, thePos, myDesc->height);
+	thePos = QTCmpr_PutLong(theBytes, thePos, myDesc->hRes);
+	thePos = QTCmpr_PutLong(theBytes, thePos, myDesc->vRes);
+	thePos = QTCmpr_PutLong(theBytes, thePos, myDesc->dataSize);
+	thePos = QTCmpr_PutShort(theBytes, thePos, myDesc->frameCount);
+	thePos = QTCmpr_PutBytes(theBytes, thePos, myDesc->name, sizeof(myDesc->name));
+	thePos = QTCmpr_PutShort(theBytes, thePos, myDesc->depth);
+	thePos = QTCmpr_PutShort(theBytes, thePos, myDesc->clutID);
+
+	if (mySize > (long)sizeof(ImageDescription))
+		thePos = QTCmpr_PutBytes(theBytes, thePos, (Ptr)myDesc + sizeof(ImageDescription), mySize - sizeof(ImageDescription));
+
+	return(thePos);
+}
+
+
+//////////
+//
+// QTCmpr_BeginAtom
+// Put the header of an atom of the specified type into theBytes at thePos; return the position just past it.
+//
+// The atom size is filled in by QTCmpr_EndAtom.
+//
+//////////
+
+static long QTCmpr_BeginAtom (UInt8 *theBytes, long thePos, OSType theType)
+{
+	thePos = QTCmpr_PutLong(theBytes, thePos, 0L);
+	thePos = QTCmpr_PutLong(theBytes, thePos, theType);
+
+	return(thePos);
+}
+
+
+//////////
+//
+// QTCmpr_BeginFullAtom
+// Put the header of an atom of the specified type that has version and flags fields into theBytes at thePos;
+// return the position just past it.
+//
+//////////
+
+static long QTCmpr_BeginFullAtom (UInt8 *theBytes, long thePos, OSType theType, UInt8 theVersion, UInt32 theFlags)
+{
+	thePos = QTCmpr_BeginAtom(theBytes, thePos, theType);
+	thePos = QTCmpr_PutLong(theBytes, thePos, ((UInt32)theVersion << 24) | (theFlags & 0x00FFFFFF));
+
+	return(thePos);
+}
+
+
+//////////
+//
+// QTCmpr_EndAtom
+// Fill in the size of the atom that begins at theAtomPos and ends at thePos.
+//
+//////////
+
+static void QTCmpr_EndAtom (UInt8 *theBytes, long theAtomPos, long thePos)
+{
+	QTCmpr_PutLong(theBytes, theAtomPos, thePos - theAtomPos);
+}
+
+
+//////////
+//
+// QTCmpr_PutBytes
+// Put the specified bytes into theBytes at thePos; return the position just past them.
+//
+//////////
+
+static long QTCmpr_PutBytes (UInt8 *theBytes, long thePos, void *theData, long theSize)
+{
+	BlockMoveData(theData, theBytes + thePos, theSize);
+
+	return(thePos + theSize);
+}
+
+
+//////////
+//
+// QTCmpr_PutZeros
+// Put theSize zero bytes into theBytes at thePos; return the position just past them.
+//
+//////////
+
+static long QTCmpr_PutZeros (UInt8 *theBytes, long thePos, long theSize)
+{
+	memset(theBytes + thePos, 0, (size_t)theSize);
+
+	return(thePos + theSize);
+}
+
+
+//////////
+//
+// QTCmpr_PutLong
+// Put the specified 32-bit value into theBytes at thePos, in big-endian order; return the position just past it.
+//
+//////////
+
+static long QTCmpr_PutLong (UInt8 *theBytes, long thePos, UInt32 theValue)
+{
+	theBytes[thePos + 0] = (UInt8)(theValue >> 24);
+	theBytes[thePos + 1] = (UInt8)(theValue >> 16);
+	theBytes[thePos + 2] = (UInt8)(theValue >> 8);
+	theBytes[thePos + 3] = (UInt8)(theValue);
+
+	return(thePos + 4);
+}
+
+
+//////////
+//
+// QTCmpr_PutShort
+// Put the specified 16-bit value into theBytes at thePos, in big-endian order; return the position just past it.
+//
+//////////
+
+static long QTCmpr_PutShort (UInt8 *theBytes, long thePos, UInt16 theValue)
+{
+	theBytes[thePos + 0] = (UInt8)(theValue >> 8);
+	theBytes[thePos + 1] = (UInt8)(theValue);
+
+	return(thePos + 2);
+}
+
+
+//////////
+//
+// QTCmpr_PutMatrix
+// Put an identity matrix into theBytes at thePos; return the position just past it.
+//
+//////////
+
+static long QTCmpr_PutMatrix (UInt8 *theBytes, long thePos)
+{
+	thePos = QTCmpr_PutLong(theBytes, thePos, fixed1);
+	thePos = QTCmpr_PutLong(theBytes, thePos, 0L);
+	thePos = QTCmpr_PutLong(theBytes, thePos, 0L);
+	thePos = QTCmpr_PutLong(theBytes, thePos, 0L);
+	thePos = QTCmpr_PutLong(theBytes, thePos, fixed1);
+	thePos = QTCmpr_PutLong(theBytes, thePos, 0L);
+	thePos = QTCmpr_PutLong(theBytes, thePos, 0L);
+	thePos = QTCmpr_PutLong(theBytes, thePos, 0L);
+	thePos = QTCmpr_PutLong(theBytes, thePos, 0x40000000L);					// w, in 2.30 fixed point
+
+	return(thePos);
+}
@@ -0,0 +1,132 @@
+//////////
+//
+//	File:		QTCmprFragment.h
+//
+//	Contains:	A writer for fragmented movie files, which can be written to pipes and read while they grow,
+//				for use by QTCompress.
+//
+//	Written by:	Tim Monroe
+//
+//	Copyright:	 2000 by Apple Computer, Inc., all rights reserved.
+//
+//	Change History (most recent first):
+//
+//	   <1>	 	10/26/26	rtm		first file
+//
+//////////
+
+#pragma once
+
+
+//////////
+//
+// header files
+//
+//////////
+
+#ifndef __QTCmprFragment__
+#define __QTCmprFragment__
+
+#ifndef __MOVIES__
+#include <Movies.h>
+#endif
+
+#include <stdio.h>
+
+#include "QTCmprBudget.h"
+
+
+//////////
+//
+// constants
+//
+//////////
+
+#define kFragmentDefaultFrames			30L						// default number of frames in a fragment
+#define kFragmentMaxFrameFactor			4L						// a fragment never holds more than this many times the requested number of frames
+#define kFragmentInitialDataSize		(256L * 1024L)			// initial size of the fragment's sample data buffer
+#define kFragmentStdOutName				"-"						// the output name that means standard output
+
+#define kFragmentAtomHeaderSize			8L						// size of an atom's size and type fields
+#define kFragmentInitHeaderSize			1024L					// room for the file type and movie atoms, not counting the sample description
+#define kFragmentMoofHeaderSize			128L					// room for the movie fragment atom, not counting the sample entries
+#define kFragmentMoofEntrySize			12L						// size of a sample entry in a track fragment run
+
+#define kFragmentTrackID				1L						// the ID of the one track we write
+
+// track fragment header and run flags (ISO/IEC 14496-12)
+#define kFragmentDefaultBaseIsMoof		0x00020000L
+#define kFragmentRunDataOffsetPresent	0x00000001L
+#define kFragmentRunDurationPresent		0x00000100L
+#define kFragmentRunSizePresent			0x00000200L
+#define kFragmentRunFlagsPresent		0x00000400L
+
+// sample flags (ISO/IEC 14496-12)
+#define kFragmentSampleDependsOnOthers	0x01000000L
+#define kFragmentSampleDependsOnNothing	0x02000000L
+#define kFragmentSampleIsNotSync		0x00010000L
+
+
+//////////
+//
+// data types
+//
+//////////
+
+// a sample waiting in the fragment buffer
+typedef struct FragmentSample {
+	long						fSize;
+	TimeValue					fDuration;
+	short						fFlags;								// media sample flags, as passed to AddMediaSample
+} FragmentSample, *FragmentSamplePtr;
+
+// a fragment writer; the file type and movie atoms are written before the first fragment, and each fragment
+// is a movie fragment atom followed by a media data atom holding the fragment's samples
+typedef struct FragmentWriter {
+	FILE						*fFile;								// the output file, pipe, or standard output
+	Boolean						fIsStdOut;							// are we writing to standard output?
+	TimeScale					fTimeScale;							// the media time scale
+	short						fWidth;								// the track dimensions
+	short						fHeight;
+	SampleDescriptionHandle		fDesc;								// the sample description in the movie atom
+	Boolean						fWroteHeader;						// have we written the file type and movie atoms?
+	long						fFramesPerFragment;					// the number of frames we try to put in each fragment
+	long						fMaxSamples;						// the number of entries in fSamples
+	FragmentSamplePtr			fSamples;							// the samples in the current fragment
+	long						fNumSamples;
+	Ptr							fData;								// the sample data of the current fragment
+	long						fDataSize;
+	long						fDataCapacity;
+	Ptr							fHeader;							// a buffer for building atoms in
+	long						fHeaderCapacity;
+	long						fSequenceNumber;					// the sequence number of the next fragment
+	wide						fDecodeTime;						// the media time of the first sample in the current fragment
+	long						fNumFragments;						// the number of fragments written so far
+	MemoryJobPtr				fJob;								// the job that the buffers are reserved for
+} FragmentWriter, *FragmentWriterPtr;
+
+
+//////////
+//
+// function prototypes
+//
+//////////
+
+OSErr							QTCmpr_BeginFragmentWriter (FragmentWriterPtr theWriter, char *thePath, TimeScale theTimeScale, short theWidth, short theHeight, long theFramesPerFragment, MemoryJobPtr theJob);
+OSErr							QTCmpr_WriteFragmentSample (FragmentWriterPtr theWriter, Ptr theData, long theSize, TimeValue theDuration, SampleDescriptionHandle theDesc, short theFlags);
+OSErr							QTCmpr_EndFragmentWriter (FragmentWriterPtr theWriter, Boolean theFlush);
+static OSErr					QTCmpr_WriteFragmentHeader (FragmentWriterPtr theWriter);
+static OSErr					QTCmpr_FlushFragment (FragmentWriterPtr theWriter);
+static OSErr					QTCmpr_GrowFragmentBuffer (FragmentWriterPtr theWriter, Ptr *theBuffer, long *theCapacity, long theSize, long theKeep);
+static OSErr					QTCmpr_WriteFragmentBytes (FragmentWriterPtr theWriter, void *theData, long theSize);
+static long						QTCmpr_PutSampleDescription (UInt8 *theBytes, long thePos, ImageDescriptionHandle theDesc);
+static long						QTCmpr_BeginAtom (UInt8 *theBytes, long thePos, OSType theType);
+static long						QTCmpr_BeginFullAtom (UInt8 *theBytes, long thePos, OSType theType, UInt8 theVersion, UInt32 theFlags);
+static void						QTCmpr_EndAtom (UInt8 *theBytes, long theAtomPos, long thePos);
+static long						QTCmpr_PutBytes (UInt8 *theBytes, long thePos, void *theData, long theSize);
+static long						QTCmpr_PutZeros (UInt8 *theBytes, long thePos, long theSize);
+static long						QTCmpr_PutLong (UInt8 *theBytes, long thePos, UInt32 theValue);
+static long						QTCmpr_PutShort (UInt8 *theBytes, long thePos, UInt16 theValue);
+static long						QTCmpr_PutMatrix (UInt8 *theBytes, long thePos);
+
+#endif	// __QTCmprFragment__
@@ -0,0 +1,637 @@
+//////////
+//
+//	File:		QTCmprFrameCache.c
+//
+//	Contains:	A memory-bounded cache of rendered movie frames, for use by QTCompress.
+//
+//	Written by:	Tim Monroe
+//
+//	Copyright:	 2000 by Apple Computer, Inc., all rights reserved.
+//
+//	Change History (most recent first):
+//
+//	   <5>	 	11/13/26	rtm		a frame is packed only if it wouldn't otherwise fit without evicting frames or waiting on
+//									the memory budget; USE_PACKED_FRAMES is now off by default
+//	   <4>	 	11/06/26	rtm		frames are now packed (predicted from the pixel to the left, and entropy coded) when
+//									that saves enough memory; see QTCmpr_PackFrame
+//	   <3>	 	11/03/26	rtm		the origin of the movie box is now part of the key, so that cropped frames (see
+//									QTCmpr_GetCropRect) don't match whole ones
+//	   <2>	 	10/22/26	rtm		cached frames now count against the memory budget; the budget can reclaim them
+//	   <1>	 	10/21/26	rtm		first file
+//
+//	Rendering a movie frame (SetMovieTimeValue followed by a few calls to MoviesTask) means decompressing
+//	the frame from scratch, which is by far the most expensive part of recompressing a movie. If the user
+//	compresses the same movie several times (to try out different settings, say), we would decompress
+//	exactly the same frames each time. So we keep a least-recently-used cache of rendered frames, keyed by
+//	the movie, the movie time, the origin of the movie box, and the size and depth of the pixel map the frame
+//	was rendered into.
+//
+//	The cache is shared by everything in QTCompress that renders movie frames: the test image displayed in
+//	the standard image compression dialog box (keyed by the special time value kFrameCachePosterTime) and
+//	the frames rendered while compressing an image sequence.
+//
+//	The total number of bytes of pixel data in the cache is limited (see QTCmpr_SetFrameCacheLimit). A
+//	sequential pass through a movie that's too big to fit in the cache would, with pure LRU replacement,
+//	evict every frame before it's needed again; so a caller can ask that a new frame not displace frames
+//	from the same movie. In that case, the first frames of the movie stay in the cache and are reused the
+//	next time through.
+//
+//	Entries are keyed by the movie identifier, so the cache must be flushed for a movie whenever that movie
+//	is edited or disposed of (see QTCmpr_FlushFrameCache).
+//
+//	The memory held by the cache also counts against the process-wide memory budget (see QTCmprBudget.c).
+//	We add a frame only if the budget has room for it right now, and we give frames back whenever some
+//	compression job needs the memory.
+//
+//	Since the cache is bounded by memory, the smaller each frame is, the more frames it holds. So (if
+//	USE_PACKED_FRAMES is 1) we can pack a frame losslessly before we store it: we replace each byte by its
+//	difference from the same component of the pixel to its left, which leaves mostly small values in any
+//	smooth part of the frame, and entropy code the differences (see QTCmprRANS.c). Unpacking runs at a few
+//	hundred megabytes a second, which is still far faster than decompressing the frame from the movie. A
+//	frame that doesn't pack to kFrameCachePackPercent of its size (noise, say, or a frame that's already
+//	been dithered) is stored as it is.
+//
+//	Packing happens as the frame is rendered, on the compressor's critical path, so we pack a frame only when
+//	that buys room: when storing it as it is would evict other frames, or the memory budget can't spare its
+//	full size. While the cache and the budget have room, frames are stored as they are. Packing is off by
+//	default until it has been shown to save more time than it costs on real movies.
+//
+//////////
+
+//////////
+//
+// header files
+//
+//////////
+
+#include "QTCmprBudget.h"
+#include "QTCmprFrameCache.h"
+#include "QTCmprRANS.h"
+
+
+//////////
+//
+// global variables
+//
+//////////
+
+static FrameCacheEntryPtr		gFrameBuckets[kFrameCacheBucketCount];		// the hash buckets
+static FrameCacheEntryPtr		gMostRecentFrame = NULL;					// head of the list of entries in order of use
+static FrameCacheEntryPtr		gLeastRecentFrame = NULL;					// tail of that list
+static long						gFrameCacheSize = 0L;						// number of bytes of pixel data in the cache
+static long						gFrameCacheLimit = kFrameCacheDefaultLimit;	// maximum value of gFrameCacheSize
+static MemoryJob				gFrameCacheJob;								// the cache's reservations against the memory budget
+static Boolean					gFrameCacheJobBegun = false;
+
+
+//////////
+//
+// QTCmpr_GetCachedFrame
+// If the frame of the specified movie at the specified time is in the cache, copy it into the specified
+// pixel map and return true; otherwise, return false.
+//
+//////////
+
+Boolean QTCmpr_GetCachedFrame (Movie theMovie, TimeValue theTime, PixMapHandle thePixMap)
+{
+	FrameCacheEntryPtr		myEntry = NULL;
+	Rect					myRect;
+	Rect					myBox;
+
+	if ((theMovie == NULL) || (thePixMap == NULL))
+		return(false);
+
+	GetPixBounds(thePixMap, &myRect);
+	GetMovieBox(theMovie, &myBox);
+	myEntry = QTCmpr_FindFrameEntry(theMovie, theTime, &myBox, myRect.right - myRect.left, myRect.bottom - myRect.top, GetPixDepth(thePixMap));
+	if (myEntry == NULL)
+		return(false);
+
+	if (myEntry->fIsPacked) {
+		if (!QTCmpr_UnpackFrame(myEntry, thePixMap))
+			return(false);
+	} else {
+		QTCmpr_CopyPixMapRows(thePixMap, myEntry->fPixels, myEntry->fRowBytes, true);
+	}
+
+	// move the entry to the front of the list of entries in order of use
+	if (myEntry != gMostRecentFrame) {
+		myEntry->fPrevUsed->fNextUsed = myEntry->fNextUsed;
+		if (myEntry->fNextUsed != NULL)
+			myEntry->fNextUsed->fPrevUsed = myEntry->fPrevUsed;
+		else
+			gLeastRecentFrame = myEntry->fPrevUsed;
+
+		myEntry->fPrevUsed = NULL;
+		myEntry->fNextUsed = gMostRecentFrame;
+		gMostRecentFrame->fPrevUsed = myEntry;
+		gMostRecentFrame = myEntry;
+	}
+
+	return(true);
+}
+
+
+//////////
+//
+// QTCmpr_CacheFrame
+// Add a copy of the pixels in the specified pixel map to the cache, as the frame of the specified movie
+// at the specified time. Return true if the frame was added to the cache.
+//
+// If theCanEvictSameMovie is false, we don't evict any other frames of the same movie to make room.
+//
+//////////
+
+Boolean QTCmpr_CacheFrame (Movie theMovie, TimeValue theTime, PixMapHandle thePixMap, Boolean theCanEvictSameMovie)
+{
+	FrameCacheEntryPtr		myEntry = NULL;
+	unsigned long			myBucket;
+	Rect					myRect;
+	Rect					myBox;
+	short					myWidth;
+	short					myHeight;
+	short					myDepth;
+	long					myRowBytes;
+	long					mySize;
+	Ptr						myPacked = NULL;
+	long					myPackedSize = 0L;
+	long					myReserved = 0L;
+	Boolean					isCached = false;
+
+	if ((theMovie == NULL) || (thePixMap == NULL))
+		return(false);
+
+	GetPixBounds(thePixMap, &myRect);
+	myWidth = myRect.right - myRect.left;
+	myHeight = myRect.bottom - myRect.top;
+	myDepth = GetPixDepth(thePixMap);
+	GetMovieBox(theMovie, &myBox);
+
+	// if we already have this frame, there's nothing to do
+	if (QTCmpr_FindFrameEntry(theMovie, theTime, &myBox, myWidth, myHeight, myDepth) != NULL)
+		return(true);
+
+	// we store only the bytes that hold pixels, not any padding at the end of each row
+	myRowBytes = ((long)myWidth * myDepth + 7) / 8;
+	mySize = (long)myHeight * myRowBytes;
+	if (mySize > gFrameCacheLimit)
+		return(false);
+
+	// cached frames are optional, so we don't wait for memory; if the budget is exhausted, we just don't cache the frame
+	if (!gFrameCacheJobBegun) {
+		QTCmpr_BeginMemoryJob(&gFrameCacheJob, "QTCmpr_FrameCache", NULL, 0L);
+		QTCmpr_AddMemoryReclaimer(QTCmpr_ReclaimFrameCache);
+		gFrameCacheJobBegun = true;
+	}
+
+#if USE_PACKED_FRAMES
+	// packing takes time on every frame we render, so we pack only when the frame wouldn't fit as it is
+	if ((gFrameCacheSize + mySize > gFrameCacheLimit) || (QTCmpr_GetMemoryInUse() + mySize > QTCmpr_GetMemoryBudget())) {
+		myPacked = QTCmpr_PackFrame(thePixMap, myRowBytes, &myPackedSize, &myReserved);
+		if ((myPacked != NULL) && (myPackedSize <= (mySize / 100) * kFrameCachePackPercent))
+			mySize = myPackedSize;
+		else if (myPacked != NULL) {
+			DisposePtr(myPacked);
+			QTCmpr_ReleaseMemory(&gFrameCacheJob, myReserved);
+			myPacked = NULL;
+		}
+	}
+#endif
+
+	if (!QTCmpr_MakeRoomInFrameCache(mySize, theMovie, theCanEvictSameMovie))
+		goto bail;
+
+	myEntry = (FrameCacheEntryPtr)NewPtrClear(sizeof(FrameCacheEntry));
+	if (myEntry == NULL)
+		goto bail;
+
+	if (myPacked != NULL) {
+		// the packed frame becomes the entry's pixels; shrinking a block never fails
+		SetPtrSize(myPacked, myPackedSize);
+		QTCmpr_ReleaseMemory(&gFrameCacheJob, myReserved - myPackedSize);
+		myEntry->fPixels = myPacked;
+		myEntry->fIsPacked = true;
+		myPacked = NULL;
+	} else {
+		if (!QTCmpr_TryReserveMemory(&gFrameCacheJob, mySize))
+			goto bail;
+
+		myEntry->fPixels = NewPtr(mySize);
+		if (myEntry->fPixels == NULL) {
+			QTCmpr_ReleaseMemory(&gFrameCacheJob, mySize);
+			goto bail;
+		}
+
+		QTCmpr_CopyPixMapRows(thePixMap, myEntry->fPixels, myRowBytes, false);
+	}
+
+	myEntry->fMovie = theMovie;
+	myEntry->fTime = theTime;
+	myEntry->fLeft = myBox.left;
+	myEntry->fTop = myBox.top;
+	myEntry->fWidth = myWidth;
+	myEntry->fHeight = myHeight;
+	myEntry->fDepth = myDepth;
+	myEntry->fRowBytes = myRowBytes;
+	myEntry->fSize = mySize;
+
+	// add the entry to its hash bucket
+	myBucket = QTCmpr_HashFrameKey(theMovie, theTime);
+	myEntry->fNextInBucket = gFrameBuckets[myBucket];
+	gFrameBuckets[myBucket] = myEntry;
+
+	// add the entry to the front of the list of entries in order of use
+	myEntry->fPrevUsed = NULL;
+	myEntry->fNextUsed = gMostRecentFrame;
+	if (gMostRecentFrame != NULL)
+		gMostRecentFrame->fPrevUsed = myEntry;
+	gMostRecentFrame = myEntry;
+	if (gLeastRecentFrame == NULL)
+		gLeastRecentFrame = myEntry;
+
+	gFrameCacheSize += myEntry->fSize;
+	isCached = true;
+
+bail:
+	if (!isCached && (myEntry != NULL))
+		DisposePtr((Ptr)myEntry);
+
+	if (myPacked != NULL) {
+		DisposePtr(myPacked);
+		QTCmpr_ReleaseMemory(&gFrameCacheJob, myReserved);
+	}
+
+	return(isCached);
+}
+
+
+//////////
+//
+// QTCmpr_RenderMovieFrame
+// Draw the frame of the specified movie at the specified time into the specified graphics world, using
+// the cached copy of that frame if there is one.
+//
+// The movie must already be set to draw into theGWorld (by a call to SetMovieGWorld).
+//
+//////////
+
+void QTCmpr_RenderMovieFrame (Movie theMovie, TimeValue theTime, GWorldPtr theGWorld)
+{
+	PixMapHandle			myPixMap = GetGWorldPixMap(theGWorld);
+
+	if (QTCmpr_GetCachedFrame(theMovie, theTime, myPixMap))
+		return;
+
+	SetMovieTimeValue(theMovie, theTime);
+	MoviesTask(theMovie, 0);
+	MoviesTask(theMovie, 0);
+	MoviesTask(theMovie, 0);
+
+	QTCmpr_CacheFrame(theMovie, theTime, myPixMap, false);
+}
+
+
+//////////
+//
+// QTCmpr_FlushFrameCache
+// Remove all frames of the specified movie from the cache; if theMovie is NULL, empty the cache entirely.
+//
+//////////
+
+void QTCmpr_FlushFrameCache (Movie theMovie)
+{
+	FrameCacheEntryPtr		myEntry = gMostRecentFrame;
+	FrameCacheEntryPtr		myNextEntry = NULL;
+
+	while (myEntry != NULL) {
+		myNextEntry = myEntry->fNextUsed;
+		if ((theMovie == NULL) || (myEntry->fMovie == theMovie))
+			QTCmpr_RemoveFrameEntry(myEntry);
+		myEntry = myNextEntry;
+	}
+}
+
+
+//////////
+//
+// QTCmpr_SetFrameCacheLimit
+// Set the maximum number of bytes of pixel data in the cache, evicting frames if necessary.
+//
+//////////
+
+void QTCmpr_SetFrameCacheLimit (long theLimit)
+{
+	if (theLimit < 0L)
+		theLimit = 0L;
+
+	gFrameCacheLimit = theLimit;
+
+	while ((gFrameCacheSize > gFrameCacheLimit) && (gLeastRecentFrame != NULL))
+		QTCmpr_RemoveFrameEntry(gLeastRecentFrame);
+}
+
+
+//////////
+//
+// QTCmpr_GetFrameCacheSize
+// Return the number of bytes of pixel data currently in the cache.
+//
+//////////
+
+long QTCmpr_GetFrameCacheSize (void)
+{
+	return(gFrameCacheSize);
+}
+
+
+//////////
+//
+// QTCmpr_FindFrameEntry
+// Return the cache entry with the specified key, or NULL if there is none.
+//
+//////////
+
+static FrameCacheEntryPtr QTCmpr_FindFrameEntry (Movie theMovie, TimeValue theTime, Rect *theBox, short theWidth, short theHeight, short theDepth)
+{
+	FrameCacheEntryPtr		myEntry = gFrameBuckets[QTCmpr_HashFrameKey(theMovie, theTime)];
+
+	while (myEntry != NULL) {
+		if ((myEntry->fMovie == theMovie) && (myEntry->fTime == theTime) && (myEntry->fLeft == theBox->left) && (myEntry->fTop == theBox->top) &&
+			(myEntry->fWidth == theWidth) && (myEntry->fHeight == theHeight) && (myEntry->fDepth == theDepth))
+			return(myEntry);
+
+		myEntry = myEntry->fNextInBucket;
+	}
+
+	return(NULL);
+}
+
+
+//////////
+//
+// QTCmpr_HashFrameKey
+// Return the hash bucket for the specified movie and time.
+//
+//////////
+
+static unsigned long QTCmpr_HashFrameKey (Movie theMovie, TimeValue theTime)
+{
+	unsigned long			myHash = (unsigned long)theMovie ^ ((unsigned long)theTime * 2654435761UL);
+
+	myHash ^= myHash >> 16;
+	myHash ^= myHash >> 8;
+
+	return(myHash & (kFrameCacheBucketCount - 1));
+}
+
+
+//////////
+//
+// QTCmpr_RemoveFrameEntry
+// Remove the specified entry from the cache and dispose of it.
+//
+//////////
+
+static void QTCmpr_RemoveFrameEntry (FrameCacheEntryPtr theEntry)
+{
+	FrameCacheEntryPtr		*myLink = &gFrameBuckets[QTCmpr_HashFrameKey(theEntry->fMovie, theEntry->fTime)];
+
+	// unlink the entry from its hash bucket
+	while (*myLink != NULL) {
+		if (*myLink == theEntry) {
+			*myLink = theEntry->fNextInBucket;
+			break;
+		}
+		myLink = &(*myLink)->fNextInBucket;
+	}
+
+	// unlink the entry from the list of entries in order of use
+	if (theEntry->fPrevUsed != NULL)
+		theEntry->fPrevUsed->fNextUsed = theEntry->fNextUsed;
+	else
+		gMostRecentFrame = theEntry->fNextUsed;
+
+	if (theEntry->fNextUsed != NULL)
+		theEntry->fNextUsed->fPrevUsed = theEntry->fPrevUsed;
+	else
+		gLeastRecentFrame = theEntry->fPrevUsed;
+
+	gFrameCacheSize -= theEntry->fSize;
+	QTCmpr_ReleaseMemory(&gFrameCacheJob, theEntry->fSize);
+
+	DisposePtr(theEntry->fPixels);
+	DisposePtr((Ptr)theEntry);
+}
+
+
+//////////
+//
+// QTCmpr_MakeRoomInFrameCache
+// Evict frames, least recently used first, until there is room for theSize more bytes of pixel data.
+// Return true if we were able to make enough room.
+//
+// If theCanEvictSameMovie is false, frames of the specified movie are never evicted.
+//
+//////////
+
+static Boolean QTCmpr_MakeRoomInFrameCache (long theSize, Movie theMovie, Boolean theCanEvictSameMovie)
+{
+	FrameCacheEntryPtr		myEntry = gLeastRecentFrame;
+	FrameCacheEntryPtr		myPrevEntry = NULL;
+
+	while ((gFrameCacheSize + theSize > gFrameCacheLimit) && (myEntry != NULL)) {
+		myPrevEntry = myEntry->fPrevUsed;
+		if (theCanEvictSameMovie || (myEntry->fMovie != theMovie))
+			QTCmpr_RemoveFrameEntry(myEntry);
+		myEntry = myPrevEntry;
+	}
+
+	return(gFrameCacheSize + theSize <= gFrameCacheLimit);
+}
+
+
+//////////
+//
+// QTCmpr_ReclaimFrameCache
+// Evict frames, least recently used first, until we've released at least theBytesNeeded bytes of pixel data
+// (or the cache is empty); return the number of bytes released.
+//
+// This is called by the memory budget when some compression job needs memory.
+//
+//////////
+
+static long QTCmpr_ReclaimFrameCache (long theBytesNeeded)
+{
+	long					myOrigSize = gFrameCacheSize;
+
+	while ((myOrigSize - gFrameCacheSize < theBytesNeeded) && (gLeastRecentFrame != NULL))
+		QTCmpr_RemoveFrameEntry(gLeastRecentFrame);
+
+	return(myOrigSize - gFrameCacheSize);
+}
+
+
+//////////
+//
+// QTCmpr_CopyPixMapRows
+// Copy pixel data between the specified pixel map and a block of memory with the specified row bytes;
+// if toPixMap is true, copy into the pixel map, otherwise copy out of it.
+//
+// The pixel map must be locked.
+//
+//////////
+
+static void QTCmpr_CopyPixMapRows (PixMapHandle thePixMap, Ptr thePixels, long theRowBytes, Boolean toPixMap)
+{
+	Ptr						myBaseAddr = GetPixBaseAddr(thePixMap);
+	long					myPixMapRowBytes = QTGetPixMapHandleRowBytes(thePixMap);
+	Rect					myRect;
+	short					myRow;
+
+	GetPixBounds(thePixMap, &myRect);
+
+	for (myRow = 0; myRow < myRect.bottom - myRect.top; myRow++) {
+		if (toPixMap)
+			BlockMoveData(thePixels + (myRow * theRowBytes), myBaseAddr + (myRow * myPixMapRowBytes), theRowBytes);
+		else
+			BlockMoveData(myBaseAddr + (myRow * myPixMapRowBytes), thePixels + (myRow * theRowBytes), theRowBytes);
+	}
+}
+
+
+//////////
+//
+// QTCmpr_PackFrame
+// Pack the pixels in the specified pixel map, stored with the specified row bytes, and return a pointer to
+// the packed pixels (or NULL if we couldn't get the memory to pack them); the size of the packed pixels is
+// returned in thePackedSize, and the number of bytes reserved for the block in theReserved.
+//
+// Each byte is replaced by its difference from the byte one pixel to its left (the first pixel of each row is
+// left as it is), and the differences are entropy coded.
+//
+//////////
+
+static Ptr QTCmpr_PackFrame (PixMapHandle thePixMap, long theRowBytes, long *thePackedSize, long *theReserved)
+{
+	Ptr						myBaseAddr = GetPixBaseAddr(thePixMap);
+	long					myPixMapRowBytes = QTGetPixMapHandleRowBytes(thePixMap);
+	long					myBytesPerPixel = GetPixDepth(thePixMap) / 8;
+	Rect					myRect;
+	long					myHeight;
+	long					mySize;
+	long					myBound;
+	UInt8					*myResidual = NULL;
+	Ptr						myPacked = NULL;
+	UInt8					*mySrc;
+	UInt8					*myDst;
+	long					myRow;
+	long					myIndex;
+	Boolean					isPacked = false;
+
+	GetPixBounds(thePixMap, &myRect);
+	myHeight = myRect.bottom - myRect.top;
+	mySize = myHeight * theRowBytes;
+	myBound = QTCmpr_GetRANSBound(mySize);
+
+	// pixels smaller than a byte are predicted from the byte to the left
+	if (myBytesPerPixel < 1)
+		myBytesPerPixel = 1;
+
+	if (!QTCmpr_TryReserveMemory(&gFrameCacheJob, mySize + myBound))
+		return(NULL);
+
+	myResidual = (UInt8 *)NewPtr(mySize);
+	myPacked = NewPtr(myBound);
+	if ((myResidual == NULL) || (myPacked == NULL))
+		goto bail;
+
+	for (myRow = 0; myRow < myHeight; myRow++) {
+		mySrc = (UInt8 *)myBaseAddr + (myRow * myPixMapRowBytes);
+		myDst = myResidual + (myRow * theRowBytes);
+
+		for (myIndex = 0; (myIndex < myBytesPerPixel) && (myIndex < theRowBytes); myIndex++)
+			myDst[myIndex] = mySrc[myIndex];
+
+		for (; myIndex < theRowBytes; myIndex++)
+			myDst[myIndex] = (UInt8)(mySrc[myIndex] - mySrc[myIndex - myBytesPerPixel]);
+	}
+
+	if (QTCmpr_RANSEncode(myResidual, mySize, kRANSMethodStatic, (UInt8 *)myPacked, myBound, thePackedSize) != noErr)
+		goto bail;
+
+	*theReserved = myBound;
+	isPacked = true;
+
+bail:
+	if (myResidual != NULL)
+		DisposePtr((Ptr)myResidual);
+	QTCmpr_ReleaseMemory(&gFrameCacheJob, mySize);
+
+	if (!isPacked) {
+		if (myPacked != NULL)
+			DisposePtr(myPacked);
+		QTCmpr_ReleaseMemory(&gFrameCacheJob, myBound);
+		myPacked = NULL;
+	}
+
+	return(myPacked);
+}
+
+
+//////////
+//
+// QTCmpr_UnpackFrame
+// Unpack the pixels of the specified cache entry into the specified pixel map; return true if we could.
+//
+// The pixel map must be locked.
+//
+//////////
+
+static Boolean QTCmpr_UnpackFrame (FrameCacheEntryPtr theEntry, PixMapHandle thePixMap)
+{
+	Ptr						myBaseAddr = GetPixBaseAddr(thePixMap);
+	long					myPixMapRowBytes = QTGetPixMapHandleRowBytes(thePixMap);
+	long					myBytesPerPixel = theEntry->fDepth / 8;
+	long					mySize = (long)theEntry->fHeight * theEntry->fRowBytes;
+	UInt8					*myResidual = NULL;
+	UInt8					*mySrc;
+	UInt8					*myDst;
+	long					myRow;
+	long					myIndex;
+	Boolean					isUnpacked = false;
+
+	if (myBytesPerPixel < 1)
+		myBytesPerPixel = 1;
+
+	// the unpacked frame is only ever needed for a moment, so again we don't wait for memory
+	if (!QTCmpr_TryReserveMemory(&gFrameCacheJob, mySize))
+		return(false);
+
+	myResidual = (UInt8 *)NewPtr(mySize);
+	if (myResidual == NULL)
+		goto bail;
+
+	if (QTCmpr_RANSDecode((UInt8 *)theEntry->fPixels, theEntry->fSize, myResidual, mySize) != noErr)
+		goto bail;
+
+	// undo the prediction as we copy each row into the pixel map
+	for (myRow = 0; myRow < theEntry->fHeight; myRow++) {
+		mySrc = myResidual + (myRow * theEntry->fRowBytes);
+		myDst = (UInt8 *)myBaseAddr + (myRow * myPixMapRowBytes);
+
+		for (myIndex = 0; (myIndex < myBytesPerPixel) && (myIndex < theEntry->fRowBytes); myIndex++)
+			myDst[myIndex] = mySrc[myIndex];
+
+		for (; myIndex < theEntry->fRowBytes; myIndex++)
+			myDst[myIndex] = (UInt8)(mySrc[myIndex] + myDst[myIndex - myBytesPerPixel]);
+	}
+
+	isUnpacked = true;
+
+bail:
+	if (myResidual != NULL)
+		DisposePtr((Ptr)myResidual);
+	QTCmpr_ReleaseMemory(&gFrameCacheJob, mySize);
+
+	return(isUnpacked);
+}
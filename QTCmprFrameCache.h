@@ -0,0 +1,103 @@
+//////////
+//
+//	File:		QTCmprFrameCache.h
+//
+//	Contains:	A memory-bounded cache of rendered movie frames, for use by QTCompress.
+//
+//	Written by:	Tim Monroe
+//
+//	Copyright:	 2000 by Apple Computer, Inc., all rights reserved.
+//
+//	Change History (most recent first):
+//
+//	   <5>	 	11/13/26	rtm		USE_PACKED_FRAMES is off until packing is shown to pay for itself
+//	   <4>	 	11/06/26	rtm		added USE_PACKED_FRAMES
+//	   <3>	 	11/03/26	rtm		added the movie box origin to the key
+//	   <2>	 	10/22/26	rtm		added QTCmpr_ReclaimFrameCache
+//	   <1>	 	10/21/26	rtm		first file
+//
+//////////
+
+#pragma once
+
+
+//////////
+//
+// header files
+//
+//////////
+
+#ifndef __QTCmprFrameCache__
+#define __QTCmprFrameCache__
+
+#ifndef __MOVIES__
+#include <Movies.h>
+#endif
+
+#ifndef __QDOFFSCREEN__
+#include <QDOffscreen.h>
+#endif
+
+
+//////////
+//
+// constants
+//
+//////////
+
+#define kFrameCacheDefaultLimit			(32L * 1024L * 1024L)	// default maximum number of bytes of pixel data in the cache
+#define kFrameCacheBucketCount			256						// number of hash buckets; must be a power of two
+#define kFrameCachePosterTime			-1L						// the time value we use as the key for a movie's poster frame
+#define kFrameCachePackPercent			75						// we keep a packed frame only if it's at most this percentage of its size
+
+#define USE_PACKED_FRAMES				0						// do we entropy code the frames in the cache, when they don't all fit?
+
+
+//////////
+//
+// data types
+//
+//////////
+
+// a single cached frame; each entry is on two lists: the list of entries in its hash bucket, and the
+// list of all entries in order of use (most recently used first)
+typedef struct FrameCacheEntry {
+	struct FrameCacheEntry		*fNextInBucket;
+	struct FrameCacheEntry		*fPrevUsed;
+	struct FrameCacheEntry		*fNextUsed;
+	Movie						fMovie;						// the key: movie, time, movie box origin, size, and depth
+	TimeValue					fTime;
+	short						fLeft;						// the origin of the movie box, which is moved to render only part of a frame
+	short						fTop;
+	short						fWidth;
+	short						fHeight;
+	short						fDepth;
+	long						fRowBytes;					// the number of bytes in each row of fPixels
+	long						fSize;						// the total number of bytes in fPixels
+	Ptr							fPixels;
+	Boolean						fIsPacked;					// are the pixels packed (see QTCmpr_PackFrame)?
+} FrameCacheEntry, *FrameCacheEntryPtr;
+
+
+//////////
+//
+// function prototypes
+//
+//////////
+
+Boolean							QTCmpr_GetCachedFrame (Movie theMovie, TimeValue theTime, PixMapHandle thePixMap);
+Boolean							QTCmpr_CacheFrame (Movie theMovie, TimeValue theTime, PixMapHandle thePixMap, Boolean theCanEvictSameMovie);
+void							QTCmpr_RenderMovieFrame (Movie theMovie, TimeValue theTime, GWorldPtr theGWorld);
+void							QTCmpr_FlushFrameCache (Movie theMovie);
+void							QTCmpr_SetFrameCacheLimit (long theLimit);
+long							QTCmpr_GetFrameCacheSize (void);
+static FrameCacheEntryPtr		QTCmpr_FindFrameEntry (Movie theMovie, TimeValue theTime, Rect *theBox, short theWidth, short theHeight, short theDepth);
+static unsigned long			QTCmpr_HashFrameKey (Movie theMovie, TimeValue theTime);
+static void						QTCmpr_RemoveFrameEntry (FrameCacheEntryPtr theEntry);
+static Boolean					QTCmpr_MakeRoomInFrameCache (long theSize, Movie theMovie, Boolean theCanEvictSameMovie);
+static long						QTCmpr_ReclaimFrameCache (long theBytesNeeded);
+static void						QTCmpr_CopyPixMapRows (PixMapHandle thePixMap, Ptr thePixels, long theRowBytes, Boolean toPixMap);
+static Ptr						QTCmpr_PackFrame (PixMapHandle thePixMap, long theRowBytes, long *thePackedSize, long *theReserved);
+static Boolean					QTCmpr_UnpackFrame (FrameCacheEntryPtr theEntry, PixMapHandle thePixMap);
+
+#endif	// __QTCmprFrameCache__
@@ -0,0 +1,328 @@
+//////////
+//
+//	File:		QTCmprGolden.c
+//
+//	Contains:	Digests of compressed output, checked against a file of known-good digests, for use by QTCompress.
+//
+//	Written by:	Tim Monroe
+//
+//	Copyright:	 2000 by Apple Computer, Inc., all rights reserved.
+//
+//	Change History (most recent first):
+//
+//	   <4>	 	11/13/26	rtm		a digest with no golden one is a failure only once digests of its kind have been recorded
+//	   <3>	 	11/13/26	rtm		the label holds every setting that affects the output; a digest that differs from the golden
+//									one, or has none, is a failure, and labels are added only in record mode; added source digests
+//	   <2>	 	11/13/26	rtm		the SHA-256 routines are now in QTCmprHash.c
+//	   <1>	 	11/11/26	rtm		first file
+//
+//	Much of what QTCompress does to a frame before the compressor sees it (converting it, resizing it, comparing it
+//	with the last one, looking for cuts) has been made faster over time, and each change could quietly alter the
+//	output. In deterministic mode (see QTCmpr_GetDeterministicMode), the same source compressed with the same
+//	settings gives the same samples, whatever the machine, the number of processors, or how long each frame takes;
+//	so we can check that a change hasn't altered them by comparing a digest of them with one recorded earlier.
+//
+//	In deterministic mode, QTCmpr_CompressImage, QTCmpr_CompressSequence, and QTCmpr_CompressIngest work out the
+//	SHA-256 digest of the samples they produce: for each sample, its size, duration, and sync flag, its image
+//	description, and its data, in order. We digest the samples rather than the movie file, since the Movie Toolbox
+//	puts the time in every movie file it makes. When they're done, they log the digest, with a label giving the
+//	kind of output, the source, and every setting that affects the output: the compressor, depth, qualities, key
+//	frame rate, and frame rate; the part of the source compressed; the size it's compressed at; and the filter it's
+//	resized with. QTCmpr_CompressIngest also digests the raw frames of its source, so that a change in the frames
+//	can be told from a change in how they're compressed.
+//
+//	If a golden file is named in the environment (see QTCmpr_GetGoldenFile), we also look up the label there: each
+//	line holds a digest in hexadecimal, some spaces, and a label, just as sha256sum writes them, and lines that
+//	begin with "#" are ignored. A digest that differs from the golden one is a failure. So is one whose label isn't
+//	there, if the file holds digests of the same kind (the part of the label before the first colon); until some
+//	are recorded, a missing label is just logged, so that a golden file with only the digests that hold everywhere
+//	still passes. In record mode (see QTCmpr_GetGoldenRecordMode), a missing label is added with this digest. The
+//	failures are counted (see QTCmpr_GetGoldenFailures), and QTCompress exits with a nonzero status if
+//	there were any. Compressing the synthetic ingest sources (see QTCmprIngest.c) with a fixed set of settings,
+//	and each test image and movie, against QTCompress.golden, which is kept with the sources, makes a regression
+//	suite.
+//
+//	Image descriptions are digested as they are in memory, so golden digests of compressed output hold for one
+//	platform; the digests of raw frames hold everywhere.
+//
+//////////
+
+//////////
+//
+// header files
+//
+//////////
+
+#include <ctype.h>
+
+#include "QTCompress.h"
+
+
+//////////
+//
+// global variables
+//
+//////////
+
+static long							gGoldenFailures = 0L;				// the digests that differed from their golden ones, or had none
+
+
+//////////
+//
+// QTCmpr_BeginGoldenDigest
+// Begin the digest of the samples of a compression, labelled with the kind of output, the name of the source,
+// the settings in theComponent, the part of the source that's compressed (theSrcRect), the size it's compressed
+// at (theDstRect), and the filter it's resized with (theFilter, or 0 if it isn't resized).
+//
+// The digest of raw frames, which aren't compressed, has no component and no rectangles; its label is just the
+// kind and the source, which should say how big the frames are and how fast they come.
+//
+//////////
+
+void QTCmpr_BeginGoldenDigest (GoldenDigestPtr theDigest, char *theKind, char *theSource, ComponentInstance theComponent, Rect *theSrcRect, Rect *theDstRect, long theFilter)
+{
+	SCSpatialSettings			mySpatial;
+	SCTemporalSettings			myTemporal;
+	char						*myLabel;
+
+	if (theDigest == NULL)
+		return;
+
+	QTCmpr_BeginHash(&theDigest->fHash);
+	theDigest->fNumSamples = 0L;
+
+	// the source name is cut short, if need be, to leave room for the rest
+	myLabel = theDigest->fLabel;
+	myLabel += sprintf(myLabel, "%s:%.*s", (theKind != NULL) ? theKind : "",
+							(int)(kGoldenMaxLabel - kGoldenMaxSettings), (theSource != NULL) ? theSource : "");
+
+	if (theComponent != NULL) {
+		memset(&mySpatial, 0, sizeof(mySpatial));
+		memset(&myTemporal, 0, sizeof(myTemporal));
+		SCGetInfo(theComponent, scSpatialSettingsType, &mySpatial);
+		SCGetInfo(theComponent, scTemporalSettingsType, &myTemporal);
+
+		// the frame rate is a Fixed, given exactly, in hexadecimal
+		myLabel += sprintf(myLabel, " %c%c%c%c/%d/%lu/%lu/%ld rate %08lx",
+							(char)(mySpatial.codecType >> 24), (char)(mySpatial.codecType >> 16), (char)(mySpatial.codecType >> 8), (char)mySpatial.codecType,
+							mySpatial.depth,
+							(unsigned long)mySpatial.spatialQuality,
+							(unsigned long)myTemporal.temporalQuality,
+							(long)myTemporal.keyFrameRate,
+							(unsigned long)myTemporal.frameRate);
+	}
+
+	if ((theSrcRect != NULL) && (theDstRect != NULL))
+		sprintf(myLabel, " src %d,%d,%dx%d dst %dx%d filter %s",
+							theSrcRect->left, theSrcRect->top, theSrcRect->right - theSrcRect->left, theSrcRect->bottom - theSrcRect->top,
+							theDstRect->right - theDstRect->left, theDstRect->bottom - theDstRect->top,
+							QTCmpr_GetGoldenFilterName(theFilter));
+}
+
+
+//////////
+//
+// QTCmpr_AddGoldenSample
+// Add a sample to the digest: a compressed sample, or a raw frame (which has no image description).
+//
+//////////
+
+void QTCmpr_AddGoldenSample (GoldenDigestPtr theDigest, Ptr theData, long theSize, TimeValue theDuration, ImageDescriptionHandle theDesc, short theSyncFlag)
+{
+	long						myDescSize = (theDesc != NULL) ? (**theDesc).idSize : 0L;
+
+	if (theDigest == NULL)
+		return;
+
+	QTCmpr_AddGoldenLong(theDigest, theSize);
+	QTCmpr_AddGoldenLong(theDigest, theDuration);
+	QTCmpr_AddGoldenLong(theDigest, theSyncFlag);
+	QTCmpr_AddGoldenLong(theDigest, myDescSize);
+
+	if (myDescSize > 0L)
+		QTCmpr_AddToHash(&theDigest->fHash, *theDesc, myDescSize);
+
+	if ((theData != NULL) && (theSize > 0L))
+		QTCmpr_AddToHash(&theDigest->fHash, theData, theSize);
+
+	theDigest->fNumSamples++;
+}
+
+
+//////////
+//
+// QTCmpr_EndGoldenDigest
+// Finish the digest and log it; if there's a golden file, check the digest against it, or (in record mode) add
+// it there. Count a digest that differs from its golden one as a failure, and also one that has none, if the golden
+// file has digests of the same kind.
+//
+//////////
+
+void QTCmpr_EndGoldenDigest (GoldenDigestPtr theDigest)
+{
+	UInt8						myDigest[kHashDigestSize];
+	char						myHex[(2 * kHashDigestSize) + 1];
+	char						myGolden[(2 * kHashDigestSize) + 1];
+	char						*myPath = QTCmpr_GetGoldenFile();
+	FILE						*myFile = NULL;
+	Boolean						myKindIsFound = false;
+	long						myIndex;
+
+	if (theDigest == NULL)
+		return;
+
+	QTCmpr_EndHash(&theDigest->fHash, myDigest);
+
+	for (myIndex = 0; myIndex < kHashDigestSize; myIndex++)
+		sprintf(myHex + (2 * myIndex), "%02x", myDigest[myIndex]);
+
+	QTCmpr_LogMessage("QTCmpr_EndGoldenDigest: %s  %s (%ld samples)", myHex, theDigest->fLabel, theDigest->fNumSamples);
+
+	if (myPath == NULL)
+		return;
+
+	if (QTCmpr_FindGoldenDigest(myPath, theDigest->fLabel, myGolden, &myKindIsFound)) {
+		if (strcmp(myGolden, myHex) == 0) {
+			QTCmpr_LogMessage("QTCmpr_EndGoldenDigest: matches the golden digest");
+		} else {
+			QTCmpr_LogMessage("QTCmpr_EndGoldenDigest: DIFFERS from the golden digest %s", myGolden);
+			gGoldenFailures++;
+		}
+		return;
+	}
+
+	// a digest with nothing to check it against doesn't pass, once digests of its kind have been recorded,
+	// unless we're recording digests for the runs that follow
+	if (!QTCmpr_GetGoldenRecordMode()) {
+		if (myKindIsFound) {
+			QTCmpr_LogMessage("QTCmpr_EndGoldenDigest: NO golden digest in %s", myPath);
+			gGoldenFailures++;
+		} else {
+			QTCmpr_LogMessage("QTCmpr_EndGoldenDigest: no golden digests of this kind in %s yet; not checked", myPath);
+		}
+		return;
+	}
+
+	myFile = fopen(myPath, "a");
+	if (myFile == NULL) {
+		QTCmpr_LogMessage("QTCmpr_EndGoldenDigest: can't add to the golden file %s", myPath);
+		gGoldenFailures++;
+		return;
+	}
+
+	fprintf(myFile, "%s  %s\n", myHex, theDigest->fLabel);
+	fclose(myFile);
+
+	QTCmpr_LogMessage("QTCmpr_EndGoldenDigest: added to the golden file %s", myPath);
+}
+
+
+//////////
+//
+// QTCmpr_GetGoldenFailures
+// Return the number of digests so far that differed from their golden digests, or had none.
+//
+//////////
+
+long QTCmpr_GetGoldenFailures (void)
+{
+	return(gGoldenFailures);
+}
+
+
+//////////
+//
+// QTCmpr_AddGoldenLong
+// Add a long integer to the digest, in big-endian byte order.
+//
+//////////
+
+static void QTCmpr_AddGoldenLong (GoldenDigestPtr theDigest, long theValue)
+{
+	UInt8						myBytes[4];
+
+	myBytes[0] = (UInt8)(theValue >> 24);
+	myBytes[1] = (UInt8)(theValue >> 16);
+	myBytes[2] = (UInt8)(theValue >> 8);
+	myBytes[3] = (UInt8)theValue;
+
+	QTCmpr_AddToHash(&theDigest->fHash, myBytes, sizeof(myBytes));
+}
+
+
+//////////
+//
+// QTCmpr_FindGoldenDigest
+// Look up the specified label in the golden file; if it's there, return true and copy its digest (in lowercase
+// hexadecimal) into theHex, which must have room for 2 * kHashDigestSize + 1 characters.
+//
+// On return, theKindIsFound says whether the file has any label of the same kind (that is, with the same text up
+// to and including the first colon).
+//
+//////////
+
+static Boolean QTCmpr_FindGoldenDigest (char *thePath, char *theLabel, char *theHex, Boolean *theKindIsFound)
+{
+	char						myLine[kGoldenMaxLine];
+	FILE						*myFile = NULL;
+	char						*myColon = strchr(theLabel, ':');
+	long						myKindLength = (myColon != NULL) ? (long)(myColon - theLabel) + 1 : (long)strlen(theLabel);
+	Boolean						myIsFound = false;
+
+	*theKindIsFound = false;
+
+	myFile = fopen(thePath, "r");
+	if (myFile == NULL)
+		return(false);
+
+	while (!myIsFound && (fgets(myLine, kGoldenMaxLine, myFile) != NULL)) {
+		char					*myLabel = myLine + (2 * kHashDigestSize);
+		long					myLength;
+		long					myIndex;
+
+		if ((myLine[0] == '#') || ((long)strlen(myLine) <= 2 * kHashDigestSize) || ((*myLabel != ' ') && (*myLabel != '\t')))
+			continue;
+
+		// the label runs from the first character after the spaces to the end of the line
+		while ((*myLabel == ' ') || (*myLabel == '\t'))
+			myLabel++;
+
+		myLength = strlen(myLabel);
+		while ((myLength > 0L) && ((myLabel[myLength - 1] == '\n') || (myLabel[myLength - 1] == '\r')))
+			myLabel[--myLength] = '\0';
+
+		if (strncmp(myLabel, theLabel, myKindLength) == 0)
+			*theKindIsFound = true;
+
+		if (strcmp(myLabel, theLabel) != 0)
+			continue;
+
+		for (myIndex = 0; myIndex < 2 * kHashDigestSize; myIndex++)
+			theHex[myIndex] = (char)tolower(myLine[myIndex]);
+		theHex[2 * kHashDigestSize] = '\0';
+
+		myIsFound = true;
+	}
+
+	fclose(myFile);
+
+	return(myIsFound);
+}
+
+
+//////////
+//
+// QTCmpr_GetGoldenFilterName
+// Return the name of the specified resize filter, as it's given in the environment (see QTCmpr_GetOutputSize).
+//
+//////////
+
+static char *QTCmpr_GetGoldenFilterName (long theFilter)
+{
+	switch (theFilter) {
+		case kResizeFilterLanczos:		return("lanczos");
+		case kResizeFilterBicubic:		return("bicubic");
+		case kResizeFilterArea:			return("area");
+		default:						return("none");
+	}
+}
@@ -0,0 +1,87 @@
+//////////
+//
+//	File:		QTCmprGolden.h
+//
+//	Contains:	Digests of compressed output, checked against a file of known-good digests, for use by QTCompress.
+//
+//	Written by:	Tim Monroe
+//
+//	Copyright:	 2000 by Apple Computer, Inc., all rights reserved.
+//
+//	Change History (most recent first):
+//
+//	   <4>	 	11/13/26	rtm		QTCmpr_FindGoldenDigest also says whether there are digests of the label's kind
+//	   <3>	 	11/13/26	rtm		added kGoldenKindSource and QTCmpr_GetGoldenFailures; the label holds the crop, the output
+//									size, the resize filter, and the frame rate
+//	   <2>	 	11/13/26	rtm		the SHA-256 routines are now in QTCmprHash.c
+//	   <1>	 	11/11/26	rtm		first file
+//
+//////////
+
+#pragma once
+
+
+//////////
+//
+// header files
+//
+//////////
+
+#ifndef __QTCmprGolden__
+#define __QTCmprGolden__
+
+#ifndef __MOVIES__
+#include <Movies.h>
+#endif
+
+#ifndef __QUICKTIMECOMPONENTS__
+#include <QuickTimeComponents.h>
+#endif
+
+#include "QTCmprHash.h"											// for the SHA-256 digest
+
+
+//////////
+//
+// constants
+//
+//////////
+
+#define kGoldenMaxLabel					256						// the longest label of a digest
+#define kGoldenMaxLine					(kGoldenMaxLabel + (2 * kHashDigestSize) + 8)
+#define kGoldenKindImage				"image"					// the kinds of output we digest: a compressed image,
+#define kGoldenKindMovie				"movie"					// the frames of a movie,
+#define kGoldenKindIngest				"ingest"				// the frames read from an ingest source,
+#define kGoldenKindSource				"source"				// or the raw frames of an ingest source, before they're compressed
+#define kGoldenMaxSettings				160						// the most of a label that the settings can take
+
+
+//////////
+//
+// data types
+//
+//////////
+
+// the digest of the samples of one compression, and the label it goes by in the golden file
+typedef struct GoldenDigest {
+	HashState					fHash;
+	char						fLabel[kGoldenMaxLabel];			// the kind of output, the source, and every setting that affects the output
+	long						fNumSamples;
+} GoldenDigest, *GoldenDigestPtr;
+
+
+//////////
+//
+// function prototypes
+//
+//////////
+
+void							QTCmpr_BeginGoldenDigest (GoldenDigestPtr theDigest, char *theKind, char *theSource, ComponentInstance theComponent, Rect *theSrcRect, Rect *theDstRect, long theFilter);
+void							QTCmpr_AddGoldenSample (GoldenDigestPtr theDigest, Ptr theData, long theSize, TimeValue theDuration, ImageDescriptionHandle theDesc, short theSyncFlag);
+void							QTCmpr_EndGoldenDigest (GoldenDigestPtr theDigest);
+long							QTCmpr_GetGoldenFailures (void);
+static void						QTCmpr_AddGoldenLong (GoldenDigestPtr theDigest, long theValue);
+static Boolean					QTCmpr_FindGoldenDigest (char *thePath, char *theLabel, char *theHex, Boolean *theKindIsFound);
+static char						*QTCmpr_GetGoldenFilterName (long theFilter);
+
+#endif	// __QTCmprGolden__
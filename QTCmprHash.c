@@ -0,0 +1,209 @@
+//////////
+//
+//	File:		QTCmprHash.c
+//
+//	Contains:	SHA-256 digests, for use by QTCompress.
+//
+//	Written by:	Tim Monroe
+//
+//	Copyright:	 2000 by Apple Computer, Inc., all rights reserved.
+//
+//	Change History (most recent first):
+//
+//	   <1>	 	11/13/26	rtm		first file; moved the SHA-256 routines here from QTCmprOutputCache.c
+//
+//	Several parts of QTCompress need a digest that identifies a block of bytes by its content: the output cache
+//	(see QTCmprOutputCache.c) names its entries by a digest of the sources and settings, the sample writer (see
+//	QTCmprWriter.c) digests each sample so that the sample store (see QTCmprSampleStore.c) can find it, and
+//	deterministic mode (see QTCmprGolden.c) digests the samples of each compression. They all use SHA-256, as
+//	described in FIPS 180-2; to digest some bytes, call QTCmpr_BeginHash, then QTCmpr_AddToHash as often as
+//	needed, then QTCmpr_EndHash.
+//
+//////////
+
+//////////
+//
+// header files
+//
+//////////
+
+#include "QTCompress.h"
+
+
+//////////
+//
+// global variables
+//
+//////////
+
+// the SHA-256 round constants
+static UInt32						gHashConstants[64] = {
+	0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+	0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+	0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+	0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+	0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+	0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+	0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+	0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+};
+
+#define QTCmpr_RotateRight(x, n)	(((x) >> (n)) | ((x) << (32 - (n))))
+
+
+//////////
+//
+// QTCmpr_BeginHash
+// Begin a SHA-256 digest.
+//
+//////////
+
+void QTCmpr_BeginHash (HashStatePtr theHash)
+{
+	theHash->fState[0] = 0x6a09e667;
+	theHash->fState[1] = 0xbb67ae85;
+	theHash->fState[2] = 0x3c6ef372;
+	theHash->fState[3] = 0xa54ff53a;
+	theHash->fState[4] = 0x510e527f;
+	theHash->fState[5] = 0x9b05688c;
+	theHash->fState[6] = 0x1f83d9ab;
+	theHash->fState[7] = 0x5be0cd19;
+	theHash->fBlockSize = 0L;
+	theHash->fBitsHigh = 0L;
+	theHash->fBitsLow = 0L;
+}
+
+
+//////////
+//
+// QTCmpr_AddToHash
+// Add the specified bytes to a digest.
+//
+//////////
+
+void QTCmpr_AddToHash (HashStatePtr theHash, void *theData, long theSize)
+{
+	UInt8						*myBytes = (UInt8 *)theData;
+	UInt32						myBits = (UInt32)theSize << 3;
+	long						myCount;
+
+	theHash->fBitsLow += myBits;
+	if (theHash->fBitsLow < myBits)
+		theHash->fBitsHigh++;
+	theHash->fBitsHigh += (UInt32)theSize >> 29;
+
+	while (theSize > 0L) {
+		// whole blocks needn't be copied
+		if ((theHash->fBlockSize == 0L) && (theSize >= 64L)) {
+			QTCmpr_HashBlock(theHash, myBytes);
+			myBytes += 64;
+			theSize -= 64L;
+			continue;
+		}
+
+		myCount = 64L - theHash->fBlockSize;
+		if (myCount > theSize)
+			myCount = theSize;
+
+		BlockMoveData(myBytes, &theHash->fBlock[theHash->fBlockSize], myCount);
+		theHash->fBlockSize += myCount;
+		myBytes += myCount;
+		theSize -= myCount;
+
+		if (theHash->fBlockSize == 64L) {
+			QTCmpr_HashBlock(theHash, theHash->fBlock);
+			theHash->fBlockSize = 0L;
+		}
+	}
+}
+
+
+//////////
+//
+// QTCmpr_EndHash
+// Finish a digest, and return it.
+//
+//////////
+
+void QTCmpr_EndHash (HashStatePtr theHash, UInt8 *theDigest)
+{
+	UInt8						myLength[8];
+	UInt8						myPad = 0x80;
+	long						myIndex;
+
+	// the message is padded with a 1 bit and then 0 bits, and ends with its length in bits
+	for (myIndex = 0L; myIndex < 4L; myIndex++) {
+		myLength[myIndex] = (UInt8)(theHash->fBitsHigh >> (24 - (8 * myIndex)));
+		myLength[myIndex + 4] = (UInt8)(theHash->fBitsLow >> (24 - (8 * myIndex)));
+	}
+
+	QTCmpr_AddToHash(theHash, &myPad, 1L);
+
+	myPad = 0x00;
+	while (theHash->fBlockSize != 56L)
+		QTCmpr_AddToHash(theHash, &myPad, 1L);
+
+	QTCmpr_AddToHash(theHash, myLength, 8L);
+
+	for (myIndex = 0L; myIndex < kHashDigestSize; myIndex++)
+		theDigest[myIndex] = (UInt8)(theHash->fState[myIndex / 4] >> (24 - (8 * (myIndex % 4))));
+}
+
+
+//////////
+//
+// QTCmpr_HashBlock
+// Add a 64-byte block to a digest.
+//
+//////////
+
+static void QTCmpr_HashBlock (HashStatePtr theHash, UInt8 *theBlock)
+{
+	UInt32						myWords[64];
+	UInt32						a, b, c, d, e, f, g, h;
+	UInt32						mySum1, mySum2;
+	long						myIndex;
+
+	for (myIndex = 0L; myIndex < 16L; myIndex++)
+		myWords[myIndex] = ((UInt32)theBlock[4 * myIndex] << 24) | ((UInt32)theBlock[(4 * myIndex) + 1] << 16) |
+							((UInt32)theBlock[(4 * myIndex) + 2] << 8) | (UInt32)theBlock[(4 * myIndex) + 3];
+
+	for (myIndex = 16L; myIndex < 64L; myIndex++) {
+		mySum1 = QTCmpr_RotateRight(myWords[myIndex - 2], 17) ^ QTCmpr_RotateRight(myWords[myIndex - 2], 19) ^ (myWords[myIndex - 2] >> 10);
+		mySum2 = QTCmpr_RotateRight(myWords[myIndex - 15], 7) ^ QTCmpr_RotateRight(myWords[myIndex - 15], 18) ^ (myWords[myIndex - 15] >> 3);
+		myWords[myIndex] = mySum1 + myWords[myIndex - 7] + mySum2 + myWords[myIndex - 16];
+	}
+
+	a = theHash->fState[0];
+	b = theHash->fState[1];
+	c = theHash->fState[2];
+	d = theHash->fState[3];
+	e = theHash->fState[4];
+	f = theHash->fState[5];
+	g = theHash->fState[6];
+	h = theHash->fState[7];
+
+	for (myIndex = 0L; myIndex < 64L; myIndex++) {
+		mySum1 = h + (QTCmpr_RotateRight(e, 6) ^ QTCmpr_RotateRight(e, 11) ^ QTCmpr_RotateRight(e, 25)) + ((e & f) ^ (~e & g)) +
+					gHashConstants[myIndex] + myWords[myIndex];
+		mySum2 = (QTCmpr_RotateRight(a, 2) ^ QTCmpr_RotateRight(a, 13) ^ QTCmpr_RotateRight(a, 22)) + ((a & b) ^ (a & c) ^ (b & c));
+
+		h = g;
+		g = f;
+		f = e;
+		e = d + mySum1;
+		d = c;
+		c = b;
+		b = a;
+		a = mySum1 + mySum2;
+	}
+
+	theHash->fState[0] += a;
+	theHash->fState[1] += b;
+	theHash->fState[2] += c;
+	theHash->fState[3] += d;
+	theHash->fState[4] += e;
+	theHash->fState[5] += f;
+	theHash->fState[6] += g;
+	theHash->fState[7] += h;
+}
@@ -0,0 +1,70 @@
+//////////
+//
+//	File:		QTCmprHash.h
+//
+//	Contains:	SHA-256 digests, for use by QTCompress.
+//
+//	Written by:	Tim Monroe
+//
+//	Copyright:	 2000 by Apple Computer, Inc., all rights reserved.
+//
+//	Change History (most recent first):
+//
+//	   <1>	 	11/13/26	rtm		first file
+//
+//////////
+
+#pragma once
+
+
+//////////
+//
+// header files
+//
+//////////
+
+#ifndef __QTCmprHash__
+#define __QTCmprHash__
+
+#ifndef __MACTYPES__
+#include <MacTypes.h>
+#endif
+
+
+//////////
+//
+// constants
+//
+//////////
+
+#define kHashDigestSize					32						// the size of a SHA-256 digest
+
+
+//////////
+//
+// data types
+//
+//////////
+
+// the state of a SHA-256 digest
+typedef struct HashState {
+	UInt32						fState[8];
+	UInt8						fBlock[64];							// the bytes not yet digested
+	long						fBlockSize;
+	UInt32						fBitsHigh;							// the number of bits added so far
+	UInt32						fBitsLow;
+} HashState, *HashStatePtr;
+
+
+//////////
+//
+// function prototypes
+//
+//////////
+
+void							QTCmpr_BeginHash (HashStatePtr theHash);
+void							QTCmpr_AddToHash (HashStatePtr theHash, void *theData, long theSize);
+void							QTCmpr_EndHash (HashStatePtr theHash, UInt8 *theDigest);
+static void						QTCmpr_HashBlock (HashStatePtr theHash, UInt8 *theBlock);
+
+#endif	// __QTCmprHash__
@@ -0,0 +1,1094 @@
+//////////
+//
+//	File:		QTCmprIngest.c
+//
+//	Contains:	A source of raw frames (YUV4MPEG2 or packed RGB) read from a pipe or a file, for use by QTCompress.
+//
+//	Written by:	Tim Monroe
+//
+//	Copyright:	 2000 by Apple Computer, Inc., all rights reserved.
+//
+//	Change History (most recent first):
+//
+//	   <5>	 	11/13/26	rtm		frames bigger than kIngestMaxFrameSize are rejected before their size is worked out
+//	   <4>	 	11/13/26	rtm		QTCmpr_ReadIngestFrame adds each raw frame to the source's golden digest, if it has one
+//	   <3>	 	11/11/26	rtm		added synthetic sources, which make their own frames, for testing
+//	   <2>	 	11/01/26	rtm		video-range 4:2:0 and 4:2:2 frames are converted by the row routines in QTCmprColor.c
+//	   <1>	 	10/27/26	rtm		first file
+//
+//	Capture tools and other programs often produce uncompressed frames on a pipe rather than in a movie file.
+//	An ingest source reads such frames, from standard input or from a named file or pipe, and draws each one
+//	into a 32-bit pixel map, which we can then hand to the standard compression component just like a frame
+//	rendered from a movie.
+//
+//	We understand two formats:
+//
+//	-	YUV4MPEG2, which begins with a one-line stream header giving the frame size, frame rate, and chroma
+//		subsampling, and then holds a one-line frame header and the planar Y'CbCr data of each frame. We
+//		handle 4:2:0, 4:2:2, 4:4:4, and monochrome streams with 8-bit samples, in video range (unless the
+//		stream header says XCOLORRANGE=FULL).
+//
+//	-	Raw packed 24-bit RGB, which has no headers at all; the caller must supply the frame size and frame
+//		rate, as a string of the form "<width>x<height>:<rate>" or "<width>x<height>:<num>/<den>".
+//
+//	There's also a third kind of source, which reads nothing: an input named "synthetic:<pattern>" or
+//	"synthetic:<pattern>:<frames>" makes its own frames, in one of a few patterns ("bars", "ramp", or "cuts"),
+//	at the size and rate given as for raw RGB (or kIngestSyntheticFormat). Each frame depends only on its
+//	number, so a synthetic source gives the same frames every time, on every machine; that's what we want
+//	for checking that the compressed output hasn't changed (see QTCmprGolden.c).
+//
+//	At high frame sizes and rates, just reading the frame data is a good part of the work, so (on Windows and
+//	on Mac OS X) we read the frames on a separate thread, into a pair of frame buffers: while one frame is
+//	being converted and compressed, the next one is being read. The reading thread uses the native file
+//	calls, not the C library, since the C library we link with isn't thread-safe. The conversion from Y'CbCr
+//	to RGB uses tables built when the source is opened, so that each pixel costs a few lookups and adds.
+//
+//////////
+
+//////////
+//
+// header files
+//
+//////////
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "QTCmprIngest.h"
+#include "QTCmprColor.h"
+
+#if TARGET_RT_MAC_MACHO
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+
+//////////
+//
+// QTCmpr_OpenIngestSource
+// Open the specified file (or standard input, if thePath is kIngestStdInName) as a source of raw frames.
+//
+// If theRawFormat is NULL, the input must be a YUV4MPEG2 stream; otherwise, the input holds packed 24-bit
+// RGB frames of the size and rate given by theRawFormat. If thePath begins with kIngestSyntheticPrefix, we
+// make the frames instead (see QTCmpr_ParseSyntheticSource). The frame buffers are reserved against the memory
+// budget for the specified job. Call QTCmpr_CloseIngestSource even if this function fails.
+//
+//////////
+
+OSErr QTCmpr_OpenIngestSource (IngestSourcePtr theSource, char *thePath, char *theRawFormat, MemoryJobPtr theJob)
+{
+	short						myIndex;
+	OSErr						myErr = noErr;
+
+	if (theSource == NULL)
+		return(paramErr);
+
+	theSource->fFormat = 0L;
+	theSource->fWidth = 0;
+	theSource->fHeight = 0;
+	theSource->fRateNum = 0L;
+	theSource->fRateDen = 1L;
+	theSource->fChroma = kIngestChroma420;
+	theSource->fFullRange = false;
+	theSource->fFrameSize = 0L;
+	theSource->fNumFrames = 0L;
+	theSource->fEndResult = noErr;
+	theSource->fPattern = 0L;
+	theSource->fFrameLimit = 0L;
+	theSource->fNumMade = 0L;
+	theSource->fGolden = NULL;
+#if TARGET_OS_WIN32
+	theSource->fFile = INVALID_HANDLE_VALUE;
+#elif TARGET_RT_MAC_MACHO
+	theSource->fFile = -1;
+#else
+	theSource->fFile = NULL;
+#endif
+	theSource->fIsStdIn = false;
+	theSource->fReadAhead = NULL;
+	theSource->fReadAheadPos = 0L;
+	theSource->fReadAheadEnd = 0L;
+	for (myIndex = 0; myIndex < kIngestNumBuffers; myIndex++) {
+		theSource->fBuffers[myIndex].fData = NULL;
+		theSource->fBuffers[myIndex].fResult = noErr;
+	}
+	theSource->fNextRead = 0L;
+	theSource->fNextFill = 0L;
+#if USE_INGEST_THREAD
+	theSource->fStopReading = false;
+#if TARGET_OS_WIN32
+	theSource->fThread = NULL;
+	theSource->fEmptySemaphore = NULL;
+	theSource->fFullSemaphore = NULL;
+#else
+	theSource->fThreadIsRunning = false;
+	theSource->fNumFull = 0L;
+#endif
+#endif
+	theSource->fJob = theJob;
+
+	if (thePath == NULL)
+		return(paramErr);
+
+	// a synthetic source has no input to open
+	if (strncmp(thePath, kIngestSyntheticPrefix, strlen(kIngestSyntheticPrefix)) == 0)
+		myErr = QTCmpr_ParseSyntheticSource(theSource, thePath, theRawFormat);
+	else
+		myErr = QTCmpr_OpenIngestInput(theSource, thePath, theRawFormat);
+	if (myErr != noErr)
+		return(myErr);
+
+	QTCmpr_BuildIngestTables(theSource);
+
+	// allocate the frame buffers
+	for (myIndex = 0; myIndex < kIngestNumBuffers; myIndex++) {
+		QTCmpr_ReserveMemory(theSource->fJob, theSource->fFrameSize);
+
+		theSource->fBuffers[myIndex].fData = NewPtr(theSource->fFrameSize);
+		if (theSource->fBuffers[myIndex].fData == NULL) {
+			QTCmpr_ReleaseMemory(theSource->fJob, theSource->fFrameSize);
+			return(memFullErr);
+		}
+	}
+
+	return(QTCmpr_StartIngestThread(theSource));
+}
+
+
+//////////
+//
+// QTCmpr_OpenIngestInput
+// Open the specified file (or standard input), and find out the size, rate, and layout of its frames.
+//
+//////////
+
+static OSErr QTCmpr_OpenIngestInput (IngestSourcePtr theSource, char *thePath, char *theRawFormat)
+{
+	// open the input
+	theSource->fIsStdIn = (strcmp(thePath, kIngestStdInName) == 0);
+#if TARGET_OS_WIN32
+	if (theSource->fIsStdIn)
+		theSource->fFile = GetStdHandle(STD_INPUT_HANDLE);
+	else
+		theSource->fFile = CreateFile(thePath, GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, NULL, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+	if ((theSource->fFile == INVALID_HANDLE_VALUE) || (theSource->fFile == NULL))
+		return(fnfErr);
+#elif TARGET_RT_MAC_MACHO
+	theSource->fFile = theSource->fIsStdIn ? STDIN_FILENO : open(thePath, O_RDONLY);
+	if (theSource->fFile < 0)
+		return(fnfErr);
+#else
+	theSource->fFile = theSource->fIsStdIn ? stdin : fopen(thePath, "rb");
+	if (theSource->fFile == NULL)
+		return(fnfErr);
+#endif
+
+	theSource->fReadAhead = NewPtr(kIngestReadAheadSize);
+	if (theSource->fReadAhead == NULL)
+		return(memFullErr);
+
+	// find out the size, rate, and layout of the frames
+	if (theRawFormat != NULL)
+		return(QTCmpr_ParseRawFormat(theSource, theRawFormat));
+	else
+		return(QTCmpr_ParseY4MHeader(theSource));
+}
+
+
+//////////
+//
+// QTCmpr_ReadIngestFrame
+// Draw the next frame from the specified source into the specified 32-bit pixel map, whose bounds must
+// match the frame size; return eofErr if there are no more frames.
+//
+// The pixel map must be locked. If the source has a golden digest (fGolden), the frame is added to it as it was
+// read, before it's converted, with a duration of fRateDen.
+//
+//////////
+
+OSErr QTCmpr_ReadIngestFrame (IngestSourcePtr theSource, PixMapHandle thePixMap)
+{
+	IngestBufferPtr				myBuffer = NULL;
+	OSErr						myErr = noErr;
+
+	if ((theSource == NULL) || (thePixMap == NULL) || (theSource->fBuffers[0].fData == NULL))
+		return(paramErr);
+
+	// once the input has ended, it stays ended
+	if (theSource->fEndResult != noErr)
+		return(theSource->fEndResult);
+
+	myBuffer = QTCmpr_WaitForFullBuffer(theSource);
+	myErr = myBuffer->fResult;
+
+	if (myErr == noErr) {
+		if (theSource->fGolden != NULL)
+			QTCmpr_AddGoldenSample(theSource->fGolden, myBuffer->fData, theSource->fFrameSize, theSource->fRateDen, NULL, 0);
+
+		if (theSource->fFormat == kIngestFormatY4M)
+			QTCmpr_ConvertYCbCrFrame(theSource, (UInt8 *)myBuffer->fData, thePixMap);
+		else
+			QTCmpr_ConvertRGBFrame(theSource, (UInt8 *)myBuffer->fData, thePixMap);
+
+		theSource->fNumFrames++;
+	} else {
+		theSource->fEndResult = myErr;
+	}
+
+	QTCmpr_ReturnEmptyBuffer(theSource);
+
+	return(myErr);
+}
+
+
+//////////
+//
+// QTCmpr_CloseIngestSource
+// Stop reading from the specified source, close its input, and dispose of its buffers.
+//
+//////////
+
+void QTCmpr_CloseIngestSource (IngestSourcePtr theSource)
+{
+	short						myIndex;
+
+	if (theSource == NULL)
+		return;
+
+	QTCmpr_StopIngestThread(theSource);
+
+#if TARGET_OS_WIN32
+	if ((theSource->fFile != INVALID_HANDLE_VALUE) && (theSource->fFile != NULL) && !theSource->fIsStdIn)
+		CloseHandle(theSource->fFile);
+	theSource->fFile = INVALID_HANDLE_VALUE;
+#elif TARGET_RT_MAC_MACHO
+	if ((theSource->fFile >= 0) && !theSource->fIsStdIn)
+		close(theSource->fFile);
+	theSource->fFile = -1;
+#else
+	if ((theSource->fFile != NULL) && !theSource->fIsStdIn)
+		fclose(theSource->fFile);
+	theSource->fFile = NULL;
+#endif
+
+	if (theSource->fReadAhead != NULL)
+		DisposePtr(theSource->fReadAhead);
+	theSource->fReadAhead = NULL;
+
+	for (myIndex = 0; myIndex < kIngestNumBuffers; myIndex++) {
+		if (theSource->fBuffers[myIndex].fData != NULL) {
+			DisposePtr(theSource->fBuffers[myIndex].fData);
+			QTCmpr_ReleaseMemory(theSource->fJob, theSource->fFrameSize);
+		}
+		theSource->fBuffers[myIndex].fData = NULL;
+	}
+}
+
+
+//////////
+//
+// QTCmpr_ParseRawFormat
+// Get the frame size and rate of a raw RGB source from a string of the form "<width>x<height>:<rate>"
+// or "<width>x<height>:<num>/<den>".
+//
+//////////
+
+static OSErr QTCmpr_ParseRawFormat (IngestSourcePtr theSource, char *theRawFormat)
+{
+	long						myWidth = 0L;
+	long						myHeight = 0L;
+	long						myRateNum = 0L;
+	long						myRateDen = 1L;
+
+	if (sscanf(theRawFormat, "%ldx%ld:%ld/%ld", &myWidth, &myHeight, &myRateNum, &myRateDen) < 3)
+		return(paramErr);
+
+	if ((myWidth <= 0L) || (myWidth > 0x7FFF) || (myHeight <= 0L) || (myHeight > 0x7FFF) || (myRateNum <= 0L) || (myRateDen <= 0L))
+		return(paramErr);
+
+	// the size of a frame at the largest width and height doesn't fit in a long
+	if (3.0 * myWidth * myHeight > (double)kIngestMaxFrameSize)
+		return(paramErr);
+
+	theSource->fFormat = kIngestFormatRGB;
+	theSource->fWidth = (short)myWidth;
+	theSource->fHeight = (short)myHeight;
+	theSource->fRateNum = myRateNum;
+	theSource->fRateDen = myRateDen;
+	theSource->fFullRange = true;
+	theSource->fFrameSize = 3 * myWidth * myHeight;
+
+	return(noErr);
+}
+
+
+//////////
+//
+// QTCmpr_ParseSyntheticSource
+// Get the pattern and number of frames of a synthetic source from its name, which is kIngestSyntheticPrefix
+// followed by "<pattern>" or "<pattern>:<frames>", and its frame size and rate from theRawFormat (or, if that's
+// NULL, from kIngestSyntheticFormat).
+//
+//////////
+
+static OSErr QTCmpr_ParseSyntheticSource (IngestSourcePtr theSource, char *thePath, char *theRawFormat)
+{
+	char						*myName = thePath + strlen(kIngestSyntheticPrefix);
+	char						*myEnd = strchr(myName, ':');
+	long						myLength = (myEnd != NULL) ? (myEnd - myName) : (long)strlen(myName);
+	long						myNumFrames = kIngestSyntheticFrames;
+	OSErr						myErr = noErr;
+
+	if ((myLength == 4) && (strncmp(myName, "bars", 4) == 0))
+		theSource->fPattern = kIngestPatternBars;
+	else if ((myLength == 4) && (strncmp(myName, "ramp", 4) == 0))
+		theSource->fPattern = kIngestPatternRamp;
+	else if ((myLength == 4) && (strncmp(myName, "cuts", 4) == 0))
+		theSource->fPattern = kIngestPatternCuts;
+	else
+		return(paramErr);
+
+	if (myEnd != NULL)
+		if ((sscanf(myEnd + 1, "%ld", &myNumFrames) != 1) || (myNumFrames <= 0L))
+			return(paramErr);
+
+	myErr = QTCmpr_ParseRawFormat(theSource, (theRawFormat != NULL) ? theRawFormat : kIngestSyntheticFormat);
+	if (myErr != noErr)
+		return(myErr);
+
+	theSource->fFormat = kIngestFormatSynthetic;
+	theSource->fFrameLimit = myNumFrames;
+
+	return(noErr);
+}
+
+
+//////////
+//
+// QTCmpr_ParseY4MHeader
+// Read and parse the stream header of a YUV4MPEG2 source.
+//
+// The header is the signature followed by space-separated parameters, each a letter and a value: W (width),
+// H (height), F (frame rate, as num:den), C (chroma subsampling), I (interlacing), A (pixel aspect ratio),
+// and X (anything else). We need W, H, and F; we ignore I and A.
+//
+//////////
+
+static OSErr QTCmpr_ParseY4MHeader (IngestSourcePtr theSource)
+{
+	char						myLine[kIngestMaxLineLength];
+	char						*myToken;
+	long						myWidth = 0L;
+	long						myHeight = 0L;
+	long						myChromaWidth, myChromaHeight;
+	OSErr						myErr = noErr;
+
+	myErr = QTCmpr_ReadIngestLine(theSource, myLine, kIngestMaxLineLength);
+	if (myErr == eofErr)
+		myErr = badFileFormat;
+	if (myErr != noErr)
+		return(myErr);
+
+	if (strncmp(myLine, kIngestY4MSignature, strlen(kIngestY4MSignature)) != 0)
+		return(badFileFormat);
+
+	for (myToken = strtok(myLine + strlen(kIngestY4MSignature), " "); myToken != NULL; myToken = strtok(NULL, " ")) {
+		switch (myToken[0]) {
+			case 'W':
+				myWidth = atol(myToken + 1);
+				break;
+
+			case 'H':
+				myHeight = atol(myToken + 1);
+				break;
+
+			case 'F':
+				if (sscanf(myToken + 1, "%ld:%ld", &theSource->fRateNum, &theSource->fRateDen) != 2)
+					return(badFileFormat);
+				break;
+
+			case 'C':
+				// we handle only 8-bit samples with no alpha plane; all the 4:2:0 variants differ only in chroma siting
+				if (strncmp(myToken + 1, "420", 3) == 0) {
+					if ((myToken[4] != '\0') && (strcmp(myToken + 4, "jpeg") != 0) && (strcmp(myToken + 4, "mpeg2") != 0) && (strcmp(myToken + 4, "paldv") != 0))
+						return(badFileFormat);
+					theSource->fChroma = kIngestChroma420;
+				} else if (strcmp(myToken + 1, "422") == 0) {
+					theSource->fChroma = kIngestChroma422;
+				} else if (strcmp(myToken + 1, "444") == 0) {
+					theSource->fChroma = kIngestChroma444;
+				} else if (strcmp(myToken + 1, "mono") == 0) {
+					theSource->fChroma = kIngestChromaMono;
+				} else {
+					return(badFileFormat);
+				}
+				break;
+
+			case 'X':
+				if (strcmp(myToken + 1, "COLORRANGE=FULL") == 0)
+					theSource->fFullRange = true;
+				break;
+
+			default:
+				break;
+		}
+	}
+
+	if ((myWidth <= 0L) || (myWidth > 0x7FFF) || (myHeight <= 0L) || (myHeight > 0x7FFF) || (theSource->fRateNum <= 0L) || (theSource->fRateDen <= 0L))
+		return(badFileFormat);
+
+	theSource->fFormat = kIngestFormatY4M;
+	theSource->fWidth = (short)myWidth;
+	theSource->fHeight = (short)myHeight;
+
+	switch (theSource->fChroma) {
+		case kIngestChroma420:
+			myChromaWidth = (myWidth + 1) / 2;
+			myChromaHeight = (myHeight + 1) / 2;
+			break;
+		case kIngestChroma422:
+			myChromaWidth = (myWidth + 1) / 2;
+			myChromaHeight = myHeight;
+			break;
+		case kIngestChroma444:
+			myChromaWidth = myWidth;
+			myChromaHeight = myHeight;
+			break;
+		default:
+			myChromaWidth = 0L;
+			myChromaHeight = 0L;
+			break;
+	}
+
+	// the size of a frame at the largest width and height doesn't fit in a long
+	if (((double)myWidth * myHeight) + (2.0 * myChromaWidth * myChromaHeight) > (double)kIngestMaxFrameSize)
+		return(badFileFormat);
+
+	theSource->fFrameSize = (myWidth * myHeight) + (2 * myChromaWidth * myChromaHeight);
+
+	return(noErr);
+}
+
+
+//////////
+//
+// QTCmpr_BuildIngestTables
+// Build the tables we use to convert Y'CbCr to RGB (using the ITU-R BT.601 coefficients).
+//
+// Each table entry is the contribution of one sample value to one RGB component, in fixed point; the luma
+// table also includes the rounding term.
+//
+//////////
+
+static void QTCmpr_BuildIngestTables (IngestSourcePtr theSource)
+{
+	double						myYScale, myCScale;
+	double						myOne = (double)(1L << kIngestFixedShift);
+	long						myY, myC;
+	short						myIndex;
+
+	if (theSource->fFullRange) {
+		myYScale = 1.0;
+		myCScale = 1.0;
+	} else {
+		myYScale = 255.0 / 219.0;
+		myCScale = 255.0 / 224.0;
+	}
+
+	for (myIndex = 0; myIndex < 256; myIndex++) {
+		myY = theSource->fFullRange ? myIndex : myIndex - 16;
+		myC = myIndex - 128;
+
+		theSource->fYTable[myIndex] = (long)(myY * myYScale * myOne) + (1L << (kIngestFixedShift - 1));
+		theSource->fCrToRTable[myIndex] = (long)(myC * myCScale * 1.402 * myOne);
+		theSource->fCrToGTable[myIndex] = (long)(myC * myCScale * -0.714136 * myOne);
+		theSource->fCbToGTable[myIndex] = (long)(myC * myCScale * -0.344136 * myOne);
+		theSource->fCbToBTable[myIndex] = (long)(myC * myCScale * 1.772 * myOne);
+	}
+
+	// the clamp table maps any sum of table entries (shifted down) to a component value
+	for (myIndex = 0; myIndex < kIngestClampTableSize; myIndex++) {
+		if (myIndex < kIngestClampOffset)
+			theSource->fClampTable[myIndex] = 0;
+		else if (myIndex > kIngestClampOffset + 255)
+			theSource->fClampTable[myIndex] = 255;
+		else
+			theSource->fClampTable[myIndex] = (UInt8)(myIndex - kIngestClampOffset);
+	}
+}
+
+
+//////////
+//
+// QTCmpr_FillIngestBuffer
+// Read the next frame from the input into the specified buffer; return (and record in the buffer) noErr,
+// eofErr if there are no more frames, or an error.
+//
+// A frame that is cut short is treated as the end of the input.
+//
+//////////
+
+static OSErr QTCmpr_FillIngestBuffer (IngestSourcePtr theSource, IngestBufferPtr theBuffer)
+{
+	char						myLine[kIngestMaxLineLength];
+	OSErr						myErr = noErr;
+
+	if (theSource->fFormat == kIngestFormatSynthetic) {
+		theBuffer->fResult = QTCmpr_MakeSyntheticFrame(theSource, (UInt8 *)theBuffer->fData);
+		return(theBuffer->fResult);
+	}
+
+	if (theSource->fFormat == kIngestFormatY4M) {
+		myErr = QTCmpr_ReadIngestLine(theSource, myLine, kIngestMaxLineLength);
+		if ((myErr == noErr) && (strncmp(myLine, kIngestY4MFrameSignature, strlen(kIngestY4MFrameSignature)) != 0))
+			myErr = badFileFormat;
+	}
+
+	if (myErr == noErr)
+		myErr = QTCmpr_ReadIngestBytes(theSource, theBuffer->fData, theSource->fFrameSize);
+
+	theBuffer->fResult = myErr;
+
+	return(myErr);
+}
+
+
+//////////
+//
+// QTCmpr_ReadIngestLine
+// Read a line of text (not including the linefeed that ends it) from the input.
+//
+//////////
+
+static OSErr QTCmpr_ReadIngestLine (IngestSourcePtr theSource, char *theLine, long theMaxLength)
+{
+	long						myLength = 0L;
+	char						myChar;
+
+	for (;;) {
+		if (theSource->fReadAheadPos == theSource->fReadAheadEnd) {
+			theSource->fReadAheadPos = 0L;
+			theSource->fReadAheadEnd = QTCmpr_ReadIngestFile(theSource, theSource->fReadAhead, kIngestReadAheadSize);
+			if (theSource->fReadAheadEnd == 0L)
+				return(eofErr);
+		}
+
+		myChar = theSource->fReadAhead[theSource->fReadAheadPos++];
+		if (myChar == '\n')
+			break;
+
+		if (myLength == theMaxLength - 1)
+			return(badFileFormat);
+
+		theLine[myLength++] = myChar;
+	}
+
+	theLine[myLength] = '\0';
+
+	return(noErr);
+}
+
+
+//////////
+//
+// QTCmpr_ReadIngestBytes
+// Read exactly theSize bytes from the input; return eofErr if there aren't that many.
+//
+// Any bytes left over from reading a header are used first; the rest are read straight into theData,
+// so that frame data is never copied through the read-ahead buffer.
+//
+//////////
+
+static OSErr QTCmpr_ReadIngestBytes (IngestSourcePtr theSource, Ptr theData, long theSize)
+{
+	long						myCount;
+
+	myCount = theSource->fReadAheadEnd - theSource->fReadAheadPos;
+	if (myCount > theSize)
+		myCount = theSize;
+
+	if (myCount > 0L) {
+		BlockMoveData(theSource->fReadAhead + theSource->fReadAheadPos, theData, myCount);
+		theSource->fReadAheadPos += myCount;
+		theData += myCount;
+		theSize -= myCount;
+	}
+
+	while (theSize > 0L) {
+		myCount = QTCmpr_ReadIngestFile(theSource, theData, theSize);
+		if (myCount == 0L)
+			return(eofErr);
+
+		theData += myCount;
+		theSize -= myCount;
+	}
+
+	return(noErr);
+}
+
+
+//////////
+//
+// QTCmpr_ReadIngestFile
+// Read up to theSize bytes from the input; return the number of bytes read, or 0 at the end of the input
+// (or if an error occurs).
+//
+//////////
+
+static long QTCmpr_ReadIngestFile (IngestSourcePtr theSource, Ptr theData, long theSize)
+{
+#if TARGET_OS_WIN32
+	DWORD						myCount = 0;
+
+	// when the writer closes a pipe, ReadFile fails with ERROR_BROKEN_PIPE; that's the end of the input
+	if (!ReadFile(theSource->fFile, theData, (DWORD)theSize, &myCount, NULL))
+		return(0L);
+
+	return((long)myCount);
+#elif TARGET_RT_MAC_MACHO
+	ssize_t						myCount;
+
+	do {
+		myCount = read(theSource->fFile, theData, (size_t)theSize);
+	} while ((myCount < 0) && (errno == EINTR));
+
+	return((myCount > 0) ? (long)myCount : 0L);
+#else
+	return((long)fread(theData, 1, (size_t)theSize, theSource->fFile));
+#endif
+}
+
+
+//////////
+//
+// QTCmpr_MakeSyntheticFrame
+// Make the next frame of a synthetic source, as packed 24-bit RGB; return eofErr if there are no more frames.
+//
+// Every pixel is worked out from its position and the frame number with integer arithmetic, so the frames
+// are the same on every machine. Like the rest of the reading thread, this must not call the C library.
+//
+//////////
+
+static OSErr QTCmpr_MakeSyntheticFrame (IngestSourcePtr theSource, UInt8 *theFrame)
+{
+	// 75% color bars: white, yellow, cyan, green, magenta, red, blue, and black
+	static const UInt8			kBarColors[8][3] = {
+		{191, 191, 191}, {191, 191, 0}, {0, 191, 191}, {0, 191, 0}, {191, 0, 191}, {191, 0, 0}, {0, 0, 191}, {0, 0, 0}
+	};
+	long						myFrame = theSource->fNumMade;
+	long						myScene = myFrame / kIngestSyntheticSceneFrames;
+	long						myShift = myFrame % kIngestSyntheticSceneFrames;
+	long						myCellShift = 3 + (myScene % 3);		// the cells of a checkerboard are 8, 16, or 32 pixels square
+	const UInt8					*myLight = kBarColors[myScene % 7];
+	const UInt8					*myDark = kBarColors[(myScene + 3) % 7];
+	UInt8						*myPixel = theFrame;
+	long						myRow, myCol;
+
+	if (myFrame >= theSource->fFrameLimit)
+		return(eofErr);
+
+	for (myRow = 0; myRow < theSource->fHeight; myRow++) {
+		for (myCol = 0; myCol < theSource->fWidth; myCol++, myPixel += 3) {
+			switch (theSource->fPattern) {
+				case kIngestPatternBars: {
+					const UInt8	*myColor = kBarColors[(myCol * 8) / theSource->fWidth];
+
+					myPixel[0] = myColor[0];
+					myPixel[1] = myColor[1];
+					myPixel[2] = myColor[2];
+					break;
+				}
+
+				case kIngestPatternRamp:
+					myPixel[0] = (UInt8)((myCol + (4 * myFrame)) & 0xFF);
+					myPixel[1] = (UInt8)((myRow + (2 * myFrame)) & 0xFF);
+					myPixel[2] = (UInt8)((((myCol + myRow) >> 1) + myFrame) & 0xFF);
+					break;
+
+				case kIngestPatternCuts:
+				default: {
+					const UInt8	*myColor = myDark;
+
+					// every fourth scene is black
+					if ((myScene % 4) == 3)
+						myColor = kBarColors[7];
+					else if (((((myCol + (2 * myShift)) >> myCellShift) + (myRow >> myCellShift)) & 1) != 0)
+						myColor = myLight;
+
+					myPixel[0] = myColor[0];
+					myPixel[1] = myColor[1];
+					myPixel[2] = myColor[2];
+					break;
+				}
+			}
+		}
+	}
+
+	theSource->fNumMade++;
+
+	return(noErr);
+}
+
+
+//////////
+//
+// QTCmpr_ConvertYCbCrFrame
+// Convert a frame of planar Y'CbCr data into the specified 32-bit pixel map.
+//
+// A monochrome frame has no chroma planes, so we read a single neutral chroma sample for every pixel. Video-range
+// 4:2:0 and 4:2:2 frames, the usual case, go through the (vectorized) row routines in QTCmprColor.c instead of
+// our tables.
+//
+//////////
+
+static void QTCmpr_ConvertYCbCrFrame (IngestSourcePtr theSource, UInt8 *theFrame, PixMapHandle thePixMap)
+{
+	UInt8						*myBaseAddr = (UInt8 *)GetPixBaseAddr(thePixMap);
+	long						myRowBytes = QTGetPixMapHandleRowBytes(thePixMap);
+	long						myWidth = theSource->fWidth;
+	long						myHeight = theSource->fHeight;
+	UInt8						*myClamp = theSource->fClampTable + kIngestClampOffset;
+	long						myChromaWidth = 0L;
+	long						myChromaStep = 1L;			// how far to move in a chroma row for each chroma sample
+	short						myYShift = 0;
+	UInt8						myNeutral = 128;			// the chroma of a monochrome stream
+	UInt8						*myCbPlane, *myCrPlane;
+	UInt8						*myY, *myCb, *myCr, *myDst;
+	short						myA, myR, myG, myB;
+	long						myRow, myCol;
+	long						myLuma, myRed, myGreen, myBlue;
+
+	if (!theSource->fFullRange && ((theSource->fChroma == kIngestChroma420) || (theSource->fChroma == kIngestChroma422))) {
+		ColorParams				myParams;
+		long					myChromaRows = (theSource->fChroma == kIngestChroma420) ? (myHeight + 1) / 2 : myHeight;
+
+		QTCmpr_SetColorParams(&myParams, kColorMatrix601, thePixMap);
+
+		myChromaWidth = (myWidth + 1) / 2;
+		myCbPlane = theFrame + (myWidth * myHeight);
+		myCrPlane = myCbPlane + (myChromaWidth * myChromaRows);
+		myYShift = (theSource->fChroma == kIngestChroma420) ? 1 : 0;
+
+		for (myRow = 0; myRow < myHeight; myRow++)
+			QTCmpr_ConvertYCbCrRow(theFrame + (myRow * myWidth), myCbPlane + ((myRow >> myYShift) * myChromaWidth),
+									myCrPlane + ((myRow >> myYShift) * myChromaWidth), myBaseAddr + (myRow * myRowBytes), myWidth, &myParams);
+		return;
+	}
+
+	QTCmpr_GetPixMapComponentOffsets(thePixMap, &myA, &myR, &myG, &myB);
+
+	switch (theSource->fChroma) {
+		case kIngestChroma420:
+			myChromaWidth = (myWidth + 1) / 2;
+			myYShift = 1;
+			break;
+		case kIngestChroma422:
+			myChromaWidth = (myWidth + 1) / 2;
+			break;
+		case kIngestChroma444:
+			myChromaWidth = myWidth;
+			break;
+		default:
+			myChromaStep = 0L;
+			break;
+	}
+
+	myCbPlane = theFrame + (myWidth * myHeight);
+	myCrPlane = myCbPlane + (myChromaWidth * ((myHeight + myYShift) >> myYShift));
+
+	for (myRow = 0; myRow < myHeight; myRow++) {
+		myY = theFrame + (myRow * myWidth);
+		if (myChromaStep != 0L) {
+			myCb = myCbPlane + ((myRow >> myYShift) * myChromaWidth);
+			myCr = myCrPlane + ((myRow >> myYShift) * myChromaWidth);
+		} else {
+			myCb = &myNeutral;
+			myCr = &myNeutral;
+		}
+		myDst = myBaseAddr + (myRow * myRowBytes);
+
+		// each chroma sample covers one or two pixels; we look up its contribution to each component just once
+		myCol = 0;
+		while (myCol < myWidth) {
+			myRed = theSource->fCrToRTable[*myCr];
+			myGreen = theSource->fCbToGTable[*myCb] + theSource->fCrToGTable[*myCr];
+			myBlue = theSource->fCbToBTable[*myCb];
+			myCb += myChromaStep;
+			myCr += myChromaStep;
+
+			myLuma = theSource->fYTable[*myY++];
+			myDst[myA] = 0xFF;
+			myDst[myR] = myClamp[(myLuma + myRed) >> kIngestFixedShift];
+			myDst[myG] = myClamp[(myLuma + myGreen) >> kIngestFixedShift];
+			myDst[myB] = myClamp[(myLuma + myBlue) >> kIngestFixedShift];
+			myDst += 4;
+			myCol++;
+
+			if ((myChromaWidth < myWidth) && (myCol < myWidth)) {
+				myLuma = theSource->fYTable[*myY++];
+				myDst[myA] = 0xFF;
+				myDst[myR] = myClamp[(myLuma + myRed) >> kIngestFixedShift];
+				myDst[myG] = myClamp[(myLuma + myGreen) >> kIngestFixedShift];
+				myDst[myB] = myClamp[(myLuma + myBlue) >> kIngestFixedShift];
+				myDst += 4;
+				myCol++;
+			}
+		}
+	}
+}
+
+
+//////////
+//
+// QTCmpr_ConvertRGBFrame
+// Convert a frame of packed 24-bit RGB data into the specified 32-bit pixel map.
+//
+//////////
+
+static void QTCmpr_ConvertRGBFrame (IngestSourcePtr theSource, UInt8 *theFrame, PixMapHandle thePixMap)
+{
+	UInt8						*myBaseAddr = (UInt8 *)GetPixBaseAddr(thePixMap);
+	long						myRowBytes = QTGetPixMapHandleRowBytes(thePixMap);
+	UInt8						*mySrc, *myDst;
+	short						myA, myR, myG, myB;
+	long						myRow, myCol;
+
+	QTCmpr_GetPixMapComponentOffsets(thePixMap, &myA, &myR, &myG, &myB);
+
+	mySrc = theFrame;
+	for (myRow = 0; myRow < theSource->fHeight; myRow++) {
+		myDst = myBaseAddr + (myRow * myRowBytes);
+
+		for (myCol = 0; myCol < theSource->fWidth; myCol++, mySrc += 3, myDst += 4) {
+			myDst[myA] = 0xFF;
+			myDst[myR] = mySrc[0];
+			myDst[myG] = mySrc[1];
+			myDst[myB] = mySrc[2];
+		}
+	}
+}
+
+
+//////////
+//
+// QTCmpr_GetPixMapComponentOffsets
+// Return the byte offsets of the alpha, red, green, and blue components of a pixel in the specified 32-bit
+// pixel map.
+//
+//////////
+
+static void QTCmpr_GetPixMapComponentOffsets (PixMapHandle thePixMap, short *theAlpha, short *theRed, short *theGreen, short *theBlue)
+{
+	if ((**thePixMap).pixelFormat == k32BGRAPixelFormat) {
+		*theBlue = 0;
+		*theGreen = 1;
+		*theRed = 2;
+		*theAlpha = 3;
+	} else {
+		*theAlpha = 0;
+		*theRed = 1;
+		*theGreen = 2;
+		*theBlue = 3;
+	}
+}
+
+
+//////////
+//
+// QTCmpr_StartIngestThread
+// Start the thread that reads frames into the frame buffers.
+//
+//////////
+
+static OSErr QTCmpr_StartIngestThread (IngestSourcePtr theSource)
+{
+#if USE_INGEST_THREAD
+#if TARGET_OS_WIN32
+	DWORD						myThreadID;
+
+	theSource->fEmptySemaphore = CreateSemaphore(NULL, kIngestNumBuffers, kIngestNumBuffers, NULL);
+	theSource->fFullSemaphore = CreateSemaphore(NULL, 0, kIngestNumBuffers, NULL);
+	if ((theSource->fEmptySemaphore == NULL) || (theSource->fFullSemaphore == NULL))
+		return(memFullErr);
+
+	theSource->fThread = CreateThread(NULL, 0, QTCmpr_IngestThreadProc, theSource, 0, &myThreadID);
+	if (theSource->fThread == NULL)
+		return(memFullErr);
+#else
+	pthread_mutex_init(&theSource->fLock, NULL);
+	pthread_cond_init(&theSource->fChanged, NULL);
+
+	if (pthread_create(&theSource->fThread, NULL, QTCmpr_IngestThreadProc, theSource) != 0) {
+		pthread_cond_destroy(&theSource->fChanged);
+		pthread_mutex_destroy(&theSource->fLock);
+		return(memFullErr);
+	}
+
+	theSource->fThreadIsRunning = true;
+#endif
+#else
+#pragma unused(theSource)
+#endif
+
+	return(noErr);
+}
+
+
+//////////
+//
+// QTCmpr_StopIngestThread
+// Stop the thread that reads frames into the frame buffers, and wait for it to quit.
+//
+// If the thread is waiting for input, it quits only once that input arrives (or the input is closed).
+//
+//////////
+
+static void QTCmpr_StopIngestThread (IngestSourcePtr theSource)
+{
+#if USE_INGEST_THREAD
+#if TARGET_OS_WIN32
+	if (theSource->fThread != NULL) {
+		theSource->fStopReading = true;
+		ReleaseSemaphore(theSource->fEmptySemaphore, 1, NULL);
+		WaitForSingleObject(theSource->fThread, INFINITE);
+		CloseHandle(theSource->fThread);
+	}
+
+	if (theSource->fEmptySemaphore != NULL)
+		CloseHandle(theSource->fEmptySemaphore);
+	if (theSource->fFullSemaphore != NULL)
+		CloseHandle(theSource->fFullSemaphore);
+
+	theSource->fThread = NULL;
+	theSource->fEmptySemaphore = NULL;
+	theSource->fFullSemaphore = NULL;
+#else
+	if (theSource->fThreadIsRunning) {
+		pthread_mutex_lock(&theSource->fLock);
+		theSource->fStopReading = true;
+		pthread_cond_broadcast(&theSource->fChanged);
+		pthread_mutex_unlock(&theSource->fLock);
+
+		pthread_join(theSource->fThread, NULL);
+		pthread_cond_destroy(&theSource->fChanged);
+		pthread_mutex_destroy(&theSource->fLock);
+	}
+
+	theSource->fThreadIsRunning = false;
+#endif
+#else
+#pragma unused(theSource)
+#endif
+}
+
+
+//////////
+//
+// QTCmpr_WaitForFullBuffer
+// Return the next frame buffer, once it has been filled.
+//
+// Without a reading thread, we fill the buffer right here.
+//
+//////////
+
+static IngestBufferPtr QTCmpr_WaitForFullBuffer (IngestSourcePtr theSource)
+{
+	IngestBufferPtr				myBuffer = &theSource->fBuffers[theSource->fNextRead];
+
+#if USE_INGEST_THREAD
+#if TARGET_OS_WIN32
+	WaitForSingleObject(theSource->fFullSemaphore, INFINITE);
+#else
+	pthread_mutex_lock(&theSource->fLock);
+	while (theSource->fNumFull == 0L)
+		pthread_cond_wait(&theSource->fChanged, &theSource->fLock);
+	pthread_mutex_unlock(&theSource->fLock);
+#endif
+#else
+	QTCmpr_FillIngestBuffer(theSource, myBuffer);
+#endif
+
+	return(myBuffer);
+}
+
+
+//////////
+//
+// QTCmpr_ReturnEmptyBuffer
+// Give the buffer returned by the last call to QTCmpr_WaitForFullBuffer back to the reading thread.
+//
+//////////
+
+static void QTCmpr_ReturnEmptyBuffer (IngestSourcePtr theSource)
+{
+	theSource->fNextRead = (theSource->fNextRead + 1) % kIngestNumBuffers;
+
+#if USE_INGEST_THREAD
+#if TARGET_OS_WIN32
+	ReleaseSemaphore(theSource->fEmptySemaphore, 1, NULL);
+#else
+	pthread_mutex_lock(&theSource->fLock);
+	theSource->fNumFull--;
+	pthread_cond_broadcast(&theSource->fChanged);
+	pthread_mutex_unlock(&theSource->fLock);
+#endif
+#endif
+}
+
+
+#if USE_INGEST_THREAD
+//////////
+//
+// QTCmpr_IngestThreadProc
+// Fill the frame buffers, in turn, until the input ends or we are told to stop.
+//
+//////////
+
+#if TARGET_OS_WIN32
+static DWORD WINAPI QTCmpr_IngestThreadProc (LPVOID theParam)
+#else
+static void * QTCmpr_IngestThreadProc (void *theParam)
+#endif
+{
+	IngestSourcePtr				mySource = (IngestSourcePtr)theParam;
+	IngestBufferPtr				myBuffer = NULL;
+	OSErr						myErr = noErr;
+
+	while (myErr == noErr) {
+		// wait for an empty buffer
+#if TARGET_OS_WIN32
+		WaitForSingleObject(mySource->fEmptySemaphore, INFINITE);
+#else
+		pthread_mutex_lock(&mySource->fLock);
+		while ((mySource->fNumFull == kIngestNumBuffers) && !mySource->fStopReading)
+			pthread_cond_wait(&mySource->fChanged, &mySource->fLock);
+		pthread_mutex_unlock(&mySource->fLock);
+#endif
+
+		if (mySource->fStopReading)
+			break;
+
+		// fill it; a buffer holding an error tells the compressing thread that there are no more frames
+		myBuffer = &mySource->fBuffers[mySource->fNextFill];
+		myErr = QTCmpr_FillIngestBuffer(mySource, myBuffer);
+		mySource->fNextFill = (mySource->fNextFill + 1) % kIngestNumBuffers;
+
+#if TARGET_OS_WIN32
+		ReleaseSemaphore(mySource->fFullSemaphore, 1, NULL);
+#else
+		pthread_mutex_lock(&mySource->fLock);
+		mySource->fNumFull++;
+		pthread_cond_broadcast(&mySource->fChanged);
+		pthread_mutex_unlock(&mySource->fLock);
+#endif
+	}
+
+#if TARGET_OS_WIN32
+	return(0);
+#else
+	return(NULL);
+#endif
+}
+#endif
@@ -0,0 +1,215 @@
+//////////
+//
+//	File:		QTCmprIngest.h
+//
+//	Contains:	A source of raw frames (YUV4MPEG2 or packed RGB) read from a pipe or a file, for use by QTCompress.
+//
+//	Written by:	Tim Monroe
+//
+//	Copyright:	 2000 by Apple Computer, Inc., all rights reserved.
+//
+//	Change History (most recent first):
+//
+//	   <4>	 	11/13/26	rtm		added kIngestMaxFrameSize
+//	   <3>	 	11/13/26	rtm		added the fGolden field
+//	   <2>	 	11/11/26	rtm		added synthetic sources
+//	   <1>	 	10/27/26	rtm		first file
+//
+//////////
+
+#pragma once
+
+
+//////////
+//
+// header files
+//
+//////////
+
+#ifndef __QTCmprIngest__
+#define __QTCmprIngest__
+
+#ifndef __MOVIES__
+#include <Movies.h>
+#endif
+
+#include <stdio.h>
+
+#if TARGET_OS_WIN32
+#include <windows.h>
+#endif
+
+#if TARGET_RT_MAC_MACHO
+#include <pthread.h>
+#endif
+
+#include "QTCmprBudget.h"
+#include "QTCmprGolden.h"
+
+
+//////////
+//
+// compiler flags
+//
+//////////
+
+// do we read the next frame on another thread while the current frame is being compressed?
+#if TARGET_OS_WIN32 || TARGET_RT_MAC_MACHO
+#define USE_INGEST_THREAD				1
+#else
+#define USE_INGEST_THREAD				0
+#endif
+
+
+//////////
+//
+// constants
+//
+//////////
+
+#define kIngestStdInName				"-"						// the input name that means standard input
+#define kIngestY4MSignature				"YUV4MPEG2 "			// the start of a YUV4MPEG2 stream header
+#define kIngestY4MFrameSignature		"FRAME"					// the start of a YUV4MPEG2 frame header
+#define kIngestMaxLineLength			1024L					// maximum length of a YUV4MPEG2 stream or frame header
+#define kIngestReadAheadSize			(64L * 1024L)			// size of the buffer used for reading stream and frame headers
+#define kIngestNumBuffers				2						// number of frame buffers
+#define kIngestMaxFrameSize				0x20000000L				// the most bytes of pixel data a frame may have (512 MB)
+#define kIngestFixedShift				16						// fraction bits in the color conversion tables
+#define kIngestClampOffset				512						// index of the entry for 0 in the clamp table
+#define kIngestClampTableSize			1536					// number of entries in the clamp table
+#define kIngestSyntheticPrefix			"synthetic:"			// the start of an input name that means a synthetic source
+#define kIngestSyntheticFormat			"320x240:30"			// the size and rate of a synthetic source, unless the caller gives them
+#define kIngestSyntheticFrames			300L					// the frames in a synthetic source, unless its name gives the number
+#define kIngestSyntheticSceneFrames		30L						// the frames in each scene of a kIngestPatternCuts source
+
+// ingest formats
+enum {
+	kIngestFormatY4M					= 1,					// YUV4MPEG2: a stream header, then a frame header and planar Y'CbCr data for each frame
+	kIngestFormatRGB					= 2,					// packed 24-bit RGB frames, with no headers
+	kIngestFormatSynthetic				= 3						// packed 24-bit RGB frames that we make ourselves
+};
+
+// the patterns of synthetic sources
+enum {
+	kIngestPatternBars					= 1,					// color bars that never change
+	kIngestPatternRamp					= 2,					// color ramps that move a little each frame
+	kIngestPatternCuts					= 3						// checkerboards that scroll, with a cut to a new one (or to black) every so often
+};
+
+// Y'CbCr chroma subsampling
+enum {
+	kIngestChroma420					= 1,
+	kIngestChroma422					= 2,
+	kIngestChroma444					= 3,
+	kIngestChromaMono					= 4
+};
+
+
+//////////
+//
+// data types
+//
+//////////
+
+// a frame buffer, filled by the reading thread and emptied by the compressing thread
+typedef struct IngestBuffer {
+	Ptr							fData;
+	OSErr						fResult;							// noErr if fData holds a frame, eofErr at the end of the input, or an error
+} IngestBuffer, *IngestBufferPtr;
+
+// a source of raw frames
+typedef struct IngestSource {
+	long						fFormat;							// kIngestFormatY4M, kIngestFormatRGB, or kIngestFormatSynthetic
+	short						fWidth;
+	short						fHeight;
+	long						fRateNum;							// frames per second is fRateNum / fRateDen
+	long						fRateDen;
+	long						fChroma;							// the chroma subsampling of a YUV4MPEG2 stream
+	Boolean						fFullRange;							// do luma and chroma use the full 0-255 range?
+	long						fFrameSize;							// the number of bytes of pixel data in a frame
+	long						fNumFrames;							// the number of frames returned so far
+	OSErr						fEndResult;							// once the input has ended, the reason (eofErr or an error)
+	long						fPattern;							// the pattern of a synthetic source
+	long						fFrameLimit;						// the number of frames in a synthetic source
+	long						fNumMade;							// the number of synthetic frames made so far
+	GoldenDigestPtr				fGolden;							// the digest that each raw frame is added to, or NULL
+
+	// the input, and a small buffer for reading headers
+#if TARGET_OS_WIN32
+	HANDLE						fFile;
+#elif TARGET_RT_MAC_MACHO
+	int							fFile;
+#else
+	FILE						*fFile;
+#endif
+	Boolean						fIsStdIn;
+	Ptr							fReadAhead;
+	long						fReadAheadPos;						// the next unread byte in fReadAhead
+	long						fReadAheadEnd;						// the end of the data in fReadAhead
+
+	// the frame buffers; fBuffers[fNextRead] is the next buffer we return, fBuffers[fNextFill] the next one we fill
+	IngestBuffer				fBuffers[kIngestNumBuffers];
+	long						fNextRead;
+	long						fNextFill;
+#if USE_INGEST_THREAD
+	Boolean						fStopReading;						// should the reading thread quit?
+#if TARGET_OS_WIN32
+	HANDLE						fThread;
+	HANDLE						fEmptySemaphore;					// counts the empty buffers
+	HANDLE						fFullSemaphore;						// counts the full buffers
+#else
+	pthread_t					fThread;
+	Boolean						fThreadIsRunning;
+	pthread_mutex_t				fLock;
+	pthread_cond_t				fChanged;							// signalled whenever a buffer is filled or emptied
+	long						fNumFull;							// the number of full buffers
+#endif
+#endif
+
+	// the color conversion tables, in fixed point with kIngestFixedShift fraction bits
+	long						fYTable[256];
+	long						fCrToRTable[256];
+	long						fCrToGTable[256];
+	long						fCbToGTable[256];
+	long						fCbToBTable[256];
+	UInt8						fClampTable[kIngestClampTableSize];
+
+	MemoryJobPtr				fJob;								// the job that the frame buffers are reserved for
+} IngestSource, *IngestSourcePtr;
+
+
+//////////
+//
+// function prototypes
+//
+//////////
+
+OSErr							QTCmpr_OpenIngestSource (IngestSourcePtr theSource, char *thePath, char *theRawFormat, MemoryJobPtr theJob);
+OSErr							QTCmpr_ReadIngestFrame (IngestSourcePtr theSource, PixMapHandle thePixMap);
+void							QTCmpr_CloseIngestSource (IngestSourcePtr theSource);
+static OSErr					QTCmpr_OpenIngestInput (IngestSourcePtr theSource, char *thePath, char *theRawFormat);
+static OSErr					QTCmpr_ParseRawFormat (IngestSourcePtr theSource, char *theRawFormat);
+static OSErr					QTCmpr_ParseSyntheticSource (IngestSourcePtr theSource, char *thePath, char *theRawFormat);
+static OSErr					QTCmpr_ParseY4MHeader (IngestSourcePtr theSource);
+static void						QTCmpr_BuildIngestTables (IngestSourcePtr theSource);
+static OSErr					QTCmpr_FillIngestBuffer (IngestSourcePtr theSource, IngestBufferPtr theBuffer);
+static OSErr					QTCmpr_ReadIngestLine (IngestSourcePtr theSource, char *theLine, long theMaxLength);
+static OSErr					QTCmpr_ReadIngestBytes (IngestSourcePtr theSource, Ptr theData, long theSize);
+static long						QTCmpr_ReadIngestFile (IngestSourcePtr theSource, Ptr theData, long theSize);
+static OSErr					QTCmpr_MakeSyntheticFrame (IngestSourcePtr theSource, UInt8 *theFrame);
+static void						QTCmpr_ConvertYCbCrFrame (IngestSourcePtr theSource, UInt8 *theFrame, PixMapHandle thePixMap);
+static void						QTCmpr_ConvertRGBFrame (IngestSourcePtr theSource, UInt8 *theFrame, PixMapHandle thePixMap);
+static void						QTCmpr_GetPixMapComponentOffsets (PixMapHandle thePixMap, short *theAlpha, short *theRed, short *theGreen, short *theBlue);
+static OSErr					QTCmpr_StartIngestThread (IngestSourcePtr theSource);
+static void						QTCmpr_StopIngestThread (IngestSourcePtr theSource);
+static IngestBufferPtr			QTCmpr_WaitForFullBuffer (IngestSourcePtr theSource);
+static void						QTCmpr_ReturnEmptyBuffer (IngestSourcePtr theSource);
+#if USE_INGEST_THREAD
+#if TARGET_OS_WIN32
+static DWORD WINAPI				QTCmpr_IngestThreadProc (LPVOID theParam);
+#else
+static void *					QTCmpr_IngestThreadProc (void *theParam);
+#endif
+#endif
+
+#endif	// __QTCmprIngest__
@@ -0,0 +1,772 @@
+//////////
+//
+//	File:		QTCmprMotion.c
+//
+//	Contains:	Block motion estimation between successive frames, for use by QTCompress.
+//
+//	Written by:	Tim Monroe
+//
+//	Copyright:	 2000 by Apple Computer, Inc., all rights reserved.
+//
+//	Change History (most recent first):
+//
+//	   <3>	 	11/13/26	rtm		the blocks are searched in slices of whole rows of blocks, on the threads in QTCmprSlice.c
+//	   <2>	 	11/07/26	rtm		the luma plane is filled in slices, on the threads in QTCmprSlice.c
+//	   <1>	 	11/05/26	rtm		first file
+//
+//	We don't compress frames ourselves; the compressor component does. But a temporal compressor decides for
+//	itself when to make a key frame, usually every so many frames, and a difference frame at a cut to a new scene
+//	is large and looks bad. So QTCmpr_CompressSequence asks a motion estimator how well each frame can be predicted
+//	from the last one; if it can't be predicted much better than it can be coded on its own, the frame starts a new
+//	scene, and we tell the compressor to make it a key frame.
+//
+//	The estimator works on the luma of each frame at half size, in blocks of 8 by 8 pixels (so each block covers a
+//	16 by 16 macroblock of the frame). For each block, we start with the best of the zero vector, the vectors of
+//	the blocks to the left and above, and the vector of the same block in the last frame; then we follow a
+//	hexagon of 6 points to the best full-pixel vector, refine it with a small diamond, and finally try the 8
+//	half-pixel vectors around it. The search compares blocks by their sum of absolute differences (SAD); the
+//	cost of the chosen vector is the sum of absolute Hadamard-transformed differences (SATD), which follows the
+//	size of the coded difference more closely. The cost of coding a block on its own is the SATD of the block
+//	less its DC term. The vectors are kept in fVectors, for any other use.
+//
+//	The search is the most expensive part of estimating motion, so it's done in slices of whole rows of blocks, on
+//	the threads in the slice pool (see QTCmprSlice.c), as the luma plane is. Each slice adds up its own costs, and
+//	takes the vector of the block above as a candidate only if that block is in the same slice, since another
+//	slice may not have searched it yet. In deterministic mode the slices are always the same, so the vectors are
+//	too.
+//
+//	The SAD and SATD routines are also the inner loops; on x86 processors with SSE2 we use versions that do a
+//	block in a few instructions (the SAD with PSADBW), and check first that they agree with the C versions.
+//
+//////////
+
+//////////
+//
+// header files
+//
+//////////
+
+#include "QTCompress.h"
+
+
+//////////
+//
+// global variables
+//
+//////////
+
+static MotionKernels				gMotionKernels;						// the block routines we use
+static Boolean						gMotionKernelsReady = false;
+
+// the C block routines, which are also the reference for the SSE2 ones
+static MotionKernels				gMotionKernels_C = {QTCmpr_SAD8x8_C, QTCmpr_SATD8x8_C, "C"};
+
+#if USE_SSE2_KERNELS
+static MotionKernels				gMotionKernels_SSE2 = {QTCmpr_SAD8x8_SSE2, QTCmpr_SATD8x8_SSE2, "SSE2"};
+#endif
+
+// the search patterns, in full pixels
+static short						gMotionHexagon[6][2] = {{-2, 0}, {-1, -2}, {1, -2}, {2, 0}, {1, 2}, {-1, 2}};
+static short						gMotionDiamond[4][2] = {{-1, 0}, {1, 0}, {0, -1}, {0, 1}};
+
+// a block of zeros; the SATD of a block against it, less its SAD against it, is the block's intra cost
+static UInt8						gMotionZeros[kMotionBlockSize * kMotionBlockSize];
+
+// the smallest average difference per pixel, in SATD terms, that can start a new scene; without it, nearly
+// flat frames would keep starting new scenes
+#define kMotionMinCutCost			4
+
+
+//////////
+//
+// QTCmpr_NewMotionEstimator
+// Prepare to estimate the motion between successive frames in the specified pixel map, which must be 24 or
+// 32 bits deep.
+//
+// Call QTCmpr_DisposeMotionEstimator even if this function fails.
+//
+//////////
+
+OSErr QTCmpr_NewMotionEstimator (MotionEstimatorPtr theEstimator, PixMapHandle thePixMap, MemoryJobPtr theJob)
+{
+	Rect						myRect;
+	OSType						myFormat;
+	long						myPlaneSize, myVectorsSize;
+
+	if (theEstimator == NULL)
+		return(paramErr);
+
+	theEstimator->fPixMap = thePixMap;
+	theEstimator->fCurrent = NULL;
+	theEstimator->fPrevious = NULL;
+	theEstimator->fVectors = NULL;
+	theEstimator->fLastVectors = NULL;
+	theEstimator->fHasPrevious = false;
+	theEstimator->fInterCost = 0L;
+	theEstimator->fIntraCost = 0L;
+	theEstimator->fKernels = NULL;
+	theEstimator->fNumFrames = 0L;
+	theEstimator->fNumSceneCuts = 0L;
+	theEstimator->fCostPercent = 0.0;
+	theEstimator->fEstimateTime = 0.0;
+	theEstimator->fSize = 0L;
+	theEstimator->fJob = theJob;
+
+	if (thePixMap == NULL)
+		return(paramErr);
+
+	// find the components; a 32-bit pixel map that doesn't say otherwise is ARGB
+	myFormat = (**thePixMap).pixelFormat;
+	if (myFormat == k24RGBPixelFormat) {
+		theEstimator->fBytesPerPixel = 3;
+		theEstimator->fRed = 0;
+		theEstimator->fGreen = 1;
+		theEstimator->fBlue = 2;
+	} else if (myFormat == k32BGRAPixelFormat) {
+		theEstimator->fBytesPerPixel = 4;
+		theEstimator->fRed = 2;
+		theEstimator->fGreen = 1;
+		theEstimator->fBlue = 0;
+	} else if (GetPixDepth(thePixMap) == 32) {
+		theEstimator->fBytesPerPixel = 4;
+		theEstimator->fRed = 1;
+		theEstimator->fGreen = 2;
+		theEstimator->fBlue = 3;
+	} else {
+		return(paramErr);
+	}
+
+	GetPixBounds(thePixMap, &myRect);
+	theEstimator->fWidth = (myRect.right - myRect.left) / 2;
+	theEstimator->fHeight = (myRect.bottom - myRect.top) / 2;
+	theEstimator->fBlocksWide = theEstimator->fWidth / kMotionBlockSize;
+	theEstimator->fBlocksHigh = theEstimator->fHeight / kMotionBlockSize;
+	if ((theEstimator->fBlocksWide == 0) || (theEstimator->fBlocksHigh == 0))
+		return(paramErr);
+
+	myPlaneSize = theEstimator->fWidth * theEstimator->fHeight;
+	myVectorsSize = theEstimator->fBlocksWide * theEstimator->fBlocksHigh * sizeof(MotionVector);
+	theEstimator->fSize = 2L * (myPlaneSize + myVectorsSize);
+	QTCmpr_ReserveMemory(theJob, theEstimator->fSize);
+
+	theEstimator->fCurrent = (UInt8 *)NewPtr(myPlaneSize);
+	theEstimator->fPrevious = (UInt8 *)NewPtr(myPlaneSize);
+	theEstimator->fVectors = (MotionVectorPtr)NewPtrClear(myVectorsSize);
+	theEstimator->fLastVectors = (MotionVectorPtr)NewPtrClear(myVectorsSize);
+	if ((theEstimator->fCurrent == NULL) || (theEstimator->fPrevious == NULL) || (theEstimator->fVectors == NULL) || (theEstimator->fLastVectors == NULL))
+		return(memFullErr);
+
+	return(noErr);
+}
+
+
+//////////
+//
+// QTCmpr_EstimateMotion
+// Find the motion vectors of the frame now in the estimator's pixel map, relative to the last frame; return true
+// if the frame starts a new scene.
+//
+// The first frame has no vectors, and doesn't start a new scene (it's a key frame anyway).
+//
+//////////
+
+Boolean QTCmpr_EstimateMotion (MotionEstimatorPtr theEstimator)
+{
+	UInt8						*myPlane;
+	MotionVectorPtr				myVectors;
+	Boolean						isSceneCut = false;
+	UnsignedWide				myStart, myEnd;
+	long						mySlice;
+
+	Microseconds(&myStart);
+
+	// the current frame becomes the last one
+	myPlane = theEstimator->fPrevious;
+	theEstimator->fPrevious = theEstimator->fCurrent;
+	theEstimator->fCurrent = myPlane;
+
+	myVectors = theEstimator->fLastVectors;
+	theEstimator->fLastVectors = theEstimator->fVectors;
+	theEstimator->fVectors = myVectors;
+
+	QTCmpr_GetLumaPlane(theEstimator);
+
+	theEstimator->fInterCost = 0L;
+	theEstimator->fIntraCost = 0L;
+
+	if (theEstimator->fHasPrevious) {
+		theEstimator->fKernels = QTCmpr_GetMotionKernels();
+		for (mySlice = 0; mySlice < kSliceMaxThreads; mySlice++) {
+			theEstimator->fSliceInterCost[mySlice] = 0L;
+			theEstimator->fSliceIntraCost[mySlice] = 0L;
+		}
+
+		// the slices are whole rows of blocks
+		QTCmpr_RunSlices(QTCmpr_SearchSlice, theEstimator, 0L, theEstimator->fBlocksHigh * kMotionBlockSize, kMotionBlockSize);
+
+		for (mySlice = 0; mySlice < kSliceMaxThreads; mySlice++) {
+			theEstimator->fInterCost += theEstimator->fSliceInterCost[mySlice];
+			theEstimator->fIntraCost += theEstimator->fSliceIntraCost[mySlice];
+		}
+
+		// the frame starts a new scene if predicting it saves little over coding it on its own
+		isSceneCut = (theEstimator->fInterCost >= kMotionMinCutCost * theEstimator->fWidth * theEstimator->fHeight) &&
+						((double)theEstimator->fInterCost * 100.0 > (double)theEstimator->fIntraCost * kMotionSceneCutPercent);
+
+		theEstimator->fNumFrames++;
+		if (isSceneCut)
+			theEstimator->fNumSceneCuts++;
+		if (theEstimator->fIntraCost > 0L)
+			theEstimator->fCostPercent += (100.0 * theEstimator->fInterCost) / theEstimator->fIntraCost;
+	}
+
+	theEstimator->fHasPrevious = true;
+
+	Microseconds(&myEnd);
+
+	theEstimator->fEstimateTime += ((double)myEnd.hi - (double)myStart.hi) * 4294967296.0 + ((double)myEnd.lo - (double)myStart.lo);
+
+	return(isSceneCut);
+}
+
+
+//////////
+//
+// QTCmpr_DisposeMotionEstimator
+// Dispose of the estimator's planes and vectors, and report what it found.
+//
+//////////
+
+void QTCmpr_DisposeMotionEstimator (MotionEstimatorPtr theEstimator)
+{
+	if (theEstimator == NULL)
+		return;
+
+	if (theEstimator->fNumFrames > 0L)
+		QTCmpr_LogMessage("QTCmpr_DisposeMotionEstimator: %ld scene cuts in %ld frames; predicted frames cost %.0f%% of their intra cost, on average; %s routines, %.0f us per frame",
+							theEstimator->fNumSceneCuts, theEstimator->fNumFrames, theEstimator->fCostPercent / theEstimator->fNumFrames,
+							QTCmpr_GetMotionKernels()->fName, theEstimator->fEstimateTime / theEstimator->fNumFrames);
+
+	if (theEstimator->fCurrent != NULL)
+		DisposePtr((Ptr)theEstimator->fCurrent);
+	if (theEstimator->fPrevious != NULL)
+		DisposePtr((Ptr)theEstimator->fPrevious);
+	if (theEstimator->fVectors != NULL)
+		DisposePtr((Ptr)theEstimator->fVectors);
+	if (theEstimator->fLastVectors != NULL)
+		DisposePtr((Ptr)theEstimator->fLastVectors);
+
+	theEstimator->fCurrent = NULL;
+	theEstimator->fPrevious = NULL;
+	theEstimator->fVectors = NULL;
+	theEstimator->fLastVectors = NULL;
+
+	QTCmpr_ReleaseMemory(theEstimator->fJob, theEstimator->fSize);
+	theEstimator->fSize = 0L;
+}
+
+
+//////////
+//
+// QTCmpr_GetLumaPlane
+// Fill the current luma plane from the estimator's pixel map; each luma pixel is the average luma of 2 by 2
+// pixels of the frame.
+//
+//////////
+
+static void QTCmpr_GetLumaPlane (MotionEstimatorPtr theEstimator)
+{
+	QTCmpr_RunSlices(QTCmpr_GetLumaSlice, theEstimator, 0L, theEstimator->fHeight, 1L);
+}
+
+
+//////////
+//
+// QTCmpr_GetLumaSlice
+// Fill rows theTop through theBottom - 1 of the current luma plane.
+//
+// This is called on the threads in the slice pool.
+//
+//////////
+
+static void QTCmpr_GetLumaSlice (void *theRefCon, long theSlice, long theTop, long theBottom)
+{
+	MotionEstimatorPtr			myEstimator = (MotionEstimatorPtr)theRefCon;
+	UInt8						*myBaseAddr = (UInt8 *)GetPixBaseAddr(myEstimator->fPixMap);
+	long						myRowBytes = QTGetPixMapHandleRowBytes(myEstimator->fPixMap);
+	long						myBytesPerPixel = myEstimator->fBytesPerPixel;
+	long						myRed = myEstimator->fRed;
+	long						myGreen = myEstimator->fGreen;
+	long						myBlue = myEstimator->fBlue;
+	UInt8						*myDst = myEstimator->fCurrent + (theTop * myEstimator->fWidth);
+	UInt8						*mySrc0, *mySrc1;
+	long						myRow, myCol;
+
+#pragma unused(theSlice)
+
+	for (myRow = theTop; myRow < theBottom; myRow++) {
+		mySrc0 = myBaseAddr + (2 * myRow * myRowBytes);
+		mySrc1 = mySrc0 + myRowBytes;
+
+		for (myCol = 0; myCol < myEstimator->fWidth; myCol++) {
+			long				myR = mySrc0[myRed] + mySrc0[myRed + myBytesPerPixel] + mySrc1[myRed] + mySrc1[myRed + myBytesPerPixel];
+			long				myG = mySrc0[myGreen] + mySrc0[myGreen + myBytesPerPixel] + mySrc1[myGreen] + mySrc1[myGreen + myBytesPerPixel];
+			long				myB = mySrc0[myBlue] + mySrc0[myBlue + myBytesPerPixel] + mySrc1[myBlue] + mySrc1[myBlue + myBytesPerPixel];
+
+			*myDst++ = (UInt8)(((77 * myR) + (150 * myG) + (29 * myB) + 512) >> 10);
+
+			mySrc0 += 2 * myBytesPerPixel;
+			mySrc1 += 2 * myBytesPerPixel;
+		}
+	}
+}
+
+
+//////////
+//
+// QTCmpr_SearchSlice
+// Find the motion vectors of the blocks in rows theTop through theBottom - 1 of the current luma plane; the
+// slice pool cuts the plane on block boundaries.
+//
+// This is called on the threads in the slice pool.
+//
+//////////
+
+static void QTCmpr_SearchSlice (void *theRefCon, long theSlice, long theTop, long theBottom)
+{
+	MotionEstimatorPtr			myEstimator = (MotionEstimatorPtr)theRefCon;
+	long						myFirstBlockY = theTop / kMotionBlockSize;
+	long						myBlockX, myBlockY;
+
+	for (myBlockY = myFirstBlockY; myBlockY < theBottom / kMotionBlockSize; myBlockY++)
+		for (myBlockX = 0; myBlockX < myEstimator->fBlocksWide; myBlockX++)
+			QTCmpr_SearchBlock(myEstimator, theSlice, myBlockX, myBlockY, myFirstBlockY);
+}
+
+
+//////////
+//
+// QTCmpr_SearchBlock
+// Find the motion vector of the specified block, and add its costs to those of the specified slice, whose first
+// row of blocks is theFirstBlockY.
+//
+//////////
+
+static void QTCmpr_SearchBlock (MotionEstimatorPtr theEstimator, long theSlice, long theBlockX, long theBlockY, long theFirstBlockY)
+{
+	MotionKernelsPtr			myKernels = theEstimator->fKernels;
+	long						myIndex = (theBlockY * theEstimator->fBlocksWide) + theBlockX;
+	long						myX = theBlockX * kMotionBlockSize;
+	long						myY = theBlockY * kMotionBlockSize;
+	UInt8						*myBlock = theEstimator->fCurrent + (myY * theEstimator->fWidth) + myX;
+	MotionVector				myCandidates[4];
+	long						myNumCandidates = 0;
+	long						myBestX = 0, myBestY = 0, myBestCost;
+	long						myCenterX, myCenterY;
+	long						myCost, myStep, myPoint;
+
+	// the candidates for the starting point, in full pixels
+	myCandidates[myNumCandidates++] = theEstimator->fLastVectors[myIndex];
+	if (theBlockX > 0)
+		myCandidates[myNumCandidates++] = theEstimator->fVectors[myIndex - 1];
+	if (theBlockY > theFirstBlockY)
+		myCandidates[myNumCandidates++] = theEstimator->fVectors[myIndex - theEstimator->fBlocksWide];
+
+	myBestCost = QTCmpr_GetVectorCost(theEstimator, myKernels->fSAD, myX, myY, 0, 0);
+	for (myPoint = 0; myPoint < myNumCandidates; myPoint++) {
+		myCenterX = myCandidates[myPoint].fX >> 1;
+		myCenterY = myCandidates[myPoint].fY >> 1;
+		myCost = QTCmpr_GetVectorCost(theEstimator, myKernels->fSAD, myX, myY, 2 * myCenterX, 2 * myCenterY);
+		if (myCost < myBestCost) {
+			myBestCost = myCost;
+			myBestX = myCenterX;
+			myBestY = myCenterY;
+		}
+	}
+
+	// follow the hexagon, and then the diamond, until the center is the best point
+	for (myStep = 0; (myStep < kMotionMaxSteps) && (myBestCost > 0L); myStep++) {
+		myCenterX = myBestX;
+		myCenterY = myBestY;
+		for (myPoint = 0; myPoint < 6; myPoint++) {
+			myCost = QTCmpr_GetVectorCost(theEstimator, myKernels->fSAD, myX, myY, 2 * (myCenterX + gMotionHexagon[myPoint][0]), 2 * (myCenterY + gMotionHexagon[myPoint][1]));
+			if (myCost < myBestCost) {
+				myBestCost = myCost;
+				myBestX = myCenterX + gMotionHexagon[myPoint][0];
+				myBestY = myCenterY + gMotionHexagon[myPoint][1];
+			}
+		}
+
+		if ((myBestX == myCenterX) && (myBestY == myCenterY))
+			break;
+	}
+
+	for (myStep = 0; (myStep < kMotionMaxSteps) && (myBestCost > 0L); myStep++) {
+		myCenterX = myBestX;
+		myCenterY = myBestY;
+		for (myPoint = 0; myPoint < 4; myPoint++) {
+			myCost = QTCmpr_GetVectorCost(theEstimator, myKernels->fSAD, myX, myY, 2 * (myCenterX + gMotionDiamond[myPoint][0]), 2 * (myCenterY + gMotionDiamond[myPoint][1]));
+			if (myCost < myBestCost) {
+				myBestCost = myCost;
+				myBestX = myCenterX + gMotionDiamond[myPoint][0];
+				myBestY = myCenterY + gMotionDiamond[myPoint][1];
+			}
+		}
+
+		if ((myBestX == myCenterX) && (myBestY == myCenterY))
+			break;
+	}
+
+	// now work in half pixels, and try the 8 points around the best one
+	myBestX *= 2;
+	myBestY *= 2;
+	myCenterX = myBestX;
+	myCenterY = myBestY;
+	for (myPoint = 0; (myPoint < 9) && (myBestCost > 0L); myPoint++) {
+		if (myPoint == 4)
+			continue;
+
+		myCost = QTCmpr_GetVectorCost(theEstimator, myKernels->fSAD, myX, myY, myCenterX + (myPoint % 3) - 1, myCenterY + (myPoint / 3) - 1);
+		if (myCost < myBestCost) {
+			myBestCost = myCost;
+			myBestX = myCenterX + (myPoint % 3) - 1;
+			myBestY = myCenterY + (myPoint / 3) - 1;
+		}
+	}
+
+	theEstimator->fVectors[myIndex].fX = (short)myBestX;
+	theEstimator->fVectors[myIndex].fY = (short)myBestY;
+
+	theEstimator->fSliceInterCost[theSlice] += QTCmpr_GetVectorCost(theEstimator, myKernels->fSATD, myX, myY, myBestX, myBestY);
+	theEstimator->fSliceIntraCost[theSlice] += myKernels->fSATD(myBlock, theEstimator->fWidth, gMotionZeros, kMotionBlockSize) -
+												myKernels->fSAD(myBlock, theEstimator->fWidth, gMotionZeros, kMotionBlockSize);
+}
+
+
+//////////
+//
+// QTCmpr_GetVectorCost
+// Return the cost of predicting the block at (theX, theY) of the current plane with the specified vector, or
+// kMotionNoCost if the vector is out of range.
+//
+//////////
+
+static long QTCmpr_GetVectorCost (MotionEstimatorPtr theEstimator, MotionCostProcPtr theCostProc, long theX, long theY, long theVectorX, long theVectorY)
+{
+	UInt8						myBlock[kMotionBlockSize * kMotionBlockSize];
+	UInt8						*myRef;
+	long						myRefRowBytes;
+
+	myRef = QTCmpr_GetReferenceBlock(theEstimator, theX, theY, theVectorX, theVectorY, myBlock, &myRefRowBytes);
+	if (myRef == NULL)
+		return(kMotionNoCost);
+
+	return(theCostProc(theEstimator->fCurrent + (theY * theEstimator->fWidth) + theX, theEstimator->fWidth, myRef, myRefRowBytes));
+}
+
+
+//////////
+//
+// QTCmpr_GetReferenceBlock
+// Return the block of the last plane that the specified vector points to from (theX, theY), or NULL if it's out
+// of range. A block at a half-pixel position is interpolated into theBlock.
+//
+//////////
+
+static UInt8 *QTCmpr_GetReferenceBlock (MotionEstimatorPtr theEstimator, long theX, long theY, long theVectorX, long theVectorY, UInt8 *theBlock, long *theRowBytes)
+{
+	long						myRowBytes = theEstimator->fWidth;
+	long						myHalfX = theVectorX & 1;
+	long						myHalfY = theVectorY & 1;
+	long						myLeft = theX + (theVectorX >> 1);
+	long						myTop = theY + (theVectorY >> 1);
+	UInt8						*myRef;
+	long						myRow, myCol;
+
+	if ((theVectorX < -2 * kMotionSearchRange) || (theVectorX > 2 * kMotionSearchRange) ||
+		(theVectorY < -2 * kMotionSearchRange) || (theVectorY > 2 * kMotionSearchRange))
+		return(NULL);
+
+	if ((myLeft < 0) || (myLeft + kMotionBlockSize + myHalfX > theEstimator->fWidth) ||
+		(myTop < 0) || (myTop + kMotionBlockSize + myHalfY > theEstimator->fHeight))
+		return(NULL);
+
+	myRef = theEstimator->fPrevious + (myTop * myRowBytes) + myLeft;
+
+	if (!myHalfX && !myHalfY) {
+		*theRowBytes = myRowBytes;
+		return(myRef);
+	}
+
+	// average the pixels on either side, horizontally, vertically, or both
+	for (myRow = 0; myRow < kMotionBlockSize; myRow++) {
+		UInt8					*mySrc = myRef + (myRow * myRowBytes);
+		UInt8					*myDst = theBlock + (myRow * kMotionBlockSize);
+
+		if (myHalfX && myHalfY) {
+			for (myCol = 0; myCol < kMotionBlockSize; myCol++)
+				myDst[myCol] = (UInt8)((((mySrc[myCol] + mySrc[myCol + 1] + 1) >> 1) + ((mySrc[myCol + myRowBytes] + mySrc[myCol + myRowBytes + 1] + 1) >> 1) + 1) >> 1);
+		} else if (myHalfX) {
+			for (myCol = 0; myCol < kMotionBlockSize; myCol++)
+				myDst[myCol] = (UInt8)((mySrc[myCol] + mySrc[myCol + 1] + 1) >> 1);
+		} else {
+			for (myCol = 0; myCol < kMotionBlockSize; myCol++)
+				myDst[myCol] = (UInt8)((mySrc[myCol] + mySrc[myCol + myRowBytes] + 1) >> 1);
+		}
+	}
+
+	*theRowBytes = kMotionBlockSize;
+	return(theBlock);
+}
+
+
+//////////
+//
+// QTCmpr_GetMotionKernels
+// Return the block routines to use: the SSE2 ones, if the processor has SSE2 and they give the same results as
+// the C ones, or else the C ones.
+//
+//////////
+
+static MotionKernelsPtr QTCmpr_GetMotionKernels (void)
+{
+	if (!gMotionKernelsReady) {
+		gMotionKernels = gMotionKernels_C;
+
+#if USE_SSE2_KERNELS
+		if (QTCmpr_HasSSE2()) {
+			if (QTCmpr_CheckMotionKernels(&gMotionKernels_SSE2, &gMotionKernels_C))
+				gMotionKernels = gMotionKernels_SSE2;
+			else
+				QTCmpr_LogMessage("QTCmpr_GetMotionKernels: the SSE2 routines don't match the C routines; using the C routines");
+		}
+#endif
+
+		gMotionKernelsReady = true;
+	}
+
+	return(&gMotionKernels);
+}
+
+
+//////////
+//
+// QTCmpr_CheckMotionKernels
+// Do the specified block routines produce exactly the same results as the reference routines?
+//
+// We compare blocks of a test plane of pseudo-random pixels against each other, and the extreme block of 0s
+// against 255s, which gives the largest SATD there is.
+//
+//////////
+
+static Boolean QTCmpr_CheckMotionKernels (MotionKernelsPtr theKernels, MotionKernelsPtr theReference)
+{
+	UInt8						myPlane[3 * kMotionBlockSize][3 * kMotionBlockSize];
+	UInt8						myFull[kMotionBlockSize * kMotionBlockSize];
+	unsigned long				mySeed = 1;
+	long						myRow, myCol, myOffset;
+
+	for (myRow = 0; myRow < 3 * kMotionBlockSize; myRow++) {
+		for (myCol = 0; myCol < 3 * kMotionBlockSize; myCol++) {
+			mySeed = (mySeed * 1103515245) + 12345;
+			myPlane[myRow][myCol] = (UInt8)(mySeed >> 16);
+		}
+	}
+
+	for (myOffset = 0; myOffset < 2 * kMotionBlockSize; myOffset++) {
+		UInt8					*myBlock = &myPlane[myOffset][myOffset / 2];
+		UInt8					*myRef = &myPlane[kMotionBlockSize][myOffset];
+
+		if ((theKernels->fSAD(myBlock, sizeof(myPlane[0]), myRef, sizeof(myPlane[0])) != theReference->fSAD(myBlock, sizeof(myPlane[0]), myRef, sizeof(myPlane[0]))) ||
+			(theKernels->fSATD(myBlock, sizeof(myPlane[0]), myRef, sizeof(myPlane[0])) != theReference->fSATD(myBlock, sizeof(myPlane[0]), myRef, sizeof(myPlane[0]))))
+			return(false);
+	}
+
+	memset(myFull, 255, sizeof(myFull));
+	if ((theKernels->fSAD(myFull, kMotionBlockSize, gMotionZeros, kMotionBlockSize) != theReference->fSAD(myFull, kMotionBlockSize, gMotionZeros, kMotionBlockSize)) ||
+		(theKernels->fSATD(gMotionZeros, kMotionBlockSize, myFull, kMotionBlockSize) != theReference->fSATD(gMotionZeros, kMotionBlockSize, myFull, kMotionBlockSize)))
+		return(false);
+
+	return(true);
+}
+
+
+//////////
+//
+// QTCmpr_Hadamard8
+// Apply an 8-point Walsh-Hadamard transform, in place, to 8 values the specified distance apart.
+//
+// The order of the outputs doesn't matter to the SATD, so we don't put them in sequency order.
+//
+//////////
+
+static void QTCmpr_Hadamard8 (long *theValues, long theStride)
+{
+	long						mySpan, myIndex;
+	long						myA, myB;
+
+	for (mySpan = 1; mySpan < 8; mySpan *= 2) {
+		for (myIndex = 0; myIndex < 8; myIndex++) {
+			if (myIndex & mySpan)
+				continue;
+
+			myA = theValues[myIndex * theStride];
+			myB = theValues[(myIndex + mySpan) * theStride];
+			theValues[myIndex * theStride] = myA + myB;
+			theValues[(myIndex + mySpan) * theStride] = myA - myB;
+		}
+	}
+}
+
+
+//////////
+//
+// QTCmpr_SAD8x8_C
+// Return the sum of absolute differences between two 8 by 8 blocks.
+//
+//////////
+
+static long QTCmpr_SAD8x8_C (UInt8 *theBlock, long theRowBytes, UInt8 *theRef, long theRefRowBytes)
+{
+	long						mySum = 0L;
+	long						myRow, myCol;
+
+	for (myRow = 0; myRow < kMotionBlockSize; myRow++) {
+		for (myCol = 0; myCol < kMotionBlockSize; myCol++)
+			mySum += labs((long)theBlock[myCol] - (long)theRef[myCol]);
+
+		theBlock += theRowBytes;
+		theRef += theRefRowBytes;
+	}
+
+	return(mySum);
+}
+
+
+//////////
+//
+// QTCmpr_SATD8x8_C
+// Return the sum of absolute values of the 8 by 8 Hadamard transform of the differences between two blocks.
+//
+//////////
+
+static long QTCmpr_SATD8x8_C (UInt8 *theBlock, long theRowBytes, UInt8 *theRef, long theRefRowBytes)
+{
+	long						myDiffs[kMotionBlockSize * kMotionBlockSize];
+	long						mySum = 0L;
+	long						myRow, myCol;
+
+	for (myRow = 0; myRow < kMotionBlockSize; myRow++)
+		for (myCol = 0; myCol < kMotionBlockSize; myCol++)
+			myDiffs[(myRow * kMotionBlockSize) + myCol] = (long)theBlock[(myRow * theRowBytes) + myCol] - (long)theRef[(myRow * theRefRowBytes) + myCol];
+
+	for (myRow = 0; myRow < kMotionBlockSize; myRow++)
+		QTCmpr_Hadamard8(&myDiffs[myRow * kMotionBlockSize], 1);
+
+	for (myCol = 0; myCol < kMotionBlockSize; myCol++)
+		QTCmpr_Hadamard8(&myDiffs[myCol], kMotionBlockSize);
+
+	for (myRow = 0; myRow < kMotionBlockSize * kMotionBlockSize; myRow++)
+		mySum += labs(myDiffs[myRow]);
+
+	return(mySum);
+}
+
+
+#if USE_SSE2_KERNELS
+//////////
+//
+// QTCmpr_SAD8x8_SSE2
+// Return the sum of absolute differences between two 8 by 8 blocks, 2 rows at a time.
+//
+//////////
+
+static long QTCmpr_SAD8x8_SSE2 (UInt8 *theBlock, long theRowBytes, UInt8 *theRef, long theRefRowBytes)
+{
+	__m128i						mySum = _mm_setzero_si128();
+	__m128i						myRows, myRefRows;
+	long						myRow;
+
+	for (myRow = 0; myRow < kMotionBlockSize; myRow += 2) {
+		myRows = _mm_unpacklo_epi64(_mm_loadl_epi64((__m128i *)(theBlock + (myRow * theRowBytes))), _mm_loadl_epi64((__m128i *)(theBlock + ((myRow + 1) * theRowBytes))));
+		myRefRows = _mm_unpacklo_epi64(_mm_loadl_epi64((__m128i *)(theRef + (myRow * theRefRowBytes))), _mm_loadl_epi64((__m128i *)(theRef + ((myRow + 1) * theRefRowBytes))));
+		mySum = _mm_add_epi64(mySum, _mm_sad_epu8(myRows, myRefRows));
+	}
+
+	return(_mm_cvtsi128_si32(mySum) + _mm_cvtsi128_si32(_mm_srli_si128(mySum, 8)));
+}
+
+
+//////////
+//
+// QTCmpr_SATD8x8_SSE2
+// Return the sum of absolute values of the 8 by 8 Hadamard transform of the differences between two blocks.
+//
+// Each register holds a row of 8 differences; the transform of the columns is done across registers, then the
+// rows are transposed and the same is done again. No value grows beyond 255 * 64, so 16 bits are enough.
+//
+//////////
+
+static long QTCmpr_SATD8x8_SSE2 (UInt8 *theBlock, long theRowBytes, UInt8 *theRef, long theRefRowBytes)
+{
+	__m128i						myZero = _mm_setzero_si128();
+	__m128i						myRows[kMotionBlockSize];
+	__m128i						myTemp[kMotionBlockSize];
+	__m128i						myA, myB, mySum;
+	long						myPass, mySpan, myIndex;
+
+	for (myIndex = 0; myIndex < kMotionBlockSize; myIndex++)
+		myRows[myIndex] = _mm_sub_epi16(_mm_unpacklo_epi8(_mm_loadl_epi64((__m128i *)(theBlock + (myIndex * theRowBytes))), myZero),
+										_mm_unpacklo_epi8(_mm_loadl_epi64((__m128i *)(theRef + (myIndex * theRefRowBytes))), myZero));
+
+	for (myPass = 0; myPass < 2; myPass++) {
+		for (mySpan = 1; mySpan < 8; mySpan *= 2) {
+			for (myIndex = 0; myIndex < 8; myIndex++) {
+				if (myIndex & mySpan)
+					continue;
+
+				myA = myRows[myIndex];
+				myB = myRows[myIndex + mySpan];
+				myRows[myIndex] = _mm_add_epi16(myA, myB);
+				myRows[myIndex + mySpan] = _mm_sub_epi16(myA, myB);
+			}
+		}
+
+		if (myPass > 0)
+			break;
+
+		// transpose the 8 by 8 block of 16-bit values
+		for (myIndex = 0; myIndex < 8; myIndex += 2) {
+			myTemp[myIndex] = _mm_unpacklo_epi16(myRows[myIndex], myRows[myIndex + 1]);
+			myTemp[myIndex + 1] = _mm_unpackhi_epi16(myRows[myIndex], myRows[myIndex + 1]);
+		}
+
+		for (myIndex = 0; myIndex < 8; myIndex += 4) {
+			myRows[myIndex] = _mm_unpacklo_epi32(myTemp[myIndex], myTemp[myIndex + 2]);
+			myRows[myIndex + 1] = _mm_unpackhi_epi32(myTemp[myIndex], myTemp[myIndex + 2]);
+			myRows[myIndex + 2] = _mm_unpacklo_epi32(myTemp[myIndex + 1], myTemp[myIndex + 3]);
+			myRows[myIndex + 3] = _mm_unpackhi_epi32(myTemp[myIndex + 1], myTemp[myIndex + 3]);
+		}
+
+		for (myIndex = 0; myIndex < 4; myIndex++) {
+			myTemp[2 * myIndex] = _mm_unpacklo_epi64(myRows[myIndex], myRows[myIndex + 4]);
+			myTemp[(2 * myIndex) + 1] = _mm_unpackhi_epi64(myRows[myIndex], myRows[myIndex + 4]);
+		}
+
+		for (myIndex = 0; myIndex < 8; myIndex++)
+			myRows[myIndex] = myTemp[myIndex];
+	}
+
+	// add up the absolute values, in 32 bits
+	mySum = myZero;
+	for (myIndex = 0; myIndex < 8; myIndex++) {
+		myA = _mm_max_epi16(myRows[myIndex], _mm_sub_epi16(myZero, myRows[myIndex]));
+		mySum = _mm_add_epi32(mySum, _mm_madd_epi16(myA, _mm_set1_epi16(1)));
+	}
+
+	mySum = _mm_add_epi32(mySum, _mm_srli_si128(mySum, 8));
+	mySum = _mm_add_epi32(mySum, _mm_srli_si128(mySum, 4));
+
+	return(_mm_cvtsi128_si32(mySum));
+}
+#endif	// USE_SSE2_KERNELS
@@ -0,0 +1,132 @@
+//////////
+//
+//	File:		QTCmprMotion.h
+//
+//	Contains:	Block motion estimation between successive frames, for use by QTCompress.
+//
+//	Written by:	Tim Monroe
+//
+//	Copyright:	 2000 by Apple Computer, Inc., all rights reserved.
+//
+//	Change History (most recent first):
+//
+//	   <3>	 	11/13/26	rtm		added QTCmpr_SearchSlice, and the per-slice costs it adds up
+//	   <2>	 	11/07/26	rtm		added QTCmpr_GetLumaSlice
+//	   <1>	 	11/05/26	rtm		first file
+//
+//////////
+
+#pragma once
+
+
+//////////
+//
+// header files
+//
+//////////
+
+#ifndef __QTCmprMotion__
+#define __QTCmprMotion__
+
+#ifndef __MOVIES__
+#include <Movies.h>
+#endif
+
+#include "QTCmprBudget.h"
+#include "QTCmprColor.h"										// for USE_SSE2_KERNELS
+#include "QTCmprSlice.h"
+
+
+//////////
+//
+// constants
+//
+//////////
+
+#define kMotionBlockSize				8						// blocks are 8 by 8 pixels of the half-size luma plane
+#define kMotionSearchRange				16						// the farthest a vector may reach, in half-size pixels
+#define kMotionMaxSteps					8						// the most steps the hexagon search takes
+#define kMotionSceneCutPercent			90						// a frame that predicts this badly from the last one starts a new scene
+#define kMotionNoCost					0x7FFFFFFFL				// the cost of a vector that's out of range
+
+
+//////////
+//
+// data types
+//
+//////////
+
+// a motion vector, in half pixels of the half-size luma plane
+typedef struct MotionVector {
+	short						fX;
+	short						fY;
+} MotionVector, *MotionVectorPtr;
+
+// the routines that measure how much an 8 by 8 block differs from a reference block: the sum of absolute
+// differences (SAD), and the sum of absolute Hadamard-transformed differences (SATD), which follows the cost of
+// coding the difference more closely
+typedef long (*MotionCostProcPtr) (UInt8 *theBlock, long theRowBytes, UInt8 *theRef, long theRefRowBytes);
+
+typedef struct MotionKernels {
+	MotionCostProcPtr			fSAD;
+	MotionCostProcPtr			fSATD;
+	char						*fName;
+} MotionKernels, *MotionKernelsPtr;
+
+// an estimator of the motion between successive frames in a pixel map; it keeps the luma of the last frame, at
+// half size, and the vectors found for it
+typedef struct MotionEstimator {
+	PixMapHandle				fPixMap;
+	long						fBytesPerPixel;
+	long						fRed;								// the offsets of the components in each pixel
+	long						fGreen;
+	long						fBlue;
+	long						fWidth;								// the size of the luma planes
+	long						fHeight;
+	long						fBlocksWide;
+	long						fBlocksHigh;
+	UInt8						*fCurrent;							// the luma of the current frame
+	UInt8						*fPrevious;							// the luma of the last frame
+	MotionVectorPtr				fVectors;							// the vector of each block of the current frame
+	MotionVectorPtr				fLastVectors;						// the vectors of the last frame
+	Boolean						fHasPrevious;
+	long						fInterCost;							// the SATD of the current frame, predicted from the last one
+	long						fIntraCost;							// the SATD of the current frame on its own
+	MotionKernelsPtr			fKernels;							// the block routines the slices use
+	long						fSliceInterCost[kSliceMaxThreads];	// each slice's share of fInterCost and fIntraCost
+	long						fSliceIntraCost[kSliceMaxThreads];
+	long						fNumFrames;
+	long						fNumSceneCuts;
+	double						fCostPercent;						// the sum of fInterCost as a percentage of fIntraCost
+	double						fEstimateTime;						// microseconds spent estimating motion
+	long						fSize;								// the number of bytes reserved
+	MemoryJobPtr				fJob;
+} MotionEstimator, *MotionEstimatorPtr;
+
+
+//////////
+//
+// function prototypes
+//
+//////////
+
+OSErr							QTCmpr_NewMotionEstimator (MotionEstimatorPtr theEstimator, PixMapHandle thePixMap, MemoryJobPtr theJob);
+Boolean							QTCmpr_EstimateMotion (MotionEstimatorPtr theEstimator);
+void							QTCmpr_DisposeMotionEstimator (MotionEstimatorPtr theEstimator);
+static void						QTCmpr_GetLumaPlane (MotionEstimatorPtr theEstimator);
+static void						QTCmpr_GetLumaSlice (void *theRefCon, long theSlice, long theTop, long theBottom);
+static void						QTCmpr_SearchSlice (void *theRefCon, long theSlice, long theTop, long theBottom);
+static void						QTCmpr_SearchBlock (MotionEstimatorPtr theEstimator, long theSlice, long theBlockX, long theBlockY, long theFirstBlockY);
+static long						QTCmpr_GetVectorCost (MotionEstimatorPtr theEstimator, MotionCostProcPtr theCostProc, long theX, long theY, long theVectorX, long theVectorY);
+static UInt8					*QTCmpr_GetReferenceBlock (MotionEstimatorPtr theEstimator, long theX, long theY, long theVectorX, long theVectorY, UInt8 *theBlock, long *theRowBytes);
+static MotionKernelsPtr			QTCmpr_GetMotionKernels (void);
+static Boolean					QTCmpr_CheckMotionKernels (MotionKernelsPtr theKernels, MotionKernelsPtr theReference);
+static void						QTCmpr_Hadamard8 (long *theValues, long theStride);
+static long						QTCmpr_SAD8x8_C (UInt8 *theBlock, long theRowBytes, UInt8 *theRef, long theRefRowBytes);
+static long						QTCmpr_SATD8x8_C (UInt8 *theBlock, long theRowBytes, UInt8 *theRef, long theRefRowBytes);
+#if USE_SSE2_KERNELS
+static long						QTCmpr_SAD8x8_SSE2 (UInt8 *theBlock, long theRowBytes, UInt8 *theRef, long theRefRowBytes);
+static long						QTCmpr_SATD8x8_SSE2 (UInt8 *theBlock, long theRowBytes, UInt8 *theRef, long theRefRowBytes);
+#endif
+
+#endif	// __QTCmprMotion__
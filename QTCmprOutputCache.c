@@ -0,0 +1,769 @@
+//////////
+//
+//	File:		QTCmprOutputCache.c
+//
+//	Contains:	A cache of compressed images and movie files, keyed by the content of their sources and the settings
+//				they were compressed with, for use by QTCompress.
+//
+//	Written by:	Tim Monroe
+//
+//	Copyright:	 2000 by Apple Computer, Inc., all rights reserved.
+//
+//	Change History (most recent first):
+//
+//	   <3>	 	11/13/26	rtm		moved the SHA-256 routines to QTCmprHash.c
+//	   <2>	 	11/10/26	rtm		made the SHA-256 routines public, for the sample store
+//	   <1>	 	11/09/26	rtm		first file
+//
+//	Build scripts tend to compress the same images and movies with the same settings over and over. If a cache
+//	directory is named in the environment (see QTCmpr_GetOutputCacheDir), we keep a copy of each compressed image
+//	and each finished movie file there, and the next time the same source is compressed the same way, we hand
+//	back the copy instead of compressing anything.
+//
+//	An entry is named by a SHA-256 digest of everything that determines the output: the content of the source
+//	file (and, for a movie, of every file its media refer to), the compression settings (as a flattened atom
+//	container, from SCGetSettingsAsAtomContainer), the part of the source compressed and the size it's compressed
+//	at, the version of QuickTime, and kOutputCacheVersion. We read every byte of the sources to work out the
+//	digest, but that costs much less than decoding and compressing them; and since the digest depends on the
+//	content and not on names or dates, a source that's copied or touched still finds its entry. A source we can't
+//	read all of (a movie whose data isn't in files, say) isn't cached.
+//
+//	Each entry is a file holding a header, the image description (for an image), and the compressed data or movie
+//	file; an index file lists the entries, their sizes, and when each was last used. Whenever an entry is added or
+//	used, we throw away the least recently used entries until the rest fit in the size limit. Entries and the index
+//	are written under temporary names and then renamed, so a compression that fails part way never leaves a partial
+//	entry; an entry that doesn't hold what its header promises is simply ignored.
+//
+//	Like checkpoint files, the cache files are written in native byte order, for use on the same machine. The cache
+//	isn't locked; if two copies of QTCompress share a cache directory, one may forget the other's entries, which
+//	then stay on disk until the directory is cleared.
+//
+//////////
+
+//////////
+//
+// header files
+//
+//////////
+
+#include "QTCompress.h"
+
+
+//////////
+//
+// QTCmpr_GetOutputCacheKey
+// Work out the key of the cache entry for the output described by theParams, compressed from the specified source
+// file (or from the specified movie, which was opened from that file) with the settings in the specified Standard
+// Compression component.
+//
+// Return false if there is no cache, or if the source can't be read.
+//
+//////////
+
+Boolean QTCmpr_GetOutputCacheKey (OutputCacheKeyPtr theKey, OutputCacheParamsPtr theParams, FSSpec *theSrcFile, Movie theSrcMovie, ComponentInstance theComponent)
+{
+	HashState					myHash;
+	QTAtomContainer				mySettings = NULL;
+	Ptr							myBuffer = NULL;
+	long						myMegabytes = 0L;
+	long						myValue;
+	Boolean						myIsValid = false;
+
+	if ((theKey == NULL) || (theParams == NULL) || (theSrcFile == NULL) || (theComponent == NULL))
+		return(false);
+
+	theKey->fDir = QTCmpr_GetOutputCacheDir(&myMegabytes);
+	if ((theKey->fDir == NULL) || (strlen(theKey->fDir) > kOutputCacheMaxPath - (2 * kHashDigestSize) - 16))
+		return(false);
+
+	theKey->fKind = theParams->fKind;
+	theKey->fMaxSize = (double)myMegabytes * 1024.0 * 1024.0;
+
+	myBuffer = NewPtr(kOutputCacheBufferSize);
+	if (myBuffer == NULL)
+		goto bail;
+
+	if (SCGetSettingsAsAtomContainer(theComponent, &mySettings) != noErr) {
+		mySettings = NULL;
+		goto bail;
+	}
+
+	QTCmpr_BeginHash(&myHash);
+
+	// the kind of output and the way it's made, and the version of QuickTime, which supplies the compressors
+	myValue = kOutputCacheVersion;
+	QTCmpr_AddToHash(&myHash, &myValue, sizeof(myValue));
+	QTCmpr_AddToHash(&myHash, &theParams->fKind, sizeof(theParams->fKind));
+	QTCmpr_AddToHash(&myHash, &theParams->fSrcRect, sizeof(theParams->fSrcRect));
+	QTCmpr_AddToHash(&myHash, &theParams->fDstRect, sizeof(theParams->fDstRect));
+	QTCmpr_AddToHash(&myHash, &theParams->fFilter, sizeof(theParams->fFilter));
+
+	myValue = 0L;
+	Gestalt(gestaltQuickTime, &myValue);
+	QTCmpr_AddToHash(&myHash, &myValue, sizeof(myValue));
+
+	// the settings
+	myValue = GetHandleSize(mySettings);
+	QTCmpr_AddToHash(&myHash, &myValue, sizeof(myValue));
+	HLock(mySettings);
+	QTCmpr_AddToHash(&myHash, *mySettings, myValue);
+	HUnlock(mySettings);
+
+	// the source
+	if (theSrcMovie != NULL) {
+		if (!QTCmpr_HashMovieSources(&myHash, theSrcMovie, theSrcFile, myBuffer))
+			goto bail;
+	} else {
+		if (QTCmpr_HashFile(&myHash, theSrcFile, myBuffer) != noErr)
+			goto bail;
+	}
+
+	QTCmpr_EndHash(&myHash, theKey->fDigest);
+	myIsValid = true;
+
+bail:
+	if (mySettings != NULL)
+		QTDisposeAtomContainer(mySettings);
+
+	if (myBuffer != NULL)
+		DisposePtr(myBuffer);
+
+	return(myIsValid);
+}
+
+
+//////////
+//
+// QTCmpr_LoadCachedImage
+// Return the compressed data and image description of the cached image with the specified key; the caller
+// disposes of them.
+//
+// Return fnfErr if there is no such image in the cache.
+//
+//////////
+
+OSErr QTCmpr_LoadCachedImage (OutputCacheKeyPtr theKey, Handle *theData, ImageDescriptionHandle *theDesc)
+{
+	OutputCacheHeader			myHeader;
+	FILE						*myFile = NULL;
+	Handle						myData = NULL;
+	Handle						myDesc = NULL;
+	OSErr						myErr = noErr;
+
+	if ((theKey == NULL) || (theData == NULL) || (theDesc == NULL))
+		return(paramErr);
+
+	*theData = NULL;
+	*theDesc = NULL;
+
+	myFile = QTCmpr_OpenCacheEntry(theKey, &myHeader);
+	if (myFile == NULL)
+		return(fnfErr);
+
+	if (myHeader.fDescSize < (long)sizeof(ImageDescription)) {
+		myErr = badFileFormat;
+		goto bail;
+	}
+
+	myDesc = NewHandle(myHeader.fDescSize);
+	myData = NewHandle(myHeader.fDataSize);
+	if ((myDesc == NULL) || (myData == NULL)) {
+		myErr = memFullErr;
+		goto bail;
+	}
+
+	HLock(myDesc);
+	HLock(myData);
+
+	if ((fread(*myDesc, 1, (size_t)myHeader.fDescSize, myFile) != (size_t)myHeader.fDescSize) ||
+		(fread(*myData, 1, (size_t)myHeader.fDataSize, myFile) != (size_t)myHeader.fDataSize))
+		myErr = ioErr;
+
+	HUnlock(myDesc);
+	HUnlock(myData);
+
+	if (myErr != noErr)
+		goto bail;
+
+	*theDesc = (ImageDescriptionHandle)myDesc;
+	*theData = myData;
+	myDesc = NULL;
+	myData = NULL;
+
+	QTCmpr_UseCacheEntry(theKey, sizeof(myHeader) + myHeader.fDescSize + myHeader.fDataSize);
+	QTCmpr_LogMessage("QTCmpr_LoadCachedImage: using the cached image (%ld bytes)", myHeader.fDataSize);
+
+bail:
+	fclose(myFile);
+
+	if (myDesc != NULL)
+		DisposeHandle(myDesc);
+
+	if (myData != NULL)
+		DisposeHandle(myData);
+
+	return(myErr);
+}
+
+
+//////////
+//
+// QTCmpr_CacheImage
+// Add a compressed image, with the specified key, to the cache.
+//
+//////////
+
+OSErr QTCmpr_CacheImage (OutputCacheKeyPtr theKey, Handle theData, ImageDescriptionHandle theDesc)
+{
+	FILE						*myFile = NULL;
+	long						myDescSize;
+	long						myDataSize;
+	Boolean						myIsWritten;
+
+	if ((theKey == NULL) || (theData == NULL) || (theDesc == NULL))
+		return(paramErr);
+
+	myDescSize = GetHandleSize((Handle)theDesc);
+	myDataSize = (**theDesc).dataSize;
+	if ((myDescSize < (long)sizeof(ImageDescription)) || (myDataSize > GetHandleSize(theData)))
+		return(paramErr);
+
+	myFile = QTCmpr_CreateCacheEntry(theKey, myDescSize, myDataSize);
+	if (myFile == NULL)
+		return(ioErr);
+
+	HLock((Handle)theDesc);
+	HLock(theData);
+
+	myIsWritten = (fwrite(*theDesc, 1, (size_t)myDescSize, myFile) == (size_t)myDescSize) &&
+					(fwrite(*theData, 1, (size_t)myDataSize, myFile) == (size_t)myDataSize);
+
+	HUnlock((Handle)theDesc);
+	HUnlock(theData);
+
+	return(QTCmpr_CommitCacheEntry(theKey, myFile, myIsWritten));
+}
+
+
+//////////
+//
+// QTCmpr_CopyCachedMovie
+// Create the specified movie file, as a copy of the cached movie file with the specified key.
+//
+// Return fnfErr if there is no such movie file in the cache. The movie file must not exist already.
+//
+//////////
+
+OSErr QTCmpr_CopyCachedMovie (OutputCacheKeyPtr theKey, FSSpec *theFile)
+{
+	OutputCacheHeader			myHeader;
+	FILE						*myFile = NULL;
+	Ptr							myBuffer = NULL;
+	short						myRefNum = -1;
+	Boolean						myIsCreated = false;
+	long						myLeft;
+	long						myCount;
+	OSErr						myErr = noErr;
+
+	if ((theKey == NULL) || (theFile == NULL))
+		return(paramErr);
+
+	myFile = QTCmpr_OpenCacheEntry(theKey, &myHeader);
+	if (myFile == NULL)
+		return(fnfErr);
+
+	myBuffer = NewPtr(kOutputCacheBufferSize);
+	if (myBuffer == NULL) {
+		myErr = memFullErr;
+		goto bail;
+	}
+
+	myErr = FSpCreate(theFile, sigMoviePlayer, MovieFileType, smSystemScript);
+	if (myErr != noErr)
+		goto bail;
+
+	myIsCreated = true;
+
+	myErr = FSpOpenDF(theFile, fsRdWrPerm, &myRefNum);
+	if (myErr != noErr) {
+		myRefNum = -1;
+		goto bail;
+	}
+
+	myLeft = myHeader.fDataSize;
+	while ((myErr == noErr) && (myLeft > 0L)) {
+		myCount = (myLeft < kOutputCacheBufferSize) ? myLeft : kOutputCacheBufferSize;
+		if (fread(myBuffer, 1, (size_t)myCount, myFile) != (size_t)myCount) {
+			myErr = ioErr;
+			break;
+		}
+
+		myErr = FSWrite(myRefNum, &myCount, myBuffer);
+		myLeft -= myCount;
+	}
+
+	if (myErr == noErr)
+		myErr = SetEOF(myRefNum, myHeader.fDataSize);
+
+bail:
+	fclose(myFile);
+
+	if (myRefNum != -1)
+		FSClose(myRefNum);
+
+	if (myBuffer != NULL)
+		DisposePtr(myBuffer);
+
+	if (myErr == noErr) {
+		QTCmpr_UseCacheEntry(theKey, sizeof(myHeader) + myHeader.fDataSize);
+		QTCmpr_LogMessage("QTCmpr_CopyCachedMovie: using the cached movie file (%ld bytes)", myHeader.fDataSize);
+	} else if (myIsCreated) {
+		FSpDelete(theFile);
+	}
+
+	return(myErr);
+}
+
+
+//////////
+//
+// QTCmpr_CacheMovie
+// Add a copy of the specified (finished and closed) movie file, with the specified key, to the cache.
+//
+// A movie file bigger than the whole cache isn't added; it would only push everything else out.
+//
+//////////
+
+OSErr QTCmpr_CacheMovie (OutputCacheKeyPtr theKey, FSSpec *theFile)
+{
+	FILE						*myFile = NULL;
+	Ptr							myBuffer = NULL;
+	short						myRefNum = -1;
+	long						mySize = 0L;
+	long						myLeft;
+	long						myCount;
+	OSErr						myErr = noErr;
+
+	if ((theKey == NULL) || (theFile == NULL))
+		return(paramErr);
+
+	myErr = FSpOpenDF(theFile, fsRdPerm, &myRefNum);
+	if (myErr != noErr)
+		return(myErr);
+
+	myErr = GetEOF(myRefNum, &mySize);
+	if ((myErr != noErr) || ((double)mySize > theKey->fMaxSize))
+		goto bail;
+
+	myErr = SetFPos(myRefNum, fsFromStart, 0L);
+	if (myErr != noErr)
+		goto bail;
+
+	myBuffer = NewPtr(kOutputCacheBufferSize);
+	if (myBuffer == NULL) {
+		myErr = memFullErr;
+		goto bail;
+	}
+
+	myFile = QTCmpr_CreateCacheEntry(theKey, 0L, mySize);
+	if (myFile == NULL) {
+		myErr = ioErr;
+		goto bail;
+	}
+
+	myLeft = mySize;
+	while ((myErr == noErr) && (myLeft > 0L)) {
+		myCount = (myLeft < kOutputCacheBufferSize) ? myLeft : kOutputCacheBufferSize;
+		myErr = FSRead(myRefNum, &myCount, myBuffer);
+		if ((myErr == noErr) && (fwrite(myBuffer, 1, (size_t)myCount, myFile) != (size_t)myCount))
+			myErr = ioErr;
+
+		myLeft -= myCount;
+	}
+
+	myErr = QTCmpr_CommitCacheEntry(theKey, myFile, myErr == noErr);
+
+bail:
+	FSClose(myRefNum);
+
+	if (myBuffer != NULL)
+		DisposePtr(myBuffer);
+
+	return(myErr);
+}
+
+
+//////////
+//
+// QTCmpr_HashMovieSources
+// Add the content of the specified movie file, and of every other file that the movie's media refer to, to a digest.
+//
+// Return false if some media data isn't in a file we can find.
+//
+//////////
+
+static Boolean QTCmpr_HashMovieSources (HashStatePtr theHash, Movie theMovie, FSSpec *theMovieFile, Ptr theBuffer)
+{
+	FSSpec						mySources[kOutputCacheMaxSources];
+	long						myNumSources = 0L;
+	FSSpec						mySpec;
+	Media						myMedia;
+	Handle						myDataRef = NULL;
+	OSType						myDataRefType;
+	long						myAttributes;
+	short						myNumDataRefs;
+	Boolean						myWasChanged;
+	long						myTrack, myIndex, mySource;
+	OSErr						myErr = noErr;
+
+	mySources[myNumSources++] = *theMovieFile;
+
+	for (myTrack = 1; myTrack <= GetMovieTrackCount(theMovie); myTrack++) {
+		myMedia = GetTrackMedia(GetMovieIndTrack(theMovie, myTrack));
+		if ((myMedia == NULL) || (GetMediaDataRefCount(myMedia, &myNumDataRefs) != noErr))
+			return(false);
+
+		for (myIndex = 1; myIndex <= myNumDataRefs; myIndex++) {
+			if (GetMediaDataRef(myMedia, (short)myIndex, &myDataRef, &myDataRefType, &myAttributes) != noErr)
+				return(false);
+
+			// we can only follow references to files
+			myErr = paramErr;
+			if (myDataRefType == rAliasType)
+				myErr = ResolveAlias(NULL, (AliasHandle)myDataRef, &mySpec, &myWasChanged);
+
+			DisposeHandle(myDataRef);
+			if (myErr != noErr)
+				return(false);
+
+			for (mySource = 0L; mySource < myNumSources; mySource++)
+				if ((mySources[mySource].vRefNum == mySpec.vRefNum) && (mySources[mySource].parID == mySpec.parID) &&
+					EqualString(mySources[mySource].name, mySpec.name, false, true))
+					break;
+
+			if (mySource == myNumSources) {
+				if (myNumSources == kOutputCacheMaxSources)
+					return(false);
+
+				mySources[myNumSources++] = mySpec;
+			}
+		}
+	}
+
+	for (mySource = 0L; mySource < myNumSources; mySource++)
+		if (QTCmpr_HashFile(theHash, &mySources[mySource], theBuffer) != noErr)
+			return(false);
+
+	return(true);
+}
+
+
+//////////
+//
+// QTCmpr_HashFile
+// Add the size and content of the data fork of the specified file to a digest.
+//
+//////////
+
+static OSErr QTCmpr_HashFile (HashStatePtr theHash, FSSpec *theFile, Ptr theBuffer)
+{
+	short						myRefNum = -1;
+	long						mySize = 0L;
+	long						myCount;
+	OSErr						myErr = noErr;
+
+	myErr = FSpOpenDF(theFile, fsRdPerm, &myRefNum);
+	if (myErr != noErr)
+		return(myErr);
+
+	myErr = GetEOF(myRefNum, &mySize);
+	if (myErr == noErr)
+		myErr = SetFPos(myRefNum, fsFromStart, 0L);
+
+	QTCmpr_AddToHash(theHash, &mySize, sizeof(mySize));
+
+	while ((myErr == noErr) && (mySize > 0L)) {
+		myCount = (mySize < kOutputCacheBufferSize) ? mySize : kOutputCacheBufferSize;
+		myErr = FSRead(myRefNum, &myCount, theBuffer);
+		if (myErr == noErr)
+			QTCmpr_AddToHash(theHash, theBuffer, myCount);
+
+		mySize -= myCount;
+	}
+
+	FSClose(myRefNum);
+
+	return(myErr);
+}
+
+
+//////////
+//
+// QTCmpr_OpenCacheEntry
+// Open the entry with the specified key, read its header, and leave the file positioned just after the header.
+//
+// Return NULL if there is no such entry, or if it's not complete.
+//
+//////////
+
+static FILE *QTCmpr_OpenCacheEntry (OutputCacheKeyPtr theKey, OutputCacheHeaderPtr theHeader)
+{
+	char						myPath[kOutputCacheMaxPath];
+	FILE						*myFile = NULL;
+
+	QTCmpr_GetCachePath(theKey, theKey->fDigest, kOutputCacheEntrySuffix, myPath);
+
+	myFile = fopen(myPath, "rb");
+	if (myFile == NULL)
+		return(NULL);
+
+	if ((fread(theHeader, sizeof(*theHeader), 1, myFile) != 1) ||
+		(theHeader->fSignature != kOutputCacheSignature) || (theHeader->fVersion != kOutputCacheVersion) ||
+		(theHeader->fKind != theKey->fKind) || (memcmp(theHeader->fDigest, theKey->fDigest, kHashDigestSize) != 0) ||
+		(theHeader->fDescSize < 0L) || (theHeader->fDataSize < 0L) ||
+		(fseek(myFile, 0L, SEEK_END) != 0) ||
+		(ftell(myFile) != (long)sizeof(*theHeader) + theHeader->fDescSize + theHeader->fDataSize) ||
+		(fseek(myFile, sizeof(*theHeader), SEEK_SET) != 0)) {
+		fclose(myFile);
+		return(NULL);
+	}
+
+	return(myFile);
+}
+
+
+//////////
+//
+// QTCmpr_CreateCacheEntry
+// Begin writing the entry with the specified key, and write its header; the caller writes the image description and
+// data, and then calls QTCmpr_CommitCacheEntry.
+//
+//////////
+
+static FILE *QTCmpr_CreateCacheEntry (OutputCacheKeyPtr theKey, long theDescSize, long theDataSize)
+{
+	OutputCacheHeader			myHeader;
+	char						myPath[kOutputCacheMaxPath];
+	FILE						*myFile = NULL;
+
+	QTCmpr_GetCachePath(theKey, theKey->fDigest, kOutputCacheTempSuffix, myPath);
+
+	myFile = fopen(myPath, "wb");
+	if (myFile == NULL)
+		return(NULL);
+
+	myHeader.fSignature = kOutputCacheSignature;
+	myHeader.fVersion = kOutputCacheVersion;
+	myHeader.fKind = theKey->fKind;
+	BlockMoveData(theKey->fDigest, myHeader.fDigest, kHashDigestSize);
+	myHeader.fDescSize = theDescSize;
+	myHeader.fDataSize = theDataSize;
+
+	if (fwrite(&myHeader, sizeof(myHeader), 1, myFile) != 1) {
+		fclose(myFile);
+		remove(myPath);
+		return(NULL);
+	}
+
+	return(myFile);
+}
+
+
+//////////
+//
+// QTCmpr_CommitCacheEntry
+// Close an entry begun by QTCmpr_CreateCacheEntry and, if theKeep is true, put it in place of any existing entry with
+// the same key; otherwise, throw it away.
+//
+//////////
+
+static OSErr QTCmpr_CommitCacheEntry (OutputCacheKeyPtr theKey, FILE *theFile, Boolean theKeep)
+{
+	char						myPath[kOutputCacheMaxPath];
+	char						myTempPath[kOutputCacheMaxPath];
+	long						mySize;
+
+	QTCmpr_GetCachePath(theKey, theKey->fDigest, kOutputCacheEntrySuffix, myPath);
+	QTCmpr_GetCachePath(theKey, theKey->fDigest, kOutputCacheTempSuffix, myTempPath);
+
+	mySize = ftell(theFile);
+	if (fclose(theFile) != 0)
+		theKeep = false;
+
+	if (!theKeep) {
+		remove(myTempPath);
+		return(ioErr);
+	}
+
+	// rename won't replace an existing file everywhere
+	remove(myPath);
+	if (rename(myTempPath, myPath) != 0) {
+		remove(myTempPath);
+		return(ioErr);
+	}
+
+	QTCmpr_UseCacheEntry(theKey, mySize);
+
+	return(noErr);
+}
+
+
+//////////
+//
+// QTCmpr_UseCacheEntry
+// Record in the index that the entry with the specified key, of the specified size, was just used (or added), and
+// throw away the least recently used entries until the rest fit in the cache.
+//
+// An index that's missing or damaged is replaced by a new one.
+//
+//////////
+
+static void QTCmpr_UseCacheEntry (OutputCacheKeyPtr theKey, long theSize)
+{
+	OutputCacheIndexHeader		myHeader;
+	OutputCacheRecordPtr		myRecords = NULL;
+	char						myPath[kOutputCacheMaxPath];
+	char						myTempPath[kOutputCacheMaxPath];
+	char						myEntryPath[kOutputCacheMaxPath];
+	FILE						*myFile = NULL;
+	long						myFileSize = 0L;
+	double						myTotalSize = 0.0;
+	long						myCurrent = -1L;
+	long						myOldest;
+	long						myIndex;
+
+	QTCmpr_GetCachePath(theKey, NULL, "", myPath);
+	QTCmpr_GetCachePath(theKey, NULL, kOutputCacheTempSuffix, myTempPath);
+
+	//////////
+	//
+	// read the index
+	//
+	//////////
+
+	myFile = fopen(myPath, "rb");
+	if ((myFile != NULL) && (fseek(myFile, 0L, SEEK_END) == 0)) {
+		myFileSize = ftell(myFile);
+		fseek(myFile, 0L, SEEK_SET);
+	}
+
+	if ((myFile == NULL) || (fread(&myHeader, sizeof(myHeader), 1, myFile) != 1) ||
+		(myHeader.fSignature != kOutputCacheSignature) || (myHeader.fVersion != kOutputCacheVersion) || (myHeader.fNumRecords < 0L) ||
+		(myHeader.fNumRecords > (myFileSize - (long)sizeof(myHeader)) / (long)sizeof(OutputCacheRecord))) {
+		myHeader.fSignature = kOutputCacheSignature;
+		myHeader.fVersion = kOutputCacheVersion;
+		myHeader.fClock = 0L;
+		myHeader.fNumRecords = 0L;
+	}
+
+	myRecords = (OutputCacheRecordPtr)NewPtr((myHeader.fNumRecords + 1) * sizeof(OutputCacheRecord));
+	if (myRecords == NULL)
+		goto bail;
+
+	if ((myFile != NULL) && (myHeader.fNumRecords > 0L))
+		if (fread(myRecords, sizeof(OutputCacheRecord), (size_t)myHeader.fNumRecords, myFile) != (size_t)myHeader.fNumRecords)
+			myHeader.fNumRecords = 0L;
+
+	if (myFile != NULL)
+		fclose(myFile);
+	myFile = NULL;
+
+	//////////
+	//
+	// make the entry the most recently used one
+	//
+	//////////
+
+	myHeader.fClock++;
+
+	for (myIndex = 0L; myIndex < myHeader.fNumRecords; myIndex++)
+		if (memcmp(myRecords[myIndex].fDigest, theKey->fDigest, kHashDigestSize) == 0)
+			myCurrent = myIndex;
+
+	if (myCurrent == -1L) {
+		myCurrent = myHeader.fNumRecords++;
+		BlockMoveData(theKey->fDigest, myRecords[myCurrent].fDigest, kHashDigestSize);
+	}
+
+	myRecords[myCurrent].fSize = theSize;
+	myRecords[myCurrent].fLastUse = myHeader.fClock;
+
+	//////////
+	//
+	// throw away the least recently used entries until the rest fit
+	//
+	//////////
+
+	for (myIndex = 0L; myIndex < myHeader.fNumRecords; myIndex++)
+		myTotalSize += myRecords[myIndex].fSize;
+
+	while ((myTotalSize > theKey->fMaxSize) && (myHeader.fNumRecords > 1L)) {
+		myOldest = (myCurrent == 0L) ? 1L : 0L;
+		for (myIndex = 0L; myIndex < myHeader.fNumRecords; myIndex++)
+			if ((myIndex != myCurrent) && (myRecords[myIndex].fLastUse < myRecords[myOldest].fLastUse))
+				myOldest = myIndex;
+
+		QTCmpr_GetCachePath(theKey, myRecords[myOldest].fDigest, kOutputCacheEntrySuffix, myEntryPath);
+		remove(myEntryPath);
+
+		myTotalSize -= myRecords[myOldest].fSize;
+		myRecords[myOldest] = myRecords[--myHeader.fNumRecords];
+		if (myCurrent == myHeader.fNumRecords)
+			myCurrent = myOldest;
+	}
+
+	//////////
+	//
+	// write the new index
+	//
+	//////////
+
+	myFile = fopen(myTempPath, "wb");
+	if (myFile == NULL)
+		goto bail;
+
+	if ((fwrite(&myHeader, sizeof(myHeader), 1, myFile) != 1) ||
+		(fwrite(myRecords, sizeof(OutputCacheRecord), (size_t)myHeader.fNumRecords, myFile) != (size_t)myHeader.fNumRecords) ||
+		(fclose(myFile) != 0)) {
+		remove(myTempPath);
+		myFile = NULL;
+		goto bail;
+	}
+
+	myFile = NULL;
+
+	remove(myPath);
+	if (rename(myTempPath, myPath) != 0)
+		remove(myTempPath);
+
+bail:
+	if (myFile != NULL)
+		fclose(myFile);
+
+	if (myRecords != NULL)
+		DisposePtr((Ptr)myRecords);
+}
+
+
+//////////
+//
+// QTCmpr_GetCachePath
+// Make the path of the cache file named by the specified digest (in hexadecimal), or of the index if theDigest is
+// NULL, with the specified suffix.
+//
+//////////
+
+static void QTCmpr_GetCachePath (OutputCacheKeyPtr theKey, UInt8 *theDigest, char *theSuffix, char *thePath)
+{
+	char						myName[(2 * kHashDigestSize) + 1];
+	long						myIndex;
+
+	if (theDigest == NULL) {
+		strcpy(myName, kOutputCacheIndexName);
+	} else {
+		for (myIndex = 0L; myIndex < kHashDigestSize; myIndex++)
+			sprintf(&myName[2 * myIndex], "%02x", theDigest[myIndex]);
+	}
+
+	sprintf(thePath, "%s%s%s%s", theKey->fDir, kOutputCachePathSeparator, myName, theSuffix);
+}
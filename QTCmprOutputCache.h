@@ -0,0 +1,138 @@
+//////////
+//
+//	File:		QTCmprOutputCache.h
+//
+//	Contains:	A cache of compressed images and movie files, keyed by the content of their sources and the settings
+//				they were compressed with, for use by QTCompress.
+//
+//	Written by:	Tim Monroe
+//
+//	Copyright:	 2000 by Apple Computer, Inc., all rights reserved.
+//
+//	Change History (most recent first):
+//
+//	   <3>	 	11/13/26	rtm		moved the SHA-256 routines to QTCmprHash.c
+//	   <2>	 	11/10/26	rtm		made the SHA-256 routines public, for the sample store
+//	   <1>	 	11/09/26	rtm		first file
+//
+//////////
+
+#pragma once
+
+
+//////////
+//
+// header files
+//
+//////////
+
+#ifndef __QTCmprOutputCache__
+#define __QTCmprOutputCache__
+
+#ifndef __MOVIES__
+#include <Movies.h>
+#endif
+
+#ifndef __QUICKTIMECOMPONENTS__
+#include <QuickTimeComponents.h>
+#endif
+
+#include <stdio.h>
+
+#include "QTCmprHash.h"											// for the SHA-256 digest
+
+
+//////////
+//
+// constants
+//
+//////////
+
+#define kOutputCacheSignature			FOUR_CHAR_CODE('QTOc')	// the start of each cache file
+#define kOutputCacheVersion				1L						// change this whenever the same settings would give different output
+#define kOutputCacheImage				FOUR_CHAR_CODE('imag')	// the kinds of output we cache: a compressed image,
+#define kOutputCacheMovie				FOUR_CHAR_CODE('moov')	// or a movie file
+#define kOutputCacheMaxPath				1024					// the longest path of a cache file
+#define kOutputCacheMaxSources			64						// the most files a source movie may refer to
+#define kOutputCacheBufferSize			(64L * 1024L)			// the size of the buffer we read and copy files with
+#define kOutputCacheDefaultMegabytes	1024L					// the size of the cache, unless the environment says otherwise
+#define kOutputCacheIndexName			"index"					// the name of the file listing the entries
+#define kOutputCacheEntrySuffix			".qtc"					// appended to the digest (in hexadecimal) to get an entry's name
+#define kOutputCacheTempSuffix			".tmp"					// appended to a file's name while it's written
+
+#if TARGET_OS_WIN32
+#define kOutputCachePathSeparator		"\\"
+#else
+#define kOutputCachePathSeparator		"/"
+#endif
+
+
+//////////
+//
+// data types
+//
+//////////
+
+// what, besides its source and the compression settings, determines a compressed image or movie
+typedef struct OutputCacheParams {
+	OSType						fKind;								// kOutputCacheImage or kOutputCacheMovie
+	Rect						fSrcRect;							// the part of the source that's compressed
+	Rect						fDstRect;							// the size it's compressed at
+	long						fFilter;							// the filter it's resized with, if fDstRect isn't the size of fSrcRect
+} OutputCacheParams, *OutputCacheParamsPtr;
+
+// the key of a cache entry
+typedef struct OutputCacheKey {
+	OSType						fKind;
+	UInt8						fDigest[kHashDigestSize];		// the SHA-256 digest of the sources, settings, and parameters
+	char						*fDir;								// the cache directory
+	double						fMaxSize;							// the most bytes the entries may take up
+} OutputCacheKey, *OutputCacheKeyPtr;
+
+// the header of a cache entry; it's followed by the image description (of an image) and the compressed data (or
+// the movie file)
+typedef struct OutputCacheHeader {
+	OSType						fSignature;							// kOutputCacheSignature
+	long						fVersion;							// kOutputCacheVersion
+	OSType						fKind;
+	UInt8						fDigest[kHashDigestSize];
+	long						fDescSize;
+	long						fDataSize;
+} OutputCacheHeader, *OutputCacheHeaderPtr;
+
+// the header of the index file; it's followed by a record for each entry
+typedef struct OutputCacheIndexHeader {
+	OSType						fSignature;							// kOutputCacheSignature
+	long						fVersion;							// kOutputCacheVersion
+	UInt32						fClock;								// incremented each time an entry is used
+	long						fNumRecords;
+} OutputCacheIndexHeader, *OutputCacheIndexHeaderPtr;
+
+// a record in the index file
+typedef struct OutputCacheRecord {
+	UInt8						fDigest[kHashDigestSize];
+	long						fSize;								// the size of the entry file
+	UInt32						fLastUse;							// the value of the index's clock when the entry was last used
+} OutputCacheRecord, *OutputCacheRecordPtr;
+
+
+//////////
+//
+// function prototypes
+//
+//////////
+
+Boolean							QTCmpr_GetOutputCacheKey (OutputCacheKeyPtr theKey, OutputCacheParamsPtr theParams, FSSpec *theSrcFile, Movie theSrcMovie, ComponentInstance theComponent);
+OSErr							QTCmpr_LoadCachedImage (OutputCacheKeyPtr theKey, Handle *theData, ImageDescriptionHandle *theDesc);
+OSErr							QTCmpr_CacheImage (OutputCacheKeyPtr theKey, Handle theData, ImageDescriptionHandle theDesc);
+OSErr							QTCmpr_CopyCachedMovie (OutputCacheKeyPtr theKey, FSSpec *theFile);
+OSErr							QTCmpr_CacheMovie (OutputCacheKeyPtr theKey, FSSpec *theFile);
+static Boolean					QTCmpr_HashMovieSources (HashStatePtr theHash, Movie theMovie, FSSpec *theMovieFile, Ptr theBuffer);
+static OSErr					QTCmpr_HashFile (HashStatePtr theHash, FSSpec *theFile, Ptr theBuffer);
+static FILE						*QTCmpr_OpenCacheEntry (OutputCacheKeyPtr theKey, OutputCacheHeaderPtr theHeader);
+static FILE						*QTCmpr_CreateCacheEntry (OutputCacheKeyPtr theKey, long theDescSize, long theDataSize);
+static OSErr					QTCmpr_CommitCacheEntry (OutputCacheKeyPtr theKey, FILE *theFile, Boolean theKeep);
+static void						QTCmpr_UseCacheEntry (OutputCacheKeyPtr theKey, long theSize);
+static void						QTCmpr_GetCachePath (OutputCacheKeyPtr theKey, UInt8 *theDigest, char *theSuffix, char *thePath);
+
+#endif	// __QTCmprOutputCache__
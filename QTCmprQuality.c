@@ -0,0 +1,881 @@
+//////////
+//
+//	File:		QTCmprQuality.c
+//
+//	Contains:	Measurement of the quality of compressed frames (PSNR and SSIM), as they are compressed, for use by QTCompress.
+//
+//	Written by:	Tim Monroe
+//
+//	Copyright:	 2000 by Apple Computer, Inc., all rights reserved.
+//
+//	Change History (most recent first):
+//
+//	   <1>	 	11/08/26	rtm		first file
+//
+//	To find out how much a compression setting costs in quality, we used to decompress the finished movie and
+//	compare it with the source, which means a second pass through every frame. If the user asks for it (see
+//	QTCmpr_GetMetricsOutput), QTCmpr_CompressSequence instead hands each compressed frame to a quality meter
+//	as soon as it has it. The meter decodes the frame, in a decompression sequence of its own (so that difference
+//	frames are decoded correctly), and compares it with the frame that was compressed.
+//
+//	We compare the luma of the two frames, worked out with the same weights as in QTCmprMotion.c, and report two
+//	measures: the peak signal-to-noise ratio (PSNR), from the sum of the squared differences, and the structural
+//	similarity (SSIM), which follows what a viewer notices more closely. SSIM is the average, over 8 by 8 windows
+//	spaced 4 pixels apart, of a formula in the means, variances, and covariance of the two windows; each window is
+//	made of four 4 by 4 blocks, and we add up the pixels, their squares, and their products for each block just
+//	once. As elsewhere, there are C and SSE2 versions of the routines that do that adding up.
+//
+//	Decoding has to happen on the main thread, like every other QuickTime call, and so does taking the luma
+//	planes, since the next frame is rendered into the same pixel map; we spread the latter over the slice threads
+//	(see QTCmprSlice.c). The measuring itself happens on a thread of its own, while the next frame is rendered and
+//	compressed; we wait for it only when the next frame is ready to be measured. The results are written (with
+//	the C library, which isn't thread-safe) on the main thread: a line for each frame, and a summary at the end.
+//
+//////////
+
+//////////
+//
+// header files
+//
+//////////
+
+#include "QTCompress.h"
+#include <math.h>
+
+
+//////////
+//
+// global variables
+//
+//////////
+
+static QualityKernels				gQualityKernels;					// the measuring routines we use
+static Boolean						gQualityKernelsReady = false;
+
+// the C measuring routines, which are also the reference for the SSE2 ones
+static QualityKernels				gQualityKernels_C = {QTCmpr_ErrorRow_C, QTCmpr_BlockSums_C, "C"};
+
+#if USE_SSE2_KERNELS
+static QualityKernels				gQualityKernels_SSE2 = {QTCmpr_ErrorRow_SSE2, QTCmpr_BlockSums_SSE2, "SSE2"};
+#endif
+
+// the constants that keep the SSIM formula stable in flat windows: (0.01 * 255) squared and (0.03 * 255) squared
+#define kQualitySSIMC1				6.5025
+#define kQualitySSIMC2				58.5225
+
+
+//////////
+//
+// QTCmpr_NewQualityMeter
+// Prepare to measure the quality of compressed versions of the frames in the specified pixel map, which must be 24 or
+// 32 bits deep; the results are written to the file with the specified path.
+//
+// Call QTCmpr_DisposeQualityMeter even if this function fails.
+//
+//////////
+
+OSErr QTCmpr_NewQualityMeter (QualityMeterPtr theMeter, PixMapHandle theSrcPixMap, char *thePath, MemoryJobPtr theJob)
+{
+	Rect						myRect;
+	OSType						myFormat;
+	long						myPlaneSize, mySumsSize;
+	OSErr						myErr = noErr;
+
+	if (theMeter == NULL)
+		return(paramErr);
+
+	theMeter->fSrcPixMap = theSrcPixMap;
+	theMeter->fGWorld = NULL;
+	theMeter->fPixMap = NULL;
+	theMeter->fSequence = 0;
+	theMeter->fDesc = NULL;
+	theMeter->fSrcLuma = NULL;
+	theMeter->fDstLuma = NULL;
+	theMeter->fSums = NULL;
+	theMeter->fIsMeasuring = false;
+	theMeter->fNumFrames = 0L;
+	theMeter->fTotalError = 0.0;
+	theMeter->fTotalPSNR = 0.0;
+	theMeter->fTotalSSIM = 0.0;
+	theMeter->fMinPSNR = kQualityMaxPSNR;
+	theMeter->fMinSSIM = 1.0;
+	theMeter->fDecodeTime = 0.0;
+	theMeter->fWaitTime = 0.0;
+	theMeter->fFile = NULL;
+#if USE_QUALITY_THREAD
+	theMeter->fStopMeasuring = false;
+#if TARGET_OS_WIN32
+	theMeter->fThread = NULL;
+	theMeter->fStartEvent = NULL;
+	theMeter->fDoneEvent = NULL;
+#else
+	theMeter->fThreadIsRunning = false;
+	theMeter->fHasFrame = false;
+#endif
+#endif
+	theMeter->fSize = 0L;
+	theMeter->fJob = theJob;
+
+	if ((theSrcPixMap == NULL) || (thePath == NULL))
+		return(paramErr);
+
+	// find the components; a 32-bit pixel map that doesn't say otherwise is ARGB
+	myFormat = (**theSrcPixMap).pixelFormat;
+	if (myFormat == k24RGBPixelFormat) {
+		theMeter->fBytesPerPixel = 3;
+		theMeter->fRed = 0;
+		theMeter->fGreen = 1;
+		theMeter->fBlue = 2;
+	} else if (myFormat == k32BGRAPixelFormat) {
+		theMeter->fBytesPerPixel = 4;
+		theMeter->fRed = 2;
+		theMeter->fGreen = 1;
+		theMeter->fBlue = 0;
+	} else if (GetPixDepth(theSrcPixMap) == 32) {
+		theMeter->fBytesPerPixel = 4;
+		theMeter->fRed = 1;
+		theMeter->fGreen = 2;
+		theMeter->fBlue = 3;
+	} else {
+		return(paramErr);
+	}
+
+	GetPixBounds(theSrcPixMap, &myRect);
+	theMeter->fWidth = myRect.right - myRect.left;
+	theMeter->fHeight = myRect.bottom - myRect.top;
+	if ((theMeter->fWidth < 2 * kQualityBlockSize) || (theMeter->fHeight < 2 * kQualityBlockSize))
+		return(paramErr);
+
+	// the two luma planes, two rows of block sums, and the graphics world the frames are decoded into
+	myPlaneSize = theMeter->fWidth * theMeter->fHeight;
+	mySumsSize = 2L * (theMeter->fWidth / kQualityBlockSize) * sizeof(theMeter->fSums[0]);
+	theMeter->fSize = (2L * myPlaneSize) + mySumsSize + (4L * myPlaneSize);
+	QTCmpr_ReserveMemory(theJob, theMeter->fSize);
+
+	theMeter->fSrcLuma = (UInt8 *)NewPtr(myPlaneSize);
+	theMeter->fDstLuma = (UInt8 *)NewPtr(myPlaneSize);
+	theMeter->fSums = (SInt32 (*)[4])NewPtr(mySumsSize);
+	if ((theMeter->fSrcLuma == NULL) || (theMeter->fDstLuma == NULL) || (theMeter->fSums == NULL))
+		return(memFullErr);
+
+	MacSetRect(&myRect, 0, 0, (short)theMeter->fWidth, (short)theMeter->fHeight);
+	myErr = QTNewGWorld(&theMeter->fGWorld, k32ARGBPixelFormat, &myRect, NULL, NULL, 0L);
+	if (myErr != noErr) {
+		theMeter->fGWorld = NULL;
+		return(myErr);
+	}
+
+	theMeter->fPixMap = GetGWorldPixMap(theMeter->fGWorld);
+	if (!LockPixels(theMeter->fPixMap))
+		return(memFullErr);
+
+	theMeter->fFile = fopen(thePath, "w");
+	if (theMeter->fFile == NULL)
+		return(ioErr);
+
+	fprintf(theMeter->fFile, "# frame\tsize\tsync\tpsnr\tssim\n");
+
+	// make sure the measuring routines are chosen before the measuring thread needs them
+	QTCmpr_GetQualityKernels();
+
+	return(QTCmpr_StartQualityThread(theMeter));
+}
+
+
+//////////
+//
+// QTCmpr_MeasureQuality
+// Decode the specified compressed frame, which was compressed from the frame now in the meter's source pixel map,
+// and begin measuring its quality; the results are written once the next frame is measured (or the meter is disposed).
+//
+// The frames must be passed in the order they were compressed.
+//
+//////////
+
+OSErr QTCmpr_MeasureQuality (QualityMeterPtr theMeter, Ptr theData, long theSize, ImageDescriptionHandle theDesc, long theFrameNum, short theSyncFlag)
+{
+	UnsignedWide				myStart, myEnd;
+	OSErr						myErr = noErr;
+
+	if ((theMeter == NULL) || (theData == NULL) || (theDesc == NULL))
+		return(paramErr);
+
+	// the measuring thread works only on the luma planes, so we can decode while it finishes the last frame
+	Microseconds(&myStart);
+	myErr = QTCmpr_DecodeQualityFrame(theMeter, theData, theSize, theDesc);
+	Microseconds(&myEnd);
+
+	theMeter->fDecodeTime += ((double)myEnd.hi - (double)myStart.hi) * 4294967296.0 + ((double)myEnd.lo - (double)myStart.lo);
+	if (myErr != noErr)
+		return(myErr);
+
+	QTCmpr_FinishQualityFrame(theMeter);
+
+	QTCmpr_RunSlices(QTCmpr_GetQualityLumaSlice, theMeter, 0L, theMeter->fHeight, 1L);
+
+	theMeter->fFrameNum = theFrameNum;
+	theMeter->fFrameSize = theSize;
+	theMeter->fFrameSyncFlag = theSyncFlag;
+	theMeter->fIsMeasuring = true;
+
+#if USE_QUALITY_THREAD
+#if TARGET_OS_WIN32
+	SetEvent(theMeter->fStartEvent);
+#else
+	pthread_mutex_lock(&theMeter->fLock);
+	theMeter->fHasFrame = true;
+	pthread_cond_broadcast(&theMeter->fChanged);
+	pthread_mutex_unlock(&theMeter->fLock);
+#endif
+#else
+	QTCmpr_MeasureLumaPlanes(theMeter);
+#endif
+
+	return(noErr);
+}
+
+
+//////////
+//
+// QTCmpr_DisposeQualityMeter
+// Write the results of the last frame and a summary of all of them, and dispose of the meter's memory.
+//
+//////////
+
+void QTCmpr_DisposeQualityMeter (QualityMeterPtr theMeter)
+{
+	double						myNumPixels;
+
+	if (theMeter == NULL)
+		return;
+
+	QTCmpr_FinishQualityFrame(theMeter);
+	QTCmpr_StopQualityThread(theMeter);
+
+	if (theMeter->fNumFrames > 0L) {
+		myNumPixels = (double)theMeter->fWidth * (double)theMeter->fHeight * (double)theMeter->fNumFrames;
+
+		QTCmpr_LogMessage("QTCmpr_DisposeQualityMeter: %ld frames; PSNR %.2f dB on average (%.2f dB overall, %.2f dB at worst); SSIM %.4f on average (%.4f at worst); %s routines, %.0f us per frame decoding, %.0f us per frame waiting",
+							theMeter->fNumFrames, theMeter->fTotalPSNR / theMeter->fNumFrames, QTCmpr_GetPSNR(theMeter->fTotalError, myNumPixels), theMeter->fMinPSNR,
+							theMeter->fTotalSSIM / theMeter->fNumFrames, theMeter->fMinSSIM, QTCmpr_GetQualityKernels()->fName,
+							theMeter->fDecodeTime / theMeter->fNumFrames, theMeter->fWaitTime / theMeter->fNumFrames);
+
+		if (theMeter->fFile != NULL)
+			fprintf(theMeter->fFile, "# %ld frames; average psnr %.3f, overall psnr %.3f, minimum psnr %.3f; average ssim %.5f, minimum ssim %.5f\n",
+							theMeter->fNumFrames, theMeter->fTotalPSNR / theMeter->fNumFrames, QTCmpr_GetPSNR(theMeter->fTotalError, myNumPixels), theMeter->fMinPSNR,
+							theMeter->fTotalSSIM / theMeter->fNumFrames, theMeter->fMinSSIM);
+	}
+
+	if (theMeter->fFile != NULL)
+		fclose(theMeter->fFile);
+	theMeter->fFile = NULL;
+
+	if (theMeter->fSequence != 0)
+		CDSequenceEnd(theMeter->fSequence);
+	theMeter->fSequence = 0;
+
+	if (theMeter->fGWorld != NULL)
+		DisposeGWorld(theMeter->fGWorld);
+	theMeter->fGWorld = NULL;
+	theMeter->fPixMap = NULL;
+
+	if (theMeter->fSrcLuma != NULL)
+		DisposePtr((Ptr)theMeter->fSrcLuma);
+	if (theMeter->fDstLuma != NULL)
+		DisposePtr((Ptr)theMeter->fDstLuma);
+	if (theMeter->fSums != NULL)
+		DisposePtr((Ptr)theMeter->fSums);
+
+	theMeter->fSrcLuma = NULL;
+	theMeter->fDstLuma = NULL;
+	theMeter->fSums = NULL;
+
+	QTCmpr_ReleaseMemory(theMeter->fJob, theMeter->fSize);
+	theMeter->fSize = 0L;
+}
+
+
+//////////
+//
+// QTCmpr_DecodeQualityFrame
+// Decode the specified compressed frame into the meter's graphics world.
+//
+// A worker that had to be restarted may have begun a new image description (see QTCmpr_CompressWorkerFrame);
+// frames with a new description begin a new decompression sequence.
+//
+//////////
+
+static OSErr QTCmpr_DecodeQualityFrame (QualityMeterPtr theMeter, Ptr theData, long theSize, ImageDescriptionHandle theDesc)
+{
+	OSErr						myErr = noErr;
+
+	if ((theMeter->fSequence != 0) && (theDesc != theMeter->fDesc)) {
+		CDSequenceEnd(theMeter->fSequence);
+		theMeter->fSequence = 0;
+	}
+
+	if (theMeter->fSequence == 0) {
+		myErr = DecompressSequenceBeginS(&theMeter->fSequence, theDesc, theData, theSize, theMeter->fGWorld, NULL, NULL, NULL, srcCopy, NULL, 0L, codecHighQuality, anyCodec);
+		if (myErr != noErr) {
+			theMeter->fSequence = 0;
+			return(myErr);
+		}
+
+		theMeter->fDesc = theDesc;
+	}
+
+	return(DecompressSequenceFrameS(theMeter->fSequence, theData, theSize, 0L, NULL, NULL));
+}
+
+
+//////////
+//
+// QTCmpr_FinishQualityFrame
+// Wait for the frame being measured (if there is one), add its results to the totals, and write them out.
+//
+//////////
+
+static void QTCmpr_FinishQualityFrame (QualityMeterPtr theMeter)
+{
+	UnsignedWide				myStart, myEnd;
+	double						myPSNR;
+
+	if (!theMeter->fIsMeasuring)
+		return;
+
+	Microseconds(&myStart);
+
+#if USE_QUALITY_THREAD
+#if TARGET_OS_WIN32
+	WaitForSingleObject(theMeter->fDoneEvent, INFINITE);
+#else
+	pthread_mutex_lock(&theMeter->fLock);
+	while (theMeter->fHasFrame)
+		pthread_cond_wait(&theMeter->fChanged, &theMeter->fLock);
+	pthread_mutex_unlock(&theMeter->fLock);
+#endif
+#endif
+
+	Microseconds(&myEnd);
+
+	theMeter->fWaitTime += ((double)myEnd.hi - (double)myStart.hi) * 4294967296.0 + ((double)myEnd.lo - (double)myStart.lo);
+	theMeter->fIsMeasuring = false;
+
+	myPSNR = QTCmpr_GetPSNR(theMeter->fFrameError, (double)theMeter->fWidth * (double)theMeter->fHeight);
+
+	theMeter->fNumFrames++;
+	theMeter->fTotalError += theMeter->fFrameError;
+	theMeter->fTotalPSNR += myPSNR;
+	theMeter->fTotalSSIM += theMeter->fFrameSSIM;
+	if (myPSNR < theMeter->fMinPSNR)
+		theMeter->fMinPSNR = myPSNR;
+	if (theMeter->fFrameSSIM < theMeter->fMinSSIM)
+		theMeter->fMinSSIM = theMeter->fFrameSSIM;
+
+	if (theMeter->fFile != NULL)
+		fprintf(theMeter->fFile, "%ld\t%ld\t%d\t%.3f\t%.5f\n", theMeter->fFrameNum, theMeter->fFrameSize,
+							(theMeter->fFrameSyncFlag & mediaSampleNotSync) ? 0 : 1, myPSNR, theMeter->fFrameSSIM);
+}
+
+
+//////////
+//
+// QTCmpr_GetQualityLumaSlice
+// Fill rows theTop through theBottom - 1 of the luma planes, from the source pixel map and the decoded frame.
+//
+// This is called on the threads in the slice pool.
+//
+//////////
+
+static void QTCmpr_GetQualityLumaSlice (void *theRefCon, long theSlice, long theTop, long theBottom)
+{
+	QualityMeterPtr				myMeter = (QualityMeterPtr)theRefCon;
+	UInt8						*mySrcBase = (UInt8 *)GetPixBaseAddr(myMeter->fSrcPixMap);
+	long						mySrcRowBytes = QTGetPixMapHandleRowBytes(myMeter->fSrcPixMap);
+	UInt8						*myDstBase = (UInt8 *)GetPixBaseAddr(myMeter->fPixMap);
+	long						myDstRowBytes = QTGetPixMapHandleRowBytes(myMeter->fPixMap);
+	long						myBytesPerPixel = myMeter->fBytesPerPixel;
+	long						myRed = myMeter->fRed;
+	long						myGreen = myMeter->fGreen;
+	long						myBlue = myMeter->fBlue;
+	UInt8						*mySrc, *myDst;
+	UInt8						*mySrcLuma, *myDstLuma;
+	long						myRow, myCol;
+
+#pragma unused(theSlice)
+
+	for (myRow = theTop; myRow < theBottom; myRow++) {
+		mySrc = mySrcBase + (myRow * mySrcRowBytes);
+		myDst = myDstBase + (myRow * myDstRowBytes);
+		mySrcLuma = myMeter->fSrcLuma + (myRow * myMeter->fWidth);
+		myDstLuma = myMeter->fDstLuma + (myRow * myMeter->fWidth);
+
+		// the decoded frame is ARGB
+		for (myCol = 0; myCol < myMeter->fWidth; myCol++) {
+			mySrcLuma[myCol] = (UInt8)(((77 * mySrc[myRed]) + (150 * mySrc[myGreen]) + (29 * mySrc[myBlue]) + 128) >> 8);
+			myDstLuma[myCol] = (UInt8)(((77 * myDst[1]) + (150 * myDst[2]) + (29 * myDst[3]) + 128) >> 8);
+
+			mySrc += myBytesPerPixel;
+			myDst += 4;
+		}
+	}
+}
+
+
+//////////
+//
+// QTCmpr_MeasureLumaPlanes
+// Work out the sum of the squared differences between the luma planes, and their SSIM.
+//
+// This is called on the measuring thread.
+//
+//////////
+
+static void QTCmpr_MeasureLumaPlanes (QualityMeterPtr theMeter)
+{
+	QualityKernelsPtr			myKernels = QTCmpr_GetQualityKernels();
+	long						myWidth = theMeter->fWidth;
+	long						myBlocksWide = myWidth / kQualityBlockSize;
+	long						myBlocksHigh = theMeter->fHeight / kQualityBlockSize;
+	SInt32						(*myAbove)[4] = theMeter->fSums;
+	SInt32						(*myBelow)[4] = theMeter->fSums + myBlocksWide;
+	SInt32						(*mySwap)[4];
+	SInt32						mySums[4];
+	double						myError = 0.0;
+	double						mySSIM = 0.0;
+	long						myNumWindows = 0L;
+	long						myRow, myBlock, myIndex;
+
+	for (myRow = 0; myRow < theMeter->fHeight; myRow++)
+		myError += myKernels->fErrorRow(theMeter->fSrcLuma + (myRow * myWidth), theMeter->fDstLuma + (myRow * myWidth), myWidth);
+
+	// each window is the 2 by 2 blocks with the block at its top left corner
+	for (myRow = 0; myRow < myBlocksHigh; myRow++) {
+		myKernels->fBlockSums(theMeter->fSrcLuma + (myRow * kQualityBlockSize * myWidth), theMeter->fDstLuma + (myRow * kQualityBlockSize * myWidth), myWidth, myBlocksWide, myBelow);
+
+		if (myRow > 0) {
+			for (myBlock = 0; myBlock + 1 < myBlocksWide; myBlock++) {
+				for (myIndex = 0; myIndex < 4; myIndex++)
+					mySums[myIndex] = myAbove[myBlock][myIndex] + myAbove[myBlock + 1][myIndex] + myBelow[myBlock][myIndex] + myBelow[myBlock + 1][myIndex];
+
+				mySSIM += QTCmpr_GetWindowSSIM(mySums);
+				myNumWindows++;
+			}
+		}
+
+		mySwap = myAbove;
+		myAbove = myBelow;
+		myBelow = mySwap;
+	}
+
+	theMeter->fFrameError = myError;
+	theMeter->fFrameSSIM = (myNumWindows > 0L) ? (mySSIM / myNumWindows) : 1.0;
+}
+
+
+//////////
+//
+// QTCmpr_GetWindowSSIM
+// Return the SSIM of an 8 by 8 window, given the sums of its source pixels, its decoded pixels, the squares of
+// both, and their products.
+//
+//////////
+
+static double QTCmpr_GetWindowSSIM (SInt32 *theSums)
+{
+	double						myCount = 4.0 * kQualityBlockSize * kQualityBlockSize;
+	double						mySrcMean = theSums[0] / myCount;
+	double						myDstMean = theSums[1] / myCount;
+	double						myVariances = (theSums[2] / myCount) - (mySrcMean * mySrcMean) - (myDstMean * myDstMean);
+	double						myCovariance = (theSums[3] / myCount) - (mySrcMean * myDstMean);
+
+	return((((2.0 * mySrcMean * myDstMean) + kQualitySSIMC1) * ((2.0 * myCovariance) + kQualitySSIMC2)) /
+			(((mySrcMean * mySrcMean) + (myDstMean * myDstMean) + kQualitySSIMC1) * (myVariances + kQualitySSIMC2)));
+}
+
+
+//////////
+//
+// QTCmpr_GetPSNR
+// Return the peak signal-to-noise ratio, in decibels, of the specified number of 8-bit values with the specified sum
+// of squared differences.
+//
+//////////
+
+static double QTCmpr_GetPSNR (double theError, double theNumPixels)
+{
+	double						myPSNR;
+
+	if (theError <= 0.0)
+		return(kQualityMaxPSNR);
+
+	myPSNR = 10.0 * log10((255.0 * 255.0 * theNumPixels) / theError);
+
+	return((myPSNR > kQualityMaxPSNR) ? kQualityMaxPSNR : myPSNR);
+}
+
+
+//////////
+//
+// QTCmpr_StartQualityThread
+// Start the thread that measures frames.
+//
+//////////
+
+static OSErr QTCmpr_StartQualityThread (QualityMeterPtr theMeter)
+{
+#if USE_QUALITY_THREAD
+#if TARGET_OS_WIN32
+	DWORD						myThreadID;
+
+	theMeter->fStartEvent = CreateEvent(NULL, FALSE, FALSE, NULL);
+	theMeter->fDoneEvent = CreateEvent(NULL, FALSE, FALSE, NULL);
+	if ((theMeter->fStartEvent == NULL) || (theMeter->fDoneEvent == NULL))
+		return(memFullErr);
+
+	theMeter->fThread = CreateThread(NULL, 0, QTCmpr_QualityThreadProc, theMeter, 0, &myThreadID);
+	if (theMeter->fThread == NULL)
+		return(memFullErr);
+#else
+	pthread_mutex_init(&theMeter->fLock, NULL);
+	pthread_cond_init(&theMeter->fChanged, NULL);
+
+	if (pthread_create(&theMeter->fThread, NULL, QTCmpr_QualityThreadProc, theMeter) != 0) {
+		pthread_cond_destroy(&theMeter->fChanged);
+		pthread_mutex_destroy(&theMeter->fLock);
+		return(memFullErr);
+	}
+
+	theMeter->fThreadIsRunning = true;
+#endif
+#else
+#pragma unused(theMeter)
+#endif
+
+	return(noErr);
+}
+
+
+//////////
+//
+// QTCmpr_StopQualityThread
+// Stop the thread that measures frames, and wait for it to quit.
+//
+// There must be no frame being measured.
+//
+//////////
+
+static void QTCmpr_StopQualityThread (QualityMeterPtr theMeter)
+{
+#if USE_QUALITY_THREAD
+#if TARGET_OS_WIN32
+	if (theMeter->fThread != NULL) {
+		theMeter->fStopMeasuring = true;
+		SetEvent(theMeter->fStartEvent);
+		WaitForSingleObject(theMeter->fThread, INFINITE);
+		CloseHandle(theMeter->fThread);
+	}
+
+	if (theMeter->fStartEvent != NULL)
+		CloseHandle(theMeter->fStartEvent);
+	if (theMeter->fDoneEvent != NULL)
+		CloseHandle(theMeter->fDoneEvent);
+
+	theMeter->fThread = NULL;
+	theMeter->fStartEvent = NULL;
+	theMeter->fDoneEvent = NULL;
+#else
+	if (theMeter->fThreadIsRunning) {
+		pthread_mutex_lock(&theMeter->fLock);
+		theMeter->fStopMeasuring = true;
+		pthread_cond_broadcast(&theMeter->fChanged);
+		pthread_mutex_unlock(&theMeter->fLock);
+
+		pthread_join(theMeter->fThread, NULL);
+		pthread_cond_destroy(&theMeter->fChanged);
+		pthread_mutex_destroy(&theMeter->fLock);
+	}
+
+	theMeter->fThreadIsRunning = false;
+#endif
+#else
+#pragma unused(theMeter)
+#endif
+}
+
+
+//////////
+//
+// QTCmpr_QualityThreadProc
+// Measure each frame we are handed, until we are told to stop.
+//
+//////////
+
+#if USE_QUALITY_THREAD
+#if TARGET_OS_WIN32
+static DWORD WINAPI QTCmpr_QualityThreadProc (LPVOID theParam)
+#else
+static void * QTCmpr_QualityThreadProc (void *theParam)
+#endif
+{
+	QualityMeterPtr				myMeter = (QualityMeterPtr)theParam;
+
+#if TARGET_OS_WIN32
+	while (true) {
+		WaitForSingleObject(myMeter->fStartEvent, INFINITE);
+		if (myMeter->fStopMeasuring)
+			break;
+
+		QTCmpr_MeasureLumaPlanes(myMeter);
+
+		SetEvent(myMeter->fDoneEvent);
+	}
+
+	return(0);
+#else
+	pthread_mutex_lock(&myMeter->fLock);
+
+	while (true) {
+		while (!myMeter->fHasFrame && !myMeter->fStopMeasuring)
+			pthread_cond_wait(&myMeter->fChanged, &myMeter->fLock);
+		if (myMeter->fStopMeasuring)
+			break;
+
+		pthread_mutex_unlock(&myMeter->fLock);
+		QTCmpr_MeasureLumaPlanes(myMeter);
+		pthread_mutex_lock(&myMeter->fLock);
+
+		myMeter->fHasFrame = false;
+		pthread_cond_broadcast(&myMeter->fChanged);
+	}
+
+	pthread_mutex_unlock(&myMeter->fLock);
+
+	return(NULL);
+#endif
+}
+#endif
+
+
+//////////
+//
+// QTCmpr_GetQualityKernels
+// Return the measuring routines to use: the SSE2 ones, if the processor has SSE2 and they give the same results as
+// the C ones, or else the C ones.
+//
+//////////
+
+static QualityKernelsPtr QTCmpr_GetQualityKernels (void)
+{
+	if (!gQualityKernelsReady) {
+		gQualityKernels = gQualityKernels_C;
+
+#if USE_SSE2_KERNELS
+		if (QTCmpr_HasSSE2()) {
+			if (QTCmpr_CheckQualityKernels(&gQualityKernels_SSE2, &gQualityKernels_C))
+				gQualityKernels = gQualityKernels_SSE2;
+			else
+				QTCmpr_LogMessage("QTCmpr_GetQualityKernels: the SSE2 routines don't match the C routines; using the C routines");
+		}
+#endif
+
+		gQualityKernelsReady = true;
+	}
+
+	return(&gQualityKernels);
+}
+
+
+//////////
+//
+// QTCmpr_CheckQualityKernels
+// Do the specified measuring routines produce exactly the same results as the reference routines?
+//
+// We measure a pair of random test planes, and a plane of 255s against a plane of 0s; the planes are wide enough to
+// exercise both the SSE2 loops and the leftover pixels.
+//
+//////////
+
+static Boolean QTCmpr_CheckQualityKernels (QualityKernelsPtr theKernels, QualityKernelsPtr theReference)
+{
+	UInt8						mySrc[kQualityCheckHeight][kQualityCheckWidth];
+	UInt8						myDst[kQualityCheckHeight][kQualityCheckWidth];
+	SInt32						mySums[kQualityCheckWidth / kQualityBlockSize][4];
+	SInt32						myRefSums[kQualityCheckWidth / kQualityBlockSize][4];
+	long						myNumBlocks = kQualityCheckWidth / kQualityBlockSize;
+	unsigned long				mySeed = 1;
+	long						myPass, myRow, myCol;
+
+	for (myPass = 0; myPass < 2; myPass++) {
+		for (myRow = 0; myRow < kQualityCheckHeight; myRow++) {
+			for (myCol = 0; myCol < kQualityCheckWidth; myCol++) {
+				mySeed = (mySeed * 1103515245) + 12345;
+				mySrc[myRow][myCol] = (myPass == 0) ? (UInt8)(mySeed >> 16) : 255;
+				myDst[myRow][myCol] = (myPass == 0) ? (UInt8)(mySeed >> 24) : 0;
+			}
+
+			if (theKernels->fErrorRow(mySrc[myRow], myDst[myRow], kQualityCheckWidth) != theReference->fErrorRow(mySrc[myRow], myDst[myRow], kQualityCheckWidth))
+				return(false);
+		}
+
+		for (myRow = 0; myRow < kQualityCheckHeight; myRow += kQualityBlockSize) {
+			theKernels->fBlockSums(mySrc[myRow], myDst[myRow], kQualityCheckWidth, myNumBlocks, mySums);
+			theReference->fBlockSums(mySrc[myRow], myDst[myRow], kQualityCheckWidth, myNumBlocks, myRefSums);
+			if (memcmp(mySums, myRefSums, sizeof(mySums)) != 0)
+				return(false);
+		}
+	}
+
+	return(true);
+}
+
+
+//////////
+//
+// QTCmpr_ErrorRow_C
+// Return the sum of the squared differences between two rows.
+//
+//////////
+
+static unsigned long QTCmpr_ErrorRow_C (UInt8 *theSrc, UInt8 *theDst, long theWidth)
+{
+	unsigned long				myError = 0L;
+	long						myDiff;
+	long						myCol;
+
+	for (myCol = 0; myCol < theWidth; myCol++) {
+		myDiff = (long)theSrc[myCol] - (long)theDst[myCol];
+		myError += (unsigned long)(myDiff * myDiff);
+	}
+
+	return(myError);
+}
+
+
+//////////
+//
+// QTCmpr_BlockSums_C
+// For each of a row of 4 by 4 blocks, add up the source pixels, the decoded pixels, the squares of both, and their
+// products.
+//
+//////////
+
+static void QTCmpr_BlockSums_C (UInt8 *theSrc, UInt8 *theDst, long theRowBytes, long theNumBlocks, SInt32 (*theSums)[4])
+{
+	UInt8						*mySrc, *myDst;
+	long						myBlock, myRow, myCol;
+
+	for (myBlock = 0; myBlock < theNumBlocks; myBlock++) {
+		theSums[myBlock][0] = 0;
+		theSums[myBlock][1] = 0;
+		theSums[myBlock][2] = 0;
+		theSums[myBlock][3] = 0;
+
+		for (myRow = 0; myRow < kQualityBlockSize; myRow++) {
+			mySrc = theSrc + (myRow * theRowBytes) + (myBlock * kQualityBlockSize);
+			myDst = theDst + (myRow * theRowBytes) + (myBlock * kQualityBlockSize);
+
+			for (myCol = 0; myCol < kQualityBlockSize; myCol++) {
+				theSums[myBlock][0] += mySrc[myCol];
+				theSums[myBlock][1] += myDst[myCol];
+				theSums[myBlock][2] += (mySrc[myCol] * mySrc[myCol]) + (myDst[myCol] * myDst[myCol]);
+				theSums[myBlock][3] += mySrc[myCol] * myDst[myCol];
+			}
+		}
+	}
+}
+
+
+#if USE_SSE2_KERNELS
+//////////
+//
+// QTCmpr_ErrorRow_SSE2
+// Return the sum of the squared differences between two rows, 16 pixels at a time.
+//
+// Each 32-bit lane gains at most 4 * 255 * 255 in each pass, and a row is at most 32767 pixels wide, so no lane
+// (and no total) can overflow.
+//
+//////////
+
+static unsigned long QTCmpr_ErrorRow_SSE2 (UInt8 *theSrc, UInt8 *theDst, long theWidth)
+{
+	__m128i						myZero = _mm_setzero_si128();
+	__m128i						mySum = _mm_setzero_si128();
+	__m128i						mySrc, myDst, myLow, myHigh;
+	unsigned long				myError;
+	long						myDiff;
+	long						myCol;
+
+	for (myCol = 0; myCol + 16 <= theWidth; myCol += 16) {
+		mySrc = _mm_loadu_si128((__m128i *)(theSrc + myCol));
+		myDst = _mm_loadu_si128((__m128i *)(theDst + myCol));
+
+		myLow = _mm_sub_epi16(_mm_unpacklo_epi8(mySrc, myZero), _mm_unpacklo_epi8(myDst, myZero));
+		myHigh = _mm_sub_epi16(_mm_unpackhi_epi8(mySrc, myZero), _mm_unpackhi_epi8(myDst, myZero));
+		mySum = _mm_add_epi32(mySum, _mm_add_epi32(_mm_madd_epi16(myLow, myLow), _mm_madd_epi16(myHigh, myHigh)));
+	}
+
+	mySum = _mm_add_epi32(mySum, _mm_srli_si128(mySum, 8));
+	mySum = _mm_add_epi32(mySum, _mm_srli_si128(mySum, 4));
+	myError = (UInt32)_mm_cvtsi128_si32(mySum);
+
+	for (; myCol < theWidth; myCol++) {
+		myDiff = (long)theSrc[myCol] - (long)theDst[myCol];
+		myError += (unsigned long)(myDiff * myDiff);
+	}
+
+	return(myError);
+}
+
+
+//////////
+//
+// QTCmpr_BlockSums_SSE2
+// For each of a row of 4 by 4 blocks, add up the source pixels, the decoded pixels, the squares of both, and their
+// products; two blocks at a time.
+//
+// Each register holds a row of 8 pixels, widened to 16 bits; multiplying and adding pairs (by 1, for the plain sums)
+// leaves lanes 0 and 1 of each sum for the first block and lanes 2 and 3 for the second, which we then gather up.
+//
+//////////
+
+static void QTCmpr_BlockSums_SSE2 (UInt8 *theSrc, UInt8 *theDst, long theRowBytes, long theNumBlocks, SInt32 (*theSums)[4])
+{
+	__m128i						myZero = _mm_setzero_si128();
+	__m128i						myOnes = _mm_set1_epi16(1);
+	__m128i						mySrc, myDst;
+	__m128i						mySrcSum, myDstSum, mySquares, myProducts;
+	__m128i						mySumsLow, mySumsHigh, myMoreLow, myMoreHigh;
+	long						myBlock, myRow;
+
+	for (myBlock = 0; myBlock + 2 <= theNumBlocks; myBlock += 2) {
+		mySrcSum = _mm_setzero_si128();
+		myDstSum = _mm_setzero_si128();
+		mySquares = _mm_setzero_si128();
+		myProducts = _mm_setzero_si128();
+
+		for (myRow = 0; myRow < kQualityBlockSize; myRow++) {
+			mySrc = _mm_unpacklo_epi8(_mm_loadl_epi64((__m128i *)(theSrc + (myRow * theRowBytes) + (myBlock * kQualityBlockSize))), myZero);
+			myDst = _mm_unpacklo_epi8(_mm_loadl_epi64((__m128i *)(theDst + (myRow * theRowBytes) + (myBlock * kQualityBlockSize))), myZero);
+
+			mySrcSum = _mm_add_epi32(mySrcSum, _mm_madd_epi16(mySrc, myOnes));
+			myDstSum = _mm_add_epi32(myDstSum, _mm_madd_epi16(myDst, myOnes));
+			mySquares = _mm_add_epi32(mySquares, _mm_add_epi32(_mm_madd_epi16(mySrc, mySrc), _mm_madd_epi16(myDst, myDst)));
+			myProducts = _mm_add_epi32(myProducts, _mm_madd_epi16(mySrc, myDst));
+		}
+
+		// interleave the sums so that each block's four lanes can be added to its other four
+		mySumsLow = _mm_unpacklo_epi32(mySrcSum, myDstSum);
+		mySumsHigh = _mm_unpackhi_epi32(mySrcSum, myDstSum);
+		myMoreLow = _mm_unpacklo_epi32(mySquares, myProducts);
+		myMoreHigh = _mm_unpackhi_epi32(mySquares, myProducts);
+
+		_mm_storeu_si128((__m128i *)theSums[myBlock], _mm_add_epi32(_mm_unpacklo_epi64(mySumsLow, myMoreLow), _mm_unpackhi_epi64(mySumsLow, myMoreLow)));
+		_mm_storeu_si128((__m128i *)theSums[myBlock + 1], _mm_add_epi32(_mm_unpacklo_epi64(mySumsHigh, myMoreHigh), _mm_unpackhi_epi64(mySumsHigh, myMoreHigh)));
+	}
+
+	if (myBlock < theNumBlocks)
+		QTCmpr_BlockSums_C(theSrc + (myBlock * kQualityBlockSize), theDst + (myBlock * kQualityBlockSize), theRowBytes, theNumBlocks - myBlock, theSums + myBlock);
+}
+
+#endif	// USE_SSE2_KERNELS
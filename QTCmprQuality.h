@@ -0,0 +1,183 @@
+//////////
+//
+//	File:		QTCmprQuality.h
+//
+//	Contains:	Measurement of the quality of compressed frames (PSNR and SSIM), as they are compressed, for use by QTCompress.
+//
+//	Written by:	Tim Monroe
+//
+//	Copyright:	 2000 by Apple Computer, Inc., all rights reserved.
+//
+//	Change History (most recent first):
+//
+//	   <1>	 	11/08/26	rtm		first file
+//
+//////////
+
+#pragma once
+
+
+//////////
+//
+// header files
+//
+//////////
+
+#ifndef __QTCmprQuality__
+#define __QTCmprQuality__
+
+#ifndef __MOVIES__
+#include <Movies.h>
+#endif
+
+#ifndef __QDOFFSCREEN__
+#include <QDOffscreen.h>
+#endif
+
+#include <stdio.h>
+
+#if TARGET_OS_WIN32
+#include <windows.h>
+#endif
+
+#if TARGET_RT_MAC_MACHO
+#include <pthread.h>
+#endif
+
+#include "QTCmprBudget.h"
+#include "QTCmprColor.h"										// for USE_SSE2_KERNELS
+
+
+//////////
+//
+// compiler flags
+//
+//////////
+
+// do we measure each frame on another thread while the next frame is being compressed?
+#if TARGET_OS_WIN32 || TARGET_RT_MAC_MACHO
+#define USE_QUALITY_THREAD				1
+#else
+#define USE_QUALITY_THREAD				0
+#endif
+
+
+//////////
+//
+// constants
+//
+//////////
+
+#define kQualityMaxPSNR					100.0					// the PSNR we report for a frame that came through unchanged
+#define kQualityBlockSize				4						// SSIM is worked out on 8 by 8 windows made of 4 by 4 blocks
+#define kQualityCheckWidth				37						// size of the test planes we compare the SSE2 and C routines on
+#define kQualityCheckHeight				8
+
+
+//////////
+//
+// data types
+//
+//////////
+
+// the routines that do most of the measuring: the sum of the squared differences between two rows, and the sums
+// (of the pixels of each plane, of their squares, and of their products) over each of a row of 4 by 4 blocks
+typedef unsigned long (*QualityErrorRowProcPtr) (UInt8 *theSrc, UInt8 *theDst, long theWidth);
+typedef void (*QualityBlockSumsProcPtr) (UInt8 *theSrc, UInt8 *theDst, long theRowBytes, long theNumBlocks, SInt32 (*theSums)[4]);
+
+typedef struct QualityKernels {
+	QualityErrorRowProcPtr		fErrorRow;
+	QualityBlockSumsProcPtr		fBlockSums;
+	char						*fName;
+} QualityKernels, *QualityKernelsPtr;
+
+// a meter of the quality of the frames of a compression sequence; it decodes each compressed frame into a graphics
+// world of its own and compares the luma of the result with the luma of the frame that was compressed
+typedef struct QualityMeter {
+	PixMapHandle				fSrcPixMap;							// the frames that are compressed
+	long						fBytesPerPixel;
+	long						fRed;								// the offsets of the components in each pixel
+	long						fGreen;
+	long						fBlue;
+	GWorldPtr					fGWorld;							// the decoded frames, in 32-bit ARGB
+	PixMapHandle				fPixMap;
+	ImageSequence				fSequence;							// the decompression sequence, or 0
+	ImageDescriptionHandle		fDesc;								// the image description the sequence was begun with
+	long						fWidth;
+	long						fHeight;
+	UInt8						*fSrcLuma;							// the luma planes of the frame being measured
+	UInt8						*fDstLuma;
+	SInt32						(*fSums)[4];						// two rows of block sums
+
+	// the frame being measured, and its results
+	Boolean						fIsMeasuring;						// has the frame been handed over, and its results not collected?
+	long						fFrameNum;
+	long						fFrameSize;
+	short						fFrameSyncFlag;
+	double						fFrameError;						// the sum of the squared differences
+	double						fFrameSSIM;
+
+	// the totals
+	long						fNumFrames;
+	double						fTotalError;
+	double						fTotalPSNR;
+	double						fTotalSSIM;
+	double						fMinPSNR;
+	double						fMinSSIM;
+	double						fDecodeTime;						// microseconds spent decoding frames
+	double						fWaitTime;							// microseconds spent waiting for the measuring thread
+
+	FILE						*fFile;								// where the results go
+#if USE_QUALITY_THREAD
+	Boolean						fStopMeasuring;						// should the measuring thread quit?
+#if TARGET_OS_WIN32
+	HANDLE						fThread;
+	HANDLE						fStartEvent;						// set when there's a frame to measure
+	HANDLE						fDoneEvent;							// set when the frame has been measured
+#else
+	pthread_t					fThread;
+	Boolean						fThreadIsRunning;
+	pthread_mutex_t				fLock;
+	pthread_cond_t				fChanged;							// signalled whenever fHasFrame changes
+	Boolean						fHasFrame;							// is there a frame to measure?
+#endif
+#endif
+	long						fSize;								// the number of bytes reserved
+	MemoryJobPtr				fJob;
+} QualityMeter, *QualityMeterPtr;
+
+
+//////////
+//
+// function prototypes
+//
+//////////
+
+OSErr							QTCmpr_NewQualityMeter (QualityMeterPtr theMeter, PixMapHandle theSrcPixMap, char *thePath, MemoryJobPtr theJob);
+OSErr							QTCmpr_MeasureQuality (QualityMeterPtr theMeter, Ptr theData, long theSize, ImageDescriptionHandle theDesc, long theFrameNum, short theSyncFlag);
+void							QTCmpr_DisposeQualityMeter (QualityMeterPtr theMeter);
+static OSErr					QTCmpr_DecodeQualityFrame (QualityMeterPtr theMeter, Ptr theData, long theSize, ImageDescriptionHandle theDesc);
+static void						QTCmpr_FinishQualityFrame (QualityMeterPtr theMeter);
+static void						QTCmpr_GetQualityLumaSlice (void *theRefCon, long theSlice, long theTop, long theBottom);
+static void						QTCmpr_MeasureLumaPlanes (QualityMeterPtr theMeter);
+static double					QTCmpr_GetWindowSSIM (SInt32 *theSums);
+static double					QTCmpr_GetPSNR (double theError, double theNumPixels);
+static OSErr					QTCmpr_StartQualityThread (QualityMeterPtr theMeter);
+static void						QTCmpr_StopQualityThread (QualityMeterPtr theMeter);
+#if USE_QUALITY_THREAD
+#if TARGET_OS_WIN32
+static DWORD WINAPI				QTCmpr_QualityThreadProc (LPVOID theParam);
+#else
+static void *					QTCmpr_QualityThreadProc (void *theParam);
+#endif
+#endif
+static QualityKernelsPtr		QTCmpr_GetQualityKernels (void);
+static Boolean					QTCmpr_CheckQualityKernels (QualityKernelsPtr theKernels, QualityKernelsPtr theReference);
+static unsigned long			QTCmpr_ErrorRow_C (UInt8 *theSrc, UInt8 *theDst, long theWidth);
+static void						QTCmpr_BlockSums_C (UInt8 *theSrc, UInt8 *theDst, long theRowBytes, long theNumBlocks, SInt32 (*theSums)[4]);
+#if USE_SSE2_KERNELS
+static unsigned long			QTCmpr_ErrorRow_SSE2 (UInt8 *theSrc, UInt8 *theDst, long theWidth);
+static void						QTCmpr_BlockSums_SSE2 (UInt8 *theSrc, UInt8 *theDst, long theRowBytes, long theNumBlocks, SInt32 (*theSums)[4]);
+#endif
+
+#endif	// __QTCmprQuality__
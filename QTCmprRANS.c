@@ -0,0 +1,591 @@
+//////////
+//
+//	File:		QTCmprRANS.c
+//
+//	Contains:	An interleaved rANS entropy coder, for use by QTCompress.
+//
+//	Written by:	Tim Monroe
+//
+//	Copyright:	 2000 by Apple Computer, Inc., all rights reserved.
+//
+//	Change History (most recent first):
+//
+//	   <1>	 	11/06/26	rtm		first file
+//
+//	Most of the data we handle is coded by compressor components, but some of it we keep ourselves (for instance,
+//	the rendered frames in the frame cache; see QTCmprFrameCache.c). This file codes blocks of bytes with range
+//	asymmetric numeral systems (rANS), which compresses as well as arithmetic coding and decodes with a table
+//	lookup, a multiply, and an occasional byte read per symbol.
+//
+//	A block is coded with one of two models of the symbol frequencies. A static model uses the frequencies of the
+//	whole block, which are stored with it; an adaptive model starts with all symbols equally likely and is rebuilt
+//	from the counts of the symbols coded so far after every kRANSAdaptInterval symbols, so nothing is stored. If
+//	coding doesn't make a block smaller, it's stored as it is.
+//
+//	rANS decodes symbols in the reverse of the order they were encoded, so we encode from the end of the block
+//	to the start, writing bytes from the end of the output buffer backward; with an adaptive model, we first run
+//	through the block forward to find the frequencies for each interval. Successive symbols use kRANSNumStates
+//	different states, which share one stream of bytes; since the states don't depend on each other, the decoder
+//	can work on all of them at once.
+//
+//	A coded block is laid out as follows (multi-byte values are little-endian):
+//
+//		1 byte		the method (kRANSMethodStored, kRANSMethodStatic, or kRANSMethodAdaptive)
+//		4 bytes		the decoded size
+//		(static)	32 bytes holding a bit for each symbol used, then 2 bytes for the frequency of each symbol used
+//		16 bytes	the final encoder states, which the decoder starts with
+//		n bytes		the stream
+//
+//////////
+
+//////////
+//
+// header files
+//
+//////////
+
+#include "QTCompress.h"
+
+
+//////////
+//
+// macros
+//
+//////////
+
+// decode a symbol with the state theX into theSymbol
+#define QTCmpr_DecodeRANSStep(theX, theSymbol)																	\
+	{																											\
+		UInt32		mySlot = (theX) & (kRANSProbScale - 1);															\
+		UInt8		mySymbol = mySymbols[mySlot];																\
+																												\
+		(theSymbol) = mySymbol;																					\
+		(theX) = (myFreqs[mySymbol] * ((theX) >> kRANSProbBits)) + mySlot - myStarts[mySymbol];					\
+	}
+
+// read a byte into the state theX if it needs one; the byte at myPtr is read even if it isn't needed
+#define QTCmpr_RefillRANSState(theX)																			\
+	{																											\
+		UInt32		myIsLow = ((theX) < kRANSLowerBound);														\
+																												\
+		(theX) = myIsLow ? (((theX) << 8) | *myPtr) : (theX);													\
+		myPtr += myIsLow;																						\
+	}
+
+
+//////////
+//
+// QTCmpr_GetRANSBound
+// Return the size of the buffer that QTCmpr_RANSEncode needs to code a block of the specified size.
+//
+//////////
+
+long QTCmpr_GetRANSBound (long theSize)
+{
+	return(kRANSHeaderSize + kRANSMaxTableSize + theSize);
+}
+
+
+//////////
+//
+// QTCmpr_RANSEncode
+// Code a block of bytes with the specified method, and return the size of the result in theEncodedSize; if
+// coding doesn't make the block smaller, it's stored instead.
+//
+// The destination buffer must be at least QTCmpr_GetRANSBound(theSize) bytes long.
+//
+//////////
+
+OSErr QTCmpr_RANSEncode (UInt8 *theSrc, long theSize, short theMethod, UInt8 *theDst, long theDstSize, long *theEncodedSize)
+{
+	RANSModelPtr				myModel = NULL;
+	UInt16						*myTables = NULL;				// the adaptive model's frequencies and starts for each interval
+	UInt8						*myTable = theDst + kRANSHeaderSize;
+	long						myTableSize = 0L;
+	UInt8						*myLimit;
+	UInt8						*myStream = theDst + theDstSize;
+	long						myNumIntervals, myInterval;
+	long						myIndex;
+	Boolean						isCoded = false;
+	OSErr						myErr = noErr;
+
+	if ((theSrc == NULL) || (theDst == NULL) || (theSize < 0L) || (theDstSize < QTCmpr_GetRANSBound(theSize)))
+		return(paramErr);
+
+	if ((theSize > 0L) && ((theMethod == kRANSMethodStatic) || (theMethod == kRANSMethodAdaptive))) {
+		myModel = (RANSModelPtr)NewPtr(sizeof(RANSModel));
+		if (myModel == NULL) {
+			myErr = memFullErr;
+			goto bail;
+		}
+
+		if (theMethod == kRANSMethodStatic) {
+			memset(myModel->fCounts, 0, sizeof(myModel->fCounts));
+			for (myIndex = 0; myIndex < theSize; myIndex++)
+				myModel->fCounts[theSrc[myIndex]]++;
+
+			QTCmpr_SetRANSFreqs(myModel, false);
+
+			// store the frequencies of the symbols used
+			memset(myTable, 0, 32);
+			myTableSize = 32L;
+			for (myIndex = 0; myIndex < 256; myIndex++) {
+				if (myModel->fFreqs[myIndex] == 0)
+					continue;
+
+				myTable[myIndex >> 3] |= (UInt8)(1 << (myIndex & 7));
+				myTable[myTableSize++] = (UInt8)(myModel->fFreqs[myIndex] & 0xFF);
+				myTable[myTableSize++] = (UInt8)(myModel->fFreqs[myIndex] >> 8);
+			}
+		} else {
+			myNumIntervals = (theSize + kRANSAdaptInterval - 1) / kRANSAdaptInterval;
+			myTables = (UInt16 *)NewPtr(myNumIntervals * 512L * sizeof(UInt16));
+			if (myTables == NULL) {
+				myErr = memFullErr;
+				goto bail;
+			}
+
+			// run through the block, recording the model used for each interval
+			QTCmpr_BeginAdaptiveModel(myModel, false);
+			for (myInterval = 0; myInterval < myNumIntervals; myInterval++) {
+				long				myStart = myInterval * kRANSAdaptInterval;
+
+				BlockMoveData(myModel->fFreqs, myTables + (myInterval * 512L), 256 * sizeof(UInt16));
+				BlockMoveData(myModel->fStarts, myTables + (myInterval * 512L) + 256, 256 * sizeof(UInt16));
+				QTCmpr_UpdateAdaptiveModel(myModel, theSrc + myStart, (theSize - myStart < kRANSAdaptInterval) ? (theSize - myStart) : kRANSAdaptInterval, false);
+			}
+		}
+
+		// a stream longer than the block is no use, so we stop if it gets that long
+		myLimit = myTable + myTableSize;
+		if (myLimit < theDst + theDstSize - theSize)
+			myLimit = theDst + theDstSize - theSize;
+
+		isCoded = QTCmpr_EncodeRANSSymbols(theSrc, theSize, myModel, myTables, myLimit, &myStream);
+		if (isCoded)
+			isCoded = (myTableSize + ((theDst + theDstSize) - myStream) < theSize);
+	}
+
+	if (isCoded) {
+		theDst[0] = (UInt8)theMethod;
+		BlockMoveData(myStream, myTable + myTableSize, (theDst + theDstSize) - myStream);
+		*theEncodedSize = kRANSHeaderSize + myTableSize + ((theDst + theDstSize) - myStream);
+	} else {
+		theDst[0] = kRANSMethodStored;
+		BlockMoveData(theSrc, theDst + kRANSHeaderSize, theSize);
+		*theEncodedSize = kRANSHeaderSize + theSize;
+	}
+
+	theDst[1] = (UInt8)(theSize & 0xFF);
+	theDst[2] = (UInt8)((theSize >> 8) & 0xFF);
+	theDst[3] = (UInt8)((theSize >> 16) & 0xFF);
+	theDst[4] = (UInt8)((theSize >> 24) & 0xFF);
+
+bail:
+	if (myModel != NULL)
+		DisposePtr((Ptr)myModel);
+	if (myTables != NULL)
+		DisposePtr((Ptr)myTables);
+
+	return(myErr);
+}
+
+
+//////////
+//
+// QTCmpr_RANSDecode
+// Decode a block coded by QTCmpr_RANSEncode; theDstSize must be the size of the original block.
+//
+// Return paramErr if the coded block is damaged.
+//
+//////////
+
+OSErr QTCmpr_RANSDecode (UInt8 *theSrc, long theSrcSize, UInt8 *theDst, long theDstSize)
+{
+	RANSModelPtr				myModel = NULL;
+	UInt8						*mySrcEnd = theSrc + theSrcSize;
+	UInt8						*myTable = theSrc + kRANSHeaderSize;
+	long						myTableSize = 32L;
+	long						mySize, mySum;
+	long						myIndex;
+	OSErr						myErr = noErr;
+
+	if ((theSrc == NULL) || (theDst == NULL) || (theSrcSize < kRANSHeaderSize))
+		return(paramErr);
+
+	mySize = (long)theSrc[1] | ((long)theSrc[2] << 8) | ((long)theSrc[3] << 16) | ((long)theSrc[4] << 24);
+	if (mySize != theDstSize)
+		return(paramErr);
+
+	if (theSrc[0] == kRANSMethodStored) {
+		if (theSrcSize != kRANSHeaderSize + mySize)
+			return(paramErr);
+
+		BlockMoveData(theSrc + kRANSHeaderSize, theDst, mySize);
+		return(noErr);
+	}
+
+	if ((theSrc[0] != kRANSMethodStatic) && (theSrc[0] != kRANSMethodAdaptive))
+		return(paramErr);
+
+	myModel = (RANSModelPtr)NewPtr(sizeof(RANSModel));
+	if (myModel == NULL)
+		return(memFullErr);
+
+	if (theSrc[0] == kRANSMethodStatic) {
+		if (mySrcEnd - myTable < 32) {
+			myErr = paramErr;
+			goto bail;
+		}
+
+		// read the frequencies of the symbols used, which must add up to kRANSProbScale
+		mySum = 0L;
+		for (myIndex = 0; myIndex < 256; myIndex++) {
+			myModel->fFreqs[myIndex] = 0;
+			if ((myTable[myIndex >> 3] & (1 << (myIndex & 7))) == 0)
+				continue;
+
+			if (mySrcEnd - myTable < myTableSize + 2) {
+				myErr = paramErr;
+				goto bail;
+			}
+
+			myModel->fFreqs[myIndex] = (UInt16)(myTable[myTableSize] | (myTable[myTableSize + 1] << 8));
+			myTableSize += 2;
+			mySum += myModel->fFreqs[myIndex];
+		}
+
+		if (mySum != kRANSProbScale) {
+			myErr = paramErr;
+			goto bail;
+		}
+
+		QTCmpr_SetRANSStarts(myModel, true);
+		myErr = QTCmpr_DecodeRANSSymbols(myTable + myTableSize, mySrcEnd, theDst, mySize, myModel, false);
+	} else {
+		QTCmpr_BeginAdaptiveModel(myModel, true);
+		myErr = QTCmpr_DecodeRANSSymbols(myTable, mySrcEnd, theDst, mySize, myModel, true);
+	}
+
+bail:
+	DisposePtr((Ptr)myModel);
+
+	return(myErr);
+}
+
+
+//////////
+//
+// QTCmpr_EncodeRANSSymbols
+// Encode the symbols of a block, from the last to the first, writing the stream backward from theEnd; return
+// false if the stream would go below theLimit. On success, theEnd points to the start of the stream.
+//
+// If theTables isn't NULL, it holds the frequencies and starts of the adaptive model for each interval;
+// otherwise, we use those in theModel.
+//
+//////////
+
+static Boolean QTCmpr_EncodeRANSSymbols (UInt8 *theSrc, long theSize, RANSModelPtr theModel, UInt16 *theTables, UInt8 *theLimit, UInt8 **theEnd)
+{
+	UInt32						myStates[kRANSNumStates];
+	UInt8						*myPtr = *theEnd;
+	UInt16						*myFreqs = theModel->fFreqs;
+	UInt16						*myStarts = theModel->fStarts;
+	long						myIntervalStart = theSize;
+	long						myIndex;
+	long						myState;
+
+	for (myState = 0; myState < kRANSNumStates; myState++)
+		myStates[myState] = kRANSLowerBound;
+
+	for (myIndex = theSize - 1; myIndex >= 0; myIndex--) {
+		UInt32					*myX = &myStates[myIndex & (kRANSNumStates - 1)];
+		UInt32					myFreq, myMax;
+
+		// each interval of an adaptive block has its own frequencies
+		if ((theTables != NULL) && (myIndex < myIntervalStart)) {
+			myIntervalStart = (myIndex / kRANSAdaptInterval) * kRANSAdaptInterval;
+			myFreqs = theTables + ((myIndex / kRANSAdaptInterval) * 512L);
+			myStarts = myFreqs + 256;
+		}
+
+		myFreq = myFreqs[theSrc[myIndex]];
+
+		// move bytes out of the state until encoding the symbol keeps it in range
+		myMax = ((kRANSLowerBound >> kRANSProbBits) << 8) * myFreq;
+		while (*myX >= myMax) {
+			if (myPtr <= theLimit)
+				return(false);
+
+			*--myPtr = (UInt8)(*myX & 0xFF);
+			*myX >>= 8;
+		}
+
+		*myX = ((*myX / myFreq) << kRANSProbBits) + (*myX % myFreq) + myStarts[theSrc[myIndex]];
+	}
+
+	// write the final states, the last one first, so that the decoder reads them in order
+	for (myState = kRANSNumStates - 1; myState >= 0; myState--) {
+		if (myPtr - 4 < theLimit)
+			return(false);
+
+		myPtr -= 4;
+		myPtr[0] = (UInt8)(myStates[myState] & 0xFF);
+		myPtr[1] = (UInt8)((myStates[myState] >> 8) & 0xFF);
+		myPtr[2] = (UInt8)((myStates[myState] >> 16) & 0xFF);
+		myPtr[3] = (UInt8)((myStates[myState] >> 24) & 0xFF);
+	}
+
+	*theEnd = myPtr;
+
+	return(true);
+}
+
+
+//////////
+//
+// QTCmpr_DecodeRANSSymbols
+// Decode theSize symbols from the stream between theSrc and theSrcEnd into theDst.
+//
+// Each pass of the inner loop decodes one symbol with each state, which it keeps in a local variable; the
+// states are independent, so their table lookups and multiplies can overlap. When we're done, every state must be back where the encoder
+// started it, and the whole stream must have been read; otherwise, the block is damaged.
+//
+//////////
+
+static OSErr QTCmpr_DecodeRANSSymbols (UInt8 *theSrc, UInt8 *theSrcEnd, UInt8 *theDst, long theSize, RANSModelPtr theModel, Boolean isAdaptive)
+{
+	UInt32						myStates[kRANSNumStates];
+	UInt8						*myPtr = theSrc;
+	UInt8						*mySymbols = theModel->fSymbols;		// (local copies, which the stores to theDst can't change)
+	UInt16						*myFreqs = theModel->fFreqs;
+	UInt16						*myStarts = theModel->fStarts;
+	UInt32						myX0, myX1, myX2, myX3;
+	long						myIndex = 0L;
+	long						myStart, myEnd;
+	long						myState;
+
+	if (theSrcEnd - myPtr < 4 * kRANSNumStates)
+		return(paramErr);
+
+	for (myState = 0; myState < kRANSNumStates; myState++, myPtr += 4)
+		myStates[myState] = (UInt32)myPtr[0] | ((UInt32)myPtr[1] << 8) | ((UInt32)myPtr[2] << 16) | ((UInt32)myPtr[3] << 24);
+
+	while (myIndex < theSize) {
+		myStart = myIndex;
+		myEnd = theSize;
+		if (isAdaptive && (myStart + kRANSAdaptInterval < theSize))
+			myEnd = myStart + kRANSAdaptInterval;
+
+		// a symbol for each state, while there are enough left; an interval is a multiple of kRANSNumStates
+		// symbols long, so symbol myIndex always goes with state myIndex % kRANSNumStates
+		for (; myIndex + kRANSNumStates <= myEnd; myIndex += kRANSNumStates) {
+			myX0 = myStates[0];
+			myX1 = myStates[1];
+			myX2 = myStates[2];
+			myX3 = myStates[3];
+
+			QTCmpr_DecodeRANSStep(myX0, theDst[myIndex]);
+			QTCmpr_DecodeRANSStep(myX1, theDst[myIndex + 1]);
+			QTCmpr_DecodeRANSStep(myX2, theDst[myIndex + 2]);
+			QTCmpr_DecodeRANSStep(myX3, theDst[myIndex + 3]);
+
+			// a state never needs more than 2 bytes, so while there are enough left, we read them without branches,
+			// whose outcome is hard to predict
+			if (theSrcEnd - myPtr >= 2 * kRANSNumStates) {
+				QTCmpr_RefillRANSState(myX0);
+				QTCmpr_RefillRANSState(myX0);
+				QTCmpr_RefillRANSState(myX1);
+				QTCmpr_RefillRANSState(myX1);
+				QTCmpr_RefillRANSState(myX2);
+				QTCmpr_RefillRANSState(myX2);
+				QTCmpr_RefillRANSState(myX3);
+				QTCmpr_RefillRANSState(myX3);
+			}
+
+			myStates[0] = myX0;
+			myStates[1] = myX1;
+			myStates[2] = myX2;
+			myStates[3] = myX3;
+
+			for (myState = 0; myState < kRANSNumStates; myState++) {
+				while (myStates[myState] < kRANSLowerBound) {
+					if (myPtr >= theSrcEnd)
+						return(paramErr);
+
+					myStates[myState] = (myStates[myState] << 8) | *myPtr++;
+				}
+			}
+		}
+
+		// and the last few
+		for (; myIndex < myEnd; myIndex++) {
+			UInt32				*myX = &myStates[myIndex % kRANSNumStates];
+			UInt32				mySlot = *myX & (kRANSProbScale - 1);
+			UInt8				mySymbol = mySymbols[mySlot];
+
+			theDst[myIndex] = mySymbol;
+			*myX = (myFreqs[mySymbol] * (*myX >> kRANSProbBits)) + mySlot - myStarts[mySymbol];
+
+			while (*myX < kRANSLowerBound) {
+				if (myPtr >= theSrcEnd)
+					return(paramErr);
+
+				*myX = (*myX << 8) | *myPtr++;
+			}
+		}
+
+		if (isAdaptive)
+			QTCmpr_UpdateAdaptiveModel(theModel, theDst + myStart, myEnd - myStart, true);
+	}
+
+	for (myState = 0; myState < kRANSNumStates; myState++)
+		if (myStates[myState] != kRANSLowerBound)
+			return(paramErr);
+
+	return((myPtr == theSrcEnd) ? noErr : paramErr);
+}
+
+
+//////////
+//
+// QTCmpr_SetRANSFreqs
+// Set the model's frequencies from its counts, so that they add up to kRANSProbScale and every symbol that was
+// counted has a frequency of at least 1.
+//
+// We use only integer arithmetic, so that the adaptive model comes out the same everywhere.
+//
+//////////
+
+static void QTCmpr_SetRANSFreqs (RANSModelPtr theModel, Boolean theForDecoding)
+{
+	UInt32						myTotal = 0L;
+	UInt32						myShift = 0L;
+	long						mySum = 0L;
+	long						myExcess;
+	long						myIndex, myLargest;
+
+	for (myIndex = 0; myIndex < 256; myIndex++)
+		myTotal += theModel->fCounts[myIndex];
+
+	// scale the counts down, if need be, so that multiplying them by kRANSProbScale can't overflow
+	while ((myTotal >> myShift) >= (1UL << (31 - kRANSProbBits)))
+		myShift++;
+
+	if (myShift > 0L) {
+		myTotal = 0L;
+		for (myIndex = 0; myIndex < 256; myIndex++)
+			myTotal += theModel->fCounts[myIndex] >> myShift;
+	}
+
+	for (myIndex = 0; myIndex < 256; myIndex++) {
+		theModel->fFreqs[myIndex] = 0;
+		if (theModel->fCounts[myIndex] == 0)
+			continue;
+
+		theModel->fFreqs[myIndex] = (UInt16)(((theModel->fCounts[myIndex] >> myShift) << kRANSProbBits) / myTotal);
+		if (theModel->fFreqs[myIndex] == 0)
+			theModel->fFreqs[myIndex] = 1;
+
+		mySum += theModel->fFreqs[myIndex];
+	}
+
+	if (mySum == 0L)
+		return;
+
+	// the rounding leaves the sum a little off; take the difference from the most frequent symbols
+	while (mySum != kRANSProbScale) {
+		myLargest = 0;
+		for (myIndex = 1; myIndex < 256; myIndex++)
+			if (theModel->fFreqs[myIndex] > theModel->fFreqs[myLargest])
+				myLargest = myIndex;
+
+		if (mySum < kRANSProbScale) {
+			theModel->fFreqs[myLargest] += (UInt16)(kRANSProbScale - mySum);
+			mySum = kRANSProbScale;
+		} else {
+			myExcess = mySum - kRANSProbScale;
+			if (myExcess > theModel->fFreqs[myLargest] - 1)
+				myExcess = theModel->fFreqs[myLargest] - 1;
+
+			theModel->fFreqs[myLargest] -= (UInt16)myExcess;
+			mySum -= myExcess;
+		}
+	}
+
+	QTCmpr_SetRANSStarts(theModel, theForDecoding);
+}
+
+
+//////////
+//
+// QTCmpr_BeginAdaptiveModel
+// Set up an adaptive model, with every symbol equally likely.
+//
+//////////
+
+static void QTCmpr_BeginAdaptiveModel (RANSModelPtr theModel, Boolean theForDecoding)
+{
+	long						myIndex;
+
+	for (myIndex = 0; myIndex < 256; myIndex++)
+		theModel->fCounts[myIndex] = 1;
+
+	QTCmpr_SetRANSFreqs(theModel, theForDecoding);
+}
+
+
+//////////
+//
+// QTCmpr_UpdateAdaptiveModel
+// Count the specified symbols, and rebuild the model's frequencies; when the counts get large, we halve them,
+// so that the model follows changes in the data.
+//
+//////////
+
+static void QTCmpr_UpdateAdaptiveModel (RANSModelPtr theModel, UInt8 *theSymbols, long theNumSymbols, Boolean theForDecoding)
+{
+	UInt32						myTotal = 0L;
+	long						myIndex;
+
+	for (myIndex = 0; myIndex < 256; myIndex++)
+		myTotal += theModel->fCounts[myIndex];
+
+	for (myIndex = 0; myIndex < theNumSymbols; myIndex++) {
+		theModel->fCounts[theSymbols[myIndex]] += kRANSAdaptIncrement;
+		myTotal += kRANSAdaptIncrement;
+
+		if (myTotal > kRANSAdaptLimit) {
+			long				mySymbol;
+
+			myTotal = 0L;
+			for (mySymbol = 0; mySymbol < 256; mySymbol++) {
+				theModel->fCounts[mySymbol] = (theModel->fCounts[mySymbol] + 1) / 2;
+				myTotal += theModel->fCounts[mySymbol];
+			}
+		}
+	}
+
+	QTCmpr_SetRANSFreqs(theModel, theForDecoding);
+}
+
+
+//////////
+//
+// QTCmpr_SetRANSStarts
+// Set the start of each symbol's range of slots from the frequencies; a decoder also needs the symbol of each slot.
+//
+//////////
+
+static void QTCmpr_SetRANSStarts (RANSModelPtr theModel, Boolean theForDecoding)
+{
+	long						myStart = 0L;
+	long						myIndex;
+
+	for (myIndex = 0; myIndex < 256; myIndex++) {
+		theModel->fStarts[myIndex] = (UInt16)myStart;
+		if (theForDecoding)
+			memset(theModel->fSymbols + myStart, myIndex, theModel->fFreqs[myIndex]);
+		myStart += theModel->fFreqs[myIndex];
+	}
+}
@@ -0,0 +1,89 @@
+//////////
+//
+//	File:		QTCmprRANS.h
+//
+//	Contains:	An interleaved rANS entropy coder, for use by QTCompress.
+//
+//	Written by:	Tim Monroe
+//
+//	Copyright:	 2000 by Apple Computer, Inc., all rights reserved.
+//
+//	Change History (most recent first):
+//
+//	   <1>	 	11/06/26	rtm		first file
+//
+//////////
+
+#pragma once
+
+
+//////////
+//
+// header files
+//
+//////////
+
+#ifndef __QTCmprRANS__
+#define __QTCmprRANS__
+
+#ifndef __MOVIES__
+#include <Movies.h>
+#endif
+
+
+//////////
+//
+// constants
+//
+//////////
+
+#define kRANSProbBits					12						// the symbol frequencies add up to 1 << kRANSProbBits
+#define kRANSProbScale					(1L << kRANSProbBits)
+#define kRANSLowerBound					(1UL << 23)				// each state stays in [kRANSLowerBound, kRANSLowerBound << 8)
+#define kRANSNumStates					4						// the number of interleaved states (the decoder is written out for 4)
+#define kRANSAdaptInterval				4096					// the adaptive model is rebuilt after every this many symbols
+#define kRANSAdaptIncrement				32						// how much the adaptive model counts each symbol
+#define kRANSAdaptLimit					(1L << 16)				// when the counts add up to more than this, they're halved
+#define kRANSHeaderSize					5						// the method, and the decoded size
+#define kRANSMaxTableSize				(32 + (256 * 2))		// the static model: a bitmap of the symbols used, and their frequencies
+
+// the ways a block can be coded
+enum {
+	kRANSMethodStored					= 0,					// not coded at all
+	kRANSMethodStatic					= 1,					// with the frequencies of the whole block, which are stored with it
+	kRANSMethodAdaptive					= 2						// with frequencies learned as the block is coded
+};
+
+
+//////////
+//
+// data types
+//
+//////////
+
+// a model of the symbol frequencies
+typedef struct RANSModel {
+	UInt32						fCounts[256];						// the counts that the frequencies are made from
+	UInt16						fFreqs[256];						// the frequency of each symbol, out of kRANSProbScale
+	UInt16						fStarts[256];						// the total frequency of the symbols before it
+	UInt8						fSymbols[kRANSProbScale];			// the symbol of each slot, for decoding
+} RANSModel, *RANSModelPtr;
+
+
+//////////
+//
+// function prototypes
+//
+//////////
+
+long							QTCmpr_GetRANSBound (long theSize);
+OSErr							QTCmpr_RANSEncode (UInt8 *theSrc, long theSize, short theMethod, UInt8 *theDst, long theDstSize, long *theEncodedSize);
+OSErr							QTCmpr_RANSDecode (UInt8 *theSrc, long theSrcSize, UInt8 *theDst, long theDstSize);
+static Boolean					QTCmpr_EncodeRANSSymbols (UInt8 *theSrc, long theSize, RANSModelPtr theModel, UInt16 *theTables, UInt8 *theLimit, UInt8 **theEnd);
+static OSErr					QTCmpr_DecodeRANSSymbols (UInt8 *theSrc, UInt8 *theSrcEnd, UInt8 *theDst, long theSize, RANSModelPtr theModel, Boolean isAdaptive);
+static void						QTCmpr_SetRANSFreqs (RANSModelPtr theModel, Boolean theForDecoding);
+static void						QTCmpr_BeginAdaptiveModel (RANSModelPtr theModel, Boolean theForDecoding);
+static void						QTCmpr_UpdateAdaptiveModel (RANSModelPtr theModel, UInt8 *theSymbols, long theNumSymbols, Boolean theForDecoding);
+static void						QTCmpr_SetRANSStarts (RANSModelPtr theModel, Boolean theForDecoding);
+
+#endif	// __QTCmprRANS__
@@ -0,0 +1,681 @@
+//////////
+//
+//	File:		QTCmprResize.c
+//
+//	Contains:	Resampling of 32-bit frames to a different size, for use by QTCompress.
+//
+//	Written by:	Tim Monroe
+//
+//	Copyright:	 2000 by Apple Computer, Inc., all rights reserved.
+//
+//	Change History (most recent first):
+//
+//	   <2>	 	11/07/26	rtm		each pass is done in slices, on the threads in QTCmprSlice.c
+//	   <1>	 	11/02/26	rtm		first file
+//
+//	When the user asks for output of a different size than the source (see QTCmpr_GetOutputSize), we render each
+//	frame at its natural size and then resample it into a graphics world of the output size, which is what we
+//	compress. Drawing the movie straight into a smaller graphics world would be quicker, but QuickDraw scales by
+//	dropping or repeating pixels, which makes shrunken frames shimmer and look jagged.
+//
+//	The resampling is separable: a horizontal pass filters each source row down (or up) to the output width, and
+//	a vertical pass filters those rows to the output height; a pass is skipped if its dimension doesn't change.
+//	Each output pixel is a weighted sum of a fixed number of neighbouring source pixels. The weights depend only
+//	on the two sizes and the filter, so we work them out once, in QTCmpr_NewResizer, as 14-bit fixed-point numbers
+//	that add up to exactly 1; the buffer between the passes is also allocated there, so resizing a frame allocates
+//	no memory. When shrinking, the filter is stretched to cover all the source pixels that fall under an output
+//	pixel; source pixels beyond an edge are taken to be copies of the edge pixel.
+//
+//	As with the color conversions in QTCmprColor.c, there is a plain C version of each pass and, on x86 processors
+//	with SSE2, a version that uses the same integer arithmetic on several components at once; the SSE2 versions are
+//	used only if they give the same results as the C versions on a small test frame.
+//
+//	Within a pass, the output rows are independent, so each pass is cut into slices that are done on several
+//	threads at once (see QTCmprSlice.c); the vertical pass starts only once the whole horizontal pass is done.
+//
+//////////
+
+//////////
+//
+// header files
+//
+//////////
+
+#include "QTCompress.h"
+#include <math.h>
+
+
+//////////
+//
+// global variables
+//
+//////////
+
+static ResizeKernels				gResizeKernels;						// the pass routines we use
+static Boolean						gResizeKernelsReady = false;
+
+// the C pass routines, which are also the reference for the SSE2 ones
+static ResizeKernels				gResizeKernels_C = {QTCmpr_ResizeRow_C, QTCmpr_ResizeColumns_C, "C"};
+
+#if USE_SSE2_KERNELS
+static ResizeKernels				gResizeKernels_SSE2 = {QTCmpr_ResizeRow_SSE2, QTCmpr_ResizeColumns_SSE2, "SSE2"};
+#endif
+
+#define kResizePi					3.14159265358979323846
+
+
+//////////
+//
+// QTCmpr_NewResizer
+// Prepare to resample the frames in one 32-bit pixel map into another, using the specified filter.
+//
+// The two pixel maps must have the same component order. Call QTCmpr_DisposeResizer even if this function fails.
+//
+//////////
+
+OSErr QTCmpr_NewResizer (ResizerPtr theResizer, PixMapHandle theSrcPixMap, PixMapHandle theDstPixMap, long theFilter, MemoryJobPtr theJob)
+{
+	Rect						mySrcRect, myDstRect;
+	OSErr						myErr = noErr;
+
+	if (theResizer == NULL)
+		return(paramErr);
+
+	theResizer->fSrcPixMap = theSrcPixMap;
+	theResizer->fDstPixMap = theDstPixMap;
+	theResizer->fFilter = theFilter;
+	theResizer->fHTaps.fStarts = NULL;
+	theResizer->fHTaps.fWeights = NULL;
+	theResizer->fVTaps.fStarts = NULL;
+	theResizer->fVTaps.fWeights = NULL;
+	theResizer->fBuffer = NULL;
+	theResizer->fBufferRowBytes = 0L;
+	theResizer->fNumFrames = 0L;
+	theResizer->fResizeTime = 0.0;
+	theResizer->fSize = 0L;
+	theResizer->fJob = theJob;
+
+	if ((theSrcPixMap == NULL) || (theDstPixMap == NULL))
+		return(paramErr);
+
+	if ((GetPixDepth(theSrcPixMap) != 32) || (GetPixDepth(theDstPixMap) != 32))
+		return(paramErr);
+
+	GetPixBounds(theSrcPixMap, &mySrcRect);
+	GetPixBounds(theDstPixMap, &myDstRect);
+	theResizer->fSrcWidth = mySrcRect.right - mySrcRect.left;
+	theResizer->fSrcHeight = mySrcRect.bottom - mySrcRect.top;
+	theResizer->fDstWidth = myDstRect.right - myDstRect.left;
+	theResizer->fDstHeight = myDstRect.bottom - myDstRect.top;
+
+	if ((theResizer->fSrcWidth <= 0) || (theResizer->fSrcHeight <= 0) || (theResizer->fDstWidth <= 0) || (theResizer->fDstHeight <= 0))
+		return(paramErr);
+
+	// if both dimensions change, the horizontal pass needs somewhere to put its rows
+	if ((theResizer->fSrcWidth != theResizer->fDstWidth) && (theResizer->fSrcHeight != theResizer->fDstHeight)) {
+		theResizer->fBufferRowBytes = theResizer->fDstWidth * 4L;
+		theResizer->fSize = theResizer->fSrcHeight * theResizer->fBufferRowBytes;
+		QTCmpr_ReserveMemory(theJob, theResizer->fSize);
+
+		theResizer->fBuffer = (UInt8 *)NewPtr(theResizer->fSize);
+		if (theResizer->fBuffer == NULL)
+			return(memFullErr);
+	}
+
+	if (theResizer->fSrcWidth != theResizer->fDstWidth) {
+		myErr = QTCmpr_NewResizeTaps(&theResizer->fHTaps, theResizer->fSrcWidth, theResizer->fDstWidth, theFilter);
+		if (myErr != noErr)
+			return(myErr);
+	}
+
+	if (theResizer->fSrcHeight != theResizer->fDstHeight) {
+		myErr = QTCmpr_NewResizeTaps(&theResizer->fVTaps, theResizer->fSrcHeight, theResizer->fDstHeight, theFilter);
+		if (myErr != noErr)
+			return(myErr);
+	}
+
+	return(noErr);
+}
+
+
+//////////
+//
+// QTCmpr_ResizeFrame
+// Resample the frame in the resizer's source pixel map into its destination pixel map.
+//
+//////////
+
+void QTCmpr_ResizeFrame (ResizerPtr theResizer)
+{
+	UnsignedWide				myStart, myEnd;
+
+	Microseconds(&myStart);
+
+	// make sure the pass routines are chosen before any other thread needs them
+	QTCmpr_GetResizeKernels();
+
+	if (theResizer->fSrcWidth != theResizer->fDstWidth)
+		QTCmpr_RunSlices(QTCmpr_ResizeRowsSlice, theResizer, 0L, theResizer->fSrcHeight, 1L);
+
+	if (theResizer->fSrcHeight != theResizer->fDstHeight)
+		QTCmpr_RunSlices(QTCmpr_ResizeColumnsSlice, theResizer, 0L, theResizer->fDstHeight, 1L);
+
+	Microseconds(&myEnd);
+
+	theResizer->fResizeTime += ((double)myEnd.hi - (double)myStart.hi) * 4294967296.0 + ((double)myEnd.lo - (double)myStart.lo);
+	theResizer->fNumFrames++;
+}
+
+
+//////////
+//
+// QTCmpr_ResizeRowsSlice
+// Do the horizontal pass on source rows theTop through theBottom - 1.
+//
+// The horizontal pass writes straight into the destination if the height doesn't change; otherwise it writes into
+// the resizer's buffer, which the vertical pass reads. This is called on the threads in the slice pool.
+//
+//////////
+
+static void QTCmpr_ResizeRowsSlice (void *theRefCon, long theSlice, long theTop, long theBottom)
+{
+	ResizerPtr					myResizer = (ResizerPtr)theRefCon;
+	ResizeKernelsPtr			myKernels = QTCmpr_GetResizeKernels();
+	UInt8						*mySrc = (UInt8 *)GetPixBaseAddr(myResizer->fSrcPixMap);
+	long						mySrcRowBytes = QTGetPixMapHandleRowBytes(myResizer->fSrcPixMap);
+	UInt8						*myDst = (UInt8 *)GetPixBaseAddr(myResizer->fDstPixMap);
+	long						myDstRowBytes = QTGetPixMapHandleRowBytes(myResizer->fDstPixMap);
+	long						myRow;
+
+#pragma unused(theSlice)
+
+	if (myResizer->fBuffer != NULL) {
+		myDst = myResizer->fBuffer;
+		myDstRowBytes = myResizer->fBufferRowBytes;
+	}
+
+	for (myRow = theTop; myRow < theBottom; myRow++)
+		myKernels->fRow(mySrc + (myRow * mySrcRowBytes), myDst + (myRow * myDstRowBytes), myResizer->fDstWidth, &myResizer->fHTaps);
+}
+
+
+//////////
+//
+// QTCmpr_ResizeColumnsSlice
+// Do the vertical pass on destination rows theTop through theBottom - 1.
+//
+// The vertical pass reads the rows written by the horizontal pass if the width changes, and the source rows
+// otherwise. This is called on the threads in the slice pool.
+//
+//////////
+
+static void QTCmpr_ResizeColumnsSlice (void *theRefCon, long theSlice, long theTop, long theBottom)
+{
+	ResizerPtr					myResizer = (ResizerPtr)theRefCon;
+	ResizeKernelsPtr			myKernels = QTCmpr_GetResizeKernels();
+	ResizeTapsPtr				myTaps = &myResizer->fVTaps;
+	UInt8						*mySrc = (UInt8 *)GetPixBaseAddr(myResizer->fSrcPixMap);
+	long						mySrcRowBytes = QTGetPixMapHandleRowBytes(myResizer->fSrcPixMap);
+	UInt8						*myDst = (UInt8 *)GetPixBaseAddr(myResizer->fDstPixMap);
+	long						myDstRowBytes = QTGetPixMapHandleRowBytes(myResizer->fDstPixMap);
+	long						myRow;
+
+#pragma unused(theSlice)
+
+	if (myResizer->fSrcWidth != myResizer->fDstWidth) {
+		mySrc = myResizer->fBuffer;
+		mySrcRowBytes = myResizer->fBufferRowBytes;
+	}
+
+	for (myRow = theTop; myRow < theBottom; myRow++)
+		myKernels->fColumns(mySrc + (myTaps->fStarts[myRow] * mySrcRowBytes), mySrcRowBytes, myTaps->fWeights + (myRow * myTaps->fNumTaps),
+							myTaps->fNumTaps, myDst + (myRow * myDstRowBytes), myResizer->fDstWidth * 4L);
+}
+
+
+//////////
+//
+// QTCmpr_DisposeResizer
+// Dispose of the resizer's taps and buffer, and report how long the resizing took.
+//
+//////////
+
+void QTCmpr_DisposeResizer (ResizerPtr theResizer)
+{
+	if (theResizer == NULL)
+		return;
+
+	if (theResizer->fNumFrames > 0L)
+		QTCmpr_LogMessage("QTCmpr_DisposeResizer: resized %ld frames from %ldx%ld to %ldx%ld with the %s routines, %.0f us per frame",
+							theResizer->fNumFrames, theResizer->fSrcWidth, theResizer->fSrcHeight, theResizer->fDstWidth, theResizer->fDstHeight,
+							QTCmpr_GetResizeKernels()->fName, theResizer->fResizeTime / theResizer->fNumFrames);
+
+	QTCmpr_DisposeResizeTaps(&theResizer->fHTaps);
+	QTCmpr_DisposeResizeTaps(&theResizer->fVTaps);
+
+	if (theResizer->fBuffer != NULL)
+		DisposePtr((Ptr)theResizer->fBuffer);
+	theResizer->fBuffer = NULL;
+
+	QTCmpr_ReleaseMemory(theResizer->fJob, theResizer->fSize);
+	theResizer->fSize = 0L;
+}
+
+
+//////////
+//
+// QTCmpr_NewResizeTaps
+// Work out the filter taps for resampling theSrcSize pixels to theDstSize pixels.
+//
+// Source pixel j covers the interval [j, j + 1), and output pixel i is centered on (i + 0.5) * theSrcSize / theDstSize
+// in those coordinates. Weights of pixels beyond an edge are added to the edge pixel, and every output pixel gets
+// the same number of taps (some of which may have a weight of 0), so that the pass routines have no special cases.
+//
+//////////
+
+static OSErr QTCmpr_NewResizeTaps (ResizeTapsPtr theTaps, long theSrcSize, long theDstSize, long theFilter)
+{
+	double						myScale = (double)theSrcSize / (double)theDstSize;
+	double						myStretch = (myScale > 1.0) ? myScale : 1.0;
+	double						mySupport;
+	double						*myWeights = NULL;
+	long						myNumTaps;
+	long						myPixel, myLast, myIndex, myTap, myLargest;
+	long						mySum;
+	OSErr						myErr = noErr;
+
+	// the distance from an output pixel's center to the farthest source pixel it uses, in source pixels
+	switch (theFilter) {
+		case kResizeFilterBicubic:	mySupport = 2.0;	break;
+		case kResizeFilterArea:		mySupport = 0.5;	break;
+		default:					mySupport = 3.0;	break;
+	}
+	mySupport *= myStretch;
+
+	myNumTaps = (long)ceil(mySupport * 2.0) + 1;
+	if (myNumTaps > theSrcSize)
+		myNumTaps = theSrcSize;
+
+	theTaps->fNumTaps = myNumTaps;
+	theTaps->fStarts = (long *)NewPtr(theDstSize * sizeof(long));
+	theTaps->fWeights = (short *)NewPtrClear(theDstSize * myNumTaps * sizeof(short));
+	myWeights = (double *)NewPtr(myNumTaps * sizeof(double));
+	if ((theTaps->fStarts == NULL) || (theTaps->fWeights == NULL) || (myWeights == NULL)) {
+		myErr = memFullErr;
+		goto bail;
+	}
+
+	for (myIndex = 0; myIndex < theDstSize; myIndex++) {
+		double					myCenter = (myIndex + 0.5) * myScale;
+		double					myTotal = 0.0;
+		short					*myTaps = theTaps->fWeights + (myIndex * myNumTaps);
+		long					myStart;
+
+		myPixel = (long)floor(myCenter - mySupport);
+		myLast = (long)ceil(myCenter + mySupport) - 1;
+
+		// the taps begin at the first pixel in the image, but must not run off its far edge
+		myStart = (myPixel > 0) ? myPixel : 0;
+		if (myStart + myNumTaps > theSrcSize)
+			myStart = theSrcSize - myNumTaps;
+		theTaps->fStarts[myIndex] = myStart;
+
+		for (myTap = 0; myTap < myNumTaps; myTap++)
+			myWeights[myTap] = 0.0;
+
+		for (; myPixel <= myLast; myPixel++) {
+			double				myWeight = QTCmpr_GetFilterWeight(theFilter, myCenter, myStretch, myPixel);
+
+			myTap = (myPixel < 0) ? 0 : ((myPixel > theSrcSize - 1) ? theSrcSize - 1 : myPixel);
+			myTap -= myStart;
+			if ((myTap >= 0) && (myTap < myNumTaps)) {
+				myWeights[myTap] += myWeight;
+				myTotal += myWeight;
+			}
+		}
+
+		// the filter can't miss every pixel, but play it safe
+		if (myTotal == 0.0)
+			myWeights[0] = myTotal = 1.0;
+
+		// convert the weights to fixed point; rounding may leave them a little off 1, so we give the difference
+		// to the largest weight
+		mySum = 0L;
+		myLargest = 0L;
+		for (myPixel = 0; myPixel < myNumTaps; myPixel++) {
+			myTaps[myPixel] = (short)floor((myWeights[myPixel] / myTotal) * (1L << kResizeWeightShift) + 0.5);
+			mySum += myTaps[myPixel];
+			if (myTaps[myPixel] > myTaps[myLargest])
+				myLargest = myPixel;
+		}
+
+		myTaps[myLargest] += (short)((1L << kResizeWeightShift) - mySum);
+	}
+
+bail:
+	if (myWeights != NULL)
+		DisposePtr((Ptr)myWeights);
+
+	return(myErr);
+}
+
+
+//////////
+//
+// QTCmpr_DisposeResizeTaps
+// Dispose of the specified filter taps.
+//
+//////////
+
+static void QTCmpr_DisposeResizeTaps (ResizeTapsPtr theTaps)
+{
+	if (theTaps->fStarts != NULL)
+		DisposePtr((Ptr)theTaps->fStarts);
+	theTaps->fStarts = NULL;
+
+	if (theTaps->fWeights != NULL)
+		DisposePtr((Ptr)theTaps->fWeights);
+	theTaps->fWeights = NULL;
+}
+
+
+//////////
+//
+// QTCmpr_GetFilterWeight
+// Return the (unnormalized) weight of the specified source pixel in the output pixel centered on theCenter.
+//
+//////////
+
+static double QTCmpr_GetFilterWeight (long theFilter, double theCenter, double theStretch, long thePixel)
+{
+	double						myX = fabs((thePixel + 0.5 - theCenter) / theStretch);
+	double						myLeft, myRight;
+
+	switch (theFilter) {
+		case kResizeFilterBicubic:
+			// Catmull-Rom, which is the cubic with a = -0.5
+			if (myX < 1.0)
+				return((1.5 * myX * myX * myX) - (2.5 * myX * myX) + 1.0);
+			if (myX < 2.0)
+				return((-0.5 * myX * myX * myX) + (2.5 * myX * myX) - (4.0 * myX) + 2.0);
+			return(0.0);
+
+		case kResizeFilterArea:
+			// the part of the pixel that lies under the output pixel
+			myLeft = theCenter - (theStretch / 2.0);
+			myRight = theCenter + (theStretch / 2.0);
+			if (myLeft < thePixel)
+				myLeft = thePixel;
+			if (myRight > thePixel + 1)
+				myRight = thePixel + 1;
+			return((myRight > myLeft) ? (myRight - myLeft) : 0.0);
+
+		default:
+			// Lanczos: sinc(x) * sinc(x / 3)
+			if (myX < 1.0e-6)
+				return(1.0);
+			if (myX >= 3.0)
+				return(0.0);
+			return((3.0 * sin(kResizePi * myX) * sin(kResizePi * myX / 3.0)) / (kResizePi * kResizePi * myX * myX));
+	}
+}
+
+
+//////////
+//
+// QTCmpr_GetResizeKernels
+// Return the pass routines to use: the SSE2 ones, if the processor has SSE2 and they give the same results as the
+// C ones, or else the C ones.
+//
+//////////
+
+static ResizeKernelsPtr QTCmpr_GetResizeKernels (void)
+{
+	if (!gResizeKernelsReady) {
+		gResizeKernels = gResizeKernels_C;
+
+#if USE_SSE2_KERNELS
+		if (QTCmpr_HasSSE2()) {
+			if (QTCmpr_CheckResizeKernels(&gResizeKernels_SSE2, &gResizeKernels_C))
+				gResizeKernels = gResizeKernels_SSE2;
+			else
+				QTCmpr_LogMessage("QTCmpr_GetResizeKernels: the SSE2 routines don't match the C routines; using the C routines");
+		}
+#endif
+
+		gResizeKernelsReady = true;
+	}
+
+	return(&gResizeKernels);
+}
+
+
+//////////
+//
+// QTCmpr_CheckResizeKernels
+// Do the specified pass routines produce exactly the same results as the reference routines?
+//
+// We shrink and enlarge a test frame with each filter; the frame is wide enough to exercise both the SSE2 loops and
+// the leftover components, and the Lanczos and bicubic filters overshoot on its random pixels, so the results are
+// clamped too.
+//
+//////////
+
+static Boolean QTCmpr_CheckResizeKernels (ResizeKernelsPtr theKernels, ResizeKernelsPtr theReference)
+{
+	UInt8						myPixels[kResizeCheckHeight][kResizeCheckWidth * 4];
+	UInt8						myResults[2][kResizeCheckWidth * 2 * 4];
+	ResizeKernelsPtr			myKernels[2];
+	ResizeTaps					myTaps;
+	long						mySizes[2];
+	unsigned long				mySeed = 1L;
+	long						myFilter, myPass, myRow, myCol, myIndex;
+	Boolean						isSame = true;
+
+	myKernels[0] = theKernels;
+	myKernels[1] = theReference;
+
+	for (myRow = 0; myRow < kResizeCheckHeight; myRow++) {
+		for (myCol = 0; myCol < kResizeCheckWidth * 4; myCol++) {
+			mySeed = (mySeed * 1103515245L) + 12345L;
+			myPixels[myRow][myCol] = (UInt8)(mySeed >> 16);
+		}
+	}
+
+	for (myFilter = kResizeFilterLanczos; isSame && (myFilter <= kResizeFilterArea); myFilter++) {
+		for (myPass = 0; isSame && (myPass < 2); myPass++) {
+			// rows: shrink or enlarge the width
+			mySizes[0] = kResizeCheckWidth;
+			mySizes[1] = (myPass == 0) ? (kResizeCheckWidth / 3) : (kResizeCheckWidth * 2);
+			if (QTCmpr_NewResizeTaps(&myTaps, mySizes[0], mySizes[1], myFilter) == noErr) {
+				for (myRow = 0; myRow < kResizeCheckHeight; myRow++) {
+					for (myIndex = 0; myIndex < 2; myIndex++)
+						myKernels[myIndex]->fRow(myPixels[myRow], myResults[myIndex], mySizes[1], &myTaps);
+
+					if (memcmp(myResults[0], myResults[1], mySizes[1] * 4) != 0)
+						isSame = false;
+				}
+			}
+			QTCmpr_DisposeResizeTaps(&myTaps);
+
+			// columns: shrink or enlarge the height
+			mySizes[0] = kResizeCheckHeight;
+			mySizes[1] = (myPass == 0) ? 2 : (kResizeCheckHeight * 2);
+			if (QTCmpr_NewResizeTaps(&myTaps, mySizes[0], mySizes[1], myFilter) == noErr) {
+				for (myRow = 0; myRow < mySizes[1]; myRow++) {
+					for (myIndex = 0; myIndex < 2; myIndex++)
+						myKernels[myIndex]->fColumns(myPixels[myTaps.fStarts[myRow]], sizeof(myPixels[0]), myTaps.fWeights + (myRow * myTaps.fNumTaps),
+													myTaps.fNumTaps, myResults[myIndex], sizeof(myPixels[0]));
+
+					if (memcmp(myResults[0], myResults[1], sizeof(myPixels[0])) != 0)
+						isSame = false;
+				}
+			}
+			QTCmpr_DisposeResizeTaps(&myTaps);
+		}
+	}
+
+	return(isSame);
+}
+
+
+//////////
+//
+// QTCmpr_ResizeRow_C
+// Resample a row of 32-bit pixels to theDstWidth pixels.
+//
+//////////
+
+static void QTCmpr_ResizeRow_C (UInt8 *theSrc, UInt8 *theDst, long theDstWidth, ResizeTapsPtr theTaps)
+{
+	long						myNumTaps = theTaps->fNumTaps;
+	long						myCol, myTap, myComponent;
+
+	for (myCol = 0; myCol < theDstWidth; myCol++) {
+		UInt8					*mySrc = theSrc + (theTaps->fStarts[myCol] * 4);
+		short					*myWeights = theTaps->fWeights + (myCol * myNumTaps);
+
+		for (myComponent = 0; myComponent < 4; myComponent++) {
+			long				mySum = kResizeRound;
+
+			for (myTap = 0; myTap < myNumTaps; myTap++)
+				mySum += myWeights[myTap] * mySrc[(myTap * 4) + myComponent];
+
+			mySum >>= kResizeWeightShift;
+			*theDst++ = (mySum < 0) ? 0 : ((mySum > 255) ? 255 : mySum);
+		}
+	}
+}
+
+
+//////////
+//
+// QTCmpr_ResizeColumns_C
+// Make a row of theNumBytes bytes, each the weighted sum of the bytes in the same position in theNumTaps rows.
+//
+//////////
+
+static void QTCmpr_ResizeColumns_C (UInt8 *theSrc, long theRowBytes, short *theWeights, long theNumTaps, UInt8 *theDst, long theNumBytes)
+{
+	long						myIndex, myTap;
+
+	for (myIndex = 0; myIndex < theNumBytes; myIndex++) {
+		long					mySum = kResizeRound;
+
+		for (myTap = 0; myTap < theNumTaps; myTap++)
+			mySum += theWeights[myTap] * theSrc[(myTap * theRowBytes) + myIndex];
+
+		mySum >>= kResizeWeightShift;
+		theDst[myIndex] = (mySum < 0) ? 0 : ((mySum > 255) ? 255 : mySum);
+	}
+}
+
+
+#if USE_SSE2_KERNELS
+//////////
+//
+// QTCmpr_GetWeightPair_SSE2
+// Return a vector holding 4 copies of a pair of weights, for multiplying 4 pairs of components with _mm_madd_epi16.
+//
+//////////
+
+static __m128i QTCmpr_GetWeightPair_SSE2 (short theFirst, short theSecond)
+{
+	return(_mm_set1_epi32((long)((UInt16)theFirst | ((UInt32)(UInt16)theSecond << 16))));
+}
+
+
+//////////
+//
+// QTCmpr_ResizeRow_SSE2
+// Resample a row of 32-bit pixels to theDstWidth pixels, two taps at a time.
+//
+//////////
+
+static void QTCmpr_ResizeRow_SSE2 (UInt8 *theSrc, UInt8 *theDst, long theDstWidth, ResizeTapsPtr theTaps)
+{
+	__m128i						myZero = _mm_setzero_si128();
+	__m128i						myRound = _mm_set1_epi32(kResizeRound);
+	__m128i						myPixels, mySum;
+	long						myNumTaps = theTaps->fNumTaps;
+	long						myCol, myTap;
+
+	for (myCol = 0; myCol < theDstWidth; myCol++) {
+		UInt8					*mySrc = theSrc + (theTaps->fStarts[myCol] * 4);
+		short					*myWeights = theTaps->fWeights + (myCol * myNumTaps);
+
+		mySum = myRound;
+
+		// interleave the components of two neighbouring pixels, so that each 32-bit lane gets the weighted sum of one component
+		for (myTap = 0; myTap + 1 < myNumTaps; myTap += 2) {
+			myPixels = _mm_unpacklo_epi8(_mm_loadl_epi64((__m128i *)(mySrc + (myTap * 4))), myZero);
+			myPixels = _mm_unpacklo_epi16(myPixels, _mm_srli_si128(myPixels, 8));
+			mySum = _mm_add_epi32(mySum, _mm_madd_epi16(myPixels, QTCmpr_GetWeightPair_SSE2(myWeights[myTap], myWeights[myTap + 1])));
+		}
+
+		if (myTap < myNumTaps) {
+			myPixels = _mm_unpacklo_epi8(_mm_cvtsi32_si128(*(int *)(mySrc + (myTap * 4))), myZero);
+			myPixels = _mm_unpacklo_epi16(myPixels, myZero);
+			mySum = _mm_add_epi32(mySum, _mm_madd_epi16(myPixels, QTCmpr_GetWeightPair_SSE2(myWeights[myTap], 0)));
+		}
+
+		mySum = _mm_srai_epi32(mySum, kResizeWeightShift);
+		mySum = _mm_packs_epi32(mySum, mySum);
+		mySum = _mm_packus_epi16(mySum, mySum);
+		*(int *)(theDst + (myCol * 4)) = _mm_cvtsi128_si32(mySum);
+	}
+}
+
+
+//////////
+//
+// QTCmpr_ResizeColumns_SSE2
+// Make a row of theNumBytes bytes, each the weighted sum of the bytes in the same position in theNumTaps rows;
+// we do 16 bytes at a time, two rows at a time.
+//
+//////////
+
+static void QTCmpr_ResizeColumns_SSE2 (UInt8 *theSrc, long theRowBytes, short *theWeights, long theNumTaps, UInt8 *theDst, long theNumBytes)
+{
+	__m128i						myZero = _mm_setzero_si128();
+	__m128i						myRound = _mm_set1_epi32(kResizeRound);
+	__m128i						myFirst, mySecond, myLow, myHigh, myWeights;
+	__m128i						mySum0, mySum1, mySum2, mySum3;
+	long						myIndex, myTap;
+
+	for (myIndex = 0; myIndex + 16 <= theNumBytes; myIndex += 16) {
+		UInt8					*mySrc = theSrc + myIndex;
+
+		mySum0 = mySum1 = mySum2 = mySum3 = myRound;
+
+		for (myTap = 0; myTap < theNumTaps; myTap += 2) {
+			myFirst = _mm_loadu_si128((__m128i *)(mySrc + (myTap * theRowBytes)));
+			if (myTap + 1 < theNumTaps) {
+				mySecond = _mm_loadu_si128((__m128i *)(mySrc + ((myTap + 1) * theRowBytes)));
+				myWeights = QTCmpr_GetWeightPair_SSE2(theWeights[myTap], theWeights[myTap + 1]);
+			} else {
+				mySecond = myZero;
+				myWeights = QTCmpr_GetWeightPair_SSE2(theWeights[myTap], 0);
+			}
+
+			myLow = _mm_unpacklo_epi8(myFirst, myZero);
+			myHigh = _mm_unpacklo_epi8(mySecond, myZero);
+			mySum0 = _mm_add_epi32(mySum0, _mm_madd_epi16(_mm_unpacklo_epi16(myLow, myHigh), myWeights));
+			mySum1 = _mm_add_epi32(mySum1, _mm_madd_epi16(_mm_unpackhi_epi16(myLow, myHigh), myWeights));
+
+			myLow = _mm_unpackhi_epi8(myFirst, myZero);
+			myHigh = _mm_unpackhi_epi8(mySecond, myZero);
+			mySum2 = _mm_add_epi32(mySum2, _mm_madd_epi16(_mm_unpacklo_epi16(myLow, myHigh), myWeights));
+			mySum3 = _mm_add_epi32(mySum3, _mm_madd_epi16(_mm_unpackhi_epi16(myLow, myHigh), myWeights));
+		}
+
+		myLow = _mm_packs_epi32(_mm_srai_epi32(mySum0, kResizeWeightShift), _mm_srai_epi32(mySum1, kResizeWeightShift));
+		myHigh = _mm_packs_epi32(_mm_srai_epi32(mySum2, kResizeWeightShift), _mm_srai_epi32(mySum3, kResizeWeightShift));
+		_mm_storeu_si128((__m128i *)(theDst + myIndex), _mm_packus_epi16(myLow, myHigh));
+	}
+
+	// do any leftover bytes the slow way
+	if (myIndex < theNumBytes)
+		QTCmpr_ResizeColumns_C(theSrc + myIndex, theRowBytes, theWeights, theNumTaps, theDst + myIndex, theNumBytes - myIndex);
+}
+#endif	// USE_SSE2_KERNELS
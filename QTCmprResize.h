@@ -0,0 +1,127 @@
+//////////
+//
+//	File:		QTCmprResize.h
+//
+//	Contains:	Resampling of 32-bit frames to a different size, for use by QTCompress.
+//
+//	Written by:	Tim Monroe
+//
+//	Copyright:	 2000 by Apple Computer, Inc., all rights reserved.
+//
+//	Change History (most recent first):
+//
+//	   <2>	 	11/07/26	rtm		added QTCmpr_ResizeRowsSlice and QTCmpr_ResizeColumnsSlice
+//	   <1>	 	11/02/26	rtm		first file
+//
+//////////
+
+#pragma once
+
+
+//////////
+//
+// header files
+//
+//////////
+
+#ifndef __QTCmprResize__
+#define __QTCmprResize__
+
+#ifndef __MOVIES__
+#include <Movies.h>
+#endif
+
+#include "QTCmprBudget.h"
+#include "QTCmprColor.h"										// for USE_SSE2_KERNELS
+
+
+//////////
+//
+// constants
+//
+//////////
+
+#define kResizeWeightShift				14						// fraction bits in the filter weights
+#define kResizeRound					(1L << (kResizeWeightShift - 1))
+#define kResizeCheckWidth				37						// size of the test frame we compare the SSE2 and C routines on
+#define kResizeCheckHeight				5
+
+// the resampling filters
+enum {
+	kResizeFilterLanczos				= 1,					// Lanczos, 3 lobes; the sharpest
+	kResizeFilterBicubic				= 2,					// Catmull-Rom cubic
+	kResizeFilterArea					= 3						// the average of the pixels each output pixel covers
+};
+
+
+//////////
+//
+// data types
+//
+//////////
+
+// the filter taps for one dimension: output pixel i is the weighted sum of the fNumTaps source pixels beginning
+// with fStarts[i], using the fNumTaps weights beginning with fWeights[i * fNumTaps]; the weights are in fixed
+// point, with kResizeWeightShift fraction bits, and add up to exactly 1
+typedef struct ResizeTaps {
+	long						fNumTaps;
+	long						*fStarts;
+	short						*fWeights;
+} ResizeTaps, *ResizeTapsPtr;
+
+// the routines that do the two passes; each byte of a pixel is filtered separately, so the component order
+// doesn't matter
+typedef void (*ResizeRowProcPtr) (UInt8 *theSrc, UInt8 *theDst, long theDstWidth, ResizeTapsPtr theTaps);
+typedef void (*ResizeColumnsProcPtr) (UInt8 *theSrc, long theRowBytes, short *theWeights, long theNumTaps, UInt8 *theDst, long theNumBytes);
+
+typedef struct ResizeKernels {
+	ResizeRowProcPtr			fRow;
+	ResizeColumnsProcPtr		fColumns;
+	char						*fName;
+} ResizeKernels, *ResizeKernelsPtr;
+
+// a resampler from the graphics world that frames are rendered in to a graphics world of the output size
+typedef struct Resizer {
+	PixMapHandle				fSrcPixMap;
+	PixMapHandle				fDstPixMap;
+	long						fFilter;
+	long						fSrcWidth;
+	long						fSrcHeight;
+	long						fDstWidth;
+	long						fDstHeight;
+	ResizeTaps					fHTaps;								// the taps of the horizontal pass, if the width changes
+	ResizeTaps					fVTaps;								// the taps of the vertical pass, if the height changes
+	UInt8						*fBuffer;							// the rows of the horizontal pass, if both passes are needed
+	long						fBufferRowBytes;
+	long						fNumFrames;
+	double						fResizeTime;						// microseconds spent resizing frames
+	long						fSize;								// the number of bytes reserved
+	MemoryJobPtr				fJob;
+} Resizer, *ResizerPtr;
+
+
+//////////
+//
+// function prototypes
+//
+//////////
+
+OSErr							QTCmpr_NewResizer (ResizerPtr theResizer, PixMapHandle theSrcPixMap, PixMapHandle theDstPixMap, long theFilter, MemoryJobPtr theJob);
+void							QTCmpr_ResizeFrame (ResizerPtr theResizer);
+void							QTCmpr_DisposeResizer (ResizerPtr theResizer);
+static void						QTCmpr_ResizeRowsSlice (void *theRefCon, long theSlice, long theTop, long theBottom);
+static void						QTCmpr_ResizeColumnsSlice (void *theRefCon, long theSlice, long theTop, long theBottom);
+static OSErr					QTCmpr_NewResizeTaps (ResizeTapsPtr theTaps, long theSrcSize, long theDstSize, long theFilter);
+static void						QTCmpr_DisposeResizeTaps (ResizeTapsPtr theTaps);
+static double					QTCmpr_GetFilterWeight (long theFilter, double theCenter, double theStretch, long thePixel);
+static ResizeKernelsPtr			QTCmpr_GetResizeKernels (void);
+static Boolean					QTCmpr_CheckResizeKernels (ResizeKernelsPtr theKernels, ResizeKernelsPtr theReference);
+static void						QTCmpr_ResizeRow_C (UInt8 *theSrc, UInt8 *theDst, long theDstWidth, ResizeTapsPtr theTaps);
+static void						QTCmpr_ResizeColumns_C (UInt8 *theSrc, long theRowBytes, short *theWeights, long theNumTaps, UInt8 *theDst, long theNumBytes);
+#if USE_SSE2_KERNELS
+static __m128i					QTCmpr_GetWeightPair_SSE2 (short theFirst, short theSecond);
+static void						QTCmpr_ResizeRow_SSE2 (UInt8 *theSrc, UInt8 *theDst, long theDstWidth, ResizeTapsPtr theTaps);
+static void						QTCmpr_ResizeColumns_SSE2 (UInt8 *theSrc, long theRowBytes, short *theWeights, long theNumTaps, UInt8 *theDst, long theNumBytes);
+#endif
+
+#endif	// __QTCmprResize__
@@ -0,0 +1,625 @@
+//////////
+//
+//	File:		QTCmprSampleStore.c
+//
+//	Contains:	A store of compressed samples shared by many movie files, each distinct sample kept once, for use by
+//				QTCompress.
+//
+//	Written by:	Tim Monroe
+//
+//	Copyright:	 2000 by Apple Computer, Inc., all rights reserved.
+//
+//	Change History (most recent first):
+//
+//	   <3>	 	11/13/26	rtm		a copy of QTCompress holds a lock on the store from when it reads the index until it has
+//									updated it; one that can't get the lock doesn't use the store
+//	   <2>	 	11/13/26	rtm		the SHA-256 routines are now in QTCmprHash.c
+//	   <1>	 	11/10/26	rtm		first file
+//
+//	When a catalog of similar movies is compressed (the several sizes of one movie, or a batch of episodes with the
+//	same titles and slates), many of the compressed samples come out byte for byte the same: black frames, still
+//	frames, and whole intros. If a sample store is named in the environment (see QTCmpr_GetSampleStorePath), the
+//	media of each new movie refers not to the movie file but to the store, a single data file shared by all the
+//	movies; the sample writer (see QTCmprWriter.c) works out the SHA-256 digest of each sample, and a sample that's
+//	already in the store is added to the media as a reference to the copy in the store instead of being written
+//	again. The movie file itself holds only the movie atom.
+//
+//	An index file beside the store lists the samples in it, by digest, with their offsets and sizes; while a movie
+//	is being compressed, a hash table finds them. A new sample goes into the writer's chunk buffer as usual, and its
+//	record is pending until the chunk is written and its offset in the store is known; a sample that's repeated
+//	before then refers to the copy in the chunk. The records of new samples are added to the index only once the
+//	movie is complete, and only after the Movie Toolbox has written out their data; a compression that fails leaves
+//	some unreferenced data at the end of the store, but never an index entry for data that isn't there.
+//
+//	Only one copy of QTCompress at a time may add to a store: it takes an exclusive lock on a lock file beside the
+//	store before it reads the index, and keeps it until it has appended its samples and updated the index. The
+//	lock belongs to an open file, so it goes away with the process that held it; a copy that can't get the lock
+//	returns fBsyErr from QTCmpr_OpenSampleStore, and its caller writes the samples into the movie file instead.
+//
+//	A movie compressed this way plays only while the store is where it was; the media refer to it by alias.
+//	Samples are never removed from the store.
+//
+//////////
+
+//////////
+//
+// header files
+//
+//////////
+
+#include "QTCompress.h"
+
+#if TARGET_RT_MAC_MACHO
+#include <fcntl.h>
+#include <sys/file.h>
+#include <unistd.h>
+#endif
+
+
+//////////
+//
+// QTCmpr_OpenSampleStore
+// Open the sample store in the specified file, creating it if need be, lock it, and read its index.
+//
+// The memory for the index is reserved against the specified job. If another copy of QTCompress has the store
+// locked, return fBsyErr. Call QTCmpr_CheckSampleStore before looking up any samples, and QTCmpr_CloseSampleStore
+// even if this function fails.
+//
+//////////
+
+OSErr QTCmpr_OpenSampleStore (SampleStorePtr theStore, char *thePath, MemoryJobPtr theJob)
+{
+	SampleStoreHeader			myHeader;
+	FILE						*myFile = NULL;
+	long						myFileSize = 0L;
+	OSErr						myErr = noErr;
+
+	if ((theStore == NULL) || (thePath == NULL))
+		return(paramErr);
+
+	theStore->fRecords = NULL;
+	theStore->fNumRecords = 0L;
+	theStore->fRecordCapacity = 0L;
+	theStore->fNumSaved = 0L;
+	theStore->fNumCommitted = 0L;
+	theStore->fTable = NULL;
+	theStore->fTableSize = 0L;
+	theStore->fRewriteIndex = false;
+	theStore->fNumSamples = 0L;
+	theStore->fNumShared = 0L;
+	theStore->fBytesShared = 0.0;
+	theStore->fJob = theJob;
+#if TARGET_OS_WIN32
+	theStore->fLock = INVALID_HANDLE_VALUE;
+#elif TARGET_RT_MAC_MACHO
+	theStore->fLock = -1;
+#else
+	theStore->fLock = 0;
+#endif
+
+	if ((strlen(thePath) + strlen(kSampleStoreIndexSuffix) + strlen(kOutputCacheTempSuffix) >= kSampleStoreMaxPath) ||
+		(strlen(thePath) + strlen(kSampleStoreLockSuffix) >= kSampleStoreMaxPath))
+		return(bdNamErr);
+
+	strcpy(theStore->fPath, thePath);
+	sprintf(theStore->fIndexPath, "%s%s", thePath, kSampleStoreIndexSuffix);
+	sprintf(theStore->fLockPath, "%s%s", thePath, kSampleStoreLockSuffix);
+
+	// nothing in the store or its index is read or written without the lock
+	myErr = QTCmpr_LockSampleStore(theStore);
+	if (myErr != noErr)
+		return(myErr);
+
+	// the store must exist before we can make an alias to it
+	myFile = fopen(theStore->fPath, "ab");
+	if (myFile == NULL)
+		return(ioErr);
+	fclose(myFile);
+
+	myErr = QTCmpr_GetStoreFile(theStore->fPath, &theStore->fFile);
+	if (myErr != noErr)
+		return(myErr);
+
+	//////////
+	//
+	// read the index
+	//
+	//////////
+
+	myFile = fopen(theStore->fIndexPath, "rb");
+	if ((myFile != NULL) && (fseek(myFile, 0L, SEEK_END) == 0)) {
+		myFileSize = ftell(myFile);
+		fseek(myFile, 0L, SEEK_SET);
+	}
+
+	// an index that's missing or damaged is replaced by a new one; the samples it listed can't be shared
+	if ((myFile == NULL) || (fread(&myHeader, sizeof(myHeader), 1, myFile) != 1) ||
+		(myHeader.fSignature != kSampleStoreSignature) || (myHeader.fVersion != kSampleStoreVersion) || (myHeader.fNumRecords < 0L) ||
+		(myHeader.fNumRecords > (myFileSize - (long)sizeof(myHeader)) / (long)sizeof(SampleStoreRecord))) {
+		myHeader.fNumRecords = 0L;
+		theStore->fRewriteIndex = true;
+	}
+
+	myErr = QTCmpr_GrowSampleStore(theStore, myHeader.fNumRecords);
+	if (myErr != noErr)
+		goto bail;
+
+	if ((myFile != NULL) && (myHeader.fNumRecords > 0L))
+		if (fread(theStore->fRecords, sizeof(SampleStoreRecord), (size_t)myHeader.fNumRecords, myFile) != (size_t)myHeader.fNumRecords) {
+			myHeader.fNumRecords = 0L;
+			theStore->fRewriteIndex = true;
+		}
+
+	theStore->fNumRecords = myHeader.fNumRecords;
+	theStore->fNumSaved = myHeader.fNumRecords;
+	theStore->fNumCommitted = myHeader.fNumRecords;
+
+bail:
+	if (myFile != NULL)
+		fclose(myFile);
+
+	return(myErr);
+}
+
+
+//////////
+//
+// QTCmpr_CheckSampleStore
+// Make sure that every sample in the index is within the store, which is theFileSize bytes long, and get ready to
+// look them up.
+//
+// If any sample isn't, the store has been tampered with, and we don't trust any of the index.
+//
+//////////
+
+OSErr QTCmpr_CheckSampleStore (SampleStorePtr theStore, wide *theFileSize)
+{
+	SampleStoreRecordPtr		myRecord;
+	UInt32						myEndLow;
+	SInt32						myEndHigh;
+	long						myIndex;
+
+	if ((theStore == NULL) || (theFileSize == NULL))
+		return(paramErr);
+
+	for (myIndex = 0L; myIndex < theStore->fNumRecords; myIndex++) {
+		myRecord = &theStore->fRecords[myIndex];
+
+		myEndLow = myRecord->fOffset.lo + (UInt32)myRecord->fSize;
+		myEndHigh = myRecord->fOffset.hi + ((myEndLow < myRecord->fOffset.lo) ? 1 : 0);
+
+		if ((myRecord->fSize <= 0L) || (myEndHigh > theFileSize->hi) || ((myEndHigh == theFileSize->hi) && (myEndLow > theFileSize->lo))) {
+			QTCmpr_LogMessage("QTCmpr_CheckSampleStore: %s is shorter than its index says; starting a new index", theStore->fPath);
+
+			theStore->fNumRecords = 0L;
+			theStore->fNumSaved = 0L;
+			theStore->fNumCommitted = 0L;
+			theStore->fRewriteIndex = true;
+			break;
+		}
+	}
+
+	for (myIndex = 0L; myIndex < theStore->fTableSize; myIndex++)
+		theStore->fTable[myIndex] = -1L;
+
+	for (myIndex = 0L; myIndex < theStore->fNumRecords; myIndex++)
+		QTCmpr_AddToStoreTable(theStore, myIndex);
+
+	return(noErr);
+}
+
+
+//////////
+//
+// QTCmpr_FindStoredSample
+// Look for a sample of the specified size with the specified digest, and return its offset.
+//
+// If the sample is still in the writer's chunk (theIsPending), the offset is relative to the start of the chunk;
+// otherwise it's an offset in the store.
+//
+//////////
+
+Boolean QTCmpr_FindStoredSample (SampleStorePtr theStore, UInt8 *theDigest, long theSize, wide *theOffset, Boolean *theIsPending)
+{
+	SampleStoreRecordPtr		myRecord;
+	UInt32						mySlot;
+	long						myIndex;
+
+	mySlot = ((UInt32)theDigest[0] << 24) | ((UInt32)theDigest[1] << 16) | ((UInt32)theDigest[2] << 8) | (UInt32)theDigest[3];
+	mySlot &= (UInt32)(theStore->fTableSize - 1);
+
+	while ((myIndex = theStore->fTable[mySlot]) != -1L) {
+		myRecord = &theStore->fRecords[myIndex];
+
+		if ((myRecord->fSize == theSize) && (memcmp(myRecord->fDigest, theDigest, kHashDigestSize) == 0)) {
+			*theOffset = myRecord->fOffset;
+			*theIsPending = (myIndex >= theStore->fNumCommitted);
+			return(true);
+		}
+
+		mySlot = (mySlot + 1) & (UInt32)(theStore->fTableSize - 1);
+	}
+
+	return(false);
+}
+
+
+//////////
+//
+// QTCmpr_CountStoredSample
+// Count a sample written through the store, noting whether it was already there (theIsShared).
+//
+//////////
+
+void QTCmpr_CountStoredSample (SampleStorePtr theStore, long theSize, Boolean theIsShared)
+{
+	theStore->fNumSamples++;
+
+	if (theIsShared) {
+		theStore->fNumShared++;
+		theStore->fBytesShared += theSize;
+	}
+}
+
+
+//////////
+//
+// QTCmpr_AddStoredSample
+// Add a record of a new sample, which is at theOffset in the writer's chunk, to the store.
+//
+//////////
+
+OSErr QTCmpr_AddStoredSample (SampleStorePtr theStore, UInt8 *theDigest, long theOffset, long theSize)
+{
+	SampleStoreRecordPtr		myRecord;
+	OSErr						myErr = noErr;
+
+	myErr = QTCmpr_GrowSampleStore(theStore, theStore->fNumRecords + 1);
+	if (myErr != noErr)
+		return(myErr);
+
+	myRecord = &theStore->fRecords[theStore->fNumRecords];
+	BlockMoveData(theDigest, myRecord->fDigest, kHashDigestSize);
+	myRecord->fOffset.hi = 0;
+	myRecord->fOffset.lo = (UInt32)theOffset;
+	myRecord->fSize = theSize;
+
+	QTCmpr_AddToStoreTable(theStore, theStore->fNumRecords++);
+
+	return(noErr);
+}
+
+
+//////////
+//
+// QTCmpr_CommitStoredSamples
+// Note that the writer's chunk has been written to the store at theChunkOffset, so that the samples in it can
+// be found there.
+//
+//////////
+
+void QTCmpr_CommitStoredSamples (SampleStorePtr theStore, wide *theChunkOffset)
+{
+	SampleStoreRecordPtr		myRecord;
+	UInt32						myLow;
+	long						myIndex;
+
+	for (myIndex = theStore->fNumCommitted; myIndex < theStore->fNumRecords; myIndex++) {
+		myRecord = &theStore->fRecords[myIndex];
+
+		myLow = myRecord->fOffset.lo + theChunkOffset->lo;
+		myRecord->fOffset.hi = theChunkOffset->hi + ((myLow < theChunkOffset->lo) ? 1 : 0);
+		myRecord->fOffset.lo = myLow;
+	}
+
+	theStore->fNumCommitted = theStore->fNumRecords;
+}
+
+
+//////////
+//
+// QTCmpr_CloseSampleStore
+// Close the sample store; if theSave is true, first add the samples written to the store to its index. Then
+// release the lock on the store.
+//
+// Call this only after EndMediaEdits, when the Movie Toolbox has finished writing the samples.
+//
+//////////
+
+void QTCmpr_CloseSampleStore (SampleStorePtr theStore, Boolean theSave)
+{
+	if (theStore == NULL)
+		return;
+
+	if (theSave && (theStore->fNumSamples > 0L)) {
+		if ((theStore->fNumCommitted > theStore->fNumSaved) || theStore->fRewriteIndex)
+			if (QTCmpr_SaveStoreIndex(theStore) != noErr)
+				QTCmpr_LogMessage("QTCmpr_CloseSampleStore: can't update the index of %s", theStore->fPath);
+
+		QTCmpr_LogMessage("QTCmpr_CloseSampleStore: %ld of %ld samples (%.0f bytes) were already in %s; it now holds %ld samples",
+								theStore->fNumShared, theStore->fNumSamples, theStore->fBytesShared, theStore->fPath, theStore->fNumSaved);
+	}
+
+	if (theStore->fRecords != NULL) {
+		DisposePtr((Ptr)theStore->fRecords);
+		QTCmpr_ReleaseMemory(theStore->fJob, theStore->fRecordCapacity * sizeof(SampleStoreRecord));
+	}
+
+	if (theStore->fTable != NULL) {
+		DisposePtr((Ptr)theStore->fTable);
+		QTCmpr_ReleaseMemory(theStore->fJob, theStore->fTableSize * sizeof(long));
+	}
+
+	theStore->fRecords = NULL;
+	theStore->fNumRecords = 0L;
+	theStore->fRecordCapacity = 0L;
+	theStore->fTable = NULL;
+	theStore->fTableSize = 0L;
+
+	QTCmpr_UnlockSampleStore(theStore);
+}
+
+
+//////////
+//
+// QTCmpr_GrowSampleStore
+// Make sure there's room for at least theNumRecords records; whenever the records are moved, the hash table is
+// made over, at least twice as big as the number of records it can hold.
+//
+//////////
+
+static OSErr QTCmpr_GrowSampleStore (SampleStorePtr theStore, long theNumRecords)
+{
+	SampleStoreRecordPtr		myRecords = NULL;
+	long						*myTable = NULL;
+	long						myCapacity;
+	long						myTableSize;
+	long						myIndex;
+
+	if ((theNumRecords <= theStore->fRecordCapacity) && (theStore->fTable != NULL))
+		return(noErr);
+
+	myCapacity = 2 * theStore->fRecordCapacity;
+	if (myCapacity < kSampleStoreMinRecords)
+		myCapacity = kSampleStoreMinRecords;
+	if (myCapacity < theNumRecords)
+		myCapacity = theNumRecords;
+
+	for (myTableSize = 1L; myTableSize < 2 * myCapacity; myTableSize <<= 1)
+		;
+
+	QTCmpr_ReserveMemory(theStore->fJob, (myCapacity * sizeof(SampleStoreRecord)) + (myTableSize * sizeof(long)));
+
+	myRecords = (SampleStoreRecordPtr)NewPtr(myCapacity * sizeof(SampleStoreRecord));
+	myTable = (long *)NewPtr(myTableSize * sizeof(long));
+	if ((myRecords == NULL) || (myTable == NULL)) {
+		if (myRecords != NULL)
+			DisposePtr((Ptr)myRecords);
+		if (myTable != NULL)
+			DisposePtr((Ptr)myTable);
+		QTCmpr_ReleaseMemory(theStore->fJob, (myCapacity * sizeof(SampleStoreRecord)) + (myTableSize * sizeof(long)));
+		return(memFullErr);
+	}
+
+	if (theStore->fRecords != NULL) {
+		BlockMoveData(theStore->fRecords, myRecords, theStore->fNumRecords * sizeof(SampleStoreRecord));
+		DisposePtr((Ptr)theStore->fRecords);
+		QTCmpr_ReleaseMemory(theStore->fJob, theStore->fRecordCapacity * sizeof(SampleStoreRecord));
+	}
+
+	if (theStore->fTable != NULL) {
+		DisposePtr((Ptr)theStore->fTable);
+		QTCmpr_ReleaseMemory(theStore->fJob, theStore->fTableSize * sizeof(long));
+	}
+
+	theStore->fRecords = myRecords;
+	theStore->fRecordCapacity = myCapacity;
+	theStore->fTable = myTable;
+	theStore->fTableSize = myTableSize;
+
+	for (myIndex = 0L; myIndex < theStore->fTableSize; myIndex++)
+		theStore->fTable[myIndex] = -1L;
+
+	for (myIndex = 0L; myIndex < theStore->fNumRecords; myIndex++)
+		QTCmpr_AddToStoreTable(theStore, myIndex);
+
+	return(noErr);
+}
+
+
+//////////
+//
+// QTCmpr_AddToStoreTable
+// Add the specified record to the hash table.
+//
+//////////
+
+static void QTCmpr_AddToStoreTable (SampleStorePtr theStore, long theRecord)
+{
+	UInt8						*myDigest = theStore->fRecords[theRecord].fDigest;
+	UInt32						mySlot;
+
+	mySlot = ((UInt32)myDigest[0] << 24) | ((UInt32)myDigest[1] << 16) | ((UInt32)myDigest[2] << 8) | (UInt32)myDigest[3];
+	mySlot &= (UInt32)(theStore->fTableSize - 1);
+
+	while (theStore->fTable[mySlot] != -1L)
+		mySlot = (mySlot + 1) & (UInt32)(theStore->fTableSize - 1);
+
+	theStore->fTable[mySlot] = theRecord;
+}
+
+
+//////////
+//
+// QTCmpr_SaveStoreIndex
+// Add the records of the samples written to the store to the end of its index, and then update the count in the
+// index's header; or, if the index must be started over, write a new one under a temporary name and rename it.
+//
+//////////
+
+static OSErr QTCmpr_SaveStoreIndex (SampleStorePtr theStore)
+{
+	SampleStoreHeader			myHeader;
+	char						myTempPath[kSampleStoreMaxPath];
+	FILE						*myFile = NULL;
+	long						myFirst;
+	long						myCount;
+	OSErr						myErr = noErr;
+
+	myHeader.fSignature = kSampleStoreSignature;
+	myHeader.fVersion = kSampleStoreVersion;
+	myHeader.fNumRecords = theStore->fNumCommitted;
+
+	if (theStore->fRewriteIndex) {
+		sprintf(myTempPath, "%s%s", theStore->fIndexPath, kOutputCacheTempSuffix);
+		myFirst = 0L;
+
+		myFile = fopen(myTempPath, "wb");
+	} else {
+		myFirst = theStore->fNumSaved;
+
+		myFile = fopen(theStore->fIndexPath, "r+b");
+		if ((myFile != NULL) && (fseek(myFile, sizeof(myHeader) + (myFirst * sizeof(SampleStoreRecord)), SEEK_SET) != 0)) {
+			fclose(myFile);
+			myFile = NULL;
+		}
+	}
+
+	if (myFile == NULL)
+		return(ioErr);
+
+	myCount = theStore->fNumCommitted - myFirst;
+
+	// in an existing index, the new count goes in only once the records it covers are there
+	if (theStore->fRewriteIndex) {
+		if (fwrite(&myHeader, sizeof(myHeader), 1, myFile) != 1)
+			myErr = ioErr;
+	}
+
+	if ((myErr == noErr) && (myCount > 0L))
+		if (fwrite(&theStore->fRecords[myFirst], sizeof(SampleStoreRecord), (size_t)myCount, myFile) != (size_t)myCount)
+			myErr = ioErr;
+
+	if ((myErr == noErr) && !theStore->fRewriteIndex)
+		if ((fflush(myFile) != 0) || (fseek(myFile, 0L, SEEK_SET) != 0) || (fwrite(&myHeader, sizeof(myHeader), 1, myFile) != 1))
+			myErr = ioErr;
+
+	if (fclose(myFile) != 0)
+		myErr = ioErr;
+
+	if (theStore->fRewriteIndex) {
+		if (myErr == noErr) {
+			// rename won't replace an existing file everywhere
+			remove(theStore->fIndexPath);
+			if (rename(myTempPath, theStore->fIndexPath) != 0)
+				myErr = ioErr;
+		}
+
+		if (myErr != noErr)
+			remove(myTempPath);
+	}
+
+	if (myErr == noErr) {
+		theStore->fNumSaved = theStore->fNumCommitted;
+		theStore->fRewriteIndex = false;
+	}
+
+	return(myErr);
+}
+
+
+//////////
+//
+// QTCmpr_GetStoreFile
+// Return a file system specification for the file with the specified path.
+//
+//////////
+
+static OSErr QTCmpr_GetStoreFile (char *thePath, FSSpec *theFile)
+{
+#if TARGET_OS_WIN32
+	return(NativePathNameToFSSpec(thePath, theFile, 0L));
+#else
+	StringPtr					myName = QTUtils_ConvertCToPascalString(thePath);
+	OSErr						myErr = noErr;
+
+	myErr = FSMakeFSSpec(0, 0L, myName, theFile);
+	free(myName);
+
+	return(myErr);
+#endif
+}
+
+
+//////////
+//
+// QTCmpr_LockSampleStore
+// Take the lock on the sample store: open its lock file, creating it if need be, so that no other process can
+// open it the same way until we close it. Return fBsyErr if we can't.
+//
+//////////
+
+static OSErr QTCmpr_LockSampleStore (SampleStorePtr theStore)
+{
+#if TARGET_OS_WIN32
+	// a file opened without sharing can't be opened again until it's closed
+	theStore->fLock = CreateFile(theStore->fLockPath, GENERIC_READ | GENERIC_WRITE, 0, NULL, OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+	if (theStore->fLock == INVALID_HANDLE_VALUE) {
+		QTCmpr_LogMessage("QTCmpr_LockSampleStore: can't lock %s (error %lu)", theStore->fPath, (unsigned long)GetLastError());
+		return(fBsyErr);
+	}
+#elif TARGET_RT_MAC_MACHO
+	theStore->fLock = open(theStore->fLockPath, O_RDWR | O_CREAT, 0666);
+	if ((theStore->fLock != -1) && (flock(theStore->fLock, LOCK_EX | LOCK_NB) != 0)) {
+		close(theStore->fLock);
+		theStore->fLock = -1;
+	}
+
+	if (theStore->fLock == -1) {
+		QTCmpr_LogMessage("QTCmpr_LockSampleStore: can't lock %s", theStore->fPath);
+		return(fBsyErr);
+	}
+#else
+	// only one path to a file can have write permission at a time
+	FSSpec						myFile;
+	FILE						*myStream = NULL;
+
+	myStream = fopen(theStore->fLockPath, "ab");
+	if (myStream != NULL)
+		fclose(myStream);
+
+	if ((myStream == NULL) || (QTCmpr_GetStoreFile(theStore->fLockPath, &myFile) != noErr) ||
+		(FSpOpenDF(&myFile, fsRdWrPerm, &theStore->fLock) != noErr)) {
+		theStore->fLock = 0;
+		QTCmpr_LogMessage("QTCmpr_LockSampleStore: can't lock %s", theStore->fPath);
+		return(fBsyErr);
+	}
+#endif
+
+	return(noErr);
+}
+
+
+//////////
+//
+// QTCmpr_UnlockSampleStore
+// Release the lock on the sample store, if we have it. The lock file stays, for the next copy of QTCompress.
+//
+//////////
+
+static void QTCmpr_UnlockSampleStore (SampleStorePtr theStore)
+{
+#if TARGET_OS_WIN32
+	if (theStore->fLock != INVALID_HANDLE_VALUE)
+		CloseHandle(theStore->fLock);
+	theStore->fLock = INVALID_HANDLE_VALUE;
+#elif TARGET_RT_MAC_MACHO
+	if (theStore->fLock != -1)
+		close(theStore->fLock);
+	theStore->fLock = -1;
+#else
+	if (theStore->fLock != 0)
+		FSClose(theStore->fLock);
+	theStore->fLock = 0;
+#endif
+}
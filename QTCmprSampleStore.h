@@ -0,0 +1,129 @@
+//////////
+//
+//	File:		QTCmprSampleStore.h
+//
+//	Contains:	A store of compressed samples shared by many movie files, each distinct sample kept once, for use by
+//				QTCompress.
+//
+//	Written by:	Tim Monroe
+//
+//	Copyright:	 2000 by Apple Computer, Inc., all rights reserved.
+//
+//	Change History (most recent first):
+//
+//	   <3>	 	11/13/26	rtm		added the lock file
+//	   <2>	 	11/13/26	rtm		the SHA-256 routines are now in QTCmprHash.c
+//	   <1>	 	11/10/26	rtm		first file
+//
+//////////
+
+#pragma once
+
+
+//////////
+//
+// header files
+//
+//////////
+
+#ifndef __QTCmprSampleStore__
+#define __QTCmprSampleStore__
+
+#ifndef __MOVIES__
+#include <Movies.h>
+#endif
+
+#include <stdio.h>
+
+#if TARGET_OS_WIN32
+#include <windows.h>
+#endif
+
+#include "QTCmprBudget.h"
+#include "QTCmprHash.h"											// for the SHA-256 digest
+
+
+//////////
+//
+// constants
+//
+//////////
+
+#define kSampleStoreSignature			FOUR_CHAR_CODE('QTSs')	// the start of the index file
+#define kSampleStoreVersion				1L
+#define kSampleStoreIndexSuffix			".index"				// appended to the store's name to get the index file's name
+#define kSampleStoreLockSuffix			".lock"					// appended to the store's name to get the lock file's name
+#define kSampleStoreMaxPath				1024
+#define kSampleStoreMinRecords			1024					// the fewest records we make room for
+
+
+//////////
+//
+// data types
+//
+//////////
+
+// a sample in the store, as recorded in the index file
+typedef struct SampleStoreRecord {
+	UInt8						fDigest[kHashDigestSize];		// the SHA-256 digest of the sample data
+	wide						fOffset;							// where the sample is in the store
+	long						fSize;
+} SampleStoreRecord, *SampleStoreRecordPtr;
+
+// the header of the index file; it's followed by fNumRecords records
+typedef struct SampleStoreHeader {
+	OSType						fSignature;							// kSampleStoreSignature
+	long						fVersion;							// kSampleStoreVersion
+	long						fNumRecords;
+} SampleStoreHeader, *SampleStoreHeaderPtr;
+
+// a sample store; the samples are in one file (which the media of each movie refers to) and the index of them in
+// another, and while the store is open a hash table finds a sample by its digest
+typedef struct SampleStore {
+	char						fPath[kSampleStoreMaxPath];			// the file holding the samples
+	char						fIndexPath[kSampleStoreMaxPath];
+	char						fLockPath[kSampleStoreMaxPath];
+	FSSpec						fFile;								// the same file, for the media's data reference
+#if TARGET_OS_WIN32
+	HANDLE						fLock;								// the lock file, opened for our use alone, or INVALID_HANDLE_VALUE
+#elif TARGET_RT_MAC_MACHO
+	int							fLock;								// the lock file, with an exclusive flock on it, or -1
+#else
+	short						fLock;								// the lock file, open with write permission, or 0
+#endif
+	SampleStoreRecordPtr		fRecords;
+	long						fNumRecords;
+	long						fRecordCapacity;
+	long						fNumSaved;							// the number of records in the index file
+	long						fNumCommitted;						// the records after these are still in the writer's chunk
+	long						*fTable;							// the indexes of the records, by digest, or -1
+	long						fTableSize;							// always a power of 2
+	Boolean						fRewriteIndex;						// must the index file be written from scratch?
+	long						fNumSamples;						// the samples written, and the ones already in the store
+	long						fNumShared;
+	double						fBytesShared;
+	MemoryJobPtr				fJob;
+} SampleStore, *SampleStorePtr;
+
+
+//////////
+//
+// function prototypes
+//
+//////////
+
+OSErr							QTCmpr_OpenSampleStore (SampleStorePtr theStore, char *thePath, MemoryJobPtr theJob);
+OSErr							QTCmpr_CheckSampleStore (SampleStorePtr theStore, wide *theFileSize);
+Boolean							QTCmpr_FindStoredSample (SampleStorePtr theStore, UInt8 *theDigest, long theSize, wide *theOffset, Boolean *theIsPending);
+void							QTCmpr_CountStoredSample (SampleStorePtr theStore, long theSize, Boolean theIsShared);
+OSErr							QTCmpr_AddStoredSample (SampleStorePtr theStore, UInt8 *theDigest, long theOffset, long theSize);
+void							QTCmpr_CommitStoredSamples (SampleStorePtr theStore, wide *theChunkOffset);
+void							QTCmpr_CloseSampleStore (SampleStorePtr theStore, Boolean theSave);
+static OSErr					QTCmpr_GrowSampleStore (SampleStorePtr theStore, long theNumRecords);
+static void						QTCmpr_AddToStoreTable (SampleStorePtr theStore, long theRecord);
+static OSErr					QTCmpr_SaveStoreIndex (SampleStorePtr theStore);
+static OSErr					QTCmpr_GetStoreFile (char *thePath, FSSpec *theFile);
+static OSErr					QTCmpr_LockSampleStore (SampleStorePtr theStore);
+static void						QTCmpr_UnlockSampleStore (SampleStorePtr theStore);
+
+#endif	// __QTCmprSampleStore__
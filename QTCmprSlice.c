@@ -0,0 +1,399 @@
+//////////
+//
+//	File:		QTCmprSlice.c
+//
+//	Contains:	A pool of threads that work on horizontal slices of a frame at the same time, for use by QTCompress.
+//
+//	Written by:	Tim Monroe
+//
+//	Copyright:	 2000 by Apple Computer, Inc., all rights reserved.
+//
+//	Change History (most recent first):
+//
+//	   <2>	 	11/11/26	rtm		added deterministic mode; frames are then always cut into the same slices
+//	   <1>	 	11/07/26	rtm		first file
+//
+//	The compressors we drive through the standard compression component compress each frame on a single thread,
+//	and the sample a compressor produces is in its own format; we can't cut a frame into pieces, hand each piece
+//	to a different compressor, and glue the results together into one sample. What we can do is spread out the
+//	work we do on each frame before the compressor sees it: converting it to Y'CbCr, resizing it, and taking the
+//	luma plane that motion estimation works on. For a large frame, that work takes as long as many compressors
+//	do, and each row of it is independent of the others.
+//
+//	So we keep a pool of threads, one for each processor, shared by everything in QTCompress that works on whole
+//	frames. QTCmpr_RunSlices cuts the rows of a frame into as many slices as there are threads (but no slice
+//	shorter than kSliceMinRows rows), runs the first slice on the calling thread and the others on the pool, and
+//	returns once they are all done. The threads are started the first time they're needed, and they sleep
+//	between frames.
+//
+//	In deterministic mode (see QTCmpr_GetDeterministicMode), how a frame is cut doesn't depend on the number of
+//	processors: a frame always gets kSliceMaxThreads slices (again, none shorter than kSliceMinRows rows), and
+//	thread i works on slices i, i + n, i + 2n, and so on, one after another, where n is the number of threads with
+//	slices. The slice routines we have don't care where a frame is cut, but a routine that does (one that adds up
+//	something across each slice, say) then gets the same results on every machine.
+//
+//	A slice routine must not call the C library (which, as we link with it, isn't thread-safe) or the Toolbox,
+//	and two slices must never write the same memory; each slice routine gets the index of the thread it runs on,
+//	so that it can use scratch memory of its own. Only one thread (the main one) may call QTCmpr_RunSlices.
+//
+//////////
+
+//////////
+//
+// header files
+//
+//////////
+
+#include "QTCompress.h"
+
+#if TARGET_RT_MAC_MACHO
+#include <unistd.h>
+#endif
+
+
+//////////
+//
+// global variables
+//
+//////////
+
+static SlicePool					gSlicePool;
+static Boolean						gSlicePoolStarted = false;
+
+
+//////////
+//
+// QTCmpr_GetMaxSlices
+// Return the most threads that ever work on a frame at once; this is the number of threads in the pool.
+//
+//////////
+
+long QTCmpr_GetMaxSlices (void)
+{
+	if (!gSlicePoolStarted)
+		QTCmpr_StartSlicePool();
+
+	return(gSlicePool.fNumThreads);
+}
+
+
+//////////
+//
+// QTCmpr_RunSlices
+// Call theProc on rows theTop through theBottom - 1 of a frame, cut into slices that are worked on at the same time;
+// return once all the slices are done.
+//
+// Every slice but the last starts on a multiple of theRowAlign rows from theTop.
+//
+//////////
+
+void QTCmpr_RunSlices (SliceProcPtr theProc, void *theRefCon, long theTop, long theBottom, long theRowAlign)
+{
+	long						myNumRows = theBottom - theTop;
+	long						myNumSlices;
+	long						myNumWorkers;
+	long						mySlice;
+#if USE_SLICE_THREADS && TARGET_OS_WIN32
+	HANDLE						myEvents[kSliceMaxThreads];
+#endif
+
+	if ((theProc == NULL) || (myNumRows <= 0L))
+		return;
+
+	if (!gSlicePoolStarted)
+		QTCmpr_StartSlicePool();
+
+	if (theRowAlign < 1L)
+		theRowAlign = 1L;
+
+	// in deterministic mode, the slices don't depend on how many threads there are to work on them
+	myNumSlices = myNumRows / kSliceMinRows;
+	if (myNumSlices > kSliceMaxThreads)
+		myNumSlices = kSliceMaxThreads;
+	if (!gSlicePool.fIsDeterministic && (myNumSlices > gSlicePool.fNumThreads))
+		myNumSlices = gSlicePool.fNumThreads;
+
+	myNumWorkers = myNumSlices;
+	if (myNumWorkers > gSlicePool.fNumThreads)
+		myNumWorkers = gSlicePool.fNumThreads;
+
+	gSlicePool.fNumRuns++;
+
+	// a small frame isn't worth cutting up
+	if (myNumSlices <= 1L) {
+		(*theProc)(theRefCon, 0L, theTop, theBottom);
+		return;
+	}
+
+	if (myNumWorkers > 1L)
+		gSlicePool.fNumSplitRuns++;
+
+#if USE_SLICE_THREADS && !TARGET_OS_WIN32
+	pthread_mutex_lock(&gSlicePool.fLock);
+#endif
+	gSlicePool.fProc = theProc;
+	gSlicePool.fRefCon = theRefCon;
+	gSlicePool.fNumSlices = myNumSlices;
+	gSlicePool.fNumWorkers = myNumWorkers;
+	for (mySlice = 0; mySlice < myNumSlices; mySlice++)
+		gSlicePool.fTops[mySlice] = theTop + ((((myNumRows * mySlice) / myNumSlices) / theRowAlign) * theRowAlign);
+	gSlicePool.fTops[myNumSlices] = theBottom;
+
+	// with just the one thread, there's nothing to wake
+	if (myNumWorkers <= 1L) {
+#if USE_SLICE_THREADS && !TARGET_OS_WIN32
+		pthread_mutex_unlock(&gSlicePool.fLock);
+#endif
+		QTCmpr_WorkOnSlices(&gSlicePool, 0L);
+		return;
+	}
+
+#if USE_SLICE_THREADS
+#if TARGET_OS_WIN32
+	for (mySlice = 1; mySlice < myNumWorkers; mySlice++) {
+		myEvents[mySlice - 1] = gSlicePool.fThreads[mySlice].fDoneEvent;
+		SetEvent(gSlicePool.fThreads[mySlice].fStartEvent);
+	}
+
+	QTCmpr_WorkOnSlices(&gSlicePool, 0L);
+
+	WaitForMultipleObjects(myNumWorkers - 1, myEvents, TRUE, INFINITE);
+#else
+	// every thread wakes up, even those without a slice, so that each one sees every generation
+	gSlicePool.fNumBusy = gSlicePool.fNumThreads - 1;
+	gSlicePool.fGeneration++;
+	pthread_cond_broadcast(&gSlicePool.fStart);
+	pthread_mutex_unlock(&gSlicePool.fLock);
+
+	QTCmpr_WorkOnSlices(&gSlicePool, 0L);
+
+	pthread_mutex_lock(&gSlicePool.fLock);
+	while (gSlicePool.fNumBusy > 0L)
+		pthread_cond_wait(&gSlicePool.fDone, &gSlicePool.fLock);
+	pthread_mutex_unlock(&gSlicePool.fLock);
+#endif
+#else
+	// without threads, the pool has one thread, so we never get here
+	QTCmpr_WorkOnSlices(&gSlicePool, 0L);
+#endif
+}
+
+
+//////////
+//
+// QTCmpr_StopSlicePool
+// Stop the threads in the pool, and wait for them to quit.
+//
+//////////
+
+void QTCmpr_StopSlicePool (void)
+{
+	long						myIndex;
+
+	if (!gSlicePoolStarted)
+		return;
+
+	if (gSlicePool.fNumRuns > 0L)
+		QTCmpr_LogMessage("QTCmpr_StopSlicePool: %ld threads; %ld of %ld frame passes were cut into slices",
+							gSlicePool.fNumThreads, gSlicePool.fNumSplitRuns, gSlicePool.fNumRuns);
+
+#if USE_SLICE_THREADS
+#if TARGET_OS_WIN32
+	gSlicePool.fQuit = true;
+
+	for (myIndex = 1; myIndex < gSlicePool.fNumThreads; myIndex++) {
+		SetEvent(gSlicePool.fThreads[myIndex].fStartEvent);
+		WaitForSingleObject(gSlicePool.fThreads[myIndex].fThread, INFINITE);
+
+		CloseHandle(gSlicePool.fThreads[myIndex].fThread);
+		CloseHandle(gSlicePool.fThreads[myIndex].fStartEvent);
+		CloseHandle(gSlicePool.fThreads[myIndex].fDoneEvent);
+	}
+#else
+	pthread_mutex_lock(&gSlicePool.fLock);
+	gSlicePool.fQuit = true;
+	pthread_cond_broadcast(&gSlicePool.fStart);
+	pthread_mutex_unlock(&gSlicePool.fLock);
+
+	for (myIndex = 1; myIndex < gSlicePool.fNumThreads; myIndex++)
+		pthread_join(gSlicePool.fThreads[myIndex].fThread, NULL);
+
+	pthread_cond_destroy(&gSlicePool.fDone);
+	pthread_cond_destroy(&gSlicePool.fStart);
+	pthread_mutex_destroy(&gSlicePool.fLock);
+#endif
+#else
+#pragma unused(myIndex)
+#endif
+
+	gSlicePool.fNumThreads = 1L;
+	gSlicePoolStarted = false;
+}
+
+
+//////////
+//
+// QTCmpr_StartSlicePool
+// Start a thread for each processor but the first; if we can't start them all, we make do with the ones we could.
+//
+//////////
+
+static void QTCmpr_StartSlicePool (void)
+{
+	long						myNumThreads = QTCmpr_GetProcessorCount();
+	long						myIndex;
+#if USE_SLICE_THREADS && TARGET_OS_WIN32
+	DWORD						myThreadID;
+#endif
+
+	if (myNumThreads > kSliceMaxThreads)
+		myNumThreads = kSliceMaxThreads;
+
+	gSlicePool.fNumThreads = 1L;
+	gSlicePool.fIsDeterministic = QTCmpr_GetDeterministicMode();
+	gSlicePool.fQuit = false;
+	gSlicePool.fNumRuns = 0L;
+	gSlicePool.fNumSplitRuns = 0L;
+	gSlicePoolStarted = true;
+
+#if USE_SLICE_THREADS
+#if !TARGET_OS_WIN32
+	pthread_mutex_init(&gSlicePool.fLock, NULL);
+	pthread_cond_init(&gSlicePool.fStart, NULL);
+	pthread_cond_init(&gSlicePool.fDone, NULL);
+	gSlicePool.fGeneration = 0L;
+	gSlicePool.fNumBusy = 0L;
+#endif
+
+	for (myIndex = 1; myIndex < myNumThreads; myIndex++) {
+		SliceThreadPtr			myThread = &gSlicePool.fThreads[myIndex];
+
+		myThread->fPool = &gSlicePool;
+		myThread->fSlice = myIndex;
+
+#if TARGET_OS_WIN32
+		myThread->fStartEvent = CreateEvent(NULL, FALSE, FALSE, NULL);
+		myThread->fDoneEvent = CreateEvent(NULL, FALSE, FALSE, NULL);
+		myThread->fThread = NULL;
+		if ((myThread->fStartEvent != NULL) && (myThread->fDoneEvent != NULL))
+			myThread->fThread = CreateThread(NULL, 0, QTCmpr_SliceThreadProc, myThread, 0, &myThreadID);
+
+		if (myThread->fThread == NULL) {
+			if (myThread->fStartEvent != NULL)
+				CloseHandle(myThread->fStartEvent);
+			if (myThread->fDoneEvent != NULL)
+				CloseHandle(myThread->fDoneEvent);
+			break;
+		}
+#else
+		if (pthread_create(&myThread->fThread, NULL, QTCmpr_SliceThreadProc, myThread) != 0)
+			break;
+#endif
+
+		gSlicePool.fNumThreads++;
+	}
+#else
+#pragma unused(myIndex)
+#endif
+}
+
+
+//////////
+//
+// QTCmpr_GetProcessorCount
+// Return the number of processors.
+//
+//////////
+
+static long QTCmpr_GetProcessorCount (void)
+{
+	long						myCount = 1L;
+
+#if TARGET_OS_WIN32
+	SYSTEM_INFO					myInfo;
+
+	GetSystemInfo(&myInfo);
+	myCount = (long)myInfo.dwNumberOfProcessors;
+#elif TARGET_RT_MAC_MACHO
+	myCount = (long)sysconf(_SC_NPROCESSORS_ONLN);
+#endif
+
+	return((myCount < 1L) ? 1L : myCount);
+}
+
+
+//////////
+//
+// QTCmpr_WorkOnSlices
+// Work, one after another, on the slices of the current frame that belong to the specified thread.
+//
+//////////
+
+static void QTCmpr_WorkOnSlices (SlicePoolPtr thePool, long theThread)
+{
+	long						mySlice;
+
+	for (mySlice = theThread; mySlice < thePool->fNumSlices; mySlice += thePool->fNumWorkers)
+		(*thePool->fProc)(thePool->fRefCon, theThread, thePool->fTops[mySlice], thePool->fTops[mySlice + 1]);
+}
+
+
+//////////
+//
+// QTCmpr_SliceThreadProc
+// Work on this thread's slice of each frame, until we are told to quit.
+//
+//////////
+
+#if USE_SLICE_THREADS
+#if TARGET_OS_WIN32
+static DWORD WINAPI QTCmpr_SliceThreadProc (LPVOID theParam)
+#else
+static void * QTCmpr_SliceThreadProc (void *theParam)
+#endif
+{
+	SliceThreadPtr				myThread = (SliceThreadPtr)theParam;
+	SlicePoolPtr				myPool = myThread->fPool;
+	long						mySlice = myThread->fSlice;
+#if !TARGET_OS_WIN32
+	long						myGeneration = 0L;
+#endif
+
+#if TARGET_OS_WIN32
+	while (true) {
+		WaitForSingleObject(myThread->fStartEvent, INFINITE);
+		if (myPool->fQuit)
+			break;
+
+		QTCmpr_WorkOnSlices(myPool, mySlice);
+
+		SetEvent(myThread->fDoneEvent);
+	}
+
+	return(0);
+#else
+	pthread_mutex_lock(&myPool->fLock);
+
+	while (true) {
+		while ((myPool->fGeneration == myGeneration) && !myPool->fQuit)
+			pthread_cond_wait(&myPool->fStart, &myPool->fLock);
+		if (myPool->fQuit)
+			break;
+
+		myGeneration = myPool->fGeneration;
+		pthread_mutex_unlock(&myPool->fLock);
+
+		if (mySlice < myPool->fNumWorkers)
+			QTCmpr_WorkOnSlices(myPool, mySlice);
+
+		pthread_mutex_lock(&myPool->fLock);
+		if (--myPool->fNumBusy == 0L)
+			pthread_cond_signal(&myPool->fDone);
+	}
+
+	pthread_mutex_unlock(&myPool->fLock);
+
+	return(NULL);
+#endif
+}
+#endif
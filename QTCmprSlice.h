@@ -0,0 +1,136 @@
+//////////
+//
+//	File:		QTCmprSlice.h
+//
+//	Contains:	A pool of threads that work on horizontal slices of a frame at the same time, for use by QTCompress.
+//
+//	Written by:	Tim Monroe
+//
+//	Copyright:	 2000 by Apple Computer, Inc., all rights reserved.
+//
+//	Change History (most recent first):
+//
+//	   <2>	 	11/11/26	rtm		added deterministic mode
+//	   <1>	 	11/07/26	rtm		first file
+//
+//////////
+
+#pragma once
+
+
+//////////
+//
+// header files
+//
+//////////
+
+#ifndef __QTCmprSlice__
+#define __QTCmprSlice__
+
+#ifndef __MOVIES__
+#include <Movies.h>
+#endif
+
+#if TARGET_OS_WIN32
+#include <windows.h>
+#endif
+
+#if TARGET_RT_MAC_MACHO
+#include <pthread.h>
+#endif
+
+
+//////////
+//
+// compiler flags
+//
+//////////
+
+// do we work on the slices of a frame on several threads?
+#if TARGET_OS_WIN32 || TARGET_RT_MAC_MACHO
+#define USE_SLICE_THREADS				1
+#else
+#define USE_SLICE_THREADS				0
+#endif
+
+
+//////////
+//
+// constants
+//
+//////////
+
+#define kSliceMaxThreads				16						// the most threads (including the calling thread) that work on a frame
+#define kSliceMinRows					32						// the fewest rows we give a thread
+
+
+//////////
+//
+// data types
+//
+//////////
+
+// a routine that works on rows theTop through theBottom - 1 of a frame; theSlice is the index of the thread doing the
+// work, from 0 up to (but not including) the number of threads in the pool, so it can be used to pick per-slice scratch
+// memory (a thread works on its slices one at a time)
+typedef void (*SliceProcPtr) (void *theRefCon, long theSlice, long theTop, long theBottom);
+
+// a thread in the pool
+typedef struct SliceThread {
+	struct SlicePool			*fPool;
+	long						fSlice;								// the first slice this thread works on
+#if USE_SLICE_THREADS
+#if TARGET_OS_WIN32
+	HANDLE						fThread;
+	HANDLE						fStartEvent;						// set when there's a slice to work on
+	HANDLE						fDoneEvent;							// set when the slice is done
+#else
+	pthread_t					fThread;
+#endif
+#endif
+} SliceThread, *SliceThreadPtr;
+
+// the pool; slice 0 is always done by the calling thread, and slice i by fThreads[i % fNumWorkers]
+typedef struct SlicePool {
+	long						fNumThreads;						// the number of threads, including the calling thread
+	SliceThread					fThreads[kSliceMaxThreads];
+	SliceProcPtr				fProc;								// the work that's being done
+	void						*fRefCon;
+	long						fNumSlices;
+	long						fNumWorkers;						// the number of threads that have slices to work on
+	long						fTops[kSliceMaxThreads + 1];		// slice i is rows fTops[i] through fTops[i + 1] - 1
+	Boolean						fIsDeterministic;					// do we cut frames the same way, however many threads there are?
+	Boolean						fQuit;								// should the threads quit?
+#if USE_SLICE_THREADS && !TARGET_OS_WIN32
+	pthread_mutex_t				fLock;
+	pthread_cond_t				fStart;								// signalled when fGeneration changes
+	pthread_cond_t				fDone;								// signalled when fNumBusy drops to 0
+	long						fGeneration;						// incremented each time there are slices to work on
+	long						fNumBusy;							// the number of threads still working on their slices
+#endif
+	long						fNumRuns;
+	long						fNumSplitRuns;						// the number of runs that used more than one thread
+} SlicePool, *SlicePoolPtr;
+
+
+//////////
+//
+// function prototypes
+//
+//////////
+
+long							QTCmpr_GetMaxSlices (void);
+void							QTCmpr_RunSlices (SliceProcPtr theProc, void *theRefCon, long theTop, long theBottom, long theRowAlign);
+void							QTCmpr_StopSlicePool (void);
+static void						QTCmpr_StartSlicePool (void);
+static long						QTCmpr_GetProcessorCount (void);
+static void						QTCmpr_WorkOnSlices (SlicePoolPtr thePool, long theThread);
+#if USE_SLICE_THREADS
+#if TARGET_OS_WIN32
+static DWORD WINAPI				QTCmpr_SliceThreadProc (LPVOID theParam);
+#else
+static void *					QTCmpr_SliceThreadProc (void *theParam);
+#endif
+#endif
+
+#endif	// __QTCmprSlice__
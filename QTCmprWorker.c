@@ -0,0 +1,694 @@
+//////////
+//
+//	File:		QTCmprWorker.c
+//
+//	Contains:	Codec worker processes, which run compression sequences outside the application so that a
+//				misbehaving codec can't take the application down with it, for use by QTCompress.
+//
+//	Written by:	Tim Monroe
+//
+//	Copyright:	 2000 by Apple Computer, Inc., all rights reserved.
+//
+//	Change History (most recent first):
+//
+//	   <3>	 	11/13/26	rtm		QTCmpr_CompressWorkerFrame checks the size and sync flag of each compressed frame, and
+//									treats a worker that returns nonsense like one that died
+//	   <2>	 	10/30/26	rtm		the frame can be in any of the pixel formats QTCmpr_CompressSequence renders in
+//	   <1>	 	10/29/26	rtm		first file
+//
+//	A compressor component runs in our address space, so a compressor that crashes while compressing a frame
+//	takes the whole application down with it, along with every open window. When worker mode is on, we instead
+//	run the compression sequence in a worker process: a second copy of this application, started with an
+//	environment variable (kWorkerVariable) that tells it to compress frames for us instead of opening a frame
+//	window (see QTApp_Init).
+//
+//	The frames and compressed data never go through a pipe. The application renders each frame into a graphics
+//	world whose pixels are in shared memory, and the worker wraps a graphics world of its own around the same
+//	memory; the worker puts each compressed frame into a second block of shared memory, which also holds the
+//	compression settings, the image description, and the per-frame parameters and results. The pipes (the
+//	worker's standard input and output) carry only one-byte messages: "compress the frame" in one direction,
+//	"the compressed frame is ready" in the other.
+//
+//	If the worker dies, its end of the pipe closes and our read fails. We then start a new worker and give it the
+//	same frame, which is still in shared memory. The frames already returned are complete, and the new worker's
+//	compression sequence begins with a key frame, so the movie picks up at a key frame right where the old worker
+//	left off. A frame that kills every worker we give it to is reported as an error (and QTCmpr_CompressSequence
+//	then compresses the rest of the frames itself).
+//
+//	A worker that's still running may be broken in a quieter way, so we don't take what it puts in shared memory
+//	on trust: a compressed frame must have a size that fits in the room we gave it, and a sync flag that
+//	SCCompressSequenceFrame could have returned. A worker whose frame fails those checks is stopped, just as if it
+//	had died.
+//
+//	We keep track of the time the workers spend compressing frames and the time we spend waiting for them; the
+//	difference is the cost of isolation, which we report when the session ends.
+//
+//////////
+
+//////////
+//
+// header files
+//
+//////////
+
+#include "QTCompress.h"
+
+
+#if USE_CODEC_WORKERS
+
+//////////
+//
+// QTCmpr_NewWorkerGWorld
+// Begin a worker session by creating the graphics world that frames are rendered into; its pixels are in
+// shared memory, in the specified pixel format.
+//
+// Call QTCmpr_EndWorkerSession even if this function fails; it also disposes of the graphics world.
+//
+//////////
+
+OSErr QTCmpr_NewWorkerGWorld (WorkerSessionPtr theSession, Rect *theRect, OSType thePixelFormat, GWorldPtr *theGWorld, MemoryJobPtr theJob)
+{
+	SECURITY_ATTRIBUTES			mySecurity;
+	long						myRowBytes;
+	OSErr						myErr = noErr;
+
+	if ((theSession == NULL) || (theRect == NULL) || (theGWorld == NULL))
+		return(paramErr);
+
+	theSession->fRect = *theRect;
+	theSession->fPixelFormat = thePixelFormat;
+	theSession->fFrameMapping = NULL;
+	theSession->fFrame = NULL;
+	theSession->fFrameSize = 0L;
+	theSession->fControlMapping = NULL;
+	theSession->fControl = NULL;
+	theSession->fControlSize = 0L;
+	theSession->fGWorld = NULL;
+	theSession->fProcess = NULL;
+	theSession->fToWorker = NULL;
+	theSession->fFromWorker = NULL;
+	theSession->fNumDescs = 0L;
+	theSession->fNumRestarts = 0L;
+	theSession->fNumFrames = 0L;
+	theSession->fRoundTripTime = 0.0;
+	theSession->fCompressTime = 0.0;
+	theSession->fJob = theJob;
+
+	*theGWorld = NULL;
+
+	// the worker inherits the handles to our shared memory
+	mySecurity.nLength = sizeof(mySecurity);
+	mySecurity.lpSecurityDescriptor = NULL;
+	mySecurity.bInheritHandle = TRUE;
+
+	myRowBytes = ((((long)(theRect->right - theRect->left) * QTCmpr_GetPixelFormatDepth(thePixelFormat)) / 8L) + 15L) & ~15L;
+	theSession->fFrameSize = myRowBytes * (theRect->bottom - theRect->top);
+
+	theSession->fFrameMapping = CreateFileMapping(INVALID_HANDLE_VALUE, &mySecurity, PAGE_READWRITE, 0, theSession->fFrameSize, NULL);
+	if (theSession->fFrameMapping == NULL)
+		return(memFullErr);
+
+	theSession->fFrame = (Ptr)MapViewOfFile(theSession->fFrameMapping, FILE_MAP_ALL_ACCESS, 0, 0, 0);
+	if (theSession->fFrame == NULL)
+		return(memFullErr);
+
+	myErr = NewGWorldFromPtr(&theSession->fGWorld, thePixelFormat, theRect, NULL, NULL, 0, theSession->fFrame, myRowBytes);
+	if (myErr != noErr) {
+		theSession->fGWorld = NULL;
+		return(myErr);
+	}
+
+	*theGWorld = theSession->fGWorld;
+
+	return(noErr);
+}
+
+
+//////////
+//
+// QTCmpr_StartWorker
+// Start a worker process and have it begin a compression sequence with the current settings of the specified
+// Standard Compression component; return the image description of the compressed frames.
+//
+// The image description belongs to the session; don't dispose of it.
+//
+//////////
+
+OSErr QTCmpr_StartWorker (WorkerSessionPtr theSession, ComponentInstance theComponent, long theMaxSampleSize, TimeScale theTimeScale, ImageDescriptionHandle *theDesc)
+{
+	SECURITY_ATTRIBUTES			mySecurity;
+	QTAtomContainer				mySettings = NULL;
+	OSErr						myErr = noErr;
+
+	if ((theSession == NULL) || (theSession->fGWorld == NULL) || (theComponent == NULL) || (theDesc == NULL))
+		return(paramErr);
+
+	myErr = SCGetSettingsAsAtomContainer(theComponent, &mySettings);
+	if (myErr != noErr)
+		goto bail;
+
+	if (GetHandleSize(mySettings) > kWorkerMaxSettingsSize) {
+		myErr = paramErr;
+		goto bail;
+	}
+
+	// if the compressor can't tell us how big a compressed frame can get, assume it's no bigger than the frame
+	if (theMaxSampleSize <= 0L)
+		theMaxSampleSize = theSession->fFrameSize;
+
+	mySecurity.nLength = sizeof(mySecurity);
+	mySecurity.lpSecurityDescriptor = NULL;
+	mySecurity.bInheritHandle = TRUE;
+
+	theSession->fControlSize = sizeof(WorkerControl) + theMaxSampleSize;
+	QTCmpr_ReserveMemory(theSession->fJob, theSession->fControlSize);
+
+	theSession->fControlMapping = CreateFileMapping(INVALID_HANDLE_VALUE, &mySecurity, PAGE_READWRITE, 0, theSession->fControlSize, NULL);
+	if (theSession->fControlMapping == NULL) {
+		myErr = memFullErr;
+		goto bail;
+	}
+
+	theSession->fControl = (WorkerControlPtr)MapViewOfFile(theSession->fControlMapping, FILE_MAP_ALL_ACCESS, 0, 0, 0);
+	if (theSession->fControl == NULL) {
+		myErr = memFullErr;
+		goto bail;
+	}
+
+	theSession->fControl->fWidth = theSession->fRect.right - theSession->fRect.left;
+	theSession->fControl->fHeight = theSession->fRect.bottom - theSession->fRect.top;
+	theSession->fControl->fPixelFormat = theSession->fPixelFormat;
+	theSession->fControl->fRowBytes = QTGetPixMapHandleRowBytes(GetGWorldPixMap(theSession->fGWorld));
+	theSession->fControl->fTimeScale = theTimeScale;
+	theSession->fControl->fMaxSampleSize = theMaxSampleSize;
+	theSession->fControl->fSettingsSize = GetHandleSize(mySettings);
+	BlockMoveData(*mySettings, theSession->fControl->fSettings, theSession->fControl->fSettingsSize);
+
+	myErr = QTCmpr_LaunchWorker(theSession);
+	if (myErr != noErr)
+		goto bail;
+
+	*theDesc = theSession->fDescs[theSession->fNumDescs - 1];
+
+bail:
+	if (mySettings != NULL)
+		QTDisposeAtomContainer(mySettings);
+
+	return(myErr);
+}
+
+
+//////////
+//
+// QTCmpr_CompressWorkerFrame
+// Have the worker compress the frame in the session's graphics world, and return the compressed data, its
+// size, its sync flag, and the image description that goes with it.
+//
+// The compressed data is in shared memory, and is valid until the next call to this function. If the worker
+// dies, or returns a frame that can't be right (an empty one, one bigger than the room we gave it, or one with a
+// sync flag we don't know), we start another one and try again.
+//
+//////////
+
+OSErr QTCmpr_CompressWorkerFrame (WorkerSessionPtr theSession, TimeValue theDuration, Ptr *theData, long *theSize, short *theSyncFlag, ImageDescriptionHandle *theDesc)
+{
+	WorkerControlPtr			myControl = NULL;
+	long						myRetries = 0L;
+	char						myMessage;
+	double						myStart;
+	long						mySize;
+	short						mySyncFlag;
+	OSErr						myErr = noErr;
+
+	if ((theSession == NULL) || (theSession->fControl == NULL) || (theData == NULL) || (theSize == NULL) || (theSyncFlag == NULL) || (theDesc == NULL))
+		return(paramErr);
+
+	myControl = theSession->fControl;
+
+	while (true) {
+		if (theSession->fProcess != NULL) {
+			myControl->fDuration = theDuration;
+
+			myStart = QTCmpr_GetMicroseconds();
+			if (QTCmpr_SendWorkerMessage(theSession->fToWorker, kWorkerFrameMessage) &&
+				QTCmpr_ReceiveWorkerMessage(theSession->fFromWorker, &myMessage) && (myMessage == kWorkerSampleMessage)) {
+
+				theSession->fRoundTripTime += QTCmpr_GetMicroseconds() - myStart;
+				theSession->fCompressTime += myControl->fCompressTime;
+
+				if (myControl->fResult != noErr)
+					return(myControl->fResult);
+
+				// take the results out of shared memory once, so that what we check is what we return
+				mySize = myControl->fDataSize;
+				mySyncFlag = myControl->fSyncFlag;
+
+				if ((mySize > 0L) && (mySize <= theSession->fControlSize - (long)sizeof(WorkerControl)) &&
+					((mySyncFlag == 0) || (mySyncFlag == mediaSampleNotSync))) {
+					theSession->fNumFrames++;
+
+					*theData = (Ptr)(myControl + 1);
+					*theSize = mySize;
+					*theSyncFlag = mySyncFlag;
+					*theDesc = theSession->fDescs[theSession->fNumDescs - 1];
+
+					return(noErr);
+				}
+
+				QTCmpr_LogMessage("QTCmpr_CompressWorkerFrame: worker returned %ld bytes with sync flag %d", mySize, mySyncFlag);
+			}
+
+			// the worker died, or stopped making sense
+			QTCmpr_StopWorker(theSession, true);
+			QTCmpr_LogMessage("QTCmpr_CompressWorkerFrame: worker failed at frame %ld", theSession->fNumFrames);
+		}
+
+		// give the frame to a new worker, which begins with a key frame; but don't keep feeding it
+		// to workers if it kills every one of them
+		if ((myRetries++ >= kWorkerMaxRetries) || (theSession->fNumRestarts >= kWorkerMaxRestarts))
+			return(codecErr);
+
+		theSession->fNumRestarts++;
+
+		myErr = QTCmpr_LaunchWorker(theSession);
+		if (myErr != noErr)
+			return(myErr);
+	}
+}
+
+
+//////////
+//
+// QTCmpr_EndWorkerSession
+// Stop the worker, report the cost of isolation, and dispose of the session's graphics world and shared memory.
+//
+//////////
+
+void QTCmpr_EndWorkerSession (WorkerSessionPtr theSession)
+{
+	long						myIndex;
+
+	if (theSession == NULL)
+		return;
+
+	QTCmpr_StopWorker(theSession, false);
+
+	if (theSession->fNumFrames > 0L)
+		QTCmpr_LogMessage("QTCmpr_EndWorkerSession: %ld frames, %ld restarts; %.0f us per frame compressing, %.0f us per frame isolation overhead",
+							theSession->fNumFrames, theSession->fNumRestarts,
+							theSession->fCompressTime / theSession->fNumFrames,
+							(theSession->fRoundTripTime - theSession->fCompressTime) / theSession->fNumFrames);
+
+	for (myIndex = 0L; myIndex < theSession->fNumDescs; myIndex++)
+		DisposeHandle((Handle)theSession->fDescs[myIndex]);
+	theSession->fNumDescs = 0L;
+
+	if (theSession->fGWorld != NULL)
+		DisposeGWorld(theSession->fGWorld);
+	theSession->fGWorld = NULL;
+
+	if (theSession->fFrame != NULL)
+		UnmapViewOfFile(theSession->fFrame);
+	if (theSession->fFrameMapping != NULL)
+		CloseHandle(theSession->fFrameMapping);
+	theSession->fFrame = NULL;
+	theSession->fFrameMapping = NULL;
+
+	if (theSession->fControl != NULL)
+		UnmapViewOfFile(theSession->fControl);
+	if (theSession->fControlMapping != NULL)
+		CloseHandle(theSession->fControlMapping);
+	theSession->fControl = NULL;
+	theSession->fControlMapping = NULL;
+
+	QTCmpr_ReleaseMemory(theSession->fJob, theSession->fControlSize);
+	theSession->fControlSize = 0L;
+}
+
+
+//////////
+//
+// QTCmpr_IsWorkerProcess
+// Were we started as a worker process?
+//
+//////////
+
+Boolean QTCmpr_IsWorkerProcess (void)
+{
+	return(getenv(kWorkerVariable) != NULL);
+}
+
+
+//////////
+//
+// QTCmpr_RunWorker
+// Compress frames for the application that started us, until it closes our standard input.
+//
+//////////
+
+void QTCmpr_RunWorker (void)
+{
+	char						*myValue = getenv(kWorkerVariable);
+	unsigned long				myFrameHandle = 0L;
+	unsigned long				myControlHandle = 0L;
+	Ptr							myFrame = NULL;
+	WorkerControlPtr			myControl = NULL;
+	HANDLE						myInput = GetStdHandle(STD_INPUT_HANDLE);
+	HANDLE						myOutput = GetStdHandle(STD_OUTPUT_HANDLE);
+	ComponentInstance			myComponent = NULL;
+	GWorldPtr					myGWorld = NULL;
+	PixMapHandle				myPixMap = NULL;
+	Rect						myRect;
+	Handle						mySettings = NULL;
+	ImageDescriptionHandle		myDesc = NULL;
+	Boolean						myIsCompressing = false;
+	SCDataRateSettings			myRateSettings;
+	char						myMessage;
+	double						myStart;
+	OSErr						myErr = noErr;
+
+	if ((myValue == NULL) || (sscanf(myValue, "%lu %lu", &myFrameHandle, &myControlHandle) != 2))
+		return;
+
+	myControl = (WorkerControlPtr)MapViewOfFile((HANDLE)myControlHandle, FILE_MAP_ALL_ACCESS, 0, 0, 0);
+	if (myControl == NULL)
+		return;
+
+	//////////
+	//
+	// begin the compression sequence, and tell the application whether we managed to
+	//
+	//////////
+
+	myFrame = (Ptr)MapViewOfFile((HANDLE)myFrameHandle, FILE_MAP_ALL_ACCESS, 0, 0, 0);
+	if (myFrame == NULL) {
+		myErr = memFullErr;
+		goto ready;
+	}
+
+	MacSetRect(&myRect, 0, 0, myControl->fWidth, myControl->fHeight);
+
+	myErr = NewGWorldFromPtr(&myGWorld, myControl->fPixelFormat, &myRect, NULL, NULL, 0, myFrame, myControl->fRowBytes);
+	if (myErr != noErr) {
+		myGWorld = NULL;
+		goto ready;
+	}
+
+	myPixMap = GetGWorldPixMap(myGWorld);
+	LockPixels(myPixMap);
+
+	myComponent = OpenDefaultComponent(StandardCompressionType, StandardCompressionSubType);
+	if (myComponent == NULL) {
+		myErr = badComponentInstance;
+		goto ready;
+	}
+
+	myErr = PtrToHand(myControl->fSettings, &mySettings, myControl->fSettingsSize);
+	if (myErr != noErr)
+		goto ready;
+
+	myErr = SCSetSettingsFromAtomContainer(myComponent, mySettings);
+	if (myErr != noErr)
+		goto ready;
+
+	// SCCompressSequenceBegin allocates the image description, and SCCompressSequenceEnd disposes of it
+	myErr = SCCompressSequenceBegin(myComponent, myPixMap, NULL, &myDesc);
+	if (myErr != noErr)
+		goto ready;
+
+	myIsCompressing = true;
+
+	myControl->fDescSize = GetHandleSize((Handle)myDesc);
+	if (myControl->fDescSize > kWorkerMaxDescSize) {
+		myErr = paramErr;
+		goto ready;
+	}
+
+	BlockMoveData(*myDesc, myControl->fDesc, myControl->fDescSize);
+
+ready:
+	myControl->fResult = myErr;
+	if (!QTCmpr_SendWorkerMessage(myOutput, kWorkerReadyMessage) || (myErr != noErr))
+		goto bail;
+
+	//////////
+	//
+	// compress frames until the application has no more for us
+	//
+	//////////
+
+	while (QTCmpr_ReceiveWorkerMessage(myInput, &myMessage) && (myMessage == kWorkerFrameMessage)) {
+		Handle			myData = NULL;
+		long			myDataSize = 0L;
+		short			mySyncFlag = 0;
+
+		// as in QTCmpr_CompressSequence, tell Standard Compression the duration of the frame in milliseconds
+		if (!SCGetInfo(myComponent, scDataRateSettingsType, &myRateSettings)) {
+			myRateSettings.frameDuration = myControl->fDuration * 1000 / myControl->fTimeScale;
+			SCSetInfo(myComponent, scDataRateSettingsType, &myRateSettings);
+		}
+
+		myStart = QTCmpr_GetMicroseconds();
+		myErr = SCCompressSequenceFrame(myComponent, myPixMap, &myRect, &myData, &myDataSize, &mySyncFlag);
+		myControl->fCompressTime = (long)(QTCmpr_GetMicroseconds() - myStart);
+
+		if ((myErr == noErr) && (myDataSize > myControl->fMaxSampleSize))
+			myErr = memFullErr;
+
+		if (myErr == noErr)
+			BlockMoveData(*myData, (Ptr)(myControl + 1), myDataSize);
+
+		myControl->fResult = myErr;
+		myControl->fDataSize = myDataSize;
+		myControl->fSyncFlag = mySyncFlag;
+
+		if (!QTCmpr_SendWorkerMessage(myOutput, kWorkerSampleMessage))
+			break;
+	}
+
+bail:
+	if (myIsCompressing)
+		SCCompressSequenceEnd(myComponent);
+
+	if (myComponent != NULL)
+		CloseComponent(myComponent);
+
+	if (mySettings != NULL)
+		DisposeHandle(mySettings);
+
+	if (myGWorld != NULL)
+		DisposeGWorld(myGWorld);
+
+	if (myFrame != NULL)
+		UnmapViewOfFile(myFrame);
+
+	UnmapViewOfFile(myControl);
+}
+
+
+//////////
+//
+// QTCmpr_LaunchWorker
+// Start a worker process, and wait for it to begin its compression sequence.
+//
+//////////
+
+static OSErr QTCmpr_LaunchWorker (WorkerSessionPtr theSession)
+{
+	SECURITY_ATTRIBUTES			mySecurity;
+	STARTUPINFO					myStartup;
+	PROCESS_INFORMATION			myProcess;
+	HANDLE						myChildInput = NULL;
+	HANDLE						myChildOutput = NULL;
+	char						myPath[MAX_PATH];
+	char						myValue[64];
+	char						myMessage;
+	BOOL						myLaunched;
+	OSErr						myErr = noErr;
+
+	mySecurity.nLength = sizeof(mySecurity);
+	mySecurity.lpSecurityDescriptor = NULL;
+	mySecurity.bInheritHandle = TRUE;
+
+	// make the pipes; the worker inherits its ends of them, but not ours
+	if (!CreatePipe(&myChildInput, &theSession->fToWorker, &mySecurity, 0) ||
+		!CreatePipe(&theSession->fFromWorker, &myChildOutput, &mySecurity, 0)) {
+		myErr = memFullErr;
+		goto bail;
+	}
+
+	SetHandleInformation(theSession->fToWorker, HANDLE_FLAG_INHERIT, 0);
+	SetHandleInformation(theSession->fFromWorker, HANDLE_FLAG_INHERIT, 0);
+
+	// the worker is another copy of this application, with the shared memory handles in its environment
+	if (GetModuleFileName(NULL, myPath, MAX_PATH) == 0) {
+		myErr = fnfErr;
+		goto bail;
+	}
+
+	sprintf(myValue, "%lu %lu", (unsigned long)theSession->fFrameMapping, (unsigned long)theSession->fControlMapping);
+
+	ZeroMemory(&myStartup, sizeof(myStartup));
+	myStartup.cb = sizeof(myStartup);
+	myStartup.dwFlags = STARTF_USESTDHANDLES;
+	myStartup.hStdInput = myChildInput;
+	myStartup.hStdOutput = myChildOutput;
+	myStartup.hStdError = GetStdHandle(STD_ERROR_HANDLE);
+
+	SetEnvironmentVariable(kWorkerVariable, myValue);
+	myLaunched = CreateProcess(myPath, NULL, NULL, NULL, TRUE, 0, NULL, NULL, &myStartup, &myProcess);
+	SetEnvironmentVariable(kWorkerVariable, NULL);
+
+	if (!myLaunched) {
+		myErr = fnfErr;
+		goto bail;
+	}
+
+	CloseHandle(myProcess.hThread);
+	theSession->fProcess = myProcess.hProcess;
+
+	// now that the worker has its ends of the pipes, close our copies, so that we notice when it dies
+	CloseHandle(myChildInput);
+	CloseHandle(myChildOutput);
+	myChildInput = NULL;
+	myChildOutput = NULL;
+
+	if (!QTCmpr_ReceiveWorkerMessage(theSession->fFromWorker, &myMessage) || (myMessage != kWorkerReadyMessage)) {
+		myErr = codecErr;
+		goto bail;
+	}
+
+	myErr = theSession->fControl->fResult;
+	if (myErr != noErr)
+		goto bail;
+
+	myErr = QTCmpr_GetWorkerDesc(theSession);
+
+bail:
+	if (myChildInput != NULL)
+		CloseHandle(myChildInput);
+
+	if (myChildOutput != NULL)
+		CloseHandle(myChildOutput);
+
+	if (myErr != noErr)
+		QTCmpr_StopWorker(theSession, true);
+
+	return(myErr);
+}
+
+
+//////////
+//
+// QTCmpr_StopWorker
+// Stop the worker process, if there is one; if theKill is false, let it end its compression sequence first.
+//
+//////////
+
+static void QTCmpr_StopWorker (WorkerSessionPtr theSession, Boolean theKill)
+{
+	// closing the worker's standard input tells it to quit
+	if (theSession->fToWorker != NULL)
+		CloseHandle(theSession->fToWorker);
+	theSession->fToWorker = NULL;
+
+	if (theSession->fProcess != NULL) {
+		if (theKill || (WaitForSingleObject(theSession->fProcess, kWorkerExitTimeout) != WAIT_OBJECT_0))
+			TerminateProcess(theSession->fProcess, 1);
+		CloseHandle(theSession->fProcess);
+	}
+	theSession->fProcess = NULL;
+
+	if (theSession->fFromWorker != NULL)
+		CloseHandle(theSession->fFromWorker);
+	theSession->fFromWorker = NULL;
+}
+
+
+//////////
+//
+// QTCmpr_GetWorkerDesc
+// Get the image description that a new worker put into shared memory.
+//
+// Usually each worker's image description is the same as the last one's; if it isn't, we keep both, since the
+// sample writer may not yet have written the frames that use the last one.
+//
+//////////
+
+static OSErr QTCmpr_GetWorkerDesc (WorkerSessionPtr theSession)
+{
+	ImageDescriptionHandle		myDesc = NULL;
+	long						mySize = theSession->fControl->fDescSize;
+
+	if ((mySize < (long)sizeof(ImageDescription)) || (mySize > kWorkerMaxDescSize))
+		return(paramErr);
+
+	if (theSession->fNumDescs > 0L) {
+		myDesc = theSession->fDescs[theSession->fNumDescs - 1];
+		if ((GetHandleSize((Handle)myDesc) == mySize) && (memcmp(*myDesc, theSession->fControl->fDesc, mySize) == 0))
+			return(noErr);
+	}
+
+	if (theSession->fNumDescs > kWorkerMaxRestarts)
+		return(paramErr);
+
+	myDesc = (ImageDescriptionHandle)NewHandle(mySize);
+	if (myDesc == NULL)
+		return(memFullErr);
+
+	BlockMoveData(theSession->fControl->fDesc, *myDesc, mySize);
+	theSession->fDescs[theSession->fNumDescs++] = myDesc;
+
+	return(noErr);
+}
+
+
+//////////
+//
+// QTCmpr_SendWorkerMessage
+// Write a one-byte message to a pipe; return false if the other end has gone away.
+//
+//////////
+
+static Boolean QTCmpr_SendWorkerMessage (HANDLE thePipe, char theMessage)
+{
+	DWORD						myCount = 0;
+
+	return(WriteFile(thePipe, &theMessage, 1, &myCount, NULL) && (myCount == 1));
+}
+
+
+//////////
+//
+// QTCmpr_ReceiveWorkerMessage
+// Read a one-byte message from a pipe; return false if the other end has gone away.
+//
+//////////
+
+static Boolean QTCmpr_ReceiveWorkerMessage (HANDLE thePipe, char *theMessage)
+{
+	DWORD						myCount = 0;
+
+	return(ReadFile(thePipe, theMessage, 1, &myCount, NULL) && (myCount == 1));
+}
+
+
+//////////
+//
+// QTCmpr_GetMicroseconds
+// Return the time in microseconds, from an arbitrary starting point.
+//
+//////////
+
+static double QTCmpr_GetMicroseconds (void)
+{
+	LARGE_INTEGER				myFrequency;
+	LARGE_INTEGER				myCount;
+
+	if (!QueryPerformanceFrequency(&myFrequency) || !QueryPerformanceCounter(&myCount))
+		return((double)GetTickCount() * 1000.0);
+
+	return((double)myCount.QuadPart * 1000000.0 / (double)myFrequency.QuadPart);
+}
+
+#endif	// USE_CODEC_WORKERS
@@ -0,0 +1,162 @@
+//////////
+//
+//	File:		QTCmprWorker.h
+//
+//	Contains:	Codec worker processes, which run compression sequences outside the application so that a
+//				misbehaving codec can't take the application down with it, for use by QTCompress.
+//
+//	Written by:	Tim Monroe
+//
+//	Copyright:	 2000 by Apple Computer, Inc., all rights reserved.
+//
+//	Change History (most recent first):
+//
+//	   <2>	 	10/30/26	rtm		the frame can be in any of the pixel formats QTCmpr_CompressSequence renders in
+//	   <1>	 	10/29/26	rtm		first file
+//
+//////////
+
+#pragma once
+
+
+//////////
+//
+// header files
+//
+//////////
+
+#ifndef __QTCmprWorker__
+#define __QTCmprWorker__
+
+#ifndef __MOVIES__
+#include <Movies.h>
+#endif
+
+#ifndef __QUICKTIMECOMPONENTS__
+#include <QuickTimeComponents.h>
+#endif
+
+#if TARGET_OS_WIN32
+#include <windows.h>
+#endif
+
+#include "QTCmprBudget.h"
+
+
+//////////
+//
+// compiler flags
+//
+//////////
+
+// can we compress in worker processes? we need the Windows process and shared memory calls
+#if TARGET_OS_WIN32
+#define USE_CODEC_WORKERS				1
+#else
+#define USE_CODEC_WORKERS				0
+#endif
+
+
+//////////
+//
+// constants
+//
+//////////
+
+#define kWorkerVariable					"QTCOMPRESS_WORKER_HANDLES"	// environment variable giving a worker its shared memory
+#define kWorkerMaxSettingsSize			(32L * 1024L)			// maximum size of the flattened compression settings
+#define kWorkerMaxDescSize				(4L * 1024L)			// maximum size of the image description
+#define kWorkerMaxRestarts				8						// the most times we restart a worker in one session
+#define kWorkerMaxRetries				2						// the most times we retry a frame that kills the worker
+#define kWorkerExitTimeout				5000					// milliseconds to wait for a worker to quit
+
+// the messages that the application and a worker send each other through their pipes
+#define kWorkerFrameMessage				'F'						// to the worker: compress the frame in shared memory
+#define kWorkerReadyMessage				'R'						// from the worker: the sequence has begun (or failed to)
+#define kWorkerSampleMessage			'S'						// from the worker: the compressed frame is in shared memory
+
+
+//////////
+//
+// data types
+//
+//////////
+
+#if USE_CODEC_WORKERS
+
+// the control block in shared memory; the compressed frame data follows it
+typedef struct WorkerControl {
+	// set by the application when it starts a worker
+	short						fWidth;
+	short						fHeight;
+	OSType						fPixelFormat;
+	long						fRowBytes;
+	TimeScale					fTimeScale;
+	long						fMaxSampleSize;						// the room for compressed frame data
+	long						fSettingsSize;
+	UInt8						fSettings[kWorkerMaxSettingsSize];	// the compression settings, as a flattened atom container
+
+	// set by the worker when it has begun the compression sequence
+	long						fDescSize;
+	UInt8						fDesc[kWorkerMaxDescSize];			// the image description of the compressed frames
+
+	// set by the application for each frame
+	TimeValue					fDuration;
+
+	// set by the worker for each frame (or for the sequence, if fResult isn't noErr when it's ready)
+	OSErr						fResult;
+	long						fDataSize;
+	short						fSyncFlag;
+	long						fCompressTime;						// microseconds spent in SCCompressSequenceFrame
+} WorkerControl, *WorkerControlPtr;
+
+// the application's side of a worker session
+typedef struct WorkerSession {
+	Rect						fRect;
+	OSType						fPixelFormat;
+	HANDLE						fFrameMapping;						// the shared memory holding the frame to compress
+	Ptr							fFrame;
+	long						fFrameSize;
+	HANDLE						fControlMapping;					// the shared memory holding the control block and compressed data
+	WorkerControlPtr			fControl;
+	long						fControlSize;
+	GWorldPtr					fGWorld;							// a graphics world whose pixels are fFrame
+
+	HANDLE						fProcess;							// the worker process, or NULL
+	HANDLE						fToWorker;							// our ends of the pipes
+	HANDLE						fFromWorker;
+
+	ImageDescriptionHandle		fDescs[kWorkerMaxRestarts + 1];		// the image descriptions returned by each worker
+	long						fNumDescs;
+	long						fNumRestarts;
+	long						fNumFrames;
+	double						fRoundTripTime;						// microseconds spent waiting for workers to compress frames
+	double						fCompressTime;						// microseconds workers spent compressing frames
+	MemoryJobPtr				fJob;
+} WorkerSession, *WorkerSessionPtr;
+
+#endif
+
+
+//////////
+//
+// function prototypes
+//
+//////////
+
+#if USE_CODEC_WORKERS
+OSErr							QTCmpr_NewWorkerGWorld (WorkerSessionPtr theSession, Rect *theRect, OSType thePixelFormat, GWorldPtr *theGWorld, MemoryJobPtr theJob);
+OSErr							QTCmpr_StartWorker (WorkerSessionPtr theSession, ComponentInstance theComponent, long theMaxSampleSize, TimeScale theTimeScale, ImageDescriptionHandle *theDesc);
+OSErr							QTCmpr_CompressWorkerFrame (WorkerSessionPtr theSession, TimeValue theDuration, Ptr *theData, long *theSize, short *theSyncFlag, ImageDescriptionHandle *theDesc);
+void							QTCmpr_EndWorkerSession (WorkerSessionPtr theSession);
+Boolean							QTCmpr_IsWorkerProcess (void);
+void							QTCmpr_RunWorker (void);
+static OSErr					QTCmpr_LaunchWorker (WorkerSessionPtr theSession);
+static void						QTCmpr_StopWorker (WorkerSessionPtr theSession, Boolean theKill);
+static OSErr					QTCmpr_GetWorkerDesc (WorkerSessionPtr theSession);
+static Boolean					QTCmpr_SendWorkerMessage (HANDLE thePipe, char theMessage);
+static Boolean					QTCmpr_ReceiveWorkerMessage (HANDLE thePipe, char *theMessage);
+static double					QTCmpr_GetMicroseconds (void);
+#endif
+
+#endif	// __QTCmprWorker__
@@ -0,0 +1,615 @@
+//////////
+//
+//	File:		QTCmprWriter.c
+//
+//	Contains:	A media sample writer that produces compact sample tables, for use by QTCompress.
+//
+//	Written by:	Tim Monroe
+//
+//	Copyright:	 2000 by Apple Computer, Inc., all rights reserved.
+//
+//	Change History (most recent first):
+//
+//	   <6>	 	11/13/26	rtm		the chunks in a movie file go inside a movie data atom, whose size is kept up to date
+//	   <5>	 	11/13/26	rtm		added QTCmpr_SyncSampleWriter, so that a checkpoint can make sure its frames are on disk
+//	   <4>	 	11/13/26	rtm		the SHA-256 routines are now in QTCmprHash.c
+//	   <3>	 	11/10/26	rtm		samples already in a sample store are added as references to it, instead of being written again
+//	   <2>	 	10/28/26	rtm		added a log of the sample references written, for checkpoints
+//	   <1>	 	10/25/26	rtm		first file
+//
+//	Adding each compressed frame to the destination media with its own call to AddMediaSample makes each
+//	frame a chunk of its own, so the sample-to-chunk and chunk offset tables in the new movie have one entry
+//	per frame. For a long movie those tables (and so the movie atom) get large, and a player has to read and
+//	parse all of them before it can open the movie.
+//
+//	Instead, we collect the compressed frames in a chunk buffer in memory, noting as each frame arrives
+//	whether it has the same size, duration, and flags as the previous one; if it does, it simply extends the
+//	current run. When the chunk buffer fills up, we write it to the media's data file with a single call to
+//	the data handler and add the samples with a single call to AddMediaSampleReferences, passing one sample
+//	reference record per run. The Movie Toolbox then records the whole chunk as one sample-to-chunk entry,
+//	records the runs as time-to-sample runs, and (if every sample has the same size) records a single
+//	constant sample size.
+//
+//	This is the same technique the sequence grabber uses to write movie data.
+//
+//	The 32-bit data handler and sample reference calls take signed offsets, so once the data file reaches
+//	2 GB we switch to DataHWrite64 and AddMediaSampleReferences64; the Movie Toolbox then writes 64-bit
+//	chunk offsets for any chunks past 4 GB.
+//
+//	A caller that wants to record its progress (see QTCmprCheckpoint.c) can ask us to keep a log of the sample
+//	references we add; each entry in the log is a run of samples, with its final file offset.
+//
+//	If the media's data file is a sample store (see QTCmprSampleStore.c), we work out the digest of each sample
+//	and look it up in the store; a sample that's already there isn't copied into the chunk, but added as a
+//	reference to the data in the store (or, if the copy is in the chunk we're filling, to that). A run is then no
+//	longer just the next stretch of the chunk, so each run notes whether its offset is in the chunk or in the file,
+//	and a sample extends a run only if its data follows on from the run's.
+//
+//	Otherwise, the media's data file is the new movie file, and every atom in a movie file must be accounted for:
+//	the chunks can't just sit at the front of the file, ahead of the movie atom that AddMovieResource appends. So
+//	we begin the file with the header of a movie data atom ('mdat'), and the chunks are its contents. We don't know
+//	how big the atom will get, so the header always has a 64-bit size; we update the size whenever the data in the
+//	file must be complete (see QTCmpr_SyncSampleWriter and QTCmpr_ResumeSampleWriter), and when we're done.
+//
+//////////
+
+//////////
+//
+// header files
+//
+//////////
+
+#include "QTCmprWriter.h"
+
+
+//////////
+//
+// QTCmpr_BeginSampleWriter
+// Prepare to write samples into the specified media. Call this after BeginMediaEdits.
+//
+// The chunk buffer is reserved against the memory budget for the specified job. If theStore isn't NULL, the
+// media's data file is that sample store, and samples already in it aren't written again. Otherwise, if the
+// media's data file is empty, we begin it with a movie data atom header.
+//
+//////////
+
+OSErr QTCmpr_BeginSampleWriter (SampleWriterPtr theWriter, Media theMedia, SampleStorePtr theStore, MemoryJobPtr theJob)
+{
+	wide						myFileSize;
+	OSErr						myErr = noErr;
+
+	if ((theWriter == NULL) || (theMedia == NULL))
+		return(paramErr);
+
+	theWriter->fMedia = theMedia;
+	theWriter->fDesc = NULL;
+	theWriter->fChunk = NULL;
+	theWriter->fChunkSize = 0L;
+	theWriter->fChunkCapacity = 0L;
+	theWriter->fNumRuns = 0;
+	theWriter->fUse64BitOffsets = false;
+	theWriter->fNumSamples = 0L;
+	theWriter->fNumReferences = 0L;
+	theWriter->fDataEnd.hi = 0;
+	theWriter->fDataEnd.lo = 0;
+	theWriter->fLog = NULL;
+	theWriter->fNumLogged = 0L;
+	theWriter->fStore = theStore;
+	theWriter->fHasMDatHeader = false;
+	theWriter->fJob = theJob;
+
+	// the media's data is written by the data handler for its first data reference (the movie file, or the store)
+	theWriter->fDataHandler = GetMediaDataHandler(theMedia, 1);
+	if (theWriter->fDataHandler == NULL)
+		return(GetMoviesError() != noErr ? GetMoviesError() : badComponentInstance);
+
+	myErr = DataHGetFileSize64(theWriter->fDataHandler, &myFileSize);
+	if (myErr != noErr)
+		return(myErr);
+
+	if (theStore != NULL) {
+		// the store's index must agree with its data file
+		myErr = QTCmpr_CheckSampleStore(theStore, &myFileSize);
+		if (myErr != noErr)
+			return(myErr);
+	} else if ((myFileSize.hi == 0) && (myFileSize.lo == 0)) {
+		// a new movie file; the chunks follow the movie data atom header (a file we're resuming already has one)
+		theWriter->fDataEnd.lo = kWriterMDatHeaderSize;
+		theWriter->fHasMDatHeader = true;
+
+		myErr = QTCmpr_WriteMDatHeader(theWriter);
+		if (myErr != noErr)
+			return(myErr);
+	}
+
+	return(QTCmpr_GrowChunk(theWriter, kWriterChunkSize));
+}
+
+
+//////////
+//
+// QTCmpr_WriteSample
+// Add a sample to the media.
+//
+// The sample data is copied, so the caller may reuse theData as soon as this function returns. The sample
+// may not actually be written to the file until a later call to QTCmpr_WriteSample or QTCmpr_EndSampleWriter.
+//
+//////////
+
+OSErr QTCmpr_WriteSample (SampleWriterPtr theWriter, Ptr theData, long theSize, TimeValue theDuration, SampleDescriptionHandle theDesc, short theFlags)
+{
+	SampleReference64Record		*myRun = NULL;
+	HashState					myHash;
+	UInt8						myDigest[kHashDigestSize];
+	wide						myOffset;						// where the sample's data is (or is going)
+	Boolean						myIsShared = false;				// is the data already in the store?
+	Boolean						myIsPending = true;				// is myOffset relative to the chunk?
+	Boolean						myExtendsRun;
+	OSErr						myErr = noErr;
+
+	if ((theWriter == NULL) || (theData == NULL) || (theSize <= 0L) || (theDesc == NULL))
+		return(paramErr);
+
+	// all samples in a chunk must share a sample description
+	if ((theDesc != theWriter->fDesc) && (theWriter->fNumRuns > 0)) {
+		myErr = QTCmpr_FlushChunk(theWriter);
+		if (myErr != noErr)
+			return(myErr);
+	}
+
+	theWriter->fDesc = theDesc;
+
+	// a sample that's already in the store (or in the chunk, on its way there) isn't copied again
+	if (theWriter->fStore != NULL) {
+		QTCmpr_BeginHash(&myHash);
+		QTCmpr_AddToHash(&myHash, theData, theSize);
+		QTCmpr_EndHash(&myHash, myDigest);
+
+		myIsShared = QTCmpr_FindStoredSample(theWriter->fStore, myDigest, theSize, &myOffset, &myIsPending);
+		QTCmpr_CountStoredSample(theWriter->fStore, theSize, myIsShared);
+	}
+
+	// if this sample won't fit in the chunk buffer, write out what we have
+	if (!myIsShared && (theWriter->fChunkSize > 0L) && (theWriter->fChunkSize + theSize > theWriter->fChunkCapacity)) {
+		myErr = QTCmpr_FlushChunk(theWriter);
+		if (myErr != noErr)
+			return(myErr);
+	}
+
+	if (!myIsShared) {
+		myOffset.hi = 0;
+		myOffset.lo = (UInt32)theWriter->fChunkSize;
+	}
+
+	// see whether this sample is like the last one
+	myExtendsRun = QTCmpr_FollowsLastRun(theWriter, &myOffset, !myIsPending, theSize, theDuration, theFlags);
+
+	// if we'd need a new run and there's no room for one, write out what we have; a shared sample that was
+	// in the chunk is then in the file
+	if (!myExtendsRun && (theWriter->fNumRuns == kWriterMaxRuns)) {
+		myErr = QTCmpr_FlushChunk(theWriter);
+		if (myErr != noErr)
+			return(myErr);
+
+		if (myIsShared)
+			QTCmpr_FindStoredSample(theWriter->fStore, myDigest, theSize, &myOffset, &myIsPending);
+		else
+			myOffset.lo = (UInt32)theWriter->fChunkSize;
+	}
+
+	if (!myIsShared) {
+		// a single sample may be bigger than the chunk buffer
+		if (theSize > theWriter->fChunkCapacity) {
+			myErr = QTCmpr_GrowChunk(theWriter, theSize);
+			if (myErr != noErr)
+				return(myErr);
+		}
+
+		BlockMoveData(theData, theWriter->fChunk + theWriter->fChunkSize, theSize);
+
+		if (theWriter->fStore != NULL) {
+			myErr = QTCmpr_AddStoredSample(theWriter->fStore, myDigest, theWriter->fChunkSize, theSize);
+			if (myErr != noErr)
+				return(myErr);
+		}
+	}
+
+	if (myExtendsRun) {
+		theWriter->fRuns[theWriter->fNumRuns - 1].numberOfSamples++;
+	} else {
+		theWriter->fRunIsInFile[theWriter->fNumRuns] = !myIsPending;
+		myRun = &theWriter->fRuns[theWriter->fNumRuns++];
+		myRun->dataOffset = myOffset;
+		myRun->dataSize = theSize;
+		myRun->durationPerSample = theDuration;
+		myRun->numberOfSamples = 1;
+		myRun->sampleFlags = theFlags;
+	}
+
+	if (!myIsShared)
+		theWriter->fChunkSize += theSize;
+	theWriter->fNumSamples++;
+
+	return(noErr);
+}
+
+
+//////////
+//
+// QTCmpr_EndSampleWriter
+// Finish writing samples, writing out any samples still in the chunk buffer if theFlush is true, and
+// dispose of the chunk buffer. Call this before EndMediaEdits.
+//
+//////////
+
+OSErr QTCmpr_EndSampleWriter (SampleWriterPtr theWriter, Boolean theFlush)
+{
+	OSErr						myErr = noErr;
+
+	if (theWriter == NULL)
+		return(paramErr);
+
+	if (theFlush)
+		myErr = QTCmpr_FlushChunk(theWriter);
+
+	// the movie data atom ends with the last chunk we wrote
+	if (theWriter->fHasMDatHeader) {
+		if (myErr == noErr)
+			myErr = QTCmpr_WriteMDatHeader(theWriter);
+		else
+			QTCmpr_WriteMDatHeader(theWriter);
+	}
+
+	if (theWriter->fChunk != NULL) {
+		DisposePtr(theWriter->fChunk);
+		QTCmpr_ReleaseMemory(theWriter->fJob, theWriter->fChunkCapacity);
+	}
+
+	theWriter->fChunk = NULL;
+	theWriter->fChunkSize = 0L;
+	theWriter->fChunkCapacity = 0L;
+	theWriter->fNumRuns = 0;
+
+	if (theWriter->fLog != NULL)
+		DisposeHandle(theWriter->fLog);
+
+	theWriter->fLog = NULL;
+	theWriter->fNumLogged = 0L;
+	theWriter->fStore = NULL;
+	theWriter->fHasMDatHeader = false;
+
+	return(myErr);
+}
+
+
+//////////
+//
+// QTCmpr_FlushSampleWriter
+// Write out any samples in the chunk buffer now, instead of waiting for the buffer to fill up.
+//
+//////////
+
+OSErr QTCmpr_FlushSampleWriter (SampleWriterPtr theWriter)
+{
+	if (theWriter == NULL)
+		return(paramErr);
+
+	return(QTCmpr_FlushChunk(theWriter));
+}
+
+
+//////////
+//
+// QTCmpr_SyncSampleWriter
+// Make the data handler write out everything written to the media's data file so far.
+//
+// QTCmpr_FlushSampleWriter hands the chunk buffer to the data handler, which may keep it in its own buffers for a
+// while; call this too when the data must be in the file (before a checkpoint commits it, say). The movie data
+// atom header is brought up to date first, so that the file on disk is well formed up to the last chunk.
+//
+//////////
+
+OSErr QTCmpr_SyncSampleWriter (SampleWriterPtr theWriter)
+{
+	OSErr						myErr = noErr;
+
+	if (theWriter == NULL)
+		return(paramErr);
+
+	if (theWriter->fHasMDatHeader) {
+		myErr = QTCmpr_WriteMDatHeader(theWriter);
+		if (myErr != noErr)
+			return(myErr);
+	}
+
+	return(DataHFlushData(theWriter->fDataHandler));
+}
+
+
+//////////
+//
+// QTCmpr_ResumeSampleWriter
+// Throw away everything in the media's data file past theDataEnd, so that the next chunk is written there.
+//
+// Call this right after QTCmpr_BeginSampleWriter, when adding samples to a partly written file. Unless the file is
+// a sample store, it must begin with the movie data atom header we wrote when we started it; we cut the atom back
+// to theDataEnd too.
+//
+//////////
+
+OSErr QTCmpr_ResumeSampleWriter (SampleWriterPtr theWriter, wide *theDataEnd)
+{
+	wide						myFileSize;
+	UInt32						myHeader[2];
+	OSErr						myErr = noErr;
+
+	if ((theWriter == NULL) || (theDataEnd == NULL) || (theWriter->fNumRuns > 0))
+		return(paramErr);
+
+	// the file must still hold all the data we expect
+	myErr = DataHGetFileSize64(theWriter->fDataHandler, &myFileSize);
+	if (myErr != noErr)
+		return(myErr);
+
+	if ((myFileSize.hi < theDataEnd->hi) || ((myFileSize.hi == theDataEnd->hi) && (myFileSize.lo < theDataEnd->lo)))
+		return(eofErr);
+
+	// the chunks in a movie file follow the movie data atom header, which has a 64-bit size
+	if (theWriter->fStore == NULL) {
+		if ((theDataEnd->hi == 0) && (theDataEnd->lo < kWriterMDatHeaderSize))
+			return(badFileFormat);
+
+		myErr = DataHScheduleData(theWriter->fDataHandler, (Ptr)myHeader, 0L, sizeof(myHeader), 0L, NULL, NULL);
+		if (myErr != noErr)
+			return(myErr);
+
+		if ((EndianU32_BtoN(myHeader[0]) != 1) || (EndianU32_BtoN(myHeader[1]) != FOUR_CHAR_CODE('mdat')))
+			return(badFileFormat);
+	}
+
+	myErr = DataHSetFileSize64(theWriter->fDataHandler, theDataEnd);
+	if (myErr != noErr)
+		return(myErr);
+
+	theWriter->fDataEnd = *theDataEnd;
+
+	if (theWriter->fStore == NULL) {
+		theWriter->fHasMDatHeader = true;
+
+		myErr = QTCmpr_WriteMDatHeader(theWriter);
+		if (myErr != noErr)
+			return(myErr);
+	}
+
+	return(noErr);
+}
+
+
+//////////
+//
+// QTCmpr_KeepSampleLog
+// Start keeping a log of the sample references we add to the media.
+//
+//////////
+
+OSErr QTCmpr_KeepSampleLog (SampleWriterPtr theWriter)
+{
+	if (theWriter == NULL)
+		return(paramErr);
+
+	if (theWriter->fLog == NULL) {
+		theWriter->fLog = NewHandle(0);
+		if (theWriter->fLog == NULL)
+			return(memFullErr);
+	}
+
+	theWriter->fNumLogged = 0L;
+
+	return(noErr);
+}
+
+
+//////////
+//
+// QTCmpr_TakeSampleLog
+// Return the log of sample references added since the last call (an array of SampleReference64Record),
+// and start a new log; the caller must dispose of the returned handle.
+//
+// Return NULL if we aren't keeping a log, or if we can't start a new one.
+//
+//////////
+
+Handle QTCmpr_TakeSampleLog (SampleWriterPtr theWriter, long *theNumReferences)
+{
+	Handle						myLog = NULL;
+	Handle						myNewLog = NULL;
+
+	if ((theWriter == NULL) || (theWriter->fLog == NULL) || (theNumReferences == NULL))
+		return(NULL);
+
+	myNewLog = NewHandle(0);
+	if (myNewLog == NULL)
+		return(NULL);
+
+	myLog = theWriter->fLog;
+	*theNumReferences = theWriter->fNumLogged;
+
+	theWriter->fLog = myNewLog;
+	theWriter->fNumLogged = 0L;
+
+	return(myLog);
+}
+
+
+//////////
+//
+// QTCmpr_FlushChunk
+// Write the chunk buffer to the end of the media's data file and add its samples to the media.
+//
+//////////
+
+static OSErr QTCmpr_FlushChunk (SampleWriterPtr theWriter)
+{
+	SampleReferenceRecord		myRuns[kWriterMaxRuns];
+	wide						myOffset;
+	UInt32						myLow;
+	TimeValue					mySampleTime;
+	short						myIndex;
+	OSErr						myErr = noErr;
+
+	if (theWriter->fNumRuns == 0)
+		return(noErr);
+
+	// the chunk goes at the end of the file
+	myErr = DataHGetFileSize64(theWriter->fDataHandler, &myOffset);
+	if (myErr != noErr)
+		return(myErr);
+
+	// once the end of the chunk is past the reach of a signed 32-bit offset, switch to the 64-bit calls for good
+	if ((myOffset.hi != 0) || (myOffset.lo > (UInt32)0x7FFFFFFF - (UInt32)theWriter->fChunkSize))
+		theWriter->fUse64BitOffsets = true;
+
+	// if every sample in the chunk was shared, there's nothing to write
+	if (theWriter->fChunkSize > 0L) {
+		if (theWriter->fUse64BitOffsets)
+			myErr = DataHWrite64(theWriter->fDataHandler, theWriter->fChunk, &myOffset, theWriter->fChunkSize, NULL, 0L);
+		else
+			myErr = DataHWrite(theWriter->fDataHandler, theWriter->fChunk, (long)myOffset.lo, theWriter->fChunkSize, NULL, 0L);
+		if (myErr != noErr)
+			return(myErr);
+	}
+
+	if (theWriter->fStore != NULL)
+		QTCmpr_CommitStoredSamples(theWriter->fStore, &myOffset);
+
+	// the run offsets are relative to the start of the chunk; make them file offsets
+	for (myIndex = 0; myIndex < theWriter->fNumRuns; myIndex++) {
+		if (theWriter->fRunIsInFile[myIndex])
+			continue;
+
+		myLow = theWriter->fRuns[myIndex].dataOffset.lo + myOffset.lo;
+		theWriter->fRuns[myIndex].dataOffset.hi = myOffset.hi + ((myLow < myOffset.lo) ? 1 : 0);
+		theWriter->fRuns[myIndex].dataOffset.lo = myLow;
+	}
+
+	if (theWriter->fUse64BitOffsets) {
+		myErr = AddMediaSampleReferences64(theWriter->fMedia, theWriter->fDesc, theWriter->fNumRuns, theWriter->fRuns, &mySampleTime);
+	} else {
+		for (myIndex = 0; myIndex < theWriter->fNumRuns; myIndex++) {
+			myRuns[myIndex].dataOffset = (long)theWriter->fRuns[myIndex].dataOffset.lo;
+			myRuns[myIndex].dataSize = (long)theWriter->fRuns[myIndex].dataSize;
+			myRuns[myIndex].durationPerSample = theWriter->fRuns[myIndex].durationPerSample;
+			myRuns[myIndex].numberOfSamples = (long)theWriter->fRuns[myIndex].numberOfSamples;
+			myRuns[myIndex].sampleFlags = theWriter->fRuns[myIndex].sampleFlags;
+		}
+
+		myErr = AddMediaSampleReferences(theWriter->fMedia, theWriter->fDesc, theWriter->fNumRuns, myRuns, &mySampleTime);
+	}
+	if (myErr != noErr)
+		return(myErr);
+
+	// add the runs, with their file offsets, to the log
+	if (theWriter->fLog != NULL) {
+		SetHandleSize(theWriter->fLog, (theWriter->fNumLogged + theWriter->fNumRuns) * sizeof(SampleReference64Record));
+		myErr = MemError();
+		if (myErr != noErr)
+			return(myErr);
+
+		BlockMoveData(theWriter->fRuns, *theWriter->fLog + (theWriter->fNumLogged * sizeof(SampleReference64Record)), theWriter->fNumRuns * sizeof(SampleReference64Record));
+		theWriter->fNumLogged += theWriter->fNumRuns;
+	}
+
+	theWriter->fDataEnd.lo = myOffset.lo + (UInt32)theWriter->fChunkSize;
+	theWriter->fDataEnd.hi = myOffset.hi + ((theWriter->fDataEnd.lo < myOffset.lo) ? 1 : 0);
+	theWriter->fNumReferences += theWriter->fNumRuns;
+	theWriter->fNumRuns = 0;
+	theWriter->fChunkSize = 0L;
+
+	return(noErr);
+}
+
+
+//////////
+//
+// QTCmpr_GrowChunk
+// Make sure the chunk buffer can hold at least theSize bytes.
+//
+//////////
+
+static OSErr QTCmpr_GrowChunk (SampleWriterPtr theWriter, long theSize)
+{
+	Ptr							myChunk = NULL;
+
+	if (theSize <= theWriter->fChunkCapacity)
+		return(noErr);
+
+	QTCmpr_ReserveMemory(theWriter->fJob, theSize);
+
+	myChunk = NewPtr(theSize);
+	if (myChunk == NULL) {
+		QTCmpr_ReleaseMemory(theWriter->fJob, theSize);
+		return(memFullErr);
+	}
+
+	if (theWriter->fChunk != NULL) {
+		BlockMoveData(theWriter->fChunk, myChunk, theWriter->fChunkSize);
+		DisposePtr(theWriter->fChunk);
+		QTCmpr_ReleaseMemory(theWriter->fJob, theWriter->fChunkCapacity);
+	}
+
+	theWriter->fChunk = myChunk;
+	theWriter->fChunkCapacity = theSize;
+
+	return(noErr);
+}
+
+
+//////////
+//
+// QTCmpr_WriteMDatHeader
+// Write the movie data atom header at the start of the media's data file, giving the atom the size it has now.
+//
+// The atom runs from the start of the file to the end of the last chunk we wrote. Its 32-bit size is 1, which
+// means that a 64-bit size follows the atom type.
+//
+//////////
+
+static OSErr QTCmpr_WriteMDatHeader (SampleWriterPtr theWriter)
+{
+	UInt32						myHeader[kWriterMDatHeaderSize / sizeof(UInt32)];
+
+	myHeader[0] = EndianU32_NtoB(1);
+	myHeader[1] = EndianU32_NtoB(FOUR_CHAR_CODE('mdat'));
+	myHeader[2] = EndianU32_NtoB(theWriter->fDataEnd.hi);
+	myHeader[3] = EndianU32_NtoB(theWriter->fDataEnd.lo);
+
+	return(DataHWrite(theWriter->fDataHandler, (Ptr)myHeader, 0L, kWriterMDatHeaderSize, NULL, 0L));
+}
+
+
+//////////
+//
+// QTCmpr_FollowsLastRun
+// Return true if a sample with the specified size, duration, and flags, whose data is at theOffset (in the file
+// if theIsInFile is true, otherwise in the chunk), can be added to the last run.
+//
+//////////
+
+static Boolean QTCmpr_FollowsLastRun (SampleWriterPtr theWriter, wide *theOffset, Boolean theIsInFile, long theSize, TimeValue theDuration, short theFlags)
+{
+	SampleReference64Record		*myRun = NULL;
+	UInt32						myEnd;
+
+	if (theWriter->fNumRuns == 0)
+		return(false);
+
+	myRun = &theWriter->fRuns[theWriter->fNumRuns - 1];
+	if (((long)myRun->dataSize != theSize) || (myRun->durationPerSample != theDuration) || (myRun->sampleFlags != theFlags))
+		return(false);
+
+	// the sample's data must follow on from the run's
+	myEnd = myRun->dataOffset.lo + (myRun->dataSize * myRun->numberOfSamples);
+
+	return((theWriter->fRunIsInFile[theWriter->fNumRuns - 1] == theIsInFile) && (myRun->dataOffset.hi == theOffset->hi) &&
+				(myEnd >= myRun->dataOffset.lo) && (myEnd == theOffset->lo));
+}
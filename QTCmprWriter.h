@@ -0,0 +1,106 @@
+//////////
+//
+//	File:		QTCmprWriter.h
+//
+//	Contains:	A media sample writer that produces compact sample tables, for use by QTCompress.
+//
+//	Written by:	Tim Monroe
+//
+//	Copyright:	 2000 by Apple Computer, Inc., all rights reserved.
+//
+//	Change History (most recent first):
+//
+//	   <5>	 	11/13/26	rtm		added kWriterMDatHeaderSize and QTCmpr_WriteMDatHeader
+//	   <4>	 	11/13/26	rtm		added QTCmpr_SyncSampleWriter
+//	   <3>	 	11/10/26	rtm		samples already in a sample store are added as references to it, instead of being written again
+//	   <2>	 	10/28/26	rtm		added a log of the sample references written, for checkpoints
+//	   <1>	 	10/25/26	rtm		first file
+//
+//////////
+
+#pragma once
+
+
+//////////
+//
+// header files
+//
+//////////
+
+#ifndef __QTCmprWriter__
+#define __QTCmprWriter__
+
+#ifndef __MOVIES__
+#include <Movies.h>
+#endif
+
+#ifndef __QUICKTIMECOMPONENTS__
+#include <QuickTimeComponents.h>
+#endif
+
+#include "QTCmprBudget.h"
+#include "QTCmprSampleStore.h"
+
+
+//////////
+//
+// constants
+//
+//////////
+
+#define kWriterChunkSize				(256L * 1024L)			// we write a chunk once it holds at least this many bytes
+#define kWriterMaxRuns					64						// maximum number of runs of like samples in a chunk
+#define kWriterMDatHeaderSize			16						// size of a movie data atom header with a 64-bit size
+
+
+//////////
+//
+// data types
+//
+//////////
+
+// a sample writer; samples are collected into chunks in memory, and each chunk is written to the media's
+// data file in one piece and added to the media as a list of runs of samples with the same size, duration,
+// and flags
+typedef struct SampleWriter {
+	Media						fMedia;							// the media we're adding samples to
+	DataHandler					fDataHandler;					// the data handler for the media's data file
+	SampleDescriptionHandle		fDesc;							// the sample description of the samples in the chunk
+	Ptr							fChunk;							// the chunk buffer
+	long						fChunkSize;						// the number of bytes in the chunk buffer
+	long						fChunkCapacity;					// the size of the chunk buffer
+	SampleReference64Record		fRuns[kWriterMaxRuns];			// the runs of samples in the chunk; the offsets are relative to the chunk,
+	Boolean						fRunIsInFile[kWriterMaxRuns];	// unless the run's samples were already in the file
+	short						fNumRuns;
+	Boolean						fUse64BitOffsets;				// has the data file grown past 2 GB?
+	long						fNumSamples;					// the number of samples written so far
+	long						fNumReferences;					// the number of sample references added so far
+	wide						fDataEnd;						// the end of the last chunk we wrote, as a file offset
+	Handle						fLog;							// the sample references written since the log was last taken, or NULL
+	long						fNumLogged;						// the number of references in fLog
+	SampleStorePtr				fStore;							// the store the media's data file belongs to, or NULL
+	Boolean						fHasMDatHeader;					// does the data file begin with a movie data atom header?
+	MemoryJobPtr				fJob;							// the job that the chunk buffer is reserved for
+} SampleWriter, *SampleWriterPtr;
+
+
+//////////
+//
+// function prototypes
+//
+//////////
+
+OSErr							QTCmpr_BeginSampleWriter (SampleWriterPtr theWriter, Media theMedia, SampleStorePtr theStore, MemoryJobPtr theJob);
+OSErr							QTCmpr_WriteSample (SampleWriterPtr theWriter, Ptr theData, long theSize, TimeValue theDuration, SampleDescriptionHandle theDesc, short theFlags);
+OSErr							QTCmpr_EndSampleWriter (SampleWriterPtr theWriter, Boolean theFlush);
+OSErr							QTCmpr_FlushSampleWriter (SampleWriterPtr theWriter);
+OSErr							QTCmpr_SyncSampleWriter (SampleWriterPtr theWriter);
+OSErr							QTCmpr_ResumeSampleWriter (SampleWriterPtr theWriter, wide *theDataEnd);
+OSErr							QTCmpr_KeepSampleLog (SampleWriterPtr theWriter);
+Handle							QTCmpr_TakeSampleLog (SampleWriterPtr theWriter, long *theNumReferences);
+static OSErr					QTCmpr_FlushChunk (SampleWriterPtr theWriter);
+static OSErr					QTCmpr_GrowChunk (SampleWriterPtr theWriter, long theSize);
+static OSErr					QTCmpr_WriteMDatHeader (SampleWriterPtr theWriter);
+static Boolean					QTCmpr_FollowsLastRun (SampleWriterPtr theWriter, wide *theOffset, Boolean theIsInFile, long theSize, TimeValue theDuration, short theFlags);
+
+#endif	// __QTCmprWriter__
@@ -12,6 +12,71 @@
 //
 //	Change History (most recent first):
 //
+//	   <31>	 	11/13/26	rtm		source samples are copied only if they're all in the source file; QTCmpr_CopySourceSamples
+//									checks every sample QTParse finds before it writes any, and otherwise uses GetMediaSample
+//	   <30>	 	11/13/26	rtm		golden digests are labelled with the crop, output size, resize filter, and frame rate;
+//									QTCmpr_CompressIngest also digests the raw frames of its source; added record mode
+//	   <29>	 	11/13/26	rtm		QTCmpr_BeginSequenceOutput opens (and locks) the sample store first, and writes the samples
+//									into the movie file if another copy of QTCompress has it locked
+//	   <28>	 	11/13/26	rtm		frames converted to Y'CbCr with the BT.709 coefficients get an 'nclc' extension saying so
+//	   <27>	 	11/13/26	rtm		QTCmpr_SetSourceSettings lets us copy a track's samples only if the track is the movie's only
+//									enabled visual track, is drawn as is, fills the movie box, and has a single plain edit
+//	   <26>	 	11/13/26	rtm		QTCmpr_GetSourcePixelFormat looks at every visual track, not just the video tracks
+//	   <25>	 	11/13/26	rtm		in worker mode, QTCmpr_CompressSequence compresses the rest of the frames itself if the
+//									workers keep failing
+//	   <24>	 	11/13/26	rtm		a compression is resumed only if the source file and the settings are unchanged since the
+//									checkpoint was written (see QTCmprCheckpoint.c)
+//	   <23>	 	11/13/26	rtm		QTCmpr_CompressSequence waits for the source movie to load before it looks for its video track
+//	   <22>	 	11/13/26	rtm		QTCmpr_CopySourceSamples reads the source samples in place with QTParse (see QTParse.c),
+//									falling back to GetMediaSample if QTParse can't read the source file
+//	   <21>	 	11/11/26	rtm		added USE_DETERMINISTIC_MODE; if deterministic mode is enabled in the environment, the
+//									same source and settings always give the same samples (frames are cut into the same
+//									slices, and checkpoints are counted in frames), and QTCmpr_CompressImage,
+//									QTCmpr_CompressSequence, and QTCmpr_CompressIngest check a digest of their samples
+//									against a golden file (see QTCmprGolden.c)
+//	   <20>	 	11/10/26	rtm		added USE_SAMPLE_STORE; if a sample store is named in the environment, the media of
+//									each new movie file refer to the store, and samples already in it aren't written again
+//									(see QTCmprSampleStore.c)
+//	   <19>	 	11/09/26	rtm		added USE_OUTPUT_CACHE; if a cache directory is named in the environment,
+//									QTCmpr_CompressImage and QTCmpr_CompressSequence keep their output there, and hand
+//									it back when the same source is compressed with the same settings (see QTCmprOutputCache.c)
+//	   <18>	 	11/08/26	rtm		added USE_QUALITY_METRICS; if a metrics file is named in the environment,
+//									QTCmpr_CompressSequence decodes each compressed frame and writes its PSNR and SSIM
+//									(see QTCmprQuality.c)
+//	   <17>	 	11/05/26	rtm		added USE_MOTION_ESTIMATION; when compressing temporally, QTCmpr_CompressSequence
+//									estimates the motion between frames (see QTCmprMotion.c) and tells the compressor
+//									to make a key frame wherever a new scene starts
+//	   <16>	 	11/04/26	rtm		added USE_DIRTY_FRAMES; QTCmpr_CompressSequence compares each frame with the last one
+//									(see QTCmprDirty.c), extends the last sample instead of compressing a frame that
+//									hasn't changed, and converts only the rows that changed to Y'CbCr
+//	   <15>	 	11/03/26	rtm		added USE_CROP; if a crop rectangle is given in the environment, QTCmpr_CompressSequence
+//									and QTCmpr_CompressImage render and compress only that part of each frame
+//	   <14>	 	11/02/26	rtm		added USE_RESIZE; if an output size is given in the environment, QTCmpr_CompressSequence
+//									and QTCmpr_CompressImage resample each frame to that size (see QTCmprResize.c)
+//									and compress the result
+//	   <13>	 	11/01/26	rtm		added USE_YUV_CONVERSION; if the compressor accepts Y'CbCr frames, QTCmpr_CompressSequence
+//									converts each frame to Y'CbCr itself (see QTCmprColor.c)
+//	   <12>	 	10/31/26	rtm		added USE_SOURCE_SETTINGS; the compression dialog now starts with the codec, depth,
+//									quality, and key frame rate of the source track, and if the user keeps them, we
+//									copy the source samples instead of recompressing them
+//	   <11>	 	10/30/26	rtm		added USE_SOURCE_DEPTH; QTCmpr_CompressSequence now renders frames at the narrowest
+//									depth that holds the source images without loss, instead of always at 32 bits
+//	   <10>	 	10/29/26	rtm		added worker mode; QTCmpr_CompressSequence can run the compression sequence in a
+//									worker process (see QTCmprWorker.c), so that a crashing codec can't take us down
+//	   <9>	 	10/28/26	rtm		added USE_CHECKPOINTS; QTCmpr_CompressSequence now keeps a checkpoint file as it goes
+//									(see QTCmprCheckpoint.c), and can resume an unfinished compression
+//	   <8>	 	10/27/26	rtm		added USE_RAW_INGEST and QTCmpr_CompressIngest, which compresses raw frames read from
+//									a pipe (see QTCmprIngest.c); moved the output code into QTCmpr_BeginSequenceOutput
+//									and friends, so that both kinds of sequence share it
+//	   <7>	 	10/26/26	rtm		added USE_FRAGMENTED_OUTPUT; if a stream is named in the environment, we write
+//									a fragmented movie to it (see QTCmprFragment.c) instead of creating a movie file
+//	   <6>	 	10/25/26	rtm		added USE_SAMPLE_WRITER; compressed frames are now written a chunk at a time
+//									(see QTCmprWriter.c), which keeps the new movie's sample tables compact
+//	   <5>	 	10/24/26	rtm		QTCmpr_CompressSequence waits for the source movie to finish loading
+//	   <4>	 	10/22/26	rtm		compression jobs now reserve their frame buffers and compressed data buffers
+//									against the memory budget in QTCmprBudget.c, and report their usage when done
+//	   <3>	 	10/21/26	rtm		added USE_FRAME_CACHE; we now keep rendered frames and poster images in a cache,
+//									so that compressing the same movie again doesn't decompress every frame again
 //	   <2>	 	11/11/00	rtm		added ability to compress an image sequence (based largely on
 //									code from ConvertToMovieJr.c)
 //	   <1>	 	11/01/00	rtm		first file from QTStdCompr.c (in QTGoodies)
@@ -82,16 +147,44 @@ extern void QTFrame_HandleEvent (EventRecord *theEvent);	// our Mac application'
 void QTCmpr_CompressImage (WindowObject theWindowObject)
 {
 	Rect						myRect;
+	Rect						myOutRect;					// the size we compress the image at: myRect, unless we're resizing it
+#if USE_CROP
+	Rect						myCropRect;					// the part of the image we compress
+#endif
 	GraphicsImportComponent		myImporter = NULL;
 	ComponentInstance			myComponent = NULL;
 	GWorldPtr					myImageWorld = NULL;		// the graphics world we draw the image in
 	PixMapHandle				myPixMap = NULL;
+	PixMapHandle				myCompressPixMap = NULL;	// the pixel map we compress: myPixMap, or its resized version
+#if USE_RESIZE
+	GWorldPtr					myOutWorld = NULL;			// the graphics world we resize the image into
+	long						myOutWorldSize = 0L;
+	Resizer						myResizer;
+	Boolean						myResizerIsOpen = false;
+	Boolean						myResizing = false;
+	long						myFilter;
+#endif
+#if USE_OUTPUT_CACHE
+	OutputCacheParams			myCacheParams;				// what, besides the image file and the settings, determines the output
+	OutputCacheKey				myCacheKey;
+	Boolean						myCacheKeyIsValid = false;
+	Boolean						myIsCached = false;			// did the compressed image come from the output cache?
+#endif
+#if USE_DETERMINISTIC_MODE
+	GoldenDigest				myGolden;					// the digest of the compressed image, in deterministic mode
+	char						*myName = NULL;
+#endif
 	ImageDescriptionHandle		myDesc = NULL;
 	Handle						myHandle = NULL;
+	MemoryJob					myJob;
+	long						myWorldSize = 0L;			// the number of bytes reserved for the graphics world
+	long						myReservedDataSize = 0L;	// the number of bytes reserved for the compressed data
 	OSErr						myErr = noErr;
 
 	if (theWindowObject == NULL)
 		return;
+
+	QTCmpr_BeginMemoryJob(&myJob, "QTCmpr_CompressImage", NULL, 0L);
 		
 	//////////
 	//
@@ -110,12 +203,53 @@ void QTCmpr_CompressImage (WindowObject theWindowObject)
 	if (myErr != noErr)
 		goto bail;
 
+#if USE_CROP
+	// if only part of the image is to be compressed, have the importer draw just that part; an importer
+	// that can decode part of an image then does only that much work
+	if (QTCmpr_GetCropRect(&myRect, &myCropRect)) {
+		GraphicsImportSetSourceRect(myImporter, &myCropRect);
+		MacSetRect(&myRect, 0, 0, myCropRect.right - myCropRect.left, myCropRect.bottom - myCropRect.top);
+		GraphicsImportSetBoundsRect(myImporter, &myRect);
+	}
+#endif
+
+	myOutRect = myRect;
+#if USE_RESIZE
+	myResizing = QTCmpr_GetOutputSize(&myRect, &myOutRect, &myFilter);
+#endif
+
+#if USE_OUTPUT_CACHE
+	myCacheParams.fKind = kOutputCacheImage;
+#if USE_CROP
+	myCacheParams.fSrcRect = myCropRect;
+#else
+	myCacheParams.fSrcRect = myRect;
+#endif
+	myCacheParams.fDstRect = myOutRect;
+	myCacheParams.fFilter = 0L;
+#if USE_RESIZE
+	if (myResizing)
+		myCacheParams.fFilter = myFilter;
+#endif
+#endif
+
 	//////////
 	//
 	// create an offscreen graphics world and draw the image into it
 	//
 	//////////
 	
+	// reserve memory for the offscreen graphics world; QTNewGWorld picks the pixel format, so
+	// we assume the worst (32 bits per pixel)
+	myWorldSize = QTCmpr_GetGWorldSize(&myRect, 32);
+	QTCmpr_ReserveMemory(&myJob, myWorldSize);
+
+#if USE_RESIZE
+	// the resizer works on 32-bit pixels
+	if (myResizing)
+		myErr = QTNewGWorld(&myImageWorld, k32ARGBPixelFormat, &myRect, NULL, NULL, kICMTempThenAppMemory);
+	else
+#endif
 	myErr = QTNewGWorld(&myImageWorld, 0, &myRect, NULL, NULL, kICMTempThenAppMemory);
 	if (myErr != noErr)
 		goto bail;
@@ -128,6 +262,32 @@ void QTCmpr_CompressImage (WindowObject theWindowObject)
 	// set the current port and draw the image
 	GraphicsImportSetGWorld(myImporter, (CGrafPtr)myImageWorld, NULL);
 	GraphicsImportDraw(myImporter);
+
+	myCompressPixMap = myPixMap;
+
+#if USE_RESIZE
+	// if the image is to be compressed at another size, resample it into a graphics world of that size;
+	// that's what the user sees in the dialog box, and what we compress
+	if (myResizing) {
+		myOutWorldSize = QTCmpr_GetGWorldSize(&myOutRect, 32);
+		QTCmpr_ReserveMemory(&myJob, myOutWorldSize);
+
+		myErr = QTNewGWorld(&myOutWorld, k32ARGBPixelFormat, &myOutRect, NULL, NULL, kICMTempThenAppMemory);
+		if (myErr != noErr)
+			goto bail;
+
+		myCompressPixMap = GetGWorldPixMap(myOutWorld);
+		if (!LockPixels(myCompressPixMap))
+			goto bail;
+
+		myResizerIsOpen = true;
+		myErr = QTCmpr_NewResizer(&myResizer, myPixMap, myCompressPixMap, myFilter, &myJob);
+		if (myErr != noErr)
+			goto bail;
+
+		QTCmpr_ResizeFrame(&myResizer);
+	}
+#endif
 	
 	//////////
 	//
@@ -144,14 +304,14 @@ void QTCmpr_CompressImage (WindowObject theWindowObject)
 	// means use the entire image; passing 0 for the flags means to use the default
 	// system method of displaying the test image, which is currently a combination
 	// of cropping and scaling; personally, I prefer scaling (your mileage may vary)
-	SCSetTestImagePixMap(myComponent, myPixMap, NULL, scPreferScaling);
+	SCSetTestImagePixMap(myComponent, myCompressPixMap, NULL, scPreferScaling);
 
 	// install the custom procs, if requested
 	// we can install two kinds of custom procedures for use in connection with
 	// the standard dialog box: (1) a modal-dialog filter function, and (2) a hook
 	// function to handle the custom button in the dialog box
 	if (gUseExtendedProcs)
-		QTCmpr_InstallExtendedProcs(myComponent, (long)myPixMap);
+		QTCmpr_InstallExtendedProcs(myComponent, (long)myCompressPixMap);
 	
 	// request image compression settings from the user; in other words, put up the dialog box
 	myErr = SCRequestImageSettings(myComponent);
@@ -164,9 +324,47 @@ void QTCmpr_CompressImage (WindowObject theWindowObject)
 	//
 	//////////
 	
-	myErr = SCCompressImage(myComponent, myPixMap, NULL, &myDesc, &myHandle);
+	// reserve memory for the compressed data
+	myReservedDataSize = QTCmpr_GetMaxCompressedSize(myComponent, myCompressPixMap, &myOutRect);
+	QTCmpr_ReserveMemory(&myJob, myReservedDataSize);
+
+#if USE_OUTPUT_CACHE
+	// if this image file was compressed with these settings before, the cached image will do
+	myCacheKeyIsValid = QTCmpr_GetOutputCacheKey(&myCacheKey, &myCacheParams, &(**theWindowObject).fFileFSSpec, NULL, myComponent);
+	if (myCacheKeyIsValid)
+		myIsCached = (QTCmpr_LoadCachedImage(&myCacheKey, &myHandle, &myDesc) == noErr);
+
+	if (!myIsCached) {
+#endif
+	myErr = SCCompressImage(myComponent, myCompressPixMap, NULL, &myDesc, &myHandle);
 	if (myErr != noErr)
 		goto bail;
+#if USE_OUTPUT_CACHE
+	if (myCacheKeyIsValid)
+		QTCmpr_CacheImage(&myCacheKey, myHandle, myDesc);
+	}
+#endif
+
+#if USE_DETERMINISTIC_MODE
+	// check the compressed image against its golden digest
+	if (QTCmpr_GetDeterministicMode()) {
+		Rect			mySrcRect = myRect;
+		long			myGoldenFilter = 0L;
+
+#if USE_CROP
+		mySrcRect = myCropRect;
+#endif
+#if USE_RESIZE
+		if (myResizing)
+			myGoldenFilter = myFilter;
+#endif
+		myName = QTUtils_ConvertPascalToCString((**theWindowObject).fFileFSSpec.name);
+		QTCmpr_BeginGoldenDigest(&myGolden, kGoldenKindImage, myName, myComponent, &mySrcRect, &myOutRect, myGoldenFilter);
+		QTCmpr_AddGoldenSample(&myGolden, *myHandle, (**myDesc).dataSize, 0L, myDesc, 0);
+		QTCmpr_EndGoldenDigest(&myGolden);
+		free(myName);
+	}
+#endif
 
 	//////////
 	//
@@ -195,9 +393,22 @@ bail:
 
 	if (myHandle != NULL)
 		DisposeHandle(myHandle);
+	QTCmpr_ReleaseMemory(&myJob, myReservedDataSize);
+
+#if USE_RESIZE
+	if (myResizerIsOpen)
+		QTCmpr_DisposeResizer(&myResizer);
+
+	if (myOutWorld != NULL)
+		DisposeGWorld(myOutWorld);
+	QTCmpr_ReleaseMemory(&myJob, myOutWorldSize);
+#endif
 
 	if (myImageWorld != NULL)
 		DisposeGWorld(myImageWorld);
+	QTCmpr_ReleaseMemory(&myJob, myWorldSize);
+
+	QTCmpr_EndMemoryJob(&myJob);
 }
 
 
@@ -280,30 +491,84 @@ void QTCmpr_CompressSequence (WindowObject theWindowObject)
 	PixMapHandle				myPixMap = NULL;
 	Movie						mySrcMovie = NULL;
 	Track						mySrcTrack = NULL;
-	Movie						myDstMovie = NULL;
-	Track						myDstTrack = NULL;
-	Media						myDstMedia = NULL;
 	Rect						myRect;
+	Rect						myOutRect;					// the size we compress frames at: myRect, unless we're resizing them
+	Boolean						myResizing = false;
+	Rect						myMovieBox;					// the movie box we draw frames with
+	Boolean						myCropping = false;
+#if USE_CROP
+	Rect						myOrigMovieBox;				// the movie box, before we moved it to crop frames
+	Rect						myCropRect;
+#endif
 	PicHandle					myPicture = NULL;
 	CGrafPtr					mySavedPort = NULL;
 	GDHandle					mySavedDevice = NULL;
 	SCTemporalSettings			myTimeSettings;
 	SCDataRateSettings			myRateSettings;
-	FSSpec						myFile;
-	Boolean						myIsSelected = false;
-	Boolean						myIsReplacing = false;	
-	short						myRefNum = -1;
-	StringPtr 					myMoviePrompt = QTUtils_ConvertCToPascalString(kQTCSaveMoviePrompt);
-	StringPtr 					myMovieFileName = QTUtils_ConvertCToPascalString(kQTCSaveMovieFileName);
-	MatrixRecord				myMatrix;
 	ImageDescriptionHandle		myImageDesc = NULL;
 	TimeValue					myCurMovieTime = 0L;
 	TimeValue					myOrigMovieTime = 0L;		// current movie time, when compression is begun
-	short						myFrameNum;		
+	long						myFrameNum;
+	long						myFirstFrame = 0L;			// the first frame to compress; not 0 if we're resuming
 	long						myFlags = 0L;
 	long						myNumFrames = 0L;
 	long						mySrcMovieDuration = 0L;	// duration of source movie
+	MemoryJob					myJob;
+	long						myWorldSize = 0L;			// the number of bytes reserved for the graphics world
+	long						myReservedDataSize = 0L;	// the number of bytes reserved for the compressed data
+	OSType						myPixelFormat = k32ARGBPixelFormat;	// the pixel format of the graphics world
+#if USE_SOURCE_SETTINGS
+	SourceSettings				mySourceSettings;			// the settings we inferred from the source track
+#endif
+	PixMapHandle				myCompressPixMap = NULL;	// the pixel map we compress: myPixMap, or its resized or Y'CbCr version
+#if USE_RESIZE
+	GWorldPtr					myOutWorld = NULL;			// the graphics world we resize frames into
+	long						myOutWorldSize = 0L;
+	Resizer						myResizer;
+	Boolean						myResizerIsOpen = false;
+	long						myFilter;
+#endif
+#if USE_YUV_CONVERSION
+	SCSpatialSettings			mySpatialSettings;
+	ColorConverter				myConverter;				// converts frames to Y'CbCr, if the compressor accepts that
+	Boolean						myConverterIsOpen = false;
+	OSType						myYUVFormat;
+#endif
+#if USE_DIRTY_FRAMES
+	DirtyDetector				myDetector;					// finds the part of each frame that changed
+	Boolean						myDetectorIsOpen = false;
+#endif
+#if USE_MOTION_ESTIMATION
+	MotionEstimator				myEstimator;				// finds cuts to new scenes
+	Boolean						myEstimatorIsOpen = false;
+	long						myForceKey = 1L;
+#endif
+#if USE_QUALITY_METRICS
+	QualityMeter				myMeter;					// measures the quality of each compressed frame
+	Boolean						myMeterIsOpen = false;
+	char						*myMetricsPath = NULL;
+#endif
+	Rect						myDirtyRect;				// the part of the current frame that changed
+#if USE_OUTPUT_CACHE
+	OutputCacheParams			myCacheParams;				// what, besides the movie and the settings, determines the output
+	OutputCacheKey				myCacheKey;
+#endif
+	OutputCacheKeyPtr			myCacheKeyPtr = NULL;		// the key of the movie file in the output cache, if it can be cached
+	char						*myStreamPath = NULL;		// the stream to write a fragmented movie to, if any
+	long						myFramesPerFragment = 0L;
+	SequenceOutput				myOutput;					// the new movie file or stream
+	Boolean						myOutputIsOpen = false;
+#if USE_DETERMINISTIC_MODE
+	GoldenDigest				myGolden;					// the digest of the compressed frames, in deterministic mode
+	char						*myName = NULL;
+#endif
 	OSErr						myErr = noErr;
+#if USE_CODEC_WORKERS
+	WorkerSession				myWorker;					// the worker process that compresses the frames, in worker mode
+	Boolean						myWorkerIsOpen = false;
+	Boolean						myUseWorker = false;		// are frames still going to the worker?
+	long						myFallbackSize = 0L;		// the bytes reserved for compressing in-process, once the workers fail
+#endif
 #if USE_ASYNC_COMPRESSION
 	ICMCompletionProcRecord		myICMComplProcRec;
 	ICMCompletionProcRecordPtr	myICMComplProcPtr = NULL;
@@ -313,6 +578,13 @@ void QTCmpr_CompressSequence (WindowObject theWindowObject)
 	myICMComplProcRec.completionRefCon = 0L;
 #endif
 
+	// while compressing asynchronously, we can let the compressor run while we wait for memory
+#if USE_ASYNC_COMPRESSION
+	QTCmpr_BeginMemoryJob(&myJob, "QTCmpr_CompressSequence", QTCmpr_MemoryIdleProc, (long)&myComponent);
+#else
+	QTCmpr_BeginMemoryJob(&myJob, "QTCmpr_CompressSequence", NULL, 0L);
+#endif
+
 	if (theWindowObject == NULL)
 		goto bail;
 
@@ -326,6 +598,12 @@ void QTCmpr_CompressSequence (WindowObject theWindowObject)
 	if (mySrcMovie == NULL)
 		goto bail;
 
+	// the movie may have been opened asynchronously; until it's completely loaded, its tracks (and their
+	// frame counts) may not all be there yet
+	myErr = QTUtils_WaitForMovieLoadState(mySrcMovie, kMovieLoadStateComplete);
+	if (myErr != noErr)
+		goto bail;
+
 	mySrcTrack = GetMovieIndTrackType(mySrcMovie, 1, VideoMediaType, movieTrackMediaType);
 	if (mySrcTrack == NULL)
 		goto bail;
@@ -347,16 +625,17 @@ void QTCmpr_CompressSequence (WindowObject theWindowObject)
 	if (myComponent == NULL)
 		goto bail;
 
-	// turn off "best depth" option in the compression dialog, because all of our
-	// buffering is done at 32-bits (regardless of the depth of the source data)
+	// if we buffer frames at the depth of the source data (see QTCmpr_GetSourcePixelFormat), the
+	// "best depth" option in the compression dialog means just what it says; otherwise turn it off,
+	// because all of our buffering is done at 32-bits (regardless of the depth of the source data)
 	//
-	// a more ambitious approach would be to loop through each of the video sample
-	// descriptions in each of the video tracks looking for the deepest depth, and
-	// using that for the best depth; better yet, we could find out which compressors
-	// were used and set one of those as the default in the compression dialog
+	// a more ambitious approach would be to find out which compressors were used in the
+	// source movie and set one of those as the default in the compression dialog
+#if !USE_SOURCE_DEPTH
 	SCGetInfo(myComponent, scPreferenceFlagsType, &myFlags);
 	myFlags &= ~scShowBestDepth;
 	SCSetInfo(myComponent, scPreferenceFlagsType, &myFlags);
+#endif
 
 	// because we are recompressing a movie that may have a variable frame rate,
 	// we want to allow the user to leave the frame rate text field blank (in which
@@ -365,25 +644,73 @@ void QTCmpr_CompressSequence (WindowObject theWindowObject)
 	// clear this flag, the compression dialog will not allow zero in the frame rate field
 	//
 	// NOTE: we could have set this flag above when we cleared the scShowBestDepth flag;
-	// it is done here for clarity.	
+	// it is done here for clarity (and because we don't always clear that flag).	
 	SCGetInfo(myComponent, scPreferenceFlagsType, &myFlags);
 	myFlags |= scAllowZeroFrameRate;
 	SCSetInfo(myComponent, scPreferenceFlagsType, &myFlags);
 
+
 	// get the number of video frames in the movie
 	myNumFrames = QTUtils_GetFrameCount(mySrcTrack);
 
-	// get the bounding rectangle of the movie, create a 32-bit GWorld with those
-	// dimensions, and draw the movie poster picture into it; this GWorld will be
-	// used for the test image in the compression dialog box and for rendering movie
-	// frames
-	myPicture = GetMoviePosterPict(mySrcMovie);
-	if (myPicture == NULL)
-		goto bail;
-		
+	// get the bounding rectangle of the movie, create a GWorld with those dimensions
+	// and the depth of the source images (or 32 bits), and draw the movie poster picture
+	// into it; this GWorld will be used for the test image in the compression dialog box
+	// and for rendering movie frames
 	GetMovieBox(mySrcMovie, &myRect);
 
-	myErr = NewGWorld(&myImageWorld, 32, &myRect, NULL, NULL, 0L);
+#if USE_CROP
+	// if only part of each frame is to be compressed, we move the movie box so that that part lands at the top
+	// left of a GWorld just big enough to hold it; QuickTime then draws only that part, and decompressors that
+	// can decode part of a frame decode only that part
+	myCropping = QTCmpr_GetCropRect(&myRect, &myCropRect);
+	if (myCropping) {
+		myOrigMovieBox = myRect;
+		MacOffsetRect(&myRect, -myCropRect.left, -myCropRect.top);
+		SetMovieBox(mySrcMovie, &myRect);
+		MacSetRect(&myRect, 0, 0, myCropRect.right - myCropRect.left, myCropRect.bottom - myCropRect.top);
+	}
+#endif
+
+	GetMovieBox(mySrcMovie, &myMovieBox);
+	myOutRect = myRect;
+
+#if USE_SOURCE_DEPTH
+	myPixelFormat = QTCmpr_GetSourcePixelFormat(mySrcMovie);
+#endif
+#if USE_RESIZE
+	// if frames are to be compressed at another size, we render them at 32 bits, which is what the resizer works on
+	myResizing = QTCmpr_GetOutputSize(&myRect, &myOutRect, &myFilter);
+	if (myResizing)
+		myPixelFormat = k32ARGBPixelFormat;
+#endif
+	myWorldSize = QTCmpr_GetGWorldSize(&myRect, QTCmpr_GetPixelFormatDepth(myPixelFormat));
+	QTCmpr_ReserveMemory(&myJob, myWorldSize);
+
+#if USE_OUTPUT_CACHE
+	myCacheParams.fKind = kOutputCacheMovie;
+#if USE_CROP
+	myCacheParams.fSrcRect = myCropRect;
+#else
+	myCacheParams.fSrcRect = myRect;
+#endif
+	myCacheParams.fDstRect = myOutRect;
+	myCacheParams.fFilter = 0L;
+#if USE_RESIZE
+	if (myResizing)
+		myCacheParams.fFilter = myFilter;
+#endif
+#endif
+
+#if USE_CODEC_WORKERS
+	// in worker mode, the GWorld's pixels are in memory we share with the worker process (unless we're
+	// resizing frames, in which case it's the resized frames that we share)
+	if (QTCmpr_GetWorkerMode() && !myResizing) {
+		myErr = QTCmpr_NewWorkerGWorld(&myWorker, &myRect, myPixelFormat, &myImageWorld, &myJob);
+		myWorkerIsOpen = true;
+	} else
+#endif
+	myErr = QTNewGWorld(&myImageWorld, myPixelFormat, &myRect, NULL, NULL, 0L);
 	if (myErr != noErr)
 		goto bail;
 		
@@ -392,13 +719,26 @@ void QTCmpr_CompressSequence (WindowObject theWindowObject)
 	if (!LockPixels(myPixMap))
 		goto bail;
 
-	// draw the movie poster image into the GWorld
+	myCompressPixMap = myPixMap;
+
+	// draw the movie poster image into the GWorld, unless we drew it the last time through
 	GetGWorld(&mySavedPort, &mySavedDevice);
-	SetGWorld(myImageWorld, NULL);
-	EraseRect(&myRect);
-	DrawPicture(myPicture, &myRect);
-	KillPicture(myPicture);
-	SetGWorld(mySavedPort, mySavedDevice);
+#if USE_FRAME_CACHE
+	if (!QTCmpr_GetCachedFrame(mySrcMovie, kFrameCachePosterTime, myPixMap)) {
+#endif
+		myPicture = GetMoviePosterPict(mySrcMovie);
+		if (myPicture == NULL)
+			goto bail;
+
+		SetGWorld(myImageWorld, NULL);
+		EraseRect(&myRect);
+		DrawPicture(myPicture, &myMovieBox);
+		KillPicture(myPicture);
+		SetGWorld(mySavedPort, mySavedDevice);
+#if USE_FRAME_CACHE
+		QTCmpr_CacheFrame(mySrcMovie, kFrameCachePosterTime, myPixMap, true);
+	}
+#endif
 
 	// set the picture to be displayed in the dialog box; passing NULL for the rect
 	// means use the entire image; passing 0 for the flags means to use the default
@@ -415,6 +755,11 @@ void QTCmpr_CompressSequence (WindowObject theWindowObject)
 	
 	// set up some default settings for the compression dialog
 	SCDefaultPixMapSettings(myComponent, myPixMap, true);
+
+#if USE_SOURCE_SETTINGS
+	// better yet, start with the settings that the source track was compressed with
+	QTCmpr_SetSourceSettings(myComponent, mySrcTrack, &mySourceSettings);
+#endif
 	
 	// clear out the default frame rate chosen by Standard Compression (a frame rate
 	// of 0 means to use the rate of the source movie)
@@ -434,6 +779,24 @@ void QTCmpr_CompressSequence (WindowObject theWindowObject)
 	// of our calculations (in a simpler application, we'd never have to look at them)	
 	SCGetInfo(myComponent, scTemporalSettingsType, &myTimeSettings);
 
+#if USE_FRAGMENTED_OUTPUT
+	// if we're streaming, make sure there's a key frame in every fragment, so that a reader can begin with any fragment
+	myStreamPath = QTCmpr_GetStreamOutput(&myFramesPerFragment);
+	if ((myStreamPath != NULL) && ((myTimeSettings.keyFrameRate <= 0) || (myTimeSettings.keyFrameRate > myFramesPerFragment))) {
+		myTimeSettings.keyFrameRate = myFramesPerFragment;
+		SCSetInfo(myComponent, scTemporalSettingsType, &myTimeSettings);
+	}
+#endif
+
+#if USE_SOURCE_SETTINGS
+	// if the user kept the settings and size of the source track, recompressing would just make the frames worse;
+	// copy the compressed frames as they are
+	if (!myResizing && !myCropping && QTCmpr_SettingsMatchSource(myComponent, &mySourceSettings)) {
+		myErr = QTCmpr_CopySourceSamples(&mySourceSettings, &(**theWindowObject).fFileFSSpec, myStreamPath, myFramesPerFragment, mySrcMovie, &myRect, &myJob);
+		goto bail;
+	}
+#endif
+
 	//////////
 	//
 	// adjust the data rate [to be supplied][relevant only for movies that have sound tracks]
@@ -441,6 +804,60 @@ void QTCmpr_CompressSequence (WindowObject theWindowObject)
 	//////////
 
 	
+	//////////
+	//
+	// create the new movie file, or begin the stream
+	//
+	//////////
+
+#if USE_OUTPUT_CACHE
+	// a movie file can come from (and go into) the output cache, unless the movie has been edited since it was
+	// opened; a stream can't
+	if ((myStreamPath == NULL) && !(**theWindowObject).fIsDirty)
+		if (QTCmpr_GetOutputCacheKey(&myCacheKey, &myCacheParams, &(**theWindowObject).fFileFSSpec, mySrcMovie, myComponent))
+			myCacheKeyPtr = &myCacheKey;
+#endif
+
+	// the destination media has the same time scale as the source movie; because the time scales
+	// are the same, we don't have to do any time scale conversions
+	myErr = QTCmpr_BeginSequenceOutput(&myOutput, myStreamPath, myFramesPerFragment, &(**theWindowObject).fFileFSSpec, mySrcMovie, &myOutRect, GetMovieTimeScale(mySrcMovie), myComponent, myCacheKeyPtr, &myJob);
+	myOutputIsOpen = true;
+	if (myErr != noErr)
+		goto bail;
+
+#if USE_OUTPUT_CACHE
+	// if the movie file was copied from the output cache, there's nothing to compress
+	if (myOutput.fIsCached) {
+		myErr = QTCmpr_EndSequenceOutput(&myOutput, true);
+		myOutputIsOpen = false;
+		goto bail;
+	}
+#endif
+
+#if USE_DETERMINISTIC_MODE
+	// add each compressed frame to a digest, to check against its golden digest at the end
+	if (QTCmpr_GetDeterministicMode()) {
+		Rect			mySrcRect = myRect;
+		long			myGoldenFilter = 0L;
+
+#if USE_CROP
+		mySrcRect = myCropRect;
+#endif
+#if USE_RESIZE
+		if (myResizing)
+			myGoldenFilter = myFilter;
+#endif
+		myName = QTUtils_ConvertPascalToCString((**theWindowObject).fFileFSSpec.name);
+		QTCmpr_BeginGoldenDigest(&myGolden, kGoldenKindMovie, myName, myComponent, &mySrcRect, &myOutRect, myGoldenFilter);
+		free(myName);
+		myOutput.fGolden = &myGolden;
+	}
+#endif
+
+	// if we're resuming an earlier compression, the output has restored its settings and knows where it left off
+	SCGetInfo(myComponent, scTemporalSettingsType, &myTimeSettings);
+	myFirstFrame = myOutput.fResumeFrame;
+
 	//////////
 	//
 	// adjust the sample count
@@ -460,83 +877,139 @@ void QTCmpr_CompressSequence (WindowObject theWindowObject)
 			myNumFrames = 1;
 	}
 
+	// set the movie to highest quality imaging
+	SetMoviePlayHints(mySrcMovie, hintsHighQuality, hintsHighQuality);
+
 	//////////
 	//
-	// get the name and location of the new movie file
+	// compress the image sequence
+	//
+	// we are going to step through the source movie, compress each frame, and then add
+	// the compressed frame to the destination movie
 	//
 	//////////
 
-	// prompt the user for a file to put the compressed image into; in theory, the name
-	// should have a file extension appropriate to the type of compressed data selected by the user;
-	// this is left as an exercise for the reader
-	QTFrame_PutFile(myMoviePrompt, myMovieFileName, &myFile, &myIsSelected, &myIsReplacing);
-	if (!myIsSelected)
-		goto bail;
+#if USE_RESIZE
+	// if we're resizing frames, we compress the resized frames, which are in a graphics world of the output size
+	if (myResizing) {
+		myOutWorldSize = QTCmpr_GetGWorldSize(&myOutRect, QTCmpr_GetPixelFormatDepth(myPixelFormat));
+		QTCmpr_ReserveMemory(&myJob, myOutWorldSize);
+
+#if USE_CODEC_WORKERS
+		if (QTCmpr_GetWorkerMode()) {
+			myErr = QTCmpr_NewWorkerGWorld(&myWorker, &myOutRect, myPixelFormat, &myOutWorld, &myJob);
+			myWorkerIsOpen = true;
+		} else
+#endif
+		myErr = QTNewGWorld(&myOutWorld, myPixelFormat, &myOutRect, NULL, NULL, 0L);
+		if (myErr != noErr)
+			goto bail;
 
-	// delete any existing file of that name
-	if (myIsReplacing) {
-		myErr = DeleteMovieFile(&myFile);
+		myCompressPixMap = GetGWorldPixMap(myOutWorld);
+		if (!LockPixels(myCompressPixMap))
+			goto bail;
+
+		myResizerIsOpen = true;
+		myErr = QTCmpr_NewResizer(&myResizer, myPixMap, myCompressPixMap, myFilter, &myJob);
 		if (myErr != noErr)
 			goto bail;
 	}
-		
-	//////////
-	//
-	// create the target movie
-	//
-	//////////
-	
-	myErr = CreateMovieFile(&myFile, sigMoviePlayer, smSystemScript, 
-								createMovieFileDeleteCurFile | createMovieFileDontCreateResFile, &myRefNum, &myDstMovie);
-	if (myErr != noErr)
-		goto bail;
-	
-	// create a new video movie track with the same dimensions as the entire source movie
-	myDstTrack = NewMovieTrack(myDstMovie,
-								(long)(myRect.right - myRect.left) << 16,
-								(long)(myRect.bottom - myRect.top) << 16, kNoVolume);
-	if (myDstTrack == NULL)
-		goto bail;
-	
-	// create a media for the new track with the same time scale as the source movie;
-	// because the time scales are the same, we don't have to do any time scale conversions.
-	myDstMedia = NewTrackMedia(myDstTrack, VIDEO_TYPE, GetMovieTimeScale(mySrcMovie), 0, 0);
-	if (myDstMedia == NULL)
-		goto bail;
-	
-	// copy the user data and settings from the source to the dest movie
-	CopyMovieSettings(mySrcMovie, myDstMovie);
-	
-	// set movie matrix to identity and clear the movie clip region (because the conversion
-	// process transforms and composites all video tracks into one untransformed video track)
-	SetIdentityMatrix(&myMatrix);
-	SetMovieMatrix(myDstMovie, &myMatrix);
-	SetMovieClipRgn(myDstMovie, NULL);
-	
-	// set the movie to highest quality imaging
-	SetMoviePlayHints(mySrcMovie, hintsHighQuality, hintsHighQuality);
+#endif
+
+#if USE_DIRTY_FRAMES
+	// compare each frame with the last one, so that we needn't compress frames that haven't changed
+	myDetectorIsOpen = true;
+	if (QTCmpr_NewDirtyDetector(&myDetector, myCompressPixMap, &myJob) != noErr) {
+		QTCmpr_DisposeDirtyDetector(&myDetector);
+		myDetectorIsOpen = false;
+	}
+#endif
+
+#if USE_MOTION_ESTIMATION
+	// if the compressor makes difference frames, look for cuts to new scenes, which should be key frames; a
+	// worker's compressor is out of our reach
+	if (myTimeSettings.keyFrameRate != 1) {
+#if USE_CODEC_WORKERS
+		if (!myWorkerIsOpen) {
+#endif
+		myEstimatorIsOpen = true;
+		if (QTCmpr_NewMotionEstimator(&myEstimator, myCompressPixMap, &myJob) != noErr) {
+			QTCmpr_DisposeMotionEstimator(&myEstimator);
+			myEstimatorIsOpen = false;
+		}
+#if USE_CODEC_WORKERS
+		}
+#endif
+	}
+#endif
+
+#if USE_QUALITY_METRICS
+	// if asked, compare each compressed frame with the frame it was compressed from; we do this before
+	// the frames are converted to Y'CbCr
+	myMetricsPath = QTCmpr_GetMetricsOutput();
+	if (myMetricsPath != NULL) {
+		myMeterIsOpen = true;
+		if (QTCmpr_NewQualityMeter(&myMeter, myCompressPixMap, myMetricsPath, &myJob) != noErr) {
+			QTCmpr_LogMessage("QTCmpr_CompressSequence: can't measure quality into %s", myMetricsPath);
+			QTCmpr_DisposeQualityMeter(&myMeter);
+			myMeterIsOpen = false;
+		}
+	}
+#endif
+
+	myReservedDataSize = QTCmpr_GetMaxCompressedSize(myComponent, myCompressPixMap, &myOutRect);
+
+#if USE_CODEC_WORKERS
+	// in worker mode, the worker begins the compression sequence; the worker session reserves the
+	// shared memory that the worker puts compressed frames in
+	if (myWorkerIsOpen) {
+		myErr = QTCmpr_StartWorker(&myWorker, myComponent, myReservedDataSize, GetMovieTimeScale(mySrcMovie), &myImageDesc);
+		myReservedDataSize = 0L;
+		if (myErr != noErr)
+			goto bail;
+
+		myUseWorker = true;
+	} else {
+#endif
+#if USE_YUV_CONVERSION
+	// if the compressor accepts Y'CbCr frames, we convert each rendered frame to Y'CbCr ourselves and
+	// compress that; otherwise the compressor would do the conversion, more slowly
+	if (SCGetInfo(myComponent, scSpatialSettingsType, &mySpatialSettings) == noErr) {
+		myYUVFormat = QTCmpr_GetCompressorYUVFormat(mySpatialSettings.codecType);
+		if (myYUVFormat != 0L) {
+			myConverterIsOpen = true;
+			if (QTCmpr_NewColorConverter(&myConverter, myCompressPixMap, myYUVFormat, &myJob) == noErr) {
+				myCompressPixMap = myConverter.fPixMap;
+			} else {
+				QTCmpr_DisposeColorConverter(&myConverter);
+				myConverterIsOpen = false;
+			}
+		}
+	}
+#endif
 
 	myImageDesc = (ImageDescriptionHandle)NewHandleClear(sizeof(ImageDescription));
 	if (myImageDesc == NULL)
 		goto bail;
 
-	// prepare for adding frames to the movie
-	myErr = BeginMediaEdits(myDstMedia);
-	if (myErr != noErr)
-		goto bail;
+	// reserve memory for the buffer that SCCompressSequenceBegin allocates to hold compressed frames
+	QTCmpr_ReserveMemory(&myJob, myReservedDataSize);
 
-	//////////
-	//
-	// compress the image sequence
-	//
-	// we are going to step through the source movie, compress each frame, and then add
-	// the compressed frame to the destination movie
-	//
-	//////////
-	
-	myErr = SCCompressSequenceBegin(myComponent, myPixMap, NULL, &myImageDesc);
+	myErr = SCCompressSequenceBegin(myComponent, myCompressPixMap, NULL, &myImageDesc);
 	if (myErr != noErr)
 		goto bail;
+
+#if USE_YUV_CONVERSION
+	// if we convert frames with the BT.709 coefficients, the image description must say so
+	if (myConverterIsOpen) {
+		myErr = QTCmpr_AddColorExtension(&myConverter, myImageDesc);
+		if (myErr != noErr)
+			goto bail;
+	}
+#endif
+#if USE_CODEC_WORKERS
+	}
+#endif
 	
 #if USE_ASYNC_COMPRESSION
 	myFlags = codecFlagUpdatePrevious + codecFlagUpdatePreviousComp + codecFlagLiveGrab;
@@ -548,18 +1021,22 @@ void QTCmpr_CompressSequence (WindowObject theWindowObject)
 	EraseRect(&myRect);
 	SetMovieGWorld(mySrcMovie, myImageWorld, GetGWorldDevice(myImageWorld));
 
-	// set current time value to beginning of the source movie
-	myCurMovieTime = 0;
+	// set current time value to beginning of the source movie (or to the frame we're resuming with)
+	myCurMovieTime = myOutput.fResumeTime;
 
 	// get a value we'll need inside the loop
 	mySrcMovieDuration = GetMovieDuration(mySrcMovie);
 
+	// unless we're comparing frames, every frame is all changed
+	myDirtyRect = myOutRect;
+
 	// loop through all of the interesting times we counted above
-	for (myFrameNum = 0; myFrameNum < myNumFrames; myFrameNum++) {
+	for (myFrameNum = myFirstFrame; myFrameNum < myNumFrames; myFrameNum++) {
 		short			mySyncFlag;
 		TimeValue		myDuration;
 		long			myDataSize;
 		Handle			myCompressedData;
+		Ptr				myFrameData;
 
 		//////////
 		//
@@ -577,7 +1054,7 @@ void QTCmpr_CompressSequence (WindowObject theWindowObject)
 			myFlags = nextTimeMediaSample;
 
 			// if this is the first frame, include the frame we are currently on		
-			if (myFrameNum == 0)
+			if (myFrameNum == myFirstFrame)
 				myFlags |= nextTimeEdgeOK;
 			
 			// if we are maintaining the frame durations of the source movie,
@@ -585,10 +1062,45 @@ void QTCmpr_CompressSequence (WindowObject theWindowObject)
 			GetMovieNextInterestingTime(mySrcMovie, myFlags, 1, &myMediaType, myCurMovieTime, 0, &myCurMovieTime, &myDuration);
 		}
 		
+#if USE_FRAME_CACHE
+		// render the frame, or copy it from the frame cache if we rendered it before
+		QTCmpr_RenderMovieFrame(mySrcMovie, myCurMovieTime, myImageWorld);
+#else
 		SetMovieTimeValue(mySrcMovie, myCurMovieTime);
 		MoviesTask(mySrcMovie, 0);
 		MoviesTask(mySrcMovie, 0);
 		MoviesTask(mySrcMovie, 0);
+#endif
+
+#if USE_RESIZE
+		if (myResizerIsOpen)
+			QTCmpr_ResizeFrame(&myResizer);
+#endif
+
+#if USE_DIRTY_FRAMES
+		// if the frame is the same as the last one, just make the last sample last longer; otherwise, the last
+		// sample is done
+		if (myDetectorIsOpen) {
+			if (!QTCmpr_FindDirtyRect(&myDetector, &myDirtyRect) && QTCmpr_ExtendHeldSample(&myOutput, myDuration))
+				continue;
+
+			myErr = QTCmpr_ReleaseHeldSample(&myOutput);
+			if (myErr != noErr)
+				goto bail;
+		}
+#endif
+
+#if USE_MOTION_ESTIMATION
+		// begin each new scene with a key frame
+		if (myEstimatorIsOpen && QTCmpr_EstimateMotion(&myEstimator))
+			SCSetInfo(myComponent, scForceKeyValueType, &myForceKey);
+#endif
+
+#if USE_YUV_CONVERSION
+		// the rows that didn't change still hold the last frame's Y'CbCr
+		if (myConverterIsOpen)
+			QTCmpr_ConvertRowsToYUV(&myConverter, myDirtyRect.top, myDirtyRect.bottom);
+#endif
 
 		// if data rate constraining is being done, tell Standard Compression the
 		// duration of the current frame in milliseconds; we only need to do this
@@ -610,8 +1122,29 @@ void QTCmpr_CompressSequence (WindowObject theWindowObject)
 		// also mySyncFlag will be a value that that indicates whether or not the frame is a
 		// key frame (and which we pass directly to AddMediaSample); note that we do not need
 		// to dispose of myCompressedData, since SCCompressSequenceEnd will do that for us
+#if USE_CODEC_WORKERS
+		// in worker mode, the compressed data is in shared memory, and the worker may have been restarted with
+		// a new image description; if the workers keep failing, we compress this frame and the rest ourselves,
+		// beginning with a key frame, as a new worker would (the frame is still in the session's shared memory)
+		if (myUseWorker) {
+			myErr = QTCmpr_CompressWorkerFrame(&myWorker, myDuration, &myFrameData, &myDataSize, &mySyncFlag, &myImageDesc);
+			if (myErr != noErr) {
+				QTCmpr_LogMessage("QTCmpr_CompressSequence: the workers failed at frame %ld (error %d); compressing the rest in-process", myFrameNum, myErr);
+				myUseWorker = false;
+
+				myFallbackSize = QTCmpr_GetMaxCompressedSize(myComponent, myCompressPixMap, &myOutRect);
+				QTCmpr_ReserveMemory(&myJob, myFallbackSize);
+
+				myErr = SCCompressSequenceBegin(myComponent, myCompressPixMap, NULL, &myImageDesc);
+				if (myErr != noErr)
+					goto bail;
+			}
+		}
+
+		if (!myUseWorker) {
+#endif
 #if !USE_ASYNC_COMPRESSION
-		myErr = SCCompressSequenceFrame(myComponent, myPixMap, &myRect, &myCompressedData, &myDataSize, &mySyncFlag);
+		myErr = SCCompressSequenceFrame(myComponent, myCompressPixMap, &myOutRect, &myCompressedData, &myDataSize, &mySyncFlag);
 		if (myErr != noErr)
 			goto bail;
 #else
@@ -623,7 +1156,7 @@ void QTCmpr_CompressSequence (WindowObject theWindowObject)
 		
 		myICMComplProcErr = kAsyncDefaultValue;
 		
-		myErr = SCCompressSequenceFrameAsync(myComponent, myPixMap, &myRect, &myCompressedData, &myDataSize, &mySyncFlag, myICMComplProcPtr);
+		myErr = SCCompressSequenceFrameAsync(myComponent, myCompressPixMap, &myOutRect, &myCompressedData, &myDataSize, &mySyncFlag, myICMComplProcPtr);
 		if (myErr != noErr)
 			goto bail;
 
@@ -636,14 +1169,47 @@ void QTCmpr_CompressSequence (WindowObject theWindowObject)
 		}
 		myErr = myICMComplProcErr;
 #endif
+		myFrameData = *myCompressedData;
+#if USE_CODEC_WORKERS
+		}
+#endif
+
+#if USE_QUALITY_METRICS
+		// a frame the meter can't decode ends the measuring, but not the compression
+		if (myMeterIsOpen && (QTCmpr_MeasureQuality(&myMeter, myFrameData, myDataSize, myImageDesc, myFrameNum, mySyncFlag) != noErr)) {
+			QTCmpr_DisposeQualityMeter(&myMeter);
+			myMeterIsOpen = false;
+		}
+#endif
+
+		// while we're comparing frames, hold on to the sample, in case the next frame is the same
+#if USE_DIRTY_FRAMES
+		if (myDetectorIsOpen && myDetector.fIsActive)
+			myErr = QTCmpr_HoldSequenceSample(&myOutput, myFrameData, myDataSize, myDuration, myImageDesc, mySyncFlag);
+		else
+#endif
+		myErr = QTCmpr_AddSequenceSample(&myOutput, myFrameData, myDataSize, myDuration, myImageDesc, mySyncFlag);
+		if (myErr != noErr)
+			goto bail;
 
-		myErr = AddMediaSample(myDstMedia, myCompressedData, 0, myDataSize, myDuration, (SampleDescriptionHandle)myImageDesc, 1, mySyncFlag, NULL);
+		// every few seconds, record how far we've got, so that we can resume from here
+		myErr = QTCmpr_CheckpointSequenceOutput(&myOutput, myComponent, myImageDesc, myFrameNum + 1, myCurMovieTime + myDuration);
 		if (myErr != noErr)
 			goto bail;
 	}
+
+	// write out any frames still buffered; we need to do this before we close the compression
+	// sequence, since that disposes of the image description
+	myErr = QTCmpr_FlushSequenceOutput(&myOutput);
+	if (myErr != noErr)
+		goto bail;
 	
 	// close the compression sequence; this will dispose of the image description
-	// and compressed data handles allocated by SCCompressSequenceBegin
+	// and compressed data handles allocated by SCCompressSequenceBegin (in worker mode,
+	// the worker closes its sequence when we end the worker session)
+#if USE_CODEC_WORKERS
+	if (!myUseWorker)
+#endif
 	SCCompressSequenceEnd(myComponent);
 
 	//////////
@@ -652,23 +1218,20 @@ void QTCmpr_CompressSequence (WindowObject theWindowObject)
 	//
 	//////////
 	
-	myErr = EndMediaEdits(myDstMedia);
-	if (myErr != noErr)
-		goto bail;
-	
-	InsertMediaIntoTrack(myDstTrack, 0, 0, GetMediaDuration(myDstMedia), fixed1);
-
-	// add the movie resource to the dst movie file.
-	myErr = AddMovieResource(myDstMovie, myRefNum, NULL, NULL);
+	myErr = QTCmpr_EndSequenceOutput(&myOutput, true);
+	myOutputIsOpen = false;
 	if (myErr != noErr)
 		goto bail;
 
-	// flatten the movie data [to be supplied]
-	
-	// close the movie file
-	CloseMovieFile(myRefNum);
+#if USE_DETERMINISTIC_MODE
+	if (myOutput.fGolden != NULL)
+		QTCmpr_EndGoldenDigest(myOutput.fGolden);
+#endif
 	
 bail:
+	if (myOutputIsOpen)
+		QTCmpr_EndSequenceOutput(&myOutput, false);
+
 	// close the Standard Compression component
 	if (myComponent != NULL)
 		CloseComponent(myComponent);
@@ -679,22 +1242,1815 @@ bail:
 
 		// restore the source movie's original movie time
 		SetMovieTimeValue(mySrcMovie, myOrigMovieTime);
+
+#if USE_CROP
+		// and its original movie box
+		if (myCropping)
+			SetMovieBox(mySrcMovie, &myOrigMovieBox);
+#endif
 	}
 	
 	// restore the original graphics port and device
 	SetGWorld(mySavedPort, mySavedDevice);
 
+	// stop the worker; the worker session disposes of the GWorld it created
+#if USE_CODEC_WORKERS
+	QTCmpr_ReleaseMemory(&myJob, myFallbackSize);
+
+	if (myWorkerIsOpen) {
+		QTCmpr_EndWorkerSession(&myWorker);
+#if USE_RESIZE
+		if (myResizing)
+			myOutWorld = NULL;
+		else
+#endif
+		myImageWorld = NULL;
+	}
+#endif
+
+#if USE_YUV_CONVERSION
+	if (myConverterIsOpen)
+		QTCmpr_DisposeColorConverter(&myConverter);
+#endif
+
+#if USE_DIRTY_FRAMES
+	if (myDetectorIsOpen)
+		QTCmpr_DisposeDirtyDetector(&myDetector);
+#endif
+
+#if USE_MOTION_ESTIMATION
+	if (myEstimatorIsOpen)
+		QTCmpr_DisposeMotionEstimator(&myEstimator);
+#endif
+
+#if USE_QUALITY_METRICS
+	if (myMeterIsOpen)
+		QTCmpr_DisposeQualityMeter(&myMeter);
+#endif
+
+#if USE_RESIZE
+	if (myResizerIsOpen)
+		QTCmpr_DisposeResizer(&myResizer);
+
+	if (myOutWorld != NULL)
+		DisposeGWorld(myOutWorld);
+	QTCmpr_ReleaseMemory(&myJob, myOutWorldSize);
+#endif
+
 	// delete the GWorld we were drawing frames into
 	if (myImageWorld != NULL)
 		DisposeGWorld(myImageWorld);
+	QTCmpr_ReleaseMemory(&myJob, myWorldSize);
+
+	// the compressed data buffer was disposed of by SCCompressSequenceEnd or CloseComponent
+	QTCmpr_ReleaseMemory(&myJob, myReservedDataSize);
 	
 #if USE_ASYNC_COMPRESSION
 	if (myICMComplProcRec.completionProc != NULL)
 		DisposeICMCompletionUPP(myICMComplProcRec.completionProc);
 #endif
 
-	free(myMoviePrompt);
-	free(myMovieFileName);
+	QTCmpr_EndMemoryJob(&myJob);
+}
+
+
+#if USE_RAW_INGEST
+//////////
+//
+// QTCmpr_CompressIngest
+// Compress the raw frames read from the specified file or pipe (or standard input, if thePath is "-").
+//
+// The frames are compressed just like the frames of a movie in QTCmpr_CompressSequence, except that they
+// arrive in order at a fixed rate, so we can't resample them; we therefore tell the compressor that they
+// come from a live source (codecFlagLiveGrab), which lets it trade some quality for speed.
+//
+//////////
+
+void QTCmpr_CompressIngest (char *thePath)
+{
+	ComponentInstance			myComponent = NULL;
+	GWorldPtr					myImageWorld = NULL;		// the graphics world we draw the frames in
+	PixMapHandle				myPixMap = NULL;
+	Rect						myRect;
+	SCTemporalSettings			myTimeSettings;
+	SCDataRateSettings			myRateSettings;
+	ImageDescriptionHandle		myImageDesc = NULL;
+	IngestSource				mySource;
+	char						*myRawFormat = NULL;		// the size and rate of raw RGB frames, if that's what we're reading
+	long						myFlags = 0L;
+	MemoryJob					myJob;
+	long						myWorldSize = 0L;			// the number of bytes reserved for the graphics world
+	long						myReservedDataSize = 0L;	// the number of bytes reserved for the compressed data
+	char						*myStreamPath = NULL;		// the stream to write a fragmented movie to, if any
+	long						myFramesPerFragment = 0L;
+	SequenceOutput				myOutput;					// the new movie file or stream
+	Boolean						myOutputIsOpen = false;
+#if USE_DETERMINISTIC_MODE
+	GoldenDigest				myGolden;					// the digest of the compressed frames, in deterministic mode
+	GoldenDigest				mySourceGolden;				// the digest of the raw frames, in deterministic mode
+	char						mySourceName[kGoldenMaxLabel];
+#endif
+	OSErr						myErr = noErr;
+
+	QTCmpr_BeginMemoryJob(&myJob, "QTCmpr_CompressIngest", NULL, 0L);
+
+	//////////
+	//
+	// open the source and read the first frame
+	//
+	//////////
+
+	QTCmpr_GetIngestInput(&myRawFormat);
+	
+	myErr = QTCmpr_OpenIngestSource(&mySource, thePath, myRawFormat, &myJob);
+	if (myErr != noErr)
+		goto bail;
+
+	MacSetRect(&myRect, 0, 0, mySource.fWidth, mySource.fHeight);
+
+#if USE_DETERMINISTIC_MODE
+	// add each raw frame to a digest too, labelled with the frame size and rate, which the source's name may not give
+	if (QTCmpr_GetDeterministicMode()) {
+		sprintf(mySourceName, "%.*s %dx%d:%ld/%ld", (int)(kGoldenMaxLabel - kGoldenMaxSettings), thePath,
+							mySource.fWidth, mySource.fHeight, mySource.fRateNum, mySource.fRateDen);
+		QTCmpr_BeginGoldenDigest(&mySourceGolden, kGoldenKindSource, mySourceName, NULL, NULL, NULL, 0L);
+		mySource.fGolden = &mySourceGolden;
+	}
+#endif
+
+	myWorldSize = QTCmpr_GetGWorldSize(&myRect, 32);
+	QTCmpr_ReserveMemory(&myJob, myWorldSize);
+
+	myErr = NewGWorld(&myImageWorld, 32, &myRect, NULL, NULL, 0L);
+	if (myErr != noErr)
+		goto bail;
+		
+	myPixMap = GetGWorldPixMap(myImageWorld);
+	if (!LockPixels(myPixMap))
+		goto bail;
+
+	// the first frame is the test image in the compression dialog box, and then the first frame we compress
+	myErr = QTCmpr_ReadIngestFrame(&mySource, myPixMap);
+	if (myErr != noErr)
+		goto bail;
+
+	//////////
+	//
+	// configure and display the Standard Image Compression dialog box
+	//
+	//////////
+	
+	myComponent = OpenDefaultComponent(StandardCompressionType, StandardCompressionSubType);
+	if (myComponent == NULL)
+		goto bail;
+
+	// the raw frames are always converted to 32 bits (see QTCmprIngest.c), so "best depth" means nothing here
+	SCGetInfo(myComponent, scPreferenceFlagsType, &myFlags);
+	myFlags &= ~scShowBestDepth;
+	SCSetInfo(myComponent, scPreferenceFlagsType, &myFlags);
+
+	SCSetTestImagePixMap(myComponent, myPixMap, NULL, scPreferScaling);
+	SCDefaultPixMapSettings(myComponent, myPixMap, true);
+	
+	// show the frame rate of the source; we ignore any other rate the user enters
+	myErr = SCGetInfo(myComponent, scTemporalSettingsType, &myTimeSettings);
+	if (myErr != noErr)
+		goto bail;
+
+	myTimeSettings.frameRate = (Fixed)((double)mySource.fRateNum / mySource.fRateDen * 65536.0);
+	SCSetInfo(myComponent, scTemporalSettingsType, &myTimeSettings);
+
+	myErr = SCRequestSequenceSettings(myComponent);
+	if (myErr == scUserCancelled)
+		goto bail;
+
+	SCGetInfo(myComponent, scTemporalSettingsType, &myTimeSettings);
+
+#if USE_FRAGMENTED_OUTPUT
+	// if we're streaming, make sure there's a key frame in every fragment, so that a reader can begin with any fragment
+	myStreamPath = QTCmpr_GetStreamOutput(&myFramesPerFragment);
+	if ((myStreamPath != NULL) && ((myTimeSettings.keyFrameRate <= 0) || (myTimeSettings.keyFrameRate > myFramesPerFragment))) {
+		myTimeSettings.keyFrameRate = myFramesPerFragment;
+		SCSetInfo(myComponent, scTemporalSettingsType, &myTimeSettings);
+	}
+#endif
+
+	//////////
+	//
+	// create the new movie file, or begin the stream
+	//
+	//////////
+
+	// the media time scale is the numerator of the frame rate, so each frame lasts fRateDen units
+	myErr = QTCmpr_BeginSequenceOutput(&myOutput, myStreamPath, myFramesPerFragment, NULL, NULL, &myRect, mySource.fRateNum, NULL, NULL, &myJob);
+	myOutputIsOpen = true;
+	if (myErr != noErr)
+		goto bail;
+
+#if USE_DETERMINISTIC_MODE
+	// add each compressed frame to a digest, to check against its golden digest at the end
+	if (QTCmpr_GetDeterministicMode()) {
+		QTCmpr_BeginGoldenDigest(&myGolden, kGoldenKindIngest, thePath, myComponent, &myRect, &myRect, 0L);
+		myOutput.fGolden = &myGolden;
+	}
+#endif
+
+	myImageDesc = (ImageDescriptionHandle)NewHandleClear(sizeof(ImageDescription));
+	if (myImageDesc == NULL)
+		goto bail;
+
+	//////////
+	//
+	// compress the frames
+	//
+	//////////
+
+	myReservedDataSize = QTCmpr_GetMaxCompressedSize(myComponent, myPixMap, &myRect);
+	QTCmpr_ReserveMemory(&myJob, myReservedDataSize);
+
+	myErr = SCCompressSequenceBegin(myComponent, myPixMap, NULL, &myImageDesc);
+	if (myErr != noErr)
+		goto bail;
+
+	// the frames come from a live source, and each one replaces the previous one in the same pixel map
+	myFlags = codecFlagUpdatePrevious + codecFlagUpdatePreviousComp + codecFlagLiveGrab;
+	SCSetInfo(myComponent, scCodecFlagsType, &myFlags);
+
+	// every frame has the same duration
+	if (!SCGetInfo(myComponent, scDataRateSettingsType, &myRateSettings)) {
+		myRateSettings.frameDuration = mySource.fRateDen * 1000 / mySource.fRateNum;
+		SCSetInfo(myComponent, scDataRateSettingsType, &myRateSettings);
+	}
+
+	// the first frame is already in the pixel map; the reading thread is reading the next one while we compress it
+	while (myErr == noErr) {
+		short			mySyncFlag;
+		long			myDataSize;
+		Handle			myCompressedData;
+
+		myErr = SCCompressSequenceFrame(myComponent, myPixMap, &myRect, &myCompressedData, &myDataSize, &mySyncFlag);
+		if (myErr != noErr)
+			goto bail;
+
+		myErr = QTCmpr_AddSequenceSample(&myOutput, *myCompressedData, myDataSize, mySource.fRateDen, myImageDesc, mySyncFlag);
+		if (myErr != noErr)
+			goto bail;
+
+		myErr = QTCmpr_ReadIngestFrame(&mySource, myPixMap);
+	}
+
+	// the input ends with eofErr; anything else is a read error or a truncated stream header
+	if (myErr != eofErr)
+		goto bail;
+
+	myErr = QTCmpr_FlushSequenceOutput(&myOutput);
+	if (myErr != noErr)
+		goto bail;
+
+	SCCompressSequenceEnd(myComponent);
+
+	myErr = QTCmpr_EndSequenceOutput(&myOutput, true);
+	myOutputIsOpen = false;
+	if (myErr != noErr)
+		goto bail;
+
+	QTCmpr_LogMessage("QTCmpr_CompressIngest: compressed %ld frames", mySource.fNumFrames);
+
+#if USE_DETERMINISTIC_MODE
+	if (mySource.fGolden != NULL)
+		QTCmpr_EndGoldenDigest(mySource.fGolden);
+	if (myOutput.fGolden != NULL)
+		QTCmpr_EndGoldenDigest(myOutput.fGolden);
+#endif
+
+bail:
+	if (myOutputIsOpen)
+		QTCmpr_EndSequenceOutput(&myOutput, false);
+
+	if (myComponent != NULL)
+		CloseComponent(myComponent);
+
+	QTCmpr_CloseIngestSource(&mySource);
+
+	if (myImageWorld != NULL)
+		DisposeGWorld(myImageWorld);
+	QTCmpr_ReleaseMemory(&myJob, myWorldSize);
+
+	// the compressed data buffer was disposed of by SCCompressSequenceEnd or CloseComponent
+	QTCmpr_ReleaseMemory(&myJob, myReservedDataSize);
+
+	QTCmpr_EndMemoryJob(&myJob);
+}
+#endif
+
+
+#if USE_SOURCE_SETTINGS
+//////////
+//
+// QTCmpr_SetSourceSettings
+// Set the spatial and temporal settings of the specified Standard Compression component to those that the
+// specified video track was compressed with, and remember them in theSettings.
+//
+// We take the codec type, depth, and quality from the track's first image description, and work out the key
+// frame rate by counting the sync samples. We also decide whether the track's samples could be copied as they
+// are: that's so only if the track uses a single image description, keeps all its samples in the movie file
+// (see QTCmpr_IsSelfContainedMedia), and is all there is to see in the movie, drawn as is (see
+// QTCmpr_IsPlainSourceTrack).
+//
+//////////
+
+static void QTCmpr_SetSourceSettings (ComponentInstance theComponent, Track theTrack, SourceSettingsPtr theSettings)
+{
+	ImageDescriptionHandle		myDesc = NULL;
+	Component					myCompressor = NULL;
+	TimeValue					myTime = 0L;
+	TimeValue					myDuration;
+	long						myNumFrames;
+	long						myNumSyncs = 0L;
+	short						myFlags;
+
+	theSettings->fTrack = theTrack;
+	theSettings->fMedia = GetTrackMedia(theTrack);
+	theSettings->fCanCopy = false;
+	theSettings->fIsSet = false;
+
+	myDesc = (ImageDescriptionHandle)NewHandle(0);
+	if (myDesc == NULL)
+		goto bail;
+
+	GetMediaSampleDescription(theSettings->fMedia, 1, (SampleDescriptionHandle)myDesc);
+	if (GetMoviesError() != noErr)
+		goto bail;
+
+	// if we can't compress to the source's codec type, the default settings are as good as any
+	if ((FindCodec((**myDesc).cType, anyCodec, &myCompressor, NULL) != noErr) || (myCompressor == NULL))
+		goto bail;
+
+	if ((SCGetInfo(theComponent, scSpatialSettingsType, &theSettings->fSpatial) != noErr) ||
+		(SCGetInfo(theComponent, scTemporalSettingsType, &theSettings->fTemporal) != noErr))
+		goto bail;
+
+	theSettings->fSpatial.codecType = (**myDesc).cType;
+	theSettings->fSpatial.codec = anyCodec;
+	theSettings->fSpatial.depth = (**myDesc).depth;
+	if ((**myDesc).spatialQuality != 0)
+		theSettings->fSpatial.spatialQuality = (**myDesc).spatialQuality;
+
+	// a key frame rate of 1 means every frame is a key frame
+	myNumFrames = QTUtils_GetFrameCount(theTrack);
+	myDuration = GetMediaDuration(theSettings->fMedia);
+	myFlags = nextTimeSyncSample | nextTimeEdgeOK;
+	while ((myTime >= 0L) && (myTime < myDuration)) {
+		GetMediaNextInterestingTime(theSettings->fMedia, myFlags, myTime, fixed1, &myTime, NULL);
+		if (myTime < 0L)
+			break;
+
+		// without nextTimeEdgeOK, the next search starts just after this sync sample
+		myNumSyncs++;
+		myFlags = nextTimeSyncSample;
+	}
+
+	theSettings->fTemporal.frameRate = 0;
+	if ((**myDesc).temporalQuality != 0)
+		theSettings->fTemporal.temporalQuality = (**myDesc).temporalQuality;
+	theSettings->fTemporal.keyFrameRate = (myNumSyncs > 0L) ? (myNumFrames + (myNumSyncs / 2)) / myNumSyncs : 0L;
+
+	SCSetInfo(theComponent, scSpatialSettingsType, &theSettings->fSpatial);
+	SCSetInfo(theComponent, scTemporalSettingsType, &theSettings->fTemporal);
+	theSettings->fIsSet = true;
+
+	// we copy the samples of a track with one image description, whose samples are all in the movie file,
+	// that the movie shows just as they are
+	theSettings->fCanCopy = (GetMediaSampleDescriptionCount(theSettings->fMedia) == 1) &&
+							((**myDesc).dataRefIndex == 1) &&
+							QTCmpr_IsSelfContainedMedia(theSettings->fMedia) &&
+							QTCmpr_IsPlainSourceTrack(theTrack);
+
+bail:
+	if (myDesc != NULL)
+		DisposeHandle((Handle)myDesc);
+}
+
+
+//////////
+//
+// QTCmpr_IsSelfContainedMedia
+// Does the specified media have a single data reference, to the movie file itself?
+//
+// The samples of a media whose data is in other files can't be read from the movie file, so we don't copy them.
+//
+//////////
+
+static Boolean QTCmpr_IsSelfContainedMedia (Media theMedia)
+{
+	Handle						myDataRef = NULL;
+	OSType						myDataRefType;
+	long						myAttributes = 0L;
+	short						myCount = 0;
+
+	if ((GetMediaDataRefCount(theMedia, &myCount) != noErr) || (myCount != 1))
+		return(false);
+
+	if (GetMediaDataRef(theMedia, 1, &myDataRef, &myDataRefType, &myAttributes) != noErr)
+		return(false);
+
+	if (myDataRef != NULL)
+		DisposeHandle(myDataRef);
+
+	return((myAttributes & dataRefSelfReference) != 0);
+}
+
+
+//////////
+//
+// QTCmpr_IsPlainSourceTrack
+// Does the movie show the specified track's samples exactly as they're stored, so that copying them gives the
+// same frames as rendering the movie would?
+//
+// That's so if the track is the movie's only enabled visual track; neither the movie nor the track moves, scales,
+// or rotates it; the track fills the movie box; and the track has one edit, which plays its media from the
+// beginning at normal speed, starting at the beginning of the movie.
+//
+//////////
+
+static Boolean QTCmpr_IsPlainSourceTrack (Track theTrack)
+{
+	Movie						myMovie = GetTrackMovie(theTrack);
+	Media						myMedia = GetTrackMedia(theTrack);
+	MatrixRecord				myMatrix;
+	Rect						myBox;
+	Fixed						myWidth;
+	Fixed						myHeight;
+	TimeValue					myEditTime;
+	TimeValue					myTrackDuration = GetTrackDuration(theTrack);
+	TimeValue					myMediaDuration = GetMediaDuration(myMedia);
+
+	// no other track draws anything
+	if (!GetTrackEnabled(theTrack) ||
+		(GetMovieIndTrackType(myMovie, 1, VisualMediaCharacteristic, movieTrackCharacteristic | movieTrackEnabledOnly) != theTrack) ||
+		(GetMovieIndTrackType(myMovie, 2, VisualMediaCharacteristic, movieTrackCharacteristic | movieTrackEnabledOnly) != NULL))
+		return(false);
+
+	// the frames are drawn as they are, and fill the movie box
+	GetMovieMatrix(myMovie, &myMatrix);
+	if (GetMatrixType(&myMatrix) != identityMatrixType)
+		return(false);
+
+	GetTrackMatrix(theTrack, &myMatrix);
+	if (GetMatrixType(&myMatrix) != identityMatrixType)
+		return(false);
+
+	GetMovieBox(myMovie, &myBox);
+	GetTrackDimensions(theTrack, &myWidth, &myHeight);
+	if ((myWidth != Long2Fix(myBox.right - myBox.left)) || (myHeight != Long2Fix(myBox.bottom - myBox.top)))
+		return(false);
+
+	// the track has a single edit, which plays the whole media from the beginning at normal speed
+	if ((GetTrackOffset(theTrack) != 0L) ||
+		(TrackTimeToMediaTime(0L, theTrack) != 0L) ||
+		(GetTrackEditRate(theTrack, 0L) != fixed1) ||
+		(myTrackDuration != (TimeValue)((double)myMediaDuration * GetMovieTimeScale(myMovie) / GetMediaTimeScale(myMedia) + 0.5)))
+		return(false);
+
+	GetTrackNextInterestingTime(theTrack, nextTimeTrackEdit, 0L, fixed1, &myEditTime, NULL);
+	if ((myEditTime >= 0L) && (myEditTime < myTrackDuration))
+		return(false);
+
+	return(true);
+}
+
+
+//////////
+//
+// QTCmpr_SettingsMatchSource
+// Are the current settings of the specified Standard Compression component the ones that QTCmpr_SetSourceSettings
+// found, and can we copy the source track's samples instead of recompressing them?
+//
+//////////
+
+static Boolean QTCmpr_SettingsMatchSource (ComponentInstance theComponent, SourceSettingsPtr theSettings)
+{
+	SCSpatialSettings			mySpatial;
+	SCTemporalSettings			myTemporal;
+	SCDataRateSettings			myRate;
+
+	if (!theSettings->fIsSet || !theSettings->fCanCopy)
+		return(false);
+
+	if ((SCGetInfo(theComponent, scSpatialSettingsType, &mySpatial) != noErr) ||
+		(SCGetInfo(theComponent, scTemporalSettingsType, &myTemporal) != noErr))
+		return(false);
+
+	// a data rate limit means the frames may need to get smaller
+	if ((SCGetInfo(theComponent, scDataRateSettingsType, &myRate) == noErr) && (myRate.dataRate != 0))
+		return(false);
+
+	return((mySpatial.codecType == theSettings->fSpatial.codecType) &&
+			(mySpatial.depth == theSettings->fSpatial.depth) &&
+			(mySpatial.spatialQuality == theSettings->fSpatial.spatialQuality) &&
+			(myTemporal.frameRate == 0) &&
+			(myTemporal.temporalQuality == theSettings->fTemporal.temporalQuality) &&
+			(myTemporal.keyFrameRate == theSettings->fTemporal.keyFrameRate));
+}
+
+
+//////////
+//
+// QTCmpr_CopySourceSamples
+// Copy the compressed samples of the source track to a new movie file or stream, without recompressing them.
+//
+// The new media has the same time scale as the source media, so the sample durations carry over unchanged.
+// We don't keep a checkpoint file; copying is quick enough to start over.
+//
+// We read the samples straight out of the source file with QTParse (see QTParse.c), which hands back each
+// sample in place in a mapping of the file, instead of having GetMediaSample copy every sample into a handle.
+// If QTParse can't read the file (a compressed movie atom, say), doesn't find the same track there, finds that
+// the track keeps any of its samples in another file, or can't locate every sample, we fall back to
+// GetMediaSample. We check all the samples before we write any, so that the fallback starts from scratch.
+//
+//////////
+
+static OSErr QTCmpr_CopySourceSamples (SourceSettingsPtr theSettings, FSSpecPtr theFSSpecPtr, char *theStreamPath, long theFramesPerFragment, Movie theSrcMovie, Rect *theRect, MemoryJobPtr theJob)
+{
+	SequenceOutput				myOutput;
+	Boolean						myOutputIsOpen = false;
+	ImageDescriptionHandle		myDesc = NULL;
+	Handle						myData = NULL;
+	TimeValue					myTime = 0L;
+	TimeValue					myDuration = GetMediaDuration(theSettings->fMedia);
+	long						myNumSamples = 0L;
+	FSSpec						myFSSpec = *theFSSpecPtr;	// (a copy, since theFSSpecPtr may point into a handle)
+	QTParseMoviePtr				myParseMovie = NULL;
+	QTParseTrackPtr				myParseTrack = NULL;
+	OSErr						myErr = noErr;
+
+	myDesc = (ImageDescriptionHandle)NewHandle(0);
+	myData = NewHandle(0);
+	if ((myDesc == NULL) || (myData == NULL)) {
+		myErr = memFullErr;
+		goto bail;
+	}
+
+	GetMediaSampleDescription(theSettings->fMedia, 1, (SampleDescriptionHandle)myDesc);
+	myErr = GetMoviesError();
+	if (myErr != noErr)
+		goto bail;
+
+	// find the source track in the file, and make sure QTParse sees the same media as the Movie Toolbox does
+	if (QTParse_OpenMovieFile(&myFSSpec, &myParseMovie) == noErr) {
+		long			myIndex = 1L;
+
+		while ((myParseTrack = QTParse_GetIndTrackType(myParseMovie, myIndex++, VideoMediaType)) != NULL)
+			if (myParseTrack->fTrackID == GetTrackID(theSettings->fTrack))
+				break;
+
+		if ((myParseTrack != NULL) &&
+			((myParseTrack->fTimeScale != GetMediaTimeScale(theSettings->fMedia)) ||
+			 (myParseTrack->fDuration != myDuration) ||
+			 (QTParse_GetSampleCount(myParseTrack) != GetMediaSampleCount(theSettings->fMedia)) ||
+			 !QTParse_IsTrackSelfContained(myParseTrack)))
+			myParseTrack = NULL;
+
+		// every sample must be one we can copy; this walks just the sample tables, not the sample data
+		if (myParseTrack != NULL) {
+			long			mySampleCount = QTParse_GetSampleCount(myParseTrack);
+			QTParseSample	mySample;
+
+			for (myIndex = 1L; myIndex <= mySampleCount; myIndex++)
+				if ((QTParse_GetSample(myParseMovie, myParseTrack, myIndex, &mySample) != noErr) ||
+					(mySample.fDescIndex != 1L) || (mySample.fDuration <= 0L)) {
+					myParseTrack = NULL;
+					break;
+				}
+		}
+	}
+
+	if (myParseTrack == NULL)
+		QTCmpr_LogMessage("QTCmpr_CopySourceSamples: can't parse the source file; reading samples with GetMediaSample");
+
+	myErr = QTCmpr_BeginSequenceOutput(&myOutput, theStreamPath, theFramesPerFragment, NULL, theSrcMovie, theRect, GetMediaTimeScale(theSettings->fMedia), NULL, NULL, theJob);
+	myOutputIsOpen = true;
+	if (myErr != noErr)
+		goto bail;
+
+	if (myParseTrack != NULL) {
+		long			mySampleCount = QTParse_GetSampleCount(myParseTrack);
+
+		for (myNumSamples = 0L; myNumSamples < mySampleCount; myNumSamples++) {
+			QTParseSample		mySample;
+
+			// we checked every sample above
+			myErr = QTParse_GetSample(myParseMovie, myParseTrack, myNumSamples + 1, &mySample);
+			if (myErr != noErr)
+				goto bail;
+
+			myErr = QTCmpr_AddSequenceSample(&myOutput, (Ptr)mySample.fBytes.fData, (long)mySample.fBytes.fSize, mySample.fDuration, myDesc, mySample.fIsSync ? 0 : mediaSampleNotSync);
+			if (myErr != noErr)
+				goto bail;
+		}
+
+		// leave the loop below nothing to do
+		myTime = myDuration;
+	}
+
+	while (myTime < myDuration) {
+		TimeValue		mySampleTime;
+		TimeValue		mySampleDuration;
+		long			mySize;
+		long			myNumReturned;
+		short			myFlags;
+
+		myErr = GetMediaSample(theSettings->fMedia, myData, 0L, &mySize, myTime, &mySampleTime, &mySampleDuration, NULL, NULL, 1L, &myNumReturned, &myFlags);
+		if (myErr != noErr)
+			goto bail;
+
+		if ((myNumReturned < 1L) || (mySampleDuration <= 0L)) {
+			myErr = badDataErr;
+			goto bail;
+		}
+
+		HLock(myData);
+		myErr = QTCmpr_AddSequenceSample(&myOutput, *myData, mySize, mySampleDuration, myDesc, myFlags);
+		HUnlock(myData);
+		if (myErr != noErr)
+			goto bail;
+
+		myTime = mySampleTime + mySampleDuration;
+		myNumSamples++;
+	}
+
+	myErr = QTCmpr_FlushSequenceOutput(&myOutput);
+	if (myErr != noErr)
+		goto bail;
+
+	myErr = QTCmpr_EndSequenceOutput(&myOutput, true);
+	myOutputIsOpen = false;
+	if (myErr != noErr)
+		goto bail;
+
+	QTCmpr_LogMessage("QTCmpr_CopySourceSamples: copied %ld samples without recompressing them", myNumSamples);
+
+bail:
+	if (myOutputIsOpen)
+		QTCmpr_EndSequenceOutput(&myOutput, false);
+
+	if (myDesc != NULL)
+		DisposeHandle((Handle)myDesc);
+
+	if (myData != NULL)
+		DisposeHandle(myData);
+
+	// the samples were copied out of the mapping as they were added, so we can unmap the file now
+	QTParse_CloseMovieFile(myParseMovie);
+
+	return(myErr);
+}
+#endif
+
+
+//////////
+//
+// QTCmpr_BeginSequenceOutput
+// Prepare to write compressed frames to a new movie file, or (if theStreamPath isn't NULL) to a stream.
+//
+// When writing a movie file, we ask the user where to put it; if theSrcMovie isn't NULL, we copy its user data
+// and settings to the new movie. The new track has the dimensions of theRect and a media with the specified
+// time scale. Call QTCmpr_EndSequenceOutput even if this function fails.
+//
+// If theSrcFile (the file theSrcMovie was opened from), theSrcMovie, and theComponent aren't NULL, we keep a
+// checkpoint file as we go (see QTCmprCheckpoint.c). If resuming is enabled and the user picks a movie file that
+// an earlier compression of the same, unchanged, source file with the same settings left unfinished, we continue
+// that compression: we add the frames it committed to the new media, and set fResumeFrame and fResumeTime to the
+// source frame to continue with.
+//
+// If theCacheKey isn't NULL, and the output cache holds a movie file with that key, we copy that movie file to the
+// file the user picks and set fIsCached; there's then nothing to compress. Otherwise the finished movie file is
+// added to the cache (see QTCmprOutputCache.c).
+//
+// If a sample store is named in the environment, the new media's data goes into the store instead of the movie
+// file (see QTCmprSampleStore.c); such a movie can't be resumed, and isn't cached.
+//
+//////////
+
+static OSErr QTCmpr_BeginSequenceOutput (SequenceOutputPtr theOutput, char *theStreamPath, long theFramesPerFragment, FSSpec *theSrcFile, Movie theSrcMovie, Rect *theRect, TimeScale theTimeScale, ComponentInstance theComponent, OutputCacheKeyPtr theCacheKey, MemoryJobPtr theJob)
+{
+	FSSpec						myFile;
+	Boolean						myIsSelected = false;
+	Boolean						myIsReplacing = false;	
+	Boolean						myIsResuming = false;
+	StringPtr 					myMoviePrompt = QTUtils_ConvertCToPascalString(kQTCSaveMoviePrompt);
+	StringPtr 					myMovieFileName = QTUtils_ConvertCToPascalString(kQTCSaveMovieFileName);
+	MatrixRecord				myMatrix;
+#if USE_SAMPLE_STORE
+	char						*myStorePath = NULL;
+#endif
+	OSErr						myErr = noErr;
+
+	theOutput->fStreamPath = theStreamPath;
+	theOutput->fRefNum = -1;
+	theOutput->fMovie = NULL;
+	theOutput->fTrack = NULL;
+	theOutput->fMedia = NULL;
+	theOutput->fIsEditing = false;
+	theOutput->fResumeFrame = 0L;
+	theOutput->fResumeTime = 0L;
+#if USE_OUTPUT_CACHE
+	theOutput->fCacheKey = theCacheKey;
+	theOutput->fIsCached = false;
+#else
+#if TARGET_OS_MAC
+#pragma unused(theCacheKey)
+#endif
+#endif
+#if USE_FRAGMENTED_OUTPUT
+	theOutput->fFragmenterIsOpen = false;
+#endif
+#if USE_SAMPLE_WRITER
+	theOutput->fWriterIsOpen = false;
+#endif
+#if USE_SAMPLE_STORE
+	theOutput->fStoreIsOpen = false;
+#endif
+#if USE_DETERMINISTIC_MODE
+	theOutput->fGolden = NULL;
+#endif
+#if USE_CHECKPOINTS
+	theOutput->fSrcMovie = theSrcMovie;
+	if (theSrcFile != NULL)
+		theOutput->fSrcFile = *theSrcFile;
+	theOutput->fUseCheckpoints = (theSrcFile != NULL) && (theSrcMovie != NULL) && (theComponent != NULL);
+	theOutput->fCheckpointIsOpen = false;
+#endif
+#if USE_DIRTY_FRAMES
+	theOutput->fHeldData = NULL;
+	theOutput->fHeldCapacity = 0L;
+	theOutput->fIsHolding = false;
+	theOutput->fJob = theJob;
+#endif
+
+#if USE_FRAGMENTED_OUTPUT
+	// if we're streaming, write a fragmented movie instead of creating a movie file
+	if (theStreamPath != NULL) {
+#if USE_CHECKPOINTS
+		theOutput->fUseCheckpoints = false;
+#endif
+		myErr = QTCmpr_BeginFragmentWriter(&theOutput->fFragmenter, theStreamPath, theTimeScale,
+								theRect->right - theRect->left, theRect->bottom - theRect->top, theFramesPerFragment, theJob);
+		theOutput->fFragmenterIsOpen = true;
+		goto bail;
+	}
+#endif
+
+	// prompt the user for a file to put the compressed image into; in theory, the name
+	// should have a file extension appropriate to the type of compressed data selected by the user;
+	// this is left as an exercise for the reader
+	QTFrame_PutFile(myMoviePrompt, myMovieFileName, &myFile, &myIsSelected, &myIsReplacing);
+	if (!myIsSelected) {
+		myErr = userCanceledErr;
+		goto bail;
+	}
+
+	theOutput->fFile = myFile;
+
+#if USE_SAMPLE_STORE
+	// if another copy of QTCompress is adding to the store, we keep our samples to ourselves, in the movie file
+	myStorePath = QTCmpr_GetSampleStorePath();
+	if (myStorePath != NULL) {
+		myErr = QTCmpr_OpenSampleStore(&theOutput->fStore, myStorePath, theJob);
+		theOutput->fStoreIsOpen = true;
+		if (myErr == fBsyErr) {
+			QTCmpr_LogMessage("QTCmpr_BeginSequenceOutput: %s is in use; writing the samples into the movie file", myStorePath);
+			QTCmpr_CloseSampleStore(&theOutput->fStore, false);
+			theOutput->fStoreIsOpen = false;
+			myStorePath = NULL;
+			myErr = noErr;
+		}
+
+		if (myErr != noErr)
+			goto bail;
+	}
+
+	// resuming would cut back the store, which other movies share; and a cached movie file would be no use
+	// without the store
+	if (myStorePath != NULL) {
+#if USE_CHECKPOINTS
+		theOutput->fUseCheckpoints = false;
+#endif
+#if USE_OUTPUT_CACHE
+		theOutput->fCacheKey = NULL;
+		theCacheKey = NULL;
+#endif
+	}
+#endif
+
+#if USE_CHECKPOINTS
+	// see whether we can pick up where an earlier compression into this file left off
+	if (theOutput->fUseCheckpoints && myIsReplacing && QTCmpr_GetResumeMode())
+		if (QTCmpr_ReadCheckpoint(&theOutput->fCheckpoint, &myFile, &theOutput->fSrcFile, theSrcMovie, theComponent) == noErr) {
+			theOutput->fCheckpointIsOpen = true;
+			myIsResuming = true;
+		}
+#endif
+
+	// delete any existing file of that name
+	if (myIsReplacing && !myIsResuming) {
+		myErr = DeleteMovieFile(&myFile);
+		if (myErr != noErr)
+			goto bail;
+	}
+
+#if USE_OUTPUT_CACHE
+	// a resumed movie is put together by two compressions, so we don't cache it; otherwise, if the same source was
+	// compressed with the same settings before, we just copy the movie file from the cache
+	if (myIsResuming) {
+		theOutput->fCacheKey = NULL;
+	} else if ((theCacheKey != NULL) && (QTCmpr_CopyCachedMovie(theCacheKey, &myFile) == noErr)) {
+		theOutput->fIsCached = true;
+		goto bail;
+	}
+#endif
+	
+	//////////
+	//
+	// create the target movie
+	//
+	//////////
+
+#if USE_CHECKPOINTS
+	if (myIsResuming) {
+		AliasHandle				myAlias = NULL;
+
+		// QTCmpr_ReadCheckpoint has made sure that theComponent holds the settings of the frames already in the file;
+		// open the existing file, and make a new movie whose media data goes into that file
+		myErr = OpenMovieFile(&myFile, &theOutput->fRefNum, fsRdWrPerm);
+		if (myErr != noErr) {
+			theOutput->fRefNum = -1;
+			goto bail;
+		}
+
+		theOutput->fMovie = NewMovie(newMovieActive);
+		if (theOutput->fMovie == NULL) {
+			myErr = GetMoviesError();
+			goto bail;
+		}
+
+		myErr = QTNewAlias(&myFile, &myAlias, true);
+		if (myErr != noErr)
+			goto bail;
+
+		myErr = SetMovieDefaultDataRef(theOutput->fMovie, (Handle)myAlias, rAliasType);
+		DisposeHandle((Handle)myAlias);
+		if (myErr != noErr)
+			goto bail;
+	} else
+#endif
+	myErr = CreateMovieFile(&myFile, sigMoviePlayer, smSystemScript, 
+								createMovieFileDeleteCurFile | createMovieFileDontCreateResFile, &theOutput->fRefNum, &theOutput->fMovie);
+	if (myErr != noErr)
+		goto bail;
+
+	// create a new video movie track with the specified dimensions
+	theOutput->fTrack = NewMovieTrack(theOutput->fMovie,
+								(long)(theRect->right - theRect->left) << 16,
+								(long)(theRect->bottom - theRect->top) << 16, kNoVolume);
+	if (theOutput->fTrack == NULL) {
+		myErr = invalidTrack;
+		goto bail;
+	}
+
+#if USE_SAMPLE_STORE
+	// the media's data goes into the sample store, which the media refers to by alias
+	if (myStorePath != NULL) {
+		AliasHandle				myAlias = NULL;
+
+		myErr = QTNewAlias(&theOutput->fStore.fFile, &myAlias, true);
+		if (myErr != noErr)
+			goto bail;
+
+		theOutput->fMedia = NewTrackMedia(theOutput->fTrack, VIDEO_TYPE, theTimeScale, (Handle)myAlias, rAliasType);
+		DisposeHandle((Handle)myAlias);
+	} else
+#endif
+	theOutput->fMedia = NewTrackMedia(theOutput->fTrack, VIDEO_TYPE, theTimeScale, 0, 0);
+	if (theOutput->fMedia == NULL) {
+		myErr = invalidMedia;
+		goto bail;
+	}
+
+	// copy the user data and settings from the source to the dest movie
+	if (theSrcMovie != NULL)
+		CopyMovieSettings(theSrcMovie, theOutput->fMovie);
+
+	// set movie matrix to identity and clear the movie clip region (because the conversion
+	// process transforms and composites all video tracks into one untransformed video track)
+	SetIdentityMatrix(&myMatrix);
+	SetMovieMatrix(theOutput->fMovie, &myMatrix);
+	SetMovieClipRgn(theOutput->fMovie, NULL);
+
+	// prepare for adding frames to the movie
+	myErr = BeginMediaEdits(theOutput->fMedia);
+	if (myErr != noErr)
+		goto bail;
+
+	theOutput->fIsEditing = true;
+
+#if USE_SAMPLE_WRITER
+#if USE_SAMPLE_STORE
+	myErr = QTCmpr_BeginSampleWriter(&theOutput->fWriter, theOutput->fMedia, theOutput->fStoreIsOpen ? &theOutput->fStore : NULL, theJob);
+#else
+	myErr = QTCmpr_BeginSampleWriter(&theOutput->fWriter, theOutput->fMedia, NULL, theJob);
+#endif
+	theOutput->fWriterIsOpen = true;
+	if (myErr != noErr)
+		goto bail;
+#endif
+
+#if USE_CHECKPOINTS
+	if (myIsResuming) {
+		// throw away anything written after the last commit, and add the committed frames to the media
+		myErr = QTCmpr_ResumeSampleWriter(&theOutput->fWriter, &theOutput->fCheckpoint.fDataEnd);
+		if (myErr != noErr)
+			goto bail;
+
+		HLock(theOutput->fCheckpoint.fReferences);
+		myErr = AddMediaSampleReferences64(theOutput->fMedia, (SampleDescriptionHandle)theOutput->fCheckpoint.fDesc,
+								theOutput->fCheckpoint.fNumReferences, (SampleReference64Ptr)*theOutput->fCheckpoint.fReferences, NULL);
+		if (myErr != noErr)
+			goto bail;
+
+		theOutput->fResumeFrame = theOutput->fCheckpoint.fNextFrame;
+		theOutput->fResumeTime = theOutput->fCheckpoint.fNextTime;
+
+		QTCmpr_LogMessage("QTCmpr_BeginSequenceOutput: resuming at frame %ld", theOutput->fResumeFrame);
+	}
+
+	// the checkpoint needs to know which sample references each commit adds
+	if (theOutput->fUseCheckpoints)
+		myErr = QTCmpr_KeepSampleLog(&theOutput->fWriter);
+#endif
+
+bail:
+#if USE_CHECKPOINTS
+	// we don't need the state we resumed from any more
+	if (theOutput->fCheckpointIsOpen)
+		QTCmpr_DisposeCheckpointState(&theOutput->fCheckpoint);
+#endif
+
+	free(myMoviePrompt);
+	free(myMovieFileName);
+
+	return(myErr);
+}
+
+
+//////////
+//
+// QTCmpr_CheckpointSequenceOutput
+// Record that the frames added so far are safely in the movie file, if it's time to do so.
+//
+// The theNextFrame and theNextTime parameters give the source frame that follows the last frame added, and its time
+// in the source movie. The first call also creates the checkpoint file, so theDesc must be the image description of
+// the compressed frames. In deterministic mode, a checkpoint is due every kCheckpointIntervalFrames frames, instead
+// of every few seconds.
+//
+//////////
+
+static OSErr QTCmpr_CheckpointSequenceOutput (SequenceOutputPtr theOutput, ComponentInstance theComponent, ImageDescriptionHandle theDesc, long theNextFrame, TimeValue theNextTime)
+{
+#if USE_CHECKPOINTS
+	OSErr						myErr = noErr;
+
+	if (!theOutput->fUseCheckpoints)
+		return(noErr);
+
+	if (!theOutput->fCheckpointIsOpen) {
+		myErr = QTCmpr_CreateCheckpoint(&theOutput->fCheckpoint, &theOutput->fFile, &theOutput->fSrcFile, theOutput->fSrcMovie, theComponent, theDesc);
+		if (myErr != noErr)
+			return(myErr);
+
+		theOutput->fCheckpointIsOpen = true;
+
+#if USE_DETERMINISTIC_MODE
+		// writing a checkpoint ends the writer's chunk, so in deterministic mode we can't go by the time
+		if (QTCmpr_GetDeterministicMode())
+			theOutput->fCheckpoint.fIntervalFrames = kCheckpointIntervalFrames;
+#endif
+	}
+
+	if (!QTCmpr_CheckpointIsDue(&theOutput->fCheckpoint, theNextFrame))
+		return(noErr);
+
+	// the checkpoint covers every frame so far, including any that the held sample stands for
+	myErr = QTCmpr_ReleaseHeldSample(theOutput);
+	if (myErr != noErr)
+		return(myErr);
+
+	return(QTCmpr_WriteCheckpoint(&theOutput->fCheckpoint, &theOutput->fWriter, theNextFrame, theNextTime));
+#else
+#if TARGET_OS_MAC
+#pragma unused(theOutput, theComponent, theDesc, theNextFrame, theNextTime)
+#endif
+	return(noErr);
+#endif
+}
+
+
+//////////
+//
+// QTCmpr_AddSequenceSample
+// Add a compressed frame to the new movie file or stream.
+//
+//////////
+
+static OSErr QTCmpr_AddSequenceSample (SequenceOutputPtr theOutput, Ptr theData, long theSize, TimeValue theDuration, ImageDescriptionHandle theDesc, short theSyncFlag)
+{
+#if !USE_SAMPLE_WRITER
+	Handle						myHandle = NULL;
+	OSErr						myErr = noErr;
+#endif
+
+#if USE_DETERMINISTIC_MODE
+	if (theOutput->fGolden != NULL)
+		QTCmpr_AddGoldenSample(theOutput->fGolden, theData, theSize, theDuration, theDesc, theSyncFlag);
+#endif
+
+#if USE_FRAGMENTED_OUTPUT
+	if (theOutput->fFragmenterIsOpen)
+		return(QTCmpr_WriteFragmentSample(&theOutput->fFragmenter, theData, theSize, theDuration, (SampleDescriptionHandle)theDesc, theSyncFlag));
+#endif
+
+#if USE_SAMPLE_WRITER
+	return(QTCmpr_WriteSample(&theOutput->fWriter, theData, theSize, theDuration, (SampleDescriptionHandle)theDesc, theSyncFlag));
+#else
+	// AddMediaSample wants the data in a handle
+	myErr = PtrToHand(theData, &myHandle, theSize);
+	if (myErr != noErr)
+		return(myErr);
+
+	myErr = AddMediaSample(theOutput->fMedia, myHandle, 0, theSize, theDuration, (SampleDescriptionHandle)theDesc, 1, theSyncFlag, NULL);
+	DisposeHandle(myHandle);
+
+	return(myErr);
+#endif
+}
+
+
+#if USE_DIRTY_FRAMES
+//////////
+//
+// QTCmpr_HoldSequenceSample
+// Keep a copy of a compressed frame, instead of adding it to the new movie file or stream right away, so that
+// QTCmpr_ExtendHeldSample can make it last longer if the frames that follow are the same.
+//
+// Any sample already held is added first. The image description must stay valid until the sample is released.
+//
+//////////
+
+static OSErr QTCmpr_HoldSequenceSample (SequenceOutputPtr theOutput, Ptr theData, long theSize, TimeValue theDuration, ImageDescriptionHandle theDesc, short theSyncFlag)
+{
+	OSErr						myErr = noErr;
+
+	myErr = QTCmpr_ReleaseHeldSample(theOutput);
+	if (myErr != noErr)
+		return(myErr);
+
+	// make the buffer bigger, if this sample doesn't fit
+	if (theSize > theOutput->fHeldCapacity) {
+		if (theOutput->fHeldData != NULL)
+			DisposePtr(theOutput->fHeldData);
+		QTCmpr_ReleaseMemory(theOutput->fJob, theOutput->fHeldCapacity);
+		theOutput->fHeldCapacity = 0L;
+
+		QTCmpr_ReserveMemory(theOutput->fJob, theSize);
+		theOutput->fHeldData = NewPtr(theSize);
+		if (theOutput->fHeldData == NULL) {
+			QTCmpr_ReleaseMemory(theOutput->fJob, theSize);
+			return(memFullErr);
+		}
+
+		theOutput->fHeldCapacity = theSize;
+	}
+
+	BlockMoveData(theData, theOutput->fHeldData, theSize);
+	theOutput->fHeldSize = theSize;
+	theOutput->fHeldDuration = theDuration;
+	theOutput->fHeldDesc = theDesc;
+	theOutput->fHeldSyncFlag = theSyncFlag;
+	theOutput->fHeldFrames = 1L;
+	theOutput->fIsHolding = true;
+
+	return(noErr);
+}
+
+
+//////////
+//
+// QTCmpr_ExtendHeldSample
+// Make the held sample stand for one more frame, of the specified duration.
+//
+// Return false if there is no held sample, or if it already stands for kMaxHeldFrames frames; a stream would
+// otherwise get no new fragments for as long as the picture stays the same.
+//
+//////////
+
+static Boolean QTCmpr_ExtendHeldSample (SequenceOutputPtr theOutput, TimeValue theDuration)
+{
+	if (!theOutput->fIsHolding || (theOutput->fHeldFrames >= kMaxHeldFrames))
+		return(false);
+
+	theOutput->fHeldDuration += theDuration;
+	theOutput->fHeldFrames++;
+
+	return(true);
+}
+#endif	// USE_DIRTY_FRAMES
+
+
+//////////
+//
+// QTCmpr_ReleaseHeldSample
+// Add the held sample, if there is one, to the new movie file or stream.
+//
+//////////
+
+static OSErr QTCmpr_ReleaseHeldSample (SequenceOutputPtr theOutput)
+{
+#if USE_DIRTY_FRAMES
+	if (!theOutput->fIsHolding)
+		return(noErr);
+
+	theOutput->fIsHolding = false;
+
+	return(QTCmpr_AddSequenceSample(theOutput, theOutput->fHeldData, theOutput->fHeldSize, theOutput->fHeldDuration, theOutput->fHeldDesc, theOutput->fHeldSyncFlag));
+#else
+#if TARGET_OS_MAC
+#pragma unused(theOutput)
+#endif
+	return(noErr);
+#endif
+}
+
+
+//////////
+//
+// QTCmpr_FlushSequenceOutput
+// Write out any compressed frames that are still buffered, and the last fragment of a stream.
+//
+// We need to do this before we close the compression sequence, since that disposes of the image description.
+//
+//////////
+
+static OSErr QTCmpr_FlushSequenceOutput (SequenceOutputPtr theOutput)
+{
+	OSErr						myErr = noErr;
+
+	myErr = QTCmpr_ReleaseHeldSample(theOutput);
+	if (myErr != noErr)
+		return(myErr);
+
+#if USE_FRAGMENTED_OUTPUT
+	if (theOutput->fFragmenterIsOpen) {
+		myErr = QTCmpr_EndFragmentWriter(&theOutput->fFragmenter, true);
+		theOutput->fFragmenterIsOpen = false;
+		if (myErr != noErr)
+			return(myErr);
+	}
+#endif
+
+#if USE_SAMPLE_WRITER
+	if (theOutput->fWriterIsOpen) {
+		myErr = QTCmpr_EndSampleWriter(&theOutput->fWriter, true);
+		theOutput->fWriterIsOpen = false;
+		if (myErr != noErr)
+			return(myErr);
+	}
+#endif
+
+	return(myErr);
+}
+
+
+//////////
+//
+// QTCmpr_EndSequenceOutput
+// Finish writing the new movie file or stream.
+//
+// If theFinish is true, we add the media to the track and the movie resource to the file, and delete the
+// checkpoint file; otherwise, we just throw away any buffered frames and close the file, leaving the
+// checkpoint file so that the compression can be resumed later.
+//
+//////////
+
+static OSErr QTCmpr_EndSequenceOutput (SequenceOutputPtr theOutput, Boolean theFinish)
+{
+	OSErr						myErr = noErr;
+
+	if (theFinish)
+		myErr = QTCmpr_FlushSequenceOutput(theOutput);
+
+	// anything still open is thrown away
+#if USE_DIRTY_FRAMES
+	if (theOutput->fHeldData != NULL)
+		DisposePtr(theOutput->fHeldData);
+	QTCmpr_ReleaseMemory(theOutput->fJob, theOutput->fHeldCapacity);
+	theOutput->fHeldData = NULL;
+	theOutput->fHeldCapacity = 0L;
+	theOutput->fIsHolding = false;
+#endif
+
+#if USE_FRAGMENTED_OUTPUT
+	if (theOutput->fFragmenterIsOpen)
+		QTCmpr_EndFragmentWriter(&theOutput->fFragmenter, false);
+	theOutput->fFragmenterIsOpen = false;
+#endif
+
+#if USE_SAMPLE_WRITER
+	if (theOutput->fWriterIsOpen)
+		QTCmpr_EndSampleWriter(&theOutput->fWriter, false);
+	theOutput->fWriterIsOpen = false;
+#endif
+
+	if (theOutput->fIsEditing) {
+		if (myErr == noErr)
+			myErr = EndMediaEdits(theOutput->fMedia);
+		else
+			EndMediaEdits(theOutput->fMedia);
+		theOutput->fIsEditing = false;
+
+		if (theFinish && (myErr == noErr)) {
+			InsertMediaIntoTrack(theOutput->fTrack, 0, 0, GetMediaDuration(theOutput->fMedia), fixed1);
+
+			// add the movie resource to the dst movie file.
+			myErr = AddMovieResource(theOutput->fMovie, theOutput->fRefNum, NULL, NULL);
+
+			// flatten the movie data [to be supplied]
+		}
+	}
+
+#if USE_SAMPLE_STORE
+	// now that the Movie Toolbox has written the new samples to the store, they can be added to its index
+	if (theOutput->fStoreIsOpen)
+		QTCmpr_CloseSampleStore(&theOutput->fStore, theFinish && (myErr == noErr));
+	theOutput->fStoreIsOpen = false;
+#endif
+
+	// close the movie file
+	if (theOutput->fRefNum != -1) {
+		CloseMovieFile(theOutput->fRefNum);
+
+#if USE_OUTPUT_CACHE
+		// keep a copy of the finished movie file, for the next time the same source is compressed the same way
+		if (theFinish && (myErr == noErr) && (theOutput->fCacheKey != NULL))
+			QTCmpr_CacheMovie(theOutput->fCacheKey, &theOutput->fFile);
+#endif
+	}
+	theOutput->fRefNum = -1;
+
+#if USE_CHECKPOINTS
+	// once the movie is complete, we don't need the checkpoint; otherwise, keep it so that we can resume
+	if (theOutput->fCheckpointIsOpen)
+		QTCmpr_CloseCheckpoint(&theOutput->fCheckpoint, theFinish && (myErr == noErr));
+	theOutput->fCheckpointIsOpen = false;
+#endif
+
+	if (theOutput->fMovie != NULL)
+		DisposeMovie(theOutput->fMovie);
+	theOutput->fMovie = NULL;
+
+	return(myErr);
+}
+
+
+//////////
+//
+// QTCmpr_GetGWorldSize
+// Return the number of bytes of pixel data in a graphics world with the specified bounds and depth.
+//
+//////////
+
+static long QTCmpr_GetGWorldSize (Rect *theRect, short theDepth)
+{
+	long			myRowBytes = ((((long)(theRect->right - theRect->left) * theDepth) + 31) / 32) * 4;
+
+	return((long)(theRect->bottom - theRect->top) * myRowBytes);
+}
+
+
+//////////
+//
+// QTCmpr_GetPixelFormatDepth
+// Return the number of bits per pixel of one of the pixel formats we render frames in.
+//
+//////////
+
+short QTCmpr_GetPixelFormatDepth (OSType thePixelFormat)
+{
+	switch (thePixelFormat) {
+		case k8IndexedGrayPixelFormat:
+			return(8);
+		case k16BE555PixelFormat:
+			return(16);
+		case k24RGBPixelFormat:
+			return(24);
+		default:
+			return(32);
+	}
+}
+
+
+#if USE_SOURCE_DEPTH
+//////////
+//
+// QTCmpr_GetSourcePixelFormat
+// Return the pixel format of the narrowest graphics world that can hold the images in all the visual tracks of
+// the specified movie without losing anything.
+//
+// We look at the depth in every image description of every video track. If all the images are grayscale, an
+// 8-bit gray graphics world will do; if all are 16-bit, a 16-bit one; if none has an alpha channel, a 24-bit one;
+// otherwise we need 32 bits. Indexed-color images each come with their own color table, so rather than try to
+// find one table for all of them, we give them 24 bits. Any other visual track (text, sprites, and so on) has no
+// depth we can read, and can draw in any color, so it gets 32 bits.
+//
+//////////
+
+static OSType QTCmpr_GetSourcePixelFormat (Movie theMovie)
+{
+	ImageDescriptionHandle		myDesc = NULL;
+	Track						myTrack = NULL;
+	Media						myMedia = NULL;
+	OSType						myMediaType;
+	long						myTrackIndex;
+	long						myDescIndex;
+	long						myNumDescs;
+	Boolean						myHasImages = false;
+	Boolean						myAllGray = true;
+	Boolean						myAll16 = true;
+	Boolean						myHasAlpha = false;
+	OSType						myPixelFormat = k32ARGBPixelFormat;
+
+	myDesc = (ImageDescriptionHandle)NewHandle(0);
+	if (myDesc == NULL)
+		goto bail;
+
+	for (myTrackIndex = 1; ; myTrackIndex++) {
+		myTrack = GetMovieIndTrackType(theMovie, myTrackIndex, VisualMediaCharacteristic, movieTrackCharacteristic);
+		if (myTrack == NULL)
+			break;
+
+		myMedia = GetTrackMedia(myTrack);
+		GetMediaHandlerDescription(myMedia, &myMediaType, NULL, NULL);
+		if (myMediaType != VideoMediaType) {
+			myHasImages = true;
+			myAllGray = false;
+			myAll16 = false;
+			myHasAlpha = true;
+			continue;
+		}
+
+		myNumDescs = GetMediaSampleDescriptionCount(myMedia);
+
+		for (myDescIndex = 1; myDescIndex <= myNumDescs; myDescIndex++) {
+			GetMediaSampleDescription(myMedia, myDescIndex, (SampleDescriptionHandle)myDesc);
+			if (GetMoviesError() != noErr)
+				goto bail;					// if we can't see every image description, assume the worst
+
+			myHasImages = true;
+
+			switch ((**myDesc).depth) {
+				case 33: case 34: case 36: case 40:			// 1-, 2-, 4-, and 8-bit grayscale
+					myAll16 = false;
+					break;
+				case 16:
+					myAllGray = false;
+					break;
+				case 1: case 2: case 4: case 8: case 24:	// indexed color, or millions of colors
+					myAllGray = false;
+					myAll16 = false;
+					break;
+				default:									// millions of colors plus alpha, or a depth we don't know
+					myAllGray = false;
+					myAll16 = false;
+					myHasAlpha = true;
+					break;
+			}
+		}
+	}
+
+	if (!myHasImages)
+		goto bail;
+
+	if (myAllGray)
+		myPixelFormat = k8IndexedGrayPixelFormat;
+	else if (myAll16)
+		myPixelFormat = k16BE555PixelFormat;
+	else if (!myHasAlpha)
+		myPixelFormat = k24RGBPixelFormat;
+
+bail:
+	if (myDesc != NULL)
+		DisposeHandle((Handle)myDesc);
+
+	QTCmpr_LogMessage("QTCmpr_GetSourcePixelFormat: rendering frames at %d bits per pixel%s",
+						QTCmpr_GetPixelFormatDepth(myPixelFormat), (myPixelFormat == k8IndexedGrayPixelFormat) ? " (grayscale)" : "");
+
+	return(myPixelFormat);
+}
+#endif
+
+
+//////////
+//
+// QTCmpr_GetMaxCompressedSize
+// Return the maximum number of bytes needed to hold the specified image once it's compressed with the current
+// settings of the specified Standard Compression component.
+//
+//////////
+
+static long QTCmpr_GetMaxCompressedSize (ComponentInstance theComponent, PixMapHandle thePixMap, Rect *theRect)
+{
+	SCSpatialSettings	mySpatialSettings;
+	long				mySize = 0L;
+
+	if (SCGetInfo(theComponent, scSpatialSettingsType, &mySpatialSettings) != noErr)
+		return(0L);
+
+	if (GetMaxCompressionSize(thePixMap, theRect, mySpatialSettings.depth, mySpatialSettings.spatialQuality, mySpatialSettings.codecType, mySpatialSettings.codec, &mySize) != noErr)
+		return(0L);
+
+	return(mySize);
+}
+
+
+//////////
+//
+// QTCmpr_MemoryIdleProc
+// Give the compressor some time while we're waiting for memory.
+//
+// The theRefCon parameter is a pointer to a variable of type ComponentInstance, which holds the
+// Standard Compression component instance (or NULL, if it hasn't been opened yet).
+//
+//////////
+
+static void QTCmpr_MemoryIdleProc (long theRefCon)
+{
+	ComponentInstance	*myComponentPtr = (ComponentInstance *)theRefCon;
+	EventRecord			myEvent;
+
+	WaitNextEvent(0, &myEvent, 1, NULL);
+	if ((myComponentPtr != NULL) && (*myComponentPtr != NULL))
+		SCAsyncIdle(*myComponentPtr);
+}
+
+
+//////////
+//
+// QTCmpr_GetStreamOutput
+// Return the name of the stream that QTCmpr_CompressSequence should write a fragmented movie to, or NULL if
+// it should create a movie file as usual; also return the number of frames to put in each fragment.
+//
+// The stream is named by an environment variable (kQTCStreamOutputVariable), so that a script can run
+// QTCompress with its output piped to another program; "-" means standard output.
+//
+//////////
+
+char *QTCmpr_GetStreamOutput (long *theFramesPerFragment)
+{
+	char			*myPath = getenv(kQTCStreamOutputVariable);
+	char			*myFrames = getenv(kQTCFragmentFramesVariable);
+
+	if (theFramesPerFragment != NULL) {
+		*theFramesPerFragment = (myFrames != NULL) ? atol(myFrames) : 0L;
+		if (*theFramesPerFragment <= 0L)
+			*theFramesPerFragment = kFragmentDefaultFrames;
+	}
+
+	if ((myPath == NULL) || (*myPath == '\0'))
+		return(NULL);
+
+	return(myPath);
+}
+
+
+//////////
+//
+// QTCmpr_GetIngestInput
+// Return the name of the file or pipe that QTCompress should read raw frames from, or NULL if there is none;
+// also return the size and rate of the frames, if they are raw RGB frames, or NULL if they are YUV4MPEG2.
+//
+// Like the output stream, the input is named by an environment variable (kQTCIngestInputVariable);
+// "-" means standard input.
+//
+//////////
+
+char *QTCmpr_GetIngestInput (char **theRawFormat)
+{
+	char			*myPath = getenv(kQTCIngestInputVariable);
+	char			*myFormat = getenv(kQTCIngestRawVariable);
+
+	if (theRawFormat != NULL)
+		*theRawFormat = ((myFormat != NULL) && (*myFormat != '\0')) ? myFormat : NULL;
+
+	if ((myPath == NULL) || (*myPath == '\0'))
+		return(NULL);
+
+	return(myPath);
+}
+
+
+//////////
+//
+// QTCmpr_GetResumeMode
+// Should QTCmpr_CompressSequence resume an unfinished compression into the movie file the user picks?
+//
+// Resuming is enabled by an environment variable (kQTCResumeVariable), so that replacing a movie file
+// still means starting over unless the user asks otherwise. A resumed movie is put together by two
+// compressions, so there's no resuming in deterministic mode.
+//
+//////////
+
+Boolean QTCmpr_GetResumeMode (void)
+{
+	char			*myValue = getenv(kQTCResumeVariable);
+
+	if (QTCmpr_GetDeterministicMode())
+		return(false);
+
+	return((myValue != NULL) && (*myValue != '\0') && (*myValue != '0'));
+}
+
+
+//////////
+//
+// QTCmpr_GetWorkerMode
+// Should QTCmpr_CompressSequence run the compression sequence in a worker process?
+//
+// Worker mode is enabled by an environment variable (kQTCWorkersVariable); it costs a little time for every
+// frame, but a codec that crashes takes down only the worker, which we replace.
+//
+//////////
+
+Boolean QTCmpr_GetWorkerMode (void)
+{
+	char			*myValue = getenv(kQTCWorkersVariable);
+
+	return((myValue != NULL) && (*myValue != '\0') && (*myValue != '0'));
+}
+
+
+//////////
+//
+// QTCmpr_GetOutputSize
+// Should frames be compressed at a different size than theSrcRect? If so, return that size in theDstRect, and
+// the filter to resample frames with in theFilter.
+//
+// The size is given by an environment variable (kQTCOutputSizeVariable), as "<width>x<height>"; a width or height
+// of 0 is chosen to keep the source's aspect ratio. The filter is named by kQTCResizeFilterVariable: "lanczos"
+// (the default), "bicubic", or "area".
+//
+//////////
+
+Boolean QTCmpr_GetOutputSize (Rect *theSrcRect, Rect *theDstRect, long *theFilter)
+{
+	char			*mySize = getenv(kQTCOutputSizeVariable);
+	char			*myFilter = getenv(kQTCResizeFilterVariable);
+	long			mySrcWidth = theSrcRect->right - theSrcRect->left;
+	long			mySrcHeight = theSrcRect->bottom - theSrcRect->top;
+	long			myWidth = 0L;
+	long			myHeight = 0L;
+
+	*theDstRect = *theSrcRect;
+	*theFilter = kResizeFilterLanczos;
+
+	if ((mySize == NULL) || (sscanf(mySize, "%ldx%ld", &myWidth, &myHeight) != 2))
+		return(false);
+
+	if ((myWidth < 0L) || (myHeight < 0L) || ((myWidth == 0L) && (myHeight == 0L)) || (mySrcWidth <= 0L) || (mySrcHeight <= 0L))
+		return(false);
+
+	if (myWidth == 0L)
+		myWidth = ((myHeight * mySrcWidth) + (mySrcHeight / 2)) / mySrcHeight;
+	if (myHeight == 0L)
+		myHeight = ((myWidth * mySrcHeight) + (mySrcWidth / 2)) / mySrcWidth;
+
+	if ((myWidth < 1L) || (myHeight < 1L) || (myWidth > 0x7FFF) || (myHeight > 0x7FFF))
+		return(false);
+
+	if ((myWidth == mySrcWidth) && (myHeight == mySrcHeight))
+		return(false);
+
+	if (myFilter != NULL) {
+		if (strcmp(myFilter, "bicubic") == 0)
+			*theFilter = kResizeFilterBicubic;
+		else if (strcmp(myFilter, "area") == 0)
+			*theFilter = kResizeFilterArea;
+	}
+
+	MacSetRect(theDstRect, 0, 0, (short)myWidth, (short)myHeight);
+
+	return(true);
+}
+
+
+//////////
+//
+// QTCmpr_GetCropRect
+// Should only part of each frame be compressed? If so, return that part of theSrcRect in theCropRect.
+//
+// The part is given by an environment variable (kQTCCropVariable), as "<width>x<height>+<left>+<top>", with
+// the offsets measured from the top left corner of theSrcRect; the part is clipped to theSrcRect.
+//
+//////////
+
+Boolean QTCmpr_GetCropRect (Rect *theSrcRect, Rect *theCropRect)
+{
+	char			*myCrop = getenv(kQTCCropVariable);
+	long			myWidth = 0L;
+	long			myHeight = 0L;
+	long			myLeft = 0L;
+	long			myTop = 0L;
+
+	*theCropRect = *theSrcRect;
+
+	if ((myCrop == NULL) || (sscanf(myCrop, "%ldx%ld+%ld+%ld", &myWidth, &myHeight, &myLeft, &myTop) != 4))
+		return(false);
+
+	if ((myWidth <= 0L) || (myHeight <= 0L) || (myLeft < 0L) || (myTop < 0L))
+		return(false);
+
+	if (myLeft + myWidth > theSrcRect->right - theSrcRect->left)
+		myWidth = theSrcRect->right - theSrcRect->left - myLeft;
+	if (myTop + myHeight > theSrcRect->bottom - theSrcRect->top)
+		myHeight = theSrcRect->bottom - theSrcRect->top - myTop;
+
+	if ((myWidth <= 0L) || (myHeight <= 0L))
+		return(false);
+
+	MacSetRect(theCropRect, theSrcRect->left + (short)myLeft, theSrcRect->top + (short)myTop,
+				theSrcRect->left + (short)(myLeft + myWidth), theSrcRect->top + (short)(myTop + myHeight));
+
+	return(!MacEqualRect(theCropRect, theSrcRect));
+}
+
+
+//////////
+//
+// QTCmpr_GetMetricsOutput
+// Return the name of the file that QTCmpr_CompressSequence should write the quality of each compressed frame to,
+// or NULL if there is none.
+//
+// The file is named by an environment variable (kQTCMetricsVariable); measuring means decoding every frame, so
+// it's off unless the user asks for it.
+//
+//////////
+
+char *QTCmpr_GetMetricsOutput (void)
+{
+	char			*myPath = getenv(kQTCMetricsVariable);
+
+	if ((myPath == NULL) || (*myPath == '\0'))
+		return(NULL);
+
+	return(myPath);
+}
+
+
+//////////
+//
+// QTCmpr_GetOutputCacheDir
+// Return the name of the directory that compressed images and movie files should be cached in, or NULL if there is
+// none; also return the most megabytes the cached files may take up.
+//
+// The directory is named by an environment variable (kQTCCacheVariable), and must already exist; its size is given by
+// kQTCCacheSizeVariable. In deterministic mode, we always compress, so there's no cache.
+//
+//////////
+
+char *QTCmpr_GetOutputCacheDir (long *theMegabytes)
+{
+	char			*myPath = getenv(kQTCCacheVariable);
+	char			*mySize = getenv(kQTCCacheSizeVariable);
+
+	if (theMegabytes != NULL) {
+		*theMegabytes = (mySize != NULL) ? atol(mySize) : 0L;
+		if (*theMegabytes <= 0L)
+			*theMegabytes = kOutputCacheDefaultMegabytes;
+	}
+
+	if ((myPath == NULL) || (*myPath == '\0') || QTCmpr_GetDeterministicMode())
+		return(NULL);
+
+	return(myPath);
+}
+
+
+//////////
+//
+// QTCmpr_GetSampleStorePath
+// Return the name of the file that new movies should keep their samples in, shared with other movies, or NULL if
+// there is none; the file is named by an environment variable (kQTCSampleStoreVariable).
+//
+//////////
+
+char *QTCmpr_GetSampleStorePath (void)
+{
+	char			*myPath = getenv(kQTCSampleStoreVariable);
+
+	if ((myPath == NULL) || (*myPath == '\0'))
+		return(NULL);
+
+	return(myPath);
+}
+
+
+//////////
+//
+// QTCmpr_GetDeterministicMode
+// Should the same source and settings always give the same compressed samples, however many processors there are
+// and however long each frame takes?
+//
+// Deterministic mode is enabled by an environment variable (kQTCDeterministicVariable). It turns off resuming and
+// the output cache, and makes checkpoints a little less timely; it's meant for checking the output against golden
+// digests (see QTCmprGolden.c).
+//
+//////////
+
+Boolean QTCmpr_GetDeterministicMode (void)
+{
+#if USE_DETERMINISTIC_MODE
+	char			*myValue = getenv(kQTCDeterministicVariable);
+
+	return((myValue != NULL) && (*myValue != '\0') && (*myValue != '0'));
+#else
+	return(false);
+#endif
+}
+
+
+//////////
+//
+// QTCmpr_GetGoldenFile
+// Return the name of the file that digests of compressed output should be checked against (and, in record mode,
+// added to), or NULL if there is none; the file is named by an environment variable (kQTCGoldenVariable).
+//
+//////////
+
+char *QTCmpr_GetGoldenFile (void)
+{
+	char			*myPath = getenv(kQTCGoldenVariable);
+
+	if ((myPath == NULL) || (*myPath == '\0'))
+		return(NULL);
+
+	return(myPath);
+}
+
+
+//////////
+//
+// QTCmpr_GetGoldenRecordMode
+// Should a digest that isn't in the golden file be added to it, instead of counting as a failure?
+//
+// Record mode is enabled by an environment variable (kQTCGoldenRecordVariable), so that a new golden digest is
+// never recorded by accident; run once in record mode on the reference machine, and check in the result.
+//
+//////////
+
+Boolean QTCmpr_GetGoldenRecordMode (void)
+{
+	char			*myValue = getenv(kQTCGoldenRecordVariable);
+
+	return((myValue != NULL) && (*myValue != '\0') && (*myValue != '0'));
+}
+
+
+//////////
+//
+// QTCmpr_LogMessage
+// Write a formatted message to the debugging output.
+//
+//////////
+
+void QTCmpr_LogMessage (char *theFormat, ...)
+{
+	char			myText[kLogMessageMaxLength];
+	va_list			myArgs;
+
+	// leave room for the line ending
+	va_start(myArgs, theFormat);
+#if TARGET_OS_WIN32
+	_vsnprintf(myText, kLogMessageMaxLength - 3, theFormat, myArgs);
+#else
+	vsnprintf(myText, kLogMessageMaxLength - 3, theFormat, myArgs);
+#endif
+	va_end(myArgs);
+	myText[kLogMessageMaxLength - 3] = '\0';
+
+#if TARGET_OS_WIN32
+	strcat(myText, "\r\n");
+	OutputDebugString(myText);
+#else
+	fprintf(stderr, "%s\n", myText);
+#endif
 }
 
 
@@ -97,6 +97,78 @@ SOURCE=".\Common Files\ComFramework.c"
 # End Source File
 # Begin Source File
 
+SOURCE=.\QTCmprBudget.c
+# End Source File
+# Begin Source File
+
+SOURCE=.\QTCmprCheckpoint.c
+# End Source File
+# Begin Source File
+
+SOURCE=.\QTCmprColor.c
+# End Source File
+# Begin Source File
+
+SOURCE=.\QTCmprDirty.c
+# End Source File
+# Begin Source File
+
+SOURCE=.\QTCmprFragment.c
+# End Source File
+# Begin Source File
+
+SOURCE=.\QTCmprFrameCache.c
+# End Source File
+# Begin Source File
+
+SOURCE=.\QTCmprGolden.c
+# End Source File
+# Begin Source File
+
+SOURCE=.\QTCmprHash.c
+# End Source File
+# Begin Source File
+
+SOURCE=.\QTCmprIngest.c
+# End Source File
+# Begin Source File
+
+SOURCE=.\QTCmprMotion.c
+# End Source File
+# Begin Source File
+
+SOURCE=.\QTCmprOutputCache.c
+# End Source File
+# Begin Source File
+
+SOURCE=.\QTCmprQuality.c
+# End Source File
+# Begin Source File
+
+SOURCE=.\QTCmprRANS.c
+# End Source File
+# Begin Source File
+
+SOURCE=.\QTCmprResize.c
+# End Source File
+# Begin Source File
+
+SOURCE=.\QTCmprSampleStore.c
+# End Source File
+# Begin Source File
+
+SOURCE=.\QTCmprSlice.c
+# End Source File
+# Begin Source File
+
+SOURCE=.\QTCmprWorker.c
+# End Source File
+# Begin Source File
+
+SOURCE=.\QTCmprWriter.c
+# End Source File
+# Begin Source File
+
 SOURCE=.\QTCompress.c
 # End Source File
 # Begin Source File
@@ -105,6 +177,10 @@ SOURCE=".\Application Files\QTCompress.rc"
 # End Source File
 # Begin Source File
 
+SOURCE=".\Common Files\QTParse.c"
+# End Source File
+# Begin Source File
+
 SOURCE=".\Common Files\QTUtilities.c"
 # End Source File
 # Begin Source File
@@ -12,6 +12,26 @@
 //
 //	Change History (most recent first):
 //
+//	   <21>	 	11/11/26	rtm		added USE_DETERMINISTIC_MODE
+//	   <20>	 	11/10/26	rtm		added USE_SAMPLE_STORE
+//	   <19>	 	11/09/26	rtm		added USE_OUTPUT_CACHE
+//	   <18>	 	11/08/26	rtm		added USE_QUALITY_METRICS
+//	   <17>	 	11/07/26	rtm		included QTCmprSlice.h
+//	   <16>	 	11/06/26	rtm		included QTCmprRANS.h
+//	   <15>	 	11/05/26	rtm		added USE_MOTION_ESTIMATION
+//	   <14>	 	11/04/26	rtm		added USE_DIRTY_FRAMES
+//	   <13>	 	11/03/26	rtm		added USE_CROP
+//	   <12>	 	11/02/26	rtm		added USE_RESIZE
+//	   <11>	 	11/01/26	rtm		added USE_YUV_CONVERSION
+//	   <10>	 	10/31/26	rtm		added USE_SOURCE_SETTINGS
+//	   <9>	 	10/30/26	rtm		added USE_SOURCE_DEPTH
+//	   <8>	 	10/29/26	rtm		added worker mode
+//	   <7>	 	10/28/26	rtm		added USE_CHECKPOINTS
+//	   <6>	 	10/27/26	rtm		added USE_RAW_INGEST
+//	   <5>	 	10/26/26	rtm		added USE_FRAGMENTED_OUTPUT
+//	   <4>	 	10/25/26	rtm		added USE_SAMPLE_WRITER
+//	   <3>	 	10/22/26	rtm		added memory budget
+//	   <2>	 	10/21/26	rtm		added USE_FRAME_CACHE
 //	   <1>	 	11/01/00	rtm		first file from QTStdCompr.h (in QTGoodies)
 //	   
 //////////
@@ -26,9 +46,32 @@
 #include <Movies.h>
 #include <QuickTimeComponents.h>
 #include <StandardFile.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 
 #include "QTUtilities.h"
+#include "QTParse.h"
 #include "ComFramework.h"
+#include "QTCmprBudget.h"
+#include "QTCmprHash.h"
+#include "QTCmprFrameCache.h"
+#include "QTCmprWriter.h"
+#include "QTCmprFragment.h"
+#include "QTCmprIngest.h"
+#include "QTCmprCheckpoint.h"
+#include "QTCmprWorker.h"
+#include "QTCmprColor.h"
+#include "QTCmprResize.h"
+#include "QTCmprDirty.h"
+#include "QTCmprMotion.h"
+#include "QTCmprRANS.h"
+#include "QTCmprSlice.h"
+#include "QTCmprQuality.h"
+#include "QTCmprOutputCache.h"
+#include "QTCmprSampleStore.h"
+#include "QTCmprGolden.h"
 
 
 //////////
@@ -40,6 +83,31 @@
 #define USE_CUSTOM_BUTTON				0		// do we display and handle a custom button? if we do this,
 												// the Options... button will not appear
 #define USE_ASYNC_COMPRESSION			0		// do we compress asynchronously?
+#define USE_FRAME_CACHE					1		// do we reuse frames rendered by earlier compressions?
+#define USE_SAMPLE_WRITER				1		// do we write frames a chunk at a time, with compact sample tables?
+#define USE_FRAGMENTED_OUTPUT			1		// can we write a fragmented movie to a pipe or to standard output?
+#define USE_RAW_INGEST					1		// can we compress raw frames read from a pipe or from standard input?
+#define USE_CHECKPOINTS					1		// do we keep a checkpoint file, so that an unfinished compression can be resumed?
+#define USE_SOURCE_DEPTH				1		// do we render frames at the depth of the source images, instead of at 32 bits?
+#define USE_SOURCE_SETTINGS				1		// do we start with the source track's compression settings, and copy its samples if they're kept?
+#define USE_YUV_CONVERSION				1		// do we convert frames to Y'CbCr for compressors that accept it?
+#define USE_RESIZE						1		// can we compress frames at a different size than the source?
+#define USE_CROP						1		// can we compress just part of each frame?
+#define USE_DIRTY_FRAMES				1		// do we skip compressing frames that are the same as the last one?
+#define USE_MOTION_ESTIMATION			1		// do we make a key frame at each cut to a new scene?
+#define USE_QUALITY_METRICS				1		// do we measure the quality of each compressed frame, if asked?
+#define USE_OUTPUT_CACHE				1		// do we reuse the output of earlier compressions of the same source with the same settings?
+#define USE_SAMPLE_STORE				1		// can movies keep their samples in a store shared with other movies, each distinct sample once?
+#define USE_DETERMINISTIC_MODE			1		// can we compress so that the same source and settings always give the same output?
+
+// checkpoints record the sample references logged by the sample writer, and it's the sample writer that shares
+// samples through a sample store
+#if !USE_SAMPLE_WRITER
+#undef USE_CHECKPOINTS
+#define USE_CHECKPOINTS					0
+#undef USE_SAMPLE_STORE
+#define USE_SAMPLE_STORE				0
+#endif
 
 
 //////////
@@ -54,8 +122,96 @@
 #define kQTCSaveImageFileName			"Untitled"
 #define kQTCSaveMovieFileName			"Untitled.mov"
 #define kButtonTitle					"Defaults"
+#define kQTCStreamOutputVariable		"QTCOMPRESS_STREAM"				// environment variable naming a stream to write to
+#define kQTCFragmentFramesVariable		"QTCOMPRESS_FRAGMENT_FRAMES"	// environment variable giving the frames per fragment
+#define kQTCIngestInputVariable			"QTCOMPRESS_INGEST"				// environment variable naming a source of raw frames
+#define kQTCIngestRawVariable			"QTCOMPRESS_INGEST_RAW"			// environment variable giving the size and rate of raw RGB frames
+#define kQTCResumeVariable				"QTCOMPRESS_RESUME"				// environment variable enabling resumed compressions
+#define kQTCWorkersVariable				"QTCOMPRESS_WORKERS"			// environment variable enabling worker mode
+#define kQTCOutputSizeVariable			"QTCOMPRESS_OUTPUT_SIZE"		// environment variable giving the size to compress frames at
+#define kQTCResizeFilterVariable		"QTCOMPRESS_RESIZE_FILTER"		// environment variable naming the filter to resize frames with
+#define kQTCCropVariable				"QTCOMPRESS_CROP"				// environment variable giving the part of each frame to compress
+#define kQTCMetricsVariable				"QTCOMPRESS_METRICS"			// environment variable naming a file to write quality metrics to
+#define kQTCCacheVariable				"QTCOMPRESS_CACHE"				// environment variable naming a directory to cache compressed output in
+#define kQTCCacheSizeVariable			"QTCOMPRESS_CACHE_SIZE"			// environment variable giving the size of that cache, in megabytes
+#define kQTCSampleStoreVariable			"QTCOMPRESS_SAMPLE_STORE"		// environment variable naming a file to share compressed samples through
+#define kQTCDeterministicVariable		"QTCOMPRESS_DETERMINISTIC"		// environment variable enabling deterministic mode
+#define kQTCGoldenVariable				"QTCOMPRESS_GOLDEN"				// environment variable naming a file of golden output digests
+#define kQTCGoldenRecordVariable		"QTCOMPRESS_GOLDEN_RECORD"		// environment variable enabling adding digests to that file
 
 #define kAsyncDefaultValue				1
+#define kMaxHeldFrames					300		// the most frames that one held sample may stand for
+
+#define kLogMessageMaxLength			512		// maximum length of a message passed to QTCmpr_LogMessage
+
+
+//////////
+//
+// data types
+//	   
+//////////
+
+// the destination of a compressed sequence: a new movie file or, if fStreamPath isn't NULL, a fragmented movie stream
+typedef struct SequenceOutput {
+	char						*fStreamPath;
+	short						fRefNum;							// the movie file, or -1
+	Movie						fMovie;
+	Track						fTrack;
+	Media						fMedia;
+	Boolean						fIsEditing;							// have we called BeginMediaEdits?
+	long						fResumeFrame;						// the first source frame to compress; not 0 if we're resuming
+	TimeValue					fResumeTime;						// the time of that frame in the source movie
+	FSSpec						fFile;								// the movie file
+#if USE_OUTPUT_CACHE
+	OutputCacheKeyPtr			fCacheKey;							// the key to cache the finished movie file under, or NULL
+	Boolean						fIsCached;							// was the movie file copied from the output cache?
+#endif
+#if USE_FRAGMENTED_OUTPUT
+	FragmentWriter				fFragmenter;
+	Boolean						fFragmenterIsOpen;
+#endif
+#if USE_SAMPLE_WRITER
+	SampleWriter				fWriter;
+	Boolean						fWriterIsOpen;
+#endif
+#if USE_SAMPLE_STORE
+	SampleStore					fStore;								// the store the media's samples are in, if fStoreIsOpen
+	Boolean						fStoreIsOpen;
+#endif
+#if USE_DETERMINISTIC_MODE
+	GoldenDigestPtr				fGolden;							// the digest that each sample is added to, or NULL
+#endif
+#if USE_CHECKPOINTS
+	FSSpec						fSrcFile;							// the file fSrcMovie was opened from
+	Movie						fSrcMovie;
+	Checkpoint					fCheckpoint;
+	Boolean						fUseCheckpoints;					// do we keep a checkpoint file?
+	Boolean						fCheckpointIsOpen;
+#endif
+#if USE_DIRTY_FRAMES
+	Ptr							fHeldData;							// the last sample, held so that unchanged frames can extend it
+	long						fHeldCapacity;						// the size of fHeldData
+	long						fHeldSize;
+	TimeValue					fHeldDuration;
+	ImageDescriptionHandle		fHeldDesc;
+	short						fHeldSyncFlag;
+	long						fHeldFrames;						// the number of frames the held sample stands for
+	Boolean						fIsHolding;
+	MemoryJobPtr				fJob;
+#endif
+} SequenceOutput, *SequenceOutputPtr;
+
+#if USE_SOURCE_SETTINGS
+// the compression settings of a source track, as set by QTCmpr_SetSourceSettings
+typedef struct SourceSettings {
+	Track						fTrack;
+	Media						fMedia;
+	SCSpatialSettings			fSpatial;
+	SCTemporalSettings			fTemporal;
+	Boolean						fIsSet;								// did we set the component to these settings?
+	Boolean						fCanCopy;							// could we copy the track's samples as they are?
+} SourceSettings, *SourceSettingsPtr;
+#endif
 
 
 //////////
@@ -67,6 +223,46 @@
 void							QTCmpr_CompressImage (WindowObject theWindowObject);
 void							QTCmpr_PromptUserForDiskFileAndSaveCompressed (Handle theHandle, ImageDescriptionHandle theDesc);
 void							QTCmpr_CompressSequence (WindowObject theWindowObject);
+#if USE_RAW_INGEST
+void							QTCmpr_CompressIngest (char *thePath);
+#endif
+char							*QTCmpr_GetStreamOutput (long *theFramesPerFragment);
+char							*QTCmpr_GetIngestInput (char **theRawFormat);
+Boolean							QTCmpr_GetResumeMode (void);
+Boolean							QTCmpr_GetWorkerMode (void);
+Boolean							QTCmpr_GetOutputSize (Rect *theSrcRect, Rect *theDstRect, long *theFilter);
+Boolean							QTCmpr_GetCropRect (Rect *theSrcRect, Rect *theCropRect);
+char							*QTCmpr_GetMetricsOutput (void);
+char							*QTCmpr_GetOutputCacheDir (long *theMegabytes);
+char							*QTCmpr_GetSampleStorePath (void);
+Boolean							QTCmpr_GetDeterministicMode (void);
+char							*QTCmpr_GetGoldenFile (void);
+Boolean							QTCmpr_GetGoldenRecordMode (void);
+void							QTCmpr_LogMessage (char *theFormat, ...);
+#if USE_SOURCE_SETTINGS
+static void						QTCmpr_SetSourceSettings (ComponentInstance theComponent, Track theTrack, SourceSettingsPtr theSettings);
+static Boolean					QTCmpr_IsSelfContainedMedia (Media theMedia);
+static Boolean					QTCmpr_IsPlainSourceTrack (Track theTrack);
+static Boolean					QTCmpr_SettingsMatchSource (ComponentInstance theComponent, SourceSettingsPtr theSettings);
+static OSErr					QTCmpr_CopySourceSamples (SourceSettingsPtr theSettings, FSSpecPtr theFSSpecPtr, char *theStreamPath, long theFramesPerFragment, Movie theSrcMovie, Rect *theRect, MemoryJobPtr theJob);
+#endif
+static OSErr					QTCmpr_BeginSequenceOutput (SequenceOutputPtr theOutput, char *theStreamPath, long theFramesPerFragment, FSSpec *theSrcFile, Movie theSrcMovie, Rect *theRect, TimeScale theTimeScale, ComponentInstance theComponent, OutputCacheKeyPtr theCacheKey, MemoryJobPtr theJob);
+static OSErr					QTCmpr_AddSequenceSample (SequenceOutputPtr theOutput, Ptr theData, long theSize, TimeValue theDuration, ImageDescriptionHandle theDesc, short theSyncFlag);
+#if USE_DIRTY_FRAMES
+static OSErr					QTCmpr_HoldSequenceSample (SequenceOutputPtr theOutput, Ptr theData, long theSize, TimeValue theDuration, ImageDescriptionHandle theDesc, short theSyncFlag);
+static Boolean					QTCmpr_ExtendHeldSample (SequenceOutputPtr theOutput, TimeValue theDuration);
+#endif
+static OSErr					QTCmpr_ReleaseHeldSample (SequenceOutputPtr theOutput);
+static OSErr					QTCmpr_CheckpointSequenceOutput (SequenceOutputPtr theOutput, ComponentInstance theComponent, ImageDescriptionHandle theDesc, long theNextFrame, TimeValue theNextTime);
+static OSErr					QTCmpr_FlushSequenceOutput (SequenceOutputPtr theOutput);
+static OSErr					QTCmpr_EndSequenceOutput (SequenceOutputPtr theOutput, Boolean theFinish);
+static long						QTCmpr_GetGWorldSize (Rect *theRect, short theDepth);
+short							QTCmpr_GetPixelFormatDepth (OSType thePixelFormat);
+#if USE_SOURCE_DEPTH
+static OSType					QTCmpr_GetSourcePixelFormat (Movie theMovie);
+#endif
+static long						QTCmpr_GetMaxCompressedSize (ComponentInstance theComponent, PixMapHandle thePixMap, Rect *theRect);
+static void						QTCmpr_MemoryIdleProc (long theRefCon);
 static void						QTCmpr_InstallExtendedProcs (ComponentInstance theComponent, long theRefCon);
 static void						QTCmpr_RemoveExtendedProcs (void);
 static PASCAL_RTN Boolean		QTCmpr_FilterProc (DialogPtr theDialog, EventRecord *theEvent, short *theItemHit, long theRefCon);
@@ -43,8 +43,27 @@ ALL : "$(OUTDIR)\QTCompress.exe"
 CLEAN :
 	-@erase "$(INTDIR)\ComApplication.obj"
 	-@erase "$(INTDIR)\ComFramework.obj"
+	-@erase "$(INTDIR)\QTCmprBudget.obj"
+	-@erase "$(INTDIR)\QTCmprCheckpoint.obj"
+	-@erase "$(INTDIR)\QTCmprColor.obj"
+	-@erase "$(INTDIR)\QTCmprDirty.obj"
+	-@erase "$(INTDIR)\QTCmprFragment.obj"
+	-@erase "$(INTDIR)\QTCmprFrameCache.obj"
+	-@erase "$(INTDIR)\QTCmprGolden.obj"
+	-@erase "$(INTDIR)\QTCmprHash.obj"
+	-@erase "$(INTDIR)\QTCmprIngest.obj"
+	-@erase "$(INTDIR)\QTCmprMotion.obj"
+	-@erase "$(INTDIR)\QTCmprOutputCache.obj"
+	-@erase "$(INTDIR)\QTCmprQuality.obj"
+	-@erase "$(INTDIR)\QTCmprRANS.obj"
+	-@erase "$(INTDIR)\QTCmprResize.obj"
+	-@erase "$(INTDIR)\QTCmprSampleStore.obj"
+	-@erase "$(INTDIR)\QTCmprSlice.obj"
+	-@erase "$(INTDIR)\QTCmprWorker.obj"
+	-@erase "$(INTDIR)\QTCmprWriter.obj"
 	-@erase "$(INTDIR)\QTCompress.obj"
 	-@erase "$(INTDIR)\QTCompress.res"
+	-@erase "$(INTDIR)\QTParse.obj"
 	-@erase "$(INTDIR)\QTUtilities.obj"
 	-@erase "$(INTDIR)\vc60.idb"
 	-@erase "$(INTDIR)\WinFramework.obj"
@@ -65,7 +84,26 @@ LINK32_FLAGS=qtmlclient.lib kernel32.lib user32.lib gdi32.lib winspool.lib comdl
 LINK32_OBJS= \
 	"$(INTDIR)\ComApplication.obj" \
 	"$(INTDIR)\ComFramework.obj" \
+	"$(INTDIR)\QTCmprBudget.obj" \
+	"$(INTDIR)\QTCmprCheckpoint.obj" \
+	"$(INTDIR)\QTCmprColor.obj" \
+	"$(INTDIR)\QTCmprDirty.obj" \
+	"$(INTDIR)\QTCmprFragment.obj" \
+	"$(INTDIR)\QTCmprFrameCache.obj" \
+	"$(INTDIR)\QTCmprGolden.obj" \
+	"$(INTDIR)\QTCmprHash.obj" \
+	"$(INTDIR)\QTCmprIngest.obj" \
+	"$(INTDIR)\QTCmprMotion.obj" \
+	"$(INTDIR)\QTCmprOutputCache.obj" \
+	"$(INTDIR)\QTCmprQuality.obj" \
+	"$(INTDIR)\QTCmprRANS.obj" \
+	"$(INTDIR)\QTCmprResize.obj" \
+	"$(INTDIR)\QTCmprSampleStore.obj" \
+	"$(INTDIR)\QTCmprSlice.obj" \
+	"$(INTDIR)\QTCmprWorker.obj" \
+	"$(INTDIR)\QTCmprWriter.obj" \
 	"$(INTDIR)\QTCompress.obj" \
+	"$(INTDIR)\QTParse.obj" \
 	"$(INTDIR)\QTUtilities.obj" \
 	"$(INTDIR)\WinFramework.obj" \
 	"$(INTDIR)\QTCompress.res"
@@ -89,8 +127,27 @@ ALL : "$(OUTDIR)\QTCompress.exe"
 CLEAN :
 	-@erase "$(INTDIR)\ComApplication.obj"
 	-@erase "$(INTDIR)\ComFramework.obj"
+	-@erase "$(INTDIR)\QTCmprBudget.obj"
+	-@erase "$(INTDIR)\QTCmprCheckpoint.obj"
+	-@erase "$(INTDIR)\QTCmprColor.obj"
+	-@erase "$(INTDIR)\QTCmprDirty.obj"
+	-@erase "$(INTDIR)\QTCmprFragment.obj"
+	-@erase "$(INTDIR)\QTCmprFrameCache.obj"
+	-@erase "$(INTDIR)\QTCmprGolden.obj"
+	-@erase "$(INTDIR)\QTCmprHash.obj"
+	-@erase "$(INTDIR)\QTCmprIngest.obj"
+	-@erase "$(INTDIR)\QTCmprMotion.obj"
+	-@erase "$(INTDIR)\QTCmprOutputCache.obj"
+	-@erase "$(INTDIR)\QTCmprQuality.obj"
+	-@erase "$(INTDIR)\QTCmprRANS.obj"
+	-@erase "$(INTDIR)\QTCmprResize.obj"
+	-@erase "$(INTDIR)\QTCmprSampleStore.obj"
+	-@erase "$(INTDIR)\QTCmprSlice.obj"
+	-@erase "$(INTDIR)\QTCmprWorker.obj"
+	-@erase "$(INTDIR)\QTCmprWriter.obj"
 	-@erase "$(INTDIR)\QTCompress.obj"
 	-@erase "$(INTDIR)\QTCompress.res"
+	-@erase "$(INTDIR)\QTParse.obj"
 	-@erase "$(INTDIR)\QTUtilities.obj"
 	-@erase "$(INTDIR)\vc60.idb"
 	-@erase "$(INTDIR)\vc60.pdb"
@@ -114,7 +171,26 @@ LINK32_FLAGS=qtmlclient.lib kernel32.lib user32.lib gdi32.lib winspool.lib comdl
 LINK32_OBJS= \
 	"$(INTDIR)\ComApplication.obj" \
 	"$(INTDIR)\ComFramework.obj" \
+	"$(INTDIR)\QTCmprBudget.obj" \
+	"$(INTDIR)\QTCmprCheckpoint.obj" \
+	"$(INTDIR)\QTCmprColor.obj" \
+	"$(INTDIR)\QTCmprDirty.obj" \
+	"$(INTDIR)\QTCmprFragment.obj" \
+	"$(INTDIR)\QTCmprFrameCache.obj" \
+	"$(INTDIR)\QTCmprGolden.obj" \
+	"$(INTDIR)\QTCmprHash.obj" \
+	"$(INTDIR)\QTCmprIngest.obj" \
+	"$(INTDIR)\QTCmprMotion.obj" \
+	"$(INTDIR)\QTCmprOutputCache.obj" \
+	"$(INTDIR)\QTCmprQuality.obj" \
+	"$(INTDIR)\QTCmprRANS.obj" \
+	"$(INTDIR)\QTCmprResize.obj" \
+	"$(INTDIR)\QTCmprSampleStore.obj" \
+	"$(INTDIR)\QTCmprSlice.obj" \
+	"$(INTDIR)\QTCmprWorker.obj" \
+	"$(INTDIR)\QTCmprWriter.obj" \
 	"$(INTDIR)\QTCompress.obj" \
+	"$(INTDIR)\QTParse.obj" \
 	"$(INTDIR)\QTUtilities.obj" \
 	"$(INTDIR)\WinFramework.obj" \
 	"$(INTDIR)\QTCompress.res"
@@ -179,6 +255,114 @@ SOURCE=".\Common Files\ComFramework.c"
 	$(CPP) $(CPP_PROJ) $(SOURCE)
 
 
+SOURCE=.\QTCmprBudget.c
+
+"$(INTDIR)\QTCmprBudget.obj" : $(SOURCE) "$(INTDIR)"
+	$(CPP) $(CPP_PROJ) $(SOURCE)
+
+
+SOURCE=.\QTCmprCheckpoint.c
+
+"$(INTDIR)\QTCmprCheckpoint.obj" : $(SOURCE) "$(INTDIR)"
+	$(CPP) $(CPP_PROJ) $(SOURCE)
+
+
+SOURCE=.\QTCmprColor.c
+
+"$(INTDIR)\QTCmprColor.obj" : $(SOURCE) "$(INTDIR)"
+	$(CPP) $(CPP_PROJ) $(SOURCE)
+
+
+SOURCE=.\QTCmprDirty.c
+
+"$(INTDIR)\QTCmprDirty.obj" : $(SOURCE) "$(INTDIR)"
+	$(CPP) $(CPP_PROJ) $(SOURCE)
+
+
+SOURCE=.\QTCmprFragment.c
+
+"$(INTDIR)\QTCmprFragment.obj" : $(SOURCE) "$(INTDIR)"
+	$(CPP) $(CPP_PROJ) $(SOURCE)
+
+
+SOURCE=.\QTCmprFrameCache.c
+
+"$(INTDIR)\QTCmprFrameCache.obj" : $(SOURCE) "$(INTDIR)"
+	$(CPP) $(CPP_PROJ) $(SOURCE)
+
+
+SOURCE=.\QTCmprGolden.c
+
+"$(INTDIR)\QTCmprGolden.obj" : $(SOURCE) "$(INTDIR)"
+	$(CPP) $(CPP_PROJ) $(SOURCE)
+
+
+SOURCE=.\QTCmprHash.c
+
+"$(INTDIR)\QTCmprHash.obj" : $(SOURCE) "$(INTDIR)"
+	$(CPP) $(CPP_PROJ) $(SOURCE)
+
+
+SOURCE=.\QTCmprIngest.c
+
+"$(INTDIR)\QTCmprIngest.obj" : $(SOURCE) "$(INTDIR)"
+	$(CPP) $(CPP_PROJ) $(SOURCE)
+
+
+SOURCE=.\QTCmprMotion.c
+
+"$(INTDIR)\QTCmprMotion.obj" : $(SOURCE) "$(INTDIR)"
+	$(CPP) $(CPP_PROJ) $(SOURCE)
+
+
+SOURCE=.\QTCmprOutputCache.c
+
+"$(INTDIR)\QTCmprOutputCache.obj" : $(SOURCE) "$(INTDIR)"
+	$(CPP) $(CPP_PROJ) $(SOURCE)
+
+
+SOURCE=.\QTCmprQuality.c
+
+"$(INTDIR)\QTCmprQuality.obj" : $(SOURCE) "$(INTDIR)"
+	$(CPP) $(CPP_PROJ) $(SOURCE)
+
+
+SOURCE=.\QTCmprRANS.c
+
+"$(INTDIR)\QTCmprRANS.obj" : $(SOURCE) "$(INTDIR)"
+	$(CPP) $(CPP_PROJ) $(SOURCE)
+
+
+SOURCE=.\QTCmprResize.c
+
+"$(INTDIR)\QTCmprResize.obj" : $(SOURCE) "$(INTDIR)"
+	$(CPP) $(CPP_PROJ) $(SOURCE)
+
+
+SOURCE=.\QTCmprSampleStore.c
+
+"$(INTDIR)\QTCmprSampleStore.obj" : $(SOURCE) "$(INTDIR)"
+	$(CPP) $(CPP_PROJ) $(SOURCE)
+
+
+SOURCE=.\QTCmprSlice.c
+
+"$(INTDIR)\QTCmprSlice.obj" : $(SOURCE) "$(INTDIR)"
+	$(CPP) $(CPP_PROJ) $(SOURCE)
+
+
+SOURCE=.\QTCmprWorker.c
+
+"$(INTDIR)\QTCmprWorker.obj" : $(SOURCE) "$(INTDIR)"
+	$(CPP) $(CPP_PROJ) $(SOURCE)
+
+
+SOURCE=.\QTCmprWriter.c
+
+"$(INTDIR)\QTCmprWriter.obj" : $(SOURCE) "$(INTDIR)"
+	$(CPP) $(CPP_PROJ) $(SOURCE)
+
+
 SOURCE=.\QTCompress.c
 
 "$(INTDIR)\QTCompress.obj" : $(SOURCE) "$(INTDIR)"
@@ -202,6 +386,12 @@ SOURCE=".\Application Files\QTCompress.rc"
 
 !ENDIF 
 
+SOURCE=".\Common Files\QTParse.c"
+
+"$(INTDIR)\QTParse.obj" : $(SOURCE) "$(INTDIR)"
+	$(CPP) $(CPP_PROJ) $(SOURCE)
+
+
 SOURCE=".\Common Files\QTUtilities.c"
 
 "$(INTDIR)\QTUtilities.obj" : $(SOURCE) "$(INTDIR)"